@@ -61,10 +61,29 @@ function _M.genconf(dt)
     local xnys_trd_symbol_mapping = os.date("/storage/i01/data/ref/nyse/%Y/%m/%d/NYSESymbolMapping_NMS.xml", dt)
     
     local md = {
+          -- "serial" or "sharded": sharded publishes each poller's quotes
+          -- to its own ring of ring_size updates, and the NBBO is built
+          -- from the rings on the mdnbbo thread instead of the pollers.
+          dispatch = "serial",
+          -- recv_mode "recvmmsg" drains each multicast socket recv_batch
+          -- datagrams per syscall; the default "recv" reads one, e.g.
+          --    recv_mode = "recvmmsg", recv_batch = 32,
+          -- timestamping is off by default; "software" (or "hardware")
+          -- asks the kernel for receive timestamps, to measure socket
+          -- queueing per feed, e.g. timestamping = "software".
+          -- The pollers spin, the default poll_mode.  poll_mode "backoff"
+          -- blocks in epoll_wait once spin_count polls in a row find
+          -- nothing, and "adaptive" spins while a poller sees at least
+          -- spin_rate events/sec and backs off otherwise;
+          -- poll_schedule switches mode at local times, e.g.
+          --    poll_mode = "backoff", spin_rate = 1000,
+          --    poll_schedule = { { at = "09:25:00", mode = "spin" },
+          --                      { at = "16:05:00", mode = "adaptive" },
+          --                      { at = "20:05:00", mode = "backoff" } },
           eventpollers = {
-             batspoller = { affinity = 7 },
-             nasdaqpoller = { affinity = 8 },
-             sftipoller = { affinity = 9 },
+             batspoller = { affinity = 7, ring_size = 65536 },
+             nasdaqpoller = { affinity = 8, ring_size = 65536 },
+             sftipoller = { affinity = 9, ring_size = 65536 },
              mdsys = { affinity = 6 },
           },
           exchanges = {
@@ -311,6 +311,8 @@ bool EngineApp::init(int argc, const char *argv[]) {
     // set the live/historical state for the DM ... and creates bookmuxen here
     auto md_cfg(cfg->copy_prefix_domain("md."));
     m_dm_p->init(*md_cfg, m_engine_date);
+    // poller receive settings and sharded dispatch, before the pollers start
+    m_dm_p->init_dispatch(*md_cfg);
     if (m_pcap_filenames.size()) {
         m_dm_p->use_files(std::set<std::string>(m_pcap_filenames.begin(), m_pcap_filenames.end()));
     }
@@ -331,6 +333,7 @@ EngineApp::~EngineApp() {
         delete th;
     }
     m_threads.clear();
+    m_dm_p->stop_dispatch();
     for (auto& ns : m_strategies) {
         delete ns.second;
         ns.second = nullptr;
@@ -374,6 +377,9 @@ int EngineApp::run()
     }
 
     m_dm_p->start_event_pollers();
+    if (!m_dm_p->start_dispatch()) {
+        return EXIT_FAILURE;
+    }
 
     if (m_shutdown_time_ns_since_midnight) {
         // shutdown timer specified, exit at specified time:
@@ -0,0 +1,115 @@
+// Converts pcap files to a pre-decoded market data archive, or dumps one.
+
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include <i01_core/Application.hpp>
+#include <i01_core/Config.hpp>
+#include <i01_core/Date.hpp>
+#include <i01_core/Time.hpp>
+
+#include <i01_md/DataManager.hpp>
+#include <i01_md/EventArchive.hpp>
+
+using namespace i01::core;
+using namespace i01::MD;
+
+class MDArchiveApp : public Application {
+public:
+    MDArchiveApp();
+    MDArchiveApp(int argc, const char *argv[]);
+
+    virtual int run() override final;
+
+private:
+    int convert();
+    int dump();
+
+private:
+    std::uint32_t m_date;
+    std::string m_output;
+    std::uint32_t m_index_interval_s;
+    bool m_dump;
+    std::vector<std::string> m_filenames;
+};
+
+MDArchiveApp::MDArchiveApp() :
+    Application(),
+    m_date(0),
+    m_index_interval_s(Archive::Writer::DEFAULT_INDEX_INTERVAL_S),
+    m_dump(false)
+{
+    options_description().add_options()
+        ("date,d", po::value<std::uint32_t>(&m_date), "date of the pcap files (format: YYYYMMDD)")
+        ("output,o", po::value<std::string>(&m_output), "archive to write")
+        ("index-interval", po::value<std::uint32_t>(&m_index_interval_s)->default_value(m_index_interval_s), "seconds between time index entries")
+        ("dump", po::bool_switch(&m_dump)->default_value(false), "print the records of archive files")
+        ("file", po::value<std::vector<std::string> >(&m_filenames), "pcap files, or archives with --dump");
+    positional_options_description().add("file", -1);
+}
+
+MDArchiveApp::MDArchiveApp(int argc, const char *argv[]) :
+    MDArchiveApp()
+{
+    if (!Application::init(argc, argv)) {
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+int MDArchiveApp::convert()
+{
+    if (m_output.empty() || m_filenames.empty() || 0 == m_date) {
+        std::cerr << "mdarchive: --date, --output and at least one pcap file are required" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    auto md_cfg(Config::instance().get_shared_state()->copy_prefix_domain("md."));
+    DataManager dm;
+    dm.init(*md_cfg, Date(m_date));
+
+    Archive::Writer writer(m_output, m_index_interval_s);
+    dm.register_listener(&writer);
+    dm.use_files(std::set<std::string>(m_filenames.begin(), m_filenames.end()));
+    dm.read_data();
+    if (!writer.close()) {
+        return EXIT_FAILURE;
+    }
+    std::cout << m_output << ": " << writer.header() << std::endl;
+    return EXIT_SUCCESS;
+}
+
+int MDArchiveApp::dump()
+{
+    for (const auto& f : m_filenames) {
+        Archive::Reader r(f);
+        std::cout << f << ": " << r.header() << std::endl;
+        for (std::uint64_t i = 0; i < r.size(); ++i) {
+            std::cout << r.records()[i] << std::endl;
+        }
+    }
+    return EXIT_SUCCESS;
+}
+
+int MDArchiveApp::run()
+{
+    return m_dump ? dump() : convert();
+}
+
+int
+main(int argc, const char *argv[])
+{
+    try {
+        MDArchiveApp app(argc, argv);
+
+        return app.run();
+    } catch (const std::exception &e) {
+        std::cerr << "Exception caught: " << e.what() << std::endl;
+    }
+    return 1;
+}
@@ -0,0 +1,114 @@
+// Builds the sidecar time indexes PcapFileMux::seek() uses, or dumps them.
+
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include <i01_core/Application.hpp>
+#include <i01_core/Time.hpp>
+
+#include <i01_net/PcapIndex.hpp>
+
+using namespace i01::core;
+using i01::net::pcap::Index;
+
+class PcapIndexApp : public Application {
+public:
+    PcapIndexApp();
+    PcapIndexApp(int argc, const char *argv[]);
+
+    virtual int run() override final;
+
+private:
+    int build();
+    int dump();
+
+private:
+    std::uint32_t m_interval_ms;
+    std::string m_dir;
+    bool m_dump;
+    std::vector<std::string> m_filenames;
+};
+
+PcapIndexApp::PcapIndexApp() :
+    Application(),
+    m_interval_ms(Index::DEFAULT_INTERVAL_MS),
+    m_dump(false)
+{
+    options_description().add_options()
+        ("interval", po::value<std::uint32_t>(&m_interval_ms)->default_value(m_interval_ms), "milliseconds of capture time between index entries")
+        ("dir", po::value<std::string>(&m_dir), "write the indexes here instead of next to the captures")
+        ("dump", po::bool_switch(&m_dump)->default_value(false), "print the entries of existing indexes")
+        ("file", po::value<std::vector<std::string> >(&m_filenames), "pcap or pcap.lz4 captures");
+    positional_options_description().add("file", -1);
+}
+
+PcapIndexApp::PcapIndexApp(int argc, const char *argv[]) :
+    PcapIndexApp()
+{
+    if (!Application::init(argc, argv)) {
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+int PcapIndexApp::build()
+{
+    int ret = EXIT_SUCCESS;
+    for (const auto& f : m_filenames) {
+        const std::string path(Index::default_path(f, m_dir));
+        Index idx;
+        if (!idx.build(f, m_interval_ms) || !idx.save(path)) {
+            std::cerr << "pcapindex: could not index " << f << " to " << path << std::endl;
+            ret = EXIT_FAILURE;
+            continue;
+        }
+        std::cout << path << ": " << idx.header() << std::endl;
+    }
+    return ret;
+}
+
+int PcapIndexApp::dump()
+{
+    int ret = EXIT_SUCCESS;
+    for (const auto& f : m_filenames) {
+        const std::string path(Index::default_path(f, m_dir));
+        Index idx;
+        if (!idx.load(path, f)) {
+            std::cerr << "pcapindex: no current index for " << f << " at " << path << std::endl;
+            ret = EXIT_FAILURE;
+            continue;
+        }
+        std::cout << path << ": " << idx.header() << std::endl;
+        for (const auto& e : idx.entries()) {
+            std::cout << Timestamp(static_cast<time_t>(e.timestamp / 1000000000ULL), static_cast<long>(e.timestamp % 1000000000ULL))
+                      << "," << e.offset << std::endl;
+        }
+    }
+    return ret;
+}
+
+int PcapIndexApp::run()
+{
+    if (m_filenames.empty()) {
+        std::cerr << "pcapindex: at least one capture is required" << std::endl;
+        return EXIT_FAILURE;
+    }
+    return m_dump ? dump() : build();
+}
+
+int
+main(int argc, const char *argv[])
+{
+    try {
+        PcapIndexApp app(argc, argv);
+
+        return app.run();
+    } catch (const std::exception &e) {
+        std::cerr << "Exception caught: " << e.what() << std::endl;
+    }
+    return 1;
+}
@@ -0,0 +1,137 @@
+// Captures an interface to a nanosecond pcap through a TPACKET_V3 ring,
+// for hosts without Solarflare adapters.
+
+#include <signal.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+#include <boost/program_options.hpp>
+
+#include <i01_core/Application.hpp>
+#include <i01_core/Time.hpp>
+
+#include <i01_net/PacketRing.hpp>
+
+using namespace i01::core;
+using i01::net::PacketRing;
+using i01::net::pcap::RingWriter;
+
+namespace {
+
+std::atomic<bool> g_stop(false);
+
+void on_signal(int)
+{
+    g_stop.store(true);
+}
+
+}
+
+class RingCapApp : public Application {
+public:
+    RingCapApp();
+    RingCapApp(int argc, const char *argv[]);
+
+    virtual int run() override final;
+
+private:
+    std::string m_interface;
+    std::string m_filter;
+    std::string m_output;
+    std::uint32_t m_block_size;
+    std::uint32_t m_block_count;
+    std::uint32_t m_seconds;
+    std::uint64_t m_count;
+    std::uint16_t m_fanout_group;
+    bool m_outgoing;
+};
+
+RingCapApp::RingCapApp() :
+    Application(),
+    m_block_size(PacketRing::DEFAULT_BLOCK_SIZE),
+    m_block_count(PacketRing::DEFAULT_BLOCK_COUNT),
+    m_seconds(0),
+    m_count(0),
+    m_fanout_group(0),
+    m_outgoing(false)
+{
+    options_description().add_options()
+        ("interface,i", po::value<std::string>(&m_interface)->default_value("any"), "interface to capture on")
+        ("filter,f", po::value<std::string>(&m_filter), "pcap-filter(7) expression, e.g. \"udp and dst net 224.0.62.0/24\"")
+        ("output,o", po::value<std::string>(&m_output), "pcap file to write")
+        ("block-size", po::value<std::uint32_t>(&m_block_size)->default_value(m_block_size), "bytes per ring block, a multiple of the page size")
+        ("blocks", po::value<std::uint32_t>(&m_block_count)->default_value(m_block_count), "ring blocks")
+        ("seconds", po::value<std::uint32_t>(&m_seconds)->default_value(m_seconds), "stop after this long, 0 to run until interrupted")
+        ("count", po::value<std::uint64_t>(&m_count)->default_value(m_count), "stop after this many packets, 0 for no limit")
+        ("fanout-group", po::value<std::uint16_t>(&m_fanout_group)->default_value(m_fanout_group), "share the interface by flow hash with other captures in this group, 0 for none")
+        ("outgoing", po::bool_switch(&m_outgoing)->default_value(false), "also capture what this host sends");
+}
+
+RingCapApp::RingCapApp(int argc, const char *argv[]) :
+    RingCapApp()
+{
+    if (!Application::init(argc, argv)) {
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+int RingCapApp::run()
+{
+    if (m_output.empty()) {
+        std::cerr << "ringcap: --output is required" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    RingWriter w(m_interface, m_output, m_block_size, m_block_count);
+    if (!m_filter.empty() && !w.set_filter(m_filter)) {
+        return EXIT_FAILURE;
+    }
+    if (m_fanout_group && !w.set_fanout(m_fanout_group)) {
+        std::cerr << "ringcap: could not join fanout group " << m_fanout_group << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (!m_outgoing && !w.set_ignore_outgoing(true)) {
+        std::cerr << "ringcap: this kernel can not skip outgoing frames, capturing them too" << std::endl;
+    }
+
+    ::signal(SIGINT, on_signal);
+    ::signal(SIGTERM, on_signal);
+
+    const Timestamp start(Timestamp::now());
+    while (!g_stop.load()) {
+        if (w.read_blocks(100) < 0) {
+            std::cerr << "ringcap: poll failed on " << m_interface << std::endl;
+            break;
+        }
+        if (m_count && w.packets_written() >= m_count) {
+            break;
+        }
+        if (m_seconds && (Timestamp::now() - start).tv_sec >= m_seconds) {
+            break;
+        }
+    }
+    w.flush();
+
+    std::cout << w.path() << ": written," << w.packets_written()
+              << ",blocks," << w.blocks_read()
+              << ",bytes," << w.bytes_read()
+              << "," << w.stats() << std::endl;
+    return EXIT_SUCCESS;
+}
+
+int
+main(int argc, const char *argv[])
+{
+    try {
+        RingCapApp app(argc, argv);
+
+        return app.run();
+    } catch (const std::exception &e) {
+        std::cerr << "Exception caught: " << e.what() << std::endl;
+    }
+    return 1;
+}
@@ -179,6 +179,7 @@ void SeqnumCapApp::record_seqnums_from_live()
     auto exchcfg = mdcfg->copy_prefix_domain("exchanges.");
 
     m_md_pollers.init(*mdcfg);
+    m_md_pollers.configure_pollers(*mdcfg);
 
     auto pitch_family = std::vector<MIC>{{MICEnum::BATS, MICEnum::BATY, MICEnum::EDGX, MICEnum::EDGA}};
     for (const auto& m : pitch_family) {
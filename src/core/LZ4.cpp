@@ -1,8 +1,14 @@
+#include <endian.h>
 #include <string.h>
 
+#include <algorithm>
+#include <condition_variable>
 #include <stdexcept>
 #include <cstdint>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
 
 #include <lz4.h>
 #include <lz4frame.h>
@@ -16,17 +22,119 @@
 
 namespace i01 { namespace core { namespace LZ4 {
 
+namespace {
+
+/// XXH32, which the frame format uses for its header, block and content
+/// checksums; liblz4 does not export its own.
+class XXH32 {
+    static const std::uint32_t PRIME1 = 2654435761U;
+    static const std::uint32_t PRIME2 = 2246822519U;
+    static const std::uint32_t PRIME3 = 3266489917U;
+    static const std::uint32_t PRIME4 = 668265263U;
+    static const std::uint32_t PRIME5 = 374761393U;
+
+    static std::uint32_t rotl_(std::uint32_t v, int r) { return (v << r) | (v >> (32 - r)); }
+    static std::uint32_t load_(const std::uint8_t *p)
+    {
+        std::uint32_t v;
+        ::memcpy(&v, p, sizeof(v));
+        return le32toh(v);
+    }
+    static std::uint32_t round_(std::uint32_t acc, std::uint32_t in) { return rotl_(acc + in * PRIME2, 13) * PRIME1; }
+
+    void stripe_(const std::uint8_t *p)
+    {
+        for (int i = 0; i < 4; ++i)
+            m_v[i] = round_(m_v[i], load_(p + 4 * i));
+    }
+
+public:
+    XXH32() { reset(); }
+
+    void reset()
+    {
+        m_v[0] = PRIME1 + PRIME2;
+        m_v[1] = PRIME2;
+        m_v[2] = 0;
+        m_v[3] = -PRIME1;
+        m_total = 0;
+        m_buffered = 0;
+    }
+
+    void update(const void *data, size_t n)
+    {
+        const std::uint8_t *p = static_cast<const std::uint8_t *>(data);
+        m_total += n;
+        if (m_buffered > 0) {
+            size_t k = std::min(n, sizeof(m_buf) - m_buffered);
+            ::memcpy(m_buf + m_buffered, p, k);
+            m_buffered += k;
+            p += k;
+            n -= k;
+            if (m_buffered < sizeof(m_buf))
+                return;
+            stripe_(m_buf);
+            m_buffered = 0;
+        }
+        for (; n >= sizeof(m_buf); p += sizeof(m_buf), n -= sizeof(m_buf))
+            stripe_(p);
+        ::memcpy(m_buf, p, n);
+        m_buffered = n;
+    }
+
+    std::uint32_t digest() const
+    {
+        std::uint32_t h = m_total >= sizeof(m_buf)
+                        ? rotl_(m_v[0], 1) + rotl_(m_v[1], 7) + rotl_(m_v[2], 12) + rotl_(m_v[3], 18)
+                        : m_v[2] + PRIME5;
+        h += static_cast<std::uint32_t>(m_total);
+        const std::uint8_t *p = m_buf;
+        size_t n = m_buffered;
+        for (; n >= 4; p += 4, n -= 4)
+            h = rotl_(h + load_(p) * PRIME3, 17) * PRIME4;
+        for (; n > 0; ++p, --n)
+            h = rotl_(h + *p * PRIME5, 11) * PRIME1;
+        h ^= h >> 15;
+        h *= PRIME2;
+        h ^= h >> 13;
+        h *= PRIME3;
+        h ^= h >> 16;
+        return h;
+    }
+
+    static std::uint32_t digest(const void *data, size_t n)
+    {
+        XXH32 h;
+        h.update(data, n);
+        return h.digest();
+    }
+
+private:
+    std::uint32_t m_v[4];
+    std::uint64_t m_total;
+    std::uint8_t m_buf[16];
+    size_t m_buffered;
+};
+
+}
+
 class FrameDecompressionCtx {
     LZ4F_decompressionContext_t m_dctx_p;
-public:
-    FrameDecompressionCtx() : m_dctx_p(nullptr) {
+
+    void create()
+    {
         auto err = LZ4F_createDecompressionContext(&m_dctx_p, LZ4F_VERSION);
         if (LZ4F_isError(err)) {
             if (m_dctx_p != nullptr)
                 LZ4F_freeDecompressionContext(m_dctx_p);
+            m_dctx_p = nullptr;
             throw std::runtime_error(LZ4F_getErrorName(err));
         }
     }
+public:
+    FrameDecompressionCtx() : m_dctx_p(nullptr) {
+        create();
+    }
     virtual ~FrameDecompressionCtx()
     {
         auto err = LZ4F_freeDecompressionContext(m_dctx_p);
@@ -34,94 +142,736 @@ public:
             std::cerr << "LZ4::~FrameDecompressionCtx: " << LZ4F_getErrorName(err) << std::endl;
     }
 
+    /// Forget any partially decoded frame.
+    void reset()
+    {
+        LZ4F_freeDecompressionContext(m_dctx_p);
+        m_dctx_p = nullptr;
+        create();
+    }
+
     LZ4F_decompressionContext_t get() { return m_dctx_p; }
 };
 
+/// Independent blocks, queued in file order, decompressed by a pool of
+/// threads into a ring of buffers and taken back in the same order.
+/// Only the reading thread queues and takes.
+class BlockPipeline {
+public:
+    struct Job {
+        const char *src;
+        size_t len;
+        bool raw;
+        size_t max_size;
+        std::uint64_t frame_offset;
+        std::uint64_t block_offset;
+        bool first_in_frame;
+        /// Set for the end mark of a frame with a content checksum, which
+        /// is queued too so that the reader can check it in order.
+        bool end_mark;
+        /// Whether the frame has a content checksum.
+        bool content_checksum;
+        /// Whether checksum is to be checked: the block's, or the frame's
+        /// content checksum for an end mark.
+        bool checksum_present;
+        std::uint32_t checksum;
+        /// File offset after the block.
+        size_t next_offset;
+    };
+    struct Slot {
+        Job job;
+        std::vector<char> block;
+        /// Decompressed length, or < 0 if the block is corrupt.
+        int n;
+        bool done;
+    };
+
+    explicit BlockPipeline(const ReadAhead& ra)
+        : m_slots(std::max(ra.queue_depth, 1u))
+        , m_head(0)
+        , m_claimed(0)
+        , m_tail(0)
+        , m_stop(false)
+    {
+        for (unsigned i = 0; i < ra.workers; ++i)
+            m_threads.emplace_back(&BlockPipeline::work_, this);
+    }
+
+    ~BlockPipeline()
+    {
+        {
+            std::lock_guard<std::mutex> l(m_mutex);
+            m_stop = true;
+        }
+        m_work_cv.notify_all();
+        for (auto& t : m_threads)
+            t.join();
+    }
+
+    /// The stored bytes of a block against its checksum, if it has one.
+    static bool block_checksum_ok(const Job& job)
+    {
+        return !job.checksum_present || XXH32::digest(job.src, job.len) == job.checksum;
+    }
+
+    bool empty() const { return m_head == m_tail; }
+    bool full() const { return m_tail - m_head == m_slots.size(); }
+
+    void push(const Job& job)
+    {
+        {
+            std::lock_guard<std::mutex> l(m_mutex);
+            Slot& s = slot_(m_tail);
+            s.job = job;
+            s.done = false;
+            ++m_tail;
+        }
+        m_work_cv.notify_one();
+    }
+
+    /// The oldest block, once decompressed.  Must not be empty().
+    Slot& front()
+    {
+        std::unique_lock<std::mutex> l(m_mutex);
+        Slot& s = slot_(m_head);
+        m_done_cv.wait(l, [&s] { return s.done; });
+        return s;
+    }
+
+    void pop() { ++m_head; }
+
+    /// Drop every queued block, waiting out those being decompressed.
+    void clear()
+    {
+        std::unique_lock<std::mutex> l(m_mutex);
+        m_tail = m_claimed;
+        m_done_cv.wait(l, [this] {
+            for (std::uint64_t i = m_head; i < m_tail; ++i) {
+                if (!slot_(i).done)
+                    return false;
+            }
+            return true;
+        });
+        m_head = m_tail;
+    }
+
+private:
+    Slot& slot_(std::uint64_t i) { return m_slots[i % m_slots.size()]; }
+
+    static void decompress_(Slot& s)
+    {
+        if (s.job.end_mark) {
+            s.n = 0;
+            return;
+        }
+        if (s.block.size() < s.job.max_size)
+            s.block.resize(s.job.max_size);
+        if (!block_checksum_ok(s.job)) {
+            s.n = -1;
+        } else if (s.job.raw) {
+            ::memcpy(s.block.data(), s.job.src, s.job.len);
+            s.n = static_cast<int>(s.job.len);
+        } else {
+            s.n = ::LZ4_decompress_safe(s.job.src, s.block.data(), static_cast<int>(s.job.len), static_cast<int>(s.job.max_size));
+        }
+    }
+
+    void work_()
+    {
+        std::unique_lock<std::mutex> l(m_mutex);
+        while (true) {
+            m_work_cv.wait(l, [this] { return m_stop || m_claimed != m_tail; });
+            if (m_stop)
+                return;
+            Slot& s = slot_(m_claimed++);
+            l.unlock();
+            decompress_(s);
+            l.lock();
+            s.done = true;
+            m_done_cv.notify_one();
+        }
+    }
+
+private:
+    std::vector<Slot> m_slots;
+    /// Counts of blocks taken, handed to a worker, and queued.
+    std::uint64_t m_head;
+    std::uint64_t m_claimed;
+    std::uint64_t m_tail;
+    bool m_stop;
+    std::mutex m_mutex;
+    std::condition_variable m_work_cv;
+    std::condition_variable m_done_cv;
+    std::vector<std::thread> m_threads;
+};
+
+/// Decodes one frame at a time.  Frames with independent blocks are
+/// decoded a block at a time with LZ4_decompress_safe(), so that reading
+/// can later restart at any block, and given a ReadAhead are decoded on
+/// its workers; other frames go through LZ4F and can only be restarted at
+/// the frame header.  Header and block checksums are verified wherever the
+/// frame or block is decoded, content checksums by the reader as it takes
+/// the blocks in order, unless it started part way into the frame.
 class FileReaderImpl : protected MappedRegion {
+    static const std::uint32_t FRAME_MAGIC_NUMBER = 0x184D2204;
+    static const std::uint32_t SKIPPABLE_MAGIC_MASK = 0xFFFFFFF0;
+    static const std::uint32_t SKIPPABLE_MAGIC_NUMBER = 0x184D2A50;
+    static const std::uint32_t UNCOMPRESSED_BLOCK = 0x80000000;
+
+    enum class State {
+        FRAME_HEADER,
+        BLOCKS,
+        STREAM,
+        /// Blocks come from m_pipeline.
+        PIPELINE,
+        END,
+        ERROR,
+    };
+
+    struct Frame {
+        std::uint64_t offset;
+        std::size_t header_size;
+        std::size_t max_block_size;
+        bool block_checksum;
+        bool content_checksum;
+        bool independent;
+    };
+
+    enum class Header {
+        FRAME,
+        END,
+        ERROR,
+    };
+
+    enum class Block {
+        DATA,
+        END_MARK,
+        ERROR,
+    };
+
+    /// Where the read-ahead has got to.
+    enum class ScanState {
+        IDLE,
+        BLOCKS,
+        FRAME_HEADER,
+        /// Stopped at a frame with linked blocks, for the reader to decode.
+        LINKED,
+        END,
+        ERROR,
+    };
+
     FrameDecompressionCtx m_ctx;
+    State m_state;
+    Frame m_frame;
     size_t m_compressed_offset;
-    size_t m_decompressed_bytes;
-    size_t m_next_frame_size;
-    bool m_ready;
+    std::vector<char> m_block;
+    size_t m_block_len;
+    size_t m_block_pos;
+    /// Offset of m_block[0] in the decompressed stream.
+    std::uint64_t m_block_start;
+    std::vector<Checkpoint> m_checkpoints;
+
+    std::unique_ptr<BlockPipeline> m_pipeline;
+    ScanState m_scan_state;
+    Frame m_scan_frame;
+    size_t m_scan_offset;
+    bool m_scan_first;
+
+    /// Of the current frame's content so far, if it has a content
+    /// checksum and was read from its first block.
+    XXH32 m_content_hash;
+    bool m_content_hashed;
+
+    std::uint32_t load32_(size_t off) const
+    {
+        std::uint32_t v;
+        ::memcpy(&v, data<const char>() + off, sizeof(v));
+        return le32toh(v);
+    }
+
+    size_t remaining_() const { return size() - m_compressed_offset; }
+
+    void checkpoint_(std::uint64_t compressed_offset, std::uint64_t frame_offset)
+    {
+        Checkpoint cp{m_block_start + m_block_len, compressed_offset, frame_offset};
+        if (m_checkpoints.empty() || m_checkpoints.back().decompressed_offset < cp.decompressed_offset) {
+            m_checkpoints.push_back(cp);
+            return;
+        }
+        auto it = std::lower_bound(m_checkpoints.begin(), m_checkpoints.end(), cp,
+                [](const Checkpoint& a, const Checkpoint& b) { return a.decompressed_offset < b.decompressed_offset; });
+        if (it == m_checkpoints.end() || it->decompressed_offset != cp.decompressed_offset)
+            m_checkpoints.insert(it, cp);
+    }
+
+    /// Parse the frame header at offset into f, first skipping skippable
+    /// frames.
+    Header parse_frame_header_(size_t offset, Frame& f) const
+    {
+        while (true) {
+            const size_t remaining = size() - offset;
+            if (remaining == 0)
+                return Header::END;
+            if (remaining < sizeof(std::uint32_t))
+                return Header::ERROR;
+            std::uint32_t magic_number = load32_(offset);
+            if ((magic_number & SKIPPABLE_MAGIC_MASK) == SKIPPABLE_MAGIC_NUMBER) {
+                if (remaining < 2 * sizeof(std::uint32_t))
+                    return Header::ERROR;
+                size_t skip = 2 * sizeof(std::uint32_t) + load32_(offset + sizeof(std::uint32_t));
+                if (remaining < skip)
+                    return Header::ERROR;
+                offset += skip;
+                continue;
+            }
+            if (magic_number != FRAME_MAGIC_NUMBER || remaining < 7)
+                return Header::ERROR;
+            break;
+        }
+        const std::uint8_t *hdr = data<const std::uint8_t>() + offset;
+        std::uint8_t flg = hdr[4];
+        std::uint8_t bd = hdr[5];
+        unsigned block_max = (bd >> 4) & 0x07;
+        if ((flg >> 6) != 0x01 || block_max < 4)
+            return Header::ERROR;
+
+        f.offset = offset;
+        f.header_size = 7 + ((flg & 0x08) ? 8 : 0) + ((flg & 0x01) ? 4 : 0);
+        f.max_block_size = size_t(1) << (8 + 2 * block_max);
+        f.block_checksum = flg & 0x10;
+        f.content_checksum = flg & 0x04;
+        // independent blocks, no dictionary:
+        f.independent = (flg & 0x20) && !(flg & 0x01);
+        if (size() - offset < f.header_size)
+            return Header::ERROR;
+        // the descriptor's checksum is the second byte of its XXH32:
+        if (hdr[f.header_size - 1] != ((XXH32::digest(hdr + 4, f.header_size - 5) >> 8) & 0xFF))
+            return Header::ERROR;
+        return Header::FRAME;
+    }
+
+    /// Parse the block header at offset in frame f into job, setting
+    /// job.next_offset past the block (or the end mark).
+    Block parse_block_(size_t offset, const Frame& f, BlockPipeline::Job& job) const
+    {
+        if (size() - offset < sizeof(std::uint32_t))
+            return Block::ERROR;
+        std::uint32_t block_size = load32_(offset);
+        job.next_offset = offset + sizeof(std::uint32_t);
+        job.frame_offset = f.offset;
+        job.block_offset = offset;
+        job.first_in_frame = false;
+        job.content_checksum = f.content_checksum;
+        job.checksum_present = false;
+        job.checksum = 0;
+        if (block_size == 0) {
+            job.src = nullptr;
+            job.len = 0;
+            job.raw = false;
+            job.max_size = 0;
+            job.end_mark = true;
+            if (f.content_checksum) {
+                if (size() - job.next_offset < sizeof(std::uint32_t))
+                    return Block::ERROR;
+                job.checksum_present = true;
+                job.checksum = load32_(job.next_offset);
+                job.next_offset += sizeof(std::uint32_t);
+            }
+            return Block::END_MARK;
+        }
+        size_t len = block_size & ~UNCOMPRESSED_BLOCK;
+        if (len > f.max_block_size || size() - job.next_offset < len + (f.block_checksum ? sizeof(std::uint32_t) : 0))
+            return Block::ERROR;
+        job.src = data<const char>() + job.next_offset;
+        job.len = len;
+        job.raw = block_size & UNCOMPRESSED_BLOCK;
+        job.max_size = f.max_block_size;
+        job.end_mark = false;
+        job.next_offset += len;
+        if (f.block_checksum) {
+            job.checksum_present = true;
+            job.checksum = load32_(job.next_offset);
+            job.next_offset += sizeof(std::uint32_t);
+        }
+        return Block::DATA;
+    }
+
+    /// Parse the frame header at m_compressed_offset, skipping skippable
+    /// frames.  The current block must have been consumed.
+    bool frame_header_()
+    {
+        switch (parse_frame_header_(m_compressed_offset, m_frame)) {
+            case Header::FRAME:
+                break;
+            case Header::END:
+                m_compressed_offset = size();
+                m_state = State::END;
+                return false;
+            case Header::ERROR:
+            default:
+                return error_();
+        }
+        m_compressed_offset = m_frame.offset;
+        if (m_block.size() < m_frame.max_block_size)
+            m_block.resize(m_frame.max_block_size);
+
+        if (m_frame.independent && m_pipeline) {
+            // the read-ahead takes it from here, checkpointing the frame
+            // with its first block:
+            m_scan_frame = m_frame;
+            m_scan_offset = m_frame.offset + m_frame.header_size;
+            m_scan_first = true;
+            m_scan_state = ScanState::BLOCKS;
+            m_state = State::PIPELINE;
+            return true;
+        }
+        checkpoint_(m_compressed_offset, m_frame.offset);
+        if (m_frame.independent) {
+            start_content_hash_(m_frame.content_checksum);
+            m_compressed_offset += m_frame.header_size;
+            m_state = State::BLOCKS;
+        } else {
+            // LZ4F reads the header itself.
+            m_ctx.reset();
+            m_state = State::STREAM;
+        }
+        return true;
+    }
+
+    bool block_()
+    {
+        BlockPipeline::Job job;
+        switch (parse_block_(m_compressed_offset, m_frame, job)) {
+            case Block::DATA:
+                break;
+            case Block::END_MARK:
+                if (!content_checksum_ok_(job))
+                    return error_();
+                m_compressed_offset = job.next_offset;
+                m_state = State::FRAME_HEADER;
+                return true;
+            case Block::ERROR:
+            default:
+                return error_();
+        }
+        checkpoint_(job.block_offset, m_frame.offset);
+        if (!BlockPipeline::block_checksum_ok(job))
+            return error_();
+
+        int n = 0;
+        if (job.raw) {
+            ::memcpy(m_block.data(), job.src, job.len);
+            n = static_cast<int>(job.len);
+        } else {
+            n = ::LZ4_decompress_safe(job.src, m_block.data(), static_cast<int>(job.len), static_cast<int>(m_frame.max_block_size));
+            if (n < 0)
+                return error_();
+        }
+        hash_content_(m_block.data(), static_cast<size_t>(n));
+        m_block_start += m_block_len;
+        m_block_len = static_cast<size_t>(n);
+        m_block_pos = 0;
+        m_compressed_offset = job.next_offset;
+        return true;
+    }
+
+    /// Queue blocks for the read-ahead until it is full, or stops at a
+    /// frame it can not split.
+    void scan_()
+    {
+        while (!m_pipeline->full()) {
+            if (m_scan_state == ScanState::FRAME_HEADER) {
+                switch (parse_frame_header_(m_scan_offset, m_scan_frame)) {
+                    case Header::FRAME:
+                        if (!m_scan_frame.independent) {
+                            m_scan_offset = m_scan_frame.offset;
+                            m_scan_state = ScanState::LINKED;
+                            return;
+                        }
+                        m_scan_offset = m_scan_frame.offset + m_scan_frame.header_size;
+                        m_scan_first = true;
+                        m_scan_state = ScanState::BLOCKS;
+                        break;
+                    case Header::END:
+                        m_scan_offset = size();
+                        m_scan_state = ScanState::END;
+                        return;
+                    case Header::ERROR:
+                    default:
+                        m_scan_state = ScanState::ERROR;
+                        return;
+                }
+            } else if (m_scan_state == ScanState::BLOCKS) {
+                BlockPipeline::Job job;
+                switch (parse_block_(m_scan_offset, m_scan_frame, job)) {
+                    case Block::DATA:
+                        job.first_in_frame = m_scan_first;
+                        m_scan_first = false;
+                        m_pipeline->push(job);
+                        break;
+                    case Block::END_MARK:
+                        if (job.checksum_present)
+                            m_pipeline->push(job);
+                        m_scan_state = ScanState::FRAME_HEADER;
+                        break;
+                    case Block::ERROR:
+                    default:
+                        m_scan_state = ScanState::ERROR;
+                        return;
+                }
+                m_scan_offset = job.next_offset;
+            } else {
+                return;
+            }
+        }
+    }
+
+    /// Take the next block from the read-ahead.
+    bool pipeline_()
+    {
+        scan_();
+        if (m_pipeline->empty()) {
+            switch (m_scan_state) {
+                case ScanState::LINKED:
+                    m_compressed_offset = m_scan_offset;
+                    m_scan_state = ScanState::IDLE;
+                    m_state = State::FRAME_HEADER;
+                    return true;
+                case ScanState::END:
+                    m_compressed_offset = m_scan_offset;
+                    m_state = State::END;
+                    return false;
+                case ScanState::ERROR:
+                default:
+                    return error_();
+            }
+        }
+        BlockPipeline::Slot& s = m_pipeline->front();
+        if (s.n < 0)
+            return error_();
+        if (s.job.end_mark) {
+            if (!content_checksum_ok_(s.job))
+                return error_();
+            m_pipeline->pop();
+            return true;
+        }
+        if (s.job.first_in_frame) {
+            checkpoint_(s.job.frame_offset, s.job.frame_offset);
+            start_content_hash_(s.job.content_checksum);
+        }
+        checkpoint_(s.job.block_offset, s.job.frame_offset);
+        hash_content_(s.block.data(), static_cast<size_t>(s.n));
+        m_block.swap(s.block);
+        m_block_start += m_block_len;
+        m_block_len = static_cast<size_t>(s.n);
+        m_block_pos = 0;
+        m_compressed_offset = s.job.next_offset;
+        m_pipeline->pop();
+        // keep the workers busy while this block is read:
+        scan_();
+        return true;
+    }
+
+    bool stream_()
+    {
+        size_t sn = remaining_();
+        size_t dn = m_block.size();
+        size_t next = LZ4F_decompress( m_ctx.get()
+                                     , m_block.data(), &dn
+                                     , data<const char>() + m_compressed_offset, &sn
+                                     , nullptr);
+        if (LZ4F_isError(next))
+            return error_();
+        m_compressed_offset += sn;
+        m_block_start += m_block_len;
+        m_block_len = dn;
+        m_block_pos = 0;
+        if (next == 0) {
+            m_state = State::FRAME_HEADER;
+        } else if (remaining_() == 0 && dn == 0) {
+            // truncated frame
+            m_state = State::END;
+            return false;
+        }
+        return true;
+    }
+
+    bool error_()
+    {
+        m_state = State::ERROR;
+        return false;
+    }
+
+    void start_content_hash_(bool content_checksum)
+    {
+        m_content_hash.reset();
+        m_content_hashed = content_checksum;
+    }
+
+    void hash_content_(const char *p, size_t n)
+    {
+        if (m_content_hashed)
+            m_content_hash.update(p, n);
+    }
+
+    /// At the end mark in job: true unless the frame has a content
+    /// checksum, all of its content went through m_content_hash, and they
+    /// differ.
+    bool content_checksum_ok_(const BlockPipeline::Job& job)
+    {
+        bool ok = !job.checksum_present || !m_content_hashed || m_content_hash.digest() == job.checksum;
+        m_content_hashed = false;
+        return ok;
+    }
+
+    /// Decode until the block holds unread bytes.
+    bool fill_()
+    {
+        while (m_block_pos == m_block_len) {
+            bool ok = false;
+            switch (m_state) {
+                case State::FRAME_HEADER:
+                    ok = frame_header_();
+                    break;
+                case State::BLOCKS:
+                    ok = block_();
+                    break;
+                case State::STREAM:
+                    ok = stream_();
+                    break;
+                case State::PIPELINE:
+                    ok = pipeline_();
+                    break;
+                case State::END:
+                case State::ERROR:
+                default:
+                    break;
+            }
+            if (!ok)
+                return false;
+        }
+        return true;
+    }
+
+    /// Start over at cp with nothing buffered.
+    bool restart_(const Checkpoint& cp)
+    {
+        if (m_pipeline)
+            m_pipeline->clear();
+        m_scan_state = ScanState::IDLE;
+        m_block_start = cp.decompressed_offset;
+        m_block_len = 0;
+        m_block_pos = 0;
+        m_compressed_offset = cp.frame_offset;
+        m_state = State::FRAME_HEADER;
+        if (!frame_header_())
+            return false;
+        if (cp.compressed_offset != cp.frame_offset) {
+            // the content before cp is not hashed:
+            m_content_hashed = false;
+            if (m_state == State::PIPELINE) {
+                m_scan_offset = cp.compressed_offset;
+                m_scan_first = false;
+            } else if (m_state == State::BLOCKS) {
+                m_compressed_offset = cp.compressed_offset;
+            } else {
+                return error_();
+            }
+        }
+        return true;
+    }
+
 public:
-    FileReaderImpl(const std::string& path)
+    FileReaderImpl(const std::string& path, const ReadAhead& ra)
         : MappedRegion(path, 0, /* ro = */ true)
         , m_ctx()
+        , m_state(State::FRAME_HEADER)
+        , m_frame{0, 0, 0, false, false, false}
         , m_compressed_offset(0)
-        , m_decompressed_bytes(0)
-        , m_next_frame_size(0)
-        , m_ready(false)
+        , m_block_len(0)
+        , m_block_pos(0)
+        , m_block_start(0)
+        , m_pipeline(ra.workers > 0 ? new BlockPipeline(ra) : nullptr)
+        , m_scan_state(ScanState::IDLE)
+        , m_scan_frame{0, 0, 0, false, false, false}
+        , m_scan_offset(0)
+        , m_scan_first(false)
+        , m_content_hash()
+        , m_content_hashed(false)
     {
         if (!mapped())
             throw std::runtime_error("could not map LZ4 file");
 
-        std::uint32_t magic_number = *data<std::uint32_t>();
-        if (magic_number != 0x184D2204)
+        if (size() < sizeof(std::uint32_t))
+            throw bad_magic_number(0);
+        std::uint32_t magic_number = load32_(0);
+        if (magic_number != FRAME_MAGIC_NUMBER)
             throw bad_magic_number(magic_number);
-
-        //LZ4F_frameInfo_t info;
-        //::memset(&info, 0, sizeof(info));
-        //size_t n = sizeof(magic_number);
-        //size_t m = 0;
-        //m_next_frame_size = LZ4F_decompress(m_ctx.get(), nullptr, &m, data<const void*>(), &n, nullptr);
-        //if (LZ4F_isError(m_next_frame_size))
-        //    throw std::runtime_error(LZ4F_getErrorName(m_next_frame_size));
-        //m_next_frame_size = LZ4F_getFrameInfo(m_ctx.get(), &info, data<const char*>(), &n);
-        //if (LZ4F_isError(m_next_frame_size))
-        //    throw std::runtime_error(LZ4F_getErrorName(m_next_frame_size));
-        //m_compressed_offset += n;
-        m_ready = true;
     }
 
     virtual ~FileReaderImpl()
     {
     }
 
-    bool opened() const { return m_ready && mapped(); }
+    bool opened() const { return m_state != State::ERROR && mapped(); }
 
     ssize_t read(char * buf, size_t maxlen)
     {
-        if (m_compressed_offset >= size())
-            return 0;
-        if (!opened() || LZ4F_isError(m_next_frame_size)) {
+        if (m_state == State::ERROR)
             return -1;
-        }
         size_t n = 0;
         while (n < maxlen) {
-            size_t sn = size() - m_compressed_offset;
-            // optimization:
-            if (m_next_frame_size > 0 && m_next_frame_size < size() - m_compressed_offset)
-                sn = m_next_frame_size;
-
-            size_t dn = maxlen - n;
-            m_next_frame_size = LZ4F_decompress( m_ctx.get()
-                                               , &buf[n], &dn
-                                               , data<const char>() + m_compressed_offset, &sn
-                                               , nullptr);
-            n += dn;
-            if (LZ4F_isError(m_next_frame_size)) {
-                if (n > 0) {
-                    return n;
-                } else {
-                    return -1;
-                }
-            }
-            if (dn == 0 || sn == 0) {
-                return n;
-            }
-            if (sn > 0)
-                m_compressed_offset += sn;
-            m_decompressed_bytes += dn;
+            if (!fill_())
+                break;
+            size_t k = std::min(maxlen - n, m_block_len - m_block_pos);
+            ::memcpy(&buf[n], m_block.data() + m_block_pos, k);
+            m_block_pos += k;
+            n += k;
+        }
+        if (n == 0 && m_state == State::ERROR)
+            return -1;
+        return static_cast<ssize_t>(n);
+    }
+
+    std::uint64_t tell() const { return m_block_start + m_block_pos; }
+
+    bool seek(std::uint64_t offset)
+    {
+        auto it = std::upper_bound(m_checkpoints.begin(), m_checkpoints.end(), offset,
+                [](std::uint64_t o, const Checkpoint& cp) { return o < cp.decompressed_offset; });
+        if (offset < tell() || m_state == State::ERROR
+            || (it != m_checkpoints.begin() && (it - 1)->decompressed_offset > tell())) {
+            bool ok = (it == m_checkpoints.begin())
+                    ? restart_(Checkpoint{0, 0, 0})
+                    : restart_(*(it - 1));
+            if (!ok)
+                return false;
+        }
+        while (tell() < offset) {
+            if (!fill_())
+                return false;
+            m_block_pos += std::min<std::uint64_t>(offset - tell(), m_block_len - m_block_pos);
         }
-        return n;
+        return true;
+    }
+
+    const std::vector<Checkpoint>& checkpoints() const { return m_checkpoints; }
+
+    void checkpoints(const std::vector<Checkpoint>& cps)
+    {
+        m_checkpoints.insert(m_checkpoints.end(), cps.begin(), cps.end());
+        auto lt = [](const Checkpoint& a, const Checkpoint& b) { return a.decompressed_offset < b.decompressed_offset; };
+        auto eq = [](const Checkpoint& a, const Checkpoint& b) { return a.decompressed_offset == b.decompressed_offset; };
+        std::stable_sort(m_checkpoints.begin(), m_checkpoints.end(), lt);
+        m_checkpoints.erase(std::unique(m_checkpoints.begin(), m_checkpoints.end(), eq), m_checkpoints.end());
     }
 
     size_t compressed_offset() const { return m_compressed_offset; }
-    size_t decompressed_bytes() const { return m_decompressed_bytes; }
+    size_t decompressed_bytes() const { return tell(); }
 };
 
-FileReader::FileReader(const std::string& path)
-    : m_impl_p(new FileReaderImpl(path))
+FileReader::FileReader(const std::string& path, const ReadAhead& ra)
+    : m_impl_p(new FileReaderImpl(path, ra))
 {
 }
 
@@ -136,4 +886,12 @@ ssize_t FileReader::read(char * buf, size_t maxlen)
     return m_impl_p->read(buf, maxlen);
 }
 
+std::uint64_t FileReader::tell() const { return m_impl_p->tell(); }
+
+bool FileReader::seek(std::uint64_t offset) { return m_impl_p->seek(offset); }
+
+const std::vector<Checkpoint>& FileReader::checkpoints() const { return m_impl_p->checkpoints(); }
+
+void FileReader::checkpoints(const std::vector<Checkpoint>& cps) { m_impl_p->checkpoints(cps); }
+
 } } }
@@ -145,7 +145,7 @@ class FileReaderImpl : public std::enable_shared_from_this<FileReaderImpl> {
     }
 public:
 
-    FileReaderImpl(const std::string& path, char * errbuf)
+    FileReaderImpl(const std::string& path, char * errbuf, const LZ4::ReadAhead& ra)
         : m_filetype(FILETYPE_UNKNOWN)
         , m_lz4reader(nullptr)
         , m_pcap_p(nullptr)
@@ -156,7 +156,7 @@ public:
             throw std::runtime_error("missing path.");
         // lz4 compressed
         try {
-            m_lz4reader = new LZ4Reader(path);
+            m_lz4reader = new LZ4Reader(path, ra);
             ssize_t n = m_lz4reader->read((char *)&m_pcap_sf_fhdr, sizeof(m_pcap_sf_fhdr));
             if (sizeof(m_pcap_sf_fhdr) == n) {
                 // NB: does not support "swapped" (big endian)
@@ -243,12 +243,43 @@ public:
 
     const char * geterr() { return ::pcap_geterr(m_pcap_p); }
 
+    std::uint64_t tell() const
+    {
+        if (m_lz4reader)
+            return m_lz4reader->tell();
+        off_t o = ::ftello(::pcap_file(m_pcap_p));
+        return o < 0 ? 0 : static_cast<std::uint64_t>(o);
+    }
+
+    bool seek(std::uint64_t offset)
+    {
+        // records start after the file header:
+        if (offset < sizeof(pcap_file_header))
+            return false;
+        if (m_lz4reader)
+            return m_lz4reader->seek(offset);
+        return 0 == ::fseeko(::pcap_file(m_pcap_p), static_cast<off_t>(offset), SEEK_SET);
+    }
+
+    bool compressed() const { return m_lz4reader != nullptr; }
+
+    std::vector<LZ4::Checkpoint> checkpoints() const
+    {
+        return m_lz4reader ? m_lz4reader->checkpoints() : std::vector<LZ4::Checkpoint>();
+    }
+
+    void checkpoints(const std::vector<LZ4::Checkpoint>& cps)
+    {
+        if (m_lz4reader)
+            m_lz4reader->checkpoints(cps);
+    }
+
     pcap_t *get_pcap_t_ptr() { return m_pcap_p; }
 };
 
 
-FileReader::FileReader(const std::string& path, char *errbuf)
-    : m_impl_p(new FileReaderImpl(path, errbuf))
+FileReader::FileReader(const std::string& path, char *errbuf, const LZ4::ReadAhead& ra)
+    : m_impl_p(new FileReaderImpl(path, errbuf, ra))
 {
 }
 
@@ -265,6 +296,23 @@ int FileReader::next_ex(struct pcap_pkthdr **hp, const u_char **dp)
 
 const char * FileReader::geterr() const { return m_impl_p ? m_impl_p->geterr() : nullptr; }
 
+std::uint64_t FileReader::tell() const { return m_impl_p ? m_impl_p->tell() : 0; }
+
+bool FileReader::seek(std::uint64_t offset) { return m_impl_p ? m_impl_p->seek(offset) : false; }
+
+bool FileReader::compressed() const { return m_impl_p ? m_impl_p->compressed() : false; }
+
+std::vector<LZ4::Checkpoint> FileReader::checkpoints() const
+{
+    return m_impl_p ? m_impl_p->checkpoints() : std::vector<LZ4::Checkpoint>();
+}
+
+void FileReader::checkpoints(const std::vector<LZ4::Checkpoint>& cps)
+{
+    if (m_impl_p)
+        m_impl_p->checkpoints(cps);
+}
+
 void * FileReader::get_pcap_t_ptr()
 {
     return m_impl_p ? m_impl_p->get_pcap_t_ptr() : nullptr;
@@ -0,0 +1,247 @@
+#include <cstring>
+
+#include <i01_core/macro.hpp>
+#include <i01_core/TimerWheel.hpp>
+
+namespace i01 { namespace core {
+
+const std::uint64_t TimerWheel::DEFAULT_RESOLUTION_NS;
+const unsigned TimerWheel::LEVELS;
+const unsigned TimerWheel::SLOTS;
+const std::uint64_t TimerWheel::MAX_DELTA;
+const std::uint16_t TimerWheel::NO_SLOT;
+
+TimerWheel::TimerWheel(std::uint64_t resolution_ns)
+    : m_resolution(resolution_ns ? resolution_ns : 1)
+    , m_tick(0)
+    , m_size(0)
+{
+    for (auto& s : m_slots)
+        s.prev = s.next = &s;
+    ::memset(m_occupied, 0, sizeof(m_occupied));
+}
+
+std::uint64_t TimerWheel::to_ns_(const Timestamp& ts)
+{
+    return static_cast<std::uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<std::uint64_t>(ts.tv_nsec);
+}
+
+Timestamp TimerWheel::to_timestamp_(std::uint64_t ns)
+{
+    return Timestamp(static_cast<time_t>(ns / 1000000000ULL), static_cast<long>(ns % 1000000000ULL));
+}
+
+void TimerWheel::unlink_(Node *n)
+{
+    n->prev->next = n->next;
+    n->next->prev = n->prev;
+    n->prev = n->next = n;
+}
+
+void TimerWheel::link_(unsigned slot, Timer *t)
+{
+    Node& head = m_slots[slot];
+    t->prev = head.prev;
+    t->next = &head;
+    head.prev->next = t;
+    head.prev = t;
+    t->slot = static_cast<std::uint16_t>(slot);
+    m_occupied[slot >> 6] |= 1ULL << (slot & 63);
+}
+
+void TimerWheel::take_(unsigned slot, Node& head)
+{
+    Node& s = m_slots[slot];
+    if (list_empty_(s)) {
+        head.prev = head.next = &head;
+        return;
+    }
+    head.next = s.next;
+    head.prev = s.prev;
+    head.next->prev = &head;
+    head.prev->next = &head;
+    s.prev = s.next = &s;
+    m_occupied[slot >> 6] &= ~(1ULL << (slot & 63));
+}
+
+void TimerWheel::reset(const Timestamp& now)
+{
+    for (unsigned i = 0; i < SLOTS; ++i) {
+        Node& s = m_slots[i];
+        while (!list_empty_(s))
+            release_(static_cast<Timer *>(s.next));
+    }
+    m_tick = to_ns_(now) / m_resolution;
+}
+
+TimerWheel::Handle TimerWheel::add(TimerListener& listener, void *userdata, const Timestamp& deadline, const Timestamp& interval)
+{
+    std::uint32_t index;
+    if (m_free.empty()) {
+        index = static_cast<std::uint32_t>(m_timers.size());
+        m_timers.emplace_back();
+        m_timers.back().index = index;
+        m_timers.back().generation = 0;
+    } else {
+        index = m_free.back();
+        m_free.pop_back();
+    }
+    Timer *t = &m_timers[index];
+    t->prev = t->next = t;
+    t->listener = &listener;
+    t->userdata = userdata;
+    t->deadline = to_ns_(deadline);
+    t->interval = to_ns_(interval);
+    t->tick = tick_of_(t->deadline);
+    t->active = true;
+    place_(t, m_tick + 1);
+    ++m_size;
+    return (static_cast<Handle>(t->generation) << 32) | (index + 1);
+}
+
+bool TimerWheel::cancel(Handle h)
+{
+    const std::uint32_t index = static_cast<std::uint32_t>(h & 0xffffffffULL);
+    if (0 == index || index > m_timers.size())
+        return false;
+    Timer *t = &m_timers[index - 1];
+    if (!t->active || t->generation != static_cast<std::uint32_t>(h >> 32))
+        return false;
+    release_(t);
+    return true;
+}
+
+void TimerWheel::release_(Timer *t)
+{
+    const std::uint16_t slot = t->slot;
+    unlink_(t);
+    // a slot being expired has been taken already, and its bit cleared:
+    if (NO_SLOT != slot && list_empty_(m_slots[slot]))
+        m_occupied[slot >> 6] &= ~(1ULL << (slot & 63));
+    t->slot = NO_SLOT;
+    t->active = false;
+    ++t->generation;
+    m_free.push_back(t->index);
+    --m_size;
+}
+
+void TimerWheel::place_(Timer *t, std::uint64_t earliest)
+{
+    const std::uint64_t tick = t->tick > earliest ? t->tick : earliest;
+    std::uint64_t delta = tick - m_tick;
+    if (delta > MAX_DELTA)
+        delta = MAX_DELTA;
+    const std::uint64_t at = m_tick + delta;
+    unsigned level = 0;
+    while (level + 1 < LEVELS && delta >= (1ULL << shift_(level + 1)))
+        ++level;
+    link_(first_slot_(level) + static_cast<unsigned>((at >> shift_(level)) & mask_(level)), t);
+}
+
+std::uint64_t TimerWheel::next_event_() const
+{
+    for (unsigned level = 0; level < LEVELS; ++level) {
+        const unsigned first = first_slot_(level);
+        const unsigned n = static_cast<unsigned>(mask_(level)) + 1;
+        const unsigned cur = static_cast<unsigned>((m_tick >> shift_(level)) & mask_(level));
+        bool any = false;
+        // the first occupied slot after the current one in this rotation:
+        for (unsigned w = first >> 6; w < (first + n) >> 6; ++w) {
+            std::uint64_t bits = m_occupied[w];
+            any = any || bits;
+            const unsigned base = (w << 6) - first;
+            if (base + 63 <= cur)
+                continue;
+            if (base <= cur)
+                bits &= ~0ULL << (cur - base) << 1;
+            if (bits) {
+                const std::uint64_t idx = base + static_cast<unsigned>(__builtin_ctzll(bits));
+                const unsigned s = shift_(level);
+                return (((m_tick >> s) & ~mask_(level)) | idx) << s;
+            }
+        }
+        // what is left here comes round after the next level moves on:
+        if (any)
+            return ((m_tick >> shift_(level + 1)) + 1) << shift_(level + 1);
+    }
+    return 0;
+}
+
+void TimerWheel::cascade_()
+{
+    for (unsigned level = 1; level < LEVELS; ++level) {
+        if (m_tick & ((1ULL << shift_(level)) - 1))
+            break;
+        Node head;
+        take_(first_slot_(level) + static_cast<unsigned>((m_tick >> shift_(level)) & mask_(level)), head);
+        while (!list_empty_(head)) {
+            Timer *t = static_cast<Timer *>(head.next);
+            unlink_(t);
+            place_(t, m_tick);
+        }
+    }
+}
+
+std::size_t TimerWheel::expire_()
+{
+    Node due;
+    take_(static_cast<unsigned>(m_tick & mask_(0)), due);
+    std::size_t fired = 0;
+    while (!list_empty_(due)) {
+        Timer *t = static_cast<Timer *>(due.next);
+        unlink_(t);
+        t->slot = NO_SLOT;
+        if (UNLIKELY(t->tick > m_tick)) {
+            // came round from beyond MAX_DELTA:
+            place_(t, m_tick + 1);
+            continue;
+        }
+        TimerListener *listener = t->listener;
+        void *userdata = t->userdata;
+        std::uint64_t deadline = t->deadline;
+        std::uint64_t iter = 1;
+        if (t->interval) {
+            iter = (m_tick * m_resolution - deadline) / t->interval + 1;
+            deadline += (iter - 1) * t->interval;
+            t->deadline = deadline + t->interval;
+            t->tick = tick_of_(t->deadline);
+            place_(t, m_tick + 1);
+        } else {
+            release_(t);
+        }
+        // t may be reused or cancelled from here:
+        listener->on_timer(to_timestamp_(deadline), userdata, iter);
+        ++fired;
+    }
+    return fired;
+}
+
+std::size_t TimerWheel::advance(const Timestamp& now)
+{
+    const std::uint64_t target = to_ns_(now) / m_resolution;
+    if (0 == m_size) {
+        if (target > m_tick)
+            m_tick = target;
+        return 0;
+    }
+    std::size_t fired = 0;
+    while (m_tick < target) {
+        const std::uint64_t next = next_event_();
+        if (0 == next || next > target) {
+            m_tick = target;
+            break;
+        }
+        m_tick = next;
+        cascade_();
+        fired += expire_();
+    }
+    return fired;
+}
+
+Timestamp TimerWheel::next_due() const
+{
+    const std::uint64_t next = next_event_();
+    return to_timestamp_((next ? next : m_tick) * m_resolution);
+}
+
+} }
@@ -79,8 +79,10 @@ union Alphanumeric {
                 raw[i] = PAD_CHAR;
                 continue;
             }
-            raw[i] = charset[n % BASE];
-            n = static_cast<T>(n - (n % BASE))/BASE;
+            // one division per digit: the remainder from the quotient
+            const T q = static_cast<T>(n / BASE);
+            raw[i] = charset[n - q * BASE];
+            n = q;
         }
         if (UNLIKELY(n != 0)) {
             return false;
@@ -1,6 +1,10 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
 #include <boost/noncopyable.hpp>
 
 namespace i01 { namespace core { namespace LZ4 {
@@ -14,6 +18,29 @@ public:
     std::uint32_t magic_number() { return m_magic_number; }
 };
 
+/// A place in the file where decompression can start over: the start of
+/// a frame, or of a block in a frame with independent blocks.
+struct Checkpoint {
+    /// Offset of the first byte of the block in the decompressed stream.
+    std::uint64_t decompressed_offset;
+    /// File offset of the block (or frame) header.
+    std::uint64_t compressed_offset;
+    /// File offset of the header of the frame holding the block.
+    std::uint64_t frame_offset;
+} __attribute__((packed));
+
+/// Decompression ahead of read(): with workers > 0, the blocks of frames
+/// with independent blocks are decompressed on that many threads, up to
+/// queue_depth blocks ahead of the reader, and handed back in order.
+/// Frames with linked blocks are still decompressed by the reader.
+struct ReadAhead {
+    ReadAhead(unsigned w = 0, unsigned depth = 0)
+      : workers(w)
+      , queue_depth(depth ? depth : 4 * w) {}
+    unsigned workers;
+    unsigned queue_depth;
+};
+
 class FileReaderImpl;
 class FileReader : boost::noncopyable {
     std::unique_ptr<FileReaderImpl> m_impl_p;
@@ -21,11 +48,24 @@ class FileReader : boost::noncopyable {
     FileReader() = delete;
     FileReader(const FileReader&) = delete;
 public:
-    FileReader(const std::string& path);
+    FileReader(const std::string& path, const ReadAhead& ra = ReadAhead());
     virtual ~FileReader();
 
     bool is_open() const;
     ssize_t read(char * buf, size_t maxlen);
+
+    /// Offset in the decompressed stream of the next byte read() returns.
+    std::uint64_t tell() const;
+    /// Continue reading at offset in the decompressed stream, starting
+    /// from the closest checkpoint at or before it.  Returns false if the
+    /// file ends (or is corrupt) before offset.
+    bool seek(std::uint64_t offset);
+
+    /// Checkpoints passed so far, in file order, plus any added with
+    /// checkpoints(); reading the whole file once records all of them.
+    const std::vector<Checkpoint>& checkpoints() const;
+    /// Add checkpoints saved from an earlier reader of the same file.
+    void checkpoints(const std::vector<Checkpoint>& cps);
 };
 
 } } }
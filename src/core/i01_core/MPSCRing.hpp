@@ -0,0 +1,116 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+
+#include <i01_core/macro.hpp>
+
+namespace i01 { namespace core {
+
+/// Bounded multiple producer, single consumer queue of trivially copyable
+/// values.  Storage is allocated once, at construction.
+///
+/// Each slot carries a sequence number that says whose turn it is: a
+/// producer claims a slot with one compare and swap on the tail, writes it,
+/// and then publishes it by advancing the slot's sequence; the consumer
+/// reads only slots whose sequence says they are published.  No producer
+/// ever waits for another, except for the slot it has claimed.
+template <typename T>
+class MPSCRing {
+public:
+    static_assert(std::is_trivially_copyable<T>::value, "MPSCRing: T must be trivially copyable");
+
+    typedef T value_type;
+
+public:
+    /// capacity is rounded up to a power of two.
+    explicit MPSCRing(std::size_t capacity)
+        : m_mask(round_up_(capacity) - 1), m_slots(new Slot[m_mask + 1]),
+          m_head(0), m_tail(0)
+    {
+        for (std::uint64_t i = 0; i <= m_mask; ++i) {
+            m_slots[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+    MPSCRing(const MPSCRing &) = delete;
+    MPSCRing & operator=(const MPSCRing &) = delete;
+
+    std::size_t capacity() const { return m_mask + 1; }
+
+    /// Approximate.
+    std::size_t size() const {
+        const auto tail = m_tail.load(std::memory_order_acquire);
+        const auto head = m_head.load(std::memory_order_acquire);
+        return tail > head ? static_cast<std::size_t>(tail - head) : 0;
+    }
+    bool empty() const { return 0 == size(); }
+
+    /// Any thread.  Returns false if the ring is full.
+    bool try_push(const T &t) {
+        auto tail = m_tail.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot &s = m_slots[tail & m_mask];
+            const auto seq = s.seq.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::int64_t>(seq - tail);
+            if (0 == diff) {
+                if (m_tail.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed)) {
+                    s.value = t;
+                    s.seq.store(tail + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                // the consumer has not yet freed this slot from the last lap:
+                return false;
+            } else {
+                tail = m_tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /// Consumer only.  Returns false if the ring is empty, or if the
+    //  oldest claimed slot has not been published yet.
+    bool try_pop(T &t) {
+        const auto head = m_head.load(std::memory_order_relaxed);
+        Slot &s = m_slots[head & m_mask];
+        if (s.seq.load(std::memory_order_acquire) != head + 1) {
+            return false;
+        }
+        t = s.value;
+        s.seq.store(head + m_mask + 1, std::memory_order_release);
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    struct Slot {
+        std::atomic<std::uint64_t> seq;
+        T value;
+    };
+
+    static std::size_t round_up_(std::size_t n) {
+        if (0 == n) {
+            throw std::invalid_argument("MPSCRing: capacity must be positive");
+        }
+        std::size_t p = 1;
+        while (p < n) {
+            p <<= 1;
+        }
+        return p;
+    }
+
+private:
+    const std::uint64_t m_mask;
+    const std::unique_ptr<Slot[]> m_slots;
+
+    // consumer
+    alignas(64) std::atomic<std::uint64_t> m_head;
+
+    // producers
+    alignas(64) std::atomic<std::uint64_t> m_tail;
+};
+
+}}
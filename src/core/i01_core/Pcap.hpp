@@ -2,9 +2,13 @@
 
 #include <pcap.h>
 
+#include <cstdint>
 #include <memory>
+#include <vector>
 #include <boost/noncopyable.hpp>
 
+#include <i01_core/LZ4.hpp>
+
 namespace i01 { namespace core { namespace pcap {
 
 class FileReaderImpl;
@@ -17,13 +21,25 @@ class FileReader : boost::noncopyable {
     std::shared_ptr<FileReaderImpl> get_impl() { return m_impl_p; }
 public:
     static const size_t s_PCAP_ERRBUF_SIZE;
-    FileReader(const std::string& path, char *errbuf);
+    /// ra applies to LZ4-compressed files.
+    FileReader(const std::string& path, char *errbuf, const LZ4::ReadAhead& ra = LZ4::ReadAhead());
     virtual ~FileReader();
 
     bool is_open() const;
     int next_ex(struct pcap_pkthdr **hp, const u_char **dp);
     const char * geterr() const;
 
+    /// Offset of the next record in the savefile, after decompression.
+    std::uint64_t tell() const;
+    /// Continue reading at a record offset returned by tell().
+    bool seek(std::uint64_t offset);
+
+    bool compressed() const;
+    /// LZ4 restart points, see LZ4::FileReader::checkpoints().  Empty
+    /// for uncompressed files, which can seek anywhere.
+    std::vector<LZ4::Checkpoint> checkpoints() const;
+    void checkpoints(const std::vector<LZ4::Checkpoint>& cps);
+
     // TODO FIXME XXX: remove this hack by creating a FileWriter for
     // reorderpcapns to use instead!
     void *get_pcap_t_ptr();
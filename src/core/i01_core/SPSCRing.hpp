@@ -0,0 +1,113 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+
+#include <i01_core/macro.hpp>
+
+namespace i01 { namespace core {
+
+/// Bounded single producer, single consumer queue of trivially copyable
+/// values.  Storage is allocated once, at construction.
+///
+/// The producer and consumer indices live on separate cache lines, and each
+/// side keeps a cached copy of the other's index, so the shared lines are
+/// only touched when the cached view says the ring is full (producer) or
+/// empty (consumer).
+template <typename T>
+class SPSCRing {
+public:
+    static_assert(std::is_trivially_copyable<T>::value, "SPSCRing: T must be trivially copyable");
+
+    typedef T value_type;
+
+public:
+    /// capacity is rounded up to a power of two.
+    explicit SPSCRing(std::size_t capacity)
+        : m_mask(round_up_(capacity) - 1), m_buffer(new T[m_mask + 1]),
+          m_head(0), m_cached_tail(0), m_tail(0), m_cached_head(0) {}
+    SPSCRing(const SPSCRing &) = delete;
+    SPSCRing & operator=(const SPSCRing &) = delete;
+
+    std::size_t capacity() const { return m_mask + 1; }
+
+    /// Approximate, unless called by the producer or the consumer while
+    //  the other is idle.
+    std::size_t size() const {
+        return static_cast<std::size_t>(m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire));
+    }
+    bool empty() const { return 0 == size(); }
+
+    /// Producer only.  Returns false if the ring is full.
+    bool try_push(const T &t) {
+        const auto tail = m_tail.load(std::memory_order_relaxed);
+        if (UNLIKELY(tail - m_cached_head > m_mask)) {
+            m_cached_head = m_head.load(std::memory_order_acquire);
+            if (tail - m_cached_head > m_mask) {
+                return false;
+            }
+        }
+        m_buffer[tail & m_mask] = t;
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Consumer only.  Returns the oldest value without removing it, or
+    //  nullptr if the ring is empty.
+    const T * front() {
+        const auto head = m_head.load(std::memory_order_relaxed);
+        if (head == m_cached_tail) {
+            m_cached_tail = m_tail.load(std::memory_order_acquire);
+            if (head == m_cached_tail) {
+                return nullptr;
+            }
+        }
+        return &m_buffer[head & m_mask];
+    }
+
+    /// Consumer only.  Removes the value returned by front().
+    void pop() {
+        m_head.store(m_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /// Consumer only.  Returns false if the ring is empty.
+    bool try_pop(T &t) {
+        const T *p = front();
+        if (nullptr == p) {
+            return false;
+        }
+        t = *p;
+        pop();
+        return true;
+    }
+
+private:
+    static std::size_t round_up_(std::size_t n) {
+        if (0 == n) {
+            throw std::invalid_argument("SPSCRing: capacity must be positive");
+        }
+        std::size_t p = 1;
+        while (p < n) {
+            p <<= 1;
+        }
+        return p;
+    }
+
+private:
+    const std::uint64_t m_mask;
+    const std::unique_ptr<T[]> m_buffer;
+
+    // consumer
+    alignas(64) std::atomic<std::uint64_t> m_head;
+    std::uint64_t m_cached_tail;
+
+    // producer
+    alignas(64) std::atomic<std::uint64_t> m_tail;
+    std::uint64_t m_cached_head;
+};
+
+}}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace i01 { namespace core {
+
+/// Single writer, multiple reader sequence lock around a trivially copyable
+/// value.  Readers never block the writer and never write shared state, so
+/// they do not bounce the writer's cache lines; a read that overlaps a write
+/// is detected by the sequence number and retried.
+///
+/// The value is held as relaxed atomic words rather than raw bytes so that
+/// concurrent copies are well defined.
+template <typename T>
+class alignas(64) SeqLock {
+public:
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock: T must be trivially copyable");
+
+    typedef T value_type;
+
+private:
+    static const std::size_t NUM_WORDS = (sizeof(T) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+
+public:
+    SeqLock() : m_seq(0) { store_words_(T()); }
+    explicit SeqLock(const T &t) : m_seq(0) { store_words_(t); }
+    SeqLock(const SeqLock &) = delete;
+    SeqLock & operator=(const SeqLock &) = delete;
+
+    /// Publish a new value.  Only one thread may call store().
+    void store(const T &t) {
+        const auto seq = m_seq.load(std::memory_order_relaxed);
+        m_seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        store_words_(t);
+        m_seq.store(seq + 2, std::memory_order_release);
+    }
+
+    /// Copy the current value into t, returns false if a write was in
+    /// progress or completed during the copy.
+    bool try_load(T &t) const {
+        const auto seq0 = m_seq.load(std::memory_order_acquire);
+        if (seq0 & 1) {
+            return false;
+        }
+        std::uint64_t buf[NUM_WORDS];
+        for (std::size_t i = 0; i < NUM_WORDS; ++i) {
+            buf[i] = m_words[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (seq0 != m_seq.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        std::memcpy(&t, buf, sizeof(T));
+        return true;
+    }
+
+    /// Copy the current value, retrying on torn reads.
+    T load() const {
+        T t;
+        while (!try_load(t)) {
+            __builtin_ia32_pause();
+        }
+        return t;
+    }
+
+    /// Number of completed stores.
+    std::uint64_t version() const { return m_seq.load(std::memory_order_acquire) >> 1; }
+
+private:
+    void store_words_(const T &t) {
+        std::uint64_t buf[NUM_WORDS] = {};
+        std::memcpy(buf, &t, sizeof(T));
+        for (std::size_t i = 0; i < NUM_WORDS; ++i) {
+            m_words[i].store(buf[i], std::memory_order_relaxed);
+        }
+    }
+
+private:
+    std::atomic<std::uint64_t> m_seq;
+    std::atomic<std::uint64_t> m_words[NUM_WORDS];
+};
+
+}}
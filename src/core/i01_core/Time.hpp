@@ -178,7 +178,7 @@ inline std::uint64_t rdtsc()
 inline std::uint64_t rdtscp()
 {
     std::uint32_t hi, lo;
-    __asm__ __volatile__ ("rdtscp" : "=a"(lo), "=d"(hi));
+    __asm__ __volatile__ ("rdtscp" : "=a"(lo), "=d"(hi) : : "%rcx");
     return ((std::uint64_t)lo | ((std::uint64_t)hi << 32));
 }
 
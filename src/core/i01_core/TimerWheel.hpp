@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include <i01_core/Time.hpp>
+#include <i01_core/TimerListener.hpp>
+
+namespace i01 { namespace core {
+
+/// Any number of timers fired through TimerListener::on_timer() by
+/// whoever owns the clock: a poller loop advancing to Timestamp::now(), or
+/// a replay advancing to each packet's timestamp.  A hashed hierarchical
+/// wheel: 256 slots of one tick each, then four levels of 64 slots each
+/// 64 times coarser, so adding and cancelling a timer are O(1), and a
+/// timer is moved down a level at most four times before it fires with
+/// the rest of its tick.  Bitmaps of occupied slots let advance() jump
+/// straight over empty stretches of time.
+///
+/// Not thread safe; on_timer() may add and cancel timers but not advance()
+/// or reset().
+class TimerWheel {
+public:
+    /// Names a timer to cancel(); 0 is never one.
+    using Handle = std::uint64_t;
+
+    static const std::uint64_t DEFAULT_RESOLUTION_NS = 1000000;
+
+    explicit TimerWheel(std::uint64_t resolution_ns = DEFAULT_RESOLUTION_NS);
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    /// Drop every timer and set the clock to now.
+    void reset(const Timestamp& now);
+
+    /// listener.on_timer(deadline, userdata, 1) once the clock reaches
+    /// deadline, and every interval after if interval is not zero.  A
+    /// deadline already passed fires on the next tick.
+    Handle add(TimerListener& listener, void *userdata, const Timestamp& deadline, const Timestamp& interval = Timestamp{});
+    /// False if h has fired its last or was cancelled already.
+    bool cancel(Handle h);
+
+    /// Move the clock to now and fire the timers due by then, tick by
+    /// tick, in the order they were added within a tick.  Each expiry of a
+    /// periodic timer fires on its own tick, so iter is only more than one
+    /// when the interval is shorter than the resolution; the timestamp is
+    /// then the last deadline passed.  Returns the number of on_timer()
+    /// calls.
+    std::size_t advance(const Timestamp& now);
+
+    /// No timer fires before this; the clock if empty().
+    Timestamp next_due() const;
+
+    Timestamp time() const { return to_timestamp_(m_tick * m_resolution); }
+    std::uint64_t resolution_ns() const { return m_resolution; }
+    std::size_t size() const { return m_size; }
+    bool empty() const { return 0 == m_size; }
+
+private:
+    struct Node {
+        Node *prev;
+        Node *next;
+    };
+    struct Timer : Node {
+        TimerListener *listener;
+        void *userdata;
+        std::uint64_t deadline;
+        std::uint64_t interval;
+        /// First tick at or after deadline.
+        std::uint64_t tick;
+        std::uint32_t index;
+        std::uint32_t generation;
+        std::uint16_t slot;
+        bool active;
+    };
+
+    static const unsigned LEVELS = 5;
+    static const unsigned SLOTS = 256 + 64 * (LEVELS - 1);
+    /// Ticks beyond which a timer waits in the last level and is placed
+    /// again when it comes round.
+    static const std::uint64_t MAX_DELTA = (1ULL << 32) - 1;
+    /// Timer::slot while on no slot's list.
+    static const std::uint16_t NO_SLOT = 0xffff;
+
+    static unsigned shift_(unsigned level) { return level ? 8 + 6 * (level - 1) : 0; }
+    static std::uint64_t mask_(unsigned level) { return level ? 63 : 255; }
+    static unsigned first_slot_(unsigned level) { return level ? 256 + 64 * (level - 1) : 0; }
+
+    static std::uint64_t to_ns_(const Timestamp& ts);
+    static Timestamp to_timestamp_(std::uint64_t ns);
+    std::uint64_t tick_of_(std::uint64_t ns) const { return (ns + m_resolution - 1) / m_resolution; }
+
+    static bool list_empty_(const Node& head) { return head.next == &head; }
+    static void unlink_(Node *n);
+    void link_(unsigned slot, Timer *t);
+    /// Move slot's timers, in order, onto the empty list head.
+    void take_(unsigned slot, Node& head);
+
+    /// File t under the slot for its tick, but not before tick earliest.
+    void place_(Timer *t, std::uint64_t earliest);
+    void release_(Timer *t);
+    /// The first tick after m_tick at which a slot fires or cascades, or
+    /// 0 if there are no timers.
+    std::uint64_t next_event_() const;
+    void cascade_();
+    std::size_t expire_();
+
+private:
+    std::uint64_t m_resolution;
+    /// The last tick fired.
+    std::uint64_t m_tick;
+    std::size_t m_size;
+    Node m_slots[SLOTS];
+    std::uint64_t m_occupied[SLOTS / 64];
+    /// Timers by handle index; a deque so that they never move.
+    std::deque<Timer> m_timers;
+    std::vector<std::uint32_t> m_free;
+};
+
+} }
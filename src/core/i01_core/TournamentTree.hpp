@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace i01 { namespace core {
+
+/// Picks the least of a fixed number of keys, one per source, for merging
+/// sorted streams: after the winning source's key changes, update() replays
+/// only the matches on its path to the root, log2(n) comparisons with no
+/// moves, where a binary heap pops and pushes.  Exhausted sources take the
+/// sentinel key, which must compare greater than any other.  Equal keys go
+/// to the lower source, so merges are stable.
+template<typename Key, typename Compare = std::less<Key> >
+class TournamentTree {
+public:
+    TournamentTree() : m_leaves(0) {}
+    TournamentTree(std::size_t n, const Key& sentinel) { reset(n, sentinel); }
+
+    /// n sources, all exhausted.
+    void reset(std::size_t n, const Key& sentinel)
+    {
+        m_sentinel = sentinel;
+        m_leaves = 1;
+        while (m_leaves < n)
+            m_leaves <<= 1;
+        m_keys.assign(m_leaves, sentinel);
+        m_tree.assign(2 * m_leaves, 0);
+        for (std::size_t i = 0; i < m_leaves; ++i)
+            m_tree[m_leaves + i] = static_cast<std::uint32_t>(i);
+        for (std::size_t node = m_leaves - 1; node > 0; --node)
+            m_tree[node] = play_(m_tree[2 * node], m_tree[2 * node + 1]);
+    }
+
+    std::size_t size() const { return m_leaves; }
+
+    /// The source with the least key.
+    std::size_t winner() const { return m_tree[1]; }
+    const Key& top() const { return m_keys[winner()]; }
+    /// Every source is exhausted.
+    bool empty() const { return !m_cmp(top(), m_sentinel); }
+
+    const Key& key(std::size_t source) const { return m_keys[source]; }
+
+    void update(std::size_t source, const Key& k)
+    {
+        m_keys[source] = k;
+        for (std::size_t node = (m_leaves + source) >> 1; node > 0; node >>= 1)
+            m_tree[node] = play_(m_tree[2 * node], m_tree[2 * node + 1]);
+    }
+    void exhaust(std::size_t source) { update(source, m_sentinel); }
+
+private:
+    std::uint32_t play_(std::uint32_t a, std::uint32_t b) const
+    {
+        return m_cmp(m_keys[b], m_keys[a]) ? b : a;
+    }
+
+private:
+    std::size_t m_leaves;
+    Key m_sentinel;
+    std::vector<Key> m_keys;
+    /// Winners of each match, the root at 1 and the leaves from m_leaves.
+    std::vector<std::uint32_t> m_tree;
+    Compare m_cmp;
+};
+
+} }
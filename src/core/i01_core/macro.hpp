@@ -42,6 +42,10 @@ inline void PREFETCHW_RANGE(char* data, int len) \
 //  value depends only on parameters and globals.
 #define I01_PURE            __attribute__((pure))
 
+/// Inline the function at every call site, whatever the optimizer thinks of
+//  its size.
+#define I01_ALWAYS_INLINE   inline __attribute__((__always_inline__))
+
 /// Declare variable as unused to suppress relevant warnings.
 #define I01_UNUSED          __attribute__((unused))
 
@@ -0,0 +1,605 @@
+#include <string.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <ostream>
+#include <stdexcept>
+
+#include <i01_md/EventArchive.hpp>
+
+namespace i01 { namespace MD { namespace Archive {
+
+namespace {
+
+const std::size_t WRITE_BUFFER_RECORDS = 4096;
+const std::size_t NUM_MICS = static_cast<std::size_t>(core::MICEnum::NUM_MIC);
+
+std::uint64_t to_ns(const core::Timestamp& ts)
+{
+    return static_cast<std::uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<std::uint64_t>(ts.tv_nsec);
+}
+
+core::Timestamp from_ns(std::uint64_t ns)
+{
+    return core::Timestamp(static_cast<time_t>(ns / 1000000000ULL), static_cast<long>(ns % 1000000000ULL));
+}
+
+std::uint8_t mic_index(const core::MIC& m)
+{
+    return static_cast<std::uint8_t>(m.index());
+}
+
+std::size_t book_key(std::uint8_t mic, std::uint32_t esi)
+{
+    return static_cast<std::size_t>(mic) * NUM_SYMBOL_INDEX + esi;
+}
+
+}
+
+std::ostream & operator<<(std::ostream &os, const RecordType &t)
+{
+    switch (t) {
+    case RecordType::SYMBOL_DEFINITION:
+        return os << "SYMBOL_DEFINITION";
+    case RecordType::LEVEL:
+        return os << "LEVEL";
+    case RecordType::TRADE:
+        return os << "TRADE";
+    case RecordType::TRADING_STATUS:
+        return os << "TRADING_STATUS";
+    case RecordType::GAP:
+        return os << "GAP";
+    case RecordType::FEED:
+        return os << "FEED";
+    case RecordType::START_OF_DATA:
+        return os << "START_OF_DATA";
+    case RecordType::END_OF_DATA:
+        return os << "END_OF_DATA";
+    case RecordType::L3_ADD:
+        return os << "L3_ADD";
+    case RecordType::L3_CANCEL:
+        return os << "L3_CANCEL";
+    case RecordType::L3_MODIFY:
+        return os << "L3_MODIFY";
+    case RecordType::L3_EXECUTION:
+        return os << "L3_EXECUTION";
+    case RecordType::UNKNOWN:
+    default:
+        return os << "UNKNOWN";
+    }
+}
+
+std::ostream & operator<<(std::ostream &os, const ArchiveHeader &h)
+{
+    return os << std::hex << h.magic_number << std::dec
+              << "," << h.version
+              << "," << h.record_size
+              << "," << h.index_interval_s
+              << "," << h.num_records
+              << "," << h.num_symbols
+              << "," << h.num_index_entries
+              << "," << from_ns(h.first_timestamp)
+              << "," << from_ns(h.last_timestamp);
+}
+
+std::ostream & operator<<(std::ostream &os, const ArchiveRecord &r)
+{
+    return os << from_ns(r.timestamp)
+              << "," << r.type
+              << "," << core::MIC::clone(r.mic)
+              << "," << r.esi
+              << "," << static_cast<int>(r.flags)
+              << "," << static_cast<int>(r.code)
+              << "," << r.price
+              << "," << r.size
+              << "," << r.num_orders
+              << "," << r.delta
+              << "," << r.refnum
+              << "," << r.aux
+              << "," << from_ns(r.exchange_timestamp);
+}
+
+Writer::Writer(const std::string& path, std::uint32_t index_interval_s) :
+    m_path(path),
+    m_file(std::fopen(path.c_str(), "wb")),
+    m_header(),
+    m_buffer(WRITE_BUFFER_RECORDS),
+    m_buffered(0),
+    m_l3_mics(NUM_MICS),
+    m_ok(nullptr != m_file)
+{
+    if (!m_ok) {
+        throw std::runtime_error("Archive::Writer: could not create " + path);
+    }
+    m_header.version = VERSION_NUMBER;
+    m_header.record_size = sizeof(ArchiveRecord);
+    m_header.index_interval_s = std::max<std::uint32_t>(index_interval_s, 1);
+    // magic_number stays 0 until close(), so an incomplete file is rejected
+    m_ok = 1 == std::fwrite(&m_header, sizeof(m_header), 1, m_file);
+}
+
+Writer::~Writer()
+{
+    close();
+}
+
+bool Writer::flush_()
+{
+    if (m_buffered) {
+        m_ok = m_ok && m_buffered == std::fwrite(m_buffer.data(), sizeof(ArchiveRecord), m_buffered, m_file);
+        m_buffered = 0;
+    }
+    return m_ok;
+}
+
+bool Writer::close()
+{
+    if (nullptr == m_file) {
+        return m_ok;
+    }
+    flush_();
+    for (auto &s : m_symbols) {
+        if (s.mic < NUM_MICS && m_l3_mics[s.mic]) {
+            s.flags |= L3_BOOK;
+        }
+    }
+    m_header.num_symbols = m_symbols.size();
+    m_header.num_index_entries = m_index.size();
+    if (m_ok && !m_symbols.empty()) {
+        m_ok = m_symbols.size() == std::fwrite(m_symbols.data(), sizeof(ArchiveSymbol), m_symbols.size(), m_file);
+    }
+    if (m_ok && !m_index.empty()) {
+        m_ok = m_index.size() == std::fwrite(m_index.data(), sizeof(ArchiveIndexEntry), m_index.size(), m_file);
+    }
+    if (m_ok) {
+        m_header.magic_number = MAGIC_NUMBER;
+        m_ok = 0 == std::fseek(m_file, 0, SEEK_SET)
+            && 1 == std::fwrite(&m_header, sizeof(m_header), 1, m_file);
+    }
+    m_ok = 0 == std::fclose(m_file) && m_ok;
+    m_file = nullptr;
+    if (!m_ok) {
+        std::cerr << "Archive::Writer: could not write " << m_path << std::endl;
+    }
+    return m_ok;
+}
+
+ArchiveRecord& Writer::next_(RecordType t, const core::Timestamp& ts, const core::MIC& m, EphemeralSymbolIndex esi)
+{
+    if (UNLIKELY(m_buffered == m_buffer.size())) {
+        flush_();
+    }
+    const std::uint64_t ns = to_ns(ts);
+    const std::uint64_t interval = m_header.index_interval_s * 1000000000ULL;
+    if (m_index.empty() || ns >= m_index.back().timestamp - m_index.back().timestamp % interval + interval) {
+        m_index.push_back(ArchiveIndexEntry{ns, m_header.num_records});
+    }
+    // symbol definitions carry no time
+    if (ns && (0 == m_header.first_timestamp || ns < m_header.first_timestamp)) {
+        m_header.first_timestamp = ns;
+    }
+    m_header.last_timestamp = std::max(m_header.last_timestamp, ns);
+    ++m_header.num_records;
+
+    ArchiveRecord& r = m_buffer[m_buffered++];
+    memset(&r, 0, sizeof(r));
+    r.timestamp = ns;
+    r.type = t;
+    r.mic = mic_index(m);
+    r.esi = esi;
+    return r;
+}
+
+ArchiveRecord& Writer::order_(RecordType t, const core::Timestamp& ts, const BookBase& b, const OrderBook::Order& o)
+{
+    ArchiveRecord& r = next_(t, ts, b.mic(), b.symbol_index());
+    m_l3_mics[r.mic] = true;
+    r.flags = OrderBook::Order::Side::BUY == o.side ? BUY : 0;
+    r.refnum = o.refnum;
+    r.price = o.price;
+    r.size = o.size;
+    return r;
+}
+
+void Writer::on_symbol_definition(const SymbolDefEvent& evt)
+{
+    next_(RecordType::SYMBOL_DEFINITION, core::Timestamp(), evt.mic, evt.esi);
+    ArchiveSymbol s;
+    memset(&s, 0, sizeof(s));
+    s.mic = mic_index(evt.mic);
+    s.esi = evt.esi;
+    strncpy(s.ticker, evt.ticker.c_str(), sizeof(s.ticker) - 1);
+    m_symbols.push_back(s);
+}
+
+void Writer::on_book_added(const L3AddEvent& evt)
+{
+    order_(RecordType::L3_ADD, evt.m_timestamp, evt.m_book, evt.m_order);
+}
+
+void Writer::on_book_canceled(const L3CancelEvent& evt)
+{
+    ArchiveRecord& r = order_(RecordType::L3_CANCEL, evt.m_timestamp, evt.m_book, evt.m_order);
+    r.delta = evt.m_old_size - evt.m_order.size;
+}
+
+void Writer::on_book_modified(const L3ModifyEvent& evt)
+{
+    ArchiveRecord& r = order_(RecordType::L3_MODIFY, evt.m_timestamp, evt.m_book, evt.m_new_order);
+    r.delta = evt.m_old_refnum;
+    r.aux = evt.m_old_price;
+    r.num_orders = evt.m_old_size;
+}
+
+void Writer::on_book_executed(const L3ExecutionEvent& evt)
+{
+    ArchiveRecord& r = order_(RecordType::L3_EXECUTION, evt.m_timestamp, evt.m_book, evt.m_order);
+    r.exchange_timestamp = to_ns(evt.m_exchange_timestamp);
+    r.flags |= evt.m_nonprintable ? NONPRINTABLE : 0;
+    r.price = evt.m_exec_price;
+    r.delta = evt.m_exec_size;
+    r.aux = evt.m_trade_id;
+}
+
+void Writer::on_l2_update(const L2BookEvent& evt)
+{
+    ArchiveRecord& r = next_(RecordType::LEVEL, evt.m_timestamp, evt.m_book.mic(), evt.m_book.symbol_index());
+    r.flags = evt.m_is_buy ? BUY : 0;
+    r.code = static_cast<std::uint8_t>(evt.m_reason);
+    r.price = evt.m_price;
+    r.size = evt.m_size;
+    r.num_orders = static_cast<std::uint32_t>(evt.m_num_orders);
+    r.delta = evt.m_delta_size;
+}
+
+void Writer::on_trade(const TradeEvent& evt)
+{
+    ArchiveRecord& r = next_(RecordType::TRADE, evt.m_timestamp, evt.m_book.mic(), evt.m_book.symbol_index());
+    r.exchange_timestamp = to_ns(evt.m_exchange_timestamp);
+    r.code = static_cast<std::uint8_t>(evt.m_passive_side);
+    r.flags = evt.m_cross ? CROSS : 0;
+    r.price = evt.m_price;
+    r.delta = evt.m_size;
+    r.refnum = evt.m_trade_id;
+}
+
+void Writer::on_gap(const GapEvent& evt)
+{
+    ArchiveRecord& r = next_(RecordType::GAP, evt.m_timestamp, evt.m_mic, 0);
+    r.exchange_timestamp = to_ns(evt.m_prior_timestamp);
+    r.refnum = evt.m_expected_seqnum;
+    r.delta = evt.m_received_seqnum;
+}
+
+void Writer::on_trading_status_update(const TradingStatusEvent& evt)
+{
+    ArchiveRecord& r = next_(RecordType::TRADING_STATUS, evt.m_timestamp, evt.m_book.mic(), evt.m_book.symbol_index());
+    r.code = static_cast<std::uint8_t>(evt.m_event);
+}
+
+void Writer::on_feed_event(const FeedEvent& evt)
+{
+    ArchiveRecord& r = next_(RecordType::FEED, evt.timestamp, evt.mic, 0);
+    r.exchange_timestamp = to_ns(evt.ecn_timestamp);
+    r.code = static_cast<std::uint8_t>(evt.event_code);
+}
+
+void Writer::on_start_of_data(const PacketEvent& evt)
+{
+    next_(RecordType::START_OF_DATA, evt.timestamp, evt.mic, 0);
+}
+
+void Writer::on_end_of_data(const PacketEvent& evt)
+{
+    next_(RecordType::END_OF_DATA, evt.timestamp, evt.mic, 0);
+}
+
+Reader::Reader(const std::string& path) :
+    m_file(path, 0, /* ro = */ true),
+    m_header(nullptr),
+    m_records(nullptr),
+    m_symbols(nullptr),
+    m_index(nullptr),
+    m_pos(0),
+    m_books(NUM_MICS * NUM_SYMBOL_INDEX),
+    m_l3_books(NUM_MICS * NUM_SYMBOL_INDEX),
+    m_l3_mics(NUM_MICS)
+{
+    if (!m_file.mapped() || m_file.size() < sizeof(ArchiveHeader)) {
+        throw std::runtime_error("Archive::Reader: could not map " + path);
+    }
+    m_header = m_file.data<const ArchiveHeader>();
+    if (Writer::MAGIC_NUMBER != m_header->magic_number
+        || Writer::VERSION_NUMBER < m_header->version || Writer::MIN_VERSION_NUMBER > m_header->version
+        || sizeof(ArchiveRecord) != m_header->record_size) {
+        throw std::runtime_error("Archive::Reader: not a complete archive: " + path);
+    }
+    const std::uint64_t expected = sizeof(ArchiveHeader)
+        + m_header->num_records * sizeof(ArchiveRecord)
+        + m_header->num_symbols * sizeof(ArchiveSymbol)
+        + m_header->num_index_entries * sizeof(ArchiveIndexEntry);
+    if (expected != m_file.size()) {
+        throw std::runtime_error("Archive::Reader: truncated archive: " + path);
+    }
+    const char *p = m_file.data<const char>() + sizeof(ArchiveHeader);
+    m_records = reinterpret_cast<const ArchiveRecord *>(p);
+    p += m_header->num_records * sizeof(ArchiveRecord);
+    m_symbols = reinterpret_cast<const ArchiveSymbol *>(p);
+    p += m_header->num_symbols * sizeof(ArchiveSymbol);
+    m_index = reinterpret_cast<const ArchiveIndexEntry *>(p);
+
+    ::madvise(m_file.data<void>(), m_file.size(), MADV_SEQUENTIAL);
+
+    for (std::size_t i = 0; i < NUM_MICS; ++i) {
+        m_mics.push_back(core::MIC::clone(static_cast<std::uint8_t>(i)));
+    }
+    m_ticker_slots.resize(NUM_MICS * NUM_SYMBOL_INDEX);
+    for (std::uint64_t i = 0; i < m_header->num_symbols; ++i) {
+        const ArchiveSymbol &s = m_symbols[i];
+        m_tickers.emplace_back(s.ticker, strnlen(s.ticker, sizeof(s.ticker)));
+        if (s.mic < NUM_MICS && s.esi < static_cast<std::uint32_t>(NUM_SYMBOL_INDEX)) {
+            m_ticker_slots[book_key(s.mic, s.esi)] = static_cast<std::uint32_t>(i + 1);
+            if (s.flags & L3_BOOK) {
+                m_l3_mics[s.mic] = true;
+            }
+        }
+    }
+}
+
+Reader::~Reader() = default;
+
+std::uint64_t Reader::find(const core::Timestamp& ts) const
+{
+    const std::uint64_t ns = to_ns(ts);
+    const ArchiveIndexEntry *end = m_index + m_header->num_index_entries;
+    const ArchiveIndexEntry *it = std::upper_bound(m_index, end, ns,
+            [](std::uint64_t t, const ArchiveIndexEntry &e) { return t < e.timestamp; });
+    std::uint64_t i = it == m_index ? 0 : (it - 1)->record;
+    while (i < m_header->num_records && m_records[i].timestamp < ns) {
+        ++i;
+    }
+    return i;
+}
+
+L2Book& Reader::book_(std::uint8_t mic, std::uint32_t esi)
+{
+    auto &b = m_books[book_key(mic, esi)];
+    if (UNLIKELY(!b)) {
+        b.reset(new L2Book(m_mics[mic], esi));
+    }
+    return *b;
+}
+
+OrderBook& Reader::l3_book_(std::uint8_t mic, std::uint32_t esi)
+{
+    auto &b = m_l3_books[book_key(mic, esi)];
+    if (UNLIKELY(!b)) {
+        b.reset(new OrderBook(m_mics[mic], esi));
+    }
+    return *b;
+}
+
+const BookBase& Reader::venue_book_(std::uint8_t mic, std::uint32_t esi)
+{
+    if (m_l3_mics[mic]) {
+        return l3_book_(mic, esi);
+    }
+    return book_(mic, esi);
+}
+
+const L2Book* Reader::book(const core::MIC& m, EphemeralSymbolIndex esi) const
+{
+    if (static_cast<std::size_t>(m.index()) >= NUM_MICS || esi >= static_cast<EphemeralSymbolIndex>(NUM_SYMBOL_INDEX)) {
+        return nullptr;
+    }
+    return m_books[book_key(mic_index(m), esi)].get();
+}
+
+const OrderBook* Reader::l3_book(const core::MIC& m, EphemeralSymbolIndex esi) const
+{
+    if (static_cast<std::size_t>(m.index()) >= NUM_MICS || esi >= static_cast<EphemeralSymbolIndex>(NUM_SYMBOL_INDEX)) {
+        return nullptr;
+    }
+    return m_l3_books[book_key(mic_index(m), esi)].get();
+}
+
+void Reader::rewind()
+{
+    m_pos = 0;
+    for (auto &b : m_books) {
+        b.reset();
+    }
+    for (auto &b : m_l3_books) {
+        b.reset();
+    }
+}
+
+void Reader::replay_l3_(const ArchiveRecord& r, const core::Timestamp& ts, BookMuxListener* l)
+{
+    using Order = OrderBook::Order;
+    OrderBook &b = l3_book_(r.mic, r.esi);
+    const Order::Side side = (r.flags & BUY) ? Order::Side::BUY : Order::Side::SELL;
+    switch (r.type) {
+    case RecordType::L3_ADD: {
+        const Order o(r.refnum, side, static_cast<Order::Price>(r.price), r.size, Order::TimeInForce::DAY, ts, ts);
+        b.add(o);
+        if (nullptr != l) {
+            l->on_book_added(L3AddEvent{ts, b, o});
+        }
+        break;
+    }
+    case RecordType::L3_CANCEL: {
+        Order *p = b.find(r.refnum);
+        if (nullptr == p) {
+            break;
+        }
+        const Order::Size old_size = p->size;
+        if (0 == r.size) {
+            Order gone(*p);
+            gone.size = 0;
+            b.erase(*p);
+            if (nullptr != l) {
+                l->on_book_canceled(L3CancelEvent{ts, b, gone, old_size});
+            }
+        } else {
+            b.modify(*p, r.size);
+            if (nullptr != l) {
+                l->on_book_canceled(L3CancelEvent{ts, b, *p, old_size});
+            }
+        }
+        break;
+    }
+    case RecordType::L3_MODIFY: {
+        const Order o(r.refnum, side, static_cast<Order::Price>(r.price), r.size, Order::TimeInForce::DAY, ts, ts);
+        if (nullptr == b.find(r.delta)) {
+            b.add(o);
+        } else {
+            b.replace(r.delta, o);
+        }
+        if (nullptr != l) {
+            l->on_book_modified(L3ModifyEvent{ts, b, o, r.delta, static_cast<Order::Price>(r.aux), r.num_orders});
+        }
+        break;
+    }
+    case RecordType::L3_EXECUTION: {
+        Order *p = b.find(r.refnum);
+        if (nullptr == p) {
+            break;
+        }
+        const Order::Size old_size = p->size;
+        const core::Timestamp ets(from_ns(r.exchange_timestamp));
+        const bool nonprintable = 0 != (r.flags & NONPRINTABLE);
+        if (0 == r.size) {
+            Order gone(*p);
+            gone.size = 0;
+            b.erase(*p);
+            if (nullptr != l) {
+                l->on_book_executed(L3ExecutionEvent{ts, ets, b, gone, r.aux, static_cast<Order::Price>(r.price),
+                            static_cast<Order::Size>(r.delta), old_size, nonprintable});
+            }
+        } else {
+            b.modify(*p, r.size);
+            if (nullptr != l) {
+                l->on_book_executed(L3ExecutionEvent{ts, ets, b, *p, r.aux, static_cast<Order::Price>(r.price),
+                            static_cast<Order::Size>(r.delta), old_size, nonprintable});
+            }
+        }
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+void Reader::replay_(const ArchiveRecord& r, BookMuxListener* l)
+{
+    if (UNLIKELY(r.mic >= NUM_MICS || r.esi >= static_cast<std::uint32_t>(NUM_SYMBOL_INDEX))) {
+        return;
+    }
+    const core::Timestamp ts(from_ns(r.timestamp));
+    switch (r.type) {
+    case RecordType::LEVEL: {
+        L2Book &b = book_(r.mic, r.esi);
+        const bool buy = r.flags & BUY;
+        const bool top = b.replace(buy, r.price, r.size, r.num_orders, ts);
+        if (nullptr != l) {
+            l->on_l2_update(L2BookEvent{ts, b, buy, top, b.last_update_reduced_size(buy),
+                        r.price, r.size, r.num_orders, static_cast<Size>(r.delta),
+                        static_cast<L2BookEvent::DeltaReasonCode>(r.code)});
+        }
+        break;
+    }
+    case RecordType::L3_ADD:
+    case RecordType::L3_CANCEL:
+    case RecordType::L3_MODIFY:
+    case RecordType::L3_EXECUTION:
+        replay_l3_(r, ts, l);
+        break;
+    case RecordType::TRADE:
+        if (nullptr != l) {
+            const core::Timestamp ets(from_ns(r.exchange_timestamp));
+            l->on_trade(TradeEvent{ts, ets, venue_book_(r.mic, r.esi), r.refnum, r.price, r.delta,
+                        static_cast<TradeEvent::PassiveSide>(r.code), 0 != (r.flags & CROSS), nullptr});
+        }
+        break;
+    case RecordType::TRADING_STATUS:
+        if (nullptr != l) {
+            l->on_trading_status_update(TradingStatusEvent{ts, venue_book_(r.mic, r.esi),
+                        static_cast<TradingStatusEvent::Event>(r.code)});
+        }
+        break;
+    case RecordType::SYMBOL_DEFINITION:
+        if (nullptr != l) {
+            const std::uint32_t slot = m_ticker_slots[book_key(r.mic, r.esi)];
+            static const std::string unknown;
+            l->on_symbol_definition(SymbolDefEvent{m_mics[r.mic], r.esi, slot ? m_tickers[slot - 1] : unknown});
+        }
+        break;
+    case RecordType::GAP:
+        if (nullptr != l) {
+            const core::Timestamp prior(from_ns(r.exchange_timestamp));
+            l->on_gap(GapEvent{ts, m_mics[r.mic], r.refnum, r.delta, prior});
+        }
+        break;
+    case RecordType::FEED:
+        if (nullptr != l) {
+            const core::Timestamp ets(from_ns(r.exchange_timestamp));
+            const FeedEvent::EventCode code = static_cast<FeedEvent::EventCode>(r.code);
+            l->on_feed_event(FeedEvent{ts, ets, m_mics[r.mic], code});
+        }
+        break;
+    case RecordType::START_OF_DATA:
+        if (nullptr != l) {
+            l->on_start_of_data(PacketEvent{ts, m_mics[r.mic]});
+        }
+        break;
+    case RecordType::END_OF_DATA:
+        if (nullptr != l) {
+            l->on_end_of_data(PacketEvent{ts, m_mics[r.mic]});
+        }
+        break;
+    case RecordType::UNKNOWN:
+    default:
+        break;
+    }
+}
+
+std::uint64_t Reader::read_records(BookMuxListener& l, std::uint64_t n)
+{
+    const std::uint64_t end = m_pos + std::min(n, m_header->num_records - m_pos);
+    const std::uint64_t start = m_pos;
+    for (; m_pos < end; ++m_pos) {
+        replay_(m_records[m_pos], &l);
+    }
+    return m_pos - start;
+}
+
+std::uint64_t Reader::read_until(BookMuxListener& l, const core::Timestamp& ts)
+{
+    const std::uint64_t end = std::max(find(ts), m_pos);
+    return read_records(l, end - m_pos);
+}
+
+std::uint64_t Reader::skip_until(const core::Timestamp& ts)
+{
+    const std::uint64_t end = std::max(find(ts), m_pos);
+    const std::uint64_t start = m_pos;
+    for (; m_pos < end; ++m_pos) {
+        const ArchiveRecord &r = m_records[m_pos];
+        switch (r.type) {
+        case RecordType::LEVEL:
+        case RecordType::L3_ADD:
+        case RecordType::L3_CANCEL:
+        case RecordType::L3_MODIFY:
+        case RecordType::L3_EXECUTION:
+            replay_(r, nullptr);
+            break;
+        default:
+            break;
+        }
+    }
+    return m_pos - start;
+}
+
+}}}
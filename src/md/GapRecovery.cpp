@@ -0,0 +1,451 @@
+#include <endian.h>
+#include <string.h>
+
+#include <algorithm>
+#include <utility>
+
+#include <i01_core/macro.hpp>
+
+#include <i01_md/GapRecovery.hpp>
+
+namespace i01 { namespace MD {
+
+GapRecovery::GapRecovery(Framing framing, net::SocketListener *downstream, RecoveryTransport *transport, const Config &cfg) :
+    m_framing(framing), m_downstream(downstream), m_transport(transport),
+    m_listener(nullptr), m_config(cfg), m_units(), m_stats()
+{
+    if (0 == m_config.ring_size) {
+        m_config.ring_size = 1;
+    }
+    if (0 == m_config.max_request) {
+        m_config.max_request = 1;
+    }
+}
+
+GapRecovery::~GapRecovery()
+{
+}
+
+bool GapRecovery::parse_(const std::uint8_t *buf, std::size_t len, Header &h) const
+{
+    switch (m_framing) {
+    case Framing::MOLDUDP64: {
+        // session[10], seqnum, msg_count; 0xffff is the end of session and
+        // carries no messages.
+        if (len < 20) {
+            return false;
+        }
+        std::uint64_t seqnum;
+        std::uint16_t count;
+        ::memcpy(&seqnum, buf + 10, sizeof(seqnum));
+        ::memcpy(&count, buf + 18, sizeof(count));
+        count = be16toh(count);
+        h.unit = 0;
+        h.seqnum = be64toh(seqnum);
+        h.count = 0xffff == count ? 0 : count;
+        return 0 != h.seqnum;
+    }
+    case Framing::PITCH2: {
+        // length, count, unit, sequence
+        if (len < 8) {
+            return false;
+        }
+        std::uint32_t seqnum;
+        ::memcpy(&seqnum, buf + 4, sizeof(seqnum));
+        h.unit = buf[3];
+        h.seqnum = le32toh(seqnum);
+        h.count = buf[2];
+        return 0 != h.seqnum;
+    }
+    }
+    return false;
+}
+
+GapRecovery::Unit & GapRecovery::unit_(std::uint8_t unit)
+{
+    if (UNLIKELY(!m_units[unit])) {
+        m_units[unit].reset(new Unit());
+        m_units[unit]->session.fill(' ');
+    }
+    return *m_units[unit];
+}
+
+bool GapRecovery::recovering(std::uint8_t unit) const
+{
+    return m_units[unit] && m_units[unit]->recovering;
+}
+
+std::uint64_t GapRecovery::expected(std::uint8_t unit) const
+{
+    return m_units[unit] ? m_units[unit]->expected : 0;
+}
+
+std::size_t GapRecovery::buffered(std::uint8_t unit) const
+{
+    return m_units[unit] ? m_units[unit]->size : 0;
+}
+
+void GapRecovery::deliver_(const core::Timestamp &ts, void *userdata, const std::uint8_t *buf, std::size_t len)
+{
+    if (m_downstream) {
+        m_downstream->on_recv(ts, userdata, buf, static_cast<ssize_t>(len));
+    }
+}
+
+void GapRecovery::on_recv(const core::Timestamp &ts, void *userdata, const std::uint8_t *buf, const ssize_t &len)
+{
+    Header h;
+    if (len <= 0 || !parse_(buf, static_cast<std::size_t>(len), h)) {
+        deliver_(ts, userdata, buf, static_cast<std::size_t>(std::max<ssize_t>(len, 0)));
+        return;
+    }
+    Unit &u = unit_(h.unit);
+    if (Framing::MOLDUDP64 == m_framing) {
+        ::memcpy(u.session.data(), buf, u.session.size());
+    }
+    if (UNLIKELY(0 == u.expected)) {
+        u.expected = h.seqnum;
+    }
+    u.horizon = std::max(u.horizon, h.seqnum + h.count);
+
+    if (LIKELY(h.seqnum <= u.expected)) {
+        if (h.count && h.seqnum + h.count <= u.expected) {
+            ++m_stats.duplicates;
+            return;
+        }
+        // in sequence, or overlapping what was passed on; the decoder skips
+        // what it has seen.
+        deliver_(ts, userdata, buf, static_cast<std::size_t>(len));
+        u.expected = std::max(u.expected, h.seqnum + h.count);
+        if (u.recovering) {
+            drain_(ts, h.unit, u);
+        }
+        return;
+    }
+
+    // ahead of the sequence
+    if (0 == h.count) {
+        // a heartbeat only tells us what is missing:
+        u.horizon = std::max(u.horizon, h.seqnum);
+        if (!u.recovering) {
+            start_(ts, h.unit, u, h.seqnum);
+        }
+        return;
+    }
+    if (UNLIKELY(!buffer_(u, h, userdata, buf, static_cast<std::size_t>(len)))) {
+        if (u.recovering) {
+            // a retransmission may fall between the packets held back, so
+            // only those before it go first:
+            fail_(ts, h.unit, u, h.seqnum);
+        } else {
+            ++m_stats.gaps;
+            ++m_stats.failed;
+            if (m_listener) {
+                m_listener->on_recovery_failed(ts, h.unit, u.expected, h.seqnum);
+            }
+        }
+        if (h.seqnum + h.count > u.expected) {
+            deliver_(ts, userdata, buf, static_cast<std::size_t>(len));
+            u.expected = h.seqnum + h.count;
+        } else {
+            ++m_stats.duplicates;
+        }
+        pass_held_(ts, u, UINT64_MAX);
+        u.expected = std::max(u.expected, u.horizon);
+        return;
+    }
+    if (!u.recovering) {
+        start_(ts, h.unit, u, h.seqnum);
+    }
+}
+
+bool GapRecovery::buffer_(Unit &u, const Header &h, void *userdata, const std::uint8_t *buf, std::size_t len)
+{
+    if (len > m_config.max_packet_size) {
+        return false;
+    }
+    if (UNLIKELY(u.ring.empty())) {
+        u.data.reset(new std::uint8_t[m_config.ring_size * m_config.max_packet_size]);
+        u.ring.resize(m_config.ring_size);
+        for (std::size_t i = 0; i < u.ring.size(); ++i) {
+            u.ring[i].data = u.data.get() + i * m_config.max_packet_size;
+        }
+    }
+    if (u.size == u.ring.size()) {
+        return false;
+    }
+    // Live packets arrive in order and go on the end; a retransmitted one
+    // may fill a hole further in.  Slots are swapped rather than copied, so
+    // each keeps its own packet buffer.
+    std::size_t i = u.size;
+    for (; i > 0 && u.at(i - 1).seqnum >= h.seqnum; --i) {
+        if (u.at(i - 1).seqnum == h.seqnum) {
+            ++m_stats.duplicates;
+            return true;
+        }
+    }
+    for (std::size_t j = u.size; j > i; --j) {
+        std::swap(u.at(j), u.at(j - 1));
+    }
+    Slot &s = u.at(i);
+    s.seqnum = h.seqnum;
+    s.count = h.count;
+    s.len = len;
+    s.userdata = userdata;
+    ::memcpy(s.data, buf, len);
+    ++u.size;
+    ++u.buffered_this_gap;
+    ++m_stats.packets_buffered;
+    m_stats.max_buffered = std::max<std::uint64_t>(m_stats.max_buffered, u.size);
+    return true;
+}
+
+void GapRecovery::drain_(const core::Timestamp &ts, std::uint8_t unit, Unit &u)
+{
+    while (u.size && u.at(0).seqnum <= u.expected) {
+        const Slot &s = u.at(0);
+        if (s.seqnum + s.count > u.expected) {
+            deliver_(ts, s.userdata, s.data, s.len);
+            u.expected = s.seqnum + s.count;
+        } else {
+            ++m_stats.duplicates;
+        }
+        u.head = (u.head + 1) % u.ring.size();
+        --u.size;
+    }
+    if (!u.recovering) {
+        return;
+    }
+    if (0 == u.size && u.expected >= u.horizon) {
+        complete_(ts, unit, u);
+    } else if (u.expected >= u.requested_end) {
+        // what was asked for is in, but there is another hole after it:
+        u.retries = 0;
+        if (!request_(ts, unit, u)) {
+            fail_(ts, unit, u);
+        }
+    }
+}
+
+bool GapRecovery::request_(const core::Timestamp &ts, std::uint8_t unit, Unit &u)
+{
+    const std::uint64_t end = u.size ? u.at(0).seqnum : u.horizon;
+    RecoveryRequest r;
+    r.timestamp = ts;
+    r.unit = unit;
+    r.seqnum = u.expected;
+    r.count = std::min(end - u.expected, m_config.max_request);
+    r.session = u.session;
+    u.request_ts = ts;
+    u.requested_end = r.seqnum + r.count;
+    ++m_stats.requests;
+    return m_transport && m_transport->request(r);
+}
+
+void GapRecovery::start_(const core::Timestamp &ts, std::uint8_t unit, Unit &u, std::uint64_t received)
+{
+    u.recovering = true;
+    u.gap_ts = ts;
+    u.retries = 0;
+    u.buffered_this_gap = u.size;
+    ++m_stats.gaps;
+    if (m_listener) {
+        m_listener->on_recovery_started(ts, unit, u.expected, received);
+    }
+    if (!request_(ts, unit, u)) {
+        fail_(ts, unit, u);
+    }
+}
+
+void GapRecovery::complete_(const core::Timestamp &ts, std::uint8_t unit, Unit &u)
+{
+    const core::Timestamp elapsed = ts - u.gap_ts;
+    u.recovering = false;
+    ++m_stats.recovered;
+    m_stats.last_time_to_recover = elapsed;
+    m_stats.max_time_to_recover = std::max(m_stats.max_time_to_recover, elapsed);
+    m_stats.total_time_to_recover = m_stats.total_time_to_recover + elapsed;
+    if (m_listener) {
+        m_listener->on_recovery_complete(ts, unit, elapsed, u.buffered_this_gap);
+    }
+}
+
+void GapRecovery::pass_held_(const core::Timestamp &ts, Unit &u, std::uint64_t end)
+{
+    for (; u.size && u.at(0).seqnum < end; --u.size) {
+        const Slot &s = u.at(0);
+        if (s.seqnum + s.count > u.expected) {
+            deliver_(ts, s.userdata, s.data, s.len);
+            u.expected = s.seqnum + s.count;
+        }
+        u.head = (u.head + 1) % u.ring.size();
+    }
+}
+
+void GapRecovery::fail_(const core::Timestamp &ts, std::uint8_t unit, Unit &u, std::uint64_t end)
+{
+    u.recovering = false;
+    ++m_stats.failed;
+    if (m_listener) {
+        m_listener->on_recovery_failed(ts, unit, u.expected, u.size ? u.at(0).seqnum : u.horizon);
+    }
+    // pass on what was held back, gaps and all:
+    pass_held_(ts, u, end);
+    if (UINT64_MAX == end) {
+        u.expected = std::max(u.expected, u.horizon);
+    }
+}
+
+void GapRecovery::abandon(const core::Timestamp &ts, std::uint8_t unit)
+{
+    if (recovering(unit)) {
+        fail_(ts, unit, *m_units[unit]);
+    }
+}
+
+void GapRecovery::on_timer(const core::Timestamp &ts, void *userdata, std::uint64_t iter)
+{
+    for (std::size_t i = 0; i < m_units.size(); ++i) {
+        Unit *u = m_units[i].get();
+        if (nullptr == u || !u->recovering || ts - u->request_ts < m_config.retry_timeout) {
+            continue;
+        }
+        const std::uint8_t unit = static_cast<std::uint8_t>(i);
+        if (u->retries >= m_config.max_retries) {
+            fail_(ts, unit, *u);
+        } else {
+            ++u->retries;
+            if (!request_(ts, unit, *u)) {
+                fail_(ts, unit, *u);
+            }
+        }
+    }
+}
+
+void GapRecovery::on_connected(const core::Timestamp &ts, void *userdata)
+{
+    if (m_downstream) {
+        m_downstream->on_connected(ts, userdata);
+    }
+}
+
+void GapRecovery::on_peer_disconnect(const core::Timestamp &ts, void *userdata)
+{
+    if (m_downstream) {
+        m_downstream->on_peer_disconnect(ts, userdata);
+    }
+}
+
+void GapRecovery::on_local_disconnect(const core::Timestamp &ts, void *userdata)
+{
+    if (m_downstream) {
+        m_downstream->on_local_disconnect(ts, userdata);
+    }
+}
+
+const std::size_t MoldUDP64RequestTransport::REQUEST_SIZE;
+
+bool MoldUDP64RequestTransport::request(const RecoveryRequest &r)
+{
+    std::uint8_t pkt[REQUEST_SIZE];
+    const std::uint64_t seqnum = htobe64(r.seqnum);
+    const std::uint16_t count = htobe16(static_cast<std::uint16_t>(std::min<std::uint64_t>(r.count, 0xffff)));
+    ::memcpy(pkt, r.session.data(), r.session.size());
+    ::memcpy(pkt + 10, &seqnum, sizeof(seqnum));
+    ::memcpy(pkt + 18, &count, sizeof(count));
+    return m_socket.send(pkt, sizeof(pkt)) == static_cast<ssize_t>(sizeof(pkt));
+}
+
+const std::size_t PITCH2GapRequestTransport::HEADER_SIZE;
+const std::size_t PITCH2GapRequestTransport::LOGIN_SIZE;
+const std::size_t PITCH2GapRequestTransport::GAP_REQUEST_SIZE;
+const std::size_t PITCH2GapRequestTransport::GAP_RESPONSE_SIZE;
+const std::size_t PITCH2GapRequestTransport::LOGIN_RESPONSE_SIZE;
+const char PITCH2GapRequestTransport::ACCEPTED;
+
+bool PITCH2GapRequestTransport::send_(MessageType type, const std::uint8_t *body, std::size_t len)
+{
+    // an unsequenced unit header, unit 0 sequence 0, and one message of
+    // length, type and body
+    std::uint8_t pkt[HEADER_SIZE + 2 + LOGIN_SIZE];
+    const std::size_t msg_len = 2 + len;
+    const std::uint16_t pkt_len = htole16(static_cast<std::uint16_t>(HEADER_SIZE + msg_len));
+    ::memcpy(pkt, &pkt_len, sizeof(pkt_len));
+    pkt[2] = 1;
+    ::memset(pkt + 3, 0, 5);
+    pkt[HEADER_SIZE] = static_cast<std::uint8_t>(msg_len);
+    pkt[HEADER_SIZE + 1] = static_cast<std::uint8_t>(type);
+    ::memcpy(pkt + HEADER_SIZE + 2, body, len);
+    return m_socket.send(pkt, HEADER_SIZE + msg_len) == static_cast<ssize_t>(HEADER_SIZE + msg_len);
+}
+
+bool PITCH2GapRequestTransport::login(const std::string &session_sub_id, const std::string &username, const std::string &password)
+{
+    // session sub id[4], username[4], filler[2], password[10], space padded
+    std::uint8_t body[LOGIN_SIZE - 2];
+    ::memset(body, ' ', sizeof(body));
+    ::memcpy(body, session_sub_id.data(), std::min<std::size_t>(session_sub_id.size(), 4));
+    ::memcpy(body + 4, username.data(), std::min<std::size_t>(username.size(), 4));
+    ::memcpy(body + 10, password.data(), std::min<std::size_t>(password.size(), 10));
+    return send_(MessageType::LOGIN, body, sizeof(body));
+}
+
+bool PITCH2GapRequestTransport::request(const RecoveryRequest &r)
+{
+    if (!m_logged_in) {
+        return false;
+    }
+    // unit, sequence, count
+    std::uint8_t body[GAP_REQUEST_SIZE - 2];
+    const std::uint32_t seqnum = htole32(static_cast<std::uint32_t>(r.seqnum));
+    const std::uint16_t count = htole16(static_cast<std::uint16_t>(std::min<std::uint64_t>(r.count, 0xffff)));
+    body[0] = r.unit;
+    ::memcpy(body + 1, &seqnum, sizeof(seqnum));
+    ::memcpy(body + 5, &count, sizeof(count));
+    return send_(MessageType::GAP_REQUEST, body, sizeof(body));
+}
+
+void PITCH2GapRequestTransport::on_recv(const core::Timestamp &ts, void *userdata, const std::uint8_t *buf, const ssize_t &len)
+{
+    if (len <= 0) {
+        return;
+    }
+    m_partial.insert(m_partial.end(), buf, buf + len);
+    std::size_t off = 0;
+    while (m_partial.size() - off >= HEADER_SIZE) {
+        std::uint16_t pkt_len;
+        ::memcpy(&pkt_len, m_partial.data() + off, sizeof(pkt_len));
+        pkt_len = le16toh(pkt_len);
+        if (pkt_len < HEADER_SIZE) {
+            // out of step with the stream; nothing to be done but drop it
+            m_partial.clear();
+            return;
+        }
+        if (m_partial.size() - off < pkt_len) {
+            break;
+        }
+        const std::uint8_t *p = m_partial.data() + off + HEADER_SIZE;
+        const std::uint8_t *end = m_partial.data() + off + pkt_len;
+        for (unsigned n = m_partial[off + 2]; n && end - p >= 2 && p[0] >= 2 && end - p >= p[0]; --n, p += p[0]) {
+            switch (static_cast<MessageType>(p[1])) {
+            case MessageType::LOGIN_RESPONSE:
+                if (p[0] >= LOGIN_RESPONSE_SIZE) {
+                    m_logged_in = ACCEPTED == static_cast<char>(p[2]);
+                }
+                break;
+            case MessageType::GAP_RESPONSE:
+                // unit, sequence, count, status
+                if (p[0] >= GAP_RESPONSE_SIZE && ACCEPTED != static_cast<char>(p[9]) && m_recovery) {
+                    m_recovery->abandon(ts, p[2]);
+                }
+                break;
+            default:
+                break;
+            }
+        }
+        off += pkt_len;
+    }
+    m_partial.erase(m_partial.begin(), m_partial.begin() + static_cast<std::ptrdiff_t>(off));
+}
+
+}}
@@ -0,0 +1,413 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include <i01_md/L2Book.hpp>
+#include <i01_md/NBBOEngine.hpp>
+
+namespace i01 { namespace MD {
+
+NBBOEngine::NBBOEngine() :
+    m_empty_bid(BookBase::EMPTY_BID_PRICE),
+    m_empty_ask(BookBase::EMPTY_ASK_PRICE)
+{
+}
+
+void NBBOEngine::subscribe(NBBOListener *l, TradingStateBitfield policy)
+{
+    if (nullptr == l) {
+        return;
+    }
+    if (!m_venues) {
+        m_venues.reset(new SymbolVenues[NUM_SYMBOL_INDEX]);
+        for (std::size_t i = 0; i < NUM_SYMBOL_INDEX; i++) {
+            m_venues[i].quotes.fill(VenueQuote{m_empty_bid, m_empty_ask, 0, 0});
+            // in case some venues do not send trading status updates when they start (BATS?)
+            m_venues[i].states.fill(0);
+        }
+        for (auto &p : m_packets) {
+            p.slot_by_esi.reset(new std::uint32_t[NUM_SYMBOL_INDEX]());
+            p.touched.reserve(256);
+            p.changed.reserve(256);
+        }
+    }
+
+    // a listener is in one view, that of its latest policy
+    for (auto &v : m_views) {
+        v->listeners.erase(std::remove(v->listeners.begin(), v->listeners.end(), l), v->listeners.end());
+    }
+    m_views.erase(std::remove_if(m_views.begin(), m_views.end(),
+                                 [policy](const std::unique_ptr<View> &v) {
+                                     return v->listeners.empty() && v->policy != policy;
+                                 }),
+                  m_views.end());
+    for (auto &v : m_views) {
+        if (v->policy == policy) {
+            v->listeners.push_back(l);
+            return;
+        }
+    }
+    if (m_views.size() == MAX_VIEWS) {
+        throw std::runtime_error("NBBOEngine: too many distinct quote policies");
+    }
+    std::unique_ptr<View> v(new View());
+    v->policy = policy;
+    init_view_(*v);
+    v->listeners.push_back(l);
+    m_views.push_back(std::move(v));
+}
+
+void NBBOEngine::init_view_(View &v)
+{
+    v.nbbo.reset(new SymbolNBBO[NUM_SYMBOL_INDEX]);
+    for (std::size_t i = 0; i < NUM_SYMBOL_INDEX; i++) {
+        const auto &sv = m_venues[i];
+        auto &n = v.nbbo[i];
+        Mutex::scoped_lock lock(sv.mutex);
+        n.enabled = 0;
+        for (int venue = 0; venue < NUM_VENUES; venue++) {
+            if (enabled_in_(v.policy, sv.states[venue])) {
+                n.enabled |= VenueMask(1) << venue;
+            }
+        }
+        rescan_side_(n, sv, true);
+        rescan_side_(n, sv, false);
+    }
+}
+
+const NBBOEngine::View * NBBOEngine::view_(TradingStateBitfield policy) const
+{
+    for (const auto &v : m_views) {
+        if (v->policy == policy) {
+            return v.get();
+        }
+    }
+    return nullptr;
+}
+
+FullL2Quote NBBOEngine::quote_(const SymbolNBBO &n)
+{
+    return FullL2Quote(L2Quote(n.bid.price, n.bid.size, static_cast<NumOrders>(__builtin_popcount(n.bid.venues))),
+                       L2Quote(n.ask.price, n.ask.size, static_cast<NumOrders>(__builtin_popcount(n.ask.venues))));
+}
+
+FullL2Quote NBBOEngine::nbbo(const EphemeralSymbolIndex esi, TradingStateBitfield policy) const
+{
+    const View *v = view_(policy);
+    if (nullptr == v) {
+        return FullL2Quote(L2Quote(m_empty_bid, 0, 0), L2Quote(m_empty_ask, 0, 0));
+    }
+    Mutex::scoped_lock lock(m_venues[esi].mutex);
+    return quote_(v->nbbo[esi]);
+}
+
+NBBOEngine::VenueMask NBBOEngine::bid_venues(const EphemeralSymbolIndex esi, TradingStateBitfield policy) const
+{
+    const View *v = view_(policy);
+    if (nullptr == v) {
+        return 0;
+    }
+    Mutex::scoped_lock lock(m_venues[esi].mutex);
+    return v->nbbo[esi].bid.venues;
+}
+
+NBBOEngine::VenueMask NBBOEngine::ask_venues(const EphemeralSymbolIndex esi, TradingStateBitfield policy) const
+{
+    const View *v = view_(policy);
+    if (nullptr == v) {
+        return 0;
+    }
+    Mutex::scoped_lock lock(m_venues[esi].mutex);
+    return v->nbbo[esi].ask.venues;
+}
+
+NBBOEngine::VenueQuote NBBOEngine::venue_quote(const core::MIC &mic, const EphemeralSymbolIndex esi) const
+{
+    if (!m_venues) {
+        return VenueQuote{m_empty_bid, m_empty_ask, 0, 0};
+    }
+    Mutex::scoped_lock lock(m_venues[esi].mutex);
+    return m_venues[esi].quotes[mic.index()];
+}
+
+void NBBOEngine::rescan_side_(SymbolNBBO &n, const SymbolVenues &sv, bool is_bid)
+{
+    auto &side = is_bid ? n.bid : n.ask;
+    const Price empty = is_bid ? m_empty_bid : m_empty_ask;
+    side = SideNBBO{empty, 0, 0};
+    for (int v = 0; v < NUM_VENUES; v++) {
+        const VenueMask bit = VenueMask(1) << v;
+        const Price p = is_bid ? sv.quotes[v].bid_price : sv.quotes[v].ask_price;
+        if (0 == (n.enabled & bit) || empty == p) {
+            continue;
+        }
+        const Size s = is_bid ? sv.quotes[v].bid_size : sv.quotes[v].ask_size;
+        if (0 == side.venues || (is_bid ? p > side.price : p < side.price)) {
+            side = SideNBBO{p, s, bit};
+        } else if (p == side.price) {
+            side.size += s;
+            side.venues |= bit;
+        }
+    }
+}
+
+bool NBBOEngine::fold_side_(SymbolNBBO &n, const SymbolVenues &sv, int venue, bool is_bid, Price p, Size s, Size old_s)
+{
+    auto &side = is_bid ? n.bid : n.ask;
+    const Price empty = is_bid ? m_empty_bid : m_empty_ask;
+    const VenueMask bit = VenueMask(1) << venue;
+    const bool was_at_best = 0 != (side.venues & bit);
+
+    if (empty != p) {
+        if (0 == side.venues || (is_bid ? p > side.price : p < side.price)) {
+            // new best price, this venue alone
+            side = SideNBBO{p, s, bit};
+            return true;
+        }
+        if (p == side.price) {
+            side.size = side.size + s - (was_at_best ? old_s : 0);
+            side.venues |= bit;
+            return true;
+        }
+    }
+
+    // worse than the best price, or gone
+    if (!was_at_best) {
+        return false;
+    }
+    side.venues &= ~bit;
+    side.size -= old_s;
+    if (0 == side.venues) {
+        rescan_side_(n, sv, is_bid);
+    }
+    return true;
+}
+
+NBBOEngine::ViewMask NBBOEngine::update_venue_(int venue, EphemeralSymbolIndex esi, const FullSummary &top)
+{
+    auto &sv = m_venues[esi];
+    auto &q = sv.quotes[venue];
+
+    const Price bid_price = std::get<0>(top.first);
+    const Size bid_size = std::get<1>(top.first);
+    const Price ask_price = std::get<0>(top.second);
+    const Size ask_size = std::get<1>(top.second);
+
+    Mutex::scoped_lock lock(sv.mutex);
+    const bool bid_changed = bid_price != q.bid_price || bid_size != q.bid_size;
+    const bool ask_changed = ask_price != q.ask_price || ask_size != q.ask_size;
+    if (!bid_changed && !ask_changed) {
+        return 0;
+    }
+    const Size old_bid_size = q.bid_size;
+    const Size old_ask_size = q.ask_size;
+    q = VenueQuote{bid_price, ask_price, bid_size, ask_size};
+
+    const VenueMask bit = VenueMask(1) << venue;
+    ViewMask changed = 0;
+    for (std::size_t i = 0; i < m_views.size(); i++) {
+        auto &n = m_views[i]->nbbo[esi];
+        if (0 == (n.enabled & bit)) {
+            continue;
+        }
+        bool c = false;
+        if (bid_changed) {
+            c = fold_side_(n, sv, venue, true, bid_price, bid_size, old_bid_size);
+        }
+        if (ask_changed) {
+            c = fold_side_(n, sv, venue, false, ask_price, ask_size, old_ask_size) || c;
+        }
+        if (c) {
+            changed |= ViewMask(1) << i;
+        }
+    }
+    return changed;
+}
+
+bool NBBOEngine::update_venue(const core::MIC &mic, const EphemeralSymbolIndex esi, const FullSummary &top)
+{
+    if (!m_venues) {
+        return false;
+    }
+    return 0 != update_venue_(mic.index(), esi, top);
+}
+
+bool NBBOEngine::enable_venue_(SymbolNBBO &n, const SymbolVenues &sv, int venue, bool enable)
+{
+    const VenueMask bit = VenueMask(1) << venue;
+    const auto &q = sv.quotes[venue];
+    if (enable == (0 != (n.enabled & bit))) {
+        return false;
+    }
+    bool changed = false;
+    if (enable) {
+        n.enabled |= bit;
+        changed = fold_side_(n, sv, venue, true, q.bid_price, q.bid_size, 0);
+        changed = fold_side_(n, sv, venue, false, q.ask_price, q.ask_size, 0) || changed;
+    } else {
+        // clear from the consolidated quote
+        n.enabled &= ~bit;
+        changed = fold_side_(n, sv, venue, true, m_empty_bid, 0, q.bid_size);
+        changed = fold_side_(n, sv, venue, false, m_empty_ask, 0, q.ask_size) || changed;
+    }
+    return changed;
+}
+
+void NBBOEngine::touch_(const BookBase &b, ViewMask status_changed)
+{
+    if (!m_venues) {
+        return;
+    }
+    auto &p = m_packets[b.mic().index()];
+    const EphemeralSymbolIndex esi = b.symbol_index();
+    Mutex::scoped_lock lock(p.mutex);
+    auto &slot = p.slot_by_esi[esi];
+    if (0 == slot) {
+        p.touched.push_back(Touched{&b, status_changed});
+        slot = static_cast<std::uint32_t>(p.touched.size());
+    } else {
+        p.touched[slot - 1].status_changed |= status_changed;
+    }
+}
+
+void NBBOEngine::on_l2_update(const L2BookEvent &evt)
+{
+    // levels below the top do not change the NBBO
+    if (evt.m_is_bbo) {
+        touch_(evt.m_book);
+    }
+}
+
+void NBBOEngine::on_trading_status_update(const TradingStatusEvent &evt)
+{
+    if (!m_venues) {
+        return;
+    }
+    const ViewMask changed = update_state_(evt.m_book.mic().index(), evt.m_book.symbol_index(), evt.m_event);
+    if (0 != changed) {
+        touch_(evt.m_book, changed);
+    }
+}
+
+NBBOEngine::ViewMask NBBOEngine::update_state_(int venue, EphemeralSymbolIndex esi, TradingStatusEvent::Event e)
+{
+    SymbolState::TradingState ts;
+    switch (e) {
+    case TradingStatusEvent::Event::TRADING:
+        ts = SymbolState::TradingState::TRADING;
+        break;
+    case TradingStatusEvent::Event::HALT:
+        ts = SymbolState::TradingState::HALTED;
+        break;
+    case TradingStatusEvent::Event::QUOTE_ONLY:
+        ts = SymbolState::TradingState::QUOTATION_ONLY;
+        break;
+    default:
+        return 0;
+    }
+    auto &sv = m_venues[esi];
+    ViewMask changed = 0;
+    Mutex::scoped_lock lock(sv.mutex);
+    sv.states[venue] = static_cast<TradingStateBitfield>(ts);
+    for (std::size_t i = 0; i < m_views.size(); i++) {
+        const auto &v = *m_views[i];
+        if (enable_venue_(v.nbbo[esi], sv, venue, enabled_in_(v.policy, sv.states[venue]))) {
+            changed |= ViewMask(1) << i;
+        }
+    }
+    return changed;
+}
+
+void NBBOEngine::publish_(const core::Timestamp &ts, const core::MIC &mic, EphemeralSymbolIndex esi, const View &v)
+{
+    const auto &n = v.nbbo[esi];
+    VenueMask bid_venues, ask_venues;
+    FullL2Quote q;
+    {
+        Mutex::scoped_lock lock(m_venues[esi].mutex);
+        q = quote_(n);
+        bid_venues = n.bid.venues;
+        ask_venues = n.ask.venues;
+    }
+    // outside the lock, so listeners may call back into the engine
+    const NBBOEvent e{ts, mic, esi, q, bid_venues, ask_venues};
+    for (auto l : v.listeners) {
+        l->on_nbbo_event(e);
+    }
+}
+
+void NBBOEngine::publish_(const core::Timestamp &ts, const core::MIC &mic, EphemeralSymbolIndex esi, ViewMask views)
+{
+    for (std::size_t i = 0; i < m_views.size(); i++) {
+        if (0 != (views & (ViewMask(1) << i))) {
+            publish_(ts, mic, esi, *m_views[i]);
+        }
+    }
+}
+
+void NBBOEngine::on_end_of_data(const PacketEvent &evt)
+{
+    if (!m_venues) {
+        return;
+    }
+    auto &p = m_packets[evt.mic.index()];
+    std::vector<Changed> changed;
+    {
+        Mutex::scoped_lock lock(p.mutex);
+        for (const auto &t : p.touched) {
+            const EphemeralSymbolIndex esi = t.book->symbol_index();
+            p.slot_by_esi[esi] = 0;
+            const ViewMask views = update_venue_(evt.mic.index(), esi, t.book->best()) | t.status_changed;
+            if (0 != views) {
+                p.changed.push_back(Changed{esi, views});
+            }
+        }
+        p.touched.clear();
+        changed.swap(p.changed);
+    }
+
+    // listeners are strategies, which may send orders or feed the venue's
+    // next packet: not under the venue's lock
+    for (const auto &c : changed) {
+        publish_(evt.timestamp, evt.mic, c.esi, c.views);
+    }
+
+    changed.clear();
+    Mutex::scoped_lock lock(p.mutex);
+    if (p.changed.capacity() < changed.capacity()) {
+        p.changed.swap(changed);
+    }
+}
+
+void NBBOEngine::on_shard_update(const ShardUpdate &u)
+{
+    if (!m_venues) {
+        return;
+    }
+    const core::MIC mic(u.mic);
+    const int venue = mic.index();
+    switch (u.kind) {
+    case ShardUpdate::Kind::QUOTE:
+    case ShardUpdate::Kind::TRADE: {
+        const FullSummary top{Summary{u.bid.price, u.bid.size, u.bid.num_orders},
+                              Summary{u.ask.price, u.ask.size, u.ask.num_orders}};
+        publish_(u.timestamp, mic, u.esi, update_venue_(venue, u.esi, top));
+        break;
+    }
+    case ShardUpdate::Kind::STATUS:
+        publish_(u.timestamp, mic, u.esi, update_state_(venue, u.esi, u.status));
+        break;
+    case ShardUpdate::Kind::GAP: {
+        // the shard republishes each book's top when it next changes
+        const FullSummary empty{Summary{m_empty_bid, 0, 0}, Summary{m_empty_ask, 0, 0}};
+        for (std::size_t esi = 0; esi < NUM_SYMBOL_INDEX; esi++) {
+            const auto i = static_cast<EphemeralSymbolIndex>(esi);
+            publish_(u.timestamp, mic, i, update_venue_(venue, i, empty));
+        }
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+}}
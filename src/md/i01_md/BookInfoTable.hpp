@@ -0,0 +1,75 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#include <i01_core/Lock.hpp>
+#include <i01_core/macro.hpp>
+
+#include <i01_md/BookBase.hpp>
+#include <i01_md/LastSale.hpp>
+#include <i01_md/Symbol.hpp>
+#include <i01_md/SymbolState.hpp>
+
+namespace i01 { namespace MD {
+
+/// Per-ESI book information, split by access pattern:
+///
+/// - hot: book pointer and last sale, read on every message and by
+///   strategies, packed densely so neighbouring symbols share lines.
+/// - state: symbol trading state, written only on status messages.
+/// - mutex: one cache line per symbol, since it is written by whichever
+///   thread takes it and must not invalidate the hot or state lines.
+template <std::size_t N>
+class BookInfoTable {
+public:
+    using SymbolMutex = core::SpinRWMutex;
+
+    struct HotInfo {
+        BookBase *book_p;
+        LastSale last_sale;
+    };
+
+private:
+    struct alignas(64) PaddedMutex {
+        SymbolMutex mutex;
+    };
+
+public:
+    BookInfoTable() : m_hot(), m_state(), m_mutex() {}
+    BookInfoTable(const BookInfoTable &) = delete;
+    BookInfoTable & operator=(const BookInfoTable &) = delete;
+
+    static constexpr std::size_t size() { return N; }
+
+    BookBase *& book(const EphemeralSymbolIndex esi) noexcept { return m_hot[esi].book_p; }
+    const BookBase * book(const EphemeralSymbolIndex esi) const noexcept { return m_hot[esi].book_p; }
+
+    LastSale & last_sale(const EphemeralSymbolIndex esi) noexcept { return m_hot[esi].last_sale; }
+    const LastSale & last_sale(const EphemeralSymbolIndex esi) const noexcept { return m_hot[esi].last_sale; }
+
+    SymbolState & state(const EphemeralSymbolIndex esi) noexcept { return m_state[esi]; }
+    const SymbolState & state(const EphemeralSymbolIndex esi) const noexcept { return m_state[esi]; }
+
+    SymbolMutex & mutex(const EphemeralSymbolIndex esi) noexcept { return m_mutex[esi].mutex; }
+
+    /// Hint that esi's hot entry will be needed soon, e.g. for the next
+    //  message in a packet.  Never faults.
+    void prefetch(const EphemeralSymbolIndex esi) const noexcept { PREFETCH(&m_hot[esi]); }
+
+    /// Hint that esi's book will be written soon.  This loads the hot
+    //  entry, so prefer prefetch() when it is not already in cache.
+    void prefetch_book(const EphemeralSymbolIndex esi) const noexcept {
+        const BookBase *b = m_hot[esi].book_p;
+        if (nullptr != b) {
+            PREFETCHW(b);
+        }
+    }
+
+private:
+    alignas(64) std::array<HotInfo, N> m_hot;
+    alignas(64) std::array<SymbolState, N> m_state;
+    std::array<PaddedMutex, N> m_mutex;
+};
+
+}}
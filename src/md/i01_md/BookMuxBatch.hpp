@@ -0,0 +1,329 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+#include <i01_core/MIC.hpp>
+#include <i01_core/macro.hpp>
+#include <i01_core/Time.hpp>
+
+#include <i01_md/BookBase.hpp>
+#include <i01_md/BookMuxEvents.hpp>
+#include <i01_md/L2Book.hpp>
+#include <i01_md/OrderData.hpp>
+#include <i01_md/Symbol.hpp>
+
+namespace i01 { namespace MD {
+
+/// All of one symbol's book events within a batch, coalesced.
+struct BookBatchEntry {
+    typedef core::Timestamp Timestamp;
+
+    enum Side : std::uint8_t {
+        BID = 1,
+        ASK = 2,
+    };
+
+    const BookBase *m_book;
+    EphemeralSymbolIndex m_esi;
+    std::uint32_t m_num_events;
+    /// Bitmask of the Sides touched by the events.
+    std::uint8_t m_sides;
+    /// True if m_best differs from the top this symbol had when it was last
+    //  delivered in a batch.
+    bool m_top_changed;
+    Timestamp m_first_timestamp;
+    Timestamp m_last_timestamp;
+    /// Top of book when the batch was delivered.
+    FullSummary m_best;
+};
+
+/// One book event of a batch, copied out of the decoder's event so that it
+/// outlives it.  The accessor matching m_type rebuilds the original event,
+/// referring into this copy.
+struct BookBatchItem {
+    typedef core::Timestamp Timestamp;
+    typedef OrderBook::Order Order;
+
+    enum class Type : std::uint8_t {
+        L3_ADD = 1,
+        L3_CANCEL = 2,
+        L3_MODIFY = 3,
+        L3_EXECUTION = 4,
+        L2_UPDATE = 5,
+    };
+
+    Type m_type;
+    Timestamp m_timestamp;
+    /// L3_EXECUTION only.
+    Timestamp m_exchange_timestamp;
+    const BookBase *m_book;
+    /// The order, or the new order of an L3_MODIFY.
+    Order m_order;
+    /// The old refnum of an L3_MODIFY, the trade id of an L3_EXECUTION.
+    Order::RefNum m_refnum;
+    /// The old price of an L3_MODIFY, the execution price of an
+    //  L3_EXECUTION, the level price of an L2_UPDATE.
+    Price m_price;
+    /// The execution size of an L3_EXECUTION, the level size of an
+    //  L2_UPDATE.
+    Size m_size;
+    /// The size before the event, L3 events other than L3_ADD.
+    Size m_old_size;
+    Size m_delta_size;
+    NumOrders m_num_orders;
+    L2BookEvent::DeltaReasonCode m_reason;
+    bool m_is_buy;
+    bool m_is_bbo;
+    bool m_is_reduced;
+    bool m_nonprintable;
+
+    const OrderBook & order_book() const { return static_cast<const OrderBook &>(*m_book); }
+    const L2Book & l2_book() const { return static_cast<const L2Book &>(*m_book); }
+
+    L3AddEvent l3_add() const { return L3AddEvent{m_timestamp, order_book(), m_order}; }
+    L3CancelEvent l3_cancel() const { return L3CancelEvent{m_timestamp, order_book(), m_order, m_old_size}; }
+    L3ModifyEvent l3_modify() const { return L3ModifyEvent{m_timestamp, order_book(), m_order, m_refnum, m_price, m_old_size}; }
+    L3ExecutionEvent l3_execution() const {
+        return L3ExecutionEvent{m_timestamp, m_exchange_timestamp, order_book(), m_order, m_refnum, m_price, m_size, m_old_size, m_nonprintable};
+    }
+    L2BookEvent l2_update() const {
+        return L2BookEvent{m_timestamp, l2_book(), m_is_buy, m_is_bbo, m_is_reduced, m_price, m_size, m_num_orders, m_delta_size, m_reason};
+    }
+};
+
+/// Book events of one packet: the events themselves in feed order, and a
+/// summary entry per symbol in order of first event.  Delivered early,
+/// with m_end_of_packet false, if the batch buffer fills up or an event
+/// that is not batched arrives mid-packet, so that listeners always see
+/// events in feed order.  Both arrays are only valid during the callback.
+struct BookBatchEvent {
+    typedef core::Timestamp Timestamp;
+    typedef core::MIC MIC;
+    typedef const BookBatchEntry * const_iterator;
+
+    const Timestamp &m_timestamp;
+    const MIC &m_mic;
+    const BookBatchEntry *m_entries;
+    std::size_t m_num_entries;
+    const BookBatchItem *m_events;
+    std::size_t m_num_events;
+    bool m_end_of_packet;
+
+    const_iterator begin() const { return m_entries; }
+    const_iterator end() const { return m_entries + m_num_entries; }
+    std::size_t size() const { return m_num_entries; }
+    bool empty() const { return 0 == m_num_entries; }
+};
+
+/// Describes how a book mux event is folded into a batch.  Only book
+/// changes are batched; trades, status and the rest are always delivered
+/// as they arrive.
+template<typename Event>
+struct BookBatchTraits {
+    static const bool batchable = false;
+};
+
+template<typename L3Event>
+struct L3BookBatchTraits {
+    static const bool batchable = true;
+
+    static const BookBase & book(const L3Event &e) { return e.m_book; }
+    static const core::Timestamp & timestamp(const L3Event &e) { return e.m_timestamp; }
+    static std::uint8_t order_side(const OrderBook::Order &o) {
+        return OrderBook::Order::Side::BUY == o.side ? BookBatchEntry::BID : BookBatchEntry::ASK;
+    }
+};
+
+template<>
+struct BookBatchTraits<L3AddEvent> : public L3BookBatchTraits<L3AddEvent> {
+    static std::uint8_t side(const L3AddEvent &e) { return L3BookBatchTraits::order_side(e.m_order); }
+    static void store(BookBatchItem &i, const L3AddEvent &e) {
+        i.m_type = BookBatchItem::Type::L3_ADD;
+        i.m_order = e.m_order;
+    }
+};
+
+template<>
+struct BookBatchTraits<L3CancelEvent> : public L3BookBatchTraits<L3CancelEvent> {
+    static std::uint8_t side(const L3CancelEvent &e) { return L3BookBatchTraits::order_side(e.m_order); }
+    static void store(BookBatchItem &i, const L3CancelEvent &e) {
+        i.m_type = BookBatchItem::Type::L3_CANCEL;
+        i.m_order = e.m_order;
+        i.m_old_size = e.m_old_size;
+    }
+};
+
+template<>
+struct BookBatchTraits<L3ModifyEvent> : public L3BookBatchTraits<L3ModifyEvent> {
+    static std::uint8_t side(const L3ModifyEvent &e) { return L3BookBatchTraits::order_side(e.m_new_order); }
+    static void store(BookBatchItem &i, const L3ModifyEvent &e) {
+        i.m_type = BookBatchItem::Type::L3_MODIFY;
+        i.m_order = e.m_new_order;
+        i.m_refnum = e.m_old_refnum;
+        i.m_price = e.m_old_price;
+        i.m_old_size = e.m_old_size;
+    }
+};
+
+template<>
+struct BookBatchTraits<L3ExecutionEvent> : public L3BookBatchTraits<L3ExecutionEvent> {
+    static std::uint8_t side(const L3ExecutionEvent &e) { return L3BookBatchTraits::order_side(e.m_order); }
+    static void store(BookBatchItem &i, const L3ExecutionEvent &e) {
+        i.m_type = BookBatchItem::Type::L3_EXECUTION;
+        i.m_exchange_timestamp = e.m_exchange_timestamp;
+        i.m_order = e.m_order;
+        i.m_refnum = e.m_trade_id;
+        i.m_price = e.m_exec_price;
+        i.m_size = e.m_exec_size;
+        i.m_old_size = e.m_old_size;
+        i.m_nonprintable = e.m_nonprintable;
+    }
+};
+
+template<>
+struct BookBatchTraits<L2BookEvent> {
+    static const bool batchable = true;
+
+    static const BookBase & book(const L2BookEvent &e) { return e.m_book; }
+    static const core::Timestamp & timestamp(const L2BookEvent &e) { return e.m_timestamp; }
+    static std::uint8_t side(const L2BookEvent &e) { return e.m_is_buy ? BookBatchEntry::BID : BookBatchEntry::ASK; }
+    static void store(BookBatchItem &i, const L2BookEvent &e) {
+        i.m_type = BookBatchItem::Type::L2_UPDATE;
+        i.m_is_buy = e.m_is_buy;
+        i.m_is_bbo = e.m_is_bbo;
+        i.m_is_reduced = e.m_is_reduced;
+        i.m_price = e.m_price;
+        i.m_size = e.m_size;
+        i.m_num_orders = e.m_num_orders;
+        i.m_delta_size = e.m_delta_size;
+        i.m_reason = e.m_reason;
+    }
+};
+
+/// A listener opts in to batching by implementing
+//  void on_book_batch(const BookBatchEvent &).
+template<typename Listener>
+struct IsBookBatchListener {
+private:
+    template<typename L>
+    static auto test(int) -> decltype(std::declval<L &>().on_book_batch(std::declval<const BookBatchEvent &>()), std::true_type());
+    template<typename>
+    static std::false_type test(...);
+
+public:
+    static const bool value = decltype(test<Listener>(0))::value;
+};
+
+template<typename... Listeners>
+struct AnyBookBatchListener;
+
+template<>
+struct AnyBookBatchListener<> : public std::false_type {};
+
+template<typename Listener, typename... Listeners>
+struct AnyBookBatchListener<Listener, Listeners...>
+    : public std::integral_constant<bool, IsBookBatchListener<Listener>::value || AnyBookBatchListener<Listeners...>::value> {};
+
+/// Fixed capacity, allocation free accumulator for one batch.  Holds up
+/// to CAPACITY events, and so at most as many symbols.  Entries are found
+/// by ESI through a slot table, so recording an event is O(1) and
+/// resetting only touches the symbols in the batch.
+template<std::size_t CAPACITY = 256>
+class BookBatchBuffer {
+public:
+    static_assert(CAPACITY > 0 && CAPACITY < std::numeric_limits<std::uint16_t>::max(), "BookBatchBuffer: CAPACITY must fit a 16 bit slot");
+
+    typedef core::Timestamp Timestamp;
+
+    static const std::size_t capacity = CAPACITY;
+
+public:
+    BookBatchBuffer() : m_size(0), m_num_events(0), m_slot() {
+        const Price empty_bid = BookBase::EMPTY_BID_PRICE;
+        const Price empty_ask = BookBase::EMPTY_ASK_PRICE;
+        m_last_best.fill(FullSummary{ Summary{ empty_bid, 0, 0 }, Summary{ empty_ask, 0, 0 } });
+    }
+    BookBatchBuffer(const BookBatchBuffer &) = delete;
+    BookBatchBuffer & operator=(const BookBatchBuffer &) = delete;
+
+    /// Number of symbols in the batch.
+    std::size_t size() const { return m_size; }
+    std::size_t num_events() const { return m_num_events; }
+    bool empty() const { return 0 == m_num_events; }
+    const BookBatchItem * events() const { return m_events.data(); }
+
+    /// Copy event e into the batch and fold it into its symbol's entry.
+    /// Returns false, recording nothing, if the buffer is full.
+    template<typename Event>
+    bool record(const Event &e) {
+        using Traits = BookBatchTraits<Event>;
+        if (UNLIKELY(m_num_events == CAPACITY)) {
+            return false;
+        }
+        const BookBase &b = Traits::book(e);
+        const Timestamp &ts = Traits::timestamp(e);
+        const std::uint8_t side = Traits::side(e);
+
+        auto &i = m_events[m_num_events++];
+        i.m_timestamp = ts;
+        i.m_book = &b;
+        Traits::store(i, e);
+
+        const EphemeralSymbolIndex esi = b.symbol_index();
+        auto &slot = m_slot[esi];
+        if (slot) {
+            auto &entry = m_entries[slot - 1];
+            ++entry.m_num_events;
+            entry.m_sides |= side;
+            entry.m_last_timestamp = ts;
+            return true;
+        }
+        auto &entry = m_entries[m_size];
+        entry.m_book = &b;
+        entry.m_esi = esi;
+        entry.m_num_events = 1;
+        entry.m_sides = side;
+        entry.m_top_changed = false;
+        entry.m_first_timestamp = ts;
+        entry.m_last_timestamp = ts;
+        slot = static_cast<std::uint16_t>(++m_size);
+        return true;
+    }
+
+    /// Read each symbol's top of book, once per batch, and return the
+    /// entries for delivery.
+    const BookBatchEntry * finish() {
+        for (std::size_t i = 0; i < m_size; ++i) {
+            auto &e = m_entries[i];
+            e.m_best = e.m_book->best();
+            auto &last = m_last_best[e.m_esi];
+            e.m_top_changed = e.m_best != last;
+            last = e.m_best;
+        }
+        return m_entries.data();
+    }
+
+    void reset() {
+        for (std::size_t i = 0; i < m_size; ++i) {
+            m_slot[m_entries[i].m_esi] = 0;
+        }
+        m_size = 0;
+        m_num_events = 0;
+    }
+
+private:
+    std::array<BookBatchItem, CAPACITY> m_events;
+    std::array<BookBatchEntry, CAPACITY> m_entries;
+    std::size_t m_size;
+    std::size_t m_num_events;
+    /// 1 + index into m_entries of each symbol in the batch, 0 if absent.
+    std::array<std::uint16_t, NUM_SYMBOL_INDEX> m_slot;
+    std::array<FullSummary, NUM_SYMBOL_INDEX> m_last_best;
+};
+
+}}
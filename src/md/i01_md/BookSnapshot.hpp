@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+
+#include <i01_core/SeqLock.hpp>
+
+#include <i01_md/OrderData.hpp>
+
+namespace i01 { namespace MD {
+
+/// POD price level, as published to readers.
+struct QuoteLevel {
+    Price price;
+    Size size;
+    NumOrders num_orders;
+
+    L2Quote quote() const { return L2Quote{ price, size, num_orders }; }
+};
+
+/// Top of book, fits in one cache line with its sequence number.
+struct BookBest {
+    QuoteLevel bid;
+    QuoteLevel ask;
+};
+
+/// Top DEPTH levels per side, best first.
+template <std::size_t DEPTH>
+struct BookTop {
+    std::uint32_t num_bids;
+    std::uint32_t num_asks;
+    QuoteLevel bids[DEPTH];
+    QuoteLevel asks[DEPTH];
+};
+
+/// Seqlock-published top of book and top DEPTH levels of a book, so that
+/// strategy threads can read them wait-free while the decoder thread is
+/// writing.  The book's own mutex is still needed for anything deeper.
+///
+/// The publish_* methods must only be called by the single book writer.
+template <std::size_t DEPTH = 5>
+class BookSnapshot {
+public:
+    static const std::size_t depth = DEPTH;
+    typedef BookTop<DEPTH> Top;
+
+public:
+    BookSnapshot(Price empty_bid, Price empty_ask) {
+        m_empty_best = BookBest{ QuoteLevel{ empty_bid, 0, 0 }, QuoteLevel{ empty_ask, 0, 0 } };
+        m_best.store(m_empty_best);
+        m_top_shadow.num_bids = 0;
+        m_top_shadow.num_asks = 0;
+        m_top.store(m_top_shadow);
+    }
+
+    BookBest best() const { return m_best.load(); }
+    Top top() const { return m_top.load(); }
+
+    /// Writer's copy of the last published top levels.
+    const Top & last_top() const { return m_top_shadow; }
+
+    void publish_best(const QuoteLevel &bid, const QuoteLevel &ask) {
+        m_best.store(BookBest{ bid, ask });
+    }
+
+    /// Writer's buffer for one side's levels: fill it, set its size with
+    //  top_side_size(), then publish_top().
+    QuoteLevel * top_side(bool is_bid) { return is_bid ? m_top_shadow.bids : m_top_shadow.asks; }
+    void top_side_size(bool is_bid, std::size_t n) {
+        (is_bid ? m_top_shadow.num_bids : m_top_shadow.num_asks) = static_cast<std::uint32_t>(n);
+    }
+    void publish_top() { m_top.store(m_top_shadow); }
+
+    /// Would a change at price p on this side alter the published top levels?
+    //  better is the side's price comparator.
+    template <typename Better>
+    bool affects_top(bool is_bid, const Price &p, Better better) const {
+        const auto n = is_bid ? m_top_shadow.num_bids : m_top_shadow.num_asks;
+        if (n < DEPTH) {
+            return true;
+        }
+        const auto &worst = (is_bid ? m_top_shadow.bids : m_top_shadow.asks)[n - 1];
+        return !better(worst.price, p);
+    }
+
+    void clear() {
+        m_best.store(m_empty_best);
+        m_top_shadow.num_bids = 0;
+        m_top_shadow.num_asks = 0;
+        m_top.store(m_top_shadow);
+    }
+
+private:
+    core::SeqLock<BookBest> m_best;
+    core::SeqLock<Top> m_top;
+    BookBest m_empty_best;
+    Top m_top_shadow;
+};
+
+template <std::size_t DEPTH>
+const std::size_t BookSnapshot<DEPTH>::depth;
+
+}}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <functional>
+#include <memory>
 #include <set>
 #include <type_traits>
 #include <utility>
@@ -18,6 +19,8 @@
 #include <i01_md/HistoricalData.hpp>
 #include <i01_md/LastSale.hpp>
 #include <i01_md/MDEventPoller.hpp>
+#include <i01_md/NBBOEngine.hpp>
+#include <i01_md/ShardedDispatch.hpp>
 #include <i01_md/util.hpp>
 
 #include <i01_md/ARCA/XDP/BookMux.hpp>
@@ -201,6 +204,33 @@ public:
     bool read_until(const core::Timestamp &t);
 
     void start_event_pollers();
+    /// The md event pollers' poll modes and counters, for status output.
+    std::string status() const { return m_md_pollers.status(); }
+
+    /// Apply the pollers' receive settings, and set up sharded dispatch
+    /// if the md config asks for it.  Call after init() has created the
+    /// event pollers and before start_event_pollers(), as the engine
+    /// does; without it the eventpollers.* receive settings and
+    /// md.dispatch are ignored.  In sharded mode
+    /// registered listeners are still called on the poller thread that
+    /// decoded the event, and the NBBOEngine is fed from the per-poller
+    /// rings on the "mdnbbo" thread that start_dispatch() spawns; other
+    /// cross-venue consumers may poll the rings through shards().
+    void init_dispatch(const core::Config::storage_type& cfg);
+    bool sharded() const { return m_shards.enabled(); }
+    ShardedDispatcher& shards() { return m_shards; }
+
+    /// In sharded mode, spawn the NBBOEngine's consumer thread if anything
+    /// has subscribed to the NBBO.  Call with the pollers.
+    bool start_dispatch();
+    /// Join the NBBOEngine's consumer thread; call before destroying its
+    /// listeners.
+    void stop_dispatch();
+
+    /// Consolidated quotes across venues.  Only maintained once something
+    /// has subscribed to it.
+    NBBOEngine& nbbo() { return m_nbbo; }
+    const NBBOEngine& nbbo() const { return m_nbbo; }
 
     Date date() const { return m_date; }
 
@@ -244,6 +274,9 @@ private:
     int m_verbose_level;
 
     MDEventPoller m_md_pollers;
+    ShardedDispatcher m_shards;
+    NBBOEngine m_nbbo;
+    std::unique_ptr<ShardConsumerThread> m_nbbo_thread;
 
     FS::FeedStateByMICFeedName<PITCHUnitState> m_pitch_family_feed_state;
     FS::FeedStateByMICFeedName<ITCHUnitState> m_itch_family_feed_state;
@@ -256,9 +289,44 @@ private:
     DecoderByMIC<PDPDecoder> m_pdp_family_decoders;
 };
 
+inline void DataManager::init_dispatch(const core::Config::storage_type& cfg)
+{
+    m_md_pollers.configure_pollers(cfg);
+    if (ShardedDispatcher::configured(cfg) && !m_shards.init(m_md_pollers.get_config(), cfg)) {
+        std::cerr << "DataManager: init_dispatch: falling back to serial dispatch" << std::endl;
+    }
+}
+
+inline bool DataManager::start_dispatch()
+{
+    if (!m_shards.enabled() || !m_nbbo.active() || m_nbbo_thread) {
+        return true;
+    }
+    m_nbbo_thread.reset(new ShardConsumerThread("mdnbbo", m_shards, m_nbbo));
+    if (!m_nbbo_thread->spawn()) {
+        std::cerr << "DataManager: start_dispatch: failed to spawn " << m_nbbo_thread->name() << std::endl;
+        m_nbbo_thread.reset();
+        return false;
+    }
+    return true;
+}
+
+inline void DataManager::stop_dispatch()
+{
+    if (m_nbbo_thread) {
+        m_nbbo_thread->stop();
+    }
+}
+
 template<typename ArgType>
 void DataManager::dispatch(void(BookMuxListener::*mfp)(ArgType), ArgType && arg)
 {
+    if (m_shards.enabled()) {
+        // the NBBOEngine reads the rings on its own thread
+        m_shards.publish(arg);
+    } else if (m_nbbo.active()) {
+        (m_nbbo.*mfp)(arg);
+    }
     for (auto l : m_listeners) {
         (l->*mfp)(std::forward<ArgType>(arg));
     }
@@ -0,0 +1,248 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <i01_core/MappedRegion.hpp>
+#include <i01_core/MIC.hpp>
+#include <i01_core/Time.hpp>
+
+#include <i01_md/BookMuxListener.hpp>
+#include <i01_md/L2Book.hpp>
+#include <i01_md/OrderBook.hpp>
+
+namespace i01 { namespace MD {
+
+/// Pre-decoded market data archive.
+///
+/// A normalized copy of the BookMuxListener event stream, written once
+/// from pcap and replayed without touching the network stack or the
+/// venue decoders.  The file is
+///
+///     ArchiveHeader | ArchiveRecord[num_records] | ArchiveSymbol[num_symbols]
+///                   | ArchiveIndexEntry[num_index_entries]
+///
+/// in host byte order.  Records are fixed size, so the reader walks a
+/// memory mapping of the file.
+///
+/// Order level events are archived as orders, and replayed through
+/// on_book_added() and the rest against OrderBooks the reader rebuilds;
+/// L2 updates are archived as the level and replayed through
+/// on_l2_update() against L2Books.  Imbalance events refer to venue
+/// messages and are not archived.
+namespace Archive {
+
+enum class RecordType : std::uint8_t {
+    UNKNOWN = 0,
+    SYMBOL_DEFINITION = 1,
+    /// A price level after an L2 update or an order event.
+    LEVEL = 2,
+    TRADE = 3,
+    TRADING_STATUS = 4,
+    GAP = 5,
+    FEED = 6,
+    START_OF_DATA = 7,
+    END_OF_DATA = 8,
+    L3_ADD = 9,
+    L3_CANCEL = 10,
+    L3_MODIFY = 11,
+    L3_EXECUTION = 12,
+};
+std::ostream & operator<<(std::ostream &, const RecordType &);
+
+/// Flags bits.
+enum RecordFlags : std::uint8_t {
+    BUY = 0x01,
+    CROSS = 0x02,
+    NONPRINTABLE = 0x04,
+};
+
+/// ArchiveSymbol flags bits.
+enum SymbolFlags : std::uint8_t {
+    /// The venue's books are order books.
+    L3_BOOK = 0x01,
+};
+
+struct ArchiveHeader {
+    std::uint32_t magic_number;
+    std::uint32_t version;
+    std::uint32_t record_size;
+    std::uint32_t index_interval_s;
+    std::uint64_t num_records;
+    std::uint64_t num_symbols;
+    std::uint64_t num_index_entries;
+    /// Nanoseconds since the epoch.
+    std::uint64_t first_timestamp;
+    std::uint64_t last_timestamp;
+} __attribute__((packed));
+std::ostream & operator<<(std::ostream &, const ArchiveHeader &);
+
+/// Fields by type:
+///   LEVEL: flags BUY, price, size and num_orders of the level, delta
+///     (size change, unsigned), code the L2BookEvent::DeltaReasonCode.
+///   L3_ADD: flags BUY, refnum, price and size of the order.
+///   L3_CANCEL: flags BUY, refnum and price of the order, size left,
+///     delta the size canceled.
+///   L3_MODIFY: flags BUY, refnum, price and size of the new order, delta
+///     the old refnum, aux the old price, num_orders the old size.
+///   L3_EXECUTION: flags BUY and NONPRINTABLE, refnum of the order, size
+///     left, price the execution price, delta the size executed, aux the
+///     trade id, exchange_timestamp.
+///   TRADE: code the passive OrderBook::Order::Side, flags CROSS, price,
+///     delta (size), refnum (trade id), exchange_timestamp.
+///   TRADING_STATUS: code the TradingStatusEvent::Event.
+///   GAP: refnum expected, delta received seqnum, exchange_timestamp the
+///     prior timestamp.
+///   FEED: code the FeedEvent::EventCode, exchange_timestamp.
+struct ArchiveRecord {
+    std::uint64_t timestamp;
+    std::uint64_t exchange_timestamp;
+    RecordType type;
+    std::uint8_t mic;
+    std::uint8_t flags;
+    std::uint8_t code;
+    std::uint32_t esi;
+    std::uint64_t price;
+    std::uint64_t refnum;
+    std::uint64_t delta;
+    std::uint32_t size;
+    std::uint32_t num_orders;
+    std::uint64_t aux;
+} __attribute__((packed));
+static_assert(sizeof(ArchiveRecord) == 64, "ArchiveRecord must be 64 bytes");
+std::ostream & operator<<(std::ostream &, const ArchiveRecord &);
+
+struct ArchiveSymbol {
+    std::uint8_t mic;
+    std::uint8_t flags;
+    std::uint8_t reserved[2];
+    std::uint32_t esi;
+    char ticker[24];
+} __attribute__((packed));
+
+/// The first record at or after timestamp.
+struct ArchiveIndexEntry {
+    std::uint64_t timestamp;
+    std::uint64_t record;
+} __attribute__((packed));
+
+/// Records BookMuxListener events to an archive.  Register it with the
+/// DataManager (or a BookMux) and read the pcaps; close() writes the
+/// symbol table and time index.
+class Writer : public NoopBookMuxListener {
+public:
+    static const std::uint32_t MAGIC_NUMBER = 0xA2C01DA7;
+    static const std::uint32_t VERSION_NUMBER = 0x02;
+    /// Version 1 archived order events as LEVEL records; it still reads.
+    static const std::uint32_t MIN_VERSION_NUMBER = 0x01;
+    static const std::uint32_t DEFAULT_INDEX_INTERVAL_S = 1;
+
+public:
+    /// Throws std::runtime_error if path cannot be created.
+    Writer(const std::string& path, std::uint32_t index_interval_s = DEFAULT_INDEX_INTERVAL_S);
+    virtual ~Writer();
+
+    /// Returns false if the file could not be completed.  Idempotent.
+    bool close();
+
+    const ArchiveHeader& header() const { return m_header; }
+
+    virtual void on_symbol_definition(const SymbolDefEvent &) override final;
+    virtual void on_book_added(const L3AddEvent&) override final;
+    virtual void on_book_canceled(const L3CancelEvent&) override final;
+    virtual void on_book_modified(const L3ModifyEvent&) override final;
+    virtual void on_book_executed(const L3ExecutionEvent&) override final;
+    virtual void on_l2_update(const L2BookEvent&) override final;
+    virtual void on_trade(const TradeEvent&) override final;
+    virtual void on_gap(const GapEvent&) override final;
+    virtual void on_trading_status_update(const TradingStatusEvent&) override final;
+    virtual void on_feed_event(const FeedEvent&) override final;
+    virtual void on_start_of_data(const PacketEvent&) override final;
+    virtual void on_end_of_data(const PacketEvent&) override final;
+
+private:
+    ArchiveRecord& next_(RecordType t, const core::Timestamp& ts, const core::MIC& m, EphemeralSymbolIndex esi);
+    ArchiveRecord& order_(RecordType t, const core::Timestamp& ts, const BookBase& b, const OrderBook::Order& o);
+    bool flush_();
+
+private:
+    std::string m_path;
+    std::FILE * m_file;
+    ArchiveHeader m_header;
+    std::vector<ArchiveRecord> m_buffer;
+    std::size_t m_buffered;
+    std::vector<ArchiveSymbol> m_symbols;
+    std::vector<ArchiveIndexEntry> m_index;
+    /// By mic, whether it sent order events.
+    std::vector<bool> m_l3_mics;
+    bool m_ok;
+};
+
+/// Replays an archive into a BookMuxListener from a read only mapping.
+class Reader {
+public:
+    /// Throws std::runtime_error if path is not a complete archive.
+    explicit Reader(const std::string& path);
+    ~Reader();
+    Reader(const Reader&) = delete;
+    Reader& operator=(const Reader&) = delete;
+
+    const ArchiveHeader& header() const { return *m_header; }
+    std::uint64_t size() const { return m_header->num_records; }
+    /// Index of the next record to replay.
+    std::uint64_t position() const { return m_pos; }
+    bool done() const { return m_pos >= m_header->num_records; }
+
+    const ArchiveRecord* records() const { return m_records; }
+    const ArchiveSymbol* symbols() const { return m_symbols; }
+    const ArchiveIndexEntry* index() const { return m_index; }
+
+    /// The first record at or after ts, by the time index.
+    std::uint64_t find(const core::Timestamp& ts) const;
+
+    /// Replay up to n records, returns the number replayed.
+    std::uint64_t read_records(BookMuxListener& l, std::uint64_t n = ~0ULL);
+    /// Replay the records before ts.
+    std::uint64_t read_until(BookMuxListener& l, const core::Timestamp& ts);
+    /// Apply the records before ts to the books without any callbacks.
+    std::uint64_t skip_until(const core::Timestamp& ts);
+
+    /// The replay books, or nullptr if the archive has no events for them.
+    const L2Book* book(const core::MIC& m, EphemeralSymbolIndex esi) const;
+    const OrderBook* l3_book(const core::MIC& m, EphemeralSymbolIndex esi) const;
+
+    /// Start again from the first record with empty books.
+    void rewind();
+
+private:
+    L2Book& book_(std::uint8_t mic, std::uint32_t esi);
+    OrderBook& l3_book_(std::uint8_t mic, std::uint32_t esi);
+    /// The book trades and status updates refer to.
+    const BookBase& venue_book_(std::uint8_t mic, std::uint32_t esi);
+    void replay_(const ArchiveRecord& r, BookMuxListener* l);
+    void replay_l3_(const ArchiveRecord& r, const core::Timestamp& ts, BookMuxListener* l);
+
+private:
+    core::MappedRegion m_file;
+    const ArchiveHeader* m_header;
+    const ArchiveRecord* m_records;
+    const ArchiveSymbol* m_symbols;
+    const ArchiveIndexEntry* m_index;
+    std::uint64_t m_pos;
+
+    std::vector<core::MIC> m_mics;
+    std::vector<std::string> m_tickers;
+    /// By mic and esi, 1 + the symbol table entry, or 0.
+    std::vector<std::uint32_t> m_ticker_slots;
+    std::vector<std::unique_ptr<L2Book> > m_books;
+    std::vector<std::unique_ptr<OrderBook> > m_l3_books;
+    std::vector<bool> m_l3_mics;
+};
+
+}
+
+}}
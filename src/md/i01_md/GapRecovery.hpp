@@ -0,0 +1,272 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <i01_core/Time.hpp>
+#include <i01_core/TimerListener.hpp>
+
+#include <i01_net/SocketListener.hpp>
+#include <i01_net/TCPSocket.hpp>
+#include <i01_net/UDPSocket.hpp>
+
+namespace i01 { namespace MD {
+
+/// A range of messages for a RecoveryTransport to have sent again.
+struct RecoveryRequest {
+    core::Timestamp timestamp;
+    std::uint8_t unit;
+    /// First missing message.
+    std::uint64_t seqnum;
+    std::uint64_t count;
+    /// The MoldUDP64 session of the unit's last packet; blank for PITCH.
+    std::array<char, 10> session;
+};
+
+/// How GapRecovery asks for missing messages.  The retransmitted packets
+/// come back to GapRecovery::on_recv() like any others, from whichever
+/// socket they arrive on.
+class RecoveryTransport {
+public:
+    virtual ~RecoveryTransport() = default;
+    /// False if the request could not be sent; GapRecovery then gives up
+    /// on the gap.
+    virtual bool request(const RecoveryRequest &) = 0;
+};
+
+class GapRecoveryListener {
+public:
+    virtual ~GapRecoveryListener() = default;
+    /// Messages expected..received-1 of unit are missing and have been
+    /// asked for; packets after them are held back until they arrive.
+    virtual void on_recovery_started(const core::Timestamp &, std::uint8_t unit, std::uint64_t expected, std::uint64_t received) {}
+    /// The gap was filled and the packets held back passed on in order.
+    virtual void on_recovery_complete(const core::Timestamp &, std::uint8_t unit, const core::Timestamp &time_to_recover, std::size_t packets_buffered) {}
+    /// Messages expected..received-1 of unit are lost: what was held back
+    /// has been passed on anyway, so the decoder sees the gap as if there
+    /// had been no recovery.  This is the place to clear_books_in_unit()
+    /// and wait for a snapshot.
+    virtual void on_recovery_failed(const core::Timestamp &, std::uint8_t unit, std::uint64_t expected, std::uint64_t received) {}
+};
+
+struct GapRecoveryStats {
+    std::uint64_t gaps = 0;
+    std::uint64_t recovered = 0;
+    std::uint64_t failed = 0;
+    /// Requests sent, first and repeated.
+    std::uint64_t requests = 0;
+    /// Packets held back behind a gap.
+    std::uint64_t packets_buffered = 0;
+    /// The most held back at once on one unit.
+    std::uint64_t max_buffered = 0;
+    /// Packets seen again that had already been passed on.
+    std::uint64_t duplicates = 0;
+    core::Timestamp last_time_to_recover;
+    core::Timestamp max_time_to_recover;
+    core::Timestamp total_time_to_recover;
+};
+
+struct GapRecoveryConfig {
+    /// Packets held back per unit.
+    std::size_t ring_size = 4096;
+    /// Largest packet that can be held back.
+    std::size_t max_packet_size = 2048;
+    core::Timestamp retry_timeout = core::Timestamp{0, 50000000};
+    unsigned max_retries = 3;
+    /// Largest count in one request.
+    std::uint64_t max_request = 0xffff;
+};
+
+/// Sits between a feed's sockets and its decoder, and fills gaps in the
+/// sequence before the decoder sees them.
+///
+/// Packets are passed through to the decoder while they are in sequence.
+/// When one arrives ahead of the next expected message, the missing range
+/// is asked for over the RecoveryTransport and later packets are held in
+/// the unit's ring, in sequence order, instead of being passed on.  As the
+/// retransmitted packets arrive they are passed on, followed by whatever
+/// they make contiguous, so the decoder only ever sees the feed in order.
+/// A request not answered within retry_timeout is sent again for what is
+/// still missing, up to max_retries times.  Recovery fails, and everything
+/// held back is passed on as is, if the retries run out, the request
+/// cannot be sent, the ring fills or a packet is too big for it.
+///
+/// Passed on packets carry the timestamp of the on_recv() that released
+/// them, so the decoder's clock never goes backwards.  Timeouts are only
+/// checked on on_timer(), which should be registered with the poller at a
+/// fraction of retry_timeout.
+///
+/// Not thread safe: live and retransmitted packets must be received on one
+/// poller thread.
+class GapRecovery : public net::SocketListener, public core::TimerListener {
+public:
+    enum class Framing : std::uint8_t {
+        /// One unit, 0; sequence numbers are the header's.  Heartbeats
+        /// carry the next sequence number, so they can reveal a gap too.
+        MOLDUDP64 = 1,
+        /// BATS PITCH 2.0 sequenced unit header.  Packets with sequence 0
+        /// are unsequenced and always passed straight on.
+        PITCH2 = 2,
+    };
+
+    using Config = GapRecoveryConfig;
+
+    GapRecovery(Framing framing, net::SocketListener *downstream, RecoveryTransport *transport, const Config &cfg = Config());
+    GapRecovery(const GapRecovery &) = delete;
+    GapRecovery & operator=(const GapRecovery &) = delete;
+    virtual ~GapRecovery();
+
+    void listener(GapRecoveryListener *l) { m_listener = l; }
+
+    /// Pass unit's gap on to the decoder now, as if recovery had failed.
+    /// For transports told by the other side that it will not be filled.
+    void abandon(const core::Timestamp &ts, std::uint8_t unit);
+
+    bool recovering(std::uint8_t unit) const;
+    /// The next message expected on unit, 0 until a sequenced packet has
+    /// been seen.
+    std::uint64_t expected(std::uint8_t unit) const;
+    /// Packets held back on unit.
+    std::size_t buffered(std::uint8_t unit) const;
+    const GapRecoveryStats & stats() const { return m_stats; }
+
+    virtual void on_recv(const core::Timestamp &ts, void *userdata, const std::uint8_t *buf, const ssize_t &len) override;
+    virtual void on_connected(const core::Timestamp &ts, void *userdata) override;
+    virtual void on_peer_disconnect(const core::Timestamp &ts, void *userdata) override;
+    virtual void on_local_disconnect(const core::Timestamp &ts, void *userdata) override;
+    virtual void on_timer(const core::Timestamp &ts, void *userdata, std::uint64_t iter) override;
+
+private:
+    struct Header {
+        std::uint8_t unit;
+        std::uint64_t seqnum;
+        std::uint64_t count;
+    };
+
+    struct Slot {
+        std::uint64_t seqnum;
+        std::uint64_t count;
+        std::size_t len;
+        void *userdata;
+        std::uint8_t *data;
+    };
+
+    /// Per unit; the ring is allocated on the unit's first gap.
+    struct Unit {
+        std::uint64_t expected = 0;
+        std::array<char, 10> session;
+        bool recovering = false;
+        core::Timestamp gap_ts;
+        core::Timestamp request_ts;
+        /// One past the last message known to have been sent.
+        std::uint64_t horizon = 0;
+        /// End of the range last asked for.
+        std::uint64_t requested_end = 0;
+        unsigned retries = 0;
+        std::uint64_t buffered_this_gap = 0;
+        std::vector<Slot> ring;
+        std::unique_ptr<std::uint8_t[]> data;
+        std::size_t head = 0;
+        std::size_t size = 0;
+
+        Slot & at(std::size_t i) { return ring[(head + i) % ring.size()]; }
+        const Slot & at(std::size_t i) const { return ring[(head + i) % ring.size()]; }
+    };
+
+    bool parse_(const std::uint8_t *buf, std::size_t len, Header &h) const;
+    Unit & unit_(std::uint8_t unit);
+    void deliver_(const core::Timestamp &ts, void *userdata, const std::uint8_t *buf, std::size_t len);
+    /// Hold the packet back, in order; false if it does not fit.
+    bool buffer_(Unit &u, const Header &h, void *userdata, const std::uint8_t *buf, std::size_t len);
+    /// Pass on what the unit's ring holds that is now in sequence.
+    void drain_(const core::Timestamp &ts, std::uint8_t unit, Unit &u);
+    /// Ask for what is missing before the ring's first packet; false if
+    /// the transport could not.
+    bool request_(const core::Timestamp &ts, std::uint8_t unit, Unit &u);
+    void start_(const core::Timestamp &ts, std::uint8_t unit, Unit &u, std::uint64_t received);
+    void complete_(const core::Timestamp &ts, std::uint8_t unit, Unit &u);
+    /// Pass on, in order, the packets held back that start before end.
+    void pass_held_(const core::Timestamp &ts, Unit &u, std::uint64_t end);
+    /// Give up on the gap and pass on what is held back before end; the
+    /// caller passes on the rest after the packet at end.
+    void fail_(const core::Timestamp &ts, std::uint8_t unit, Unit &u, std::uint64_t end = UINT64_MAX);
+
+private:
+    Framing m_framing;
+    net::SocketListener *m_downstream;
+    RecoveryTransport *m_transport;
+    GapRecoveryListener *m_listener;
+    Config m_config;
+    std::array<std::unique_ptr<Unit>, 256> m_units;
+    GapRecoveryStats m_stats;
+};
+
+/// MoldUDP64 re-request: a 20 byte request packet, session, sequence
+/// number and count, to the feed's request server.  The server sends the
+/// messages back to the requesting socket as ordinary downstream packets,
+/// so that socket should be polled into the same GapRecovery.
+class MoldUDP64RequestTransport : public RecoveryTransport {
+public:
+    static const std::size_t REQUEST_SIZE = 20;
+
+    /// sock must already have the request server as its peer.
+    explicit MoldUDP64RequestTransport(net::UDPSocket &sock) : m_socket(sock) {}
+
+    virtual bool request(const RecoveryRequest &r) override;
+
+private:
+    net::UDPSocket &m_socket;
+};
+
+/// BATS PITCH 2.0 Gap Request Proxy: gap request messages over a logged
+/// in TCP session.  Accepted ranges are sent on the unit's gap multicast
+/// channel, which should be polled into the same GapRecovery; on_recv()
+/// takes the proxy's side of the session, and a rejected request abandons
+/// the gap.
+class PITCH2GapRequestTransport : public RecoveryTransport, public net::SocketListener {
+public:
+    enum class MessageType : std::uint8_t {
+        LOGIN = 0x01,
+        LOGIN_RESPONSE = 0x02,
+        GAP_REQUEST = 0x03,
+        GAP_RESPONSE = 0x04,
+    };
+    static const std::size_t HEADER_SIZE = 8;
+    static const std::size_t LOGIN_SIZE = 22;
+    static const std::size_t GAP_REQUEST_SIZE = 9;
+    static const std::size_t GAP_RESPONSE_SIZE = 10;
+    static const std::size_t LOGIN_RESPONSE_SIZE = 3;
+    /// Gap response and login response status for success.
+    static const char ACCEPTED = 'A';
+
+    PITCH2GapRequestTransport(net::TCPSocket &sock, GapRecovery *recovery = nullptr)
+        : m_socket(sock), m_recovery(recovery), m_logged_in(false) {}
+
+    void recovery(GapRecovery *r) { m_recovery = r; }
+
+    bool login(const std::string &session_sub_id, const std::string &username, const std::string &password);
+    bool logged_in() const { return m_logged_in; }
+
+    virtual bool request(const RecoveryRequest &r) override;
+
+    virtual void on_recv(const core::Timestamp &ts, void *userdata, const std::uint8_t *buf, const ssize_t &len) override;
+    virtual void on_connected(const core::Timestamp &, void *) override {}
+    virtual void on_peer_disconnect(const core::Timestamp &, void *) override { m_logged_in = false; }
+    virtual void on_local_disconnect(const core::Timestamp &, void *) override { m_logged_in = false; }
+
+private:
+    bool send_(MessageType type, const std::uint8_t *body, std::size_t len);
+
+private:
+    net::TCPSocket &m_socket;
+    GapRecovery *m_recovery;
+    bool m_logged_in;
+    /// The stream may split messages anywhere.
+    std::vector<std::uint8_t> m_partial;
+};
+
+}}
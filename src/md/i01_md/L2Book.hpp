@@ -1,10 +1,13 @@
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
 
 #include <map>
+#include <new>
 #include <tuple>
 #include <type_traits>
+#include <utility>
 
 #include <boost/pool/pool_alloc.hpp>
 
@@ -14,6 +17,7 @@
 #include <i01_core/Time.hpp>
 
 #include <i01_md/BookBase.hpp>
+#include <i01_md/BookSnapshot.hpp>
 
 namespace i01 { namespace MD {
 
@@ -48,8 +52,342 @@ private:
     Timestamp m_created;
 };
 
+/// \internal Price level storage backed by a pool-allocated std::map.
+//  Ordered by Comparator, so begin() is always the best price level.
+template <typename Comparator, Price EMPTY_PRICE>
+using MapL2BookHalfStorage = std::map< Price
+                                     , L2PriceLevel
+                                     , Comparator
+                                     , boost::fast_pool_allocator<std::pair<const Price, L2PriceLevel>>>;
+
+/// \internal Price level storage kept in a contiguous ring of
+//  tick-indexed slots around the inside market, with a bitmap of occupied
+//  slots.  Levels that are not on a TICK boundary or that fall outside the
+//  ring (deep in the book) go to an overflow map.  Top of book and updates
+//  near the touch are O(1) and do not leave the object.
+//
+//  The ring recenters on the new best price when the inside moves outside
+//  of it; levels keep their slot (tick % NUM_SLOTS) across recenters, so
+//  only levels entering or leaving the window are moved.
+//
+//  Iterators are pointers to the level and are invalidated by erase() and
+//  by any emplace() that recenters the ring.
+template <typename Comparator, Price EMPTY_PRICE, std::size_t NUM_SLOTS, Price TICK>
+class FlatL2BookHalfStorage {
+public:
+    typedef std::pair<const Price, L2PriceLevel> value_type;
+    typedef value_type * iterator;
+    typedef const value_type * const_iterator;
+
+    static_assert(NUM_SLOTS >= 64 && (NUM_SLOTS & (NUM_SLOTS - 1)) == 0, "FlatL2BookHalfStorage: NUM_SLOTS must be a power of 2 and at least 64");
+    static_assert(TICK > 0, "FlatL2BookHalfStorage: TICK must be positive");
+
+private:
+    typedef std::map< Price
+                      , L2PriceLevel
+                      , Comparator
+                      , boost::fast_pool_allocator<std::pair<const Price, L2PriceLevel>>> OverflowStorage;
+    typedef typename std::aligned_storage<sizeof(value_type), alignof(value_type)>::type Slot;
+
+    static const std::size_t SLOT_MASK = NUM_SLOTS - 1;
+    static const std::size_t NUM_WORDS = NUM_SLOTS / 64;
+
+public:
+    FlatL2BookHalfStorage() : m_size(0), m_lo_tick(0), m_best(nullptr), m_bitmap() {}
+    FlatL2BookHalfStorage(const FlatL2BookHalfStorage &) = delete;
+    FlatL2BookHalfStorage & operator=(const FlatL2BookHalfStorage &) = delete;
+    ~FlatL2BookHalfStorage() { clear(); }
+
+    iterator begin() { return m_best; }
+    const_iterator begin() const { return m_best; }
+    iterator end() { return nullptr; }
+    const_iterator end() const { return nullptr; }
+
+    bool empty() const { return 0 == m_size; }
+    std::size_t size() const { return m_size; }
+    /// Number of levels that live outside of the ring.
+    std::size_t overflow_size() const { return m_overflow.size(); }
+
+    iterator find(const Price &p) {
+        std::size_t idx;
+        if (LIKELY(slot_index_(p, idx))) {
+            return test_(idx) ? slot_(idx) : end();
+        }
+        auto it = m_overflow.find(p);
+        return it == m_overflow.end() ? end() : &*it;
+    }
+
+    const_iterator find(const Price &p) const { return const_cast<FlatL2BookHalfStorage *>(this)->find(p); }
+
+    /// Insert a level that is not already present.
+    std::pair<iterator, bool> emplace(std::pair<Price, L2PriceLevel> && v) {
+        const Price p = v.first;
+        if (0 == m_size || (p % TICK == 0 && !in_window_(p) && better_(p, m_best->first))) {
+            recenter_(p);
+        }
+
+        iterator ret;
+        std::size_t idx;
+        if (LIKELY(slot_index_(p, idx))) {
+            ret = ::new (&m_slots[idx]) value_type(p, std::move(v.second));
+            set_(idx);
+        } else {
+            ret = &*m_overflow.emplace(std::move(v)).first;
+        }
+        ++m_size;
+
+        if (nullptr == m_best || better_(p, m_best->first)) {
+            m_best = ret;
+        }
+        return std::make_pair(ret, true);
+    }
+
+    void erase(iterator it) {
+        const Price p = it->first;
+        const bool was_best = it == m_best;
+        std::size_t idx;
+        if (LIKELY(slot_index_(p, idx))) {
+            it->~value_type();
+            reset_(idx);
+        } else {
+            m_overflow.erase(p);
+        }
+        --m_size;
+
+        if (was_best) {
+            m_best = find_best_(p);
+        }
+    }
+
+    /// Copy up to n levels, best first, returns the number copied.
+    std::size_t copy_top(QuoteLevel *out, std::size_t n) const {
+        auto self = const_cast<FlatL2BookHalfStorage *>(this);
+        const value_type *r = self->scan_from_(best_edge_());
+        auto o = m_overflow.begin();
+        std::size_t k = 0;
+        while (k < n) {
+            bool from_ring;
+            if (nullptr != r && o != m_overflow.end()) {
+                from_ring = !better_(o->first, r->first);
+            } else if (nullptr != r) {
+                from_ring = true;
+            } else if (o != m_overflow.end()) {
+                from_ring = false;
+            } else {
+                break;
+            }
+            const value_type &v = from_ring ? *r : *o;
+            out[k++] = QuoteLevel{ v.first, v.second.size(), v.second.num_orders() };
+            if (from_ring) {
+                r = self->ring_next_(r->first);
+            } else {
+                ++o;
+            }
+        }
+        return k;
+    }
+
+    void clear() {
+        for (std::size_t w = 0; w < NUM_WORDS; ++w) {
+            auto word = m_bitmap[w];
+            while (word) {
+                auto b = static_cast<std::size_t>(__builtin_ctzll(word));
+                slot_(w * 64 + b)->~value_type();
+                word &= word - 1;
+            }
+            m_bitmap[w] = 0;
+        }
+        m_overflow.clear();
+        m_size = 0;
+        m_lo_tick = 0;
+        m_best = nullptr;
+    }
+
+private:
+    static bool better_(const Price &a, const Price &b) { return Comparator()(a, b); }
+    static bool higher_is_better_() { return Comparator()(Price(1), Price(0)); }
+
+    bool in_window_(const Price &p) const {
+        return p % TICK == 0 && p / TICK - m_lo_tick < NUM_SLOTS;
+    }
+
+    bool slot_index_(const Price &p, std::size_t &idx) const {
+        if (in_window_(p)) {
+            idx = static_cast<std::size_t>(p / TICK) & SLOT_MASK;
+            return true;
+        }
+        return false;
+    }
+
+    value_type * slot_(std::size_t idx) { return reinterpret_cast<value_type *>(&m_slots[idx]); }
+
+    bool test_(std::size_t idx) const { return m_bitmap[idx / 64] & (1ULL << (idx % 64)); }
+    void set_(std::size_t idx) { m_bitmap[idx / 64] |= (1ULL << (idx % 64)); }
+    void reset_(std::size_t idx) { m_bitmap[idx / 64] &= ~(1ULL << (idx % 64)); }
+
+    /// Best occupied slot no better than p, which must be in the window,
+    //  or nullptr.
+    value_type * scan_from_(const Price &p) {
+        const std::uint64_t off = p / TICK - m_lo_tick;
+        std::size_t b = static_cast<std::size_t>(p / TICK) & SLOT_MASK;
+        if (higher_is_better_()) {
+            // walk towards lower prices
+            std::size_t remaining = off + 1;
+            while (remaining > 0) {
+                const std::size_t bit = b % 64;
+                const std::size_t chunk = std::min<std::size_t>(bit + 1, remaining);
+                std::uint64_t word = m_bitmap[b / 64] << (63 - bit);
+                if (chunk < 64) {
+                    word &= ~((1ULL << (64 - chunk)) - 1);
+                }
+                if (word) {
+                    return slot_(b - static_cast<std::size_t>(__builtin_clzll(word)));
+                }
+                b = (b - chunk) & SLOT_MASK;
+                remaining -= chunk;
+            }
+        } else {
+            // walk towards higher prices
+            std::size_t remaining = NUM_SLOTS - off;
+            while (remaining > 0) {
+                const std::size_t bit = b % 64;
+                const std::size_t chunk = std::min<std::size_t>(64 - bit, remaining);
+                std::uint64_t word = m_bitmap[b / 64] >> bit;
+                if (chunk < 64) {
+                    word &= (1ULL << chunk) - 1;
+                }
+                if (word) {
+                    return slot_(b + static_cast<std::size_t>(__builtin_ctzll(word)));
+                }
+                b = (b + chunk) & SLOT_MASK;
+                remaining -= chunk;
+            }
+        }
+        return nullptr;
+    }
+
+    /// Price of the best end of the window.
+    Price best_edge_() const {
+        return (higher_is_better_() ? m_lo_tick + NUM_SLOTS - 1 : m_lo_tick) * TICK;
+    }
+
+    /// Next occupied slot worse than p, which must be in the window.
+    value_type * ring_next_(const Price &p) {
+        const std::uint64_t tick = p / TICK;
+        if (higher_is_better_()) {
+            return tick == m_lo_tick ? nullptr : scan_from_((tick - 1) * TICK);
+        }
+        return tick + 1 - m_lo_tick >= NUM_SLOTS ? nullptr : scan_from_((tick + 1) * TICK);
+    }
+
+    /// Find the best level after removing the former best price p.
+    value_type * find_best_(const Price &p) {
+        if (0 == m_size) {
+            return nullptr;
+        }
+        value_type * ring_best = nullptr;
+        if (in_window_(p)) {
+            ring_best = scan_from_(p);
+        } else {
+            // p was in the overflow, and so was better than anything in the
+            // ring; scan the whole ring from its best end.
+            ring_best = scan_from_(best_edge_());
+        }
+        if (m_overflow.empty()) {
+            return ring_best;
+        }
+        value_type * overflow_best = &*m_overflow.begin();
+        if (nullptr == ring_best || better_(overflow_best->first, ring_best->first)) {
+            return overflow_best;
+        }
+        return ring_best;
+    }
+
+    /// Move the window so that p is at its center, migrating levels
+    //  between the ring and the overflow as needed.
+    void recenter_(const Price &p) {
+        const std::uint64_t tick = p / TICK;
+        const std::uint64_t lo = tick < NUM_SLOTS / 2 ? 0 : tick - NUM_SLOTS / 2;
+        if (m_size > 0) {
+            for (std::size_t w = 0; w < NUM_WORDS; ++w) {
+                auto word = m_bitmap[w];
+                while (word) {
+                    const std::size_t idx = w * 64 + static_cast<std::size_t>(__builtin_ctzll(word));
+                    word &= word - 1;
+                    value_type * v = slot_(idx);
+                    if (v->first / TICK - lo >= NUM_SLOTS) {
+                        m_overflow.emplace(v->first, std::move(v->second));
+                        v->~value_type();
+                        reset_(idx);
+                    }
+                }
+            }
+        }
+        m_lo_tick = lo;
+        for (auto it = m_overflow.begin(); it != m_overflow.end(); ) {
+            std::size_t idx;
+            if (slot_index_(it->first, idx)) {
+                ::new (&m_slots[idx]) value_type(it->first, std::move(it->second));
+                set_(idx);
+                it = m_overflow.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        // level addresses may have changed.
+        if (m_size > 0) {
+            m_best = scan_from_(best_edge_());
+            if (!m_overflow.empty() && (nullptr == m_best || better_(m_overflow.begin()->first, m_best->first))) {
+                m_best = &*m_overflow.begin();
+            }
+        } else {
+            m_best = nullptr;
+        }
+    }
+
+private:
+    std::size_t m_size;
+    std::uint64_t m_lo_tick;
+    value_type * m_best;
+    std::uint64_t m_bitmap[NUM_WORDS];
+    Slot m_slots[NUM_SLOTS];
+    OverflowStorage m_overflow;
+};
+
+/// \internal Copy up to n levels of a book half storage, best first.
+template <typename Comparator, typename Allocator>
+std::size_t copy_top_levels(const std::map<Price, L2PriceLevel, Comparator, Allocator> &s, QuoteLevel *out, std::size_t n)
+{
+    std::size_t k = 0;
+    for (auto it = s.begin(); k < n && it != s.end(); ++it) {
+        out[k++] = QuoteLevel{ it->first, it->second.size(), it->second.num_orders() };
+    }
+    return k;
+}
+
+template <typename Comparator, Price EMPTY_PRICE, std::size_t NUM_SLOTS, Price TICK>
+std::size_t copy_top_levels(const FlatL2BookHalfStorage<Comparator, EMPTY_PRICE, NUM_SLOTS, TICK> &s, QuoteLevel *out, std::size_t n)
+{
+    return s.copy_top(out, n);
+}
+
+/// Storage policy selecting the std::map backed L2BookHalf.
+struct MapL2Storage {
+    template <typename Comparator, Price EMPTY_PRICE>
+    using storage_type = MapL2BookHalfStorage<Comparator, EMPTY_PRICE>;
+};
+
+/// Storage policy selecting the tick-indexed ring backed L2BookHalf.
+//  TICK is in MD::Price units, so the default of 100 is one cent.
+//  Each book half holds NUM_SLOTS levels inline (~64 bytes each).
+template <std::size_t NUM_SLOTS = 256, Price TICK = 100>
+struct FlatL2Storage {
+    template <typename Comparator, Price EMPTY_PRICE>
+    using storage_type = FlatL2BookHalfStorage<Comparator, EMPTY_PRICE, NUM_SLOTS, TICK>;
+};
+
 /// \internal Use Compare = std::greater for bids, std::less for asks.
-template <template <typename Price> class Compare, Price EMPTY_PRICE, typename RWMutexT = core::SpinRWMutex>
+template <template <typename Price> class Compare, Price EMPTY_PRICE, typename RWMutexT = core::SpinRWMutex, typename StoragePolicy = MapL2Storage>
 class L2BookHalf {
 public:
     typedef L2PriceLevel PriceLevel;
@@ -63,10 +401,7 @@ private:
     typedef RWMutexT RWMutex;
     /// A single L2 book price level.
 
-    typedef std::map< Price
-                      , PriceLevel
-                      , Compare<Price>
-                      , boost::fast_pool_allocator<std::pair<Price, PriceLevel>>> BookHalfStorage;
+    typedef typename StoragePolicy::template storage_type<Comparator, EMPTY_PRICE> BookHalfStorage;
 
 public:
     using const_iterator = typename BookHalfStorage::const_iterator;
@@ -146,6 +481,9 @@ public:
     /// Did the last replace reduce the size at the price level?
     bool last_update_reduced_size() const { return m_reduced_size; }
 
+    /// Copy up to n levels into out, best first, returns the number copied.
+    std::size_t top_levels(QuoteLevel *out, std::size_t n) const { return copy_top_levels(m_bookhalf_storage, out, n); }
+
     /// Const iterator to the price levels
     const_iterator find(const Price p) const { return m_bookhalf_storage.find(p); }
     /// The end market iterator for price levels
@@ -159,40 +497,52 @@ private:
     bool m_reduced_size;
 };
 
-template <typename Mutex = core::SpinRWMutex>
-using BidL2BookHalf = L2BookHalf<std::greater, BookBase::EMPTY_BID_PRICE, Mutex>;
-
-template <typename Mutex = core::SpinRWMutex>
-using AskL2BookHalf = L2BookHalf<std::less, BookBase::EMPTY_ASK_PRICE, Mutex>;
-
-class L2Book : public BookBase {
+template <typename Mutex = core::SpinRWMutex, typename StoragePolicy = MapL2Storage>
+using BidL2BookHalf = L2BookHalf<std::greater, BookBase::EMPTY_BID_PRICE, Mutex, StoragePolicy>;
+
+template <typename Mutex = core::SpinRWMutex, typename StoragePolicy = MapL2Storage>
+using AskL2BookHalf = L2BookHalf<std::less, BookBase::EMPTY_ASK_PRICE, Mutex, StoragePolicy>;
+
+/// L2 book over either storage policy.  Use L2Book (map) or FlatL2Book
+//  (tick-indexed ring) rather than instantiating this directly.
+//
+//  The writer publishes top of book and the top Snapshot::depth levels
+//  through seqlocks after every update, so best_bid(), best_ask(), best()
+//  and l2_bid()/l2_ask() near the touch never take the book mutex.  Deeper
+//  l2_bid()/l2_ask() lookups fall back to the mutex.
+template <typename StoragePolicy>
+class BasicL2Book : public BookBase {
 public:
-    typedef BidL2BookHalf<> bidhalf_type;
-    typedef AskL2BookHalf<> askhalf_type;
+    typedef BidL2BookHalf<core::SpinRWMutex, StoragePolicy> bidhalf_type;
+    typedef AskL2BookHalf<core::SpinRWMutex, StoragePolicy> askhalf_type;
+    typedef BookSnapshot<> Snapshot;
 
     typedef L2PriceLevel::Timestamp Timestamp;
 
     using Mutex = core::SpinRWMutex;
 
 public:
-    L2Book() = delete;
-    L2Book(const core::MIC & mkt) : BookBase(mkt) {}
-    L2Book(const core::MIC & mkt, const SymbolIndex &idx) : BookBase(mkt, idx) {}
-    virtual ~L2Book() = default;
+    BasicL2Book() = delete;
+    BasicL2Book(const core::MIC & mkt) : BookBase(mkt), m_snapshot(EMPTY_BID_PRICE, EMPTY_ASK_PRICE) {}
+    BasicL2Book(const core::MIC & mkt, const SymbolIndex &idx) : BookBase(mkt, idx), m_snapshot(EMPTY_BID_PRICE, EMPTY_ASK_PRICE) {}
+    virtual ~BasicL2Book() = default;
 
     bool replace(bool is_bid, const Price &p, const Size &s, const NumOrders &n, const Timestamp &ts);
 
-    virtual Summary best_bid() const override final { Mutex::scoped_lock lock(m_mutex, /* write= */ false); return m_bids.best(); }
-    virtual Summary best_ask() const override final { Mutex::scoped_lock lock(m_mutex, /* write= */ false); return m_asks.best(); }
+    virtual Summary best_bid() const override final { return m_snapshot.best().bid.quote(); }
+    virtual Summary best_ask() const override final { return m_snapshot.best().ask.quote(); }
 
-    virtual L2Quote l2_bid(const Price& p) const override final { Mutex::scoped_lock lock(m_mutex, /* write= */ false); return unsafe_l2_bid(p); }
-    virtual L2Quote l2_ask(const Price& p) const override final { Mutex::scoped_lock lock(m_mutex, /* write= */ false); return unsafe_l2_ask(p); }
+    virtual L2Quote l2_bid(const Price& p) const override final;
+    virtual L2Quote l2_ask(const Price& p) const override final;
 
     FullSummary best() const override final {
-        Mutex::scoped_lock lock(m_mutex, /* write= */ false);
-        return { unsafe_best_bid(), unsafe_best_ask() };
+        const auto b = m_snapshot.best();
+        return { b.bid.quote(), b.ask.quote() };
     }
 
+    /// Wait-free copy of the top levels of both sides.
+    typename Snapshot::Top top() const { return m_snapshot.top(); }
+
     bool crossed() const;
     bool locked() const;
 
@@ -210,12 +560,191 @@ protected:
     L2Quote unsafe_l2_bid(const Price&) const;
     L2Quote unsafe_l2_ask(const Price&) const;
 
+private:
+    /// Publish snapshots after a replace(), called with the write lock held.
+    void publish_(bool is_bid, const Price &p, bool top_changed);
+    /// Look up p in the published levels of one side, returns false if p
+    //  is deeper than the snapshot.
+    static bool snapshot_l2_(const QuoteLevel *levels, std::uint32_t n, const Price &p, bool is_bid, L2Quote &q);
+
 private:
     bidhalf_type m_bids;
     askhalf_type m_asks;
 
     mutable Mutex m_mutex;
+
+    Snapshot m_snapshot;
+};
+
+class L2Book : public BasicL2Book<MapL2Storage> {
+public:
+    L2Book() = delete;
+    L2Book(const core::MIC & mkt) : BasicL2Book(mkt) {}
+    L2Book(const core::MIC & mkt, const SymbolIndex &idx) : BasicL2Book(mkt, idx) {}
+    virtual ~L2Book() = default;
 };
 
+class FlatL2Book : public BasicL2Book<FlatL2Storage<>> {
+public:
+    FlatL2Book() = delete;
+    FlatL2Book(const core::MIC & mkt) : BasicL2Book(mkt) {}
+    FlatL2Book(const core::MIC & mkt, const SymbolIndex &idx) : BasicL2Book(mkt, idx) {}
+    virtual ~FlatL2Book() = default;
+};
+
+template <typename SP>
+bool BasicL2Book<SP>::replace(bool is_bid, const Price &p, const Size &s, const NumOrders &n, const Timestamp &ts)
+{
+    Mutex::scoped_lock lock(m_mutex, /* write= */ true);
+    const bool ret = is_bid ? m_bids.replace(p, s, n, ts) : m_asks.replace(p, s, n, ts);
+    publish_(is_bid, p, ret);
+    return ret;
+}
+
+template <typename SP>
+void BasicL2Book<SP>::publish_(bool is_bid, const Price &p, bool top_changed)
+{
+    if (top_changed) {
+        const auto bid = unsafe_best_bid();
+        const auto ask = unsafe_best_ask();
+        m_snapshot.publish_best(QuoteLevel{ bid.price, bid.size, bid.num_orders },
+                                QuoteLevel{ ask.price, ask.size, ask.num_orders });
+    }
+    const bool affects_top = is_bid
+        ? m_snapshot.affects_top(true, p, std::greater<Price>())
+        : m_snapshot.affects_top(false, p, std::less<Price>());
+    if (affects_top) {
+        const auto n = is_bid
+            ? m_bids.top_levels(m_snapshot.top_side(true), Snapshot::depth)
+            : m_asks.top_levels(m_snapshot.top_side(false), Snapshot::depth);
+        m_snapshot.top_side_size(is_bid, n);
+        m_snapshot.publish_top();
+    }
+}
+
+template <typename SP>
+bool BasicL2Book<SP>::snapshot_l2_(const QuoteLevel *levels, std::uint32_t n, const Price &p, bool is_bid, L2Quote &q)
+{
+    for (std::uint32_t i = 0; i < n; ++i) {
+        if (levels[i].price == p) {
+            q = levels[i].quote();
+            return true;
+        }
+    }
+    // absent levels are known to be empty if the snapshot holds the whole
+    // side, or if p is better than the deepest level in it.
+    if (n < Snapshot::depth || (is_bid ? p > levels[n - 1].price : p < levels[n - 1].price)) {
+        q = L2Quote{ p, 0, 0 };
+        return true;
+    }
+    return false;
+}
+
+template <typename SP>
+L2Quote BasicL2Book<SP>::l2_bid(const Price &p) const
+{
+    const auto top = m_snapshot.top();
+    L2Quote q{ p, 0, 0 };
+    if (snapshot_l2_(top.bids, top.num_bids, p, true, q)) {
+        return q;
+    }
+    Mutex::scoped_lock lock(m_mutex, /* write= */ false);
+    return unsafe_l2_bid(p);
+}
+
+template <typename SP>
+L2Quote BasicL2Book<SP>::l2_ask(const Price &p) const
+{
+    const auto top = m_snapshot.top();
+    L2Quote q{ p, 0, 0 };
+    if (snapshot_l2_(top.asks, top.num_asks, p, false, q)) {
+        return q;
+    }
+    Mutex::scoped_lock lock(m_mutex, /* write= */ false);
+    return unsafe_l2_ask(p);
+}
+
+template <typename SP>
+bool BasicL2Book<SP>::crossed() const
+{
+    const auto b = m_snapshot.best();
+    const auto &bid = b.bid;
+    const auto &ask = b.ask;
+    return bid.price != EMPTY_BID_PRICE && ask.price != EMPTY_ASK_PRICE && bid.price > ask.price;
+}
+
+template <typename SP>
+bool BasicL2Book<SP>::locked() const
+{
+    const auto b = m_snapshot.best();
+    const auto &bid = b.bid;
+    const auto &ask = b.ask;
+    return bid.price != EMPTY_BID_PRICE && bid.price == ask.price;
+}
+
+template <typename SP>
+bool BasicL2Book<SP>::last_order_added_level(bool bid) const
+{
+    return bid ? m_bids.last_order_added_level() : m_asks.last_order_added_level();
+}
+
+template <typename SP>
+bool BasicL2Book<SP>::last_order_deleted_level(bool bid) const
+{
+    return bid ? m_bids.last_order_deleted_level() : m_asks.last_order_deleted_level();
+}
+
+template <typename SP>
+bool BasicL2Book<SP>::last_order_deleted_existing_level(bool bid) const
+{
+    return bid ? m_bids.last_order_deleted_existing_level() : m_asks.last_order_deleted_existing_level();
+}
+
+template <typename SP>
+bool BasicL2Book<SP>::last_update_reduced_size(bool bid) const
+{
+    return bid ? m_bids.last_update_reduced_size() : m_asks.last_update_reduced_size();
+}
+
+template <typename SP>
+void BasicL2Book<SP>::clear()
+{
+    Mutex::scoped_lock lock(m_mutex, /* write= */ true);
+    m_bids.clear();
+    m_asks.clear();
+    m_snapshot.clear();
+}
+
+template <typename SP>
+L2Quote BasicL2Book<SP>::unsafe_best_bid() const
+{
+    return m_bids.best_quote();
+}
+
+template <typename SP>
+L2Quote BasicL2Book<SP>::unsafe_best_ask() const
+{
+    return m_asks.best_quote();
+}
+
+template <typename SP>
+L2Quote BasicL2Book<SP>::unsafe_l2_bid(const Price &p) const
+{
+    auto it = m_bids.find(p);
+    if (it != m_bids.end()) {
+        return L2Quote{ p, it->second.size(), it->second.num_orders() };
+    }
+    return L2Quote{ p, 0, 0 };
+}
+
+template <typename SP>
+L2Quote BasicL2Book<SP>::unsafe_l2_ask(const Price &p) const
+{
+    auto it = m_asks.find(p);
+    if (it != m_asks.end()) {
+        return L2Quote{ p, it->second.size(), it->second.num_orders() };
+    }
+    return L2Quote{ p, 0, 0 };
+}
 
 }}
@@ -2,6 +2,7 @@
 
 #include <list>
 #include <map>
+#include <sstream>
 #include <string>
 
 #include <i01_core/MIC.hpp>
@@ -44,6 +45,19 @@ public:
 
     EventPollerConfig get_config() const { return m_epc; }
 
+    /// Apply the receive settings under eventpollers.<name> in the md
+    /// config to each poller, see net::EpollEventPoller::configure().
+    /// Call before the pollers are started.
+    void configure_pollers(const core::Config::storage_type& cfg);
+
+    /// Socket queueing latency of all the units of feed_state, merged
+    /// across pollers; empty unless the pollers have timestamping set.
+    template<typename FS>
+    net::RecvLatencyHistogram recv_latency(const FS& feed_state) const;
+
+    /// One line per poller with its poll mode and counters.
+    std::string status() const;
+
     friend std::ostream& operator<<(std::ostream&, const EventPollerConfig&);
 
 private:
@@ -63,6 +77,44 @@ private:
     MulticastPollerContainer m_pollers;
 };
 
+inline void MDEventPoller::configure_pollers(const core::Config::storage_type& cfg)
+{
+    auto pollers_cfg(cfg.copy_prefix_domain("eventpollers."));
+    for (const auto& p : m_pollers) {
+        auto poller_cfg(pollers_cfg->copy_prefix_domain(p.first + "."));
+        if (!p.second->configure(*poller_cfg)) {
+            std::cerr << "MDEventPoller: configure_pollers: keeping defaults for " << p.first << std::endl;
+        }
+    }
+}
+
+inline std::string MDEventPoller::status() const
+{
+    std::ostringstream ss;
+    bool first = true;
+    bool sys_listed = false;
+    for (const auto& p : m_pollers) {
+        ss << (first ? "" : "\n") << p.second->status();
+        first = false;
+        sys_listed = sys_listed || p.second == m_sys_poller;
+    }
+    if (m_sys_poller && !sys_listed)
+        ss << (first ? "" : "\n") << m_sys_poller->status();
+    return ss.str();
+}
+
+template<typename FS>
+net::RecvLatencyHistogram MDEventPoller::recv_latency(const FS& feed_state) const
+{
+    net::RecvLatencyHistogram h;
+    for (const auto& p : m_pollers) {
+        for (const auto& u : feed_state) {
+            p.second->recv_latency(net::EventUserData{u.state_ptr.get()}, h);
+        }
+    }
+    return h;
+}
+
 template<typename DecoderContainer, typename FeedStateContainer>
 void MDEventPoller::init_feed_event_pollers(DecoderContainer& decoders, FeedStateContainer& fs)
 {
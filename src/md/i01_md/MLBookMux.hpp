@@ -1,8 +1,14 @@
 #pragma once
 
+#include <memory>
+#include <type_traits>
+#include <vector>
+
 #include <i01_core/Lock.hpp>
 
 #include <i01_md/BookBase.hpp>
+#include <i01_md/BookInfoTable.hpp>
+#include <i01_md/BookMuxBatch.hpp>
 #include <i01_md/BookMuxListener.hpp>
 #include <i01_md/DecoderEvents.hpp>
 #include <i01_md/LastSale.hpp>
@@ -40,10 +46,76 @@ static void call_listeners(std::tuple<ListenerTypes...>& t, MemberFnPtr mfp, Arg
     CallListenersImpl<0, sizeof...(ListenerTypes), std::tuple<ListenerTypes...>, MemberFnPtr, Args&&...>() (t, mfp, std::forward<Args>(args)...);
 }
 
+// same again, but skipping listeners that receive the event in a
+// BookBatchEvent instead.
+
+template<typename ListenerType, typename MemberFnPtr, typename... Args>
+void call_if_unbatched(std::false_type, ListenerType* l, MemberFnPtr mfp, Args&&... args) {
+    (l->*mfp)(std::forward<Args>(args)...);
+}
+
+template<typename ListenerType, typename MemberFnPtr, typename... Args>
+void call_if_unbatched(std::true_type, ListenerType*, MemberFnPtr, Args&&...) {}
+
+template<int I, int TSize, typename Tuple, typename MemberFnPtr, typename... Args>
+struct CallUnbatchedListenersImpl : public CallUnbatchedListenersImpl<I + 1, TSize, Tuple, MemberFnPtr, Args...>
+{
+    using ListenerType = typename std::remove_pointer<typename std::tuple_element<I, Tuple>::type>::type;
+
+    void operator() (Tuple& t, MemberFnPtr mfp, Args&&... args) {
+        call_if_unbatched(std::integral_constant<bool, IsBookBatchListener<ListenerType>::value>(), std::get<I>(t), mfp, std::forward<Args>(args)...);
+        CallUnbatchedListenersImpl<I + 1, TSize, Tuple, MemberFnPtr, Args...>::operator() (t, mfp, std::forward<Args>(args)...);
+    }
+};
+
+template<int I, typename Tuple, typename MemberFnPtr, typename... Args>
+struct CallUnbatchedListenersImpl<I, I, Tuple, MemberFnPtr, Args...>
+{
+    void operator() (Tuple&, MemberFnPtr, Args&&...) {}
+};
+
+template<typename... ListenerTypes, typename MemberFnPtr, typename... Args>
+static void call_unbatched_listeners(std::tuple<ListenerTypes...>& t, MemberFnPtr mfp, Args&&...args)
+{
+    CallUnbatchedListenersImpl<0, sizeof...(ListenerTypes), std::tuple<ListenerTypes...>, MemberFnPtr, Args&&...>() (t, mfp, std::forward<Args>(args)...);
+}
+
+template<typename ListenerType>
+void call_if_batched(std::true_type, ListenerType* l, const BookBatchEvent& e) {
+    l->on_book_batch(e);
+}
+
+template<typename ListenerType>
+void call_if_batched(std::false_type, ListenerType*, const BookBatchEvent&) {}
+
+template<int I, int TSize, typename Tuple>
+struct CallBatchListenersImpl : public CallBatchListenersImpl<I + 1, TSize, Tuple>
+{
+    using ListenerType = typename std::remove_pointer<typename std::tuple_element<I, Tuple>::type>::type;
+
+    void operator() (Tuple& t, const BookBatchEvent& e) {
+        call_if_batched(std::integral_constant<bool, IsBookBatchListener<ListenerType>::value>(), std::get<I>(t), e);
+        CallBatchListenersImpl<I + 1, TSize, Tuple>::operator() (t, e);
+    }
+};
+
+template<int I, typename Tuple>
+struct CallBatchListenersImpl<I, I, Tuple>
+{
+    void operator() (Tuple&, const BookBatchEvent&) {}
+};
+
+template<typename... ListenerTypes>
+static void call_batch_listeners(std::tuple<ListenerTypes...>& t, const BookBatchEvent& e)
+{
+    CallBatchListenersImpl<0, sizeof...(ListenerTypes), std::tuple<ListenerTypes...> >() (t, e);
+}
+
 class BookMuxBase {
 public:
     using MIC = core::MIC;
-    using SymbolMutex = core::SpinRWMutex;
+    using BookInfo = BookInfoTable<(std::size_t)MD::NUM_SYMBOL_INDEX>;
+    using SymbolMutex = BookInfo::SymbolMutex;
     using UnitIndex = std::uint8_t;
 
 public:
@@ -55,11 +127,16 @@ public:
 
     const MIC & mic() const { return m_mic; }
 
-    const BookBase * operator[](const EphemeralSymbolIndex esi) noexcept { return m_bookinfo_by_esi[esi].book_p; }
+    const BookBase * operator[](const EphemeralSymbolIndex esi) noexcept { return m_bookinfo_by_esi.book(esi); }
+
+    const SymbolState& symbol_state(const EphemeralSymbolIndex esi) const noexcept { return m_bookinfo_by_esi.state(esi); }
 
-    const SymbolState& symbol_state(const EphemeralSymbolIndex esi) const noexcept { return m_bookinfo_by_esi[esi].state; }
+    const LastSale& last_sale(const EphemeralSymbolIndex esi) const noexcept { return m_bookinfo_by_esi.last_sale(esi); }
 
-    const LastSale& last_sale(const EphemeralSymbolIndex esi) const noexcept { return m_bookinfo_by_esi[esi].last_sale; }
+    /// Prefetch hints for decoders, e.g. for the symbol of the next message
+    /// in a packet while the current one is being applied.
+    void prefetch(const EphemeralSymbolIndex esi) const noexcept { m_bookinfo_by_esi.prefetch(esi); }
+    void prefetch_book(const EphemeralSymbolIndex esi) const noexcept { m_bookinfo_by_esi.prefetch_book(esi); }
 
     int clear_books_in_unit(const UnitIndex unit) noexcept;
 
@@ -67,26 +144,17 @@ public:
 
 protected:
     MIC m_mic;
-    // TODO FIXME: Move SymbolState and BookBase* into single array for cache
-    // coherency, and so multiple lookups by esi aren't necessary.
 
     virtual BookBase * create_book_for_symbol(const EphemeralSymbolIndex&) = 0;
 
     /// this is not thread safe
-    BookBase *& book_from_esi_(const EphemeralSymbolIndex esi) noexcept { return m_bookinfo_by_esi[esi].book_p; }
-    SymbolState& state_from_esi_(const EphemeralSymbolIndex esi) noexcept { return m_bookinfo_by_esi[esi].state; }
-    LastSale & last_sale_from_esi_(const EphemeralSymbolIndex esi) noexcept { return m_bookinfo_by_esi[esi].last_sale; }
-    SymbolMutex& symbol_mutex_from_esi_(const EphemeralSymbolIndex esi) noexcept { return m_bookinfo_by_esi[esi].mutex; }
-private:
-    struct BookInfo {
-        BookBase *book_p;
-        SymbolState state;
-        LastSale last_sale;
-        SymbolMutex mutex;
-    };
+    BookBase *& book_from_esi_(const EphemeralSymbolIndex esi) noexcept { return m_bookinfo_by_esi.book(esi); }
+    SymbolState& state_from_esi_(const EphemeralSymbolIndex esi) noexcept { return m_bookinfo_by_esi.state(esi); }
+    LastSale & last_sale_from_esi_(const EphemeralSymbolIndex esi) noexcept { return m_bookinfo_by_esi.last_sale(esi); }
+    SymbolMutex& symbol_mutex_from_esi_(const EphemeralSymbolIndex esi) noexcept { return m_bookinfo_by_esi.mutex(esi); }
 
 private:
-    std::array<BookInfo, (int)MD::NUM_SYMBOL_INDEX> m_bookinfo_by_esi;
+    BookInfo m_bookinfo_by_esi;
     std::array<std::vector<EphemeralSymbolIndex>, NUM_UNIT_INDEX> m_esi_by_unit;
 };
 
@@ -100,8 +168,11 @@ public:
     using Timestamp = core::Timestamp;
     using BaseMux = MLBookMux<BookType, Listeners...>;
     using ListenersTuple = std::tuple<Listeners*...>;
+    using BatchBuffer = BookBatchBuffer<>;
     // TODO: we should verify that every type in Listeners... is derived from BookMuxListener
 
+    static const bool HAS_BATCH_LISTENERS = AnyBookBatchListener<Listeners...>::value;
+
 protected:
     using BookMuxBase::m_mic;
 
@@ -111,6 +182,16 @@ public:
 
     virtual BookType * create_book_for_symbol(const EphemeralSymbolIndex&) override ;
 
+    /// Opt in to per-packet batching.  While enabled, listeners that
+    /// implement on_book_batch(const BookBatchEvent&) receive the book
+    /// changes of each packet (L3 adds, cancels, modifies and executions,
+    /// L2 updates) as one BookBatchEvent, delivered before on_end_of_data,
+    /// instead of one call per change; all other events, and all events
+    /// for other listeners, are unchanged.  Does nothing if no listener
+    /// implements on_book_batch.
+    void batching(bool enable);
+    bool batching() const { return nullptr != m_batch; }
+
     // we do this std::decay because otherwise the arguments we pass
     // to this must be the exact match types as the arguments to the
     // member func .. also, we are wrapping this in a call here so
@@ -120,6 +201,16 @@ public:
         call_listeners(m_listeners, mfp, std::forward<Args>(args)...);
     }
 
+    template<typename MemberFnPtr, typename Event>
+    void notify(MemberFnPtr mfp, Event&& e) {
+        if (HAS_BATCH_LISTENERS && m_in_packet && m_batch) {
+            using Traits = BookBatchTraits<typename std::decay<Event>::type>;
+            batch_(std::integral_constant<bool, Traits::batchable>(), mfp, std::forward<Event>(e));
+        } else {
+            call_listeners(m_listeners, mfp, std::forward<Event>(e));
+        }
+    }
+
     template<typename MemberFnPtr>
     void notify(MemberFnPtr mfp, TradeEvent&& te) {
         // update last sale
@@ -127,6 +218,7 @@ public:
             this->last_sale_from_esi_(te.m_book.symbol_index()) = LastSale{te.m_price, te.m_timestamp};
         }
 
+        flush_batch_(false);
         call_listeners(m_listeners, mfp, std::forward<TradeEvent>(te));
     }
 
@@ -137,7 +229,11 @@ public:
             this->last_sale_from_esi_(ee.m_book.symbol_index()) = LastSale{ee.m_exec_price, ee.m_timestamp};
         }
 
-        call_listeners(m_listeners, mfp, std::forward<L3ExecutionEvent>(ee));
+        if (HAS_BATCH_LISTENERS && m_in_packet && m_batch) {
+            batch_(std::true_type(), mfp, std::forward<L3ExecutionEvent>(ee));
+        } else {
+            call_listeners(m_listeners, mfp, std::forward<L3ExecutionEvent>(ee));
+        }
     }
 
     // ignore heartbeats from the decoder
@@ -161,10 +257,14 @@ public:
     }
 
     void on_raw_msg(const Timestamp &ts, const StartOfPktMsg &, std::uint64_t seqnum, std::uint32_t index) {
+        m_packet_timestamp = ts;
+        m_in_packet = true;
         notify(&Listener::on_start_of_data, PacketEvent{ts, m_mic});
     }
 
     void on_raw_msg(const Timestamp &ts, const EndOfPktMsg &, std::uint64_t seqnum, std::uint32_t index) {
+        flush_batch_(true);
+        m_in_packet = false;
         notify(&Listener::on_end_of_data, PacketEvent{ts, m_mic});
     }
 
@@ -172,17 +272,61 @@ public:
         notify(&Listener::on_timeout_event, TimeoutEvent{ts, m_mic, last_ts, unit_index, name, started ? TimeoutEvent::EventCode::TIMEOUT_START : TimeoutEvent::EventCode::TIMEOUT_END});
     }
 
+protected:
+    template<typename MemberFnPtr, typename Event>
+    void batch_(std::true_type, MemberFnPtr mfp, Event&& e) {
+        if (UNLIKELY(!m_batch->record(e))) {
+            flush_batch_(false);
+            m_batch->record(e);
+        }
+        call_unbatched_listeners(m_listeners, mfp, std::forward<Event>(e));
+    }
+
+    template<typename MemberFnPtr, typename Event>
+    void batch_(std::false_type, MemberFnPtr mfp, Event&& e) {
+        flush_batch_(false);
+        call_listeners(m_listeners, mfp, std::forward<Event>(e));
+    }
+
+    void flush_batch_(bool end_of_packet) {
+        if (HAS_BATCH_LISTENERS && m_batch && !m_batch->empty()) {
+            const BookBatchEvent be{m_packet_timestamp, m_mic, m_batch->finish(), m_batch->size(),
+                                    m_batch->events(), m_batch->num_events(), end_of_packet};
+            call_batch_listeners(m_listeners, be);
+            m_batch->reset();
+        }
+    }
 
 protected:
     ListenersTuple m_listeners;
+    std::unique_ptr<BatchBuffer> m_batch;
+    bool m_in_packet;
+    Timestamp m_packet_timestamp;
 };
 
+template<typename BT, typename...LT>
+const bool MLBookMux<BT,LT...>::HAS_BATCH_LISTENERS;
+
 template<typename BT, typename...LT>
 MLBookMux<BT,LT...>::MLBookMux(const core::MIC & m, LT*... nl) :
-    BookMuxBase::BookMuxBase(m), m_listeners(std::make_tuple(nl...))
+    BookMuxBase::BookMuxBase(m), m_listeners(std::make_tuple(nl...)),
+    m_batch(), m_in_packet(false), m_packet_timestamp()
 {
 }
 
+template<typename BT, typename...LT>
+void MLBookMux<BT,LT...>::batching(bool enable)
+{
+    if (enable && HAS_BATCH_LISTENERS) {
+        if (!m_batch) {
+            m_batch.reset(new BatchBuffer());
+        }
+    } else {
+        flush_batch_(false);
+        m_batch.reset();
+    }
+}
+
 template<typename BT, typename...LT>
 BT * MLBookMux<BT,LT...>::create_book_for_symbol(const EphemeralSymbolIndex& esi)
 {
@@ -0,0 +1,517 @@
+#pragma once
+
+#include <endian.h>
+#include <string.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+
+#include <i01_core/macro.hpp>
+
+namespace i01 { namespace MD { namespace NASDAQ { namespace ITCH50 { namespace Batch {
+
+/// Batch front end for ITCH 5.0 in MoldUDP64 framing.
+///
+/// A packet is decoded in two passes: the first walks the message blocks
+/// and sorts the hot order messages (add, execute, cancel, delete,
+/// replace) by type, the second converts each type's messages from wire
+/// format in a tight loop.  The hot records below are host order and laid
+/// out so the SIMD kernels fill them with a few 16 byte shuffles and
+/// stores; every other message is left in the packet for the existing
+/// decoder.  Entries keep packet order, so a book applying them sees the
+/// feed as sent.
+
+/// 'A' and 'F'.
+struct Add {
+    std::uint64_t timestamp;
+    std::uint16_t stock_locate;
+    std::uint16_t tracking_number;
+    char buy_sell_indicator;
+    /// True for 'F', which carries an MPID the batch does not keep.
+    std::uint8_t attributed;
+    std::uint16_t reserved;
+    std::uint64_t order_refnum;
+    std::uint32_t shares;
+    std::uint32_t price;
+    std::array<std::uint8_t, 8> stock;
+};
+static_assert(sizeof(Add) == 40, "ITCH50::Batch::Add layout");
+
+/// 'E' and 'C'.
+struct Execute {
+    std::uint64_t timestamp;
+    std::uint16_t stock_locate;
+    std::uint16_t tracking_number;
+    /// 'Y' or 'N' for 'C', 0 for 'E'.
+    char printable;
+    std::uint8_t with_price;
+    std::uint16_t reserved;
+    std::uint64_t order_refnum;
+    std::uint64_t match_number;
+    std::uint32_t executed_shares;
+    /// 0 for 'E'.
+    std::uint32_t execution_price;
+};
+static_assert(sizeof(Execute) == 40, "ITCH50::Batch::Execute layout");
+
+/// 'X'.
+struct Cancel {
+    std::uint64_t timestamp;
+    std::uint16_t stock_locate;
+    std::uint16_t tracking_number;
+    std::uint32_t reserved;
+    std::uint64_t order_refnum;
+    std::uint32_t canceled_shares;
+    std::uint32_t reserved2;
+};
+static_assert(sizeof(Cancel) == 32, "ITCH50::Batch::Cancel layout");
+
+/// 'D'.
+struct Delete {
+    std::uint64_t timestamp;
+    std::uint16_t stock_locate;
+    std::uint16_t tracking_number;
+    std::uint32_t reserved;
+    std::uint64_t order_refnum;
+};
+static_assert(sizeof(Delete) == 24, "ITCH50::Batch::Delete layout");
+
+/// 'U'.
+struct Replace {
+    std::uint64_t timestamp;
+    std::uint16_t stock_locate;
+    std::uint16_t tracking_number;
+    std::uint32_t reserved;
+    std::uint64_t original_order_refnum;
+    std::uint64_t new_order_refnum;
+    std::uint32_t shares;
+    std::uint32_t price;
+};
+static_assert(sizeof(Replace) == 40, "ITCH50::Batch::Replace layout");
+
+/// Wire sizes of the hot messages.  A hot type byte with any other length
+/// is passed through as OTHER.
+enum MessageSize : std::uint16_t {
+    ADD_SIZE = 36,
+    ADD_MPID_SIZE = 40,
+    EXECUTE_SIZE = 31,
+    EXECUTE_WITH_PRICE_SIZE = 36,
+    CANCEL_SIZE = 23,
+    DELETE_SIZE = 19,
+    REPLACE_SIZE = 35,
+};
+
+struct Entry {
+    enum class Kind : std::uint8_t {
+        ADD = 0,
+        EXECUTE = 1,
+        CANCEL = 2,
+        DELETE = 3,
+        REPLACE = 4,
+        OTHER = 5,
+    };
+
+    Kind kind;
+    /// Into the Packet's array for kind; unused for OTHER.
+    std::uint16_t index;
+    /// Of the message in the MoldUDP64 packet, past its length prefix.
+    std::uint16_t offset;
+    std::uint16_t length;
+};
+
+/// One MoldUDP64 packet's messages.  MAX_MSGS covers a jumbo frame of the
+/// smallest messages; if a packet has more, the rest are not decoded and
+/// truncated is set.
+template<std::size_t MAX_MSGS = 512>
+struct Packet {
+    static const std::size_t capacity = MAX_MSGS;
+
+    std::array<std::uint8_t, 10> session;
+    std::uint64_t seqnum;
+    /// As sent: 0 for a heartbeat, 0xFFFF for end of session.
+    std::uint16_t msg_count;
+    bool truncated;
+
+    std::size_t num_entries;
+    std::size_t num_adds;
+    std::size_t num_executes;
+    std::size_t num_cancels;
+    std::size_t num_deletes;
+    std::size_t num_replaces;
+
+    std::array<Entry, MAX_MSGS> entries;
+    std::array<Add, MAX_MSGS> adds;
+    std::array<Execute, MAX_MSGS> executes;
+    std::array<Cancel, MAX_MSGS> cancels;
+    std::array<Delete, MAX_MSGS> deletes;
+    std::array<Replace, MAX_MSGS> replaces;
+
+    /// Deliver the packet's messages in order, to
+    //  h.on_add(const Add &), h.on_execute(const Execute &),
+    //  h.on_cancel(const Cancel &), h.on_delete(const Delete &),
+    //  h.on_replace(const Replace &) and
+    //  h.on_other(const std::uint8_t *msg, std::size_t len), where pkt is
+    //  the buffer the packet was decoded from.
+    template<typename Handler>
+    void for_each(const std::uint8_t *pkt, Handler &h) const {
+        for (std::size_t i = 0; i < num_entries; ++i) {
+            const Entry &e = entries[i];
+            switch (e.kind) {
+            case Entry::Kind::ADD:
+                h.on_add(adds[e.index]);
+                break;
+            case Entry::Kind::EXECUTE:
+                h.on_execute(executes[e.index]);
+                break;
+            case Entry::Kind::CANCEL:
+                h.on_cancel(cancels[e.index]);
+                break;
+            case Entry::Kind::DELETE:
+                h.on_delete(deletes[e.index]);
+                break;
+            case Entry::Kind::REPLACE:
+                h.on_replace(replaces[e.index]);
+                break;
+            case Entry::Kind::OTHER:
+            default:
+                h.on_other(pkt + e.offset, e.length);
+                break;
+            }
+        }
+    }
+};
+
+/// Converts with endian.h, a message at a time, as the message decoder
+/// does.  The reference for the SIMD kernels.
+struct ScalarKernels {
+    static const char * name() { return "scalar"; }
+
+    static std::uint16_t be16(const std::uint8_t *p) { std::uint16_t v; memcpy(&v, p, sizeof(v)); return be16toh(v); }
+    static std::uint32_t be32(const std::uint8_t *p) { std::uint32_t v; memcpy(&v, p, sizeof(v)); return be32toh(v); }
+    static std::uint64_t be48(const std::uint8_t *p) { return (static_cast<std::uint64_t>(be16(p)) << 32) | be32(p + 2); }
+    static std::uint64_t be64(const std::uint8_t *p) { std::uint64_t v; memcpy(&v, p, sizeof(v)); return be64toh(v); }
+
+    template<typename Record>
+    static void header(const std::uint8_t *m, Record &r) {
+        r.timestamp = be48(m + 5);
+        r.stock_locate = be16(m + 1);
+        r.tracking_number = be16(m + 3);
+    }
+
+    static void adds(const std::uint8_t * const *msgs, std::size_t n, Add *out) {
+        for (std::size_t i = 0; i < n; ++i) {
+            const std::uint8_t *m = msgs[i];
+            Add &r = out[i];
+            header(m, r);
+            r.buy_sell_indicator = static_cast<char>(m[19]);
+            r.attributed = 'F' == m[0];
+            r.reserved = 0;
+            r.order_refnum = be64(m + 11);
+            r.shares = be32(m + 20);
+            r.price = be32(m + 32);
+            memcpy(r.stock.data(), m + 24, r.stock.size());
+        }
+    }
+
+    static void executes(const std::uint8_t * const *msgs, std::size_t n, Execute *out) {
+        for (std::size_t i = 0; i < n; ++i) {
+            const std::uint8_t *m = msgs[i];
+            Execute &r = out[i];
+            header(m, r);
+            r.reserved = 0;
+            r.order_refnum = be64(m + 11);
+            r.executed_shares = be32(m + 19);
+            r.match_number = be64(m + 23);
+            if ('C' == m[0]) {
+                r.printable = static_cast<char>(m[31]);
+                r.with_price = 1;
+                r.execution_price = be32(m + 32);
+            } else {
+                r.printable = 0;
+                r.with_price = 0;
+                r.execution_price = 0;
+            }
+        }
+    }
+
+    static void cancels(const std::uint8_t * const *msgs, std::size_t n, Cancel *out) {
+        for (std::size_t i = 0; i < n; ++i) {
+            const std::uint8_t *m = msgs[i];
+            Cancel &r = out[i];
+            header(m, r);
+            r.reserved = 0;
+            r.order_refnum = be64(m + 11);
+            r.canceled_shares = be32(m + 19);
+            r.reserved2 = 0;
+        }
+    }
+
+    static void deletes(const std::uint8_t * const *msgs, std::size_t n, Delete *out) {
+        for (std::size_t i = 0; i < n; ++i) {
+            const std::uint8_t *m = msgs[i];
+            Delete &r = out[i];
+            header(m, r);
+            r.reserved = 0;
+            r.order_refnum = be64(m + 11);
+        }
+    }
+
+    static void replaces(const std::uint8_t * const *msgs, std::size_t n, Replace *out) {
+        for (std::size_t i = 0; i < n; ++i) {
+            const std::uint8_t *m = msgs[i];
+            Replace &r = out[i];
+            header(m, r);
+            r.reserved = 0;
+            r.original_order_refnum = be64(m + 11);
+            r.new_order_refnum = be64(m + 19);
+            r.shares = be32(m + 27);
+            r.price = be32(m + 31);
+        }
+    }
+};
+
+#if defined(__SSSE3__)
+
+/// Byte swaps with pshufb: each record is built from three 16 byte loads
+/// of its message, one shuffle each, stored straight into the record
+/// layout.  With AVX2 two messages share each 256 bit shuffle.  All loads
+/// lie within the message.
+struct SIMDKernels {
+#if defined(__AVX2__)
+    static const char * name() { return "avx2"; }
+#else
+    static const char * name() { return "ssse3"; }
+#endif
+
+    // -1 (0x80) clears the byte
+    static __m128i mask(char b0, char b1, char b2, char b3, char b4, char b5, char b6, char b7,
+                        char b8, char b9, char b10, char b11, char b12, char b13, char b14, char b15) {
+        return _mm_setr_epi8(b0, b1, b2, b3, b4, b5, b6, b7, b8, b9, b10, b11, b12, b13, b14, b15);
+    }
+
+    /// m[0..15] to timestamp, stock_locate, tracking_number and 4 zero
+    //  bytes, the first 16 bytes of every record.
+    static __m128i header_mask() { return mask(10, 9, 8, 7, 6, 5, -1, -1, 2, 1, 4, 3, -1, -1, -1, -1); }
+
+    static void store(void *p, __m128i v) { _mm_storeu_si128(reinterpret_cast<__m128i *>(p), v); }
+    static void store8(void *p, __m128i v) { _mm_storel_epi64(reinterpret_cast<__m128i *>(p), v); }
+    static __m128i load(const std::uint8_t *p) { return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)); }
+
+    /// Apply shuffle k to the 16 bytes at offset off of each message, and
+    //  store the result at offset out_off of each record: two messages per
+    //  shuffle with AVX2.
+    template<typename Record, bool WIDE>
+    static void shuffle_store(const std::uint8_t * const *msgs, std::size_t n, Record *out,
+                              std::size_t off, __m128i k, std::size_t out_off) {
+        std::size_t i = 0;
+#if defined(__AVX2__)
+        const __m256i k2 = _mm256_broadcastsi128_si256(k);
+        for (; i + 1 < n; i += 2) {
+            const __m256i v = _mm256_shuffle_epi8(
+                _mm256_inserti128_si256(_mm256_castsi128_si256(load(msgs[i] + off)), load(msgs[i + 1] + off), 1), k2);
+            if (WIDE) {
+                store(reinterpret_cast<std::uint8_t *>(&out[i]) + out_off, _mm256_castsi256_si128(v));
+                store(reinterpret_cast<std::uint8_t *>(&out[i + 1]) + out_off, _mm256_extracti128_si256(v, 1));
+            } else {
+                store8(reinterpret_cast<std::uint8_t *>(&out[i]) + out_off, _mm256_castsi256_si128(v));
+                store8(reinterpret_cast<std::uint8_t *>(&out[i + 1]) + out_off, _mm256_extracti128_si256(v, 1));
+            }
+        }
+#endif
+        for (; i < n; ++i) {
+            const __m128i v = _mm_shuffle_epi8(load(msgs[i] + off), k);
+            if (WIDE) {
+                store(reinterpret_cast<std::uint8_t *>(&out[i]) + out_off, v);
+            } else {
+                store8(reinterpret_cast<std::uint8_t *>(&out[i]) + out_off, v);
+            }
+        }
+    }
+
+    static void adds(const std::uint8_t * const *msgs, std::size_t n, Add *out) {
+        shuffle_store<Add, true>(msgs, n, out, 0, header_mask(), 0);
+        // m[11..26]: order_refnum, the upper half is overwritten below
+        shuffle_store<Add, true>(msgs, n, out, 11, mask(7, 6, 5, 4, 3, 2, 1, 0, -1, -1, -1, -1, -1, -1, -1, -1), 16);
+        // m[20..35]: shares, price, stock
+        shuffle_store<Add, true>(msgs, n, out, 20, mask(3, 2, 1, 0, 15, 14, 13, 12, 4, 5, 6, 7, 8, 9, 10, 11), 24);
+        for (std::size_t i = 0; i < n; ++i) {
+            out[i].buy_sell_indicator = static_cast<char>(msgs[i][19]);
+            out[i].attributed = 'F' == msgs[i][0];
+        }
+    }
+
+    static void executes(const std::uint8_t * const *msgs, std::size_t n, Execute *out) {
+        shuffle_store<Execute, true>(msgs, n, out, 0, header_mask(), 0);
+        // m[11..26]: order_refnum
+        shuffle_store<Execute, true>(msgs, n, out, 11, mask(7, 6, 5, 4, 3, 2, 1, 0, -1, -1, -1, -1, -1, -1, -1, -1), 16);
+        // m[15..30]: match_number, executed_shares, and a zero price
+        shuffle_store<Execute, true>(msgs, n, out, 15, mask(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, -1, -1, -1, -1), 24);
+        for (std::size_t i = 0; i < n; ++i) {
+            if ('C' == msgs[i][0]) {
+                out[i].printable = static_cast<char>(msgs[i][31]);
+                out[i].with_price = 1;
+                out[i].execution_price = ScalarKernels::be32(msgs[i] + 32);
+            }
+        }
+    }
+
+    static void cancels(const std::uint8_t * const *msgs, std::size_t n, Cancel *out) {
+        shuffle_store<Cancel, true>(msgs, n, out, 0, header_mask(), 0);
+        // m[7..22]: order_refnum, canceled_shares
+        shuffle_store<Cancel, true>(msgs, n, out, 7, mask(11, 10, 9, 8, 7, 6, 5, 4, 15, 14, 13, 12, -1, -1, -1, -1), 16);
+    }
+
+    static void deletes(const std::uint8_t * const *msgs, std::size_t n, Delete *out) {
+        shuffle_store<Delete, true>(msgs, n, out, 0, header_mask(), 0);
+        // m[3..18]: order_refnum
+        shuffle_store<Delete, false>(msgs, n, out, 3, mask(15, 14, 13, 12, 11, 10, 9, 8, -1, -1, -1, -1, -1, -1, -1, -1), 16);
+    }
+
+    static void replaces(const std::uint8_t * const *msgs, std::size_t n, Replace *out) {
+        shuffle_store<Replace, true>(msgs, n, out, 0, header_mask(), 0);
+        // m[11..26]: original_order_refnum, new_order_refnum
+        shuffle_store<Replace, true>(msgs, n, out, 11, mask(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8), 16);
+        // m[19..34]: shares, price
+        shuffle_store<Replace, false>(msgs, n, out, 19, mask(11, 10, 9, 8, 15, 14, 13, 12, -1, -1, -1, -1, -1, -1, -1, -1), 32);
+    }
+};
+
+using DefaultKernels = SIMDKernels;
+
+#else
+
+using DefaultKernels = ScalarKernels;
+
+#endif
+
+/// Decodes whole MoldUDP64 packets into a Packet.  Kernels is
+/// SIMDKernels when the build targets SSSE3 or AVX2, ScalarKernels
+/// otherwise.
+template<typename Kernels = DefaultKernels, std::size_t MAX_MSGS = 512>
+class BatchDecoder {
+public:
+    using PacketType = Packet<MAX_MSGS>;
+
+    static const std::size_t MOLD_HEADER_SIZE = 20;
+
+public:
+    BatchDecoder() = default;
+    BatchDecoder(const BatchDecoder &) = delete;
+    BatchDecoder & operator=(const BatchDecoder &) = delete;
+
+    static const char * kernels() { return Kernels::name(); }
+
+    /// Returns false, with p empty, if buf is too short for a MoldUDP64
+    /// header.  Message blocks that run past len end the packet.
+    bool decode(const std::uint8_t *buf, std::size_t len, PacketType &p) {
+        p.num_entries = p.num_adds = p.num_executes = p.num_cancels = p.num_deletes = p.num_replaces = 0;
+        p.truncated = false;
+        if (UNLIKELY(len < MOLD_HEADER_SIZE)) {
+            p.msg_count = 0;
+            return false;
+        }
+        memcpy(p.session.data(), buf, p.session.size());
+        p.seqnum = ScalarKernels::be64(buf + 10);
+        p.msg_count = ScalarKernels::be16(buf + 18);
+        const std::size_t count = 0xFFFF == p.msg_count ? 0 : p.msg_count;
+
+        // pass 1: find the message boundaries and sort by type
+        std::size_t off = MOLD_HEADER_SIZE;
+        for (std::size_t n = 0; n < count && off + 2 <= len; ++n) {
+            const std::uint16_t msg_len = ScalarKernels::be16(buf + off);
+            off += 2;
+            if (UNLIKELY(off + msg_len > len || 0 == msg_len)) {
+                break;
+            }
+            if (UNLIKELY(p.num_entries == MAX_MSGS)) {
+                p.truncated = true;
+                break;
+            }
+            classify_(buf + off, msg_len, static_cast<std::uint16_t>(off), p);
+            off += msg_len;
+        }
+
+        // pass 2: convert each type in one go
+        Kernels::adds(m_adds.data(), p.num_adds, p.adds.data());
+        Kernels::executes(m_executes.data(), p.num_executes, p.executes.data());
+        Kernels::cancels(m_cancels.data(), p.num_cancels, p.cancels.data());
+        Kernels::deletes(m_deletes.data(), p.num_deletes, p.deletes.data());
+        Kernels::replaces(m_replaces.data(), p.num_replaces, p.replaces.data());
+        return true;
+    }
+
+private:
+    using MsgPtrs = std::array<const std::uint8_t *, MAX_MSGS>;
+
+    static void push_(PacketType &p, Entry::Kind k, MsgPtrs &ptrs, std::size_t &n, const std::uint8_t *m,
+                      std::uint16_t off, std::uint16_t len) {
+        p.entries[p.num_entries++] = Entry{k, static_cast<std::uint16_t>(n), off, len};
+        ptrs[n++] = m;
+    }
+
+    void classify_(const std::uint8_t *m, std::uint16_t len, std::uint16_t off, PacketType &p) {
+        switch (m[0]) {
+        case 'A':
+            if (ADD_SIZE == len) {
+                push_(p, Entry::Kind::ADD, m_adds, p.num_adds, m, off, len);
+                return;
+            }
+            break;
+        case 'F':
+            if (ADD_MPID_SIZE == len) {
+                push_(p, Entry::Kind::ADD, m_adds, p.num_adds, m, off, len);
+                return;
+            }
+            break;
+        case 'E':
+            if (EXECUTE_SIZE == len) {
+                push_(p, Entry::Kind::EXECUTE, m_executes, p.num_executes, m, off, len);
+                return;
+            }
+            break;
+        case 'C':
+            if (EXECUTE_WITH_PRICE_SIZE == len) {
+                push_(p, Entry::Kind::EXECUTE, m_executes, p.num_executes, m, off, len);
+                return;
+            }
+            break;
+        case 'X':
+            if (CANCEL_SIZE == len) {
+                push_(p, Entry::Kind::CANCEL, m_cancels, p.num_cancels, m, off, len);
+                return;
+            }
+            break;
+        case 'D':
+            if (DELETE_SIZE == len) {
+                push_(p, Entry::Kind::DELETE, m_deletes, p.num_deletes, m, off, len);
+                return;
+            }
+            break;
+        case 'U':
+            if (REPLACE_SIZE == len) {
+                push_(p, Entry::Kind::REPLACE, m_replaces, p.num_replaces, m, off, len);
+                return;
+            }
+            break;
+        default:
+            break;
+        }
+        p.entries[p.num_entries++] = Entry{Entry::Kind::OTHER, 0, off, len};
+    }
+
+private:
+    MsgPtrs m_adds;
+    MsgPtrs m_executes;
+    MsgPtrs m_cancels;
+    MsgPtrs m_deletes;
+    MsgPtrs m_replaces;
+};
+
+}}}}}
@@ -0,0 +1,204 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include <i01_core/Lock.hpp>
+#include <i01_core/MIC.hpp>
+#include <i01_core/Time.hpp>
+
+#include <i01_md/BookBase.hpp>
+#include <i01_md/BookMuxEvents.hpp>
+#include <i01_md/BookMuxListener.hpp>
+#include <i01_md/OrderData.hpp>
+#include <i01_md/ShardedDispatch.hpp>
+#include <i01_md/Symbol.hpp>
+#include <i01_md/SymbolState.hpp>
+
+namespace i01 { namespace MD {
+
+struct NBBOEvent {
+    typedef core::Timestamp Timestamp;
+    typedef core::MIC MIC;
+    typedef std::uint32_t VenueMask;
+
+    const Timestamp &m_timestamp;
+    /// The venue whose packet changed the NBBO.
+    const MIC &m_mic;
+    const EphemeralSymbolIndex m_esi;
+    /// Sizes are totals over the venues at the best price, and num_orders
+    //  is the number of those venues.
+    const FullL2Quote &m_nbbo;
+    /// Bit MIC::index() is set for each venue at the best price.
+    const VenueMask m_bid_venues;
+    const VenueMask m_ask_venues;
+};
+
+class NBBOListener {
+public:
+    virtual ~NBBOListener() = default;
+    virtual void on_nbbo_event(const NBBOEvent &) = 0;
+};
+
+/// Consolidated best bid and offer across all venues, for every symbol.
+///
+/// Fed by the book muxes, through DataManager, like any other listener: it
+/// notes which symbols each venue's packet touched, and at the end of the
+/// packet reads those books' tops and folds any change into the NBBO.  Each
+/// symbol's venue tops are one flat array, and the venues at the best
+/// price on each side are a bitmask, so a change that does not touch the
+/// best price costs a compare, and only the last venue leaving the best
+/// price needs a scan.  Listeners get at most one NBBOEvent per symbol per
+/// packet.
+///
+/// Each listener has its own quote policy, the trading states in which a
+/// venue's quotes count (TRADING by default; a venue is counted until it
+/// sends a trading status).  Listeners with the same policy share one
+/// NBBO, so the usual case of a single policy costs one NBBO per symbol.
+///
+/// Under sharded dispatch the engine is instead fed the venue tops the
+/// pollers publish to their rings, on a consumer thread of its own, and
+/// listeners get an NBBOEvent per venue update that changes the NBBO.  A
+/// venue's gap empties its quotes until its books update again.
+class NBBOEngine : public NoopBookMuxListener,
+                   public ShardUpdateListener {
+public:
+    using VenueMask = NBBOEvent::VenueMask;
+    using Mutex = core::SpinMutex;
+    using TradingStateBitfield = std::underlying_type<SymbolState::TradingState>::type;
+    using ListenerContainer = std::vector<NBBOListener *>;
+
+    static const int NUM_VENUES = (int) core::MIC::Enum::NUM_MIC;
+    static_assert(NUM_VENUES <= 8 * (int) sizeof(VenueMask), "NBBOEngine: too many MICs for VenueMask");
+
+    static const TradingStateBitfield DEFAULT_POLICY = static_cast<TradingStateBitfield>(SymbolState::TradingState::TRADING);
+
+    struct VenueQuote {
+        Price bid_price;
+        Price ask_price;
+        Size bid_size;
+        Size ask_size;
+    };
+
+public:
+    NBBOEngine();
+    virtual ~NBBOEngine() = default;
+    NBBOEngine(const NBBOEngine &) = delete;
+    NBBOEngine & operator=(const NBBOEngine &) = delete;
+
+    /// Not thread safe: subscribe before data starts.  l gets the NBBO of
+    /// the venues whose trading state is in policy; subscribing l again
+    /// changes its policy.  The per symbol tables are allocated by the
+    /// first subscription.
+    void subscribe(NBBOListener *l, TradingStateBitfield policy = DEFAULT_POLICY);
+    bool active() const { return !m_views.empty(); }
+
+    /// The NBBO under policy, empty if no listener has that policy.
+    FullL2Quote nbbo(const EphemeralSymbolIndex esi, TradingStateBitfield policy = DEFAULT_POLICY) const;
+    VenueMask bid_venues(const EphemeralSymbolIndex esi, TradingStateBitfield policy = DEFAULT_POLICY) const;
+    VenueMask ask_venues(const EphemeralSymbolIndex esi, TradingStateBitfield policy = DEFAULT_POLICY) const;
+    VenueQuote venue_quote(const core::MIC &mic, const EphemeralSymbolIndex esi) const;
+
+    /// Fold a venue's new top of book into the NBBO, returns true if the
+    /// NBBO changed under any policy.  The BookMuxListener interface calls
+    /// this once per touched symbol per packet; it is public for replaying
+    /// tops directly.
+    bool update_venue(const core::MIC &mic, const EphemeralSymbolIndex esi, const FullSummary &top);
+
+    /* BookMuxListener */
+    virtual void on_book_added(const L3AddEvent &evt) override { touch_(evt.m_book); }
+    virtual void on_book_canceled(const L3CancelEvent &evt) override { touch_(evt.m_book); }
+    virtual void on_book_modified(const L3ModifyEvent &evt) override { touch_(evt.m_book); }
+    virtual void on_book_executed(const L3ExecutionEvent &evt) override { touch_(evt.m_book); }
+    virtual void on_l2_update(const L2BookEvent &evt) override;
+    virtual void on_trading_status_update(const TradingStatusEvent &evt) override;
+    virtual void on_end_of_data(const PacketEvent &evt) override;
+
+    /* ShardUpdateListener */
+    virtual void on_shard_update(const ShardUpdate &u) override;
+
+private:
+    /// Bit i is set for the i'th of m_views.
+    using ViewMask = std::uint32_t;
+    static const std::size_t MAX_VIEWS = 8 * sizeof(ViewMask);
+
+    struct SideNBBO {
+        Price price;
+        Size size;
+        VenueMask venues;
+    };
+
+    struct SymbolNBBO {
+        SideNBBO bid;
+        SideNBBO ask;
+        VenueMask enabled;
+    };
+
+    /// The NBBO of every symbol under one policy, and its listeners.
+    struct View {
+        TradingStateBitfield policy;
+        std::unique_ptr<SymbolNBBO[]> nbbo;
+        ListenerContainer listeners;
+    };
+
+    /// Each venue's top and trading state for one symbol; its mutex also
+    //  guards the symbol's SymbolNBBO in every view.
+    struct SymbolVenues {
+        std::array<VenueQuote, NUM_VENUES> quotes;
+        /// 0 until the venue sends a trading status.
+        std::array<TradingStateBitfield, NUM_VENUES> states;
+        mutable Mutex mutex;
+    };
+
+    struct Touched {
+        const BookBase *book;
+        ViewMask status_changed;
+    };
+
+    struct Changed {
+        EphemeralSymbolIndex esi;
+        ViewMask views;
+    };
+
+    /// Symbols touched by the current packet of one venue.
+    struct VenuePacket {
+        Mutex mutex;
+        std::vector<Touched> touched;
+        /// 1 + index into touched of each symbol, 0 if absent.
+        std::unique_ptr<std::uint32_t[]> slot_by_esi;
+        /// Spare storage for the NBBOs a packet changed, empty whenever
+        //  mutex is free.
+        std::vector<Changed> changed;
+    };
+
+private:
+    void touch_(const BookBase &b, ViewMask status_changed = 0);
+
+    const View * view_(TradingStateBitfield policy) const;
+    void init_view_(View &v);
+    static bool enabled_in_(TradingStateBitfield policy, TradingStateBitfield state) {
+        return 0 == state || 0 != (policy & state);
+    }
+
+    ViewMask update_venue_(int venue, EphemeralSymbolIndex esi, const FullSummary &top);
+    ViewMask update_state_(int venue, EphemeralSymbolIndex esi, TradingStatusEvent::Event e);
+    bool fold_side_(SymbolNBBO &n, const SymbolVenues &sv, int venue, bool is_bid, Price p, Size s, Size old_s);
+    void rescan_side_(SymbolNBBO &n, const SymbolVenues &sv, bool is_bid);
+    bool enable_venue_(SymbolNBBO &n, const SymbolVenues &sv, int venue, bool enable);
+    void publish_(const core::Timestamp &ts, const core::MIC &mic, EphemeralSymbolIndex esi, const View &v);
+    void publish_(const core::Timestamp &ts, const core::MIC &mic, EphemeralSymbolIndex esi, ViewMask views);
+
+    static FullL2Quote quote_(const SymbolNBBO &n);
+
+private:
+    const Price m_empty_bid;
+    const Price m_empty_ask;
+    std::unique_ptr<SymbolVenues[]> m_venues;
+    std::vector<std::unique_ptr<View> > m_views;
+    std::array<VenuePacket, NUM_VENUES> m_packets;
+};
+
+}}
@@ -0,0 +1,274 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#include <i01_core/macro.hpp>
+
+namespace i01 { namespace MD {
+
+/// Counters kept by OrderRefIndex.  A probe is one slot examined.
+struct OrderRefIndexStats {
+    std::uint64_t lookups;
+    std::uint64_t probes;
+    std::uint32_t max_probe_length;
+    /// Inserts refused because the index was at capacity.
+    std::uint64_t overflows;
+
+    double mean_probe_length() const { return lookups ? static_cast<double>(probes) / lookups : 0.0; }
+};
+
+/// Hash index from an order reference number to a small value, with all
+/// storage allocated at construction.
+///
+/// Open addressing with linear probing over a power of two table at least
+/// twice the capacity, so the load factor never exceeds 1/2.  Erase shifts
+/// the rest of the probe run back rather than leaving tombstones, so runs
+/// stay short over a whole day of adds and deletes, and clear() is O(1):
+/// each slot carries the epoch it was written in.
+template<typename Value, typename Key = std::uint64_t>
+class OrderRefIndex {
+public:
+    using Stats = OrderRefIndexStats;
+
+public:
+    explicit OrderRefIndex(std::size_t capacity)
+        : m_capacity(check_capacity_(capacity)), m_mask(table_size_(capacity) - 1),
+          m_slots(new Slot[m_mask + 1]()), m_size(0), m_epoch(1), m_stats() {}
+    OrderRefIndex(const OrderRefIndex &) = delete;
+    OrderRefIndex & operator=(const OrderRefIndex &) = delete;
+
+    std::size_t size() const { return m_size; }
+    bool empty() const { return 0 == m_size; }
+    /// Maximum number of entries.
+    std::size_t capacity() const { return m_capacity; }
+    std::size_t table_size() const { return m_mask + 1; }
+    double load_factor() const { return static_cast<double>(m_size) / table_size(); }
+
+    const Stats & stats() const { return m_stats; }
+    void reset_stats() { m_stats = Stats(); }
+
+    Value * find(const Key k) {
+        Slot *s = find_slot_(k);
+        return nullptr != s ? &s->value : nullptr;
+    }
+    const Value * find(const Key k) const { return const_cast<OrderRefIndex *>(this)->find(k); }
+
+    /// Returns the entry for k and true if it was inserted, false if k was
+    /// already present.  Returns nullptr if k is new and the index is full.
+    std::pair<Value *, bool> insert(const Key k, const Value &v) {
+        std::uint32_t n = 1;
+        std::size_t i = hash_(k) & m_mask;
+        for (; occupied_(m_slots[i]); i = (i + 1) & m_mask, ++n) {
+            if (m_slots[i].key == k) {
+                count_(n);
+                return { &m_slots[i].value, false };
+            }
+        }
+        count_(n);
+        if (UNLIKELY(m_size == m_capacity)) {
+            ++m_stats.overflows;
+            return { nullptr, false };
+        }
+        m_slots[i].key = k;
+        m_slots[i].epoch = m_epoch;
+        m_slots[i].value = v;
+        ++m_size;
+        return { &m_slots[i].value, true };
+    }
+
+    bool erase(const Key k) {
+        Slot *s = find_slot_(k);
+        if (nullptr == s) {
+            return false;
+        }
+        // shift back any entry further along the run that would otherwise
+        // no longer be reachable from its home slot
+        std::size_t hole = static_cast<std::size_t>(s - m_slots.get());
+        for (std::size_t j = (hole + 1) & m_mask; occupied_(m_slots[j]); j = (j + 1) & m_mask) {
+            const std::size_t home = hash_(m_slots[j].key) & m_mask;
+            if (((j - home) & m_mask) >= ((j - hole) & m_mask)) {
+                m_slots[hole] = m_slots[j];
+                hole = j;
+            }
+        }
+        m_slots[hole].epoch = 0;
+        --m_size;
+        return true;
+    }
+
+    void clear() {
+        m_size = 0;
+        if (UNLIKELY(0 == ++m_epoch)) {
+            for (std::size_t i = 0; i <= m_mask; ++i) {
+                m_slots[i].epoch = 0;
+            }
+            m_epoch = 1;
+        }
+    }
+
+private:
+    struct Slot {
+        Key key;
+        std::uint32_t epoch;
+        Value value;
+    };
+
+    static std::size_t check_capacity_(std::size_t capacity) {
+        if (0 == capacity || capacity > std::numeric_limits<std::uint32_t>::max()) {
+            throw std::invalid_argument("OrderRefIndex: capacity out of range");
+        }
+        return capacity;
+    }
+
+    static std::size_t table_size_(std::size_t capacity) {
+        std::size_t n = 2;
+        while (n < 2 * capacity) {
+            n <<= 1;
+        }
+        return n;
+    }
+
+    /// Reference numbers are mostly sequential per feed, so mix all the
+    /// bits into the low ones used for the slot.
+    static std::size_t hash_(Key k) {
+        std::uint64_t h = static_cast<std::uint64_t>(k);
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        return static_cast<std::size_t>(h);
+    }
+
+    bool occupied_(const Slot &s) const { return s.epoch == m_epoch; }
+
+    void count_(std::uint32_t n) {
+        ++m_stats.lookups;
+        m_stats.probes += n;
+        if (UNLIKELY(n > m_stats.max_probe_length)) {
+            m_stats.max_probe_length = n;
+        }
+    }
+
+    Slot * find_slot_(const Key k) {
+        std::uint32_t n = 1;
+        for (std::size_t i = hash_(k) & m_mask; occupied_(m_slots[i]); i = (i + 1) & m_mask, ++n) {
+            if (m_slots[i].key == k) {
+                count_(n);
+                return &m_slots[i];
+            }
+        }
+        count_(n);
+        return nullptr;
+    }
+
+private:
+    const std::size_t m_capacity;
+    const std::size_t m_mask;
+    const std::unique_ptr<Slot[]> m_slots;
+    std::size_t m_size;
+    std::uint32_t m_epoch;
+    Stats m_stats;
+};
+
+/// Fixed capacity store of order records by reference number: a slab of
+/// records, preallocated along with a free list, and an OrderRefIndex from
+/// reference number to slab slot.  Records never move, so pointers stay
+/// valid until erased, and once constructed the store never allocates.
+template<typename Record, typename Key = std::uint64_t>
+class OrderStore {
+public:
+    using Index = OrderRefIndex<std::uint32_t, Key>;
+    using Stats = typename Index::Stats;
+
+    static const std::size_t DEFAULT_CAPACITY = 1 << 22;
+
+public:
+    explicit OrderStore(std::size_t capacity = DEFAULT_CAPACITY)
+        : m_index(capacity), m_records(new Record[capacity]),
+          m_free(new std::uint32_t[capacity]), m_num_free(0) {
+        release_all_();
+    }
+    OrderStore(const OrderStore &) = delete;
+    OrderStore & operator=(const OrderStore &) = delete;
+
+    std::size_t size() const { return m_index.size(); }
+    bool empty() const { return m_index.empty(); }
+    std::size_t capacity() const { return m_index.capacity(); }
+    double load_factor() const { return m_index.load_factor(); }
+    const Stats & stats() const { return m_index.stats(); }
+    void reset_stats() { m_index.reset_stats(); }
+
+    Record * find(const Key k) {
+        const std::uint32_t *slot = m_index.find(k);
+        return nullptr != slot ? &m_records[*slot] : nullptr;
+    }
+    const Record * find(const Key k) const { return const_cast<OrderStore *>(this)->find(k); }
+
+    /// As OrderRefIndex::insert: an existing record is left unchanged.
+    std::pair<Record *, bool> insert(const Key k, const Record &r) {
+        // the index is full exactly when the slab is, and then refuses k
+        const std::uint32_t free_slot = m_num_free ? m_free[m_num_free - 1] : 0;
+        auto res = m_index.insert(k, free_slot);
+        if (!res.second) {
+            return { nullptr != res.first ? &m_records[*res.first] : nullptr, false };
+        }
+        --m_num_free;
+        m_records[free_slot] = r;
+        return { &m_records[free_slot], true };
+    }
+
+    bool erase(const Key k) {
+        const std::uint32_t *slot = m_index.find(k);
+        if (nullptr == slot) {
+            return false;
+        }
+        m_free[m_num_free++] = *slot;
+        return m_index.erase(k);
+    }
+
+    /// Move the record for old_k to new_k in place, as for an order
+    /// replace that assigns a new reference number.  Returns nullptr if
+    /// old_k is absent or new_k is already present.
+    Record * rekey(const Key old_k, const Key new_k) {
+        const std::uint32_t *slot = m_index.find(old_k);
+        if (nullptr == slot) {
+            return nullptr;
+        }
+        const std::uint32_t s = *slot;
+        m_index.erase(old_k);
+        // there is room, old_k was just erased
+        auto res = m_index.insert(new_k, s);
+        if (!res.second) {
+            m_index.insert(old_k, s);
+            return nullptr;
+        }
+        return &m_records[s];
+    }
+
+    void clear() {
+        m_index.clear();
+        release_all_();
+    }
+
+private:
+    void release_all_() {
+        // hand out low slots first
+        const std::size_t n = m_index.capacity();
+        for (std::size_t i = 0; i < n; ++i) {
+            m_free[i] = static_cast<std::uint32_t>(n - 1 - i);
+        }
+        m_num_free = n;
+    }
+
+private:
+    Index m_index;
+    const std::unique_ptr<Record[]> m_records;
+    const std::unique_ptr<std::uint32_t[]> m_free;
+    std::size_t m_num_free;
+};
+
+}}
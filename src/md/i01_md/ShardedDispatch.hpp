@@ -0,0 +1,472 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <i01_core/Config.hpp>
+#include <i01_core/Lock.hpp>
+#include <i01_core/MIC.hpp>
+#include <i01_core/NamedThread.hpp>
+#include <i01_core/SPSCRing.hpp>
+#include <i01_core/Time.hpp>
+
+#include <i01_md/BookBase.hpp>
+#include <i01_md/BookMuxEvents.hpp>
+#include <i01_md/BookSnapshot.hpp>
+#include <i01_md/L2Book.hpp>
+#include <i01_md/MDEventPoller.hpp>
+
+namespace i01 { namespace MD {
+
+/// What a shard publishes for cross-venue consumers.  Holds values rather
+/// than references, so consumers never read books owned by a shard thread.
+struct ShardUpdate {
+    enum class Kind : std::uint8_t {
+        UNKNOWN = 0,
+        /// bid and ask are the venue's top after a book change.
+        QUOTE = 1,
+        /// trade_price and trade_size are set, bid and ask as for QUOTE.
+        TRADE = 2,
+        /// The venue's feed gapped: its quotes are suspect until updated.
+        GAP = 3,
+        /// status is the book's new trading status.
+        STATUS = 4,
+    };
+
+    core::Timestamp timestamp;
+    /// Per shard, contiguous from 1.
+    std::uint64_t seqnum;
+    EphemeralSymbolIndex esi;
+    core::MICEnum mic;
+    Kind kind;
+    QuoteLevel bid;
+    QuoteLevel ask;
+    Price trade_price;
+    Size trade_size;
+    TradingStatusEvent::Event status;
+};
+
+class ShardUpdateListener {
+public:
+    virtual ~ShardUpdateListener() = default;
+    virtual void on_shard_update(const ShardUpdate &) = 0;
+};
+
+/// One decoding thread's outbound queue: the event poller thread that owns
+/// a group of MICs' decoders and book muxes is its only producer.
+///
+/// The producer never waits for the consumer.  A QUOTE, STATUS or GAP that
+/// does not fit in the ring is held back, at most one QUOTE and one STATUS
+/// per book and one GAP per MIC, since only the latest top and status of a
+/// book matter: a newer one drops the held one and is held behind
+/// everything held before it, and a GAP drops the quotes and gap held for
+/// its MIC, so the consumer still sees them in the order they were
+/// published.  Held updates go out ahead of anything
+/// published later, as soon as the ring has room; flush() retries them
+/// without publishing anything new.  A TRADE that does not fit while the
+/// ring is full is dropped and counted.
+class MDShard {
+public:
+    using Ring = core::SPSCRing<ShardUpdate>;
+    using MICs = std::vector<core::MIC>;
+
+    static const std::size_t DEFAULT_RING_SIZE = 65536;
+
+public:
+    MDShard(const std::string &name, const MICs &mics, std::size_t ring_size = DEFAULT_RING_SIZE)
+        : m_name(name), m_ring(ring_size), m_seqnum(0), m_lane(),
+          m_last_top(mics.size() * NUM_SYMBOL_INDEX),
+          m_held(mics.size() * KEYS_PER_MIC),
+          m_held_slot(m_held.size(), 0), m_held_head(0), m_num_held(0),
+          m_num_live(0), m_overflows(0), m_dropped(0) {
+        m_lane.fill(-1);
+        for (std::size_t i = 0; i < mics.size(); ++i) {
+            m_lane[mics[i].index()] = static_cast<int>(i);
+        }
+        const Price empty_bid = BookBase::EMPTY_BID_PRICE;
+        const Price empty_ask = BookBase::EMPTY_ASK_PRICE;
+        reset_tops_(0, m_last_top.size(), empty_bid, empty_ask);
+    }
+    MDShard(const MDShard &) = delete;
+    MDShard & operator=(const MDShard &) = delete;
+
+    const std::string & name() const { return m_name; }
+
+    /// Shard thread only.  Publish u, a QUOTE, unless the book's top is
+    //  the one last published for it.
+    void publish_quote(ShardUpdate &u) {
+        auto &last = m_last_top[lane_(u.mic) * NUM_SYMBOL_INDEX + u.esi];
+        if (same_(u.bid, last.bid) && same_(u.ask, last.ask)) {
+            return;
+        }
+        last = BookBest{ u.bid, u.ask };
+        publish(u);
+    }
+
+    /// Shard thread only.
+    void publish(ShardUpdate &u) {
+        switch (u.kind) {
+        case ShardUpdate::Kind::TRADE:
+            m_last_top[lane_(u.mic) * NUM_SYMBOL_INDEX + u.esi] = BookBest{ u.bid, u.ask };
+            break;
+        case ShardUpdate::Kind::GAP:
+            // every quote of the venue is suspect: republish them all
+            reset_tops_(lane_(u.mic) * NUM_SYMBOL_INDEX, NUM_SYMBOL_INDEX, BookBase::EMPTY_BID_PRICE, BookBase::EMPTY_ASK_PRICE);
+            break;
+        default:
+            break;
+        }
+        if (LIKELY(0 == m_num_held || flush())) {
+            if (LIKELY(push_(u))) {
+                return;
+            }
+        }
+        ++m_overflows;
+        if (ShardUpdate::Kind::TRADE == u.kind) {
+            ++m_dropped;
+        } else {
+            hold_(u);
+        }
+    }
+
+    /// Shard thread only.  Push held updates while the ring has room;
+    //  returns true if none are left.
+    bool flush() {
+        while (0 != m_num_held) {
+            auto &u = m_held[m_held_head];
+            if (ShardUpdate::Kind::UNKNOWN != u.kind) {
+                if (!push_(u)) {
+                    return false;
+                }
+                m_held_slot[key_(u)] = 0;
+                --m_num_live;
+            }
+            m_held_head = (m_held_head + 1) % m_held.size();
+            --m_num_held;
+        }
+        return true;
+    }
+
+    /// Updates that found the ring full.
+    std::uint64_t overflows() const { return m_overflows; }
+    /// Updates the consumer never saw: trades dropped, and held quotes
+    //  and gaps superseded by a newer one or by a gap.
+    std::uint64_t dropped() const { return m_dropped; }
+    /// Updates held back right now.
+    std::size_t held() const { return m_num_live; }
+
+    /// Consumer side.
+    Ring & ring() { return m_ring; }
+
+private:
+    static const std::size_t KEYS_PER_MIC = 2 * NUM_SYMBOL_INDEX + 1;
+
+    static bool same_(const QuoteLevel &a, const QuoteLevel &b) {
+        return a.price == b.price && a.size == b.size && a.num_orders == b.num_orders;
+    }
+
+    std::size_t lane_(core::MICEnum m) const { return static_cast<std::size_t>(m_lane[(int)m]); }
+
+    /// Index into m_held_slot: two per book, for its quote and its
+    //  status, and one per MIC for gaps.
+    std::size_t key_(const ShardUpdate &u) const {
+        std::size_t k = u.esi;
+        if (ShardUpdate::Kind::GAP == u.kind) {
+            k = 2 * NUM_SYMBOL_INDEX;
+        } else if (ShardUpdate::Kind::STATUS == u.kind) {
+            k += NUM_SYMBOL_INDEX;
+        }
+        return lane_(u.mic) * KEYS_PER_MIC + k;
+    }
+
+    void reset_tops_(std::size_t first, std::size_t n, Price empty_bid, Price empty_ask) {
+        for (std::size_t i = first; i < first + n; ++i) {
+            m_last_top[i] = BookBest{ QuoteLevel{ empty_bid, 0, 0 }, QuoteLevel{ empty_ask, 0, 0 } };
+        }
+    }
+
+    bool push_(ShardUpdate &u) {
+        u.seqnum = m_seqnum + 1;
+        if (UNLIKELY(!m_ring.try_push(u))) {
+            return false;
+        }
+        ++m_seqnum;
+        return true;
+    }
+
+    void hold_(const ShardUpdate &u) {
+        if (ShardUpdate::Kind::GAP == u.kind) {
+            // the consumer drops the venue's quotes at the gap anyway
+            for (std::size_t n = 0; n < m_num_held; ++n) {
+                auto &h = m_held[(m_held_head + n) % m_held.size()];
+                if (h.mic == u.mic && (ShardUpdate::Kind::QUOTE == h.kind || ShardUpdate::Kind::GAP == h.kind)) {
+                    drop_(h);
+                }
+            }
+        } else if (0 != m_held_slot[key_(u)]) {
+            drop_(m_held[m_held_slot[key_(u)] - 1]);
+        }
+        if (m_num_held == m_held.size()) {
+            compact_();
+        }
+        const std::size_t i = (m_held_head + m_num_held) % m_held.size();
+        m_held[i] = u;
+        m_held_slot[key_(u)] = static_cast<std::uint32_t>(i + 1);
+        ++m_num_held;
+        ++m_num_live;
+    }
+
+    /// Leave a held update in the FIFO, marked UNKNOWN, for flush() to skip.
+    void drop_(ShardUpdate &h) {
+        m_held_slot[key_(h)] = 0;
+        h.kind = ShardUpdate::Kind::UNKNOWN;
+        --m_num_live;
+        ++m_dropped;
+    }
+
+    /// Squeeze dropped updates out of the FIFO, keeping the rest in order.
+    //  There is then room for one more, as at most one is held per key and
+    //  the one being held has none.
+    void compact_() {
+        std::size_t w = m_held_head;
+        for (std::size_t n = 0; n < m_num_held; ++n) {
+            const std::size_t r = (m_held_head + n) % m_held.size();
+            if (ShardUpdate::Kind::UNKNOWN != m_held[r].kind) {
+                m_held[w] = m_held[r];
+                m_held_slot[key_(m_held[w])] = static_cast<std::uint32_t>(w + 1);
+                w = (w + 1) % m_held.size();
+            }
+        }
+        m_num_held = m_num_live;
+    }
+
+private:
+    std::string m_name;
+    Ring m_ring;
+    std::uint64_t m_seqnum;
+    /// Index of each of the shard's MICs into the per-book tables.
+    std::array<int, (int)core::MICEnum::NUM_MIC> m_lane;
+    /// Top last published per book, to publish only changes.
+    std::vector<BookBest> m_last_top;
+    /// Updates held back while the ring is full, a circular FIFO with
+    //  room for one per key.  Dropped ones stay in it as UNKNOWN.
+    std::vector<ShardUpdate> m_held;
+    /// 1 + index into m_held of the update held for each key, 0 if none.
+    std::vector<std::uint32_t> m_held_slot;
+    std::size_t m_held_head;
+    /// Length of the FIFO, and how many in it are not dropped.
+    std::size_t m_num_held;
+    std::size_t m_num_live;
+    core::Atomic<std::uint64_t> m_overflows;
+    core::Atomic<std::uint64_t> m_dropped;
+};
+
+/// Sharded market data dispatch.  Each event poller that carries feeds is
+/// a shard; the decoders on it publish venue quotes, trades, trading
+/// statuses and gaps into its ring, and a cross-venue consumer drains all
+/// rings with poll() on its own thread, in timestamp order across shards.
+///
+/// Configured from the md config, next to the pollers:
+///
+///     dispatch = "sharded",              -- default "serial"
+///     eventpollers = {
+///         batspoller = { affinity = 7, ring_size = 65536 },
+///         ...
+///     },
+class ShardedDispatcher {
+public:
+    using EventPollerConfig = MDEventPoller::EventPollerConfig;
+    using ShardContainer = std::vector<std::unique_ptr<MDShard> >;
+
+public:
+    ShardedDispatcher() : m_shard_by_mic() {}
+    ShardedDispatcher(const ShardedDispatcher &) = delete;
+    ShardedDispatcher & operator=(const ShardedDispatcher &) = delete;
+
+    static bool configured(const core::Config::storage_type &md_cfg) {
+        return "sharded" == md_cfg.get_or_default<std::string>("dispatch", "serial");
+    }
+
+    /// Create one shard per poller in epc.  Returns false, creating
+    /// nothing, if a MIC's feeds are split over more than one poller,
+    /// since its books would then have more than one writer.
+    bool init(const EventPollerConfig &epc, const core::Config::storage_type &md_cfg) {
+        std::array<const std::string *, (int)core::MICEnum::NUM_MIC> poller_by_mic{};
+        for (const auto &p : epc) {
+            for (const auto &entry : p.second) {
+                auto &poller = poller_by_mic[entry.mic.index()];
+                if (nullptr != poller && *poller != p.first) {
+                    std::cerr << "ShardedDispatcher: " << entry.mic << " is on pollers " << *poller << " and " << p.first << ", can not shard" << std::endl;
+                    return false;
+                }
+                poller = &p.first;
+            }
+        }
+
+        std::array<MDShard *, (int)core::MICEnum::NUM_MIC> shard_by_mic{};
+        ShardContainer shards;
+        auto pollers_cfg(md_cfg.copy_prefix_domain("eventpollers."));
+        for (const auto &p : epc) {
+            MDShard::MICs mics;
+            for (const auto &entry : p.second) {
+                if (std::find(mics.begin(), mics.end(), entry.mic) == mics.end()) {
+                    mics.push_back(entry.mic);
+                }
+            }
+            if (mics.empty()) {
+                continue;
+            }
+            auto poller_cfg(pollers_cfg->copy_prefix_domain(p.first + "."));
+            shards.emplace_back(new MDShard(p.first, mics, poller_cfg->get_or_default<std::size_t>("ring_size", MDShard::DEFAULT_RING_SIZE)));
+            for (const auto &m : mics) {
+                shard_by_mic[m.index()] = shards.back().get();
+            }
+        }
+        m_shards = std::move(shards);
+        m_shard_by_mic = shard_by_mic;
+        return true;
+    }
+
+    bool enabled() const { return !m_shards.empty(); }
+
+    const ShardContainer & shards() const { return m_shards; }
+
+    MDShard * shard(const core::MIC &m) const { return m_shard_by_mic[m.index()]; }
+
+    /// Called on the shard thread that decoded the event.  Events that do
+    //  not change a venue's top of book are not published.
+    template<typename Event>
+    void publish(const Event &) {}
+
+    /// Retry held updates at the end of each packet, so they go out even
+    //  if the feed then goes quiet.
+    void publish(const PacketEvent &e) {
+        MDShard *s = shard(e.mic);
+        if (nullptr != s) {
+            s->flush();
+        }
+    }
+
+    void publish(const L3AddEvent &e) { publish_quote_(e.m_timestamp, e.m_book); }
+    void publish(const L3CancelEvent &e) { publish_quote_(e.m_timestamp, e.m_book); }
+    void publish(const L3ModifyEvent &e) { publish_quote_(e.m_timestamp, e.m_book); }
+    void publish(const L3ExecutionEvent &e) { publish_quote_(e.m_timestamp, e.m_book); }
+    void publish(const L2BookEvent &e) { publish_quote_(e.m_timestamp, e.m_book); }
+
+    void publish(const TradeEvent &e) {
+        MDShard *s = shard(e.m_book.mic());
+        if (nullptr != s) {
+            auto u = make_update_(e.m_timestamp, e.m_book, ShardUpdate::Kind::TRADE);
+            u.trade_price = e.m_price;
+            u.trade_size = static_cast<Size>(e.m_size);
+            s->publish(u);
+        }
+    }
+
+    void publish(const TradingStatusEvent &e) {
+        MDShard *s = shard(e.m_book.mic());
+        if (nullptr != s) {
+            auto u = make_update_(e.m_timestamp, e.m_book, ShardUpdate::Kind::STATUS);
+            u.status = e.m_event;
+            s->publish(u);
+        }
+    }
+
+    void publish(const GapEvent &e) {
+        MDShard *s = shard(e.m_mic);
+        if (nullptr != s) {
+            ShardUpdate u{};
+            u.timestamp = e.m_timestamp;
+            u.mic = e.m_mic.market();
+            u.kind = ShardUpdate::Kind::GAP;
+            s->publish(u);
+        }
+    }
+
+    /// Consumer thread only.  Deliver up to max_updates, always taking the
+    /// earliest update at the head of any shard, and return the number
+    /// delivered.
+    std::size_t poll(ShardUpdateListener &l, std::size_t max_updates = 1024) {
+        std::size_t n = 0;
+        for (; n < max_updates; ++n) {
+            MDShard *next = nullptr;
+            const ShardUpdate *next_u = nullptr;
+            for (const auto &s : m_shards) {
+                const ShardUpdate *u = s->ring().front();
+                if (nullptr != u && (nullptr == next_u || u->timestamp < next_u->timestamp)) {
+                    next = s.get();
+                    next_u = u;
+                }
+            }
+            if (nullptr == next) {
+                break;
+            }
+            l.on_shard_update(*next_u);
+            next->ring().pop();
+        }
+        return n;
+    }
+
+private:
+    static ShardUpdate make_update_(const core::Timestamp &ts, const BookBase &b, ShardUpdate::Kind k) {
+        ShardUpdate u{};
+        u.timestamp = ts;
+        u.esi = b.symbol_index();
+        u.mic = b.mic().market();
+        u.kind = k;
+        const FullSummary best = b.best();
+        u.bid = QuoteLevel{ std::get<0>(best.first), std::get<1>(best.first), std::get<2>(best.first) };
+        u.ask = QuoteLevel{ std::get<0>(best.second), std::get<1>(best.second), std::get<2>(best.second) };
+        return u;
+    }
+
+    void publish_quote_(const core::Timestamp &ts, const BookBase &b) {
+        MDShard *s = shard(b.mic());
+        if (nullptr != s) {
+            auto u = make_update_(ts, b, ShardUpdate::Kind::QUOTE);
+            s->publish_quote(u);
+        }
+    }
+
+private:
+    ShardContainer m_shards;
+    std::array<MDShard *, (int)core::MICEnum::NUM_MIC> m_shard_by_mic;
+};
+
+/// Drains a ShardedDispatcher into one cross-venue consumer on its own
+/// thread, spinning while the rings are empty.  Its cpu is set with
+/// threads.<name>.cpu_affinity like any NamedThread.
+class ShardConsumerThread : public core::NamedThread<ShardConsumerThread> {
+public:
+    ShardConsumerThread(const std::string &name, ShardedDispatcher &sd, ShardUpdateListener &l)
+        : NamedThread(name), m_dispatcher(sd), m_listener(l) {}
+    virtual ~ShardConsumerThread() { stop(); }
+
+    /// Stop and join the thread, if it was spawned.
+    void stop() {
+        if (State::UNINITIALIZED == state()) {
+            return;
+        }
+        while (State::STARTING == state()) {
+            __builtin_ia32_pause();
+        }
+        shutdown(true);
+    }
+
+    virtual void * process() override final {
+        if (0 == m_dispatcher.poll(m_listener)) {
+            __builtin_ia32_pause();
+        }
+        return nullptr;
+    }
+
+private:
+    ShardedDispatcher &m_dispatcher;
+    ShardUpdateListener &m_listener;
+};
+
+}}
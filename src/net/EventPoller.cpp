@@ -1,7 +1,15 @@
 #include <errno.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <linux/errqueue.h>
+#include <linux/net_tstamp.h>
 
 #include <boost/lexical_cast.hpp>
 
+#include <algorithm>
+#include <cstdio>
+#include <sstream>
+
 #include <i01_core/macro.hpp>
 #include <i01_core/EventListener.hpp>
 #include <i01_core/FD.hpp>
@@ -11,6 +19,7 @@
 
 #include <i01_net/EventPoller.hpp>
 #include <i01_net/SocketListener.hpp>
+#include <i01_net/UringEventPoller.hpp>
 
 namespace i01 { namespace net {
 
@@ -38,9 +47,87 @@ std::ostream & operator<<(std::ostream &os, const EventType &s)
     return os;
 }
 
+std::ostream & operator<<(std::ostream &os, const RecvMode &m)
+{
+    switch (m) {
+    case RecvMode::RECV:
+        os << "recv";
+        break;
+    case RecvMode::RECVMMSG:
+        os << "recvmmsg";
+        break;
+    default:
+        break;
+    }
+    return os;
+}
+
+std::ostream & operator<<(std::ostream &os, const RecvTimestamping &t)
+{
+    switch (t) {
+    case RecvTimestamping::NONE:
+        os << "none";
+        break;
+    case RecvTimestamping::SOFTWARE:
+        os << "software";
+        break;
+    case RecvTimestamping::HARDWARE:
+        os << "hardware";
+        break;
+    default:
+        break;
+    }
+    return os;
+}
+
+std::ostream & operator<<(std::ostream &os, const PollMode &m)
+{
+    switch (m) {
+    case PollMode::SPIN:
+        os << "spin";
+        break;
+    case PollMode::BACKOFF:
+        os << "backoff";
+        break;
+    case PollMode::ADAPTIVE:
+        os << "adaptive";
+        break;
+    default:
+        break;
+    }
+    return os;
+}
+
+bool parse_poll_mode(const std::string& name, PollMode& mode)
+{
+    if ("spin" == name) {
+        mode = PollMode::SPIN;
+    } else if ("backoff" == name) {
+        mode = PollMode::BACKOFF;
+    } else if ("adaptive" == name) {
+        mode = PollMode::ADAPTIVE;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+std::ostream & operator<<(std::ostream &os, const PollStats &s)
+{
+    return os << "empty," << s.empty.load(std::memory_order_relaxed)
+              << ",productive," << s.productive.load(std::memory_order_relaxed)
+              << ",blocking," << s.blocking.load(std::memory_order_relaxed)
+              << ",switches," << s.switches.load(std::memory_order_relaxed)
+              << ",event_rate," << s.event_rate.load(std::memory_order_relaxed);
+}
+
 EventPoller::EventPoller()
     : m_last_event_ts{0,0}
     , m_active(false)
+    , m_timers()
+    , m_new_timers()
+    , m_new_timers_mutex()
+    , m_have_new_timers(false)
 {
     m_errcount = 0;
 }
@@ -50,6 +137,49 @@ EventPoller::~EventPoller()
 
 }
 
+bool EventPoller::add_timer( core::TimerListener& listener
+                           , EventUserData userdata
+                           , const core::Timestamp& start
+                           , const core::Timestamp& interval)
+{
+    if (core::Timestamp{} == start)
+        return false;
+    core::LockGuard<core::SpinMutex> l(m_new_timers_mutex);
+    m_new_timers.push_back(NewTimer{&listener, userdata, core::Timestamp::now() + start, interval});
+    m_have_new_timers.store(true, std::memory_order_release);
+    return true;
+}
+
+void EventPoller::run_timers_()
+{
+    if (UNLIKELY(m_have_new_timers.load(std::memory_order_acquire))) {
+        core::LockGuard<core::SpinMutex> l(m_new_timers_mutex);
+        m_have_new_timers.store(false, std::memory_order_relaxed);
+        // the wheel's clock stands still while it is empty:
+        if (m_timers.empty())
+            m_timers.reset(core::Timestamp::now());
+        for (const auto& t : m_new_timers)
+            m_timers.add(*t.listener, t.userdata, t.deadline, t.interval);
+        m_new_timers.clear();
+    }
+    if (!m_timers.empty())
+        m_timers.advance(core::Timestamp::now());
+}
+
+int EventPoller::timer_timeout_(int timeout_ms) const
+{
+    if (timeout_ms <= 0 || m_timers.empty())
+        return timeout_ms;
+    const core::Timestamp now(core::Timestamp::now());
+    const core::Timestamp due(m_timers.next_due());
+    if (due <= now)
+        return 0;
+    const core::Timestamp d(due - now);
+    // rounded down, so that the poll never wakes late:
+    const std::int64_t ms = static_cast<std::int64_t>(d.tv_sec) * 1000 + d.tv_nsec / 1000000;
+    return ms < timeout_ms ? static_cast<int>(ms) : timeout_ms;
+}
+
 void EventPoller::on_error(const core::Timestamp& t,
                            EventData *ed,
                            int errno_,
@@ -71,7 +201,21 @@ EpollEventPoller::EpollEventPoller()
     , m_change_mutex()
     , m_eps(s_evq_size, true)
     , m_listeners()
+    , m_recv_mode(RecvMode::RECV)
+    , m_recv_batch(0)
+    , m_recv_buffer_size(0)
+    , m_recv_timestamping(RecvTimestamping::NONE)
+    , m_poll_mode(PollMode::SPIN)
+    , m_effective_poll_mode(PollMode::SPIN)
+    , m_spin_count(DEFAULT_SPIN_COUNT)
+    , m_wait_ms(DEFAULT_WAIT_MS)
+    , m_spin_rate(DEFAULT_SPIN_RATE)
+    , m_busy_poll_us(0)
+    , m_empty_polls(0)
+    , m_polls_since_check(0)
+    , m_window_events(0)
 {
+    recv_mode(RecvMode::RECV, 1);
 }
 
 EpollEventPoller::EpollEventPoller(const std::string& n) : EpollEventPoller()
@@ -96,36 +240,124 @@ EpollEventPoller::~EpollEventPoller()
     }
 }
 
-bool EpollEventPoller::add_timer( core::TimerListener& listener
-                                , EventUserData userdata
-                                , const core::Timestamp& start
-                                , const core::Timestamp& interval)
+bool EpollEventPoller::recv_mode(RecvMode mode, std::uint32_t batch, std::uint32_t buffer_size)
 {
+    if (0 == buffer_size || (RecvMode::RECVMMSG == mode && 0 == batch))
+        return false;
+    if (RecvMode::RECV == mode)
+        batch = 1;
+
     lockguard_type l(m_change_mutex);
-    struct itimerspec its{
-        .it_interval = interval,
-        .it_value = start
-    };
-    EventData * ed = new EventData{
-        .type = EventType::TIMER_FD,
-        .managed = true,
-        .fd = core::FDBase(::timerfd_create(CLOCK_REALTIME, TFD_NONBLOCK | TFD_CLOEXEC)),
-        .listener = { .timer = &listener },
-        .userdata = userdata
-    };
-    if (ed && ed->fd.valid()) {
-        ::timerfd_settime(ed->fd.fd(), 0, &its, nullptr);
-        if (m_eps.add(ed->fd.fd(),
-                    reinterpret_cast<std::uint64_t>(ed),
-                    EPOLLIN | EPOLLET)) {
-            m_listeners.push_back(ed);
-            return true;
+    m_recv_mode = mode;
+    m_recv_batch = batch;
+    m_recv_buffer_size = buffer_size;
+    m_recv_buffers.assign(static_cast<std::size_t>(batch) * buffer_size, 0);
+    m_recv_iovecs.resize(batch);
+    m_recv_msgs.resize(batch);
+    m_recv_descs.resize(batch);
+    m_recv_control.assign(static_cast<std::size_t>(batch) * s_recv_control_size, 0);
+    for (std::uint32_t i = 0; i < batch; ++i) {
+        m_recv_iovecs[i].iov_base = &m_recv_buffers[static_cast<std::size_t>(i) * buffer_size];
+        m_recv_iovecs[i].iov_len = buffer_size;
+        ::memset(&m_recv_msgs[i], 0, sizeof(m_recv_msgs[i]));
+        m_recv_msgs[i].msg_hdr.msg_iov = &m_recv_iovecs[i];
+        m_recv_msgs[i].msg_hdr.msg_iovlen = 1;
+        m_recv_msgs[i].msg_hdr.msg_control = &m_recv_control[static_cast<std::size_t>(i) * s_recv_control_size];
+        m_recv_msgs[i].msg_hdr.msg_controllen = s_recv_control_size;
+    }
+    return true;
+}
+
+bool EpollEventPoller::configure(const core::Config::storage_type& cfg)
+{
+    const auto mode_name = cfg.get_or_default<std::string>("recv_mode", "recv");
+    RecvMode mode = RecvMode::RECV;
+    if ("recvmmsg" == mode_name) {
+        mode = RecvMode::RECVMMSG;
+    } else if ("recv" != mode_name) {
+        std::cerr << "EpollEventPoller: " << name() << ": unknown recv_mode " << mode_name << std::endl;
+        return false;
+    }
+    if (!recv_mode(mode,
+                   cfg.get_or_default<std::uint32_t>("recv_batch", DEFAULT_RECV_BATCH),
+                   cfg.get_or_default<std::uint32_t>("recv_buffer_size", DEFAULT_RECV_BUFFER_SIZE))) {
+        std::cerr << "EpollEventPoller: " << name() << ": bad recv_batch or recv_buffer_size" << std::endl;
+        return false;
+    }
+    PollMode pm = PollMode::SPIN;
+    const auto pm_name = cfg.get_or_default<std::string>("poll_mode", "spin");
+    if (!parse_poll_mode(pm_name, pm)) {
+        std::cerr << "EpollEventPoller: " << name() << ": unknown poll_mode " << pm_name << std::endl;
+        return false;
+    }
+    if (!poll_mode(pm,
+                   cfg.get_or_default<std::uint32_t>("spin_count", DEFAULT_SPIN_COUNT),
+                   cfg.get_or_default<int>("wait_ms", DEFAULT_WAIT_MS))) {
+        std::cerr << "EpollEventPoller: " << name() << ": bad wait_ms" << std::endl;
+        return false;
+    }
+    spin_rate(cfg.get_or_default<std::uint64_t>("spin_rate", DEFAULT_SPIN_RATE));
+    busy_poll_us(cfg.get_or_default<int>("busy_poll_us", 0));
+
+    // poll_schedule = { { at = "HH:MM[:SS]", mode = "..." }, ... }
+    clear_poll_schedule();
+    auto sched(cfg.copy_prefix_domain("poll_schedule."));
+    for (const auto& k : sched->get_key_prefix_set()) {
+        std::string at, mode_name;
+        unsigned h = 0, m = 0, sec = 0;
+        PollMode mode;
+        if (!sched->get(k + ".at", at) || !sched->get(k + ".mode", mode_name)
+            || std::sscanf(at.c_str(), "%u:%u:%u", &h, &m, &sec) < 2
+            || h > 23 || m > 59 || sec > 59
+            || !parse_poll_mode(mode_name, mode)) {
+            std::cerr << "EpollEventPoller: " << name() << ": bad poll_schedule entry " << k << std::endl;
+            return false;
         }
+        add_poll_schedule(h * 3600 + m * 60 + sec, mode);
     }
-    delete ed;
-    return false;
+
+    const auto ts_name = cfg.get_or_default<std::string>("timestamping", "none");
+    if ("none" == ts_name) {
+        recv_timestamping(RecvTimestamping::NONE);
+    } else if ("software" == ts_name) {
+        recv_timestamping(RecvTimestamping::SOFTWARE);
+    } else if ("hardware" == ts_name) {
+        recv_timestamping(RecvTimestamping::HARDWARE);
+    } else {
+        std::cerr << "EpollEventPoller: " << name() << ": unknown timestamping " << ts_name << std::endl;
+        return false;
+    }
+    return true;
 }
 
+EpollEventPoller * EpollEventPoller::create_and_config(const std::string& name, const core::Config::storage_type& cfg)
+{
+    auto * p = new EpollEventPoller(name);
+    if (!p->configure(cfg)) {
+        delete p;
+        return nullptr;
+    }
+    return p;
+}
+
+EventPoller * create_event_poller(const std::string& name, const core::Config::storage_type& cfg)
+{
+    const auto backend = cfg.get_or_default<std::string>("backend", "epoll");
+    EventPoller *p = nullptr;
+    if ("epoll" == backend) {
+        p = new EpollEventPoller(name);
+    } else if ("io_uring" == backend) {
+        p = new UringEventPoller(name);
+    } else {
+        std::cerr << "create_event_poller: " << name << ": unknown backend " << backend << std::endl;
+        return nullptr;
+    }
+    if (!p->configure(cfg)) {
+        delete p;
+        return nullptr;
+    }
+    return p;
+}
 
 bool EpollEventPoller::add_socket( SocketListener& listener
                                  , EventUserData userdata
@@ -141,7 +373,18 @@ bool EpollEventPoller::add_socket( SocketListener& listener
     };
 
     if (ed && ed->fd.valid()) {
+        int so_type = 0;
+        socklen_t so_type_len = sizeof(so_type);
+        ed->datagram = 0 == ::getsockopt(fd, SOL_SOCKET, SO_TYPE, &so_type, &so_type_len)
+                    && SOCK_DGRAM == so_type;
         ed->fd.fcntl(F_SETFL, O_NONBLOCK);
+        if (m_busy_poll_us > 0
+            && 0 != ::setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, &m_busy_poll_us, sizeof(m_busy_poll_us))) {
+            std::cerr << "EpollEventPoller: " << name() << ": could not set SO_BUSY_POLL on fd " << fd << ": " << ::strerror(errno) << std::endl;
+        }
+        if (RecvTimestamping::NONE != m_recv_timestamping && !enable_timestamping_(ed)) {
+            std::cerr << "EpollEventPoller: " << name() << ": could not set SO_TIMESTAMPING on fd " << fd << ": " << ::strerror(errno) << std::endl;
+        }
         if (m_eps.add(ed->fd.fd(),
                     reinterpret_cast<std::uint64_t>(ed),
                     EPOLLIN | EPOLLRDHUP)) {
@@ -153,11 +396,144 @@ bool EpollEventPoller::add_socket( SocketListener& listener
     return false;
 }
 
-bool EpollEventPoller::run()
+bool EpollEventPoller::enable_timestamping_(EventData *e)
+{
+    int flags = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+    if (RecvTimestamping::HARDWARE == m_recv_timestamping)
+        flags |= SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE;
+    e->timestamping = 0 == ::setsockopt(e->fd.fd(), SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags));
+    return e->timestamping;
+}
+
+void EpollEventPoller::parse_timestamps_(const ::msghdr& hdr, core::Timestamp& kernel_ts, core::Timestamp& hw_ts)
+{
+    kernel_ts = core::Timestamp();
+    hw_ts = core::Timestamp();
+    for (auto *c = CMSG_FIRSTHDR(&hdr); c; c = CMSG_NXTHDR(const_cast< ::msghdr *>(&hdr), c)) {
+        if (SOL_SOCKET == c->cmsg_level && SCM_TIMESTAMPING == c->cmsg_type) {
+            const auto *t = reinterpret_cast<const ::scm_timestamping *>(CMSG_DATA(c));
+            // ts[0] is the software timestamp, ts[2] the raw hardware one:
+            kernel_ts = core::Timestamp(t->ts[0].tv_sec, t->ts[0].tv_nsec);
+            hw_ts = core::Timestamp(t->ts[2].tv_sec, t->ts[2].tv_nsec);
+            return;
+        }
+    }
+}
+
+bool EpollEventPoller::recv_latency(EventUserData userdata, RecvLatencyHistogram& out)
 {
-    int n = m_eps.wait(0);
-    if (UNLIKELY(n < 0))
+    lockguard_type l(m_change_mutex);
+    bool found = false;
+    for (const auto *ed : m_listeners) {
+        if (ed && EventType::SOCKET_FD == ed->type && userdata == ed->userdata && ed->timestamping) {
+            out.merge(ed->recv_latency);
+            found = true;
+        }
+    }
+    return found;
+}
+
+bool EpollEventPoller::poll_mode(PollMode mode, std::uint32_t spin_count, int wait_ms)
+{
+    if (wait_ms <= 0)
         return false;
+    m_poll_mode = mode;
+    m_spin_count = spin_count;
+    m_wait_ms = wait_ms;
+    m_effective_poll_mode = PollMode::ADAPTIVE == mode ? PollMode::BACKOFF : mode;
+    m_empty_polls = 0;
+    return true;
+}
+
+void EpollEventPoller::add_poll_schedule(std::uint32_t seconds_since_midnight, PollMode mode)
+{
+    auto entry = std::make_pair(seconds_since_midnight, mode);
+    auto it = std::upper_bound(m_poll_schedule.begin(), m_poll_schedule.end(), entry,
+            [](const std::pair<std::uint32_t, PollMode>& a, const std::pair<std::uint32_t, PollMode>& b) { return a.first < b.first; });
+    m_poll_schedule.insert(it, entry);
+}
+
+PollMode EpollEventPoller::scheduled_poll_mode(const core::Timestamp& ts) const
+{
+    if (m_poll_schedule.empty())
+        return m_poll_mode;
+    struct tm lt;
+    time_t t = ts.tv_sec;
+    ::localtime_r(&t, &lt);
+    const std::uint32_t sec = static_cast<std::uint32_t>(lt.tm_hour * 3600 + lt.tm_min * 60 + lt.tm_sec);
+    // the last entry at or before sec, or yesterday's last entry:
+    auto it = std::upper_bound(m_poll_schedule.begin(), m_poll_schedule.end(), sec,
+            [](std::uint32_t s, const std::pair<std::uint32_t, PollMode>& e) { return s < e.first; });
+    return (it == m_poll_schedule.begin() ? m_poll_schedule.back() : *(it - 1)).second;
+}
+
+void EpollEventPoller::update_poll_mode_(const core::Timestamp& now)
+{
+    m_poll_mode = scheduled_poll_mode(now);
+    PollMode effective = m_poll_mode;
+    if (PollMode::ADAPTIVE == m_poll_mode) {
+        effective = m_poll_stats.event_rate.load(std::memory_order_relaxed) >= m_spin_rate
+                  ? PollMode::SPIN : PollMode::BACKOFF;
+    }
+    if (effective != m_effective_poll_mode) {
+        m_effective_poll_mode = effective;
+        PollStats::increment(m_poll_stats.switches);
+    }
+}
+
+int EpollEventPoller::poll_timeout_()
+{
+    if (UNLIKELY(++m_polls_since_check >= s_poll_check_interval
+                 || (m_empty_polls == m_spin_count && PollMode::SPIN != m_effective_poll_mode))) {
+        m_polls_since_check = 0;
+        const core::Timestamp now(core::Timestamp::now());
+        const core::Timestamp elapsed(now - m_window_start);
+        if (elapsed.tv_sec >= 1) {
+            const std::uint64_t ns = static_cast<std::uint64_t>(elapsed.tv_sec) * 1000000000ULL + static_cast<std::uint64_t>(elapsed.tv_nsec);
+            m_poll_stats.event_rate.store(m_window_events * 1000000000ULL / ns, std::memory_order_relaxed);
+            m_window_events = 0;
+            m_window_start = now;
+            update_poll_mode_(now);
+        }
+    }
+    if (PollMode::SPIN == m_effective_poll_mode || m_empty_polls < m_spin_count)
+        return 0;
+    return m_wait_ms;
+}
+
+std::string EpollEventPoller::status() const
+{
+    std::ostringstream ss;
+    ss << name() << ","
+       << "poll_mode," << m_poll_mode << ","
+       << "effective," << m_effective_poll_mode << ","
+       << m_poll_stats << ","
+       << "errors," << m_errcount;
+    return ss.str();
+}
+
+bool EpollEventPoller::run()
+{
+    run_timers_();
+    const int timeout = timer_timeout_(poll_timeout_());
+    int n = m_eps.wait(timeout);
+    if (UNLIKELY(n < 0)) {
+        // e.g. task work from an io_uring closed on this thread:
+        if (EINTR != errno)
+            return false;
+        n = 0;
+    }
+    if (timeout)
+        PollStats::increment(m_poll_stats.blocking);
+    if (n == 0) {
+        PollStats::increment(m_poll_stats.empty);
+        if (m_empty_polls < m_spin_count)
+            ++m_empty_polls;
+        return true;
+    }
+    PollStats::increment(m_poll_stats.productive);
+    m_empty_polls = 0;
+    m_window_events += static_cast<std::uint64_t>(n);
     for (auto it = m_eps.begin(); it != m_eps.end(); ++it) {
         EventData * e = reinterpret_cast<EventData*>(it->data.ptr);
         e->last_event_ts = core::Timestamp::now();
@@ -178,39 +554,12 @@ bool EpollEventPoller::run()
                 on_error(e->last_event_ts, e, errno, "eventfd read failed");
             }
         } break;
-        case EventType::TIMER_FD: {
-            std::uint64_t val = 0;
-            if (sizeof(val) == e->fd.read(&val, sizeof(val))) {
-                e->listener.timer->on_timer(e->last_event_ts, e->userdata, val);
-            } else {
-                on_error(e->last_event_ts, e, errno, "timerfd read failed");
-            }
-        } break;
         case EventType::SOCKET_FD: {
             if (it->events & EPOLLIN) {
-                char buf[2048]{0}; // TODO: pool allocated, zero copy
-                ssize_t m = ::recv(e->fd.fd(), buf, 2048, 0); // TODO
-                if (LIKELY(m > 0)) {
-#ifdef _DEBUG
-                    if (m >= (ssize_t)sizeof(buf)) {
-                        std::cerr << "EventPoller: read buf bytes in callback " << m << std::endl;
-                    }
-#endif
-                    e->listener.socket->on_recv(e->last_event_ts, e->userdata, (std::uint8_t *)buf, m); // TODO
-                } else if (m == 0) {
-                    e->listener.socket->on_peer_disconnect(e->last_event_ts, e->userdata);
-                    // TODO: remove from epollset, close fd if managed,
-                    // delete eventdata, remove listener...
-                    {
-                        lockguard_type l(m_change_mutex);
-                        m_eps.remove(e->fd.fd());
-                        auto it2 = std::find(m_listeners.begin(), m_listeners.end(), e);
-                        if (it2 != m_listeners.end())
-                            *it2 = nullptr;
-                    }
-                } else {
-                    on_error(e->last_event_ts, e, errno, "socketfd read failed");
-                }
+                if (RecvMode::RECVMMSG == m_recv_mode && e->datagram)
+                    recv_batch_(e);
+                else
+                    recv_(e);
             }
         } break;
         case EventType::UNKNOWN:
@@ -222,6 +571,91 @@ bool EpollEventPoller::run()
     return true;
 }
 
+void EpollEventPoller::recv_(EventData *e)
+{
+    std::uint8_t *buf = m_recv_buffers.data();
+    ssize_t m;
+    core::Timestamp kernel_ts, hw_ts;
+    if (e->timestamping) {
+        ::msghdr& hdr = m_recv_msgs[0].msg_hdr;
+        hdr.msg_controllen = s_recv_control_size;
+        m = ::recvmsg(e->fd.fd(), &hdr, 0);
+        if (LIKELY(m > 0)) {
+            e->last_event_ts = core::Timestamp::now();
+            parse_timestamps_(hdr, kernel_ts, hw_ts);
+            if (kernel_ts.tv_sec)
+                e->recv_latency.add(kernel_ts, e->last_event_ts);
+        }
+    } else {
+        m = ::recv(e->fd.fd(), buf, m_recv_buffer_size, 0);
+    }
+    if (LIKELY(m > 0)) {
+        if (e->timestamping)
+            e->listener.socket->on_recv_timestamped(e->last_event_ts, e->userdata, buf, m, kernel_ts, hw_ts);
+        else
+            e->listener.socket->on_recv(e->last_event_ts, e->userdata, buf, m);
+    } else if (m == 0) {
+        on_disconnect_(e);
+    } else {
+        on_error(e->last_event_ts, e, errno, "socketfd read failed");
+    }
+}
+
+void EpollEventPoller::recv_batch_(EventData *e)
+{
+    // drain the socket, a batch at a time; a short batch means it is empty
+    for (std::uint32_t b = 0; b < s_max_batches_per_event; ++b) {
+        if (e->timestamping) {
+            // the kernel shrinks msg_controllen to what it used:
+            for (std::uint32_t i = 0; i < m_recv_batch; ++i)
+                m_recv_msgs[i].msg_hdr.msg_controllen = s_recv_control_size;
+        }
+        int m = ::recvmmsg(e->fd.fd(), m_recv_msgs.data(), m_recv_batch, MSG_DONTWAIT, nullptr);
+        if (UNLIKELY(m <= 0)) {
+            if (m < 0 && EAGAIN != errno && EWOULDBLOCK != errno)
+                on_error(e->last_event_ts, e, errno, "socketfd recvmmsg failed");
+            return;
+        }
+        // every batch after the first was dequeued later than the event:
+        if (e->timestamping || b > 0)
+            e->last_event_ts = core::Timestamp::now();
+        for (int i = 0; i < m; ++i) {
+            const auto & hdr = m_recv_msgs[i];
+            if (UNLIKELY(hdr.msg_hdr.msg_flags & MSG_TRUNC))
+                on_error(e->last_event_ts, e, EMSGSIZE, "datagram truncated");
+            RecvDescriptor& d = m_recv_descs[i];
+            d.buf = static_cast<const std::uint8_t *>(m_recv_iovecs[i].iov_base);
+            d.len = static_cast<ssize_t>(hdr.msg_len);
+            d.ts = e->last_event_ts;
+            if (e->timestamping) {
+                parse_timestamps_(hdr.msg_hdr, d.kernel_ts, d.hw_ts);
+                if (d.kernel_ts.tv_sec)
+                    e->recv_latency.add(d.kernel_ts, d.ts);
+            } else {
+                d.kernel_ts = core::Timestamp();
+                d.hw_ts = core::Timestamp();
+            }
+        }
+        e->listener.socket->on_recv_batch(e->last_event_ts, e->userdata, m_recv_descs.data(), static_cast<std::size_t>(m));
+        if (static_cast<std::uint32_t>(m) < m_recv_batch)
+            return;
+    }
+}
+
+void EpollEventPoller::on_disconnect_(EventData *e)
+{
+    e->listener.socket->on_peer_disconnect(e->last_event_ts, e->userdata);
+    // TODO: remove from epollset, close fd if managed,
+    // delete eventdata, remove listener...
+    {
+        lockguard_type l(m_change_mutex);
+        m_eps.remove(e->fd.fd());
+        auto it2 = std::find(m_listeners.begin(), m_listeners.end(), e);
+        if (it2 != m_listeners.end())
+            *it2 = nullptr;
+    }
+}
+
 void* EpollEventPoller::process()
 {
     if (!run()) {
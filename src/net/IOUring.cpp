@@ -0,0 +1,205 @@
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#include <i01_net/IOUring.hpp>
+
+namespace i01 { namespace net {
+
+namespace {
+
+int io_uring_setup(std::uint32_t entries, ::io_uring_params *p)
+{
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, p));
+}
+
+int io_uring_enter(int fd, std::uint32_t to_submit, std::uint32_t min_complete, std::uint32_t flags)
+{
+    return static_cast<int>(::syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+int io_uring_register(int fd, unsigned opcode, void *arg, unsigned nr_args)
+{
+    return static_cast<int>(::syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+}
+
+void * map(int fd, std::size_t size, std::uint64_t offset)
+{
+    void *p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, static_cast<off_t>(offset));
+    return p == MAP_FAILED ? nullptr : p;
+}
+
+template <typename T>
+T * at(void *base, std::uint32_t offset)
+{
+    return reinterpret_cast<T *>(static_cast<char *>(base) + offset);
+}
+
+}
+
+IOUring::IOUring(std::uint32_t entries, std::uint32_t cq_entries, std::uint32_t flags)
+    : m_fd(-1)
+    , m_flags(0)
+    , m_sq_ring(nullptr)
+    , m_sq_ring_size(0)
+    , m_cq_ring(nullptr)
+    , m_cq_ring_size(0)
+    , m_sqes(nullptr)
+    , m_sqes_size(0)
+    , m_sqe_tail(0)
+    , m_sqe_head(0)
+    , m_bgid(0)
+    , m_buf_ring(nullptr)
+    , m_buf_ring_size(0)
+    , m_buf_mask(0)
+    , m_buf_tail(0)
+    , m_buffers(nullptr)
+    , m_buffers_size(0)
+    , m_buffer_size(0)
+{
+    ::io_uring_params p;
+    for (std::uint32_t f : {flags, 0U}) {
+        ::memset(&p, 0, sizeof(p));
+        p.flags = f | IORING_SETUP_CQSIZE;
+        p.cq_entries = std::max(cq_entries, entries);
+        m_fd = io_uring_setup(entries, &p);
+        if (m_fd >= 0 || EINVAL != errno || 0 == f) {
+            m_flags = f;
+            break;
+        }
+    }
+    if (m_fd < 0) {
+        throw std::runtime_error(
+            std::string(__PRETTY_FUNCTION__)
+          + " io_uring_setup failed: " + strerror(errno));
+    }
+
+    m_sq_ring_size = p.sq_off.array + p.sq_entries * sizeof(std::uint32_t);
+    m_cq_ring_size = p.cq_off.cqes + p.cq_entries * sizeof(::io_uring_cqe);
+    if (p.features & IORING_FEAT_SINGLE_MMAP)
+        m_sq_ring_size = m_cq_ring_size = std::max(m_sq_ring_size, m_cq_ring_size);
+    m_sq_ring = map(m_fd, m_sq_ring_size, IORING_OFF_SQ_RING);
+    m_cq_ring = (p.features & IORING_FEAT_SINGLE_MMAP) ? m_sq_ring : map(m_fd, m_cq_ring_size, IORING_OFF_CQ_RING);
+    m_sqes_size = p.sq_entries * sizeof(::io_uring_sqe);
+    m_sqes = static_cast< ::io_uring_sqe *>(map(m_fd, m_sqes_size, IORING_OFF_SQES));
+    if (!m_sq_ring || !m_cq_ring || !m_sqes) {
+        int err = errno;
+        release_();
+        throw std::runtime_error(
+            std::string(__PRETTY_FUNCTION__)
+          + " mmap failed: " + strerror(err));
+    }
+
+    m_sq_head = at<std::uint32_t>(m_sq_ring, p.sq_off.head);
+    m_sq_tail = at<std::uint32_t>(m_sq_ring, p.sq_off.tail);
+    m_sq_mask = *at<std::uint32_t>(m_sq_ring, p.sq_off.ring_mask);
+    m_sq_entries = *at<std::uint32_t>(m_sq_ring, p.sq_off.ring_entries);
+    m_cq_head = at<std::uint32_t>(m_cq_ring, p.cq_off.head);
+    m_cq_tail = at<std::uint32_t>(m_cq_ring, p.cq_off.tail);
+    m_cq_mask = *at<std::uint32_t>(m_cq_ring, p.cq_off.ring_mask);
+    m_cqes = at< ::io_uring_cqe>(m_cq_ring, p.cq_off.cqes);
+    // SQEs are submitted in order, so the index array is the identity:
+    std::uint32_t *array = at<std::uint32_t>(m_sq_ring, p.sq_off.array);
+    for (std::uint32_t i = 0; i < m_sq_entries; ++i)
+        array[i] = i;
+    m_sqe_tail = m_sqe_head = *m_sq_tail;
+}
+
+IOUring::~IOUring()
+{
+    release_();
+}
+
+void IOUring::release_()
+{
+    if (m_buf_ring) {
+        ::io_uring_buf_reg reg;
+        ::memset(&reg, 0, sizeof(reg));
+        reg.bgid = m_bgid;
+        io_uring_register(m_fd, IORING_UNREGISTER_PBUF_RING, &reg, 1);
+        ::munmap(m_buf_ring, m_buf_ring_size);
+        m_buf_ring = nullptr;
+    }
+    if (m_buffers) {
+        ::munmap(m_buffers, m_buffers_size);
+        m_buffers = nullptr;
+    }
+    if (m_sqes) {
+        ::munmap(m_sqes, m_sqes_size);
+        m_sqes = nullptr;
+    }
+    if (m_cq_ring && m_cq_ring != m_sq_ring)
+        ::munmap(m_cq_ring, m_cq_ring_size);
+    m_cq_ring = nullptr;
+    if (m_sq_ring) {
+        ::munmap(m_sq_ring, m_sq_ring_size);
+        m_sq_ring = nullptr;
+    }
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+}
+
+int IOUring::submit(std::uint32_t min_complete, bool get_events)
+{
+    const std::uint32_t to_submit = m_sqe_tail - m_sqe_head;
+    if (to_submit)
+        __atomic_store_n(m_sq_tail, m_sqe_tail, __ATOMIC_RELEASE);
+    if (0 == to_submit && !get_events)
+        return 0;
+    int ret = io_uring_enter(m_fd, to_submit, min_complete, get_events ? IORING_ENTER_GETEVENTS : 0);
+    if (ret < 0)
+        return -errno;
+    m_sqe_head += static_cast<std::uint32_t>(ret);
+    return ret;
+}
+
+bool IOUring::register_buffers(std::uint16_t bgid, std::uint16_t count, std::uint32_t size)
+{
+    if (m_buf_ring || 0 == count || (count & (count - 1)) || 0 == size)
+        return false;
+    m_buf_ring_size = count * sizeof(::io_uring_buf);
+    m_buffers_size = static_cast<std::size_t>(count) * size;
+    void *ring = ::mmap(nullptr, m_buf_ring_size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE | MAP_POPULATE, -1, 0);
+    void *bufs = ::mmap(nullptr, m_buffers_size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE | MAP_POPULATE, -1, 0);
+    if (MAP_FAILED == ring || MAP_FAILED == bufs) {
+        if (MAP_FAILED != ring)
+            ::munmap(ring, m_buf_ring_size);
+        if (MAP_FAILED != bufs)
+            ::munmap(bufs, m_buffers_size);
+        return false;
+    }
+
+    ::io_uring_buf_reg reg;
+    ::memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = reinterpret_cast<std::uint64_t>(ring);
+    reg.ring_entries = count;
+    reg.bgid = bgid;
+    if (0 != io_uring_register(m_fd, IORING_REGISTER_PBUF_RING, &reg, 1)) {
+        int err = errno;
+        ::munmap(ring, m_buf_ring_size);
+        ::munmap(bufs, m_buffers_size);
+        errno = err;
+        return false;
+    }
+
+    m_bgid = bgid;
+    m_buf_ring = static_cast< ::io_uring_buf_ring *>(ring);
+    m_buf_mask = static_cast<std::uint16_t>(count - 1);
+    m_buf_tail = 0;
+    m_buffers = static_cast<std::uint8_t *>(bufs);
+    m_buffer_size = size;
+    for (std::uint16_t i = 0; i < count; ++i)
+        recycle_buffer(i);
+    commit_buffers();
+    return true;
+}
+
+}}
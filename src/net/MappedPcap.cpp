@@ -0,0 +1,111 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <stdexcept>
+
+#include <pcap.h>
+
+#include <i01_core/macro.hpp>
+
+#include <i01_net/MappedPcap.hpp>
+
+namespace i01 { namespace net { namespace pcap {
+
+namespace {
+
+const std::uint32_t MAGIC_USEC = 0xa1b2c3d4;
+const std::uint32_t MAGIC_NSEC = 0xa1b23c4d;
+
+/// The on-disk record header; struct pcap_pkthdr has a struct timeval,
+/// which is bigger on 64-bit hosts.
+struct RecordHeader {
+    std::uint32_t ts_sec;
+    std::uint32_t ts_frac;
+    std::uint32_t caplen;
+    std::uint32_t len;
+};
+
+}
+
+MappedReader::MappedReader(const std::string& filename)
+    : m_filename(filename)
+    , m_data(nullptr)
+    , m_size(0)
+    , m_pos(sizeof(struct pcap_file_header))
+    , m_nanosecond(false)
+    , m_bytes_read(0)
+{
+    int fd = ::open(m_filename.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error("MappedReader: could not open " + m_filename + ": " + ::strerror(errno));
+    }
+    struct stat st;
+    if (0 != ::fstat(fd, &st)) {
+        int err = errno;
+        ::close(fd);
+        throw std::runtime_error("MappedReader: could not stat " + m_filename + ": " + ::strerror(err));
+    }
+    m_size = static_cast<std::size_t>(st.st_size);
+    if (m_size < sizeof(struct pcap_file_header)) {
+        ::close(fd);
+        throw std::runtime_error("MappedReader: " + m_filename + " is not a pcap capture");
+    }
+    void *p = ::mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    int err = errno;
+    ::close(fd);
+    if (MAP_FAILED == p) {
+        throw std::runtime_error("MappedReader: could not map " + m_filename + ": " + ::strerror(err));
+    }
+    m_data = static_cast<std::uint8_t *>(p);
+    ::madvise(m_data, m_size, MADV_SEQUENTIAL);
+
+    std::uint32_t magic;
+    std::memcpy(&magic, m_data, sizeof(magic));
+    if (MAGIC_USEC != magic && MAGIC_NSEC != magic) {
+        ::munmap(m_data, m_size);
+        throw std::runtime_error("MappedReader: " + m_filename + " is not an uncompressed pcap capture in host byte order");
+    }
+    m_nanosecond = MAGIC_NSEC == magic;
+}
+
+MappedReader::~MappedReader()
+{
+    ::munmap(m_data, m_size);
+}
+
+bool MappedReader::next(MappedRecord& rec)
+{
+    if (UNLIKELY(m_pos + sizeof(RecordHeader) > m_size)) {
+        return false;
+    }
+    RecordHeader hdr;
+    std::memcpy(&hdr, m_data + m_pos, sizeof(hdr));
+    const std::size_t end = m_pos + sizeof(RecordHeader) + hdr.caplen;
+    if (UNLIKELY(end > m_size)) {
+        return false;
+    }
+    rec.data = m_data + m_pos + sizeof(RecordHeader);
+    rec.caplen = hdr.caplen;
+    rec.len = hdr.len;
+    rec.ts = core::Timestamp{static_cast<time_t>(hdr.ts_sec),
+                             static_cast<long>(m_nanosecond ? hdr.ts_frac : hdr.ts_frac * 1000)};
+    m_bytes_read += end - m_pos;
+    m_pos = end;
+    return true;
+}
+
+bool MappedReader::seek(std::uint64_t offset)
+{
+    if (offset < sizeof(struct pcap_file_header) || offset > m_size) {
+        return false;
+    }
+    m_pos = static_cast<std::size_t>(offset);
+    return true;
+}
+
+} } }
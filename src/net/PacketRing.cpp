@@ -0,0 +1,278 @@
+#include <errno.h>
+#include <net/if.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <linux/filter.h>
+#include <linux/if_ether.h>
+
+#include <iostream>
+#include <stdexcept>
+
+#include <i01_core/macro.hpp>
+
+#include <i01_net/PacketRing.hpp>
+
+#ifndef PACKET_IGNORE_OUTGOING
+#define PACKET_IGNORE_OUTGOING 23
+#endif
+
+namespace i01 { namespace net {
+
+std::ostream & operator<<(std::ostream &os, const PacketRingStats &s)
+{
+    return os << "packets," << s.packets
+              << ",drops," << s.drops
+              << ",freezes," << s.freezes;
+}
+
+PacketRing::PacketRing( const std::string& interface
+                      , std::uint32_t block_size
+                      , std::uint32_t block_count
+                      , std::uint32_t block_timeout_ms)
+    : m_interface(interface)
+    , m_fd(-1)
+    , m_ring(nullptr)
+    , m_ring_size(0)
+    , m_block_size(block_size)
+    , m_block_count(block_count)
+    , m_next_block(0)
+    , m_ts{0,0}
+    , m_pkt_len(0)
+    , m_blocks_read(0)
+    , m_bytes_read(0)
+    , m_stats{0,0,0}
+{
+    unsigned int ifindex = 0;
+    if (!m_interface.empty() && "any" != m_interface) {
+        ifindex = ::if_nametoindex(m_interface.c_str());
+        if (0 == ifindex) {
+            throw std::runtime_error("PacketRing: unknown interface " + m_interface);
+        }
+    }
+
+    // no protocol until the ring is set up, so nothing is queued before
+    // it exists:
+    m_fd = ::socket(AF_PACKET, SOCK_RAW | SOCK_CLOEXEC, 0);
+    if (m_fd < 0) {
+        throw std::runtime_error(std::string("PacketRing: socket failed: ") + ::strerror(errno));
+    }
+
+    int version = TPACKET_V3;
+    ::tpacket_req3 req;
+    ::memset(&req, 0, sizeof(req));
+    req.tp_block_size = m_block_size;
+    req.tp_block_nr = m_block_count;
+    req.tp_frame_size = TPACKET_ALIGNMENT << 7;
+    req.tp_frame_nr = (m_block_size / req.tp_frame_size) * m_block_count;
+    req.tp_retire_blk_tov = block_timeout_ms;
+    if (0 != ::setsockopt(m_fd, SOL_PACKET, PACKET_VERSION, &version, sizeof(version))
+     || 0 != ::setsockopt(m_fd, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req))) {
+        int err = errno;
+        release_();
+        throw std::runtime_error(std::string("PacketRing: could not set up a TPACKET_V3 ring: ") + ::strerror(err));
+    }
+
+    m_ring_size = static_cast<std::size_t>(m_block_size) * m_block_count;
+    void *ring = ::mmap(nullptr, m_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, 0);
+    if (MAP_FAILED == ring) {
+        int err = errno;
+        release_();
+        throw std::runtime_error(std::string("PacketRing: mmap failed: ") + ::strerror(err));
+    }
+    m_ring = static_cast<std::uint8_t *>(ring);
+
+    ::sockaddr_ll sll;
+    ::memset(&sll, 0, sizeof(sll));
+    sll.sll_family = AF_PACKET;
+    sll.sll_protocol = htons(ETH_P_ALL);
+    sll.sll_ifindex = static_cast<int>(ifindex);
+    if (0 != ::bind(m_fd, reinterpret_cast<sockaddr *>(&sll), sizeof(sll))) {
+        int err = errno;
+        release_();
+        throw std::runtime_error("PacketRing: bind to " + m_interface + " failed: " + ::strerror(err));
+    }
+}
+
+PacketRing::~PacketRing()
+{
+    release_();
+}
+
+void PacketRing::release_()
+{
+    if (m_ring) {
+        ::munmap(m_ring, m_ring_size);
+        m_ring = nullptr;
+    }
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+}
+
+bool PacketRing::set_filter(const std::string& expr)
+{
+    ::pcap_t *p = ::pcap_open_dead(DLT_EN10MB, 65535);
+    if (!p) {
+        return false;
+    }
+    struct bpf_program prog;
+    if (0 != ::pcap_compile(p, &prog, expr.c_str(), 1, PCAP_NETMASK_UNKNOWN)) {
+        std::cerr << "PacketRing: " << m_interface << ": bad filter \"" << expr << "\": " << ::pcap_geterr(p) << std::endl;
+        ::pcap_close(p);
+        return false;
+    }
+    ::sock_fprog fprog;
+    fprog.len = static_cast<unsigned short>(prog.bf_len);
+    fprog.filter = reinterpret_cast< ::sock_filter *>(prog.bf_insns);
+    const bool ok = 0 == ::setsockopt(m_fd, SOL_SOCKET, SO_ATTACH_FILTER, &fprog, sizeof(fprog));
+    if (!ok) {
+        std::cerr << "PacketRing: " << m_interface << ": SO_ATTACH_FILTER failed: " << ::strerror(errno) << std::endl;
+    }
+    ::pcap_freecode(&prog);
+    ::pcap_close(p);
+    return ok;
+}
+
+bool PacketRing::set_fanout(std::uint16_t group, std::uint16_t mode)
+{
+    int arg = group | (mode << 16);
+    return 0 == ::setsockopt(m_fd, SOL_PACKET, PACKET_FANOUT, &arg, sizeof(arg));
+}
+
+bool PacketRing::set_ignore_outgoing(bool ignore)
+{
+    int arg = ignore ? 1 : 0;
+    return 0 == ::setsockopt(m_fd, SOL_PACKET, PACKET_IGNORE_OUTGOING, &arg, sizeof(arg));
+}
+
+int PacketRing::read_blocks(int timeout_ms, int limit)
+{
+    int count = 0;
+    int blocks = 0;
+    while (limit < 0 || blocks < limit) {
+        auto *block = reinterpret_cast< ::tpacket_block_desc *>(m_ring + static_cast<std::size_t>(m_next_block) * m_block_size);
+        if (!(__atomic_load_n(&block->hdr.bh1.block_status, __ATOMIC_ACQUIRE) & TP_STATUS_USER)) {
+            if (blocks > 0 || 0 == timeout_ms) {
+                break;
+            }
+            ::pollfd pfd{m_fd, POLLIN | POLLERR, 0};
+            int ret = ::poll(&pfd, 1, timeout_ms);
+            if (ret < 0 && EINTR != errno) {
+                return -1;
+            }
+            // wait once only:
+            timeout_ms = 0;
+            continue;
+        }
+        count += static_cast<int>(block->hdr.bh1.num_pkts);
+        read_block_(block);
+        ++blocks;
+        if (++m_next_block == m_block_count) {
+            m_next_block = 0;
+        }
+    }
+    return count;
+}
+
+void PacketRing::read_block_(::tpacket_block_desc *block)
+{
+    auto& bh = block->hdr.bh1;
+    handle_block_(bh.num_pkts,
+                  core::Timestamp{bh.ts_first_pkt.ts_sec, bh.ts_first_pkt.ts_nsec},
+                  core::Timestamp{bh.ts_last_pkt.ts_sec, bh.ts_last_pkt.ts_nsec});
+
+    std::uint8_t *p = reinterpret_cast<std::uint8_t *>(block) + bh.offset_to_first_pkt;
+    for (std::uint32_t i = 0; i < bh.num_pkts; ++i) {
+        auto *hdr = reinterpret_cast< ::tpacket3_hdr *>(p);
+        m_ts = core::Timestamp{hdr->tp_sec, hdr->tp_nsec};
+        m_pkt_len = hdr->tp_len;
+        m_bytes_read += hdr->tp_snaplen;
+        handle_frame_(p + hdr->tp_mac, hdr->tp_snaplen, hdr->tp_len, &m_ts);
+        p += hdr->tp_next_offset;
+    }
+
+    ++m_blocks_read;
+    // give the block back to the kernel:
+    __atomic_store_n(&bh.block_status, TP_STATUS_KERNEL, __ATOMIC_RELEASE);
+}
+
+void PacketRing::handle_frame_(std::uint8_t *frame, std::uint32_t caplen, std::uint32_t, const core::Timestamp *ts)
+{
+    if (UNLIKELY(caplen < sizeof(struct ethhdr))) {
+        return;
+    }
+    std::uint16_t proto = 0;
+    std::uint32_t header_size = pcap::ethernet_header(frame, proto);
+    handle_eth_payload_(proto, frame + header_size, caplen - header_size, ts);
+}
+
+PacketRingStats PacketRing::stats()
+{
+    ::tpacket_stats_v3 st;
+    socklen_t len = sizeof(st);
+    ::memset(&st, 0, sizeof(st));
+    // the kernel resets its counters on each read:
+    if (0 == ::getsockopt(m_fd, SOL_PACKET, PACKET_STATISTICS, &st, &len)) {
+        m_stats.packets += st.tp_packets;
+        m_stats.drops += st.tp_drops;
+        m_stats.freezes += st.tp_freeze_q_cnt;
+    }
+    return m_stats;
+}
+
+namespace pcap {
+
+RingWriter::RingWriter( const std::string& interface
+                      , const std::string& path
+                      , std::uint32_t block_size
+                      , std::uint32_t block_count
+                      , std::uint32_t block_timeout_ms)
+    : PacketRing(interface, block_size, block_count, block_timeout_ms)
+    , m_path(path)
+    , m_pcap_p(::pcap_open_dead_with_tstamp_precision(DLT_EN10MB, 262144, PCAP_TSTAMP_PRECISION_NANO))
+    , m_dumper_p(nullptr)
+    , m_packets_written(0)
+{
+    if (m_pcap_p) {
+        m_dumper_p = ::pcap_dump_open(m_pcap_p, m_path.c_str());
+    }
+    if (!m_dumper_p) {
+        std::string err(m_pcap_p ? ::pcap_geterr(m_pcap_p) : "pcap_open_dead failed");
+        if (m_pcap_p) {
+            ::pcap_close(m_pcap_p);
+        }
+        throw std::runtime_error("RingWriter: could not open " + m_path + ": " + err);
+    }
+}
+
+RingWriter::~RingWriter()
+{
+    ::pcap_dump_close(m_dumper_p);
+    ::pcap_close(m_pcap_p);
+}
+
+bool RingWriter::flush()
+{
+    return 0 == ::pcap_dump_flush(m_dumper_p);
+}
+
+void RingWriter::handle_frame_(std::uint8_t *frame, std::uint32_t caplen, std::uint32_t len, const core::Timestamp *ts)
+{
+    struct pcap_pkthdr hdr;
+    hdr.ts.tv_sec = ts->tv_sec;
+    // nanoseconds, as the file says:
+    hdr.ts.tv_usec = static_cast<suseconds_t>(ts->tv_nsec);
+    hdr.caplen = caplen;
+    hdr.len = len;
+    ::pcap_dump(reinterpret_cast<u_char *>(m_dumper_p), &hdr, frame);
+    ++m_packets_written;
+}
+
+}
+
+} }
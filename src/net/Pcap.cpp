@@ -7,8 +7,9 @@
 
 namespace i01 { namespace net { namespace pcap {
 
-Reader::Reader(const std::string &filename) :
-    m_filename(filename)
+Reader::Reader(const std::string &filename, const core::LZ4::ReadAhead& ra) :
+    m_filename(filename),
+    m_read_ahead(ra)
 {
     open_file_();
 }
@@ -16,17 +17,45 @@ Reader::Reader(const std::string &filename) :
 void
 Reader::open_file_()
 {
-    m_pcap_p = new core::pcap::FileReader(m_filename.c_str(), m_errbuf);
+    m_pcap_p = new core::pcap::FileReader(m_filename.c_str(), m_errbuf, m_read_ahead);
+    if (!m_checkpoints.empty())
+        m_pcap_p->checkpoints(m_checkpoints);
 }
 
 void Reader::close_file_()
 {
     if (m_pcap_p) {
+        m_checkpoints = m_pcap_p->checkpoints();
         delete m_pcap_p;
         m_pcap_p = nullptr;
     }
 }
 
+std::uint64_t Reader::tell() const
+{
+    return m_pcap_p ? m_pcap_p->tell() : 0;
+}
+
+bool Reader::seek(std::uint64_t offset)
+{
+    if (!m_pcap_p)
+        open_file_();
+    return m_pcap_p->seek(offset);
+}
+
+std::vector<core::LZ4::Checkpoint> Reader::checkpoints() const
+{
+    return m_pcap_p ? m_pcap_p->checkpoints() : m_checkpoints;
+}
+
+void Reader::checkpoints(const std::vector<core::LZ4::Checkpoint>& cps)
+{
+    if (m_pcap_p)
+        m_pcap_p->checkpoints(cps);
+    else
+        m_checkpoints = cps;
+}
+
 int Reader::read_packets(int limit)
 {
     std::uint32_t count = 0;
@@ -60,16 +89,8 @@ int Reader::read_packets(int limit)
         m_pkt_len = header_p->len;
         // this should be in seconds + nanos
         m_ts = i01::core::Timestamp{header_p->ts.tv_sec, header_p->ts.tv_usec};
-        const struct ethhdr *eth_p = reinterpret_cast<const struct ethhdr *>(data_p);
-
-        std::uint16_t next_proto = ntohs(eth_p->h_proto);
-        std::uint32_t header_size = sizeof(struct ethhdr);
-        if (ETH_P_8021Q == next_proto) {
-            // vlan extended header
-            // just skip the next two bytes to find the next protocol
-            header_size += 4;
-            next_proto = ntohs(*reinterpret_cast<const std::uint16_t *>(data_p + sizeof(struct ethhdr) + 2));
-        }
+        std::uint16_t next_proto = 0;
+        std::uint32_t header_size = ethernet_header(data_p, next_proto);
 
         std::uint32_t payload_size = header_p->caplen - header_size;
 
@@ -4,7 +4,12 @@ namespace i01 { namespace net {
 
 void FileMuxBase::register_timer(TimerListener *tl, void *userdata)
 {
-    m_timer_listeners.emplace_back(TimerListenerEntry{tl, userdata, 0});
+    m_timer_listeners.emplace_back(tl, userdata);
+    if (m_timer_ts.tv_sec) {
+        // join the others at their next expiry:
+        const Timestamp next(m_timer_ts.tv_sec + (m_last_ts - m_timer_ts).tv_sec + 1, m_timer_ts.tv_nsec);
+        m_timers.add(m_timer_listeners.back(), nullptr, next, timer_interval());
+    }
 }
 
 int FileMuxBase::read_packets(int num)
@@ -30,27 +35,15 @@ int FileMuxBase::read_packets_until(const Timestamp &ts)
 
 void FileMuxBase::update_timers()
 {
-    // call the timer listeners if necessary ... thsi needs to happen before we dispatch the pkt since we could've had a gap in the data... so would need to fire timers in the interim...
-
+    // this needs to happen before we dispatch the pkt since we could've had
+    // a gap in the data, and the timers for the interim fire first
     if (m_timer_ts.tv_sec == 0) {
         m_timer_ts = m_last_ts;
-    } else {
-        auto diff = m_last_ts - m_timer_ts;
-
-        if (diff.tv_sec >= 1) {
-            // we have to fire timer at least once
-            while (diff.tv_sec-- >= 1) {
-                // it's been at least a second since last timer ..
-                // we need to hit any timers that occurred in between ...
-                m_timer_ts.tv_sec++;
-                core::Timestamp::last_event(m_timer_ts);
-                for (auto t : m_timer_listeners) {
-                    // i think it's always iter==1, since we are never going to miss a read on the timer
-                    t.listener->on_timer(m_timer_ts, t.userdata, 1);
-                }
-            }
-            core::Timestamp::last_event(m_last_ts);
-        }
+        m_timers.reset(m_timer_ts);
+        for (auto& t : m_timer_listeners)
+            m_timers.add(t, nullptr, m_timer_ts + timer_interval(), timer_interval());
+    } else if (m_timers.advance(m_last_ts)) {
+        core::Timestamp::last_event(m_last_ts);
     }
 }
 
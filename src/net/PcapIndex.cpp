@@ -0,0 +1,177 @@
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <ostream>
+
+#include <i01_net/Pcap.hpp>
+#include <i01_net/PcapIndex.hpp>
+
+namespace i01 { namespace net { namespace pcap {
+
+namespace {
+
+std::uint64_t to_ns(const core::Timestamp& ts)
+{
+    return static_cast<std::uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<std::uint64_t>(ts.tv_nsec);
+}
+
+}
+
+std::ostream & operator<<(std::ostream &os, const IndexHeader &h)
+{
+    return os << std::hex << h.magic_number << std::dec
+              << "," << h.version
+              << "," << h.interval_ms
+              << "," << h.source_size
+              << "," << h.source_mtime
+              << "," << h.num_entries
+              << "," << h.num_checkpoints;
+}
+
+std::string Index::default_path(const std::string& capture, const std::string& dir)
+{
+    if (dir.empty())
+        return capture + ".idx";
+    std::string::size_type slash = capture.rfind('/');
+    return dir + "/" + (slash == std::string::npos ? capture : capture.substr(slash + 1)) + ".idx";
+}
+
+Index::Index() :
+    m_header()
+{
+}
+
+bool Index::stat_(const std::string& capture, std::uint64_t& size, std::int64_t& mtime)
+{
+    struct stat st;
+    if (0 != ::stat(capture.c_str(), &st))
+        return false;
+    size = static_cast<std::uint64_t>(st.st_size);
+    mtime = static_cast<std::int64_t>(st.st_mtime);
+    return true;
+}
+
+bool Index::load(const std::string& path, const std::string& capture)
+{
+    std::uint64_t size = 0;
+    std::int64_t mtime = 0;
+    if (!stat_(capture, size, mtime))
+        return false;
+    std::FILE *f = std::fopen(path.c_str(), "rb");
+    if (!f)
+        return false;
+
+    IndexHeader h;
+    bool ok = 1 == std::fread(&h, sizeof(h), 1, f)
+        && MAGIC_NUMBER == h.magic_number
+        && VERSION_NUMBER == h.version
+        && size == h.source_size
+        && mtime == h.source_mtime;
+    std::vector<IndexEntry> entries;
+    std::vector<core::LZ4::Checkpoint> checkpoints;
+    if (ok) {
+        entries.resize(h.num_entries);
+        checkpoints.resize(h.num_checkpoints);
+        ok = entries.size() == std::fread(entries.data(), sizeof(IndexEntry), entries.size(), f)
+            && checkpoints.size() == std::fread(checkpoints.data(), sizeof(core::LZ4::Checkpoint), checkpoints.size(), f)
+            && EOF == std::fgetc(f);
+    }
+    std::fclose(f);
+    if (!ok)
+        return false;
+
+    m_header = h;
+    m_entries.swap(entries);
+    m_checkpoints.swap(checkpoints);
+    return true;
+}
+
+bool Index::save(const std::string& path) const
+{
+    // write a copy and rename it into place, so that concurrent users
+    // never see a partial index:
+    const std::string tmp(path + ".tmp." + std::to_string(::getpid()));
+    std::FILE *f = std::fopen(tmp.c_str(), "wb");
+    if (!f)
+        return false;
+    bool ok = 1 == std::fwrite(&m_header, sizeof(m_header), 1, f)
+        && m_entries.size() == std::fwrite(m_entries.data(), sizeof(IndexEntry), m_entries.size(), f)
+        && m_checkpoints.size() == std::fwrite(m_checkpoints.data(), sizeof(core::LZ4::Checkpoint), m_checkpoints.size(), f);
+    ok = (0 == std::fclose(f)) && ok;
+    ok = ok && 0 == std::rename(tmp.c_str(), path.c_str());
+    if (!ok)
+        ::unlink(tmp.c_str());
+    return ok;
+}
+
+bool Index::build(const std::string& capture, std::uint32_t interval_ms)
+{
+    IndexHeader h = IndexHeader();
+    h.magic_number = MAGIC_NUMBER;
+    h.version = VERSION_NUMBER;
+    h.interval_ms = std::max<std::uint32_t>(interval_ms, 1);
+    std::uint64_t size = 0;
+    std::int64_t mtime = 0;
+    if (!stat_(capture, size, mtime))
+        return false;
+    h.source_size = size;
+    h.source_mtime = mtime;
+
+    const std::uint64_t interval_ns = static_cast<std::uint64_t>(h.interval_ms) * 1000000ULL;
+    std::uint64_t next_ns = 0;
+    std::vector<IndexEntry> entries;
+    try {
+        Reader r(capture);
+        while (true) {
+            const std::uint64_t offset = r.tell();
+            int n = r.read_packets(1);
+            if (n < 0)
+                return false;
+            if (n == 0)
+                break;
+            const std::uint64_t ns = to_ns(r.last_ts());
+            if (entries.empty() || ns >= next_ns) {
+                entries.push_back(IndexEntry{ns, offset});
+                next_ns = (ns / interval_ns + 1) * interval_ns;
+            }
+        }
+        m_checkpoints = r.checkpoints();
+    } catch (const std::runtime_error& e) {
+        std::cerr << "pcap::Index: could not read " << capture << ": " << e.what() << std::endl;
+        return false;
+    }
+
+    m_entries.swap(entries);
+    h.num_entries = m_entries.size();
+    h.num_checkpoints = m_checkpoints.size();
+    m_header = h;
+    return true;
+}
+
+bool Index::open(const std::string& capture, const std::string& path, std::uint32_t interval_ms)
+{
+    if (load(path, capture))
+        return true;
+    if (!build(capture, interval_ms))
+        return false;
+    if (!save(path))
+        std::cerr << "pcap::Index: could not save " << path << std::endl;
+    return true;
+}
+
+const IndexEntry* Index::find(const core::Timestamp& ts) const
+{
+    const std::uint64_t ns = to_ns(ts);
+    auto it = std::upper_bound(m_entries.begin(), m_entries.end(), ns,
+            [](std::uint64_t t, const IndexEntry& e) { return t < e.timestamp; });
+    if (it == m_entries.begin())
+        return nullptr;
+    return &*(it - 1);
+}
+
+}}}
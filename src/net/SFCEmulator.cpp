@@ -0,0 +1,253 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
+
+#include <i01_core/macro.hpp>
+#include <i01_core/Pcap.hpp>
+
+#include <i01_net/SFCEmulator.hpp>
+
+namespace i01 { namespace net { namespace sfcemu {
+
+PcapSource::PcapSource(const std::string& path, std::uint64_t loops)
+    : m_loops(loops)
+    , m_loop(0)
+    , m_pos(0)
+    , m_delivered(0)
+    , m_discard_every(0)
+    , m_discard_type(Frame::NO_DISCARD)
+    , m_hw_timestamps(true)
+{
+    char errbuf[PCAP_ERRBUF_SIZE] = "";
+    core::pcap::FileReader reader(path, errbuf);
+    if (!reader.is_open()) {
+        throw std::runtime_error("PcapSource: could not open " + path + ": " + errbuf);
+    }
+    struct pcap_pkthdr *hdr_p = nullptr;
+    const u_char *data_p = nullptr;
+    int ret;
+    while ((ret = reader.next_ex(&hdr_p, &data_p)) == 1) {
+        // ts.tv_usec holds nanoseconds for nanosecond files, as
+        // pcap::Reader assumes:
+        m_frames.push_back(Record{m_data.size(), hdr_p->caplen,
+                    core::Timestamp{hdr_p->ts.tv_sec, hdr_p->ts.tv_usec}});
+        m_data.insert(m_data.end(), data_p, data_p + hdr_p->caplen);
+    }
+    // a capture cut short mid-record keeps the frames before the cut:
+    if (-1 == ret && m_frames.empty()) {
+        throw std::runtime_error("PcapSource: error reading " + path + ": " + reader.geterr());
+    }
+}
+
+void PcapSource::discard_every(std::uint64_t n, int type)
+{
+    m_discard_every = n;
+    m_discard_type = type;
+}
+
+void PcapSource::rewind()
+{
+    m_loop = 0;
+    m_pos = 0;
+}
+
+bool PcapSource::next(Frame& f)
+{
+    if (UNLIKELY(m_pos == m_frames.size())) {
+        if (m_frames.empty() || ++m_loop >= m_loops) {
+            m_loop = m_loops;
+            return false;
+        }
+        m_pos = 0;
+    }
+    const Record& r = m_frames[m_pos++];
+    f.data = m_data.data() + r.offset;
+    f.len = r.len;
+    f.hw_ts = m_hw_timestamps ? r.ts : core::Timestamp{0,0};
+    ++m_delivered;
+    f.discard_type = (m_discard_every && 0 == m_delivered % m_discard_every)
+                   ? m_discard_type : Frame::NO_DISCARD;
+    return true;
+}
+
+struct ShmFrameRing::Header {
+    static const std::uint64_t MAGIC = 0x693031534643524eULL; // "i01SFCRN"
+
+    std::uint64_t magic;
+    std::uint32_t slot_size;
+    std::uint32_t slot_count;
+    alignas(64) std::atomic<std::uint32_t> head; // written by the producer
+    alignas(64) std::atomic<std::uint32_t> tail; // written by the consumer
+};
+
+struct ShmFrameRing::Slot {
+    std::uint32_t len;
+    std::int32_t discard_type;
+    std::int64_t sec;
+    std::int64_t nsec;
+    std::uint8_t data[SLOT_SIZE - 24];
+};
+
+// the header has a page to itself:
+std::size_t ShmFrameRing::header_size_()
+{
+    return (sizeof(Header) + 4095) & ~std::size_t(4095);
+}
+
+std::size_t ShmFrameRing::ring_size_(std::uint32_t slot_count)
+{
+    return header_size_() + static_cast<std::size_t>(slot_count) * SLOT_SIZE;
+}
+
+ShmFrameRing::ShmFrameRing(const std::string& name, std::uint32_t slot_count)
+    : m_name(name)
+    , m_owner(true)
+    , m_hdr(nullptr)
+    , m_size(ring_size_(slot_count))
+{
+    static_assert(sizeof(Slot) == SLOT_SIZE, "ShmFrameRing::Slot must fill a slot");
+    if (0 == slot_count || (slot_count & (slot_count - 1))) {
+        throw std::invalid_argument("ShmFrameRing: slot_count must be a power of two");
+    }
+    ::shm_unlink(m_name.c_str());
+    int fd = ::shm_open(m_name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0) {
+        throw std::runtime_error("ShmFrameRing: shm_open " + m_name + " failed: " + ::strerror(errno));
+    }
+    if (0 != ::ftruncate(fd, static_cast<off_t>(m_size))) {
+        int err = errno;
+        ::close(fd);
+        ::shm_unlink(m_name.c_str());
+        throw std::runtime_error("ShmFrameRing: ftruncate " + m_name + " failed: " + ::strerror(err));
+    }
+    map_(fd, m_size);
+    m_hdr->slot_size = SLOT_SIZE;
+    m_hdr->slot_count = slot_count;
+    m_hdr->head.store(0, std::memory_order_relaxed);
+    m_hdr->tail.store(0, std::memory_order_relaxed);
+    // publish last, so an opener never sees a half-made ring:
+    __atomic_store_n(&m_hdr->magic, Header::MAGIC, __ATOMIC_RELEASE);
+}
+
+ShmFrameRing::ShmFrameRing(const std::string& name)
+    : m_name(name)
+    , m_owner(false)
+    , m_hdr(nullptr)
+    , m_size(0)
+{
+    int fd = ::shm_open(m_name.c_str(), O_RDWR, 0);
+    if (fd < 0) {
+        throw std::runtime_error("ShmFrameRing: shm_open " + m_name + " failed: " + ::strerror(errno));
+    }
+    struct stat st;
+    if (0 != ::fstat(fd, &st) || static_cast<std::size_t>(st.st_size) < header_size_()) {
+        ::close(fd);
+        throw std::runtime_error("ShmFrameRing: " + m_name + " is not a frame ring");
+    }
+    m_size = static_cast<std::size_t>(st.st_size);
+    map_(fd, m_size);
+    if (Header::MAGIC != __atomic_load_n(&m_hdr->magic, __ATOMIC_ACQUIRE)
+     || SLOT_SIZE != m_hdr->slot_size
+     || ring_size_(m_hdr->slot_count) != m_size) {
+        ::munmap(m_hdr, m_size);
+        throw std::runtime_error("ShmFrameRing: " + m_name + " is not a frame ring");
+    }
+}
+
+ShmFrameRing::~ShmFrameRing()
+{
+    ::munmap(m_hdr, m_size);
+    if (m_owner) {
+        ::shm_unlink(m_name.c_str());
+    }
+}
+
+void ShmFrameRing::map_(int fd, std::size_t size)
+{
+    void *p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0);
+    int err = errno;
+    ::close(fd);
+    if (MAP_FAILED == p) {
+        if (m_owner) {
+            ::shm_unlink(m_name.c_str());
+        }
+        throw std::runtime_error("ShmFrameRing: mmap " + m_name + " failed: " + ::strerror(err));
+    }
+    m_hdr = static_cast<Header *>(p);
+}
+
+ShmFrameRing::Slot * ShmFrameRing::slot_(std::uint32_t i) const
+{
+    return reinterpret_cast<Slot *>(reinterpret_cast<char *>(m_hdr) + header_size_()
+                                    + static_cast<std::size_t>(i & (m_hdr->slot_count - 1)) * SLOT_SIZE);
+}
+
+std::uint32_t ShmFrameRing::capacity() const
+{
+    return m_hdr->slot_count;
+}
+
+std::uint32_t ShmFrameRing::size() const
+{
+    return m_hdr->head.load(std::memory_order_acquire) - m_hdr->tail.load(std::memory_order_acquire);
+}
+
+std::uint32_t ShmFrameRing::max_frame_len()
+{
+    return sizeof(Slot::data);
+}
+
+bool ShmFrameRing::push(const void *frame, std::uint32_t len, const core::Timestamp& hw_ts, int discard_type)
+{
+    const std::uint32_t head = m_hdr->head.load(std::memory_order_relaxed);
+    if (UNLIKELY(head - m_hdr->tail.load(std::memory_order_acquire) == m_hdr->slot_count
+              || len > max_frame_len())) {
+        return false;
+    }
+    Slot *s = slot_(head);
+    s->len = len;
+    s->discard_type = discard_type;
+    s->sec = hw_ts.tv_sec;
+    s->nsec = hw_ts.tv_nsec;
+    std::memcpy(s->data, frame, len);
+    m_hdr->head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+bool ShmFrameRing::front(Frame& f) const
+{
+    const std::uint32_t tail = m_hdr->tail.load(std::memory_order_relaxed);
+    if (tail == m_hdr->head.load(std::memory_order_acquire)) {
+        return false;
+    }
+    const Slot *s = slot_(tail);
+    f.data = s->data;
+    f.len = s->len;
+    f.hw_ts = core::Timestamp{static_cast<time_t>(s->sec), static_cast<long>(s->nsec)};
+    f.discard_type = s->discard_type;
+    return true;
+}
+
+void ShmFrameRing::pop()
+{
+    m_hdr->tail.store(m_hdr->tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+bool ShmRingSource::next(Frame& f)
+{
+    // the previous frame is done with once the next is asked for:
+    if (m_held) {
+        m_ring->pop();
+    }
+    m_held = m_ring->front(f);
+    return m_held;
+}
+
+} } }
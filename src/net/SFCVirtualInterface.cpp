@@ -22,12 +22,14 @@ SFCVirtualInterface::SFCVirtualInterface(
         , SFCVirtualInterface* evq_opt
         , bool hw_timestamping)
     : m_intf(intf)
+    , m_index_in_vi_set(-1)
     , m_vi()
     , m_mr()
     , m_pio()
     , m_sfc_mac()
     , m_sfc_mtu(0)
     , m_pktbufs_p(nullptr)
+    , m_pktbufs_lifo(0) /* nodes are reserved in init() */
     , m_pktbufs_lifo_size(0)
     , m_rxq_cushion(8)
     , m_hw_timestamping(hw_timestamping)
@@ -71,6 +73,7 @@ SFCVirtualInterface::SFCVirtualInterface(
     , m_sfc_mac()
     , m_sfc_mtu(0)
     , m_pktbufs_p(nullptr)
+    , m_pktbufs_lifo(0) /* nodes are reserved in init() */
     , m_pktbufs_lifo_size(0)
     , m_rxq_cushion(8)
     , m_hw_timestamping(hw_timestamping)
@@ -111,7 +114,7 @@ SFCVirtualInterface::~SFCVirtualInterface()
         ::ef_memreg_free(&m_mr, m_intf.dh());
         if (m_pktbufs_p)
         {
-            ::free(&m_pktbufs_p);
+            ::free(m_pktbufs_p);
         }
     } else { throw std::runtime_error("ef_vi_flush failed."); }
     ::ef_vi_free(&m_vi, m_intf.dh());
@@ -250,12 +253,13 @@ int SFCVirtualInterface::fill_rxq(int n)
     /* Remember that m_rxq_cushion is always bounded from above by the number of
      * SFCPktBufs available due to get_pktbuf()'s behavior. */
     int ret = 0;
-    for (int i = 0; i < m_rxq_cushion; ++i)
+    for (int i = 0; i < n; ++i)
     {
         SFCPktBuf * pb_p = get_pktbuf();
+        /* addr() is already past the SFCPktBuf header, at data(). */
         if ( pb_p
           && ef_vi_receive_init(&m_vi
-              , pb_p->addr() + SFCPktBuf::prefix_size()
+              , pb_p->addr()
               , pb_p->pool_id()) == 0 /* will be -EAGAIN if rxq full */
            )
         {
@@ -294,8 +298,8 @@ int SFCVirtualInterface::poll(const int max_evs)
                             , pb_p->data()
                             , static_cast<i01::core::POSIXTimeSpec*>(&hwts)
                             , &timesync_flags);
-                    bool hwts_clock_set = timesync_flags | EF_VI_SYNC_FLAG_CLOCK_SET;
-                    bool hwts_clock_in_sync = timesync_flags | EF_VI_SYNC_FLAG_CLOCK_IN_SYNC;
+                    bool hwts_clock_set = timesync_flags & EF_VI_SYNC_FLAG_CLOCK_SET;
+                    bool hwts_clock_in_sync = timesync_flags & EF_VI_SYNC_FLAG_CLOCK_IN_SYNC;
                     char * buf = pb_p->data()
                                + pb_p->vi_owner()->m_receive_prefix_len;
                     int len = EF_EVENT_RX_BYTES(evs[i])
@@ -340,8 +344,8 @@ int SFCVirtualInterface::poll(const int max_evs)
                             , pb_p->data()
                             , static_cast<i01::core::POSIXTimeSpec*>(&hwts)
                             , &timesync_flags);
-                    bool hwts_clock_set = timesync_flags | EF_VI_SYNC_FLAG_CLOCK_SET;
-                    bool hwts_clock_in_sync = timesync_flags | EF_VI_SYNC_FLAG_CLOCK_IN_SYNC;
+                    bool hwts_clock_set = timesync_flags & EF_VI_SYNC_FLAG_CLOCK_SET;
+                    bool hwts_clock_in_sync = timesync_flags & EF_VI_SYNC_FLAG_CLOCK_IN_SYNC;
                     char * buf = pb_p->data()
                                + pb_p->vi_owner()->m_receive_prefix_len;
                     int len = EF_EVENT_RX_DISCARD_BYTES(evs[i])
@@ -376,8 +380,8 @@ int SFCVirtualInterface::poll(const int max_evs)
                 Timestamp hwts( EF_EVENT_TX_WITH_TIMESTAMP_SEC(evs[i])
                               , EF_EVENT_TX_WITH_TIMESTAMP_NSEC(evs[i]));
                 unsigned timesync_flags = EF_EVENT_TX_WITH_TIMESTAMP_SYNC_FLAGS(evs[i]);
-                bool hwts_clock_set = timesync_flags | EF_VI_SYNC_FLAG_CLOCK_SET;
-                bool hwts_clock_in_sync = timesync_flags | EF_VI_SYNC_FLAG_CLOCK_IN_SYNC;
+                bool hwts_clock_set = timesync_flags & EF_VI_SYNC_FLAG_CLOCK_SET;
+                bool hwts_clock_in_sync = timesync_flags & EF_VI_SYNC_FLAG_CLOCK_IN_SYNC;
                 for (int j = 0; j < n; ++j)
                 {
                     SFCPktBuf * pb_p = get_pktbuf(ids[j]);
@@ -404,6 +408,9 @@ int SFCVirtualInterface::poll(const int max_evs)
               } break;
             }
         }
+        /* Return the buffers just consumed before the rxq runs dry, rather
+         * than only once the adapter reports it has. */
+        maintain_rxq();
         on_poll_complete_cb(n_ev);
     }
     return n_ev;
@@ -0,0 +1,256 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/socket.h>
+
+#include <algorithm>
+#include <sstream>
+
+#include <i01_core/macro.hpp>
+#include <i01_core/FD.hpp>
+
+#include <i01_net/UringEventPoller.hpp>
+
+namespace i01 { namespace net {
+
+std::ostream & operator<<(std::ostream &os, const UringStats &s)
+{
+    return os << "enters," << s.enters.load(std::memory_order_relaxed)
+              << ",completions," << s.completions.load(std::memory_order_relaxed)
+              << ",rearms," << s.rearms.load(std::memory_order_relaxed)
+              << ",no_buffers," << s.no_buffers.load(std::memory_order_relaxed);
+}
+
+UringEventPoller::UringEventPoller()
+    : EventPoller()
+    , m_change_mutex()
+    , m_have_unarmed(false)
+    , m_sq_entries(DEFAULT_SQ_ENTRIES)
+    , m_buffer_count(DEFAULT_BUFFER_COUNT)
+    , m_buffer_size(DEFAULT_BUFFER_SIZE)
+    , m_recv_descs(MAX_RECV_BATCH)
+    , m_recv_bids(MAX_RECV_BATCH)
+    , m_batch_size(0)
+{
+}
+
+UringEventPoller::UringEventPoller(const std::string& n) : UringEventPoller()
+{
+    name(n);
+}
+
+UringEventPoller::~UringEventPoller()
+{
+    lockguard_type l(m_change_mutex);
+    // closing the ring cancels everything still in flight:
+    m_ring.reset();
+    for (auto *s : m_sources) {
+        delete s->ed;
+        delete s;
+    }
+    m_sources.clear();
+    m_unarmed.clear();
+}
+
+bool UringEventPoller::ring_size(std::uint32_t sq_entries, std::uint16_t buffer_count, std::uint32_t buffer_size)
+{
+    if (0 == sq_entries || 0 == buffer_count || (buffer_count & (buffer_count - 1)) || 0 == buffer_size)
+        return false;
+    lockguard_type l(m_change_mutex);
+    if (m_ring)
+        return false;
+    m_sq_entries = sq_entries;
+    m_buffer_count = buffer_count;
+    m_buffer_size = buffer_size;
+    return true;
+}
+
+bool UringEventPoller::configure(const core::Config::storage_type& cfg)
+{
+    if (!ring_size(cfg.get_or_default<std::uint32_t>("sq_entries", DEFAULT_SQ_ENTRIES),
+                   cfg.get_or_default<std::uint16_t>("recv_buffers", DEFAULT_BUFFER_COUNT),
+                   cfg.get_or_default<std::uint32_t>("recv_buffer_size", DEFAULT_BUFFER_SIZE))) {
+        std::cerr << "UringEventPoller: " << name() << ": bad sq_entries, recv_buffers or recv_buffer_size" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+std::string UringEventPoller::status() const
+{
+    std::ostringstream ss;
+    ss << name() << ",io_uring," << m_stats << ",errors," << m_errcount;
+    return ss.str();
+}
+
+bool UringEventPoller::add_socket( SocketListener& listener
+                                 , EventUserData userdata
+                                 , int fd, bool managed)
+{
+    EventData * ed = new EventData{
+        .type = EventType::SOCKET_FD,
+        .managed = managed,
+        .fd = core::SocketFD(fd),
+        .listener = { .socket = &listener },
+        .userdata = userdata
+    };
+    if (!ed->fd.valid()) {
+        delete ed;
+        return false;
+    }
+    int so_type = 0;
+    socklen_t so_type_len = sizeof(so_type);
+    ed->datagram = 0 == ::getsockopt(fd, SOL_SOCKET, SO_TYPE, &so_type, &so_type_len)
+                && SOCK_DGRAM == so_type;
+
+    lockguard_type l(m_change_mutex);
+    Source *s = new Source{ed, false};
+    m_sources.push_back(s);
+    m_unarmed.push_back(s);
+    m_have_unarmed.store(true, std::memory_order_release);
+    return true;
+}
+
+bool UringEventPoller::init_ring_()
+{
+    try {
+        m_ring.reset(new IOUring(m_sq_entries, m_sq_entries * 16,
+                                 IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_DEFER_TASKRUN));
+    } catch (const std::runtime_error& e) {
+        std::cerr << "UringEventPoller: " << name() << ": " << e.what() << std::endl;
+        return false;
+    }
+    if (!m_ring->register_buffers(s_buffer_group, m_buffer_count, m_buffer_size)) {
+        std::cerr << "UringEventPoller: " << name() << ": could not register receive buffers: " << ::strerror(errno) << std::endl;
+        m_ring.reset();
+        return false;
+    }
+    return true;
+}
+
+void UringEventPoller::arm_unarmed_()
+{
+    lockguard_type l(m_change_mutex);
+    m_have_unarmed.store(false, std::memory_order_relaxed);
+    for (auto *s : m_unarmed) {
+        if (!arm_(s))
+            on_error(m_last_event_ts, s->ed, EBUSY, "submission queue full");
+    }
+    m_unarmed.clear();
+}
+
+bool UringEventPoller::arm_(Source *s)
+{
+    ::io_uring_sqe *sqe = m_ring->get_sqe();
+    if (UNLIKELY(!sqe)) {
+        // make room, and try once more:
+        m_ring->submit(0, false);
+        sqe = m_ring->get_sqe();
+        if (!sqe)
+            return false;
+    }
+    sqe->fd = s->ed->fd.fd();
+    sqe->user_data = reinterpret_cast<std::uint64_t>(s);
+    sqe->opcode = IORING_OP_RECV;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = s_buffer_group;
+    return true;
+}
+
+bool UringEventPoller::run()
+{
+    if (UNLIKELY(!m_ring) && !init_ring_())
+        return false;
+    if (UNLIKELY(m_have_unarmed.load(std::memory_order_acquire)))
+        arm_unarmed_();
+    run_timers_();
+
+    // one system call submits the re-arms and runs the completions:
+    int ret = m_ring->submit(0, true);
+    PollStats::increment(m_stats.enters);
+    if (UNLIKELY(ret < 0 && -EINTR != ret && -EAGAIN != ret && -EBUSY != ret)) {
+        on_error(m_last_event_ts, nullptr, -ret, "io_uring_enter failed");
+        return false;
+    }
+
+    if (0 == m_ring->ready())
+        return true;
+    m_last_event_ts = core::Timestamp::now();
+    Source *batch = nullptr;
+    std::uint32_t n = m_ring->for_each_cqe([this, &batch](const ::io_uring_cqe& c) {
+        Source *s = reinterpret_cast<Source *>(c.user_data);
+        if (s != batch)
+            flush_batch_(batch);
+        s->ed->last_event_ts = m_last_event_ts;
+        on_socket_cqe_(s, c, batch);
+    });
+    flush_batch_(batch);
+    if (n) {
+        PollStats::increment(m_stats.completions, n);
+        m_ring->commit_buffers();
+    }
+    return true;
+}
+
+void UringEventPoller::on_socket_cqe_(Source *s, const ::io_uring_cqe& c, Source *& batch)
+{
+    EventData *e = s->ed;
+    const bool more = c.flags & IORING_CQE_F_MORE;
+    if (LIKELY(c.res > 0 && (c.flags & IORING_CQE_F_BUFFER))) {
+        const std::uint16_t bid = static_cast<std::uint16_t>(c.flags >> IORING_CQE_BUFFER_SHIFT);
+        const std::uint8_t *buf = m_ring->buffer(bid);
+        if (e->datagram) {
+            batch = s;
+            m_recv_descs[m_batch_size] = RecvDescriptor{buf, static_cast<ssize_t>(c.res), e->last_event_ts, core::Timestamp(), core::Timestamp()};
+            m_recv_bids[m_batch_size] = bid;
+            if (++m_batch_size == MAX_RECV_BATCH)
+                flush_batch_(batch);
+        } else {
+            e->listener.socket->on_recv(e->last_event_ts, e->userdata, buf, c.res);
+            m_ring->recycle_buffer(bid);
+        }
+    } else if (0 == c.res) {
+        if (c.flags & IORING_CQE_F_BUFFER)
+            m_ring->recycle_buffer(static_cast<std::uint16_t>(c.flags >> IORING_CQE_BUFFER_SHIFT));
+        if (!e->datagram) {
+            s->closed = true;
+            e->listener.socket->on_peer_disconnect(e->last_event_ts, e->userdata);
+            return;
+        }
+    } else if (-ENOBUFS == c.res) {
+        // every buffer is with a listener or queued; they come back at
+        // the end of this run()
+        PollStats::increment(m_stats.no_buffers);
+    } else if (-ECANCELED != c.res) {
+        on_error(e->last_event_ts, e, -c.res, "io_uring recv failed");
+    }
+    if (!more && !s->closed && -ECANCELED != c.res) {
+        PollStats::increment(m_stats.rearms);
+        if (!arm_(s))
+            on_error(e->last_event_ts, e, EBUSY, "submission queue full");
+    }
+}
+
+void UringEventPoller::flush_batch_(Source *& batch)
+{
+    if (!batch)
+        return;
+    EventData *e = batch->ed;
+    e->listener.socket->on_recv_batch(e->last_event_ts, e->userdata, m_recv_descs.data(), m_batch_size);
+    for (std::size_t i = 0; i < m_batch_size; ++i)
+        m_ring->recycle_buffer(m_recv_bids[i]);
+    m_batch_size = 0;
+    batch = nullptr;
+}
+
+void* UringEventPoller::process()
+{
+    if (!run()) {
+        return (void*)1;
+    } else {
+        return nullptr;
+    }
+}
+
+} }
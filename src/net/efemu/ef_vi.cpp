@@ -0,0 +1,715 @@
+// Software ef_vi: the part of OpenOnload's ef_vi API that i01_net uses,
+// receiving from the emulated ports of i01_net/SFCEmulator.hpp.  Built
+// only against the stand-in headers next to it, see src/net/CMakeLists.txt.
+
+#include <etherfabric/vi.h>
+#include <etherfabric/memreg.h>
+
+#ifdef I01_SFC_EMULATION
+
+#include <errno.h>
+#include <string.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+#include <i01_core/macro.hpp>
+
+#include <i01_net/SFCEmulator.hpp>
+
+namespace i01 { namespace net { namespace sfcemu {
+
+namespace {
+
+/// Written ahead of each frame when a VI has EF_VI_RX_TIMESTAMPS.
+struct RxPrefix {
+    std::uint32_t sec;
+    std::uint32_t nsec;
+    std::uint32_t sync_flags;
+    std::uint32_t reserved;
+};
+
+const int DEFAULT_EVQ_CAPACITY = 1024;
+const int DEFAULT_RXQ_CAPACITY = 512;
+const int DEFAULT_TXQ_CAPACITY = 512;
+const int MTU = 1500;
+
+/// ef_filter_spec::type bits.
+enum : unsigned {
+    FILTER_MAC = 0x1,
+    FILTER_VLAN = 0x2,
+    FILTER_IP4_LOCAL = 0x4,
+    FILTER_IP4_FULL = 0x8,
+    FILTER_UNICAST_ALL = 0x10,
+    FILTER_MULTICAST_ALL = 0x20
+};
+
+struct Port;
+struct VISet;
+
+struct VI {
+    Port *port;
+    VISet *set;
+    unsigned flags;
+    int prefix_len;
+    int txq_capacity;
+
+    std::vector<ef_event> evq;
+    std::uint32_t evq_mask;
+    std::uint32_t evq_head;
+    std::uint32_t evq_tail;
+
+    std::vector<std::pair<ef_addr, ef_request_id> > rxq;
+    std::uint32_t rxq_mask;
+    std::uint32_t rxq_added;
+    std::uint32_t rxq_pushed;
+    std::uint32_t rxq_removed;
+    /// An RX_NO_DESC_TRUNC has been raised since the last delivery.
+    bool no_desc;
+
+    std::uint32_t evq_fill() const { return evq_tail - evq_head; }
+    bool evq_full() const { return evq_fill() > evq_mask; }
+    void push_event(const ef_event& ev) { evq[evq_tail++ & evq_mask] = ev; }
+};
+
+struct VISet {
+    Port *port;
+    std::vector<VI *> vis;
+};
+
+struct Filter {
+    int id;
+    ef_filter_spec spec;
+    VI *vi;
+    VISet *set;
+};
+
+struct Port {
+    std::shared_ptr<Source> source;
+    /// The frame on the wire, held until every VI it goes to has room.
+    Frame frame;
+    bool held;
+    std::vector<VI *> vis;
+    std::vector<std::unique_ptr<VISet> > sets;
+    std::vector<Filter> filters;
+    std::vector<VI *> targets;
+    PortStats stats;
+};
+
+/// The headers filters match on; addresses and ports in network order.
+struct Headers {
+    const std::uint8_t *dst_mac;
+    int vlan_id;
+    bool ip4;
+    bool l4;
+    int protocol;
+    std::uint32_t saddr;
+    std::uint32_t daddr;
+    std::uint16_t sport;
+    std::uint16_t dport;
+};
+
+std::mutex g_mutex;
+std::map<unsigned, std::unique_ptr<Port> > g_ports;
+int g_next_dh = 0;
+int g_next_filter_id = 0;
+
+/// With g_mutex held.
+Port& port_(unsigned ifindex)
+{
+    std::unique_ptr<Port>& p = g_ports[ifindex];
+    if (!p) {
+        p.reset(new Port());
+        p->held = false;
+        p->stats = PortStats{0,0,0,0,0};
+    }
+    return *p;
+}
+
+VI * vi_(ef_vi *vi)
+{
+    return vi ? static_cast<VI *>(vi->vi_emu) : nullptr;
+}
+
+std::uint32_t pow2_(int n)
+{
+    std::uint32_t r = 1;
+    while (r < static_cast<std::uint32_t>(n))
+        r <<= 1;
+    return r;
+}
+
+void parse_(const Frame& f, Headers& h)
+{
+    std::memset(&h, 0, sizeof(h));
+    h.vlan_id = EF_FILTER_VLAN_ID_ANY;
+    if (f.len < 14)
+        return;
+    h.dst_mac = f.data;
+    std::uint32_t off = 12;
+    std::uint16_t type = static_cast<std::uint16_t>(f.data[off] << 8 | f.data[off + 1]);
+    if (0x8100 == type && f.len >= 18) {
+        h.vlan_id = (f.data[14] << 8 | f.data[15]) & 0xfff;
+        off += 4;
+        type = static_cast<std::uint16_t>(f.data[off] << 8 | f.data[off + 1]);
+    }
+    off += 2;
+    if (0x0800 != type || f.len < off + 20)
+        return;
+    const std::uint8_t *ip = f.data + off;
+    const std::uint32_t ihl = (ip[0] & 0xf) * 4u;
+    h.ip4 = true;
+    h.protocol = ip[9];
+    std::memcpy(&h.saddr, ip + 12, 4);
+    std::memcpy(&h.daddr, ip + 16, 4);
+    // fragments after the first carry no ports, and the first is not
+    // worth reassembling here:
+    const bool fragment = (ip[6] & 0x3f) || ip[7];
+    if (!fragment && (IPPROTO_UDP == h.protocol || IPPROTO_TCP == h.protocol)
+        && f.len >= off + ihl + 4) {
+        h.l4 = true;
+        std::memcpy(&h.sport, ip + ihl, 2);
+        std::memcpy(&h.dport, ip + ihl + 2, 2);
+    }
+}
+
+bool match_(const ef_filter_spec& fs, const Headers& h)
+{
+    if (!h.dst_mac)
+        return false;
+    if ((fs.type & FILTER_VLAN) && fs.vlan_id != h.vlan_id)
+        return false;
+    if ((fs.type & FILTER_MAC) && 0 != std::memcmp(fs.mac, h.dst_mac, 6))
+        return false;
+    if (fs.type & (FILTER_IP4_LOCAL | FILTER_IP4_FULL)) {
+        if (!h.l4 || fs.protocol != h.protocol
+         || fs.local_host_be32 != h.daddr || fs.local_port_be16 != h.dport)
+            return false;
+        if ((fs.type & FILTER_IP4_FULL)
+         && (fs.remote_host_be32 != h.saddr || fs.remote_port_be16 != h.sport))
+            return false;
+    }
+    if ((fs.type & FILTER_MULTICAST_ALL) && !(h.dst_mac[0] & 1))
+        return false;
+    if ((fs.type & FILTER_UNICAST_ALL) && (h.dst_mac[0] & 1))
+        return false;
+    return true;
+}
+
+/// Spreads flows over the VIs of a set, as RSS would.
+VI * pick_(const VISet& s, const Headers& h)
+{
+    std::uint32_t live = 0;
+    for (VI *v : s.vis)
+        live += v ? 1 : 0;
+    if (0 == live)
+        return nullptr;
+    std::uint32_t hash = h.saddr ^ h.daddr ^ (static_cast<std::uint32_t>(h.sport) << 16 | h.dport) ^ h.protocol;
+    hash *= 0x9e3779b1u;
+    std::uint32_t k = (hash >> 16) % live;
+    for (VI *v : s.vis) {
+        if (v && 0 == k--)
+            return v;
+    }
+    return nullptr;
+}
+
+/// The VIs frame goes to: those with a matching filter, or failing any,
+/// those with a matching unicast-all or multicast-all filter.
+void route_(Port& p, const Frame& f)
+{
+    p.targets.clear();
+    Headers h;
+    parse_(f, h);
+    for (int pass = 0; pass < 2 && p.targets.empty(); ++pass) {
+        for (const Filter& flt : p.filters) {
+            const bool wildcard = flt.spec.type & (FILTER_UNICAST_ALL | FILTER_MULTICAST_ALL);
+            if (wildcard != (1 == pass) || !match_(flt.spec, h))
+                continue;
+            VI *v = flt.vi ? flt.vi : pick_(*flt.set, h);
+            if (v && p.targets.end() == std::find(p.targets.begin(), p.targets.end(), v))
+                p.targets.push_back(v);
+        }
+    }
+}
+
+/// DMA frame into v's next receive buffer, as the adapter would.
+void receive_(Port& p, VI& v, const Frame& f)
+{
+    ef_event ev;
+    std::memset(&ev, 0, sizeof(ev));
+    if (UNLIKELY(v.rxq_removed == v.rxq_pushed)) {
+        ++p.stats.no_desc;
+        if (!v.no_desc) {
+            v.no_desc = true;
+            ev.rx_no_desc_trunc.type = EF_EVENT_TYPE_RX_NO_DESC_TRUNC;
+            v.push_event(ev);
+        }
+        return;
+    }
+    const std::pair<ef_addr, ef_request_id>& desc = v.rxq[v.rxq_removed++ & v.rxq_mask];
+    v.no_desc = false;
+
+    std::uint8_t *buf = reinterpret_cast<std::uint8_t *>(static_cast<std::uintptr_t>(desc.first));
+    if (v.prefix_len) {
+        RxPrefix px{0, 0, 0, 0};
+        if (f.hw_ts.tv_sec || f.hw_ts.tv_nsec) {
+            px.sec = static_cast<std::uint32_t>(f.hw_ts.tv_sec);
+            px.nsec = static_cast<std::uint32_t>(f.hw_ts.tv_nsec);
+            px.sync_flags = EF_VI_SYNC_FLAG_CLOCK_SET | EF_VI_SYNC_FLAG_CLOCK_IN_SYNC;
+        }
+        std::memcpy(buf, &px, sizeof(px));
+    }
+    const std::uint32_t len = std::min<std::uint32_t>(f.len, static_cast<std::uint32_t>(RX_BUFFER_LEN - v.prefix_len));
+    std::memcpy(buf + v.prefix_len, f.data, len);
+
+    int discard_type = f.discard_type;
+    if (len < f.len)
+        discard_type = EF_EVENT_RX_DISCARD_TRUNC;
+    if (UNLIKELY(Frame::NO_DISCARD != discard_type)) {
+        ev.rx_discard.type = EF_EVENT_TYPE_RX_DISCARD;
+        ev.rx_discard.rq_id = static_cast<unsigned>(desc.second);
+        ev.rx_discard.len = static_cast<unsigned>(len + v.prefix_len);
+        ev.rx_discard.flags = EF_EVENT_FLAG_SOP;
+        ev.rx_discard.subtype = static_cast<unsigned>(discard_type);
+        ++p.stats.discarded;
+    } else {
+        ev.rx.type = EF_EVENT_TYPE_RX;
+        ev.rx.rq_id = static_cast<unsigned>(desc.second);
+        ev.rx.len = static_cast<unsigned>(len + v.prefix_len);
+        ev.rx.flags = EF_EVENT_FLAG_SOP;
+        ++p.stats.delivered;
+    }
+    v.push_event(ev);
+}
+
+/// Move up to want frames off p's wire, stopping early once poller has
+/// want events or the wire is idle.  A frame waits while any VI it goes
+/// to has a full event queue.
+void pump_(Port& p, const VI& poller, std::uint32_t want)
+{
+    for (std::uint32_t moved = 0; moved < want && poller.evq_fill() < want; ++moved) {
+        if (!p.held) {
+            if (!p.source || !p.source->next(p.frame))
+                break;
+            p.held = true;
+            ++p.stats.frames;
+            route_(p, p.frame);
+        }
+        if (p.targets.empty()) {
+            ++p.stats.unmatched;
+            p.held = false;
+            continue;
+        }
+        bool room = true;
+        for (const VI *v : p.targets)
+            room = room && !v->evq_full();
+        if (!room)
+            break;
+        for (VI *v : p.targets)
+            receive_(p, *v, p.frame);
+        p.held = false;
+    }
+}
+
+int alloc_(ef_vi *vi, Port& p, VISet *set, int index,
+           int evq_capacity, int rxq_capacity, int txq_capacity,
+           ef_vi *evq_opt, enum ef_vi_flags flags)
+{
+    // a VI always has its own event queue here:
+    if (evq_opt)
+        return -EOPNOTSUPP;
+    if (set) {
+        if (index < 0) {
+            index = static_cast<int>(std::find(set->vis.begin(), set->vis.end(), nullptr) - set->vis.begin());
+        }
+        if (index >= static_cast<int>(set->vis.size()))
+            return -EINVAL;
+        if (set->vis[static_cast<std::size_t>(index)])
+            return -EBUSY;
+    }
+    std::unique_ptr<VI> v(new VI());
+    v->port = &p;
+    v->set = set;
+    v->flags = flags;
+    v->prefix_len = (flags & EF_VI_RX_TIMESTAMPS) ? static_cast<int>(sizeof(RxPrefix)) : 0;
+    v->txq_capacity = static_cast<int>(pow2_(txq_capacity < 0 ? DEFAULT_TXQ_CAPACITY : txq_capacity));
+    v->evq.resize(pow2_(evq_capacity < 0 ? DEFAULT_EVQ_CAPACITY : evq_capacity));
+    v->evq_mask = static_cast<std::uint32_t>(v->evq.size() - 1);
+    v->evq_head = v->evq_tail = 0;
+    v->rxq.resize(pow2_(rxq_capacity < 0 ? DEFAULT_RXQ_CAPACITY : rxq_capacity));
+    v->rxq_mask = static_cast<std::uint32_t>(v->rxq.size() - 1);
+    v->rxq_added = v->rxq_pushed = v->rxq_removed = 0;
+    v->no_desc = false;
+    if (set)
+        set->vis[static_cast<std::size_t>(index)] = v.get();
+    p.vis.push_back(v.get());
+    vi->vi_emu = v.release();
+    vi->vi_rx_prefix_len = vi_(vi)->prefix_len;
+    return 0;
+}
+
+}
+
+std::ostream & operator<<(std::ostream &os, const PortStats &s)
+{
+    return os << "frames," << s.frames
+              << ",delivered," << s.delivered
+              << ",discarded," << s.discarded
+              << ",unmatched," << s.unmatched
+              << ",no_desc," << s.no_desc;
+}
+
+void attach(unsigned ifindex, std::shared_ptr<Source> source)
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+    Port& p = port_(ifindex);
+    p.source = source;
+    p.held = false;
+    p.stats = PortStats{0,0,0,0,0};
+}
+
+void detach(unsigned ifindex)
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+    Port& p = port_(ifindex);
+    p.source.reset();
+    p.held = false;
+}
+
+PortStats port_stats(unsigned ifindex)
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+    return port_(ifindex).stats;
+}
+
+} } }
+
+using namespace i01::net::sfcemu;
+
+extern "C" {
+
+int ef_driver_open(ef_driver_handle *dh_out)
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+    *dh_out = ++g_next_dh;
+    return 0;
+}
+
+int ef_driver_close(ef_driver_handle)
+{
+    return 0;
+}
+
+int ef_pd_alloc(ef_pd *pd, ef_driver_handle, int ifindex, enum ef_pd_flags flags)
+{
+    if (ifindex <= 0)
+        return -ENODEV;
+    std::lock_guard<std::mutex> lock(g_mutex);
+    port_(static_cast<unsigned>(ifindex));
+    pd->pd_ifindex = ifindex;
+    pd->pd_flags = flags;
+    return 0;
+}
+
+int ef_pd_free(ef_pd *, ef_driver_handle)
+{
+    return 0;
+}
+
+int ef_memreg_alloc(ef_memreg *mr, ef_driver_handle, ef_pd *, ef_driver_handle, void *p_mem, size_t len_bytes)
+{
+    if (reinterpret_cast<std::uintptr_t>(p_mem) % EF_VI_DMA_ALIGN)
+        return -EINVAL;
+    mr->mr_base = static_cast<char *>(p_mem);
+    mr->mr_bytes = len_bytes;
+    return 0;
+}
+
+int ef_memreg_free(ef_memreg *mr, ef_driver_handle)
+{
+    mr->mr_base = nullptr;
+    mr->mr_bytes = 0;
+    return 0;
+}
+
+int ef_vi_alloc_from_pd(ef_vi *vi, ef_driver_handle, ef_pd *pd, ef_driver_handle,
+                        int evq_capacity, int rxq_capacity, int txq_capacity,
+                        ef_vi *evq_opt, ef_driver_handle, enum ef_vi_flags flags)
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+    return alloc_(vi, port_(static_cast<unsigned>(pd->pd_ifindex)), nullptr, -1,
+                  evq_capacity, rxq_capacity, txq_capacity, evq_opt, flags);
+}
+
+int ef_vi_alloc_from_set(ef_vi *vi, ef_driver_handle, ef_vi_set *vi_set, ef_driver_handle,
+                         int index_in_vi_set, int evq_capacity, int rxq_capacity, int txq_capacity,
+                         ef_vi *evq_opt, ef_driver_handle, enum ef_vi_flags flags)
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+    VISet *s = static_cast<VISet *>(vi_set->vis_emu);
+    return alloc_(vi, *s->port, s, index_in_vi_set,
+                  evq_capacity, rxq_capacity, txq_capacity, evq_opt, flags);
+}
+
+int ef_vi_free(ef_vi *vi, ef_driver_handle)
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+    std::unique_ptr<VI> v(vi_(vi));
+    if (!v)
+        return -EINVAL;
+    Port& p = *v->port;
+    p.vis.erase(std::remove(p.vis.begin(), p.vis.end(), v.get()), p.vis.end());
+    p.filters.erase(std::remove_if(p.filters.begin(), p.filters.end(),
+                                   [&v](const Filter& f) { return f.vi == v.get(); }),
+                    p.filters.end());
+    if (v->set)
+        std::replace(v->set->vis.begin(), v->set->vis.end(), v.get(), static_cast<VI *>(nullptr));
+    // the frame on the wire may have been going to it:
+    if (p.held)
+        route_(p, p.frame);
+    vi->vi_emu = nullptr;
+    return 0;
+}
+
+int ef_vi_flush(ef_vi *, ef_driver_handle)
+{
+    return 0;
+}
+
+int ef_vi_set_alloc_from_pd(ef_vi_set *vi_set, ef_driver_handle, ef_pd *pd, ef_driver_handle, int n_vis)
+{
+    if (n_vis <= 0)
+        return -EINVAL;
+    std::lock_guard<std::mutex> lock(g_mutex);
+    Port& p = port_(static_cast<unsigned>(pd->pd_ifindex));
+    p.sets.emplace_back(new VISet());
+    p.sets.back()->port = &p;
+    p.sets.back()->vis.assign(static_cast<std::size_t>(n_vis), nullptr);
+    vi_set->vis_emu = p.sets.back().get();
+    return 0;
+}
+
+int ef_vi_get_mac(ef_vi *vi, ef_driver_handle, void *mac_out)
+{
+    VI *v = vi_(vi);
+    if (!v)
+        return -EINVAL;
+    // locally administered, ending in the interface index:
+    std::lock_guard<std::mutex> lock(g_mutex);
+    unsigned ifindex = 0;
+    for (const auto& kv : g_ports) {
+        if (kv.second.get() == v->port)
+            ifindex = kv.first;
+    }
+    const std::uint8_t mac[6] = { 0x02, 0, static_cast<std::uint8_t>(ifindex >> 24), static_cast<std::uint8_t>(ifindex >> 16),
+                                  static_cast<std::uint8_t>(ifindex >> 8), static_cast<std::uint8_t>(ifindex) };
+    std::memcpy(mac_out, mac, sizeof(mac));
+    return 0;
+}
+
+int ef_vi_mtu(ef_vi *, ef_driver_handle)
+{
+    return MTU;
+}
+
+int ef_vi_receive_prefix_len(ef_vi *vi)
+{
+    return vi->vi_rx_prefix_len;
+}
+
+int ef_vi_receive_buffer_len(ef_vi *)
+{
+    return RX_BUFFER_LEN;
+}
+
+int ef_eventq_capacity(ef_vi *vi)
+{
+    return static_cast<int>(vi_(vi)->evq.size());
+}
+
+int ef_vi_receive_capacity(ef_vi *vi)
+{
+    return static_cast<int>(vi_(vi)->rxq.size());
+}
+
+int ef_vi_transmit_capacity(ef_vi *vi)
+{
+    return vi_(vi)->txq_capacity;
+}
+
+int ef_vi_receive_fill_level(ef_vi *vi)
+{
+    const VI *v = vi_(vi);
+    return static_cast<int>(v->rxq_added - v->rxq_removed);
+}
+
+int ef_vi_receive_init(ef_vi *vi, ef_addr addr, ef_request_id dma_id)
+{
+    VI *v = vi_(vi);
+    if (UNLIKELY(v->rxq_added - v->rxq_removed > v->rxq_mask))
+        return -EAGAIN;
+    v->rxq[v->rxq_added++ & v->rxq_mask] = std::make_pair(addr, dma_id);
+    return 0;
+}
+
+void ef_vi_receive_push(ef_vi *vi)
+{
+    VI *v = vi_(vi);
+    v->rxq_pushed = v->rxq_added;
+}
+
+int ef_vi_receive_get_timestamp_with_sync_flags(ef_vi *vi, const void *pkt, struct timespec *ts_out, unsigned *flags_out)
+{
+    if (!(vi_(vi)->flags & EF_VI_RX_TIMESTAMPS))
+        return -EOPNOTSUPP;
+    RxPrefix px;
+    std::memcpy(&px, pkt, sizeof(px));
+    *flags_out = px.sync_flags;
+    if (!(px.sync_flags & EF_VI_SYNC_FLAG_CLOCK_SET))
+        return -ENODATA;
+    ts_out->tv_sec = static_cast<time_t>(px.sec);
+    ts_out->tv_nsec = static_cast<long>(px.nsec);
+    return 0;
+}
+
+int ef_eventq_poll(ef_vi *vi, ef_event *evs, int evs_len)
+{
+    VI *v = vi_(vi);
+    if (evs_len <= 0)
+        return 0;
+    pump_(*v->port, *v, static_cast<std::uint32_t>(evs_len));
+    int n = 0;
+    while (n < evs_len && v->evq_head != v->evq_tail)
+        evs[n++] = v->evq[v->evq_head++ & v->evq_mask];
+    return n;
+}
+
+int ef_vi_transmit_unbundle(ef_vi *, const ef_event *, ef_request_id *)
+{
+    return 0;
+}
+
+void ef_filter_spec_init(ef_filter_spec *fs, enum ef_filter_flags flags)
+{
+    std::memset(fs, 0, sizeof(*fs));
+    fs->flags = flags;
+    fs->vlan_id = EF_FILTER_VLAN_ID_ANY;
+}
+
+int ef_filter_spec_set_ip4_local(ef_filter_spec *fs, int protocol, unsigned host_be32, int port_be16)
+{
+    if (IPPROTO_UDP != protocol && IPPROTO_TCP != protocol)
+        return -EPROTONOSUPPORT;
+    fs->type |= FILTER_IP4_LOCAL;
+    fs->protocol = protocol;
+    fs->local_host_be32 = host_be32;
+    fs->local_port_be16 = static_cast<std::uint16_t>(port_be16);
+    return 0;
+}
+
+int ef_filter_spec_set_ip4_full(ef_filter_spec *fs, int protocol, unsigned host_be32, int port_be16,
+                                unsigned rhost_be32, int rport_be16)
+{
+    int ret = ef_filter_spec_set_ip4_local(fs, protocol, host_be32, port_be16);
+    if (ret < 0)
+        return ret;
+    fs->type = (fs->type & ~static_cast<unsigned>(FILTER_IP4_LOCAL)) | FILTER_IP4_FULL;
+    fs->remote_host_be32 = rhost_be32;
+    fs->remote_port_be16 = static_cast<std::uint16_t>(rport_be16);
+    return 0;
+}
+
+int ef_filter_spec_set_vlan(ef_filter_spec *fs, int vlan_id)
+{
+    fs->type |= FILTER_VLAN;
+    fs->vlan_id = vlan_id;
+    return 0;
+}
+
+int ef_filter_spec_set_eth_local(ef_filter_spec *fs, int vlan_id, const void *mac)
+{
+    fs->type |= FILTER_MAC;
+    std::memcpy(fs->mac, mac, sizeof(fs->mac));
+    if (EF_FILTER_VLAN_ID_ANY != vlan_id)
+        ef_filter_spec_set_vlan(fs, vlan_id);
+    return 0;
+}
+
+int ef_filter_spec_set_unicast_all(ef_filter_spec *fs)
+{
+    fs->type |= FILTER_UNICAST_ALL;
+    return 0;
+}
+
+int ef_filter_spec_set_multicast_all(ef_filter_spec *fs)
+{
+    fs->type |= FILTER_MULTICAST_ALL;
+    return 0;
+}
+
+int ef_vi_filter_add(ef_vi *vi, ef_driver_handle, const ef_filter_spec *fs, ef_filter_cookie *filter_cookie_out)
+{
+    VI *v = vi_(vi);
+    if (!v || 0 == fs->type)
+        return -EINVAL;
+    std::lock_guard<std::mutex> lock(g_mutex);
+    Filter f{++g_next_filter_id, *fs, v, nullptr};
+    v->port->filters.push_back(f);
+    filter_cookie_out->filter_id = f.id;
+    filter_cookie_out->filter_type = static_cast<int>(fs->type);
+    return 0;
+}
+
+int ef_vi_set_filter_add(ef_vi_set *vi_set, ef_driver_handle, const ef_filter_spec *fs, ef_filter_cookie *filter_cookie_out)
+{
+    VISet *s = static_cast<VISet *>(vi_set->vis_emu);
+    if (!s || 0 == fs->type)
+        return -EINVAL;
+    std::lock_guard<std::mutex> lock(g_mutex);
+    Filter f{++g_next_filter_id, *fs, nullptr, s};
+    s->port->filters.push_back(f);
+    filter_cookie_out->filter_id = f.id;
+    filter_cookie_out->filter_type = static_cast<int>(fs->type);
+    return 0;
+}
+
+namespace {
+
+int filter_del_(Port& p, const ef_filter_cookie *fc)
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+    auto it = std::find_if(p.filters.begin(), p.filters.end(),
+                           [fc](const Filter& f) { return f.id == fc->filter_id; });
+    if (p.filters.end() == it)
+        return -ENOENT;
+    p.filters.erase(it);
+    if (p.held)
+        route_(p, p.frame);
+    return 0;
+}
+
+}
+
+int ef_vi_filter_del(ef_vi *vi, ef_driver_handle, ef_filter_cookie *filter_cookie)
+{
+    VI *v = vi_(vi);
+    return v ? filter_del_(*v->port, filter_cookie) : -EINVAL;
+}
+
+int ef_vi_set_filter_del(ef_vi_set *vi_set, ef_driver_handle, ef_filter_cookie *filter_cookie)
+{
+    VISet *s = static_cast<VISet *>(vi_set->vis_emu);
+    return s ? filter_del_(*s->port, filter_cookie) : -EINVAL;
+}
+
+}
+
+#endif
@@ -0,0 +1,26 @@
+/* Software stand-in for OpenOnload's etherfabric/base.h, used when
+ * OpenOnload is not installed.  See i01_net/SFCEmulator.hpp. */
+#pragma once
+
+/* Tells i01_net it is built against the emulation. */
+#define I01_SFC_EMULATION 1
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef int ef_driver_handle;
+typedef uint64_t ef_addr;
+typedef int ef_request_id;
+
+#define EF_VI_DMA_ALIGN 64
+
+int ef_driver_open(ef_driver_handle *dh_out);
+int ef_driver_close(ef_driver_handle dh);
+
+#ifdef __cplusplus
+}
+#endif
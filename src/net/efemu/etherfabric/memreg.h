@@ -0,0 +1,27 @@
+/* Software stand-in for OpenOnload's etherfabric/memreg.h.  DMA addresses
+ * are the registered memory's own addresses. */
+#pragma once
+
+#include <etherfabric/base.h>
+#include <etherfabric/pd.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct ef_memreg {
+    char *mr_base;
+    size_t mr_bytes;
+} ef_memreg;
+
+int ef_memreg_alloc(ef_memreg *mr, ef_driver_handle mr_dh, ef_pd *pd, ef_driver_handle pd_dh, void *p_mem, size_t len_bytes);
+int ef_memreg_free(ef_memreg *mr, ef_driver_handle mr_dh);
+
+static inline ef_addr ef_memreg_dma_addr(ef_memreg *mr, size_t offset)
+{
+    return (ef_addr)(uintptr_t)(mr->mr_base + offset);
+}
+
+#ifdef __cplusplus
+}
+#endif
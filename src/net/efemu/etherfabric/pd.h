@@ -0,0 +1,24 @@
+/* Software stand-in for OpenOnload's etherfabric/pd.h. */
+#pragma once
+
+#include <etherfabric/base.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum ef_pd_flags {
+    EF_PD_DEFAULT = 0x0
+};
+
+typedef struct ef_pd {
+    int pd_ifindex;
+    enum ef_pd_flags pd_flags;
+} ef_pd;
+
+int ef_pd_alloc(ef_pd *pd, ef_driver_handle pd_dh, int ifindex, enum ef_pd_flags flags);
+int ef_pd_free(ef_pd *pd, ef_driver_handle pd_dh);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,9 @@
+/* Software stand-in for OpenOnload's etherfabric/pio.h.  There is no PIO. */
+#pragma once
+
+#include <etherfabric/base.h>
+
+typedef struct ef_pio {
+    uint8_t *pio_buffer;
+    unsigned pio_len;
+} ef_pio;
@@ -0,0 +1,179 @@
+/* Software stand-in for OpenOnload's etherfabric/vi.h: the subset of the
+ * ef_vi API used by i01_net, with the same names and semantics, over the
+ * emulated ports of i01_net/SFCEmulator.hpp. */
+#pragma once
+
+#include <time.h>
+
+#include <etherfabric/base.h>
+#include <etherfabric/pd.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**********************************************************************
+ * Events
+ */
+
+enum {
+    EF_EVENT_TYPE_RX,
+    EF_EVENT_TYPE_TX,
+    EF_EVENT_TYPE_RX_DISCARD,
+    EF_EVENT_TYPE_TX_ERROR,
+    EF_EVENT_TYPE_RX_NO_DESC_TRUNC,
+    EF_EVENT_TYPE_SW,
+    EF_EVENT_TYPE_OFLOW,
+    EF_EVENT_TYPE_TX_WITH_TIMESTAMP,
+    EF_EVENT_TYPE_RX_PACKED_STREAM,
+    EF_EVENT_TYPE_RX_PACKED_STREAM_DISCARD
+};
+
+enum {
+    EF_EVENT_RX_DISCARD_CSUM_BAD,
+    EF_EVENT_RX_DISCARD_MCAST_MISMATCH,
+    EF_EVENT_RX_DISCARD_CRC_BAD,
+    EF_EVENT_RX_DISCARD_TRUNC,
+    EF_EVENT_RX_DISCARD_RIGHTS,
+    EF_EVENT_RX_DISCARD_EV_ERROR,
+    EF_EVENT_RX_DISCARD_OTHER
+};
+
+#define EF_EVENT_FLAG_SOP   0x1
+#define EF_EVENT_FLAG_CONT  0x2
+
+typedef union {
+    uint64_t u64[2];
+    struct { unsigned type:16; } generic;
+    struct { unsigned type:16; unsigned q_id:16; unsigned rq_id:32; unsigned len:16; unsigned flags:16; } rx;
+    struct { unsigned type:16; unsigned q_id:16; unsigned rq_id:32; unsigned len:16; unsigned flags:16; unsigned subtype:16; } rx_discard;
+    struct { unsigned type:16; unsigned q_id:16; unsigned desc_id:16; } tx;
+    struct { unsigned type:16; unsigned q_id:16; unsigned desc_id:16; unsigned subtype:16; } tx_error;
+    struct { unsigned type:16; unsigned q_id:16; unsigned rq_id:32; unsigned ts_sec:32; unsigned ts_nsec:32; } tx_timestamp;
+    struct { unsigned type:16; unsigned q_id:16; } rx_no_desc_trunc;
+    struct { unsigned type:16; unsigned data; } sw;
+} ef_event;
+
+#define EF_EVENT_TYPE(e)                    ((e).generic.type)
+
+#define EF_EVENT_RX_BYTES(e)                ((e).rx.len)
+#define EF_EVENT_RX_Q_ID(e)                 ((e).rx.q_id)
+#define EF_EVENT_RX_RQ_ID(e)                ((e).rx.rq_id)
+#define EF_EVENT_RX_CONT(e)                 ((e).rx.flags & EF_EVENT_FLAG_CONT)
+#define EF_EVENT_RX_SOP(e)                  ((e).rx.flags & EF_EVENT_FLAG_SOP)
+
+#define EF_EVENT_RX_DISCARD_Q_ID(e)         ((e).rx_discard.q_id)
+#define EF_EVENT_RX_DISCARD_RQ_ID(e)        ((e).rx_discard.rq_id)
+#define EF_EVENT_RX_DISCARD_CONT(e)         ((e).rx_discard.flags & EF_EVENT_FLAG_CONT)
+#define EF_EVENT_RX_DISCARD_SOP(e)          ((e).rx_discard.flags & EF_EVENT_FLAG_SOP)
+#define EF_EVENT_RX_DISCARD_TYPE(e)         ((e).rx_discard.subtype)
+#define EF_EVENT_RX_DISCARD_BYTES(e)        ((e).rx_discard.len)
+
+#define EF_EVENT_TX_Q_ID(e)                 ((e).tx.q_id)
+#define EF_EVENT_TX_ERROR_TYPE(e)           ((e).tx_error.subtype)
+#define EF_EVENT_TX_WITH_TIMESTAMP_SEC(e)   ((e).tx_timestamp.ts_sec)
+#define EF_EVENT_TX_WITH_TIMESTAMP_NSEC(e)  ((e).tx_timestamp.ts_nsec & ~3u)
+#define EF_EVENT_TX_WITH_TIMESTAMP_SYNC_FLAGS(e) ((e).tx_timestamp.ts_nsec & 3u)
+
+#define EF_EVENT_RX_NO_DESC_TRUNC_Q_ID(e)   ((e).rx_no_desc_trunc.q_id)
+
+#define EF_EVENT_SW_DATA_MASK               0xffff
+#define EF_EVENT_SW_DATA(e)                 ((e).sw.data)
+
+#define EF_VI_SYNC_FLAG_CLOCK_SET           1
+#define EF_VI_SYNC_FLAG_CLOCK_IN_SYNC       2
+
+#define EF_VI_TRANSMIT_BATCH                64
+
+/**********************************************************************
+ * Virtual interfaces
+ */
+
+enum ef_vi_flags {
+    EF_VI_FLAGS_DEFAULT = 0x0,
+    EF_VI_RX_TIMESTAMPS = 0x80,
+    EF_VI_TX_TIMESTAMPS = 0x2000
+};
+
+/* An emulated VI; the state lives with the emulated port. */
+typedef struct ef_vi {
+    void *vi_emu;
+    int vi_rx_prefix_len;
+} ef_vi;
+
+typedef struct ef_vi_set {
+    void *vis_emu;
+} ef_vi_set;
+
+int ef_vi_alloc_from_pd(ef_vi *vi, ef_driver_handle vi_dh, ef_pd *pd, ef_driver_handle pd_dh,
+                        int evq_capacity, int rxq_capacity, int txq_capacity,
+                        ef_vi *evq_opt, ef_driver_handle evq_dh, enum ef_vi_flags flags);
+int ef_vi_alloc_from_set(ef_vi *vi, ef_driver_handle vi_dh, ef_vi_set *vi_set, ef_driver_handle vi_set_dh,
+                         int index_in_vi_set, int evq_capacity, int rxq_capacity, int txq_capacity,
+                         ef_vi *evq_opt, ef_driver_handle evq_dh, enum ef_vi_flags flags);
+int ef_vi_free(ef_vi *vi, ef_driver_handle nic);
+int ef_vi_flush(ef_vi *vi, ef_driver_handle nic);
+
+int ef_vi_set_alloc_from_pd(ef_vi_set *vi_set, ef_driver_handle vi_set_dh, ef_pd *pd, ef_driver_handle pd_dh, int n_vis);
+
+int ef_vi_get_mac(ef_vi *vi, ef_driver_handle vi_dh, void *mac_out);
+int ef_vi_mtu(ef_vi *vi, ef_driver_handle vi_dh);
+int ef_vi_receive_prefix_len(ef_vi *vi);
+int ef_vi_receive_buffer_len(ef_vi *vi);
+int ef_eventq_capacity(ef_vi *vi);
+int ef_vi_receive_capacity(ef_vi *vi);
+int ef_vi_transmit_capacity(ef_vi *vi);
+
+int ef_vi_receive_fill_level(ef_vi *vi);
+/* -EAGAIN if the receive queue is full. */
+int ef_vi_receive_init(ef_vi *vi, ef_addr addr, ef_request_id dma_id);
+void ef_vi_receive_push(ef_vi *vi);
+int ef_vi_receive_get_timestamp_with_sync_flags(ef_vi *vi, const void *pkt, struct timespec *ts_out, unsigned *flags_out);
+
+int ef_eventq_poll(ef_vi *vi, ef_event *evs, int evs_len);
+int ef_vi_transmit_unbundle(ef_vi *vi, const ef_event *ev, ef_request_id *ids);
+
+/**********************************************************************
+ * Filters
+ */
+
+enum ef_filter_flags {
+    EF_FILTER_FLAG_NONE = 0x0
+};
+
+#define EF_FILTER_VLAN_ID_ANY -1
+
+typedef struct ef_filter_spec {
+    unsigned type;
+    unsigned flags;
+    int vlan_id;
+    uint8_t mac[6];
+    int protocol;
+    uint32_t local_host_be32;
+    uint32_t remote_host_be32;
+    uint16_t local_port_be16;
+    uint16_t remote_port_be16;
+} ef_filter_spec;
+
+typedef struct ef_filter_cookie {
+    int filter_id;
+    int filter_type;
+} ef_filter_cookie;
+
+void ef_filter_spec_init(ef_filter_spec *fs, enum ef_filter_flags flags);
+int ef_filter_spec_set_ip4_local(ef_filter_spec *fs, int protocol, unsigned host_be32, int port_be16);
+int ef_filter_spec_set_ip4_full(ef_filter_spec *fs, int protocol, unsigned host_be32, int port_be16,
+                                unsigned rhost_be32, int rport_be16);
+int ef_filter_spec_set_vlan(ef_filter_spec *fs, int vlan_id);
+int ef_filter_spec_set_eth_local(ef_filter_spec *fs, int vlan_id, const void *mac);
+int ef_filter_spec_set_unicast_all(ef_filter_spec *fs);
+int ef_filter_spec_set_multicast_all(ef_filter_spec *fs);
+
+int ef_vi_filter_add(ef_vi *vi, ef_driver_handle dh, const ef_filter_spec *fs, ef_filter_cookie *filter_cookie_out);
+int ef_vi_filter_del(ef_vi *vi, ef_driver_handle dh, ef_filter_cookie *filter_cookie);
+int ef_vi_set_filter_add(ef_vi_set *vi_set, ef_driver_handle dh, const ef_filter_spec *fs, ef_filter_cookie *filter_cookie_out);
+int ef_vi_set_filter_del(ef_vi_set *vi_set, ef_driver_handle dh, ef_filter_cookie *filter_cookie);
+
+#ifdef __cplusplus
+}
+#endif
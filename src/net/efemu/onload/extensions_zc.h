@@ -0,0 +1,2 @@
+/* Software stand-in for OpenOnload's onload/extensions_zc.h: no extensions. */
+#pragma once
@@ -1,25 +1,31 @@
 #pragma once
 
+#include <sys/socket.h>
+
+#include <atomic>
 #include <queue>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include <i01_core/macro.hpp>
 #include <i01_core/FD.hpp>
 #include <i01_net/EpollSet.hpp>
 #include <i01_core/Time.hpp>
+#include <i01_core/TimerWheel.hpp>
 #include <i01_core/Lock.hpp>
 #include <i01_core/Config.hpp>
 #include <i01_core/NamedThread.hpp>
+#include <i01_net/RecvLatency.hpp>
+#include <i01_net/SocketListener.hpp>
 
 namespace i01 { namespace core {
-class TimerListener;
 class EventListener;
 class SignalListener;
 }}
 
 namespace i01 { namespace net {
 
-class SocketListener;
-
     typedef void * EventUserData;
 
     enum class EventType {
@@ -31,6 +37,66 @@ class SocketListener;
     };
     std::ostream & operator<<(std::ostream &os, const EventType &s);
 
+    /// How EpollEventPoller reads a readable socket.
+    enum class RecvMode {
+        /// One recv() per EPOLLIN event, passed to SocketListener::on_recv().
+        RECV                  = 0
+        /// Datagram sockets are drained with recvmmsg() into the poller's
+        /// buffer pool and passed to SocketListener::on_recv_batch();
+        /// stream sockets are still read with recv().
+      , RECVMMSG              = 1
+    };
+    std::ostream & operator<<(std::ostream &os, const RecvMode &m);
+
+    /// Receive timestamps EpollEventPoller asks the kernel for with
+    /// SO_TIMESTAMPING on each socket it adds.
+    enum class RecvTimestamping {
+        NONE                  = 0
+        /// Kernel software receive timestamps.
+      , SOFTWARE              = 1
+        /// Software and raw NIC hardware receive timestamps.  Hardware
+        /// timestamps are only delivered once the NIC has been configured
+        /// to stamp received packets (SIOCSHWTSTAMP, e.g. hwstamp_ctl).
+      , HARDWARE              = 2
+    };
+    std::ostream & operator<<(std::ostream &os, const RecvTimestamping &t);
+
+    /// How EpollEventPoller waits for events.
+    enum class PollMode {
+        /// epoll_wait() without a timeout on every run(), burning the core.
+        SPIN                  = 0
+        /// Spin until spin_count polls in a row found nothing, then block
+        /// in epoll_wait() for up to wait_ms at a time until the next event.
+      , BACKOFF               = 1
+        /// SPIN while the event rate over the last second is at least
+        /// spin_rate events/sec, BACKOFF otherwise.
+      , ADAPTIVE              = 2
+    };
+    std::ostream & operator<<(std::ostream &os, const PollMode &m);
+    bool parse_poll_mode(const std::string& name, PollMode& mode);
+
+    /// Counts of EpollEventPoller::run() calls.  Written by the poller
+    /// thread only, and safe to read from any other.
+    struct PollStats {
+        /// Polls that found no events, and that found some.
+        std::atomic<std::uint64_t> empty;
+        std::atomic<std::uint64_t> productive;
+        /// Polls that blocked in epoll_wait() with a timeout.
+        std::atomic<std::uint64_t> blocking;
+        /// Changes of the effective PollMode.
+        std::atomic<std::uint64_t> switches;
+        /// Events per second over the last complete second.
+        std::atomic<std::uint64_t> event_rate;
+
+        PollStats() : empty(0), productive(0), blocking(0), switches(0), event_rate(0) {}
+
+        static void increment(std::atomic<std::uint64_t>& c, std::uint64_t n = 1)
+        {
+            c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+        }
+    };
+    std::ostream & operator<<(std::ostream &os, const PollStats &s);
+
 
     struct EventData {
         EventType type;
@@ -46,6 +112,14 @@ class SocketListener;
         EventUserData userdata;
         core::Timestamp last_event_ts;
         core::Atomic<std::uint64_t> errcount;
+        /// SOCK_DGRAM socket.
+        bool datagram;
+        /// SO_TIMESTAMPING is set on the socket.
+        bool timestamping;
+        /// Dequeue time - kernel receive time of each read, only kept
+        /// for sockets with timestamping; added to by the poller thread
+        /// only.
+        RecvLatencyHistogram recv_latency;
 
         ~EventData() {
             if (managed) {
@@ -69,10 +143,15 @@ class SocketListener;
         EventPoller();
         virtual ~EventPoller();
 
+        /// The listener's on_timer() is called from run(), start after now
+        /// and then every interval if that is not zero, off the poller's
+        /// timer wheel rather than a timerfd each.  Safe from any thread;
+        /// the timer is taken up by the next run().  A zero start, like a
+        /// disarmed timerfd, never fires, and is refused.
         virtual bool add_timer( core::TimerListener&
                               , EventUserData
-                              , const core::Timestamp&
-                              , const core::Timestamp&) = 0;
+                              , const core::Timestamp& start
+                              , const core::Timestamp& interval);
         virtual bool add_socket( SocketListener&
                                , EventUserData
                                , int fd
@@ -80,13 +159,39 @@ class SocketListener;
 
         const core::Timestamp& time() { return m_last_event_ts; }
 
+        /// Apply the settings in the poller's own config domain.
+        virtual bool configure(const core::Config::storage_type&) { return true; }
+        /// One line for the status output.
+        virtual std::string status() const { return std::string{}; }
+        /// Start the poller's thread, which calls run() until shut down.
+        virtual bool start() = 0;
+
         virtual bool run() = 0;
     protected:
+        struct NewTimer {
+            core::TimerListener *listener;
+            EventUserData userdata;
+            core::Timestamp deadline;
+            core::Timestamp interval;
+        };
+
         core::Timestamp m_last_event_ts;
         core::Atomic<bool> m_active;
         core::Atomic<std::uint64_t> m_errcount;
+        /// Only touched by the poller thread.
+        core::TimerWheel m_timers;
+        /// Added since the last run_timers_(), guarded by m_new_timers_mutex.
+        std::vector<NewTimer> m_new_timers;
+        core::SpinMutex m_new_timers_mutex;
+        std::atomic<bool> m_have_new_timers;
 
         virtual void on_error(const core::Timestamp& t, EventData *ed = nullptr, int errno_ = 0, const char *msg = nullptr);
+
+        /// Take up new timers and fire those due; called by run().
+        void run_timers_();
+        /// timeout_ms, or less so that a blocking poll wakes for the next
+        /// timer.
+        int timer_timeout_(int timeout_ms) const;
     };
 
     class EpollEventPoller : public EventPoller, public core::NamedThread<EpollEventPoller> {
@@ -97,16 +202,67 @@ class SocketListener;
         std::vector<EventData *> m_listeners;
 
         static const std::uint32_t s_evq_size = 64;
+        /// recvmmsg() calls per socket per EPOLLIN event, so that one busy
+        /// socket does not starve the others.
+        static const std::uint32_t s_max_batches_per_event = 8;
+        /// Bytes of control messages per datagram, room for
+        /// SCM_TIMESTAMPING and a little more.
+        static const std::uint32_t s_recv_control_size = 128;
+        /// run() calls between looks at the clock for the poll schedule and
+        /// the event rate.
+        static const std::uint32_t s_poll_check_interval = 256;
+
+        RecvMode m_recv_mode;
+        std::uint32_t m_recv_batch;
+        std::uint32_t m_recv_buffer_size;
+        /// m_recv_batch buffers of m_recv_buffer_size bytes, reused for
+        /// every read.
+        std::vector<std::uint8_t> m_recv_buffers;
+        std::vector< ::mmsghdr> m_recv_msgs;
+        std::vector< ::iovec> m_recv_iovecs;
+        std::vector<RecvDescriptor> m_recv_descs;
+
+        RecvTimestamping m_recv_timestamping;
+        /// Control message buffer for each of the m_recv_msgs.
+        std::vector<std::uint8_t> m_recv_control;
+
+        /// Configured mode, which the schedule may change, and the one in
+        /// use after ADAPTIVE is resolved.
+        PollMode m_poll_mode;
+        PollMode m_effective_poll_mode;
+        std::uint32_t m_spin_count;
+        int m_wait_ms;
+        std::uint64_t m_spin_rate;
+        int m_busy_poll_us;
+        /// (seconds since local midnight, mode), sorted.
+        std::vector<std::pair<std::uint32_t, PollMode> > m_poll_schedule;
+        PollStats m_poll_stats;
+        std::uint32_t m_empty_polls;
+        std::uint32_t m_polls_since_check;
+        std::uint64_t m_window_events;
+        core::Timestamp m_window_start;
+
+        int poll_timeout_();
+        void update_poll_mode_(const core::Timestamp& now);
+
+        void recv_(EventData *e);
+        void recv_batch_(EventData *e);
+        void on_disconnect_(EventData *e);
+        bool enable_timestamping_(EventData *e);
+        static void parse_timestamps_(const ::msghdr& hdr, core::Timestamp& kernel_ts, core::Timestamp& hw_ts);
+
+    public:
+        static const std::uint32_t DEFAULT_RECV_BATCH = 32;
+        static const std::uint32_t DEFAULT_RECV_BUFFER_SIZE = 2048;
+        static const std::uint32_t DEFAULT_SPIN_COUNT = 10000;
+        static const int DEFAULT_WAIT_MS = 1;
+        static const std::uint64_t DEFAULT_SPIN_RATE = 1000;
 
     public:
         EpollEventPoller();
         EpollEventPoller(const std::string&);
         virtual ~EpollEventPoller();
 
-        virtual bool add_timer( core::TimerListener&
-                              , EventUserData
-                              , const core::Timestamp&
-                              , const core::Timestamp&) override final;
         virtual bool add_socket( SocketListener&
                                , EventUserData
                                , int fd
@@ -114,6 +270,65 @@ class SocketListener;
 
         // bool set_affinity(const core::Config::storage_type&);
 
+        /// Set before the poller thread starts.  Datagrams longer than
+        /// buffer_size are truncated and counted as errors.
+        bool recv_mode(RecvMode mode, std::uint32_t batch = DEFAULT_RECV_BATCH, std::uint32_t buffer_size = DEFAULT_RECV_BUFFER_SIZE);
+        RecvMode recv_mode() const { return m_recv_mode; }
+        std::uint32_t recv_batch() const { return m_recv_batch; }
+        std::uint32_t recv_buffer_size() const { return m_recv_buffer_size; }
+
+        /// Set before adding sockets; applies to the sockets added after.
+        void recv_timestamping(RecvTimestamping t) { m_recv_timestamping = t; }
+        RecvTimestamping recv_timestamping() const { return m_recv_timestamping; }
+
+        /// Merge the queueing latency histograms of the sockets added with
+        /// userdata into out, returns false if there are none.  Safe to
+        /// call from any thread while the poller runs, in which case the
+        /// counters may be a few datagrams apart.
+        bool recv_latency(EventUserData userdata, RecvLatencyHistogram& out);
+
+        /// Set before the poller thread starts.  A poll schedule overrides
+        /// mode at the next scheduled time.
+        bool poll_mode(PollMode mode, std::uint32_t spin_count = DEFAULT_SPIN_COUNT, int wait_ms = DEFAULT_WAIT_MS);
+        PollMode poll_mode() const { return m_poll_mode; }
+        PollMode effective_poll_mode() const { return m_effective_poll_mode; }
+        std::uint32_t spin_count() const { return m_spin_count; }
+        int wait_ms() const { return m_wait_ms; }
+        void spin_rate(std::uint64_t events_per_sec) { m_spin_rate = events_per_sec; }
+        std::uint64_t spin_rate() const { return m_spin_rate; }
+        /// SO_BUSY_POLL on the sockets added after, 0 for none.  More than
+        /// net.core.busy_read needs CAP_NET_ADMIN.
+        void busy_poll_us(int us) { m_busy_poll_us = us; }
+        int busy_poll_us() const { return m_busy_poll_us; }
+        /// From seconds_since_midnight local time the poll mode is mode,
+        /// until the next entry; the last entry also covers the time
+        /// before the first.  Set before the poller thread starts.
+        void add_poll_schedule(std::uint32_t seconds_since_midnight, PollMode mode);
+        void clear_poll_schedule() { m_poll_schedule.clear(); }
+        const std::vector<std::pair<std::uint32_t, PollMode> >& poll_schedule() const { return m_poll_schedule; }
+        /// The scheduled mode at ts, or poll_mode() if there is no schedule.
+        PollMode scheduled_poll_mode(const core::Timestamp& ts) const;
+        const PollStats& poll_stats() const { return m_poll_stats; }
+
+        /// Reads, from the poller's own config domain:
+        ///
+        ///     recv_mode = "recvmmsg",    -- default "recv"
+        ///     recv_batch = 32,           -- datagrams per recvmmsg()
+        ///     recv_buffer_size = 2048,   -- bytes per datagram
+        ///     timestamping = "software", -- or "hardware", default "none"
+        ///     poll_mode = "backoff",     -- or "adaptive", default "spin"
+        ///     spin_count = 10000,        -- empty polls before blocking
+        ///     wait_ms = 1,               -- epoll_wait() timeout once blocking
+        ///     spin_rate = 1000,          -- adaptive: events/sec to spin at
+        ///     busy_poll_us = 50,         -- SO_BUSY_POLL, default 0
+        ///     poll_schedule = {          -- local time, optional
+        ///         { at = "09:25:00", mode = "spin" },
+        ///         { at = "16:05:00", mode = "backoff" },
+        ///     },
+        virtual bool configure(const core::Config::storage_type& cfg) override;
+        virtual std::string status() const override;
+        virtual bool start() override { return spawn(); }
+
         virtual bool run() override final;
         virtual void* process() override;
 
@@ -121,4 +336,8 @@ class SocketListener;
         static EpollEventPoller * create_and_config(const std::string& name, const core::Config::storage_type& cfg);
     };
 
+    /// An EpollEventPoller or, if cfg has backend = "io_uring", a
+    /// UringEventPoller, configured from cfg; nullptr on bad config.
+    EventPoller * create_event_poller(const std::string& name, const core::Config::storage_type& cfg);
+
 } }
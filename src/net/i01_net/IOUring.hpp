@@ -0,0 +1,130 @@
+#pragma once
+
+#include <linux/io_uring.h>
+
+#include <cstddef>
+#include <cstdint>
+
+#include <i01_core/macro.hpp>
+
+namespace i01 { namespace net {
+
+/// Minimal io_uring(7) submission and completion rings over the raw
+/// system calls, plus one ring of provided receive buffers.  Not thread
+/// safe: with IORING_SETUP_SINGLE_ISSUER every call after construction
+/// must come from the thread that first submits.
+class IOUring {
+public:
+    /// Throws std::runtime_error if the ring can not be set up.  Tries
+    /// flags first, then no flags if the kernel does not support them.
+    IOUring(std::uint32_t entries, std::uint32_t cq_entries, std::uint32_t flags = 0);
+    ~IOUring();
+
+    IOUring(const IOUring&) = delete;
+    IOUring& operator=(const IOUring&) = delete;
+
+    int fd() const { return m_fd; }
+    std::uint32_t flags() const { return m_flags; }
+
+    /// A zeroed SQE, or nullptr if the submission queue is full.
+    inline ::io_uring_sqe * get_sqe();
+    std::uint32_t pending() const { return m_sqe_tail - m_sqe_head; }
+    /// Submit the pending SQEs and, if get_events, reap completions
+    /// (running deferred task work); waits for min_complete of them.
+    /// Returns the number submitted or negative errno.
+    int submit(std::uint32_t min_complete = 0, bool get_events = true);
+
+    /// Completions waiting to be reaped.
+    std::uint32_t ready() const { return __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE) - *m_cq_head; }
+    /// Call f(const io_uring_cqe&) for each available completion, returns
+    /// how many.  No system call.
+    template <typename F>
+    inline std::uint32_t for_each_cqe(F&& f);
+
+    /// Provide count buffers of size bytes to the kernel as buffer group
+    /// bgid; count must be a power of two.
+    bool register_buffers(std::uint16_t bgid, std::uint16_t count, std::uint32_t size);
+    std::uint8_t * buffer(std::uint16_t bid) { return m_buffers + static_cast<std::size_t>(bid) * m_buffer_size; }
+    std::uint32_t buffer_size() const { return m_buffer_size; }
+    /// Give a buffer back to the kernel; visible to it after
+    /// commit_buffers().
+    inline void recycle_buffer(std::uint16_t bid);
+    inline void commit_buffers();
+
+private:
+    void release_();
+
+private:
+    int m_fd;
+    std::uint32_t m_flags;
+
+    void *m_sq_ring;
+    std::size_t m_sq_ring_size;
+    void *m_cq_ring;
+    std::size_t m_cq_ring_size;
+    ::io_uring_sqe *m_sqes;
+    std::size_t m_sqes_size;
+
+    std::uint32_t *m_sq_head;
+    std::uint32_t *m_sq_tail;
+    std::uint32_t m_sq_mask;
+    std::uint32_t m_sq_entries;
+    std::uint32_t *m_cq_head;
+    std::uint32_t *m_cq_tail;
+    std::uint32_t m_cq_mask;
+    ::io_uring_cqe *m_cqes;
+    /// SQEs handed out, and those already submitted.
+    std::uint32_t m_sqe_tail;
+    std::uint32_t m_sqe_head;
+
+    std::uint16_t m_bgid;
+    ::io_uring_buf_ring *m_buf_ring;
+    std::size_t m_buf_ring_size;
+    std::uint16_t m_buf_mask;
+    std::uint16_t m_buf_tail;
+    std::uint8_t *m_buffers;
+    std::size_t m_buffers_size;
+    std::uint32_t m_buffer_size;
+};
+
+::io_uring_sqe * IOUring::get_sqe()
+{
+    const std::uint32_t head = __atomic_load_n(m_sq_head, __ATOMIC_ACQUIRE);
+    if (UNLIKELY(m_sqe_tail - head >= m_sq_entries))
+        return nullptr;
+    ::io_uring_sqe *sqe = &m_sqes[m_sqe_tail & m_sq_mask];
+    ++m_sqe_tail;
+    *sqe = ::io_uring_sqe();
+    return sqe;
+}
+
+template <typename F>
+std::uint32_t IOUring::for_each_cqe(F&& f)
+{
+    std::uint32_t head = *m_cq_head;
+    const std::uint32_t tail = __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE);
+    const std::uint32_t n = tail - head;
+    for (; head != tail; ++head) {
+        f(m_cqes[head & m_cq_mask]);
+    }
+    __atomic_store_n(m_cq_head, head, __ATOMIC_RELEASE);
+    return n;
+}
+
+void IOUring::recycle_buffer(std::uint16_t bid)
+{
+    // not m_buf_ring->bufs: in C++ the header's flexible array member
+    // is preceded by a one byte empty struct, and so misplaced.
+    ::io_uring_buf& b = reinterpret_cast< ::io_uring_buf *>(m_buf_ring)[m_buf_tail & m_buf_mask];
+    b.addr = reinterpret_cast<std::uint64_t>(buffer(bid));
+    b.len = m_buffer_size;
+    b.bid = bid;
+    ++m_buf_tail;
+}
+
+void IOUring::commit_buffers()
+{
+    __atomic_store_n(&m_buf_ring->tail, m_buf_tail, __ATOMIC_RELEASE);
+}
+
+}}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <i01_core/Time.hpp>
+
+namespace i01 { namespace net { namespace pcap {
+
+/// A pcap record in place in a MappedReader's mapping.
+struct MappedRecord {
+    /// Writable: the mapping is private, so a decoder that rewrites a
+    /// packet only copies that page.
+    std::uint8_t *data;
+    std::uint32_t caplen;
+    std::uint32_t len;
+    core::Timestamp ts;
+};
+
+/// Reads an uncompressed pcap capture (microsecond or nanosecond, in this
+/// host's byte order) by mapping it whole and walking the records in
+/// place, with no copy and no system call per record.  The kernel is told
+/// the mapping is read sequentially, so it reads ahead aggressively and
+/// drops pages behind.  LZ4-compressed captures still need pcap::Reader.
+class MappedReader {
+public:
+    /// Throws std::runtime_error if filename can not be mapped or is not
+    /// such a capture.
+    explicit MappedReader(const std::string& filename);
+    ~MappedReader();
+
+    MappedReader(const MappedReader&) = delete;
+    MappedReader& operator=(const MappedReader&) = delete;
+
+    const std::string& filename() const { return m_filename; }
+    std::size_t size() const { return m_size; }
+    bool nanosecond() const { return m_nanosecond; }
+
+    /// The next record, valid as long as the reader, or false at the end
+    /// of the capture (or at a record cut short by it).
+    bool next(MappedRecord& rec);
+
+    /// Offset of the next record, as pcap::Reader::tell() and
+    /// pcap::IndexEntry give it.
+    std::uint64_t tell() const { return m_pos; }
+    /// Continue at a record offset, false if it is outside the capture.
+    bool seek(std::uint64_t offset);
+
+    std::uint64_t bytes_read() const { return m_bytes_read; }
+
+private:
+    std::string m_filename;
+    std::uint8_t *m_data;
+    std::size_t m_size;
+    std::size_t m_pos;
+    bool m_nanosecond;
+    std::uint64_t m_bytes_read;
+};
+
+} } }
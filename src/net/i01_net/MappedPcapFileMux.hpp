@@ -0,0 +1,235 @@
+#pragma once
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <linux/if_ether.h>
+
+#include <i01_core/macro.hpp>
+#include <i01_core/TournamentTree.hpp>
+
+#include <i01_net/IPAddress.hpp>
+#include <i01_net/MappedPcap.hpp>
+#include <i01_net/Pcap.hpp>
+#include <i01_net/PcapFileMux.hpp>
+#include <i01_net/PcapIndex.hpp>
+
+namespace i01 { namespace net {
+
+/// PcapFileMux for uncompressed captures: each file is mapped whole
+/// (pcap::MappedReader) rather than read through libpcap, and the files
+/// are merged with a tournament tree rather than a priority queue, so
+/// replaying a packet costs no copy and log2(files) comparisons.  The
+/// listener gets pointers into the mappings, valid until the mux is
+/// destroyed.
+template<typename ListenerType>
+class MappedPcapFileMux : public FileMuxBase, public UDPPktListener<MappedPcapFileMux<ListenerType> > {
+public:
+    using Demux = pcap::UDPDemux<MappedPcapFileMux<ListenerType> >;
+
+private:
+    struct FileEntry {
+        std::unique_ptr<pcap::MappedReader> reader;
+        Demux demux;
+        LatencyNS latency;
+        /// The next packet, if tree.key() is not the sentinel.
+        UDPPkt pkt;
+    };
+    using FileContainer = std::vector<std::unique_ptr<FileEntry> >;
+    using Tree = core::TournamentTree<Timestamp>;
+
+public:
+    /// Throws std::runtime_error if a file is not an uncompressed capture.
+    MappedPcapFileMux(const FileWithLatencyContainer &files, ListenerType *listener);
+    MappedPcapFileMux(const std::set<std::string>& files, ListenerType* listener, LatencyNS = 0);
+
+    virtual ~MappedPcapFileMux() = default;
+
+    void handle_payload(std::uint32_t src_addr, std::uint16_t src_port, std::uint32_t addr, std::uint16_t port, std::uint8_t *buf, size_t len, const Timestamp *ts);
+
+    /// Files with a packet still to replay.
+    std::size_t packets_enqueued() const;
+    /// The next packet, if packets_enqueued().
+    const UDPPkt& top() const { return m_files[m_tree.winner()]->pkt; }
+
+    void listener(ListenerType *l) { m_listener = l; }
+
+    /// Record bytes walked across all the files.
+    std::uint64_t bytes_read() const;
+
+    virtual bool seek(const Timestamp &ts) override final;
+
+    /// As PcapFileMux::index_interval_ms().
+    void index_interval_ms(std::uint32_t ms) { m_index_interval_ms = ms; }
+    /// As PcapFileMux::index_dir().
+    void index_dir(const std::string& dir) { m_index_dir = dir; }
+
+protected:
+    virtual bool read_next_packet() override final;
+
+    /// Load file i's next UDP packet into the tree.
+    void advance(std::size_t i);
+
+    void initial_file_load();
+
+    static Timestamp end_of_file() { return Timestamp{std::numeric_limits<time_t>::max(), 0}; }
+
+protected:
+    FileContainer m_files;
+    Tree m_tree;
+    /// By file, loaded on the first seek().
+    std::vector<std::unique_ptr<pcap::Index> > m_indexes;
+    std::uint32_t m_index_interval_ms;
+    std::string m_index_dir;
+    bool m_handled;
+    FileEntry* m_current;
+    ListenerType * m_listener;
+};
+
+template<typename LT>
+MappedPcapFileMux<LT>::MappedPcapFileMux(const FileWithLatencyContainer& files, LT *l) :
+    m_index_interval_ms(pcap::Index::DEFAULT_INTERVAL_MS),
+    m_handled(false),
+    m_current(nullptr),
+    m_listener(l)
+{
+    m_filenames = files;
+    initial_file_load();
+}
+
+template<typename LT>
+MappedPcapFileMux<LT>::MappedPcapFileMux(const std::set<std::string>& files, LT *l, LatencyNS latency) :
+    m_index_interval_ms(pcap::Index::DEFAULT_INTERVAL_MS),
+    m_handled(false),
+    m_current(nullptr),
+    m_listener(l)
+{
+    std::transform(files.begin(), files.end(), std::inserter(m_filenames, m_filenames.begin()), [latency](const std::string& s) -> FileWithLatency { return {s, latency};});
+    initial_file_load();
+}
+
+template<typename LT>
+void MappedPcapFileMux<LT>::initial_file_load()
+{
+    for (const auto& f : m_filenames) {
+        m_files.emplace_back(std::unique_ptr<FileEntry>(new FileEntry{
+                    std::unique_ptr<pcap::MappedReader>(new pcap::MappedReader(f.first)), Demux(this), f.second, UDPPkt()}));
+    }
+    m_tree.reset(m_files.size(), end_of_file());
+    for (std::size_t i = 0; i < m_files.size(); ++i)
+        advance(i);
+}
+
+template<typename LT>
+void MappedPcapFileMux<LT>::advance(std::size_t i)
+{
+    m_current = m_files[i].get();
+    pcap::MappedRecord rec;
+    // walk records until one is handled in our UDP callback:
+    m_handled = false;
+    while (!m_handled && m_current->reader->next(rec)) {
+        // pcap::Reader stops at a record cut short by the snap length;
+        // here it is just skipped:
+        if (UNLIKELY(rec.caplen != rec.len || rec.caplen < sizeof(struct ethhdr)))
+            continue;
+        std::uint16_t proto = 0;
+        const std::uint32_t header_size = pcap::ethernet_header(rec.data, proto);
+        m_current->demux.handle_eth_payload(proto, rec.data + header_size, rec.caplen - header_size, &rec.ts);
+    }
+    m_tree.update(i, m_handled ? m_current->pkt.ts : end_of_file());
+}
+
+template<typename LT>
+std::size_t MappedPcapFileMux<LT>::packets_enqueued() const
+{
+    std::size_t n = 0;
+    for (std::size_t i = 0; i < m_files.size(); ++i)
+        n += m_tree.key(i) < end_of_file() ? 1 : 0;
+    return n;
+}
+
+template<typename LT>
+std::uint64_t MappedPcapFileMux<LT>::bytes_read() const
+{
+    std::uint64_t n = 0;
+    for (const auto& f : m_files)
+        n += f->reader->bytes_read();
+    return n;
+}
+
+template<typename LT>
+bool MappedPcapFileMux<LT>::read_next_packet()
+{
+    if (m_tree.empty())
+        return false;
+    const std::size_t i = m_tree.winner();
+    FileEntry* f = m_files[i].get();
+    const UDPPkt & pkt = f->pkt;
+    if (pkt.ts < m_last_ts) {
+        std::cerr << "mappedpcapfilemux: packet is before last event " << pkt.ts << " " << m_last_ts << " " << ip_addr_to_str(f->demux.last_channel().second) << std::endl;
+    }
+    m_last_ts = pkt.ts;
+
+    core::Timestamp::last_event(m_last_ts);
+
+    // need to call this before we dispatch the pkt since it could
+    // trigger a timer callback for a time that is before the pkt
+    // time
+    update_timers();
+
+    m_listener->handle_payload(pkt.src_addr, pkt.src_port, pkt.addr, pkt.port, pkt.buf, pkt.len, &pkt.ts);
+
+    advance(i);
+    return true;
+}
+
+template<typename LT>
+bool MappedPcapFileMux<LT>::seek(const Timestamp &ts)
+{
+    bool ok = true;
+    m_indexes.resize(m_files.size());
+    for (std::size_t i = 0; i < m_files.size(); ++i) {
+        FileEntry* f = m_files[i].get();
+        auto& index = m_indexes[i];
+        if (!index) {
+            index.reset(new pcap::Index());
+            const std::string& capture = f->reader->filename();
+            if (!index->open(capture, pcap::Index::default_path(capture, m_index_dir), m_index_interval_ms)) {
+                std::cerr << "mappedpcapfilemux: could not index " << capture << std::endl;
+                index.reset();
+            }
+        }
+        // start of the capture unless the index has something better:
+        std::uint64_t offset = sizeof(struct pcap_file_header);
+        if (index && !index->entries().empty()) {
+            // the capture time of ts for this file:
+            const pcap::IndexEntry *e = index->find(ts - Timestamp{0, f->latency});
+            offset = e ? e->offset : index->entries().front().offset;
+        } else if (!index) {
+            ok = false;
+        }
+        if (!f->reader->seek(offset)) {
+            std::cerr << "mappedpcapfilemux: could not seek " << f->reader->filename() << " to " << offset << std::endl;
+            ok = false;
+            f->reader->seek(sizeof(struct pcap_file_header));
+        }
+        advance(i);
+    }
+    m_last_ts = Timestamp{};
+    m_timer_ts = Timestamp{};
+    return ok;
+}
+
+template<typename LT>
+void MappedPcapFileMux<LT>::handle_payload(std::uint32_t src_addr, std::uint16_t src_port, std::uint32_t addr, std::uint16_t port, std::uint8_t *buf, size_t len, const Timestamp *ts)
+{
+    m_current->pkt = UDPPkt{src_addr, src_port, addr, port, buf, len, *ts + Timestamp{0, m_current->latency}};
+    m_handled = true;
+}
+
+}}
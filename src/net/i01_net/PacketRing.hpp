@@ -0,0 +1,174 @@
+#pragma once
+
+#include <linux/if_packet.h>
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+#include <pcap.h>
+
+#include <i01_core/Time.hpp>
+
+#include <i01_net/Pcap.hpp>
+
+namespace i01 { namespace net {
+
+/// Kernel counters for a PacketRing, accumulated since it was opened.
+struct PacketRingStats {
+    std::uint64_t packets;
+    std::uint64_t drops;
+    /// Times the kernel found every block still with user space.
+    std::uint64_t freezes;
+};
+std::ostream & operator<<(std::ostream &os, const PacketRingStats &s);
+
+/// Receives frames from an AF_PACKET TPACKET_V3 ring mapped into user
+/// space, for hosts without Solarflare adapters.  The kernel fills
+/// blocks of frames and hands over a whole block at a time, so
+/// read_blocks() needs no system call while blocks are ready and none
+/// per frame at all.  Frames are delivered in place, like
+/// pcap::Reader's: handle_block_() once per block with the timestamps of
+/// its first and last frames, then handle_frame_() for each frame,
+/// which by default strips the Ethernet header for handle_eth_payload_().
+///
+/// Needs CAP_NET_RAW.
+class PacketRing {
+public:
+    static const std::uint32_t DEFAULT_BLOCK_SIZE = 1 << 20;
+    static const std::uint32_t DEFAULT_BLOCK_COUNT = 64;
+    static const std::uint32_t DEFAULT_BLOCK_TIMEOUT_MS = 1;
+
+public:
+    /// Capture on interface, or on every interface if it is empty or
+    /// "any".  block_size must be a multiple of the page size.  A block
+    /// is handed over when full or block_timeout_ms after its first
+    /// frame.  Throws std::runtime_error if the ring can not be set up.
+    PacketRing( const std::string& interface
+              , std::uint32_t block_size = DEFAULT_BLOCK_SIZE
+              , std::uint32_t block_count = DEFAULT_BLOCK_COUNT
+              , std::uint32_t block_timeout_ms = DEFAULT_BLOCK_TIMEOUT_MS);
+    virtual ~PacketRing();
+
+    PacketRing(const PacketRing&) = delete;
+    PacketRing& operator=(const PacketRing&) = delete;
+
+    /// Pollable for readability, e.g. from an EventPoller.
+    int fd() const { return m_fd; }
+    const std::string& interface() const { return m_interface; }
+
+    /// Only capture frames matching a pcap-filter(7) expression, such as
+    /// "udp and dst net 224.0.62.0/24".  Frames already in the ring are
+    /// not filtered.
+    bool set_filter(const std::string& expr);
+    /// Share the interface's frames with the other rings in group, by
+    /// flow hash unless mode says otherwise (PACKET_FANOUT_*).
+    bool set_fanout(std::uint16_t group, std::uint16_t mode = PACKET_FANOUT_HASH);
+    /// Skip frames this host sends, which otherwise appear alongside
+    /// those it receives (on loopback, every frame twice).
+    bool set_ignore_outgoing(bool ignore);
+
+    /// Hand up to limit ready blocks (all if negative) to the handlers,
+    /// first waiting up to timeout_ms for one if none is ready (0 to not
+    /// wait, negative to wait indefinitely).  Returns the number of
+    /// frames, or -1 on error.
+    int read_blocks(int timeout_ms = 0, int limit = -1);
+
+    const core::Timestamp& last_ts() const { return m_ts; }
+    std::uint32_t last_pkt_len() const { return m_pkt_len; }
+    std::uint64_t blocks_read() const { return m_blocks_read; }
+    std::uint64_t bytes_read() const { return m_bytes_read; }
+
+    /// Reads the kernel's counters.
+    PacketRingStats stats();
+
+protected:
+    /// Called before the frames of each block.
+    virtual void handle_block_(std::uint32_t num_pkts, const core::Timestamp& first_ts, const core::Timestamp& last_ts) {}
+    /// frame holds caplen of the len bytes received.
+    virtual void handle_frame_(std::uint8_t *frame, std::uint32_t caplen, std::uint32_t len, const core::Timestamp *ts);
+    virtual void handle_eth_payload_(std::uint16_t proto, std::uint8_t *buf, std::size_t len, const core::Timestamp *ts) {}
+
+private:
+    void read_block_(::tpacket_block_desc *block);
+    void release_();
+
+private:
+    std::string m_interface;
+    int m_fd;
+    std::uint8_t *m_ring;
+    std::size_t m_ring_size;
+    std::uint32_t m_block_size;
+    std::uint32_t m_block_count;
+    std::uint32_t m_next_block;
+
+    core::Timestamp m_ts;
+    std::uint32_t m_pkt_len;
+    std::uint64_t m_blocks_read;
+    std::uint64_t m_bytes_read;
+    PacketRingStats m_stats;
+};
+
+/// A PacketRing that passes UDP datagrams to a UDPPktListener, as
+/// pcap::UDPReader does for captures, so live frames can drive the same
+/// decoders.
+template<typename HandlerType>
+class UDPPacketRing : public PacketRing {
+public:
+    typedef typename pcap::UDPDemux<HandlerType>::channel_type channel_type; // (src, dst)
+
+public:
+    UDPPacketRing( const std::string& interface
+                 , HandlerType *handler
+                 , std::uint32_t block_size = DEFAULT_BLOCK_SIZE
+                 , std::uint32_t block_count = DEFAULT_BLOCK_COUNT
+                 , std::uint32_t block_timeout_ms = DEFAULT_BLOCK_TIMEOUT_MS) :
+        PacketRing(interface, block_size, block_count, block_timeout_ms),
+        m_demux(handler)
+    {
+        // a feed source has no use for what this host publishes:
+        set_ignore_outgoing(true);
+    }
+
+    channel_type last_channel() const { return m_demux.last_channel(); }
+
+private:
+    void handle_eth_payload_(std::uint16_t proto, std::uint8_t *buf, std::size_t len, const core::Timestamp *ts) override final {
+        m_demux.handle_eth_payload(proto, buf, len, ts);
+    }
+
+private:
+    pcap::UDPDemux<HandlerType> m_demux;
+};
+
+namespace pcap {
+
+/// Writes every frame from a PacketRing to a nanosecond pcap file, which
+/// pcap::Reader and PcapFileMux read back.
+class RingWriter : public PacketRing {
+public:
+    /// Throws std::runtime_error if path can not be opened.
+    RingWriter( const std::string& interface
+              , const std::string& path
+              , std::uint32_t block_size = DEFAULT_BLOCK_SIZE
+              , std::uint32_t block_count = DEFAULT_BLOCK_COUNT
+              , std::uint32_t block_timeout_ms = DEFAULT_BLOCK_TIMEOUT_MS);
+    virtual ~RingWriter();
+
+    const std::string& path() const { return m_path; }
+    std::uint64_t packets_written() const { return m_packets_written; }
+    bool flush();
+
+private:
+    void handle_frame_(std::uint8_t *frame, std::uint32_t caplen, std::uint32_t len, const core::Timestamp *ts) override final;
+
+private:
+    std::string m_path;
+    ::pcap_t *m_pcap_p;
+    ::pcap_dumper_t *m_dumper_p;
+    std::uint64_t m_packets_written;
+};
+
+}
+
+} }
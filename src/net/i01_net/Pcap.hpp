@@ -1,6 +1,8 @@
 #pragma once
 
+#include <cstdint>
 #include <unordered_map>
+#include <vector>
 
 #include <pcap.h>
 #include <string>
@@ -21,7 +23,7 @@ namespace i01 { namespace net { namespace pcap {
 class Reader {
 public:
     Reader() = delete;
-    Reader(const std::string &filename);
+    Reader(const std::string &filename, const core::LZ4::ReadAhead& ra = core::LZ4::ReadAhead());
     virtual ~Reader() {}
     int read_packets(int limit = -1);
 
@@ -29,6 +31,20 @@ public:
     std::uint32_t last_pkt_len() const { return m_pkt_len; }
 
     std::uint32_t bytes_read() const { return m_bytes_read; }
+
+    const std::string& filename() const { return m_filename; }
+
+    /// Offset of the next record in the (decompressed) file, 0 once the
+    /// whole file has been read.
+    std::uint64_t tell() const;
+    /// Continue reading at a record offset returned by tell(), reopening
+    /// the file if it had been read to the end.
+    bool seek(std::uint64_t offset);
+
+    /// See core::pcap::FileReader::checkpoints().  Kept once the file has
+    /// been read to the end.
+    std::vector<core::LZ4::Checkpoint> checkpoints() const;
+    void checkpoints(const std::vector<core::LZ4::Checkpoint>& cps);
 protected:
     std::uint8_t ip_hdr_size_(const struct iphdr *hdr) const {
         return static_cast<std::uint8_t>(4u*(hdr->ihl & 0x0FU));
@@ -43,36 +59,54 @@ private:
 
 private:
     std::string m_filename;
+    core::LZ4::ReadAhead m_read_ahead;
     char m_errbuf[PCAP_ERRBUF_SIZE];
     core::pcap::FileReader *m_pcap_p = nullptr;
     i01::core::Timestamp m_ts = {0,0};
     std::uint32_t m_pkt_len = 0;
     std::uint32_t m_bytes_read = 0;
+    std::vector<core::LZ4::Checkpoint> m_checkpoints;
 };
 
+/// Size of the Ethernet header, and any 802.1Q tag, at the start of
+/// frame; sets proto to the EtherType of what follows.
+inline std::uint32_t ethernet_header(const std::uint8_t *frame, std::uint16_t& proto)
+{
+    const struct ethhdr *eth_p = reinterpret_cast<const struct ethhdr *>(frame);
+    proto = ntohs(eth_p->h_proto);
+    std::uint32_t header_size = sizeof(struct ethhdr);
+    if (ETH_P_8021Q == proto) {
+        // vlan extended header
+        // just skip the next two bytes to find the next protocol
+        header_size += 4;
+        proto = ntohs(*reinterpret_cast<const std::uint16_t *>(frame + sizeof(struct ethhdr) + 2));
+    }
+    return header_size;
+}
+
+/// Passes the UDP datagrams among Ethernet payloads to a UDPPktListener,
+/// for whatever reads the frames: UDPReader from a capture file,
+/// UDPPacketRing from a live interface.
 template<typename HandlerType>
-class UDPReader : public Reader {
+class UDPDemux {
 public:
     typedef std::pair<ip_addr_port_type, ip_addr_port_type> channel_type; // (src, dst)
-    channel_type make_channel(std::uint32_t src_addr, std::uint16_t src_port, std::uint32_t dst_addr, std::uint16_t dst_port) {
+    static channel_type make_channel(std::uint32_t src_addr, std::uint16_t src_port, std::uint32_t dst_addr, std::uint16_t dst_port) {
         return {std::make_pair(src_addr, src_port), std::make_pair(dst_addr, dst_port)};
     }
 
 public:
-    UDPReader(const std::string &filename, HandlerType *handler) :
-        Reader(filename),
-        m_udp_handler_p(handler) {}
+    UDPDemux(HandlerType *handler) : m_udp_handler_p(handler) {}
 
     channel_type last_channel() const { return m_last_channel; }
 
-private:
-    void handle_eth_payload_(std::uint16_t proto, std::uint8_t *buf, std::size_t len, const i01::core::Timestamp *ts) {
+    void handle_eth_payload(std::uint16_t proto, std::uint8_t *buf, std::size_t len, const i01::core::Timestamp *ts) {
 
         if (ETH_P_IP != proto) {
             return;
         }
         const struct iphdr *ip = reinterpret_cast<const struct iphdr *>(buf);
-        std::uint8_t ip_hdr_size = ip_hdr_size_(ip);
+        std::uint8_t ip_hdr_size = static_cast<std::uint8_t>(4u*(ip->ihl & 0x0FU));
 
         m_ip_src_addr = ip->saddr;
         m_ip_dst_addr = ip->daddr;
@@ -91,7 +125,6 @@ private:
         }
     }
 
-
 private:
     HandlerType *m_udp_handler_p;
 
@@ -103,5 +136,30 @@ private:
     channel_type m_last_channel;
 };
 
+template<typename HandlerType>
+class UDPReader : public Reader {
+public:
+    typedef typename UDPDemux<HandlerType>::channel_type channel_type; // (src, dst)
+    channel_type make_channel(std::uint32_t src_addr, std::uint16_t src_port, std::uint32_t dst_addr, std::uint16_t dst_port) {
+        return UDPDemux<HandlerType>::make_channel(src_addr, src_port, dst_addr, dst_port);
+    }
+
+public:
+    UDPReader(const std::string &filename, HandlerType *handler, const core::LZ4::ReadAhead& ra = core::LZ4::ReadAhead()) :
+        Reader(filename, ra),
+        m_demux(handler) {}
+
+    channel_type last_channel() const { return m_demux.last_channel(); }
+
+private:
+    void handle_eth_payload_(std::uint16_t proto, std::uint8_t *buf, std::size_t len, const i01::core::Timestamp *ts) {
+        m_demux.handle_eth_payload(proto, buf, len, ts);
+    }
+
+
+private:
+    UDPDemux<HandlerType> m_demux;
+};
+
 
 }}}
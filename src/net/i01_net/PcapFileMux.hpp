@@ -2,6 +2,7 @@
 #include <string.h>
 
 #include <algorithm>
+#include <deque>
 #include <queue>
 #include <string>
 #include <set>
@@ -12,9 +13,11 @@
 #include <boost/filesystem.hpp>
 
 #include <i01_core/TimerListener.hpp>
+#include <i01_core/TimerWheel.hpp>
 
 #include <i01_net/IPAddress.hpp>
 #include <i01_net/Pcap.hpp>
+#include <i01_net/PcapIndex.hpp>
 
 namespace i01 { namespace net {
 
@@ -37,24 +40,51 @@ public:
     };
 
     using TimerListener = core::TimerListener;
-    struct TimerListenerEntry {
+    /// Fires a registered listener from m_timers with the replay clock
+    /// set to the timer's time.
+    struct TimerListenerEntry : public TimerListener {
         TimerListener * listener;
         void * userdata;
-        std::uint64_t iter;
+
+        TimerListenerEntry(TimerListener *l, void *u) : listener(l), userdata(u) {}
+        virtual void on_timer(const Timestamp& ts, void *, std::uint64_t iter) override
+        {
+            core::Timestamp::last_event(ts);
+            listener->on_timer(ts, userdata, iter);
+        }
     };
 
-    using TimerListenerContainer = std::vector<TimerListenerEntry>;
+    /// A deque, so that entries stay put in m_timers.
+    using TimerListenerContainer = std::deque<TimerListenerEntry>;
+
+    /// Registered timers fire every second of packet time from the first
+    /// packet.
+    static Timestamp timer_interval() { return Timestamp{1, 0}; }
 
 public:
-    FileMuxBase() = default;
+    /// The timer wheel ticks in nanoseconds, so timers fire between the
+    /// same packets they would at any resolution.
+    FileMuxBase() : m_timers(1) {}
     virtual ~FileMuxBase() = default;
 
     int read_packets(int num = -1);
     int read_packets_until(const Timestamp &ts);
 
+    /// Skip ahead (or back) to ts without reading the packets in between:
+    /// every capture moves to its last index entry at or before ts, less
+    /// its latency, so that reading resumes at most an index interval of
+    /// packets before ts.  Packets skipped are not dispatched and timers
+    /// do not fire for the time skipped.  Listener state, such as books,
+    /// is not rebuilt; MD::Archive::Reader::skip_until() does that from an
+    /// archive.  Returns false if a capture had to start over because it
+    /// could not be indexed or repositioned.
+    virtual bool seek(const Timestamp &ts) = 0;
+
     void register_timer(TimerListener *listener, void *userdata);
 
 protected:
+    /// Fire the timers due by m_last_ts; after a seek(), which clears
+    /// m_timer_ts, restart them from m_last_ts.
     void update_timers();
 
 private:
@@ -63,9 +93,11 @@ private:
 protected:
     FileWithLatencyContainer m_filenames;
     TimerListenerContainer m_timer_listeners;
+    core::TimerWheel m_timers;
 
     Timestamp m_stop_ts;
     Timestamp m_last_ts;
+    /// When the timers started, or zero before the first packet.
     Timestamp m_timer_ts;
 };
 
@@ -93,8 +125,10 @@ public:
     using PktQueue = std::priority_queue<PktEntry, std::vector<PktEntry>, std::greater<PktEntry> >;
 
 public:
-    PcapFileMux(const FileWithLatencyContainer &files, ListenerType *listener);
-    PcapFileMux(const std::set<std::string>& files, ListenerType* listener, LatencyNS = 0);
+    /// LZ4-compressed captures are decompressed ahead of replay as ra
+    /// says, see core::LZ4::ReadAhead.
+    PcapFileMux(const FileWithLatencyContainer &files, ListenerType *listener, const core::LZ4::ReadAhead& ra = core::LZ4::ReadAhead());
+    PcapFileMux(const std::set<std::string>& files, ListenerType* listener, LatencyNS = 0, const core::LZ4::ReadAhead& ra = core::LZ4::ReadAhead());
 
     virtual ~PcapFileMux() = default;
 
@@ -106,6 +140,14 @@ public:
 
     void listener(ListenerType *l) { m_listener = l; }
 
+    virtual bool seek(const Timestamp &ts) override final;
+
+    /// Interval of the indexes seek() builds for captures without one.
+    void index_interval_ms(std::uint32_t ms) { m_index_interval_ms = ms; }
+    /// Where seek() looks for and saves indexes, instead of next to the
+    /// captures.
+    void index_dir(const std::string& dir) { m_index_dir = dir; }
+
 protected:
     virtual bool read_next_packet() override final ;
 
@@ -115,6 +157,11 @@ protected:
 
 protected:
     ReaderContainer m_readers;
+    /// By reader, loaded on the first seek().
+    std::vector<std::unique_ptr<pcap::Index> > m_indexes;
+    std::uint32_t m_index_interval_ms;
+    std::string m_index_dir;
+    core::LZ4::ReadAhead m_read_ahead;
     bool m_handled;
     ReaderEntry* m_current_reader;
     ListenerType * m_listener;
@@ -122,7 +169,9 @@ protected:
 };
 
 template<typename LT>
-PcapFileMux<LT>::PcapFileMux(const FileWithLatencyContainer& files, LT *l) :
+PcapFileMux<LT>::PcapFileMux(const FileWithLatencyContainer& files, LT *l, const core::LZ4::ReadAhead& ra) :
+    m_index_interval_ms(pcap::Index::DEFAULT_INTERVAL_MS),
+    m_read_ahead(ra),
     m_handled(false),
     m_listener(l)
 {
@@ -131,7 +180,9 @@ PcapFileMux<LT>::PcapFileMux(const FileWithLatencyContainer& files, LT *l) :
 }
 
 template<typename LT>
-PcapFileMux<LT>::PcapFileMux(const std::set<std::string>& files, LT *l, LatencyNS latency) :
+PcapFileMux<LT>::PcapFileMux(const std::set<std::string>& files, LT *l, LatencyNS latency, const core::LZ4::ReadAhead& ra) :
+    m_index_interval_ms(pcap::Index::DEFAULT_INTERVAL_MS),
+    m_read_ahead(ra),
     m_handled(false),
     m_listener(l)
 {
@@ -143,7 +194,7 @@ template<typename LT>
 void PcapFileMux<LT>::initial_reader_load()
 {
     for (auto f : m_filenames) {
-        auto reader = std::unique_ptr<UDPReader>(new UDPReader(f.first, this));
+        auto reader = std::unique_ptr<UDPReader>(new UDPReader(f.first, this, m_read_ahead));
         m_readers.emplace_back(std::unique_ptr<ReaderEntry>(new ReaderEntry{std::move(reader), f.second}));
         packets_from_reader(m_readers.back().get());
     }
@@ -203,7 +254,47 @@ bool PcapFileMux<LT>::read_next_packet()
     }
 }
 
-
+template<typename LT>
+bool PcapFileMux<LT>::seek(const Timestamp &ts)
+{
+    bool ok = true;
+    // the queued packets point into the readers' buffers:
+    PktQueue().swap(m_queue);
+    m_indexes.resize(m_readers.size());
+    for (std::size_t i = 0; i < m_readers.size(); ++i) {
+        ReaderEntry* r = m_readers[i].get();
+        auto& index = m_indexes[i];
+        if (!index) {
+            index.reset(new pcap::Index());
+            const std::string& capture = r->first->filename();
+            if (index->open(capture, pcap::Index::default_path(capture, m_index_dir), m_index_interval_ms)) {
+                r->first->checkpoints(index->checkpoints());
+            } else {
+                std::cerr << "pcapfilemux: could not index " << r->first->filename() << std::endl;
+                index.reset();
+            }
+        }
+        // start of the capture unless the index has something better:
+        std::uint64_t offset = sizeof(struct pcap_file_header);
+        if (index && !index->entries().empty()) {
+            // the capture time of ts for this reader:
+            const pcap::IndexEntry *e = index->find(ts - Timestamp{0, r->second});
+            offset = e ? e->offset : index->entries().front().offset;
+        } else if (!index) {
+            ok = false;
+        }
+        if (!r->first->seek(offset)) {
+            std::cerr << "pcapfilemux: could not seek " << r->first->filename() << " to " << offset << std::endl;
+            ok = false;
+            if (!r->first->seek(sizeof(struct pcap_file_header)))
+                continue;
+        }
+        packets_from_reader(r);
+    }
+    m_last_ts = Timestamp{};
+    m_timer_ts = Timestamp{};
+    return ok;
+}
 
 template<typename LT>
 void PcapFileMux<LT>::handle_payload(std::uint32_t src_addr, std::uint16_t src_port, std::uint32_t addr, std::uint16_t port, std::uint8_t *buf, size_t len, const Timestamp *ts)
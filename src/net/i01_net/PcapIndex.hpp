@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include <i01_core/LZ4.hpp>
+#include <i01_core/Time.hpp>
+
+namespace i01 { namespace net { namespace pcap {
+
+/// Sidecar time index of a pcap (or pcap.lz4) capture, by default next
+/// to it as "<capture>.idx":
+///
+///     IndexHeader | IndexEntry[num_entries] | core::LZ4::Checkpoint[num_checkpoints]
+///
+/// in host byte order.  There is an entry for the first record of every
+/// interval of capture time that has any records, giving the offset of
+/// the record in the decompressed file; the LZ4 checkpoints let a reader
+/// start decompressing close to any entry.  Records are assumed to be in
+/// time order within the capture, as PcapFileMux does.
+struct IndexHeader {
+    std::uint32_t magic_number;
+    std::uint32_t version;
+    std::uint32_t interval_ms;
+    std::uint32_t reserved;
+    /// Size and modification time of the capture when indexed.
+    std::uint64_t source_size;
+    std::int64_t source_mtime;
+    std::uint64_t num_entries;
+    std::uint64_t num_checkpoints;
+} __attribute__((packed));
+std::ostream & operator<<(std::ostream &, const IndexHeader &);
+
+struct IndexEntry {
+    /// Nanoseconds since the epoch.
+    std::uint64_t timestamp;
+    std::uint64_t offset;
+} __attribute__((packed));
+
+class Index {
+public:
+    static const std::uint32_t MAGIC_NUMBER = 0x1DC0FFEE;
+    static const std::uint32_t VERSION_NUMBER = 0x01;
+    static const std::uint32_t DEFAULT_INTERVAL_MS = 100;
+
+    /// "<capture>.idx", or "<dir>/<capture file name>.idx".
+    static std::string default_path(const std::string& capture, const std::string& dir = std::string());
+
+public:
+    Index();
+
+    /// Read the index at path, returns false if it is missing, corrupt, or
+    /// does not match capture as it is now.
+    bool load(const std::string& path, const std::string& capture);
+    bool save(const std::string& path) const;
+    /// Index capture by reading it from the start.
+    bool build(const std::string& capture, std::uint32_t interval_ms = DEFAULT_INTERVAL_MS);
+    /// Load the index at path, or build it and try to save it there.  A
+    /// saved index is used whatever its interval.
+    bool open(const std::string& capture, const std::string& path, std::uint32_t interval_ms = DEFAULT_INTERVAL_MS);
+
+    /// The last entry at or before ts, nullptr if the capture starts after
+    /// ts or has no records.
+    const IndexEntry* find(const core::Timestamp& ts) const;
+
+    const IndexHeader& header() const { return m_header; }
+    const std::vector<IndexEntry>& entries() const { return m_entries; }
+    const std::vector<core::LZ4::Checkpoint>& checkpoints() const { return m_checkpoints; }
+
+private:
+    static bool stat_(const std::string& capture, std::uint64_t& size, std::int64_t& mtime);
+
+private:
+    IndexHeader m_header;
+    std::vector<IndexEntry> m_entries;
+    std::vector<core::LZ4::Checkpoint> m_checkpoints;
+};
+
+}}}
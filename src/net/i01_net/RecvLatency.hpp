@@ -0,0 +1,143 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+
+#include <i01_core/Time.hpp>
+
+namespace i01 { namespace net {
+
+/// Histogram of socket queueing latency, the time from the kernel
+/// timestamping a datagram to the poller dequeuing it, in power of two
+/// nanosecond buckets: bucket i counts latencies in [2^(i-1), 2^i), bucket
+/// 0 counts zero (or negative, if the clocks disagree) latencies.
+///
+/// One thread adds, the poller's, while any thread may read or merge it:
+/// the counters are relaxed atomics that only the adding thread writes, so
+/// an add costs the same plain loads and stores as before, and a reader
+/// sees each counter whole, if not all of them from the same instant.
+class RecvLatencyHistogram {
+public:
+    static const unsigned NUM_BUCKETS = 64;
+
+    RecvLatencyHistogram() { reset(); }
+    RecvLatencyHistogram(const RecvLatencyHistogram& o) { reset(); merge(o); }
+    RecvLatencyHistogram& operator=(const RecvLatencyHistogram& o)
+    {
+        if (this != &o) {
+            reset();
+            merge(o);
+        }
+        return *this;
+    }
+
+    void reset()
+    {
+        for (auto& b : m_buckets)
+            b.store(0, std::memory_order_relaxed);
+        m_count.store(0, std::memory_order_relaxed);
+        m_sum_ns.store(0, std::memory_order_relaxed);
+        m_max_ns.store(0, std::memory_order_relaxed);
+    }
+
+    void add(const core::Timestamp& kernel_ts, const core::Timestamp& dequeue_ts)
+    {
+        std::int64_t ns = (static_cast<std::int64_t>(dequeue_ts.tv_sec) - kernel_ts.tv_sec) * 1000000000LL
+            + (dequeue_ts.tv_nsec - kernel_ts.tv_nsec);
+        add(ns > 0 ? static_cast<std::uint64_t>(ns) : 0);
+    }
+
+    /// Only from the thread that owns the histogram.
+    void add(std::uint64_t ns)
+    {
+        bump_(m_buckets[bucket(ns)], 1);
+        bump_(m_count, 1);
+        bump_(m_sum_ns, ns);
+        if (ns > load_(m_max_ns))
+            m_max_ns.store(ns, std::memory_order_relaxed);
+    }
+
+    /// Add o's counts to this one, which must not be added to meanwhile;
+    /// o may be.
+    void merge(const RecvLatencyHistogram& o)
+    {
+        for (unsigned i = 0; i < NUM_BUCKETS; ++i)
+            bump_(m_buckets[i], load_(o.m_buckets[i]));
+        bump_(m_count, load_(o.m_count));
+        bump_(m_sum_ns, load_(o.m_sum_ns));
+        const std::uint64_t max_ns = load_(o.m_max_ns);
+        if (max_ns > load_(m_max_ns))
+            m_max_ns.store(max_ns, std::memory_order_relaxed);
+    }
+
+    static unsigned bucket(std::uint64_t ns)
+    {
+        if (0 == ns)
+            return 0;
+        const unsigned b = static_cast<unsigned>(64 - __builtin_clzll(ns));
+        return b < NUM_BUCKETS ? b : NUM_BUCKETS - 1;
+    }
+    /// Exclusive upper bound of bucket i.
+    static std::uint64_t bucket_limit(unsigned i) { return i >= 63 ? UINT64_MAX : (1ULL << i); }
+
+    std::uint64_t count() const { return load_(m_count); }
+    std::uint64_t operator[](unsigned i) const { return load_(m_buckets[i]); }
+    std::uint64_t max_ns() const { return load_(m_max_ns); }
+    std::uint64_t mean_ns() const
+    {
+        const std::uint64_t n = count();
+        return n ? load_(m_sum_ns) / n : 0;
+    }
+
+    /// Upper bound of the bucket holding the p-th (0 <= p <= 1) latency,
+    /// so within a factor of two above the true percentile.
+    std::uint64_t percentile_ns(double p) const
+    {
+        const std::uint64_t n = count();
+        const std::uint64_t max = max_ns();
+        if (0 == n)
+            return 0;
+        std::uint64_t rank = static_cast<std::uint64_t>(p * static_cast<double>(n - 1)) + 1;
+        std::uint64_t seen = 0;
+        for (unsigned i = 0; i < NUM_BUCKETS; ++i) {
+            seen += (*this)[i];
+            if (seen >= rank)
+                return i ? (bucket_limit(i) < max ? bucket_limit(i) : max) : 0;
+        }
+        return max;
+    }
+
+private:
+    typedef std::atomic<std::uint64_t> Counter;
+
+    static std::uint64_t load_(const Counter& c) { return c.load(std::memory_order_relaxed); }
+    /// Not a read-modify-write: there is one writer.
+    static void bump_(Counter& c, std::uint64_t n) { c.store(load_(c) + n, std::memory_order_relaxed); }
+
+private:
+    Counter m_buckets[NUM_BUCKETS];
+    Counter m_count;
+    Counter m_sum_ns;
+    Counter m_max_ns;
+};
+
+inline std::ostream & operator<<(std::ostream &os, const RecvLatencyHistogram &h)
+{
+    os << "count=" << h.count()
+       << ",mean_ns=" << h.mean_ns()
+       << ",p50_ns<=" << h.percentile_ns(0.5)
+       << ",p99_ns<=" << h.percentile_ns(0.99)
+       << ",max_ns=" << h.max_ns()
+       << ",buckets=";
+    bool first = true;
+    for (unsigned i = 0; i < RecvLatencyHistogram::NUM_BUCKETS; ++i) {
+        if (h[i]) {
+            os << (first ? "" : " ") << "<" << RecvLatencyHistogram::bucket_limit(i) << ":" << h[i];
+            first = false;
+        }
+    }
+    return os;
+}
+
+}}
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <etherfabric/base.h>
+
+#include <i01_core/Time.hpp>
+
+namespace i01 { namespace net { namespace sfcemu {
+
+/// Frame sources for the software ef_vi in src/net/efemu, which stands in
+/// for OpenOnload in builds configured with I01_EFVI_EMULATION where it is
+/// not installed, so that SFCInterface, SFCVISet and SFCVirtualInterface
+/// run unchanged on any host: frames are copied into the SFCPktBufs
+/// posted to the receive queue, with the receive prefix, RX, RX_DISCARD
+/// and RX_NO_DESC_TRUNC events and hardware timestamps a Solarflare
+/// adapter would produce.  Only receiving is emulated.
+
+/// A frame on an emulated wire.  data stays valid until the next call to
+/// the Source's next().
+struct Frame {
+    const std::uint8_t *data;
+    std::uint32_t len;
+    /// Stamped by the emulated adapter when not {0,0}.
+    core::Timestamp hw_ts;
+    /// EF_EVENT_RX_DISCARD_* to deliver the frame as discarded, or
+    /// NO_DISCARD.
+    int discard_type;
+
+    static const int NO_DISCARD = -1;
+};
+
+/// What an emulated port receives.
+class Source {
+public:
+    virtual ~Source() {}
+    /// The next frame, or false if there is none yet.
+    virtual bool next(Frame& f) = 0;
+};
+
+/// Replays a capture, read into memory up front so that replay costs a
+/// copy per frame and nothing else.
+class PcapSource : public Source {
+public:
+    /// Reads path, which core::pcap::FileReader can open (microsecond or
+    /// nanosecond, optionally LZ4), to be replayed loops times.  Throws
+    /// std::runtime_error if it can not be read.
+    explicit PcapSource(const std::string& path, std::uint64_t loops = 1);
+
+    /// Stamp frames with their capture timestamps (the default), or not
+    /// at all.
+    void hw_timestamps(bool on) { m_hw_timestamps = on; }
+    /// Deliver every n-th frame as discarded with type, or none if n is 0.
+    void discard_every(std::uint64_t n, int type);
+    /// Start again from the first frame and loop.
+    void rewind();
+
+    std::size_t frame_count() const { return m_frames.size(); }
+    std::size_t byte_count() const { return m_data.size(); }
+    std::uint64_t frames_delivered() const { return m_delivered; }
+
+    bool next(Frame& f) override final;
+
+private:
+    struct Record {
+        std::size_t offset;
+        std::uint32_t len;
+        core::Timestamp ts;
+    };
+
+    std::vector<std::uint8_t> m_data;
+    std::vector<Record> m_frames;
+    std::uint64_t m_loops;
+    std::uint64_t m_loop;
+    std::size_t m_pos;
+    std::uint64_t m_delivered;
+    std::uint64_t m_discard_every;
+    int m_discard_type;
+    bool m_hw_timestamps;
+};
+
+/// A single-producer, single-consumer ring of frames in POSIX shared
+/// memory, so another process (a replayer, a fuzzer, a capture bridge)
+/// can feed an emulated port.  Slots are fixed size; the producer and
+/// consumer indices sit on separate cache lines.
+class ShmFrameRing {
+public:
+    static const std::uint32_t SLOT_SIZE = 2048;
+    static const std::uint32_t DEFAULT_SLOT_COUNT = 4096;
+
+public:
+    /// Create the ring name (see shm_open(3)), replacing any existing
+    /// one, with slot_count slots, a power of two.  The creator unlinks it
+    /// when destroyed.
+    ShmFrameRing(const std::string& name, std::uint32_t slot_count);
+    /// Open the existing ring name.
+    explicit ShmFrameRing(const std::string& name);
+    ~ShmFrameRing();
+
+    ShmFrameRing(const ShmFrameRing&) = delete;
+    ShmFrameRing& operator=(const ShmFrameRing&) = delete;
+
+    const std::string& name() const { return m_name; }
+    std::uint32_t capacity() const;
+    std::uint32_t size() const;
+    /// Longest frame a slot holds.
+    static std::uint32_t max_frame_len();
+
+    /// Producer: false if the ring is full or the frame too long.
+    bool push(const void *frame, std::uint32_t len, const core::Timestamp& hw_ts = {0,0}, int discard_type = Frame::NO_DISCARD);
+
+    /// Consumer: the oldest frame, valid until pop(), or false if empty.
+    bool front(Frame& f) const;
+    void pop();
+
+private:
+    struct Header;
+    struct Slot;
+
+    static std::size_t header_size_();
+    static std::size_t ring_size_(std::uint32_t slot_count);
+    void map_(int fd, std::size_t size);
+    Slot * slot_(std::uint32_t i) const;
+
+private:
+    std::string m_name;
+    bool m_owner;
+    Header *m_hdr;
+    std::size_t m_size;
+};
+
+/// Delivers the frames pushed to a ShmFrameRing.
+class ShmRingSource : public Source {
+public:
+    explicit ShmRingSource(std::shared_ptr<ShmFrameRing> ring) : m_ring(ring), m_held(false) {}
+
+    bool next(Frame& f) override final;
+
+private:
+    std::shared_ptr<ShmFrameRing> m_ring;
+    bool m_held;
+};
+
+#ifdef I01_SFC_EMULATION
+
+/// Counters for an emulated port, accumulated since it was attached.
+struct PortStats {
+    std::uint64_t frames;
+    std::uint64_t delivered;
+    /// Delivered as RX_DISCARD, including truncated frames.
+    std::uint64_t discarded;
+    /// Matched no filter.
+    std::uint64_t unmatched;
+    /// Dropped because the receive queue had no buffers posted.
+    std::uint64_t no_desc;
+};
+std::ostream & operator<<(std::ostream &os, const PortStats &s);
+
+/// The emulated adapter delivers this many bytes at most into a receive
+/// buffer, prefix included; longer frames are truncated and discarded.
+const int RX_BUFFER_LEN = 1792;
+
+/// Feed the emulated port of interface ifindex (see Interface::index())
+/// from source, replacing any source it had.  Each ef_eventq_poll() of a
+/// VI on the port moves as many frames off the wire as it asks for
+/// events, so a port must be polled from one thread and attached to
+/// before polling starts or from that thread.  A frame stays on the wire
+/// until every VI whose filters match it has event queue space; frames
+/// are lost only to an empty receive queue, as on the adapter.
+void attach(unsigned ifindex, std::shared_ptr<Source> source);
+void detach(unsigned ifindex);
+PortStats port_stats(unsigned ifindex);
+
+#endif
+
+} } }
@@ -40,7 +40,7 @@ public:
     {
         ::ef_filter_spec_init(&m_fs, EF_FILTER_FLAG_NONE);
     }
-    virtual ~SFCFilterSpec();
+    virtual ~SFCFilterSpec() {}
 
     ::ef_filter_spec& fs() { return m_fs; }
     ::ef_filter_cookie& fc() { return m_fc; }
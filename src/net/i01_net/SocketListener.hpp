@@ -1,17 +1,51 @@
 #pragma once
 
-namespace i01 { namespace core {
-class Timestamp;
-}}
+#include <sys/types.h>
+
+#include <cstddef>
+#include <cstdint>
+
+#include <i01_core/Time.hpp>
 
 namespace i01 { namespace net {
 
+/// A datagram received in a batch.  buf is only valid until the
+/// on_recv_batch() call it was passed to returns.
+struct RecvDescriptor {
+    const std::uint8_t *buf;
+    ssize_t len;
+    /// When the poller dequeued the datagram.
+    core::Timestamp ts;
+    /// When the kernel (software) and the NIC (hardware) received it, see
+    /// RecvTimestamping; {0,0} if not available.
+    core::Timestamp kernel_ts;
+    core::Timestamp hw_ts;
+};
+
 class SocketListener {
 public:
     virtual void on_connected(const core::Timestamp&, void *) = 0;
     virtual void on_peer_disconnect(const core::Timestamp&, void *) = 0;
     virtual void on_local_disconnect(const core::Timestamp&, void *) = 0;
     virtual void on_recv(const core::Timestamp & ts, void *, const std::uint8_t *buf, const ssize_t & len) = 0;
+
+    /// A read from a socket with receive timestamping, ts is the dequeue
+    /// time and kernel_ts, hw_ts as in RecvDescriptor.  By default goes to
+    /// on_recv().
+    virtual void on_recv_timestamped(const core::Timestamp & ts, void *ud, const std::uint8_t *buf, const ssize_t & len, const core::Timestamp & kernel_ts, const core::Timestamp & hw_ts)
+    {
+        on_recv(ts, ud, buf, len);
+    }
+
+    /// n datagrams read from one socket at once, oldest first, when the
+    /// poller is in RecvMode::RECVMMSG.  By default each goes to
+    /// on_recv_timestamped().
+    virtual void on_recv_batch(const core::Timestamp & ts, void *ud, const RecvDescriptor *descs, std::size_t n)
+    {
+        for (std::size_t i = 0; i < n; ++i) {
+            on_recv_timestamped(descs[i].ts, ud, descs[i].buf, descs[i].len, descs[i].kernel_ts, descs[i].hw_ts);
+        }
+    }
 };
 
 }}
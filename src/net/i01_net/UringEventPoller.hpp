@@ -0,0 +1,118 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <i01_core/macro.hpp>
+#include <i01_core/Time.hpp>
+#include <i01_core/Lock.hpp>
+#include <i01_core/Config.hpp>
+#include <i01_core/NamedThread.hpp>
+#include <i01_net/EventPoller.hpp>
+#include <i01_net/IOUring.hpp>
+#include <i01_net/SocketListener.hpp>
+
+namespace i01 { namespace net {
+
+    /// Counts of UringEventPoller work.  Written by the poller thread
+    /// only, and safe to read from any other.
+    struct UringStats {
+        /// io_uring_enter() calls, one per run().
+        std::atomic<std::uint64_t> enters;
+        std::atomic<std::uint64_t> completions;
+        /// Receives re-armed after the kernel ended a multishot receive.
+        std::atomic<std::uint64_t> rearms;
+        /// Multishot receives ended because every buffer was in use.
+        std::atomic<std::uint64_t> no_buffers;
+
+        UringStats() : enters(0), completions(0), rearms(0), no_buffers(0) {}
+    };
+    std::ostream & operator<<(std::ostream &os, const UringStats &s);
+
+    /// EventPoller on io_uring(7): each socket has one multishot receive
+    /// outstanding, reading into a ring of buffers provided to the kernel
+    /// up front, so that run() makes one io_uring_enter() however many
+    /// sockets are readable and listeners get the kernel's buffer without
+    /// a copy.  Consecutive datagrams from
+    /// one socket go to SocketListener::on_recv_batch(), stream data to
+    /// on_recv().  Buffers are reused once the callback returns.
+    ///
+    /// The ring is created by the first run(), so all io_uring calls are
+    /// made on the poller thread; sockets added before or after are armed
+    /// by the next run().
+    class UringEventPoller : public EventPoller, public core::NamedThread<UringEventPoller> {
+        core::RecursiveMutex m_change_mutex;
+        typedef core::LockGuard<decltype(m_change_mutex)> lockguard_type;
+
+        /// What a submission's user_data points to.
+        struct Source {
+            EventData *ed;
+            /// Stream socket whose peer has gone.
+            bool closed;
+        };
+
+        std::unique_ptr<IOUring> m_ring;
+        std::vector<Source *> m_sources;
+        /// Added but not armed yet, guarded by m_change_mutex.
+        std::vector<Source *> m_unarmed;
+        std::atomic<bool> m_have_unarmed;
+
+        std::uint32_t m_sq_entries;
+        std::uint16_t m_buffer_count;
+        std::uint32_t m_buffer_size;
+        std::vector<RecvDescriptor> m_recv_descs;
+        std::vector<std::uint16_t> m_recv_bids;
+        /// Datagrams in m_recv_descs waiting for on_recv_batch().
+        std::size_t m_batch_size;
+        UringStats m_stats;
+
+        static const std::uint16_t s_buffer_group = 0;
+
+        bool init_ring_();
+        void arm_unarmed_();
+        bool arm_(Source *s);
+        void on_socket_cqe_(Source *s, const ::io_uring_cqe& c, Source *& batch);
+        void flush_batch_(Source *& batch);
+
+    public:
+        static const std::uint32_t DEFAULT_SQ_ENTRIES = 256;
+        static const std::uint16_t DEFAULT_BUFFER_COUNT = 1024;
+        static const std::uint32_t DEFAULT_BUFFER_SIZE = 2048;
+        /// Datagrams per on_recv_batch() call at most.
+        static const std::uint32_t MAX_RECV_BATCH = 64;
+
+    public:
+        UringEventPoller();
+        UringEventPoller(const std::string&);
+        virtual ~UringEventPoller();
+
+        virtual bool add_socket( SocketListener&
+                               , EventUserData
+                               , int fd
+                               , bool managed = true) override final;
+
+        /// Set before the first run().  buffer_count, a power of two,
+        /// buffers of buffer_size bytes are shared by all sockets; longer
+        /// datagrams are truncated.
+        bool ring_size(std::uint32_t sq_entries, std::uint16_t buffer_count = DEFAULT_BUFFER_COUNT, std::uint32_t buffer_size = DEFAULT_BUFFER_SIZE);
+        std::uint32_t sq_entries() const { return m_sq_entries; }
+        std::uint16_t buffer_count() const { return m_buffer_count; }
+        std::uint32_t buffer_size() const { return m_buffer_size; }
+        const UringStats& stats() const { return m_stats; }
+
+        /// Reads, from the poller's own config domain:
+        ///
+        ///     sq_entries = 256,
+        ///     recv_buffers = 1024,       -- shared by all sockets
+        ///     recv_buffer_size = 2048,   -- bytes per datagram
+        virtual bool configure(const core::Config::storage_type& cfg) override;
+        virtual std::string status() const override;
+        virtual bool start() override { return spawn(); }
+
+        virtual bool run() override final;
+        virtual void* process() override;
+    };
+
+} }
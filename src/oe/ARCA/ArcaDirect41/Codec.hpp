@@ -0,0 +1,499 @@
+#pragma once
+
+// ArcaDirect 4.1 as WireCodec descriptions: byte for byte the packed structs
+// of Messages.hpp, all integers big endian.
+
+#include <cstdint>
+
+#include <i01_oe/WireCodec.hpp>
+
+#include "Types.hpp"
+
+namespace i01 { namespace OE { namespace ARCA { namespace ArcaDirect41 { namespace Codec {
+    using namespace i01::OE::WireCodec;
+    namespace T = i01::OE::ARCA::ArcaDirect41::Types;
+
+    namespace F {
+        I01_WIRE_FIELD(message_type);
+        I01_WIRE_FIELD(variant);
+        I01_WIRE_FIELD(length);
+        I01_WIRE_FIELD(seqnum);
+        I01_WIRE_FIELD(sending_time);
+        I01_WIRE_FIELD(transaction_time);
+        I01_WIRE_FIELD(client_order_id);
+        I01_WIRE_FIELD(original_client_order_id);
+        I01_WIRE_FIELD(order_id);
+        I01_WIRE_FIELD(pcs_link_id);
+        I01_WIRE_FIELD(order_quantity);
+        I01_WIRE_FIELD(order_price);
+        I01_WIRE_FIELD(price);
+        I01_WIRE_FIELD(strike_price);
+        I01_WIRE_FIELD(under_qty);
+        I01_WIRE_FIELD(ex_destination);
+        I01_WIRE_FIELD(price_scale);
+        I01_WIRE_FIELD(corporate_action);
+        I01_WIRE_FIELD(put_or_call);
+        I01_WIRE_FIELD(bulk_cancel);
+        I01_WIRE_FIELD(open_or_close);
+        I01_WIRE_FIELD(symbol);
+        I01_WIRE_FIELD(strike_date);
+        I01_WIRE_FIELD(company_group_id);
+        I01_WIRE_FIELD(deliver_to_comp_id);
+        I01_WIRE_FIELD(sender_sub_id);
+        I01_WIRE_FIELD(exec_inst);
+        I01_WIRE_FIELD(side);
+        I01_WIRE_FIELD(order_type);
+        I01_WIRE_FIELD(time_in_force);
+        I01_WIRE_FIELD(rule_80a);
+        I01_WIRE_FIELD(trading_session_id);
+        I01_WIRE_FIELD(account);
+        I01_WIRE_FIELD(iso);
+        I01_WIRE_FIELD(extended_exec_inst);
+        I01_WIRE_FIELD(extended_pnp);
+        I01_WIRE_FIELD(no_self_trade);
+        I01_WIRE_FIELD(proactive_if_locked);
+        I01_WIRE_FIELD(liquidity_indicator);
+        I01_WIRE_FIELD(filler);
+        I01_WIRE_FIELD(message_terminator);
+        I01_WIRE_FIELD(last_seqnum);
+        I01_WIRE_FIELD(username);
+        I01_WIRE_FIELD(symbology);
+        I01_WIRE_FIELD(message_version_profile);
+        I01_WIRE_FIELD(cancel_on_disconnect);
+        I01_WIRE_FIELD(session_profile_bitmap);
+        I01_WIRE_FIELD(default_extended_exec_inst);
+        I01_WIRE_FIELD(default_proactive_if_locked);
+        I01_WIRE_FIELD(last_seqnum_server_received);
+        I01_WIRE_FIELD(last_seqnum_server_sent);
+        I01_WIRE_FIELD(reject_type);
+        I01_WIRE_FIELD(text);
+        I01_WIRE_FIELD(new_client_order_id);
+        I01_WIRE_FIELD(order_qty);
+        I01_WIRE_FIELD(suppress_ack);
+        I01_WIRE_FIELD(information_text);
+        I01_WIRE_FIELD(last_shares);
+        I01_WIRE_FIELD(rejected_message_type);
+        I01_WIRE_FIELD(reject_reason);
+        I01_WIRE_FIELD(execution_id);
+        I01_WIRE_FIELD(type);
+        I01_WIRE_FIELD(arca_ex_id);
+        I01_WIRE_FIELD(last_price);
+        I01_WIRE_FIELD(last_mkt);
+        I01_WIRE_FIELD(execution_ref_id);
+        I01_WIRE_FIELD(leaves);
+        I01_WIRE_FIELD(cum_qty);
+        I01_WIRE_FIELD(avg_px);
+        I01_WIRE_FIELD(stop_price);
+        I01_WIRE_FIELD(discretion_offset);
+        I01_WIRE_FIELD(peg_difference);
+        I01_WIRE_FIELD(exec_trans_type);
+        I01_WIRE_FIELD(order_reject_reason);
+        I01_WIRE_FIELD(order_status);
+        I01_WIRE_FIELD(execution_type);
+        I01_WIRE_FIELD(discretion_instruction);
+        I01_WIRE_FIELD(exec_broker);
+        I01_WIRE_FIELD(leg_ref_id);
+    }
+
+    /// ExecInst and OrderType are plain characters.
+    typedef BigEndian<std::uint8_t> Char;
+    /// Character fields, NUL padded.
+    template<std::size_t N> using Text = Alpha<N, '\0'>;
+    typedef Literal<BigEndian<T::MessageTerminator>, T::MessageTerminator::NEW_LINE> Terminator;
+
+    using LogonRequestVariant1 = Message<
+        Field<F::message_type,          Literal<BigEndian<T::MessageType>, T::MessageType::LOGON>>
+      , Field<F::variant,               Literal<BigEndian<T::Variant>, 1>>
+      , Field<F::length,                Literal<BigEndian<T::Length>, 48>>
+      , Field<F::seqnum,                BigEndian<T::SeqNum>>
+      , Field<F::last_seqnum,           BigEndian<T::SeqNum>>
+      , Field<F::username,              Text<5>>
+      , Field<F::symbology,             BigEndian<T::Symbology>>
+      , Field<F::message_version_profile, Text<28>>
+      , Field<F::cancel_on_disconnect,  BigEndian<T::CancelOnDisconnect>>
+      , Field<F::message_terminator,    Terminator>
+    >;
+    static_assert(LogonRequestVariant1::SIZE == 48, "ArcaDirect41 LogonRequestVariant1 is 48 bytes.");
+
+    using LogonRequestVariant2Full = Message<
+        Field<F::message_type,          Literal<BigEndian<T::MessageType>, T::MessageType::LOGON>>
+      , Field<F::variant,               Literal<BigEndian<T::Variant>, 2>>
+      , Field<F::length,                Literal<BigEndian<T::Length>, 53>>
+      , Field<F::seqnum,                BigEndian<T::SeqNum>>
+      , Field<F::last_seqnum,           BigEndian<T::SeqNum>>
+      , Field<F::session_profile_bitmap, BigEndian<T::SessionProfileBitmap>>
+      , Field<F::username,              Text<5>>
+      , Field<F::message_version_profile, Text<28>>
+      , Field<F::cancel_on_disconnect,  BigEndian<T::CancelOnDisconnect>>
+      , Field<F::default_extended_exec_inst, BigEndian<T::DefaultExtendedExecInst>>
+      , Field<F::default_proactive_if_locked, BigEndian<T::ProactiveIfLocked>>
+      , Field<F::message_terminator,    Terminator>
+    >;
+    static_assert(LogonRequestVariant2Full::SIZE == 53, "ArcaDirect41 LogonRequestVariant2Full is 53 bytes.");
+
+    using LogonReject = Message<
+        Field<F::message_type,          Literal<BigEndian<T::MessageType>, T::MessageType::LOGON_REJECT>>
+      , Field<F::variant,               Literal<BigEndian<T::Variant>, 1>>
+      , Field<F::length,                Literal<BigEndian<T::Length>, 60>>
+      , Field<F::seqnum,                BigEndian<T::SeqNum>>
+      , Field<F::last_seqnum_server_received, BigEndian<T::SeqNum>>
+      , Field<F::last_seqnum_server_sent, BigEndian<T::SeqNum>>
+      , Field<F::reject_type,           BigEndian<T::RejectType>>
+      , Field<F::text,                  Text<40>>
+      , Field<F::filler,                Filler<1>>
+      , Field<F::message_terminator,    Terminator>
+    >;
+    static_assert(LogonReject::SIZE == 60, "ArcaDirect41 LogonReject is 60 bytes.");
+
+    using TestRequest = Message<
+        Field<F::message_type,          Literal<BigEndian<T::MessageType>, T::MessageType::TEST_MESSAGE>>
+      , Field<F::variant,               Literal<BigEndian<T::Variant>, 1>>
+      , Field<F::length,                Literal<BigEndian<T::Length>, 12>>
+      , Field<F::seqnum,                BigEndian<T::SeqNum>>
+      , Field<F::filler,                Filler<3>>
+      , Field<F::message_terminator,    Terminator>
+    >;
+    static_assert(TestRequest::SIZE == 12, "ArcaDirect41 TestRequest is 12 bytes.");
+
+    using Heartbeat = Message<
+        Field<F::message_type,          Literal<BigEndian<T::MessageType>, T::MessageType::HEARTBEAT_MESSAGE>>
+      , Field<F::variant,               Literal<BigEndian<T::Variant>, 1>>
+      , Field<F::length,                Literal<BigEndian<T::Length>, 12>>
+      , Field<F::seqnum,                BigEndian<T::SeqNum>>
+      , Field<F::filler,                Filler<3>>
+      , Field<F::message_terminator,    Terminator>
+    >;
+    static_assert(Heartbeat::SIZE == 12, "ArcaDirect41 Heartbeat is 12 bytes.");
+
+    using NewOrderVariant1 = Message<
+        Field<F::message_type,          Literal<BigEndian<T::MessageType>, T::MessageType::NEW_ORDER>>
+      , Field<F::variant,               Literal<BigEndian<T::Variant>, 1>>
+      , Field<F::length,                Literal<BigEndian<T::Length>, 76>>
+      , Field<F::seqnum,                BigEndian<T::SeqNum>>
+      , Field<F::client_order_id,       BigEndian<T::ClientOrderID>>
+      , Field<F::pcs_link_id,           BigEndian<T::PCSLinkID>>
+      , Field<F::order_quantity,        BigEndian<T::Quantity>>
+        // in units of price_scale
+      , Field<F::order_price,           BigEndian<T::Price>>
+      , Field<F::ex_destination,        BigEndian<T::ExDestination>>
+      , Field<F::price_scale,           BigEndian<T::PriceScale>>
+      , Field<F::symbol,                Text<8>>
+      , Field<F::company_group_id,      Text<5>>
+      , Field<F::deliver_to_comp_id,    Text<5>>
+      , Field<F::sender_sub_id,         Text<5>>
+      , Field<F::exec_inst,             Char>
+      , Field<F::side,                  BigEndian<T::Side>>
+      , Field<F::order_type,            Char>
+      , Field<F::time_in_force,         BigEndian<T::TimeInForce>>
+      , Field<F::rule_80a,              BigEndian<T::Rule80A>>
+      , Field<F::trading_session_id,    Text<4>>
+      , Field<F::account,               Text<10>>
+      , Field<F::iso,                   BigEndian<T::ISO>>
+      , Field<F::extended_exec_inst,    BigEndian<T::ExtendedExecInst>>
+      , Field<F::extended_pnp,          BigEndian<T::ExtendedPNP>>
+      , Field<F::no_self_trade,         BigEndian<T::NoSelfTrade>>
+      , Field<F::proactive_if_locked,   BigEndian<T::ProactiveIfLocked>>
+      , Field<F::filler,                Filler<1>>
+      , Field<F::message_terminator,    Terminator>
+    >;
+    static_assert(NewOrderVariant1::SIZE == 76, "ArcaDirect41 NewOrderMessageVariant1 is 76 bytes.");
+
+    using Cancel = Message<
+        Field<F::message_type,          Literal<BigEndian<T::MessageType>, T::MessageType::CANCEL>>
+      , Field<F::variant,               Literal<BigEndian<T::Variant>, 1>>
+      , Field<F::length,                Literal<BigEndian<T::Length>, 72>>
+      , Field<F::seqnum,                BigEndian<T::SeqNum>>
+      , Field<F::order_id,              BigEndian<T::OrderID>>
+      , Field<F::original_client_order_id, BigEndian<T::ClientOrderID>>
+      , Field<F::strike_price,          BigEndian<T::Price>>
+      , Field<F::under_qty,             BigEndian<T::UnderQty>>
+      , Field<F::ex_destination,        BigEndian<T::ExDestination>>
+      , Field<F::corporate_action,      BigEndian<T::CorporateAction>>
+      , Field<F::put_or_call,           BigEndian<T::PutOrCall>>
+      , Field<F::bulk_cancel,           BigEndian<T::BulkCancel>>
+      , Field<F::open_or_close,         BigEndian<T::OpenOrClose>>
+      , Field<F::symbol,                Text<8>>
+      , Field<F::strike_date,           Text<8>>
+      , Field<F::side,                  BigEndian<T::Side>>
+      , Field<F::deliver_to_comp_id,    Text<5>>
+      , Field<F::account,               Text<10>>
+      , Field<F::filler,                Filler<7>>
+      , Field<F::message_terminator,    Terminator>
+    >;
+    static_assert(Cancel::SIZE == 72, "ArcaDirect41 Cancel is 72 bytes.");
+
+    using CancelReplaceVariant1 = Message<
+        Field<F::message_type,          Literal<BigEndian<T::MessageType>, T::MessageType::CANCEL_REPLACE>>
+      , Field<F::variant,               Literal<BigEndian<T::Variant>, 1>>
+      , Field<F::length,                Literal<BigEndian<T::Length>, 88>>
+      , Field<F::seqnum,                BigEndian<T::SeqNum>>
+      , Field<F::order_id,              BigEndian<T::OrderID>>
+      , Field<F::new_client_order_id,   BigEndian<T::ClientOrderID>>
+      , Field<F::original_client_order_id, BigEndian<T::ClientOrderID>>
+      , Field<F::order_qty,             BigEndian<T::Quantity>>
+      , Field<F::strike_price,          BigEndian<T::Price>>
+      , Field<F::price,                 BigEndian<T::Price>>
+      , Field<F::ex_destination,        BigEndian<T::ExDestination>>
+      , Field<F::under_qty,             BigEndian<T::UnderQty>>
+      , Field<F::price_scale,           BigEndian<T::PriceScale>>
+      , Field<F::put_or_call,           BigEndian<T::PutOrCall>>
+      , Field<F::corporate_action,      BigEndian<T::CorporateAction>>
+      , Field<F::open_or_close,         BigEndian<T::OpenOrClose>>
+      , Field<F::symbol,                Text<8>>
+      , Field<F::strike_date,           Text<8>>
+      , Field<F::exec_inst,             Char>
+      , Field<F::side,                  BigEndian<T::Side>>
+      , Field<F::order_type,            Char>
+      , Field<F::time_in_force,         BigEndian<T::TimeInForce>>
+      , Field<F::rule_80a,              BigEndian<T::Rule80A>>
+      , Field<F::trading_session_id,    Text<4>>
+      , Field<F::deliver_to_comp_id,    Text<5>>
+      , Field<F::account,               Text<10>>
+      , Field<F::filler,                Filler<3>>
+      , Field<F::message_terminator,    Terminator>
+    >;
+    static_assert(CancelReplaceVariant1::SIZE == 88, "ArcaDirect41 CancelReplaceVariant1 is 88 bytes.");
+
+    using CancelReplaceVariant4 = Message<
+        Field<F::message_type,          Literal<BigEndian<T::MessageType>, T::MessageType::CANCEL_REPLACE>>
+      , Field<F::variant,               Literal<BigEndian<T::Variant>, 4>>
+      , Field<F::length,                Literal<BigEndian<T::Length>, 64>>
+      , Field<F::seqnum,                BigEndian<T::SeqNum>>
+      , Field<F::order_id,              BigEndian<T::OrderID>>
+      , Field<F::original_client_order_id, BigEndian<T::ClientOrderID>>
+      , Field<F::order_qty,             BigEndian<T::Quantity>>
+      , Field<F::price,                 BigEndian<T::Price>>
+      , Field<F::ex_destination,        BigEndian<T::ExDestination>>
+      , Field<F::price_scale,           BigEndian<T::PriceScale>>
+      , Field<F::symbol,                Text<8>>
+      , Field<F::side,                  BigEndian<T::Side>>
+      , Field<F::suppress_ack,          BigEndian<T::SuppressAck>>
+      , Field<F::deliver_to_comp_id,    Text<5>>
+      , Field<F::account,               Text<10>>
+      , Field<F::filler,                Filler<7>>
+      , Field<F::message_terminator,    Terminator>
+    >;
+    static_assert(CancelReplaceVariant4::SIZE == 64, "ArcaDirect41 CancelReplaceVariant4 is 64 bytes.");
+
+    using CancelRequestAck = Message<
+        Field<F::message_type,          Literal<BigEndian<T::MessageType>, T::MessageType::CANCEL_REQUEST_ACK>>
+      , Field<F::variant,               Literal<BigEndian<T::Variant>, 1>>
+      , Field<F::length,                Literal<BigEndian<T::Length>, 40>>
+      , Field<F::seqnum,                BigEndian<T::SeqNum>>
+      , Field<F::sending_time,          BigEndian<T::SendingTime>>
+      , Field<F::transaction_time,      BigEndian<T::TransactionTime>>
+      , Field<F::client_order_id,       BigEndian<T::ClientOrderID>>
+      , Field<F::order_id,              BigEndian<T::OrderID>>
+      , Field<F::filler,                Filler<3>>
+      , Field<F::message_terminator,    Terminator>
+    >;
+    static_assert(CancelRequestAck::SIZE == 40, "ArcaDirect41 CancelRequestAck is 40 bytes.");
+
+    using Killed = Message<
+        Field<F::message_type,          Literal<BigEndian<T::MessageType>, T::MessageType::ORDER_KILLED>>
+      , Field<F::variant,               Literal<BigEndian<T::Variant>, 1>>
+      , Field<F::length,                Literal<BigEndian<T::Length>, 40>>
+      , Field<F::seqnum,                BigEndian<T::SeqNum>>
+      , Field<F::sending_time,          BigEndian<T::SendingTime>>
+      , Field<F::transaction_time,      BigEndian<T::TransactionTime>>
+      , Field<F::client_order_id,       BigEndian<T::ClientOrderID>>
+      , Field<F::order_id,              BigEndian<T::OrderID>>
+      , Field<F::information_text,      BigEndian<T::InformationText>>
+      , Field<F::filler,                Filler<2>>
+      , Field<F::message_terminator,    Terminator>
+    >;
+    static_assert(Killed::SIZE == 40, "ArcaDirect41 Killed is 40 bytes.");
+
+    using KilledSTP = Message<
+        Field<F::message_type,          Literal<BigEndian<T::MessageType>, T::MessageType::ORDER_KILLED>>
+      , Field<F::variant,               Literal<BigEndian<T::Variant>, 2>>
+      , Field<F::length,                Literal<BigEndian<T::Length>, 88>>
+      , Field<F::seqnum,                BigEndian<T::SeqNum>>
+      , Field<F::sending_time,          BigEndian<T::SendingTime>>
+      , Field<F::transaction_time,      BigEndian<T::TransactionTime>>
+      , Field<F::client_order_id,       BigEndian<T::ClientOrderID>>
+      , Field<F::order_id,              BigEndian<T::OrderID>>
+      , Field<F::last_shares,           BigEndian<T::Quantity>>
+      , Field<F::information_text,      BigEndian<T::InformationText>>
+      , Field<F::text,                  Text<40>>
+      , Field<F::liquidity_indicator,   BigEndian<T::LiquidityIndicator>>
+      , Field<F::filler,                Filler<5>>
+      , Field<F::message_terminator,    Terminator>
+    >;
+    static_assert(KilledSTP::SIZE == 88, "ArcaDirect41 KilledSTP is 88 bytes.");
+
+    using CancelReplaceAck = Message<
+        Field<F::message_type,          Literal<BigEndian<T::MessageType>, T::MessageType::CANCEL_REPLACE_ACK>>
+      , Field<F::variant,               Literal<BigEndian<T::Variant>, 1>>
+      , Field<F::length,                Literal<BigEndian<T::Length>, 40>>
+      , Field<F::seqnum,                BigEndian<T::SeqNum>>
+      , Field<F::sending_time,          BigEndian<T::SendingTime>>
+      , Field<F::transaction_time,      BigEndian<T::TransactionTime>>
+      , Field<F::original_client_order_id, BigEndian<T::ClientOrderID>>
+      , Field<F::order_id,              BigEndian<T::OrderID>>
+      , Field<F::filler,                Filler<3>>
+      , Field<F::message_terminator,    Terminator>
+    >;
+    static_assert(CancelReplaceAck::SIZE == 40, "ArcaDirect41 CancelReplaceAck is 40 bytes.");
+
+    using Replaced = Message<
+        Field<F::message_type,          Literal<BigEndian<T::MessageType>, T::MessageType::ORDER_REPLACED>>
+      , Field<F::variant,               Literal<BigEndian<T::Variant>, 1>>
+      , Field<F::length,                Literal<BigEndian<T::Length>, 40>>
+      , Field<F::seqnum,                BigEndian<T::SeqNum>>
+      , Field<F::sending_time,          BigEndian<T::SendingTime>>
+      , Field<F::transaction_time,      BigEndian<T::TransactionTime>>
+      , Field<F::new_client_order_id,   BigEndian<T::ClientOrderID>>
+      , Field<F::order_id,              BigEndian<T::OrderID>>
+      , Field<F::filler,                Filler<3>>
+      , Field<F::message_terminator,    Terminator>
+    >;
+    static_assert(Replaced::SIZE == 40, "ArcaDirect41 Replaced is 40 bytes.");
+
+    using CancelReplaceReject = Message<
+        Field<F::message_type,          Literal<BigEndian<T::MessageType>, T::MessageType::ORDER_REJECTED>>
+      , Field<F::variant,               Literal<BigEndian<T::Variant>, 1>>
+      , Field<F::length,                Literal<BigEndian<T::Length>, 80>>
+      , Field<F::seqnum,                BigEndian<T::SeqNum>>
+      , Field<F::sending_time,          BigEndian<T::SendingTime>>
+      , Field<F::transaction_time,      BigEndian<T::TransactionTime>>
+      , Field<F::client_order_id,       BigEndian<T::ClientOrderID>>
+      , Field<F::original_client_order_id, BigEndian<T::ClientOrderID>>
+      , Field<F::rejected_message_type, BigEndian<T::RejectedMessageType>>
+      , Field<F::text,                  Text<40>>
+      , Field<F::reject_reason,         BigEndian<T::RejectReason>>
+      , Field<F::filler,                Filler<5>>
+      , Field<F::message_terminator,    Terminator>
+    >;
+    static_assert(CancelReplaceReject::SIZE == 80, "ArcaDirect41 CancelReplaceReject is 80 bytes.");
+
+    using BustedOrCorrected = Message<
+        Field<F::message_type,          Literal<BigEndian<T::MessageType>, T::MessageType::BUST_OR_CORRECT>>
+      , Field<F::variant,               Literal<BigEndian<T::Variant>, 1>>
+      , Field<F::length,                Literal<BigEndian<T::Length>, 48>>
+      , Field<F::seqnum,                BigEndian<T::SeqNum>>
+      , Field<F::sending_time,          BigEndian<T::SendingTime>>
+      , Field<F::transaction_time,      BigEndian<T::TransactionTime>>
+      , Field<F::client_order_id,       BigEndian<T::ClientOrderID>>
+      , Field<F::execution_id,          BigEndian<T::ExecutionID>>
+      , Field<F::order_quantity,        BigEndian<T::Quantity>>
+      , Field<F::price,                 BigEndian<T::Price>>
+      , Field<F::price_scale,           BigEndian<T::PriceScale>>
+      , Field<F::type,                  BigEndian<T::BustType>>
+      , Field<F::filler,                Filler<1>>
+      , Field<F::message_terminator,    Terminator>
+    >;
+    static_assert(BustedOrCorrected::SIZE == 48, "ArcaDirect41 BustedOrCorrected is 48 bytes.");
+
+    using Ack = Message<
+        Field<F::message_type,          Literal<BigEndian<T::MessageType>, T::MessageType::ORDER_ACK>>
+      , Field<F::variant,               Literal<BigEndian<T::Variant>, 1>>
+      , Field<F::length,                Literal<BigEndian<T::Length>, 48>>
+      , Field<F::seqnum,                BigEndian<T::SeqNum>>
+      , Field<F::sending_time,          BigEndian<T::SendingTime>>
+      , Field<F::transaction_time,      BigEndian<T::TransactionTime>>
+      , Field<F::original_client_order_id, BigEndian<T::ClientOrderID>>
+      , Field<F::order_id,              BigEndian<T::OrderID>>
+      , Field<F::price,                 BigEndian<T::Price>>
+      , Field<F::price_scale,           BigEndian<T::PriceScale>>
+      , Field<F::liquidity_indicator,   BigEndian<T::AckLiquidityIndicator>>
+      , Field<F::filler,                Filler<5>>
+      , Field<F::message_terminator,    Terminator>
+    >;
+    static_assert(Ack::SIZE == 48, "ArcaDirect41 Ack is 48 bytes.");
+
+    using FillVariant1 = Message<
+        Field<F::message_type,          Literal<BigEndian<T::MessageType>, T::MessageType::ORDER_FILLED>>
+      , Field<F::variant,               Literal<BigEndian<T::Variant>, 1>>
+      , Field<F::length,                Literal<BigEndian<T::Length>, 88>>
+      , Field<F::seqnum,                BigEndian<T::SeqNum>>
+      , Field<F::sending_time,          BigEndian<T::SendingTime>>
+      , Field<F::transaction_time,      BigEndian<T::TransactionTime>>
+      , Field<F::client_order_id,       BigEndian<T::ClientOrderID>>
+      , Field<F::order_id,              BigEndian<T::OrderID>>
+      , Field<F::execution_id,          BigEndian<T::ExecutionID>>
+      , Field<F::arca_ex_id,            Text<20>>
+      , Field<F::last_shares,           BigEndian<T::Quantity>>
+      , Field<F::last_price,            BigEndian<T::Price>>
+      , Field<F::price_scale,           BigEndian<T::PriceScale>>
+      , Field<F::liquidity_indicator,   BigEndian<T::LiquidityIndicator>>
+      , Field<F::side,                  BigEndian<T::Side>>
+      , Field<F::last_mkt,              BigEndian<T::LastMkt>>
+      , Field<F::filler,                Filler<10>>
+      , Field<F::message_terminator,    Terminator>
+    >;
+    static_assert(FillVariant1::SIZE == 88, "ArcaDirect41 FillVariant1 is 88 bytes.");
+
+    using FillVariant2 = Message<
+        Field<F::message_type,          Literal<BigEndian<T::MessageType>, T::MessageType::ORDER_FILLED>>
+      , Field<F::variant,               Literal<BigEndian<T::Variant>, 2>>
+      , Field<F::length,                Literal<BigEndian<T::Length>, 208>>
+      , Field<F::seqnum,                BigEndian<T::SeqNum>>
+      , Field<F::sending_time,          BigEndian<T::SendingTime>>
+      , Field<F::transaction_time,      BigEndian<T::TransactionTime>>
+      , Field<F::client_order_id,       BigEndian<T::ClientOrderID>>
+      , Field<F::order_id,              BigEndian<T::OrderID>>
+      , Field<F::execution_id,          BigEndian<T::ExecutionID>>
+      , Field<F::execution_ref_id,      BigEndian<T::ExecutionID>>
+      , Field<F::arca_ex_id,            Text<20>>
+      , Field<F::order_quantity,        BigEndian<T::Quantity>>
+      , Field<F::price,                 BigEndian<T::Price>>
+      , Field<F::leaves,                BigEndian<T::Quantity>>
+      , Field<F::cum_qty,               BigEndian<T::Quantity>>
+      , Field<F::avg_px,                BigEndian<T::Price>>
+      , Field<F::stop_price,            BigEndian<T::Price>>
+      , Field<F::discretion_offset,     BigEndian<T::Price>>
+      , Field<F::peg_difference,        BigEndian<T::Price>>
+      , Field<F::last_shares,           BigEndian<T::Quantity>>
+      , Field<F::last_price,            BigEndian<T::Price>>
+      , Field<F::strike_price,          BigEndian<T::Price>>
+      , Field<F::put_or_call,           BigEndian<T::PutOrCall>>
+      , Field<F::open_or_close,         BigEndian<T::OpenOrClose>>
+      , Field<F::symbol,                Text<8>>
+      , Field<F::strike_date,           Text<8>>
+      , Field<F::exec_trans_type,       BigEndian<T::ExecTransType>>
+      , Field<F::order_reject_reason,   BigEndian<T::OrderRejectReason>>
+      , Field<F::order_status,          BigEndian<T::OrderStatus>>
+      , Field<F::execution_type,        BigEndian<T::ExecutionType>>
+      , Field<F::side,                  BigEndian<T::Side>>
+      , Field<F::order_type,            Char>
+      , Field<F::time_in_force,         BigEndian<T::TimeInForce>>
+      , Field<F::account,               Text<10>>
+      , Field<F::text,                  Text<40>>
+      , Field<F::discretion_instruction, BigEndian<T::DiscretionInstruction>>
+      , Field<F::liquidity_indicator,   BigEndian<T::AckLiquidityIndicator>>
+      , Field<F::exec_broker,           Text<5>>
+      , Field<F::last_mkt,              BigEndian<T::LastMkt>>
+      , Field<F::filler,                Filler<7>>
+      , Field<F::message_terminator,    Terminator>
+    >;
+    static_assert(FillVariant2::SIZE == 208, "ArcaDirect41 FillVariant2 is 208 bytes.");
+
+    using FillVariant3 = Message<
+        Field<F::message_type,          Literal<BigEndian<T::MessageType>, T::MessageType::ORDER_FILLED>>
+      , Field<F::variant,               Literal<BigEndian<T::Variant>, 3>>
+      , Field<F::length,                Literal<BigEndian<T::Length>, 136>>
+      , Field<F::seqnum,                BigEndian<T::SeqNum>>
+      , Field<F::sending_time,          BigEndian<T::SendingTime>>
+      , Field<F::transaction_time,      BigEndian<T::TransactionTime>>
+      , Field<F::client_order_id,       BigEndian<T::ClientOrderID>>
+      , Field<F::order_id,              BigEndian<T::OrderID>>
+      , Field<F::execution_id,          BigEndian<T::ExecutionID>>
+      , Field<F::execution_ref_id,      BigEndian<T::ExecutionID>>
+      , Field<F::arca_ex_id,            Text<20>>
+      , Field<F::leg_ref_id,            BigEndian<T::LegRefID>>
+      , Field<F::last_shares,           BigEndian<T::Quantity>>
+      , Field<F::last_price,            BigEndian<T::Price>>
+      , Field<F::exec_trans_type,       BigEndian<T::ExecTransType>>
+      , Field<F::order_reject_reason,   BigEndian<T::OrderRejectReason>>
+      , Field<F::execution_type,        BigEndian<T::ExecutionType>>
+      , Field<F::side,                  BigEndian<T::Side>>
+      , Field<F::text,                  Text<40>>
+      , Field<F::liquidity_indicator,   BigEndian<T::LiquidityIndicator>>
+      , Field<F::filler,                Filler<6>>
+      , Field<F::message_terminator,    Terminator>
+    >;
+    static_assert(FillVariant3::SIZE == 136, "ArcaDirect41 FillVariant3 is 136 bytes.");
+
+
+} } } } }
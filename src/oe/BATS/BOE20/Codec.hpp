@@ -0,0 +1,725 @@
+#pragma once
+
+// BOE 2.0 as WireCodec descriptions, all integers little endian.  The
+// bitfields are fixed at those BOE20Session sends (prepare_new_order_buffer
+// and friends), and the responses' at the return bitfields it asks for in
+// send_login_request, so each message has the one layout the session's does.
+
+#include <cstdint>
+
+#include <i01_oe/WireCodec.hpp>
+
+#include "Messages.hpp"
+
+namespace i01 { namespace OE { namespace BATS { namespace BOE20 { namespace Codec {
+    using namespace i01::OE::WireCodec;
+    namespace T = i01::OE::BATS::BOE20::Types;
+
+    namespace F {
+        I01_WIRE_FIELD(start_of_message);
+        I01_WIRE_FIELD(message_length);
+        I01_WIRE_FIELD(message_type);
+        I01_WIRE_FIELD(matching_unit);
+        I01_WIRE_FIELD(sequence_number);
+        I01_WIRE_FIELD(cl_ord_id);
+        I01_WIRE_FIELD(orig_cl_ord_id);
+        I01_WIRE_FIELD(side);
+        I01_WIRE_FIELD(order_qty);
+        I01_WIRE_FIELD(num_bitfields);
+        I01_WIRE_FIELD(bitfield1);
+        I01_WIRE_FIELD(bitfield2);
+        I01_WIRE_FIELD(bitfield3);
+        I01_WIRE_FIELD(bitfield4);
+        I01_WIRE_FIELD(bitfield5);
+        I01_WIRE_FIELD(bitfield6);
+        I01_WIRE_FIELD(clearing_firm);
+        I01_WIRE_FIELD(clearing_account);
+        I01_WIRE_FIELD(price);
+        I01_WIRE_FIELD(exec_inst);
+        I01_WIRE_FIELD(ord_type);
+        I01_WIRE_FIELD(time_in_force);
+        I01_WIRE_FIELD(min_qty);
+        I01_WIRE_FIELD(max_floor);
+        I01_WIRE_FIELD(symbol);
+        I01_WIRE_FIELD(capacity);
+        I01_WIRE_FIELD(routing_inst);
+        I01_WIRE_FIELD(account);
+        I01_WIRE_FIELD(display_indicator);
+        I01_WIRE_FIELD(max_remove_pct);
+        I01_WIRE_FIELD(discretion_amount);
+        I01_WIRE_FIELD(peg_difference);
+        I01_WIRE_FIELD(attributed_quote);
+        I01_WIRE_FIELD(ext_exec_inst);
+        I01_WIRE_FIELD(session_sub_id);
+        I01_WIRE_FIELD(username);
+        I01_WIRE_FIELD(password);
+        I01_WIRE_FIELD(num_param_groups);
+        I01_WIRE_FIELD(login_response_status);
+        I01_WIRE_FIELD(login_response_text);
+        I01_WIRE_FIELD(no_unspecified_unit_replay);
+        I01_WIRE_FIELD(last_received_sequence_number);
+        I01_WIRE_FIELD(number_of_units);
+        I01_WIRE_FIELD(logout_reason);
+        I01_WIRE_FIELD(logout_reason_text);
+        I01_WIRE_FIELD(transaction_time);
+        I01_WIRE_FIELD(order_id);
+        I01_WIRE_FIELD(reserved);
+        I01_WIRE_FIELD(number_of_return_bitfields);
+        I01_WIRE_FIELD(bitfield7);
+        I01_WIRE_FIELD(bitfield8);
+        I01_WIRE_FIELD(leaves_qty);
+        I01_WIRE_FIELD(display_price);
+        I01_WIRE_FIELD(working_price);
+        I01_WIRE_FIELD(order_reject_reason);
+        I01_WIRE_FIELD(text);
+        I01_WIRE_FIELD(restatement_reason);
+        I01_WIRE_FIELD(modify_reject_reason);
+        I01_WIRE_FIELD(cancel_reason);
+        I01_WIRE_FIELD(cancel_reject_reason);
+        I01_WIRE_FIELD(exec_id);
+        I01_WIRE_FIELD(last_shares);
+        I01_WIRE_FIELD(last_px);
+        I01_WIRE_FIELD(base_liquidity_indicator);
+        I01_WIRE_FIELD(sub_liquidity_indicator);
+        I01_WIRE_FIELD(contra_broker);
+        I01_WIRE_FIELD(fee_code);
+        I01_WIRE_FIELD(exec_ref_id);
+        I01_WIRE_FIELD(corrected_price);
+        I01_WIRE_FIELD(orig_time);
+        I01_WIRE_FIELD(new_cl_ord_id);
+        I01_WIRE_FIELD(cancel_orig_on_reject);
+        I01_WIRE_FIELD(param_group_length);
+        I01_WIRE_FIELD(param_group_type);
+        I01_WIRE_FIELD(unit_number);
+        I01_WIRE_FIELD(unit_sequence);
+    }
+
+    typedef LittleEndian<std::uint8_t> Byte;
+    typedef Decimal<T::Price, false, 10000> Price;
+    /// BOE text fields are padded with NUL.
+    template<std::size_t N> using Text = Alpha<N, '\0'>;
+
+    using LoginRequest = Message<
+        Field<F::start_of_message,      Literal<LittleEndian<T::StartOfMessage>, T::START_OF_MESSAGE_SENTINEL>>
+        // the length counts the param groups that follow
+      , Field<F::message_length,        LittleEndian<T::MessageLength>>
+      , Field<F::message_type,          Literal<Byte, static_cast<std::uint8_t>(T::MessageType::LOGIN_REQUEST_V2)>>
+      , Field<F::matching_unit,         Literal<LittleEndian<T::MatchingUnit>, 0>>
+      , Field<F::sequence_number,       LittleEndian<T::SequenceNumber>>
+      , Field<F::session_sub_id,        Text<4>>
+      , Field<F::username,              Text<4>>
+      , Field<F::password,              Text<10>>
+      , Field<F::num_param_groups,      Byte>
+    >;
+    static_assert(LoginRequest::SIZE == 29, "BOE20 LoginRequest is 29 bytes.");
+
+    /// Followed by number_of_units UnitNumberSequencePairs.
+    using UnitSequencesParamGroup = Message<
+        Field<F::param_group_length,    LittleEndian<T::ParamGroupLength>>
+      , Field<F::param_group_type,      Literal<LittleEndian<T::ParamGroupType>, T::ParamGroupType::UNIT_SEQUENCES>>
+      , Field<F::no_unspecified_unit_replay, LittleEndian<T::BooleanFlag>>
+      , Field<F::number_of_units,       LittleEndian<T::NumberOfUnits>>
+    >;
+    static_assert(UnitSequencesParamGroup::SIZE == 5, "BOE20 UnitSequencesParamGroup is 5 bytes.");
+
+    using UnitNumberSequencePair = Message<
+        Field<F::unit_number,           LittleEndian<T::MatchingUnit>>
+      , Field<F::unit_sequence,         LittleEndian<T::SequenceNumber>>
+    >;
+    static_assert(UnitNumberSequencePair::SIZE == 5, "BOE20 UnitNumberSequencePair is 5 bytes.");
+
+    /// The session always sends all eight bitfields.
+    using ReturnBitfieldsParamGroup = Message<
+        Field<F::param_group_length,    Literal<LittleEndian<T::ParamGroupLength>, 13>>
+      , Field<F::param_group_type,      Literal<LittleEndian<T::ParamGroupType>, T::ParamGroupType::RETURN_BITFIELDS>>
+      , Field<F::message_type,          Byte>
+      , Field<F::num_bitfields,         Literal<Byte, 8>>
+      , Field<F::bitfield1,             Byte>
+      , Field<F::bitfield2,             Byte>
+      , Field<F::bitfield3,             Byte>
+      , Field<F::bitfield4,             Byte>
+      , Field<F::bitfield5,             Byte>
+      , Field<F::bitfield6,             Byte>
+      , Field<F::bitfield7,             Byte>
+      , Field<F::bitfield8,             Byte>
+    >;
+    static_assert(ReturnBitfieldsParamGroup::SIZE == 13, "BOE20 ReturnBitfieldsParamGroup is 13 bytes.");
+
+    using LogoutRequest = Message<
+        Field<F::start_of_message,      Literal<LittleEndian<T::StartOfMessage>, T::START_OF_MESSAGE_SENTINEL>>
+      , Field<F::message_length,        Literal<LittleEndian<T::MessageLength>, 8>>
+      , Field<F::message_type,          Literal<Byte, static_cast<std::uint8_t>(T::MessageType::LOGOUT_REQUEST)>>
+      , Field<F::matching_unit,         Literal<LittleEndian<T::MatchingUnit>, 0>>
+      , Field<F::sequence_number,       LittleEndian<T::SequenceNumber>>
+    >;
+    static_assert(LogoutRequest::SIZE == 10, "BOE20 LogoutRequest is 10 bytes.");
+
+    using ClientHeartbeat = Message<
+        Field<F::start_of_message,      Literal<LittleEndian<T::StartOfMessage>, T::START_OF_MESSAGE_SENTINEL>>
+      , Field<F::message_length,        Literal<LittleEndian<T::MessageLength>, 8>>
+      , Field<F::message_type,          Literal<Byte, static_cast<std::uint8_t>(T::MessageType::CLIENT_HEARTBEAT)>>
+      , Field<F::matching_unit,         Literal<LittleEndian<T::MatchingUnit>, 0>>
+      , Field<F::sequence_number,       LittleEndian<T::SequenceNumber>>
+    >;
+    static_assert(ClientHeartbeat::SIZE == 10, "BOE20 ClientHeartbeat is 10 bytes.");
+
+    constexpr std::size_t NEW_ORDER_SIZE = sizeof(Messages::NewOrder) + 6 + sizeof(Messages::NewOrder::OptionalFields);
+
+    constexpr std::uint8_t NEW_ORDER_BITFIELD1 =
+        static_cast<std::uint8_t>(T::NewOrderBitfield1::CLEARING_FIRM)
+      | static_cast<std::uint8_t>(T::NewOrderBitfield1::CLEARING_ACCOUNT)
+      | static_cast<std::uint8_t>(T::NewOrderBitfield1::PRICE)
+      | static_cast<std::uint8_t>(T::NewOrderBitfield1::EXEC_INST)
+      | static_cast<std::uint8_t>(T::NewOrderBitfield1::ORD_TYPE)
+      | static_cast<std::uint8_t>(T::NewOrderBitfield1::TIME_IN_FORCE)
+      | static_cast<std::uint8_t>(T::NewOrderBitfield1::MIN_QTY)
+      | static_cast<std::uint8_t>(T::NewOrderBitfield1::MAX_FLOOR);
+    constexpr std::uint8_t NEW_ORDER_BITFIELD2 =
+        static_cast<std::uint8_t>(T::NewOrderBitfield2::SYMBOL)
+      | static_cast<std::uint8_t>(T::NewOrderBitfield2::CAPACITY)
+      | static_cast<std::uint8_t>(T::NewOrderBitfield2::ROUTING_INST);
+    constexpr std::uint8_t NEW_ORDER_BITFIELD3 =
+        static_cast<std::uint8_t>(T::NewOrderBitfield3::ACCOUNT)
+      | static_cast<std::uint8_t>(T::NewOrderBitfield3::DISPLAY_INDICATOR)
+      | static_cast<std::uint8_t>(T::NewOrderBitfield3::MAX_REMOVE_PCT)
+      | static_cast<std::uint8_t>(T::NewOrderBitfield3::DISCRETION_AMOUNT)
+      | static_cast<std::uint8_t>(T::NewOrderBitfield3::PEG_DIFFERENCE);
+    constexpr std::uint8_t NEW_ORDER_BITFIELD5 =
+        static_cast<std::uint8_t>(T::NewOrderBitfield5::ATTRIBUTED_QUOTE)
+      | static_cast<std::uint8_t>(T::NewOrderBitfield5::EXT_EXEC_INST);
+
+    using NewOrder = Message<
+        Field<F::start_of_message,      Literal<LittleEndian<T::StartOfMessage>, T::START_OF_MESSAGE_SENTINEL>>
+        // the length leaves out the start of message
+      , Field<F::message_length,        Literal<LittleEndian<T::MessageLength>, NEW_ORDER_SIZE - sizeof(T::StartOfMessage)>>
+      , Field<F::message_type,          Literal<Byte, static_cast<std::uint8_t>(T::MessageType::NEW_ORDER_V2)>>
+      , Field<F::matching_unit,         Literal<LittleEndian<T::MatchingUnit>, 0>>
+      , Field<F::sequence_number,       LittleEndian<T::SequenceNumber>>
+      , Field<F::cl_ord_id,             Text<20>>
+      , Field<F::side,                  LittleEndian<T::Side>>
+      , Field<F::order_qty,             LittleEndian<T::Quantity>>
+      , Field<F::num_bitfields,         Literal<Byte, 6>>
+      , Field<F::bitfield1,             Literal<Byte, NEW_ORDER_BITFIELD1>>
+      , Field<F::bitfield2,             Literal<Byte, NEW_ORDER_BITFIELD2>>
+      , Field<F::bitfield3,             Literal<Byte, NEW_ORDER_BITFIELD3>>
+      , Field<F::bitfield4,             Literal<Byte, 0>>
+      , Field<F::bitfield5,             Literal<Byte, NEW_ORDER_BITFIELD5>>
+      , Field<F::bitfield6,             Literal<Byte, 0>>
+      , Field<F::clearing_firm,         Text<4>>
+      , Field<F::clearing_account,      Text<4>>
+      , Field<F::price,                 Price>
+      , Field<F::exec_inst,             LittleEndian<T::ExecInst>>
+      , Field<F::ord_type,              LittleEndian<T::OrdType>>
+      , Field<F::time_in_force,         LittleEndian<T::TimeInForce>>
+      , Field<F::min_qty,               LittleEndian<T::MinQty>>
+      , Field<F::max_floor,             LittleEndian<T::MaxFloor>>
+      , Field<F::symbol,                Text<8>>
+      , Field<F::capacity,              LittleEndian<T::Capacity>>
+      , Field<F::routing_inst,          Text<4>>
+      , Field<F::account,               Text<16>>
+      , Field<F::display_indicator,     LittleEndian<T::DisplayIndicator>>
+      , Field<F::max_remove_pct,        LittleEndian<T::MaxRemovePct>>
+      , Field<F::discretion_amount,     LittleEndian<T::DiscretionAmount>>
+      , Field<F::peg_difference,        LittleEndian<T::PegDifference>>
+      , Field<F::attributed_quote,      Byte>
+      , Field<F::ext_exec_inst,         Byte>
+    >;
+    static_assert(NewOrder::SIZE == NEW_ORDER_SIZE, "BOE20 NewOrder as BOE20Session sends it.");
+
+    constexpr std::size_t CANCEL_ORDER_SIZE = sizeof(Messages::CancelOrder) + 1 + sizeof(Messages::CancelOrder::OptionalFields);
+
+    using CancelOrder = Message<
+        Field<F::start_of_message,      Literal<LittleEndian<T::StartOfMessage>, T::START_OF_MESSAGE_SENTINEL>>
+      , Field<F::message_length,        Literal<LittleEndian<T::MessageLength>, CANCEL_ORDER_SIZE - sizeof(T::StartOfMessage)>>
+      , Field<F::message_type,          Literal<Byte, static_cast<std::uint8_t>(T::MessageType::CANCEL_ORDER_V2)>>
+      , Field<F::matching_unit,         Literal<LittleEndian<T::MatchingUnit>, 0>>
+      , Field<F::sequence_number,       LittleEndian<T::SequenceNumber>>
+      , Field<F::orig_cl_ord_id,        Text<20>>
+      , Field<F::num_bitfields,         Literal<Byte, 1>>
+      , Field<F::bitfield1,             Literal<Byte, static_cast<std::uint8_t>(T::CancelOrderBitfield1::CLEARING_FIRM)>>
+      , Field<F::clearing_firm,         Text<4>>
+    >;
+    static_assert(CancelOrder::SIZE == CANCEL_ORDER_SIZE, "BOE20 CancelOrder as BOE20Session sends it.");
+
+    constexpr std::uint8_t MODIFY_ORDER_BITFIELD1 =
+        static_cast<std::uint8_t>(T::ModifyOrderBitfield1::CLEARING_FIRM)
+      | static_cast<std::uint8_t>(T::ModifyOrderBitfield1::ORDER_QTY)
+      | static_cast<std::uint8_t>(T::ModifyOrderBitfield1::PRICE)
+      | static_cast<std::uint8_t>(T::ModifyOrderBitfield1::ORD_TYPE)
+      | static_cast<std::uint8_t>(T::ModifyOrderBitfield1::CANCEL_ORIG_ON_REJECT)
+      | static_cast<std::uint8_t>(T::ModifyOrderBitfield1::EXEC_INST)
+      | static_cast<std::uint8_t>(T::ModifyOrderBitfield1::SIDE);
+
+    /// Bitfield 2 is sent empty, as HPR wants, but max_floor is sent all
+    //  the same.
+    using ModifyOrder = Message<
+        Field<F::start_of_message,      Literal<LittleEndian<T::StartOfMessage>, T::START_OF_MESSAGE_SENTINEL>>
+      , Field<F::message_length,        Literal<LittleEndian<T::MessageLength>, 75>>
+      , Field<F::message_type,          Literal<Byte, static_cast<std::uint8_t>(T::MessageType::MODIFY_ORDER_V2)>>
+      , Field<F::matching_unit,         Literal<LittleEndian<T::MatchingUnit>, 0>>
+      , Field<F::sequence_number,       LittleEndian<T::SequenceNumber>>
+      , Field<F::new_cl_ord_id,         Text<20>>
+      , Field<F::orig_cl_ord_id,        Text<20>>
+      , Field<F::num_bitfields,         Literal<Byte, 2>>
+      , Field<F::bitfield1,             Literal<Byte, MODIFY_ORDER_BITFIELD1>>
+      , Field<F::bitfield2,             Literal<Byte, 0>>
+      , Field<F::clearing_firm,         Text<4>>
+      , Field<F::order_qty,             LittleEndian<T::OrderQty>>
+      , Field<F::price,                 Price>
+      , Field<F::ord_type,              LittleEndian<T::OrdType>>
+      , Field<F::cancel_orig_on_reject, LittleEndian<T::CancelOrigOnReject>>
+      , Field<F::exec_inst,             LittleEndian<T::ExecInst>>
+      , Field<F::side,                  LittleEndian<T::Side>>
+      , Field<F::max_floor,             LittleEndian<T::MaxFloor>>
+    >;
+    static_assert(ModifyOrder::SIZE == sizeof(Messages::ModifyOrder) + 2 + sizeof(Messages::ModifyOrder::OptionalFields),
+                  "BOE20 ModifyOrder as BOE20Session sends it.");
+
+    using LoginResponse = Message<
+        Field<F::start_of_message,      Literal<LittleEndian<T::StartOfMessage>, T::START_OF_MESSAGE_SENTINEL>>
+        // the length counts the UnitNumberSequencePairs that follow
+      , Field<F::message_length,        LittleEndian<T::MessageLength>>
+      , Field<F::message_type,          Literal<Byte, static_cast<std::uint8_t>(T::MessageType::LOGIN_RESPONSE_V2)>>
+      , Field<F::matching_unit,         LittleEndian<T::MatchingUnit>>
+      , Field<F::sequence_number,       LittleEndian<T::SequenceNumber>>
+      , Field<F::login_response_status, LittleEndian<T::LoginResponseStatus>>
+      , Field<F::login_response_text,   Text<60>>
+      , Field<F::no_unspecified_unit_replay, LittleEndian<T::BooleanFlag>>
+      , Field<F::last_received_sequence_number, LittleEndian<T::SequenceNumber>>
+      , Field<F::number_of_units,       LittleEndian<T::NumberOfUnits>>
+    >;
+    static_assert(LoginResponse::SIZE == 77, "BOE20 LoginResponse is 77 bytes.");
+
+    using Logout = Message<
+        Field<F::start_of_message,      Literal<LittleEndian<T::StartOfMessage>, T::START_OF_MESSAGE_SENTINEL>>
+        // the length counts the UnitNumberSequencePairs that follow
+      , Field<F::message_length,        LittleEndian<T::MessageLength>>
+      , Field<F::message_type,          Literal<Byte, static_cast<std::uint8_t>(T::MessageType::LOGOUT)>>
+      , Field<F::matching_unit,         LittleEndian<T::MatchingUnit>>
+      , Field<F::sequence_number,       LittleEndian<T::SequenceNumber>>
+      , Field<F::logout_reason,         LittleEndian<T::LogoutReason>>
+      , Field<F::logout_reason_text,    Text<60>>
+      , Field<F::last_received_sequence_number, LittleEndian<T::SequenceNumber>>
+      , Field<F::number_of_units,       LittleEndian<T::NumberOfUnits>>
+    >;
+    static_assert(Logout::SIZE == 76, "BOE20 Logout is 76 bytes.");
+
+    using ServerHeartbeat = Message<
+        Field<F::start_of_message,      Literal<LittleEndian<T::StartOfMessage>, T::START_OF_MESSAGE_SENTINEL>>
+      , Field<F::message_length,        Literal<LittleEndian<T::MessageLength>, 8>>
+      , Field<F::message_type,          Literal<Byte, static_cast<std::uint8_t>(T::MessageType::SERVER_HEARTBEAT)>>
+      , Field<F::matching_unit,         LittleEndian<T::MatchingUnit>>
+      , Field<F::sequence_number,       LittleEndian<T::SequenceNumber>>
+    >;
+    static_assert(ServerHeartbeat::SIZE == 10, "BOE20 ServerHeartbeat is 10 bytes.");
+
+    using ReplayComplete = Message<
+        Field<F::start_of_message,      Literal<LittleEndian<T::StartOfMessage>, T::START_OF_MESSAGE_SENTINEL>>
+      , Field<F::message_length,        Literal<LittleEndian<T::MessageLength>, 8>>
+      , Field<F::message_type,          Literal<Byte, static_cast<std::uint8_t>(T::MessageType::REPLAY_COMPLETE)>>
+      , Field<F::matching_unit,         LittleEndian<T::MatchingUnit>>
+      , Field<F::sequence_number,       LittleEndian<T::SequenceNumber>>
+    >;
+    static_assert(ReplayComplete::SIZE == 10, "BOE20 ReplayComplete is 10 bytes.");
+
+    /// The return bitfields send_login_request asks for: each response is
+    //  the fixed message, its eight bitfields, then the fields they select.
+    constexpr std::uint8_t RETURN_BITFIELD1 = 0xFF;
+    constexpr std::uint8_t RETURN_BITFIELD2 =
+        static_cast<std::uint8_t>(T::OrderAcknowledgmentBitfield2::SYMBOL)
+      | static_cast<std::uint8_t>(T::OrderAcknowledgmentBitfield2::CAPACITY);
+    constexpr std::uint8_t RETURN_BITFIELD3 =
+        static_cast<std::uint8_t>(T::OrderAcknowledgmentBitfield3::ACCOUNT)
+      | static_cast<std::uint8_t>(T::OrderAcknowledgmentBitfield3::CLEARING_FIRM)
+      | static_cast<std::uint8_t>(T::OrderAcknowledgmentBitfield3::CLEARING_ACCOUNT)
+      | static_cast<std::uint8_t>(T::OrderAcknowledgmentBitfield3::DISPLAY_INDICATOR)
+      | static_cast<std::uint8_t>(T::OrderAcknowledgmentBitfield3::MAX_FLOOR)
+      | static_cast<std::uint8_t>(T::OrderAcknowledgmentBitfield3::DISCRETION_AMOUNT)
+      | static_cast<std::uint8_t>(T::OrderAcknowledgmentBitfield3::ORDER_QTY);
+    constexpr std::uint8_t ACK_RETURN_BITFIELD5 =
+        static_cast<std::uint8_t>(T::OrderAcknowledgmentBitfield5::LEAVES_QTY)
+      | static_cast<std::uint8_t>(T::OrderAcknowledgmentBitfield5::DISPLAY_PRICE)
+      | static_cast<std::uint8_t>(T::OrderAcknowledgmentBitfield5::WORKING_PRICE);
+    constexpr std::uint8_t MODIFIED_RETURN_BITFIELD5 =
+        static_cast<std::uint8_t>(T::OrderModifiedBitfield5::ORIG_CL_ORD_ID) | ACK_RETURN_BITFIELD5;
+    constexpr std::uint8_t CANCELLED_RETURN_BITFIELD5 =
+        static_cast<std::uint8_t>(T::OrderCancelledBitfield5::LEAVES_QTY);
+    constexpr std::uint8_t RETURN_BITFIELD6 =
+        static_cast<std::uint8_t>(T::OrderAcknowledgmentBitfield6::ATTRIBUTED_QUOTE)
+      | static_cast<std::uint8_t>(T::OrderAcknowledgmentBitfield6::EXT_EXEC_INST);
+    constexpr std::uint8_t RETURN_BITFIELD8 =
+        static_cast<std::uint8_t>(T::OrderAcknowledgmentBitfield8::ROUTING_INST);
+    constexpr std::uint8_t EXECUTION_RETURN_BITFIELD8 =
+        static_cast<std::uint8_t>(T::OrderExecutionBitfield8::FEE_CODE)
+      | static_cast<std::uint8_t>(T::OrderExecutionBitfield8::ROUTING_INST);
+
+    using OrderAcknowledgment = Message<
+        Field<F::start_of_message,      Literal<LittleEndian<T::StartOfMessage>, T::START_OF_MESSAGE_SENTINEL>>
+      , Field<F::message_length,        Literal<LittleEndian<T::MessageLength>, 149>>
+      , Field<F::message_type,          Literal<Byte, static_cast<std::uint8_t>(T::MessageType::ORDER_ACKNOWLEDGMENT_V2)>>
+      , Field<F::matching_unit,         LittleEndian<T::MatchingUnit>>
+      , Field<F::sequence_number,       LittleEndian<T::SequenceNumber>>
+      , Field<F::transaction_time,      LittleEndian<T::DateTime>>
+      , Field<F::cl_ord_id,             Text<20>>
+      , Field<F::order_id,              LittleEndian<T::OrderID>>
+      , Field<F::reserved,              Filler<1>>
+      , Field<F::number_of_return_bitfields, Literal<Byte, 8>>
+      , Field<F::bitfield1,             Literal<Byte, RETURN_BITFIELD1>>
+      , Field<F::bitfield2,             Literal<Byte, RETURN_BITFIELD2>>
+      , Field<F::bitfield3,             Literal<Byte, RETURN_BITFIELD3>>
+      , Field<F::bitfield4,             Literal<Byte, 0>>
+      , Field<F::bitfield5,             Literal<Byte, ACK_RETURN_BITFIELD5>>
+      , Field<F::bitfield6,             Literal<Byte, RETURN_BITFIELD6>>
+      , Field<F::bitfield7,             Literal<Byte, 0>>
+      , Field<F::bitfield8,             Literal<Byte, RETURN_BITFIELD8>>
+      , Field<F::side,                  LittleEndian<T::Side>>
+      , Field<F::peg_difference,        LittleEndian<T::PegDifference>>
+      , Field<F::price,                 Price>
+      , Field<F::exec_inst,             LittleEndian<T::ExecInst>>
+      , Field<F::ord_type,              LittleEndian<T::OrdType>>
+      , Field<F::time_in_force,         LittleEndian<T::TimeInForce>>
+      , Field<F::min_qty,               LittleEndian<T::MinQty>>
+      , Field<F::max_remove_pct,        LittleEndian<T::MaxRemovePct>>
+      , Field<F::symbol,                Text<8>>
+      , Field<F::capacity,              LittleEndian<T::Capacity>>
+      , Field<F::account,               Text<16>>
+      , Field<F::clearing_firm,         Text<4>>
+      , Field<F::clearing_account,      Text<4>>
+      , Field<F::display_indicator,     LittleEndian<T::DisplayIndicator>>
+      , Field<F::max_floor,             LittleEndian<T::MaxFloor>>
+      , Field<F::discretion_amount,     LittleEndian<T::DiscretionAmount>>
+      , Field<F::order_qty,             LittleEndian<T::OrderQty>>
+      , Field<F::leaves_qty,            LittleEndian<T::LeavesQty>>
+      , Field<F::display_price,         Price>
+      , Field<F::working_price,         Price>
+      , Field<F::attributed_quote,      Byte>
+      , Field<F::ext_exec_inst,         Byte>
+      , Field<F::routing_inst,          Text<4>>
+    >;
+    static_assert(OrderAcknowledgment::SIZE == sizeof(Messages::OrderAcknowledgment) + 8 + sizeof(Messages::OrderAcknowledgment::OptionalFields),
+                  "BOE20 OrderAcknowledgment with the return bitfields BOE20Session asks for.");
+
+    using OrderRejected = Message<
+        Field<F::start_of_message,      Literal<LittleEndian<T::StartOfMessage>, T::START_OF_MESSAGE_SENTINEL>>
+      , Field<F::message_length,        Literal<LittleEndian<T::MessageLength>, 182>>
+      , Field<F::message_type,          Literal<Byte, static_cast<std::uint8_t>(T::MessageType::ORDER_REJECTED_V2)>>
+      , Field<F::matching_unit,         LittleEndian<T::MatchingUnit>>
+      , Field<F::sequence_number,       LittleEndian<T::SequenceNumber>>
+      , Field<F::transaction_time,      LittleEndian<T::DateTime>>
+      , Field<F::cl_ord_id,             Text<20>>
+      , Field<F::order_reject_reason,   LittleEndian<T::ReasonCode>>
+      , Field<F::text,                  Text<60>>
+      , Field<F::reserved,              Filler<1>>
+      , Field<F::number_of_return_bitfields, Literal<Byte, 8>>
+      , Field<F::bitfield1,             Literal<Byte, RETURN_BITFIELD1>>
+      , Field<F::bitfield2,             Literal<Byte, RETURN_BITFIELD2>>
+      , Field<F::bitfield3,             Literal<Byte, RETURN_BITFIELD3>>
+      , Field<F::bitfield4,             Literal<Byte, 0>>
+      , Field<F::bitfield5,             Literal<Byte, 0>>
+      , Field<F::bitfield6,             Literal<Byte, RETURN_BITFIELD6>>
+      , Field<F::bitfield7,             Literal<Byte, 0>>
+      , Field<F::bitfield8,             Literal<Byte, RETURN_BITFIELD8>>
+      , Field<F::side,                  LittleEndian<T::Side>>
+      , Field<F::peg_difference,        LittleEndian<T::PegDifference>>
+      , Field<F::price,                 Price>
+      , Field<F::exec_inst,             LittleEndian<T::ExecInst>>
+      , Field<F::ord_type,              LittleEndian<T::OrdType>>
+      , Field<F::time_in_force,         LittleEndian<T::TimeInForce>>
+      , Field<F::min_qty,               LittleEndian<T::MinQty>>
+      , Field<F::max_remove_pct,        LittleEndian<T::MaxRemovePct>>
+      , Field<F::symbol,                Text<8>>
+      , Field<F::capacity,              LittleEndian<T::Capacity>>
+      , Field<F::account,               Text<16>>
+      , Field<F::clearing_firm,         Text<4>>
+      , Field<F::clearing_account,      Text<4>>
+      , Field<F::display_indicator,     LittleEndian<T::DisplayIndicator>>
+      , Field<F::max_floor,             LittleEndian<T::MaxFloor>>
+      , Field<F::discretion_amount,     LittleEndian<T::DiscretionAmount>>
+      , Field<F::order_qty,             LittleEndian<T::OrderQty>>
+      , Field<F::attributed_quote,      Byte>
+      , Field<F::ext_exec_inst,         Byte>
+      , Field<F::routing_inst,          Text<4>>
+    >;
+    static_assert(OrderRejected::SIZE == sizeof(Messages::OrderRejected) + 8 + sizeof(Messages::OrderRejected::OptionalFields),
+                  "BOE20 OrderRejected with the return bitfields BOE20Session asks for.");
+
+    using OrderModified = Message<
+        Field<F::start_of_message,      Literal<LittleEndian<T::StartOfMessage>, T::START_OF_MESSAGE_SENTINEL>>
+      , Field<F::message_length,        Literal<LittleEndian<T::MessageLength>, 160>>
+      , Field<F::message_type,          Literal<Byte, static_cast<std::uint8_t>(T::MessageType::ORDER_MODIFIED_V2)>>
+      , Field<F::matching_unit,         LittleEndian<T::MatchingUnit>>
+      , Field<F::sequence_number,       LittleEndian<T::SequenceNumber>>
+      , Field<F::transaction_time,      LittleEndian<T::DateTime>>
+      , Field<F::cl_ord_id,             Text<20>>
+      , Field<F::order_id,              LittleEndian<T::OrderID>>
+      , Field<F::reserved,              Filler<1>>
+      , Field<F::number_of_return_bitfields, Literal<Byte, 8>>
+      , Field<F::bitfield1,             Literal<Byte, RETURN_BITFIELD1>>
+      , Field<F::bitfield2,             Literal<Byte, 0>>
+      , Field<F::bitfield3,             Literal<Byte, RETURN_BITFIELD3>>
+      , Field<F::bitfield4,             Literal<Byte, 0>>
+      , Field<F::bitfield5,             Literal<Byte, MODIFIED_RETURN_BITFIELD5>>
+      , Field<F::bitfield6,             Literal<Byte, RETURN_BITFIELD6>>
+      , Field<F::bitfield7,             Literal<Byte, 0>>
+      , Field<F::bitfield8,             Literal<Byte, RETURN_BITFIELD8>>
+      , Field<F::side,                  LittleEndian<T::Side>>
+      , Field<F::peg_difference,        LittleEndian<T::PegDifference>>
+      , Field<F::price,                 Price>
+      , Field<F::exec_inst,             LittleEndian<T::ExecInst>>
+      , Field<F::ord_type,              LittleEndian<T::OrdType>>
+      , Field<F::time_in_force,         LittleEndian<T::TimeInForce>>
+      , Field<F::min_qty,               LittleEndian<T::MinQty>>
+      , Field<F::max_remove_pct,        LittleEndian<T::MaxRemovePct>>
+      , Field<F::account,               Text<16>>
+      , Field<F::clearing_firm,         Text<4>>
+      , Field<F::clearing_account,      Text<4>>
+      , Field<F::display_indicator,     LittleEndian<T::DisplayIndicator>>
+      , Field<F::max_floor,             LittleEndian<T::MaxFloor>>
+      , Field<F::discretion_amount,     LittleEndian<T::DiscretionAmount>>
+      , Field<F::order_qty,             LittleEndian<T::OrderQty>>
+      , Field<F::orig_cl_ord_id,        Text<20>>
+      , Field<F::leaves_qty,            LittleEndian<T::LeavesQty>>
+      , Field<F::display_price,         Price>
+      , Field<F::working_price,         Price>
+      , Field<F::attributed_quote,      Byte>
+      , Field<F::ext_exec_inst,         Byte>
+      , Field<F::routing_inst,          Text<4>>
+    >;
+    static_assert(OrderModified::SIZE == sizeof(Messages::OrderModified) + 8 + sizeof(Messages::OrderModified::OptionalFields),
+                  "BOE20 OrderModified with the return bitfields BOE20Session asks for.");
+
+    using OrderRestated = Message<
+        Field<F::start_of_message,      Literal<LittleEndian<T::StartOfMessage>, T::START_OF_MESSAGE_SENTINEL>>
+      , Field<F::message_length,        Literal<LittleEndian<T::MessageLength>, 170>>
+      , Field<F::message_type,          Literal<Byte, static_cast<std::uint8_t>(T::MessageType::ORDER_RESTATED_V2)>>
+      , Field<F::matching_unit,         LittleEndian<T::MatchingUnit>>
+      , Field<F::sequence_number,       LittleEndian<T::SequenceNumber>>
+      , Field<F::transaction_time,      LittleEndian<T::DateTime>>
+      , Field<F::cl_ord_id,             Text<20>>
+      , Field<F::order_id,              LittleEndian<T::OrderID>>
+      , Field<F::restatement_reason,    LittleEndian<T::RestatementReason>>
+      , Field<F::reserved,              Filler<1>>
+      , Field<F::number_of_return_bitfields, Literal<Byte, 8>>
+      , Field<F::bitfield1,             Literal<Byte, RETURN_BITFIELD1>>
+      , Field<F::bitfield2,             Literal<Byte, RETURN_BITFIELD2>>
+      , Field<F::bitfield3,             Literal<Byte, RETURN_BITFIELD3>>
+      , Field<F::bitfield4,             Literal<Byte, 0>>
+      , Field<F::bitfield5,             Literal<Byte, MODIFIED_RETURN_BITFIELD5>>
+      , Field<F::bitfield6,             Literal<Byte, RETURN_BITFIELD6>>
+      , Field<F::bitfield7,             Literal<Byte, 0>>
+      , Field<F::bitfield8,             Literal<Byte, RETURN_BITFIELD8>>
+      , Field<F::side,                  LittleEndian<T::Side>>
+      , Field<F::peg_difference,        LittleEndian<T::PegDifference>>
+      , Field<F::price,                 Price>
+      , Field<F::exec_inst,             LittleEndian<T::ExecInst>>
+      , Field<F::ord_type,              LittleEndian<T::OrdType>>
+      , Field<F::time_in_force,         LittleEndian<T::TimeInForce>>
+      , Field<F::min_qty,               LittleEndian<T::MinQty>>
+      , Field<F::max_remove_pct,        LittleEndian<T::MaxRemovePct>>
+      , Field<F::symbol,                Text<8>>
+      , Field<F::capacity,              LittleEndian<T::Capacity>>
+      , Field<F::account,               Text<16>>
+      , Field<F::clearing_firm,         Text<4>>
+      , Field<F::clearing_account,      Text<4>>
+      , Field<F::display_indicator,     LittleEndian<T::DisplayIndicator>>
+      , Field<F::max_floor,             LittleEndian<T::MaxFloor>>
+      , Field<F::discretion_amount,     LittleEndian<T::DiscretionAmount>>
+      , Field<F::order_qty,             LittleEndian<T::OrderQty>>
+      , Field<F::orig_cl_ord_id,        Text<20>>
+      , Field<F::leaves_qty,            LittleEndian<T::LeavesQty>>
+      , Field<F::display_price,         Price>
+      , Field<F::working_price,         Price>
+      , Field<F::attributed_quote,      Byte>
+      , Field<F::ext_exec_inst,         Byte>
+      , Field<F::routing_inst,          Text<4>>
+    >;
+    static_assert(OrderRestated::SIZE == sizeof(Messages::OrderRestated) + 8 + sizeof(Messages::OrderRestated::OptionalFields),
+                  "BOE20 OrderRestated with the return bitfields BOE20Session asks for.");
+
+    using UserModifyRejected = Message<
+        Field<F::start_of_message,      Literal<LittleEndian<T::StartOfMessage>, T::START_OF_MESSAGE_SENTINEL>>
+      , Field<F::message_length,        Literal<LittleEndian<T::MessageLength>, 107>>
+      , Field<F::message_type,          Literal<Byte, static_cast<std::uint8_t>(T::MessageType::USER_MODIFY_REJECTED_V2)>>
+      , Field<F::matching_unit,         LittleEndian<T::MatchingUnit>>
+      , Field<F::sequence_number,       LittleEndian<T::SequenceNumber>>
+      , Field<F::transaction_time,      LittleEndian<T::DateTime>>
+      , Field<F::cl_ord_id,             Text<20>>
+      , Field<F::modify_reject_reason,  LittleEndian<T::ReasonCode>>
+      , Field<F::text,                  Text<60>>
+      , Field<F::reserved,              Filler<1>>
+      , Field<F::num_bitfields,         Literal<Byte, 8>>
+      , Field<F::bitfield1,             Literal<Byte, 0>>
+      , Field<F::bitfield2,             Literal<Byte, 0>>
+      , Field<F::bitfield3,             Literal<Byte, 0>>
+      , Field<F::bitfield4,             Literal<Byte, 0>>
+      , Field<F::bitfield5,             Literal<Byte, 0>>
+      , Field<F::bitfield6,             Literal<Byte, 0>>
+      , Field<F::bitfield7,             Literal<Byte, 0>>
+      , Field<F::bitfield8,             Literal<Byte, 0>>
+    >;
+    static_assert(UserModifyRejected::SIZE == sizeof(Messages::UserModifyRejected) + 8,
+                  "BOE20 UserModifyRejected with the return bitfields BOE20Session asks for.");
+
+    using OrderCancelled = Message<
+        Field<F::start_of_message,      Literal<LittleEndian<T::StartOfMessage>, T::START_OF_MESSAGE_SENTINEL>>
+      , Field<F::message_length,        Literal<LittleEndian<T::MessageLength>, 126>>
+      , Field<F::message_type,          Literal<Byte, static_cast<std::uint8_t>(T::MessageType::ORDER_CANCELLED_V2)>>
+      , Field<F::matching_unit,         LittleEndian<T::MatchingUnit>>
+      , Field<F::sequence_number,       LittleEndian<T::SequenceNumber>>
+      , Field<F::transaction_time,      LittleEndian<T::DateTime>>
+      , Field<F::cl_ord_id,             Text<20>>
+      , Field<F::cancel_reason,         LittleEndian<T::ReasonCode>>
+      , Field<F::reserved,              Filler<1>>
+      , Field<F::number_of_return_bitfields, Literal<Byte, 8>>
+      , Field<F::bitfield1,             Literal<Byte, RETURN_BITFIELD1>>
+      , Field<F::bitfield2,             Literal<Byte, RETURN_BITFIELD2>>
+      , Field<F::bitfield3,             Literal<Byte, RETURN_BITFIELD3>>
+      , Field<F::bitfield4,             Literal<Byte, 0>>
+      , Field<F::bitfield5,             Literal<Byte, CANCELLED_RETURN_BITFIELD5>>
+      , Field<F::bitfield6,             Literal<Byte, RETURN_BITFIELD6>>
+      , Field<F::bitfield7,             Literal<Byte, 0>>
+      , Field<F::bitfield8,             Literal<Byte, RETURN_BITFIELD8>>
+      , Field<F::side,                  LittleEndian<T::Side>>
+      , Field<F::peg_difference,        LittleEndian<T::PegDifference>>
+      , Field<F::price,                 Price>
+      , Field<F::exec_inst,             LittleEndian<T::ExecInst>>
+      , Field<F::ord_type,              LittleEndian<T::OrdType>>
+      , Field<F::time_in_force,         LittleEndian<T::TimeInForce>>
+      , Field<F::min_qty,               LittleEndian<T::MinQty>>
+      , Field<F::max_remove_pct,        LittleEndian<T::MaxRemovePct>>
+      , Field<F::symbol,                Text<8>>
+      , Field<F::capacity,              LittleEndian<T::Capacity>>
+      , Field<F::account,               Text<16>>
+      , Field<F::clearing_firm,         Text<4>>
+      , Field<F::clearing_account,      Text<4>>
+      , Field<F::display_indicator,     LittleEndian<T::DisplayIndicator>>
+      , Field<F::max_floor,             LittleEndian<T::MaxFloor>>
+      , Field<F::discretion_amount,     LittleEndian<T::DiscretionAmount>>
+      , Field<F::order_qty,             LittleEndian<T::OrderQty>>
+      , Field<F::leaves_qty,            LittleEndian<T::LeavesQty>>
+      , Field<F::attributed_quote,      Byte>
+      , Field<F::ext_exec_inst,         Byte>
+      , Field<F::routing_inst,          Text<4>>
+    >;
+    static_assert(OrderCancelled::SIZE == sizeof(Messages::OrderCancelled) + 8 + sizeof(Messages::OrderCancelled::OptionalFields),
+                  "BOE20 OrderCancelled with the return bitfields BOE20Session asks for.");
+
+    using CancelRejected = Message<
+        Field<F::start_of_message,      Literal<LittleEndian<T::StartOfMessage>, T::START_OF_MESSAGE_SENTINEL>>
+      , Field<F::message_length,        Literal<LittleEndian<T::MessageLength>, 141>>
+      , Field<F::message_type,          Literal<Byte, static_cast<std::uint8_t>(T::MessageType::CANCEL_REJECTED_V2)>>
+      , Field<F::matching_unit,         LittleEndian<T::MatchingUnit>>
+      , Field<F::sequence_number,       LittleEndian<T::SequenceNumber>>
+      , Field<F::transaction_time,      LittleEndian<T::DateTime>>
+      , Field<F::cl_ord_id,             Text<20>>
+      , Field<F::cancel_reject_reason,  LittleEndian<T::ReasonCode>>
+      , Field<F::text,                  Text<60>>
+      , Field<F::reserved,              Filler<1>>
+      , Field<F::number_of_return_bitfields, Literal<Byte, 8>>
+      , Field<F::bitfield1,             Literal<Byte, RETURN_BITFIELD1>>
+      , Field<F::bitfield2,             Literal<Byte, RETURN_BITFIELD2>>
+      , Field<F::bitfield3,             Literal<Byte, 0>>
+      , Field<F::bitfield4,             Literal<Byte, 0>>
+      , Field<F::bitfield5,             Literal<Byte, 0>>
+      , Field<F::bitfield6,             Literal<Byte, 0>>
+      , Field<F::bitfield7,             Literal<Byte, 0>>
+      , Field<F::bitfield8,             Literal<Byte, 0>>
+      , Field<F::side,                  LittleEndian<T::Side>>
+      , Field<F::peg_difference,        LittleEndian<T::PegDifference>>
+      , Field<F::price,                 Price>
+      , Field<F::exec_inst,             LittleEndian<T::ExecInst>>
+      , Field<F::ord_type,              LittleEndian<T::OrdType>>
+      , Field<F::time_in_force,         LittleEndian<T::TimeInForce>>
+      , Field<F::min_qty,               LittleEndian<T::MinQty>>
+      , Field<F::max_remove_pct,        LittleEndian<T::MaxRemovePct>>
+      , Field<F::symbol,                Text<8>>
+      , Field<F::capacity,              LittleEndian<T::Capacity>>
+    >;
+    static_assert(CancelRejected::SIZE == sizeof(Messages::CancelRejected) + 8 + sizeof(Messages::CancelRejected::OptionalFields),
+                  "BOE20 CancelRejected with the return bitfields BOE20Session asks for.");
+
+    using OrderExecution = Message<
+        Field<F::start_of_message,      Literal<LittleEndian<T::StartOfMessage>, T::START_OF_MESSAGE_SENTINEL>>
+      , Field<F::message_length,        Literal<LittleEndian<T::MessageLength>, 153>>
+      , Field<F::message_type,          Literal<Byte, static_cast<std::uint8_t>(T::MessageType::ORDER_EXECUTION_V2)>>
+      , Field<F::matching_unit,         LittleEndian<T::MatchingUnit>>
+      , Field<F::sequence_number,       LittleEndian<T::SequenceNumber>>
+      , Field<F::transaction_time,      LittleEndian<T::DateTime>>
+      , Field<F::cl_ord_id,             Text<20>>
+      , Field<F::exec_id,               LittleEndian<T::ExecID>>
+      , Field<F::last_shares,           LittleEndian<T::Quantity>>
+      , Field<F::last_px,               Price>
+      , Field<F::leaves_qty,            LittleEndian<T::Quantity>>
+      , Field<F::base_liquidity_indicator, LittleEndian<T::BaseLiquidityIndicator>>
+      , Field<F::sub_liquidity_indicator, LittleEndian<T::SubLiquidityIndicator>>
+      , Field<F::contra_broker,         LittleEndian<T::ContraBroker>>
+      , Field<F::reserved,              Filler<1>>
+      , Field<F::number_of_return_bitfields, Literal<Byte, 8>>
+      , Field<F::bitfield1,             Literal<Byte, RETURN_BITFIELD1>>
+      , Field<F::bitfield2,             Literal<Byte, RETURN_BITFIELD2>>
+      , Field<F::bitfield3,             Literal<Byte, RETURN_BITFIELD3>>
+      , Field<F::bitfield4,             Literal<Byte, 0>>
+      , Field<F::bitfield5,             Literal<Byte, 0>>
+      , Field<F::bitfield6,             Literal<Byte, RETURN_BITFIELD6>>
+      , Field<F::bitfield7,             Literal<Byte, 0>>
+      , Field<F::bitfield8,             Literal<Byte, EXECUTION_RETURN_BITFIELD8>>
+      , Field<F::side,                  LittleEndian<T::Side>>
+      , Field<F::peg_difference,        LittleEndian<T::PegDifference>>
+      , Field<F::price,                 Price>
+      , Field<F::exec_inst,             LittleEndian<T::ExecInst>>
+      , Field<F::ord_type,              LittleEndian<T::OrdType>>
+      , Field<F::time_in_force,         LittleEndian<T::TimeInForce>>
+      , Field<F::min_qty,               LittleEndian<T::MinQty>>
+      , Field<F::max_remove_pct,        LittleEndian<T::MaxRemovePct>>
+      , Field<F::symbol,                Text<8>>
+      , Field<F::capacity,              LittleEndian<T::Capacity>>
+      , Field<F::account,               Text<16>>
+      , Field<F::clearing_firm,         Text<4>>
+      , Field<F::clearing_account,      Text<4>>
+      , Field<F::display_indicator,     LittleEndian<T::DisplayIndicator>>
+      , Field<F::max_floor,             LittleEndian<T::MaxFloor>>
+      , Field<F::discretion_amount,     LittleEndian<T::DiscretionAmount>>
+      , Field<F::order_qty,             LittleEndian<T::OrderQty>>
+      , Field<F::attributed_quote,      Byte>
+      , Field<F::ext_exec_inst,         Byte>
+      , Field<F::fee_code,              Text<2>>
+      , Field<F::routing_inst,          Text<4>>
+    >;
+    static_assert(OrderExecution::SIZE == sizeof(Messages::OrderExecution) + 8 + sizeof(Messages::OrderExecution::OptionalFields),
+                  "BOE20 OrderExecution with the return bitfields BOE20Session asks for.");
+
+    using TradeCancelOrCorrect = Message<
+        Field<F::start_of_message,      Literal<LittleEndian<T::StartOfMessage>, T::START_OF_MESSAGE_SENTINEL>>
+      , Field<F::message_length,        Literal<LittleEndian<T::MessageLength>, 109>>
+      , Field<F::message_type,          Literal<Byte, static_cast<std::uint8_t>(T::MessageType::TRADE_CANCEL_OR_CORRECT_V2)>>
+      , Field<F::matching_unit,         LittleEndian<T::MatchingUnit>>
+      , Field<F::sequence_number,       LittleEndian<T::SequenceNumber>>
+      , Field<F::transaction_time,      LittleEndian<T::DateTime>>
+      , Field<F::cl_ord_id,             Text<20>>
+      , Field<F::order_id,              LittleEndian<T::OrderID>>
+      , Field<F::exec_ref_id,           LittleEndian<T::ExecID>>
+      , Field<F::side,                  LittleEndian<T::Side>>
+      , Field<F::base_liquidity_indicator, LittleEndian<T::BaseLiquidityIndicator>>
+      , Field<F::clearing_firm,         Text<4>>
+      , Field<F::clearing_account,      Text<4>>
+      , Field<F::last_shares,           LittleEndian<T::Quantity>>
+      , Field<F::last_px,               Price>
+      , Field<F::corrected_price,       Price>
+      , Field<F::orig_time,             LittleEndian<T::DateTime>>
+      , Field<F::reserved,              Filler<1>>
+      , Field<F::number_of_return_bitfields, Literal<Byte, 8>>
+      , Field<F::bitfield1,             Literal<Byte, 0>>
+      , Field<F::bitfield2,             Literal<Byte, RETURN_BITFIELD2>>
+      , Field<F::bitfield3,             Literal<Byte, 0>>
+      , Field<F::bitfield4,             Literal<Byte, 0>>
+      , Field<F::bitfield5,             Literal<Byte, 0>>
+      , Field<F::bitfield6,             Literal<Byte, 0>>
+      , Field<F::bitfield7,             Literal<Byte, 0>>
+      , Field<F::bitfield8,             Literal<Byte, 0>>
+      , Field<F::symbol,                Text<8>>
+      , Field<F::capacity,              LittleEndian<T::Capacity>>
+    >;
+    static_assert(TradeCancelOrCorrect::SIZE == sizeof(Messages::TradeCancelOrCorrect) + 8 + sizeof(Messages::TradeCancelOrCorrect::OptionalFields),
+                  "BOE20 TradeCancelOrCorrect with the return bitfields BOE20Session asks for.");
+
+} } } } }
@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <cstdlib>
+#include <cstring>
 #include <iomanip>
 
 #include <boost/lexical_cast.hpp>
@@ -23,6 +24,9 @@ namespace i01 { namespace OE { namespace BATS {
 using namespace BOE20::Messages;
 using i01::core::operator<<;
 
+const std::size_t BOE20Session::MAX_NEW_ORDER_TEMPLATES;
+const std::size_t BOE20Session::NewOrderTemplate::SIZE;
+
 std::ostream& debug_print_bytes(std::ostream& os,
                                 const core::Timestamp& ts,
                                 const MessageType& mt,
@@ -55,6 +59,8 @@ BOE20Session::BOE20Session(OrderManager *omp, const std::string &n) :
     m_missed_hb_before_logout(5),
     m_auto_reconnect(true),
     m_reconnect_interval_ms(DEFAULT_RECONNECT_INTERVAL_MS),
+    m_new_order_templates(true),
+    m_no_templates(MD::NUM_SYMBOL_INDEX),
     m_outbound_seqnum_init_override(-1),
     m_inbound_seqnum_init_override(msgs::MAX_NUMBER_OF_MATCHING_UNITS,-1)
 {
@@ -113,6 +119,11 @@ void BOE20Session::init_conf()
     m_no_bufs.init([this] (NewOrderBuffer &nob) { this->prepare_new_order_buffer(nob); });
     m_cxl_bufs.init([this] (CancelOrderBuffer &cob) {this->prepare_cancel_order_buffer(cob);});
     m_mod_bufs.init([this] (ModifyOrderBuffer &mob) { this->prepare_modify_order_buffer(mob);});
+
+    m_new_order_templates = "false" != cs->get_or_default<std::string>("new_order_templates", "true");
+    if (m_new_order_templates) {
+        new_order_templates_init();
+    }
 }
 
 void BOE20Session::init_seqnum_overrides(const core::Config::storage_type& cfg)
@@ -829,6 +840,11 @@ void BOE20Session::disconnect(const bool force)
 
 void BOE20Session::do_logout(bool requested)
 {
+    if (State::UNCONNECTED == m_state) {
+        // never connected, so there is no socket to log out on
+        disconnect_connection(requested);
+        return;
+    }
     send_logout_request();
     ::usleep(1000);
     disconnect_connection(requested);
@@ -1177,31 +1193,51 @@ void BOE20Session::send_heartbeat()
 
 bool BOE20Session::send_new_order(Order *op)
 {
-    auto * bop = static_cast<BOE20Order*>(op);
-
     NewOrderBuffer *buf;
     if (!m_no_bufs.get(buf)) {
         std::cerr << m_name << ",ERR,NEWORDER,NO BUFFER," << *op << std::endl;
         return false;
     }
 
+    if (!(m_new_order_templates ? fill_new_order_from_template(op, *buf) : fill_new_order(op, *buf))) {
+        m_no_bufs.release(buf);
+        return false;
+    }
+
     auto *msg = &buf->data.msg;
+    // we store our portion of the ID
+    m_id_map.insert({op->localID(), msg->cl_ord_id});
+
+    // FIXME log state for this order ...
+    // message size is static...
+    {
+        Mutex::scoped_lock lock(m_mutex);
+        msg->message_header.sequence_number = m_persist_state->data()->outbound_seqnum++;
+        set_order_sent_time(op, Timestamp::now());
+        send_helper_nolock(buf->data.bytes, buf->msglen);
+    }
+    debug_print_msg("NO", buf->data.msg);
+
+    m_no_bufs.release(buf);
+    return true;
+}
+
+bool BOE20Session::fill_new_order(Order *op, NewOrderBuffer &nob)
+{
+    auto * bop = static_cast<BOE20Order*>(op);
+    auto *msg = &nob.data.msg;
 
     // set ClOrdID
     msg->cl_ord_id = create_cl_ord_id(op);
     op->client_order_id(msg->cl_ord_id.arr);
-    // we store our portion of the ID
-    m_id_map.insert({op->localID(), msg->cl_ord_id});
 
     if (UNLIKELY(!side_from_order(op, msg->side))) {
         std::cerr << m_name << ",ERR,NEWORDER,UNKNOWN SIDE," << *op << std::endl;
-        m_no_bufs.release(buf);
         return false;
     }
 
     if (op->size() > MAX_ORDER_QTY) {
         std::cerr << m_name << ",ERR,NEWORDER,EXCEEDS ORDER QTY," << *op << std::endl;
-        m_no_bufs.release(buf);
         return false;
     }
 
@@ -1209,52 +1245,124 @@ bool BOE20Session::send_new_order(Order *op)
 
     // We know that m_no_buf is big enough for the largest possible message
 
-    buf->opt->price = price_to_fixed(op->price());
+    nob.opt->price = price_to_fixed(op->price());
 
-    if (UNLIKELY(!exec_inst_from_order(bop, buf->opt->exec_inst))) {
+    if (UNLIKELY(!exec_inst_from_order(bop, nob.opt->exec_inst))) {
         std::cerr << m_name << ",ERR,NOBF1,UNSUPPORTED EXEC INST," << *op << std::endl;
-        m_no_bufs.release(buf);
         return false;
     }
 
-    if (UNLIKELY(!ord_type_from_order(op, buf->opt->ord_type))) {
+    if (UNLIKELY(!ord_type_from_order(op, nob.opt->ord_type))) {
         std::cerr << m_name << ",ERR,NOBF1,UNSUPPORTED ORDER TYPE," << *op << std::endl;
-        m_no_bufs.release(buf);
         return false;
     }
 
-    if (UNLIKELY(!tif_from_order(op, buf->opt->time_in_force))) {
+    if (UNLIKELY(!tif_from_order(op, nob.opt->time_in_force))) {
         std::cerr << m_name << ",ERR,NOBF1,UNSUPPORTED TIF," << *op << std::endl;
-        m_no_bufs.release(buf);
         return false;
     }
 
-    if (UNLIKELY(!display_indicator_from_order(bop, buf->opt->display_indicator))) {
+    if (UNLIKELY(!display_indicator_from_order(bop, nob.opt->display_indicator))) {
         std::cerr << m_name << ",ERR,NOBF1,UNSUPPORTED DISPLAY INDICATOR" << *bop << std::endl;
-        m_no_bufs.release(buf);
         return false;
     }
 
-    if (UNLIKELY(!routing_inst_from_order(bop, buf->opt->routing_inst))) {
+    if (UNLIKELY(!routing_inst_from_order(bop, nob.opt->routing_inst))) {
         std::cerr << m_name << ",ERR,NOBF,UNSUPPORTED ROUTING INST" << *bop << std::endl;
-        m_no_bufs.release(buf);
         return false;
     }
 
-    buf->opt->symbol.arr = m_bats_symbol_array[op->instrument()->esi()].arr;
+    nob.opt->symbol.arr = m_bats_symbol_array[op->instrument()->esi()].arr;
+    return true;
+}
+
+bool BOE20Session::fill_new_order_from_template(Order *op, NewOrderBuffer &nob)
+{
+    auto * bop = static_cast<BOE20Order*>(op);
+
+    if (UNLIKELY(op->size() > MAX_ORDER_QTY)) {
+        std::cerr << m_name << ",ERR,NEWORDER,EXCEEDS ORDER QTY," << *op << std::endl;
+        return false;
+    }
+
+    const auto& templates = m_no_templates[op->instrument()->esi()];
+    const auto profile = new_order_profile(bop);
+    const NewOrderTemplate *tp = nullptr;
+    for (std::size_t i = 0; i < templates.profiles.size(); i++) {
+        if (templates.profiles[i] == profile) {
+            tp = &templates.templates[i];
+            break;
+        }
+    }
+    if (UNLIKELY(nullptr == tp)) {
+        return fill_new_order(op, nob);
+    }
+
+    std::memcpy(nob.data.bytes, tp->bytes.data(), NewOrderTemplate::SIZE);
+    bop->boe_exec_inst(tp->exec_inst);
+    bop->boe_display_indicator(tp->display_indicator);
+    bop->boe_routing_inst(tp->routing_inst);
 
-    // FIXME log state for this order ...
-    // message size is static...
-    {
-        Mutex::scoped_lock lock(m_mutex);
-        msg->message_header.sequence_number = m_persist_state->data()->outbound_seqnum++;
-        set_order_sent_time(op, Timestamp::now());
-        send_helper_nolock(buf->data.bytes, buf->msglen);
+    auto *msg = &nob.data.msg;
+    // the template has the broker location and symbol
+    msg->cl_ord_id.fields.order_id.set(BOE20::Types::LocalClOrdID::create(op->local_account(), op->localID()).u64);
+    op->client_order_id(msg->cl_ord_id.arr);
+    msg->order_qty = op->size();
+    nob.opt->price = price_to_fixed(op->price());
+    return true;
+}
+
+void BOE20Session::add_new_order_template(NewOrderTemplates &templates, std::uint64_t profile,
+                                          const BOE20Order *bop, const NewOrderBuffer &nob)
+{
+    if (templates.profiles.size() >= MAX_NEW_ORDER_TEMPLATES) {
+        return;
     }
-    debug_print_msg("NO", buf->data.msg);
+    NewOrderTemplate t;
+    t.exec_inst = bop->boe_exec_inst();
+    t.display_indicator = bop->boe_display_indicator();
+    t.routing_inst = bop->boe_routing_inst();
+    std::memcpy(t.bytes.data(), nob.data.bytes, NewOrderTemplate::SIZE);
+    templates.profiles.push_back(profile);
+    templates.templates.push_back(t);
+}
+
+std::uint64_t BOE20Session::new_order_profile(const BOE20Order *bop)
+{
+    // the attributes as the order has them, before exec_inst_from_order and
+    // friends fill in the defaults; OrderType and Side both fit in 4 bits
+    return (static_cast<std::uint64_t>(bop->type()) << 60)
+        | (static_cast<std::uint64_t>(bop->side()) << 56)
+        | (static_cast<std::uint64_t>(bop->tif()) << 48)
+        | (static_cast<std::uint64_t>(bop->boe_exec_inst()) << 40)
+        | (static_cast<std::uint64_t>(bop->boe_display_indicator()) << 32)
+        | static_cast<std::uint64_t>(bop->boe_routing_inst().u32);
+}
 
+void BOE20Session::new_order_templates_init()
+{
+    NewOrderBuffer *buf;
+    if (!m_no_bufs.get(buf)) {
+        return;
+    }
+    const OE::Side sides[] = {OE::Side::BUY, OE::Side::SELL, OE::Side::SHORT, OE::Side::SHORT_EXEMPT};
+    const OE::TimeInForce tifs[] = {OE::TimeInForce::DAY, OE::TimeInForce::IMMEDIATE_OR_CANCEL};
+    for (const auto& u : m_order_manager_p->universe()) {
+        auto *inst = u.data();
+        auto& templates = m_no_templates[inst->esi()];
+        templates.profiles.reserve(MAX_NEW_ORDER_TEMPLATES);
+        templates.templates.reserve(MAX_NEW_ORDER_TEMPLATES);
+        for (const auto tif : tifs) {
+            for (const auto side : sides) {
+                BATSOrder proto(inst, 0.0, 0, side, tif, OE::OrderType::LIMIT, nullptr);
+                const auto profile = new_order_profile(&proto);
+                if (fill_new_order(&proto, *buf)) {
+                    add_new_order_template(templates, profile, &proto, *buf);
+                }
+            }
+        }
+    }
     m_no_bufs.release(buf);
-    return true;
 }
 
 Instrument * BOE20Session::find_instrument(const Symbol &symbol) const
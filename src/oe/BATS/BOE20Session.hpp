@@ -1,10 +1,11 @@
 #pragma once
 
 #include <array>
+#include <cassert>
 #include <functional>
-#include <list>
 #include <regex>
 #include <unordered_map>
+#include <vector>
 
 #include <i01_core/Alphanumeric.hpp>
 #include <i01_core/Lock.hpp>
@@ -40,7 +41,7 @@ public:
     using Timestamp = core::Timestamp;
     using Connection = net::HeartBeatConnThread;
     using DataBuffer = std::vector<std::uint8_t>;
-    using Mutex = core::SpinMutex;
+    using Mutex = Threading::Mutex;
     using Price = BOE20::Types::Price;
     using LocalIDToClOrdIDMap = std::unordered_map<LocalID, msgs::ClOrdID>;
     using SymbolInstCache = std::unordered_map<std::array<std::uint8_t, sizeof(msgs::Symbol)>, Instrument *, core::array_hasher<std::uint8_t,sizeof(msgs::Symbol)> >;
@@ -61,6 +62,9 @@ public:
 
     static const int MSG_BUFFER_SIZE = 2048;
     static const int NUM_MSG_BUFFERS = 128;
+    static const int NUM_NEW_ORDER_BITFIELDS = 6;
+    /// Most templates made per symbol, to bound the search for one.
+    static const std::size_t MAX_NEW_ORDER_TEMPLATES = 16;
     static const std::uint32_t DEFAULT_RECONNECT_INTERVAL_MS = 5000;
 
 protected:
@@ -93,9 +97,14 @@ protected:
     using CancelOrderBuffer = OutboundMsgBuffer<msgs::CancelOrder>;
     using ModifyOrderBuffer = OutboundMsgBuffer<msgs::ModifyOrder>;
 
+    /// The free buffers are a fixed stack of indices, so get and release
+    /// never allocate, and the buffer released last, still in cache, is
+    /// the next one out.
     template<typename BufType, int NUM = NUM_MSG_BUFFERS>
     class BufferStore {
     public:
+        BufferStore() : m_num_free(0) {}
+
         void init(std::function<void(BufType &)> f);
 
         bool get(BufType *& ptr);
@@ -103,10 +112,31 @@ protected:
         // FIXME should ensure that BufType is an OutboundMsgBuffer instance
     private:
         std::array<BufType, NUM> m_array;
-        std::list<int> m_free_list;
+        std::array<int, NUM> m_free;
+        int m_num_free;
         Mutex m_mutex;
     };
 
+    /// A NewOrder, bitfields and optional fields, serialized for one
+    /// symbol and profile: all that send_new_order patches is the ClOrdID,
+    /// size, price and sequence number.  The profile is the order's side,
+    /// type, TIF and BOE20 attributes as they were when the template was
+    /// made (see new_order_profile), and the attributes they resolved to
+    /// are kept to set on each order sent from the template.
+    struct NewOrderTemplate {
+        static const std::size_t SIZE = sizeof(msgs::NewOrder) + NUM_NEW_ORDER_BITFIELDS + sizeof(msgs::NewOrder::OptionalFields);
+
+        BOE20Order::ExecInst exec_inst;
+        BOE20Order::DisplayIndicator display_indicator;
+        BOE20Order::RoutingInst routing_inst;
+        std::array<std::uint8_t, SIZE> bytes;
+    };
+    /// A symbol's templates, their profiles kept apart to search.
+    struct NewOrderTemplates {
+        std::vector<std::uint64_t> profiles;
+        std::vector<NewOrderTemplate> templates;
+    };
+
     template<typename MsgType>
     struct InboundMsgBuffer {
         MsgType msg;
@@ -194,6 +224,11 @@ protected:
     void symbology_init();
     std::string cta_to_bats_symbology(const std::string&);
 
+    /// Makes the new order templates for LIMIT DAY and IOC orders, every
+    /// side, in every symbol of the universe.  The only place templates are
+    /// made: they are read only once the session is up.
+    void new_order_templates_init();
+
     void send_login_request();
     void send_logout_request();
     void send_heartbeat();
@@ -238,6 +273,16 @@ protected:
 
     msgs::ClOrdID create_cl_ord_id(Order *op) const ;
 
+    /// Serializes op into nob field by field.
+    bool fill_new_order(Order *op, NewOrderBuffer &nob);
+    /// Copies op's template into nob and patches it, or serializes op
+    /// field by field if there is none.  The templates are only read here,
+    /// so any number of threads may send at once.
+    bool fill_new_order_from_template(Order *op, NewOrderBuffer &nob);
+    void add_new_order_template(NewOrderTemplates &templates, std::uint64_t profile,
+                                const BOE20Order *bop, const NewOrderBuffer &nob);
+    static std::uint64_t new_order_profile(const BOE20Order *bop);
+
     bool get_buffer(NewOrderBuffer *&nob);
     void release_buffer(NewOrderBuffer *nob);
 
@@ -308,6 +353,10 @@ protected:
     BufferStore<CancelOrderBuffer> m_cxl_bufs;
     BufferStore<ModifyOrderBuffer> m_mod_bufs;
 
+    bool m_new_order_templates;
+    /// By ESI.
+    std::vector<NewOrderTemplates> m_no_templates;
+
     SymbolInstCache m_symbol_inst_cache;
     BATSSymbolArray m_bats_symbol_array;
     std::regex m_unit_r;
@@ -329,10 +378,11 @@ protected:
 template<typename BT, int NUM>
 void BOE20Session::BufferStore<BT,NUM>::init(std::function<void(BT &)> f)
 {
-    for (int i = 0; i < NUM; i++) {
+    m_num_free = 0;
+    for (int i = NUM - 1; i >= 0; i--) {
         f(m_array[i]);
         m_array[i].index = i;
-        m_free_list.push_back(i);
+        m_free[m_num_free++] = i;
     }
 }
 
@@ -341,12 +391,11 @@ bool BOE20Session::BufferStore<BT,NUM>::get(BT *& ptr)
 {
     Mutex::scoped_lock lock(m_mutex);
 
-    if (m_free_list.empty()) {
+    if (UNLIKELY(0 == m_num_free)) {
         ptr = nullptr;
         return false;
     }
-    ptr = &m_array[m_free_list.front()];
-    m_free_list.pop_front();
+    ptr = &m_array[m_free[--m_num_free]];
     return true;
 }
 
@@ -355,7 +404,12 @@ void BOE20Session::BufferStore<BT,NUM>::release(BT * ptr)
 {
     Mutex::scoped_lock lock(m_mutex);
 
-    m_free_list.push_front(ptr->index);
+    // a buffer released twice would be handed out twice
+    assert(m_num_free < NUM && ptr == &m_array[ptr->index]);
+    if (UNLIKELY(m_num_free >= NUM)) {
+        return;
+    }
+    m_free[m_num_free++] = ptr->index;
 }
 
 template<typename ResType>
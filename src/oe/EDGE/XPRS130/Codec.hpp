@@ -0,0 +1,362 @@
+#pragma once
+
+// XPRS 1.30 as WireCodec descriptions: byte for byte the packed structs of
+// Messages.hpp, all integers big endian.
+
+#include <cstdint>
+
+#include <i01_oe/WireCodec.hpp>
+
+#include "Types.hpp"
+
+namespace i01 { namespace OE { namespace EDGE { namespace XPRS130 { namespace Codec {
+    using namespace i01::OE::WireCodec;
+    namespace T = i01::OE::EDGE::XPRS130::Types;
+
+    namespace F {
+        I01_WIRE_FIELD(package_length);
+        I01_WIRE_FIELD(package_type);
+        I01_WIRE_FIELD(message_type);
+        I01_WIRE_FIELD(timestamp);
+        I01_WIRE_FIELD(order_token);
+        I01_WIRE_FIELD(buy_sell_indicator);
+        I01_WIRE_FIELD(quantity);
+        I01_WIRE_FIELD(symbol);
+        I01_WIRE_FIELD(price);
+        I01_WIRE_FIELD(time_in_force);
+        I01_WIRE_FIELD(display);
+        I01_WIRE_FIELD(special_order_type);
+        I01_WIRE_FIELD(extended_hours_eligible);
+        I01_WIRE_FIELD(order_reference_number);
+        I01_WIRE_FIELD(capacity);
+        I01_WIRE_FIELD(route_out_eligibility);
+        I01_WIRE_FIELD(iso_eligibility);
+        I01_WIRE_FIELD(username);
+        I01_WIRE_FIELD(password);
+        I01_WIRE_FIELD(requested_session);
+        I01_WIRE_FIELD(requested_sequence_number);
+        I01_WIRE_FIELD(session);
+        I01_WIRE_FIELD(sequence_number);
+        I01_WIRE_FIELD(reject_reason_code);
+        I01_WIRE_FIELD(routing_delivery_method);
+        I01_WIRE_FIELD(route_strategy);
+        I01_WIRE_FIELD(minimum_quantity);
+        I01_WIRE_FIELD(max_floor);
+        I01_WIRE_FIELD(peg_difference);
+        I01_WIRE_FIELD(discretionary_offset);
+        I01_WIRE_FIELD(expire_time);
+        I01_WIRE_FIELD(symbol_suffix);
+        I01_WIRE_FIELD(executed_quantity);
+        I01_WIRE_FIELD(execution_price);
+        I01_WIRE_FIELD(liquidity_flag);
+        I01_WIRE_FIELD(match_number);
+        I01_WIRE_FIELD(reject_reason);
+        I01_WIRE_FIELD(in_response_to);
+        I01_WIRE_FIELD(decremented_quantity);
+        I01_WIRE_FIELD(canceled_reason);
+        I01_WIRE_FIELD(existing_order_token);
+        I01_WIRE_FIELD(replacement_order_token);
+        I01_WIRE_FIELD(previous_order_token);
+        I01_WIRE_FIELD(event_code);
+        I01_WIRE_FIELD(broken_trade_reason);
+        I01_WIRE_FIELD(new_execution_price);
+        I01_WIRE_FIELD(price_correction_reason);
+        I01_WIRE_FIELD(ai_method);
+        I01_WIRE_FIELD(ai_identifier);
+        I01_WIRE_FIELD(ai_group_id);
+        I01_WIRE_FIELD(canceled_order_state);
+        I01_WIRE_FIELD(contra_member_id);
+        I01_WIRE_FIELD(contra_token_or_cl_order_id);
+    }
+
+    typedef Decimal<T::Price, true, 10000> Price;
+
+    /// MEP packets: package_length counts the bytes after it, and the
+    //  payload of data and debug packets follows the header.
+    using MEPLoginRequest = Message<
+        Field<F::package_length,        Literal<BigEndian<T::PackageLength>, 47>>
+      , Field<F::package_type,          Literal<BigEndian<T::PackageType>, T::PackageType::LOGIN_REQUEST>>
+      , Field<F::username,              Alpha<6>>
+      , Field<F::password,              Alpha<10>>
+      , Field<F::requested_session,     Alpha<10>>
+      , Field<F::requested_sequence_number, Alpha<20>>
+    >;
+    static_assert(MEPLoginRequest::SIZE == 49, "XPRS130 MEPLoginRequest is 49 bytes.");
+
+    using MEPLoginAccepted = Message<
+        Field<F::package_length,        Literal<BigEndian<T::PackageLength>, 31>>
+      , Field<F::package_type,          Literal<BigEndian<T::PackageType>, T::PackageType::LOGIN_ACCEPTED>>
+      , Field<F::session,               Alpha<10>>
+      , Field<F::sequence_number,       Alpha<20>>
+    >;
+    static_assert(MEPLoginAccepted::SIZE == 33, "XPRS130 MEPLoginAccepted is 33 bytes.");
+
+    using MEPLoginRejected = Message<
+        Field<F::package_length,        Literal<BigEndian<T::PackageLength>, 2>>
+      , Field<F::package_type,          Literal<BigEndian<T::PackageType>, T::PackageType::LOGIN_REJECTED>>
+      , Field<F::reject_reason_code,    BigEndian<T::RejectReasonCode>>
+    >;
+    static_assert(MEPLoginRejected::SIZE == 4, "XPRS130 MEPLoginRejected is 4 bytes.");
+
+    using MEPSequencedData = Message<
+        Field<F::package_length,        BigEndian<T::PackageLength>>
+      , Field<F::package_type,          Literal<BigEndian<T::PackageType>, T::PackageType::SEQUENCED_DATA>>
+    >;
+    static_assert(MEPSequencedData::SIZE == 3, "XPRS130 MEPSequencedData is 3 bytes.");
+
+    using MEPUnsequencedData = Message<
+        Field<F::package_length,        BigEndian<T::PackageLength>>
+      , Field<F::package_type,          Literal<BigEndian<T::PackageType>, T::PackageType::UNSEQUENCED_DATA>>
+    >;
+    static_assert(MEPUnsequencedData::SIZE == 3, "XPRS130 MEPUnsequencedData is 3 bytes.");
+
+    using MEPServerHeartbeat = Message<
+        Field<F::package_length,        Literal<BigEndian<T::PackageLength>, 1>>
+      , Field<F::package_type,          Literal<BigEndian<T::PackageType>, T::PackageType::SERVER_HEARTBEAT>>
+    >;
+    static_assert(MEPServerHeartbeat::SIZE == 3, "XPRS130 MEPServerHeartbeat is 3 bytes.");
+
+    using MEPClientHeartbeat = Message<
+        Field<F::package_length,        Literal<BigEndian<T::PackageLength>, 1>>
+      , Field<F::package_type,          Literal<BigEndian<T::PackageType>, T::PackageType::CLIENT_HEARTBEAT>>
+    >;
+    static_assert(MEPClientHeartbeat::SIZE == 3, "XPRS130 MEPClientHeartbeat is 3 bytes.");
+
+    using MEPLogoutRequest = Message<
+        Field<F::package_length,        Literal<BigEndian<T::PackageLength>, 1>>
+      , Field<F::package_type,          Literal<BigEndian<T::PackageType>, T::PackageType::LOGOUT_REQUEST>>
+    >;
+    static_assert(MEPLogoutRequest::SIZE == 3, "XPRS130 MEPLogoutRequest is 3 bytes.");
+
+    using MEPDebug = Message<
+        Field<F::package_length,        BigEndian<T::PackageLength>>
+      , Field<F::package_type,          Literal<BigEndian<T::PackageType>, T::PackageType::DEBUG>>
+    >;
+    static_assert(MEPDebug::SIZE == 3, "XPRS130 MEPDebug is 3 bytes.");
+
+    using MEPEndOfSession = Message<
+        Field<F::package_length,        Literal<BigEndian<T::PackageLength>, 1>>
+      , Field<F::package_type,          Literal<BigEndian<T::PackageType>, T::PackageType::END_OF_SESSION>>
+    >;
+    static_assert(MEPEndOfSession::SIZE == 3, "XPRS130 MEPEndOfSession is 3 bytes.");
+
+    using EnterOrderShortFormat = Message<
+        Field<F::message_type,          Literal<BigEndian<T::MessageType>, T::MessageType::ENTER_ORDER_SHORT_FORMAT>>
+      , Field<F::order_token,           Alpha<14>>
+      , Field<F::buy_sell_indicator,    BigEndian<T::BuySellIndicator>>
+      , Field<F::quantity,              BigEndian<T::Quantity>>
+      , Field<F::symbol,                Alpha<6>>
+      , Field<F::price,                 Price>
+      , Field<F::time_in_force,         BigEndian<T::TimeInForce>>
+      , Field<F::display,               BigEndian<T::Display>>
+      , Field<F::special_order_type,    BigEndian<T::SpecialOrderType>>
+      , Field<F::extended_hours_eligible, BigEndian<T::ExtendedHoursEligible>>
+      , Field<F::capacity,              BigEndian<T::Capacity>>
+      , Field<F::route_out_eligibility, BigEndian<T::RouteOutEligibility>>
+      , Field<F::iso_eligibility,       BigEndian<T::ISOEligibility>>
+    >;
+    static_assert(EnterOrderShortFormat::SIZE == 37, "XPRS130 EnterOrderShortFormat is 37 bytes.");
+
+    using EnterOrderExtendedFormat = Message<
+        Field<F::message_type,          Literal<BigEndian<T::MessageType>, T::MessageType::ENTER_ORDER_EXTENDED_FORMAT>>
+      , Field<F::order_token,           Alpha<14>>
+      , Field<F::buy_sell_indicator,    BigEndian<T::BuySellIndicator>>
+      , Field<F::quantity,              BigEndian<T::Quantity>>
+      , Field<F::symbol,                Alpha<6>>
+      , Field<F::price,                 Price>
+      , Field<F::time_in_force,         BigEndian<T::TimeInForce>>
+      , Field<F::display,               BigEndian<T::Display>>
+      , Field<F::special_order_type,    BigEndian<T::SpecialOrderType>>
+      , Field<F::extended_hours_eligible, BigEndian<T::ExtendedHoursEligible>>
+      , Field<F::capacity,              BigEndian<T::Capacity>>
+      , Field<F::route_out_eligibility, BigEndian<T::RouteOutEligibility>>
+      , Field<F::iso_eligibility,       BigEndian<T::ISOEligibility>>
+      , Field<F::routing_delivery_method, BigEndian<T::RoutingDeliveryMethod>>
+      , Field<F::route_strategy,        BigEndian<T::RouteStrategy>>
+      , Field<F::minimum_quantity,      BigEndian<T::Quantity>>
+      , Field<F::max_floor,             BigEndian<T::Quantity>>
+      , Field<F::peg_difference,        BigEndian<T::PegDifference>>
+      , Field<F::discretionary_offset,  BigEndian<T::DiscretionaryOffset>>
+      , Field<F::expire_time,           BigEndian<T::Timestamp>>
+      , Field<F::symbol_suffix,         Alpha<6>>
+    >;
+    static_assert(EnterOrderExtendedFormat::SIZE == 64, "XPRS130 EnterOrderExtendedFormat is 64 bytes.");
+
+    using AcceptedMessageShortFormat = Message<
+        Field<F::message_type,          Literal<BigEndian<T::MessageType>, T::MessageType::ACCEPTED_MESSAGE_SHORT_FORMAT>>
+      , Field<F::timestamp,             BigEndian<T::Timestamp>>
+      , Field<F::order_token,           Alpha<14>>
+      , Field<F::buy_sell_indicator,    BigEndian<T::BuySellIndicator>>
+      , Field<F::quantity,              BigEndian<T::Quantity>>
+      , Field<F::symbol,                Alpha<6>>
+      , Field<F::price,                 Price>
+      , Field<F::time_in_force,         BigEndian<T::TimeInForce>>
+      , Field<F::display,               BigEndian<T::Display>>
+      , Field<F::special_order_type,    BigEndian<T::SpecialOrderType>>
+      , Field<F::extended_hours_eligible, BigEndian<T::ExtendedHoursEligible>>
+      , Field<F::order_reference_number, BigEndian<T::OrderReferenceNumber>>
+      , Field<F::capacity,              BigEndian<T::Capacity>>
+      , Field<F::route_out_eligibility, BigEndian<T::RouteOutEligibility>>
+      , Field<F::iso_eligibility,       BigEndian<T::ISOEligibility>>
+    >;
+    static_assert(AcceptedMessageShortFormat::SIZE == 53, "XPRS130 AcceptedMessageShortFormat is 53 bytes.");
+
+    using AcceptedMessageExtendedFormat = Message<
+        Field<F::message_type,          Literal<BigEndian<T::MessageType>, T::MessageType::ACCEPTED_MESSAGE_EXTENDED_FORMAT>>
+      , Field<F::timestamp,             BigEndian<T::Timestamp>>
+      , Field<F::order_token,           Alpha<14>>
+      , Field<F::buy_sell_indicator,    BigEndian<T::BuySellIndicator>>
+      , Field<F::quantity,              BigEndian<T::Quantity>>
+      , Field<F::symbol,                Alpha<6>>
+      , Field<F::price,                 Price>
+      , Field<F::time_in_force,         BigEndian<T::TimeInForce>>
+      , Field<F::display,               BigEndian<T::Display>>
+      , Field<F::special_order_type,    BigEndian<T::SpecialOrderType>>
+      , Field<F::extended_hours_eligible, BigEndian<T::ExtendedHoursEligible>>
+      , Field<F::order_reference_number, BigEndian<T::OrderReferenceNumber>>
+      , Field<F::capacity,              BigEndian<T::Capacity>>
+      , Field<F::route_out_eligibility, BigEndian<T::RouteOutEligibility>>
+      , Field<F::iso_eligibility,       BigEndian<T::ISOEligibility>>
+      , Field<F::routing_delivery_method, BigEndian<T::RoutingDeliveryMethod>>
+      , Field<F::route_strategy,        BigEndian<T::RouteStrategy>>
+      , Field<F::minimum_quantity,      BigEndian<T::Quantity>>
+      , Field<F::max_floor,             BigEndian<T::Quantity>>
+      , Field<F::peg_difference,        BigEndian<T::PegDifference>>
+      , Field<F::discretionary_offset,  BigEndian<T::DiscretionaryOffset>>
+      , Field<F::expire_time,           BigEndian<T::Timestamp>>
+      , Field<F::symbol_suffix,         Alpha<6>>
+    >;
+    static_assert(AcceptedMessageExtendedFormat::SIZE == 80, "XPRS130 AcceptedMessageExtendedFormat is 80 bytes.");
+
+    using ExecutedOrder = Message<
+        Field<F::message_type,          Literal<BigEndian<T::MessageType>, T::MessageType::EXECUTED_ORDER>>
+      , Field<F::timestamp,             BigEndian<T::Timestamp>>
+      , Field<F::order_token,           Alpha<14>>
+      , Field<F::executed_quantity,     BigEndian<T::Quantity>>
+      , Field<F::execution_price,       Price>
+      , Field<F::liquidity_flag,        Alpha<5>>
+      , Field<F::match_number,          BigEndian<T::MatchNumber>>
+    >;
+    static_assert(ExecutedOrder::SIZE == 44, "XPRS130 ExecutedOrder is 44 bytes.");
+
+    using RejectedMessage = Message<
+        Field<F::message_type,          Literal<BigEndian<T::MessageType>, T::MessageType::REJECTED_MESSAGE>>
+      , Field<F::timestamp,             BigEndian<T::Timestamp>>
+      , Field<F::order_token,           Alpha<14>>
+      , Field<F::reject_reason,         BigEndian<T::RejectReason>>
+    >;
+    static_assert(RejectedMessage::SIZE == 24, "XPRS130 RejectedMessage is 24 bytes.");
+
+    using ExtendedRejectedMessage = Message<
+        Field<F::message_type,          Literal<BigEndian<T::MessageType>, T::MessageType::EXTENDED_REJECTED_MESSAGE>>
+      , Field<F::timestamp,             BigEndian<T::Timestamp>>
+      , Field<F::order_token,           Alpha<14>>
+      , Field<F::reject_reason,         BigEndian<T::RejectReason>>
+      , Field<F::in_response_to,        BigEndian<T::InResponseTo>>
+    >;
+    static_assert(ExtendedRejectedMessage::SIZE == 25, "XPRS130 ExtendedRejectedMessage is 25 bytes.");
+
+    using Cancel = Message<
+        Field<F::message_type,          Literal<BigEndian<T::MessageType>, T::MessageType::CANCEL_ORDER>>
+      , Field<F::order_token,           Alpha<14>>
+      , Field<F::quantity,              BigEndian<T::Quantity>>
+    >;
+    static_assert(Cancel::SIZE == 19, "XPRS130 Cancel is 19 bytes.");
+
+    using CanceledMessage = Message<
+        Field<F::message_type,          Literal<BigEndian<T::MessageType>, T::MessageType::CANCELED_MESSAGE>>
+      , Field<F::timestamp,             BigEndian<T::Timestamp>>
+      , Field<F::order_token,           Alpha<14>>
+      , Field<F::decremented_quantity,  BigEndian<T::Quantity>>
+      , Field<F::canceled_reason,       BigEndian<T::CanceledReason>>
+    >;
+    static_assert(CanceledMessage::SIZE == 28, "XPRS130 CanceledMessage is 28 bytes.");
+
+    using CancelPending = Message<
+        Field<F::message_type,          Literal<BigEndian<T::MessageType>, T::MessageType::CANCEL_PENDING>>
+      , Field<F::timestamp,             BigEndian<T::Timestamp>>
+      , Field<F::order_token,           Alpha<14>>
+    >;
+    static_assert(CancelPending::SIZE == 23, "XPRS130 CancelPending is 23 bytes.");
+
+    using Replace = Message<
+        Field<F::message_type,          Literal<BigEndian<T::MessageType>, T::MessageType::REPLACE_ORDER>>
+      , Field<F::existing_order_token,  Alpha<14>>
+      , Field<F::replacement_order_token, Alpha<14>>
+      , Field<F::quantity,              BigEndian<T::Quantity>>
+      , Field<F::price,                 Price>
+    >;
+    static_assert(Replace::SIZE == 37, "XPRS130 Replace is 37 bytes.");
+
+    using ReplacedMessage = Message<
+        Field<F::message_type,          Literal<BigEndian<T::MessageType>, T::MessageType::REPLACED_MESSAGE>>
+      , Field<F::timestamp,             BigEndian<T::Timestamp>>
+      , Field<F::replacement_order_token, Alpha<14>>
+      , Field<F::buy_sell_indicator,    BigEndian<T::BuySellIndicator>>
+      , Field<F::quantity,              BigEndian<T::Quantity>>
+      , Field<F::symbol,                Alpha<6>>
+      , Field<F::price,                 Price>
+      , Field<F::order_reference_number, BigEndian<T::OrderReferenceNumber>>
+      , Field<F::capacity,              BigEndian<T::Capacity>>
+      , Field<F::previous_order_token,  Alpha<14>>
+    >;
+    static_assert(ReplacedMessage::SIZE == 61, "XPRS130 ReplacedMessage is 61 bytes.");
+
+    using PendingReplace = Message<
+        Field<F::message_type,          Literal<BigEndian<T::MessageType>, T::MessageType::PENDING_REPLACE>>
+      , Field<F::timestamp,             BigEndian<T::Timestamp>>
+      , Field<F::order_token,           Alpha<14>>
+    >;
+    static_assert(PendingReplace::SIZE == 23, "XPRS130 PendingReplace is 23 bytes.");
+
+    using SystemEvent = Message<
+        Field<F::message_type,          Literal<BigEndian<T::MessageType>, T::MessageType::SYSTEM_EVENT>>
+      , Field<F::timestamp,             BigEndian<T::Timestamp>>
+      , Field<F::event_code,            BigEndian<T::EventCode>>
+    >;
+    static_assert(SystemEvent::SIZE == 10, "XPRS130 SystemEvent is 10 bytes.");
+
+    using BrokenTrade = Message<
+        Field<F::message_type,          Literal<BigEndian<T::MessageType>, T::MessageType::BROKEN_TRADE>>
+      , Field<F::timestamp,             BigEndian<T::Timestamp>>
+      , Field<F::order_token,           Alpha<14>>
+      , Field<F::match_number,          BigEndian<T::MatchNumber>>
+      , Field<F::broken_trade_reason,   BigEndian<T::BrokenTradeReason>>
+    >;
+    static_assert(BrokenTrade::SIZE == 32, "XPRS130 BrokenTrade is 32 bytes.");
+
+    using PriceCorrection = Message<
+        Field<F::message_type,          Literal<BigEndian<T::MessageType>, T::MessageType::PRICE_CORRECTION>>
+      , Field<F::timestamp,             BigEndian<T::Timestamp>>
+      , Field<F::order_token,           Alpha<14>>
+      , Field<F::match_number,          BigEndian<T::MatchNumber>>
+      , Field<F::new_execution_price,   Price>
+      , Field<F::price_correction_reason, BigEndian<T::PriceCorrectionReason>>
+    >;
+    static_assert(PriceCorrection::SIZE == 36, "XPRS130 PriceCorrection is 36 bytes.");
+
+    using AntiInternalizationModifier = Message<
+        Field<F::message_type,          Literal<BigEndian<T::MessageType>, T::MessageType::ANTI_INTERNALIZATION_MODIFIER>>
+      , Field<F::ai_method,             BigEndian<T::AIMethod>>
+      , Field<F::ai_identifier,         BigEndian<T::AIIdentifier>>
+      , Field<F::ai_group_id,           BigEndian<T::AIGroupID>>
+    >;
+    static_assert(AntiInternalizationModifier::SIZE == 5, "XPRS130 AntiInternalizationModifier is 5 bytes.");
+
+    using AIAdditionalInfoMessage = Message<
+        Field<F::message_type,          Literal<BigEndian<T::MessageType>, T::MessageType::AI_ADDITIONAL_INFO_MESSAGE>>
+      , Field<F::timestamp,             BigEndian<T::Timestamp>>
+      , Field<F::order_token,           Alpha<14>>
+      , Field<F::quantity,              BigEndian<T::Quantity>>
+      , Field<F::price,                 Price>
+      , Field<F::canceled_order_state,  BigEndian<T::CanceledOrderState>>
+      , Field<F::contra_member_id,      Alpha<6>>
+      , Field<F::contra_token_or_cl_order_id, Alpha<20>>
+      , Field<F::ai_method,             BigEndian<T::AIMethod>>
+      , Field<F::ai_identifier,         BigEndian<T::AIIdentifier>>
+      , Field<F::ai_group_id,           BigEndian<T::AIGroupID>>
+    >;
+    static_assert(AIAdditionalInfoMessage::SIZE == 62, "XPRS130 AIAdditionalInfoMessage is 62 bytes.");
+
+
+} } } } }
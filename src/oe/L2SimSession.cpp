@@ -7,8 +7,22 @@
 
 namespace i01 { namespace OE {
 
+namespace {
+
+std::size_t session_capacity(const std::string& name, const std::string& key, std::size_t def)
+{
+    auto cfg = core::Config::instance().get_shared_state();
+    return cfg->copy_prefix_domain("oe.sessions." + name + ".")->get_or_default<std::size_t>(key, def);
+}
+
+}
+
 L2SimSession::L2SimSession(OrderManager *om_p, const std::string& name_)
     : SimSession(om_p, name_, "L2SimSession")
+    , m_orders(session_capacity(name_, "max_open_orders", DEFAULT_MAX_OPEN_ORDERS))
+    , m_exec_this_pkt(session_capacity(name_, "max_executions_per_packet", DEFAULT_MAX_EXECUTIONS_PER_PACKET))
+    , m_num_sending(0)
+    , m_store_full_rejects(0)
     , m_ignore_trading_state(true)
 {
 
@@ -82,10 +96,21 @@ bool L2SimSession::send(Order *o_p)
     auto idx = it->second;
 
 
+    // every order sent, arrived or not, needs a slot in m_orders, so
+    // refuse it here rather than lose track of it (its cancels would be
+    // rejected)
+    if (m_orders.size() + m_num_sending >= m_orders.capacity()) {
+        ++m_store_full_rejects;
+        std::cerr << "ERR,L2SIM," << market() << "," << name()
+                  << ",SEND,STORE_FULL," << m_orders.capacity() << "," << *o_p << std::endl;
+        return false;
+    }
+
     auto ts = m_ts + m_ack_latency;
 
     set_order_sent_time(o_p, m_ts);
-    m_eventq.emplace(ts,SimEvent{OrderState::SENT, o_p, idx});
+    schedule_(ts,SimEvent{OrderState::SENT, o_p, idx});
+    ++m_num_sending;
     return true;
 }
 
@@ -110,7 +135,7 @@ bool L2SimSession::cancel(Order *o_p, Size newqty)
     }
 
     set_order_last_request_time(o_p, m_ts);
-    m_eventq.emplace(ts,SimEvent{OrderState::PENDING_CANCEL, o_p, idx, newqty});
+    schedule_(ts,SimEvent{OrderState::PENDING_CANCEL, o_p, idx, newqty});
 
     return true;
 }
@@ -187,9 +212,9 @@ void L2SimSession::on_book_canceled(const MD::L3CancelEvent &evt)
     }
 
     auto delta_size = evt.m_old_size - evt.m_order.size;
-    auto it = m_exec_this_pkt.find(evt.m_order.refnum);
-    if (it != m_exec_this_pkt.end()) {
-        delta_size = it->second;
+    const auto *exec_size = m_exec_this_pkt.find(evt.m_order.refnum);
+    if (nullptr != exec_size) {
+        delta_size = *exec_size;
     }
 
     if (evt.m_order.side == MD::OrderBook::Order::Side::BUY) {
@@ -211,12 +236,12 @@ void L2SimSession::on_book_modified(const MD::L3ModifyEvent &evt)
     }
 
     auto delta_size = evt.m_old_size - evt.m_new_order.size;
-    auto it = m_exec_this_pkt.find(evt.m_old_refnum);
-    if (it != m_exec_this_pkt.end()) {
+    const auto *exec_size = m_exec_this_pkt.find(evt.m_old_refnum);
+    if (nullptr != exec_size) {
         // then it's a reduce of the old size I hope
         // SEE FIXME ON L2SimSession.hpp:232
         //assert(evt.m_new_order.size < evt.m_old_size);
-        delta_size = it->second;
+        delta_size = *exec_size;
     }
 
     if (evt.m_new_order.side == MD::OrderBook::Order::Side::BUY) {
@@ -269,7 +294,9 @@ void L2SimSession::on_book_executed(const MD::L3ExecutionEvent &evt)
         exec_event_size_helper(be->asks, evt);
     }
 
-    m_exec_this_pkt.insert({evt.m_order.refnum, avail_size});
+    if (nullptr == m_exec_this_pkt.insert(evt.m_order.refnum, avail_size).first) {
+        std::cerr << "ERR,L2SIM," << market() << "," << name() << ",EXEC,STORE_FULL," << evt.m_order.refnum << std::endl;
+    }
     be->trades.insert(evt.m_trade_id);
 }
 
@@ -416,8 +443,8 @@ void L2SimSession::update_ts(const Timestamp &ts)
                       << std::endl;
         }
 
-        // TODO: change Order memory model to allow deletion
-        // delete evt.second.order_p;
+        // the event's hold on its order, which may now be reused
+        drop_order(evt.second.order_p);
     }
     m_ts = ts;
 }
@@ -436,7 +463,13 @@ void L2SimSession::on_order_sent(const Timestamp &ts, const SimEvent &se)
     // book, which is just a map based on price
 
     auto * op = se.order_p;
-    m_orders[op->localID()] = op;
+    --m_num_sending;
+    // send() kept a slot for it
+    auto res = m_orders.insert(op->localID(), op);
+    assert(nullptr != res.first);
+    *res.first = op;
+    if (res.second)
+        hold_order(op);
 
     auto idx = se.esi;
     auto &be = m_books[idx];
@@ -499,21 +532,29 @@ void L2SimSession::on_order_sent(const Timestamp &ts, const SimEvent &se)
                 price = 5e5; // TODO: find a better way to handle MOO/MOC orders?
             }
             if (TimeInForce::AUCTION_CLOSE == op->tif()) {
-                be.close_bids.emplace(price, so);
+                if (be.close_bids.emplace(price, so).second) {
+                    hold_order(op);
+                }
             } else {
-                be.open_bids.emplace(price, so);
+                if (be.open_bids.emplace(price, so).second) {
+                    hold_order(op);
+                }
             }
         } else {
             if (OrderType::MARKET == op->type()) {
                 price = 0;
             }
             if (TimeInForce::AUCTION_CLOSE == op->tif()) {
-                be.close_asks.emplace(price, so);
+                if (be.close_asks.emplace(price, so).second) {
+                    hold_order(op);
+                }
             } else {
-                be.open_asks.emplace(price, so);
+                if (be.open_asks.emplace(price, so).second) {
+                    hold_order(op);
+                }
             }
         }
-        m_eventq.emplace(ts + m_ack_latency, SimEvent{OrderState::ACKNOWLEDGED, op, idx});
+        schedule_(ts + m_ack_latency, SimEvent{OrderState::ACKNOWLEDGED, op, idx});
         return;
     }
 
@@ -531,13 +572,13 @@ void L2SimSession::on_order_sent(const Timestamp &ts, const SimEvent &se)
                 fill_price = l2q.ask.price_as_double();
                 remains -= fill_size;
                 // we generate the ack lower down
-                m_eventq.emplace(ts + m_ack_latency, SimEvent{OrderState::ACKNOWLEDGED, op, idx});
-                m_eventq.emplace(SimEvent::Ordering{ts + m_ack_latency, 1}, SimEvent(OrderState::FILLED, op, idx, fill_size, fill_price, ts));
+                schedule_(ts + m_ack_latency, SimEvent{OrderState::ACKNOWLEDGED, op, idx});
+                schedule_(SimEvent::Ordering{ts + m_ack_latency, 1}, SimEvent(OrderState::FILLED, op, idx, fill_size, fill_price, ts));
 
                 // if we are a non-market, non-IOC, then we send a fill... otherwise we need to partially cancel
                 if (remains) {
                     if ((OrderType::MARKET == op->type()) || TimeInForce::IMMEDIATE_OR_CANCEL == op->tif()) {
-                        m_eventq.emplace(SimEvent::Ordering{ts + m_cxl_latency, 1}, SimEvent(OrderState::CANCELLED, op, idx, remains, 0, ts));
+                        schedule_(SimEvent::Ordering{ts + m_cxl_latency, 1}, SimEvent(OrderState::CANCELLED, op, idx, remains, 0, ts));
                         return;
                     }
                 }
@@ -551,12 +592,12 @@ void L2SimSession::on_order_sent(const Timestamp &ts, const SimEvent &se)
                 fill_size = std::min(op->size(), l2q.bid.size);
                 fill_price = l2q.bid.price_as_double();
                 remains -= fill_size;
-                m_eventq.emplace(ts + m_ack_latency, SimEvent{OrderState::ACKNOWLEDGED, op, idx});
-                m_eventq.emplace(SimEvent::Ordering{ts + m_ack_latency, 1}, SimEvent(OrderState::FILLED, op, idx, fill_size, fill_price, ts));
+                schedule_(ts + m_ack_latency, SimEvent{OrderState::ACKNOWLEDGED, op, idx});
+                schedule_(SimEvent::Ordering{ts + m_ack_latency, 1}, SimEvent(OrderState::FILLED, op, idx, fill_size, fill_price, ts));
 
                 if (remains) {
                     if ((OrderType::MARKET == op->type()) || TimeInForce::IMMEDIATE_OR_CANCEL == op->tif()) {
-                        m_eventq.emplace(SimEvent::Ordering{ts + m_cxl_latency, 1}, SimEvent(OrderState::CANCELLED, op, idx, remains, 0, ts));
+                        schedule_(SimEvent::Ordering{ts + m_cxl_latency, 1}, SimEvent(OrderState::CANCELLED, op, idx, remains, 0, ts));
                         return;
                     }
                 }
@@ -574,7 +615,7 @@ void L2SimSession::on_order_sent(const Timestamp &ts, const SimEvent &se)
 
             // if we haven't had any fills, then just send an ACK
             if (remains == op->size()) {
-                m_eventq.emplace(ts + m_ack_latency, SimEvent{OrderState::ACKNOWLEDGED, op, idx});
+                schedule_(ts + m_ack_latency, SimEvent{OrderState::ACKNOWLEDGED, op, idx});
             }
 
             Size size_ahead = 0;
@@ -582,18 +623,22 @@ void L2SimSession::on_order_sent(const Timestamp &ts, const SimEvent &se)
             if (Side::BUY == op->side()) {
                 auto qq = be.book_p->l2_bid(MD::to_fixed(op->price()));
                 size_ahead += qq.size;
-                be.bids.emplace(op->price(), SimOrder{op, size_ahead, size_behind, remains});
+                if (be.bids.emplace(op->price(), SimOrder{op, size_ahead, size_behind, remains}).second) {
+                    hold_order(op);
+                }
             } else {
                 auto qq = be.book_p->l2_ask(MD::to_fixed(op->price()));
                 size_ahead += qq.size;
-                be.asks.emplace(op->price(), SimOrder{op, size_ahead, size_behind, remains});
+                if (be.asks.emplace(op->price(), SimOrder{op, size_ahead, size_behind, remains}).second) {
+                    hold_order(op);
+                }
             }
         }
 
         return;
     }
 cancel:
-    m_eventq.emplace(ts+m_cxl_latency, SimEvent(OrderState::CANCELLED, op, idx, remains, 0, ts));
+    schedule_(ts+m_cxl_latency, SimEvent(OrderState::CANCELLED, op, idx, remains, 0, ts));
 }
 
 void L2SimSession::on_order_acknowledged(const Timestamp &ts, const SimEvent &se)
@@ -614,12 +659,11 @@ void L2SimSession::on_order_filled(const Timestamp &ts, const SimEvent &se)
 
     // remove this order from our records
     if (!se.order_p->open_size()) {
-        auto it = m_orders.find(se.order_p->localID());
-        if (it == m_orders.end()) {
+        if (!m_orders.erase(se.order_p->localID())) {
             // this is strange ... have no record of this order
             std::cerr << "ERR,L2SIM," << market() << "," << name() << ",OOF,NO_ORDER," << *se.order_p << std::endl;
         } else {
-            m_orders.erase(it);
+            drop_order(se.order_p);
         }
     }
 }
@@ -628,9 +672,9 @@ void L2SimSession::on_order_filled(const Timestamp &ts, const SimEvent &se)
 
 void L2SimSession::on_order_pending_cancel(const Timestamp &ts, const SimEvent &se)
 {
-    auto it = m_orders.find(se.order_p->localID());
-    if (it == m_orders.end()) {
-        m_eventq.emplace(ts+m_cxl_latency, SimEvent(OrderState::CANCEL_REJECTED, se.order_p));
+    auto * const * opp = m_orders.find(se.order_p->localID());
+    if (nullptr == opp) {
+        schedule_(ts+m_cxl_latency, SimEvent(OrderState::CANCEL_REJECTED, se.order_p));
         return;
     }
 
@@ -651,11 +695,11 @@ void L2SimSession::on_order_pending_cancel(const Timestamp &ts, const SimEvent &
     case OrderState::REMOTELY_REJECTED:
     case OrderState::CANCEL_REJECTED:
     default:
-        m_eventq.emplace(ts+m_cxl_latency, SimEvent(OrderState::CANCEL_REJECTED, se.order_p));
+        schedule_(ts+m_cxl_latency, SimEvent(OrderState::CANCEL_REJECTED, se.order_p));
         return;
     }
 
-    auto * op = it->second;
+    auto * op = *opp;
 
     Size amt_cancelled = 0;
     if (Side::BUY == op->side()) {
@@ -665,9 +709,9 @@ void L2SimSession::on_order_pending_cancel(const Timestamp &ts, const SimEvent &
     }
     if (!amt_cancelled) {
         // this could happen if the order is filled
-        m_eventq.emplace(ts+m_cxl_latency, SimEvent(OrderState::CANCEL_REJECTED, se.order_p));
+        schedule_(ts+m_cxl_latency, SimEvent(OrderState::CANCEL_REJECTED, se.order_p));
     } else {
-        m_eventq.emplace(ts+m_cxl_latency, SimEvent(OrderState::CANCELLED, se.order_p, se.esi, amt_cancelled));
+        schedule_(ts+m_cxl_latency, SimEvent(OrderState::CANCELLED, se.order_p, se.esi, amt_cancelled));
     }
 }
 
@@ -689,9 +733,10 @@ void L2SimSession::on_order_cancelled(const Timestamp &ts, const SimEvent &se)
     auto remains = se.order_p->size() - se.size;
 
     if (0 == remains) {
-        auto it = m_orders.find(se.order_p->localID());
-        assert(it != m_orders.end());
-        m_orders.erase(it);
+        const bool erased = m_orders.erase(se.order_p->localID());
+        assert(erased);
+        if (erased)
+            drop_order(se.order_p);
     }
 }
 
@@ -720,6 +765,9 @@ std::string L2SimSession::status() const
 {
     std::ostringstream os;
     os << m_ts;
+    if (m_store_full_rejects) {
+        os << ",STORE_FULL_REJECTS," << m_store_full_rejects;
+    }
     return os.str();
 }
 
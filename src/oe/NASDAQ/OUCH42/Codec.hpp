@@ -0,0 +1,236 @@
+#pragma once
+
+// OUCH 4.2 as WireCodec descriptions: byte for byte the packed structs of
+// Messages.hpp, all integers big endian.
+
+#include <cstdint>
+
+#include <i01_oe/WireCodec.hpp>
+
+#include "Types.hpp"
+
+namespace i01 { namespace OE { namespace NASDAQ { namespace OUCH42 { namespace Codec {
+    using namespace i01::OE::WireCodec;
+    namespace T = i01::OE::NASDAQ::OUCH42::Types;
+
+    namespace F {
+        I01_WIRE_FIELD(message_type);
+        I01_WIRE_FIELD(exch_time);
+        I01_WIRE_FIELD(order_token);
+        I01_WIRE_FIELD(existing_order_token);
+        I01_WIRE_FIELD(replacement_order_token);
+        I01_WIRE_FIELD(previous_order_token);
+        I01_WIRE_FIELD(buy_sell_indicator);
+        I01_WIRE_FIELD(shares);
+        I01_WIRE_FIELD(stock);
+        I01_WIRE_FIELD(price);
+        I01_WIRE_FIELD(time_in_force);
+        I01_WIRE_FIELD(firm);
+        I01_WIRE_FIELD(display);
+        I01_WIRE_FIELD(order_reference_number);
+        I01_WIRE_FIELD(capacity);
+        I01_WIRE_FIELD(iso_eligibility);
+        I01_WIRE_FIELD(minimum_quantity);
+        I01_WIRE_FIELD(cross_type);
+        I01_WIRE_FIELD(customer_type);
+        I01_WIRE_FIELD(order_state);
+        I01_WIRE_FIELD(bbo_weight_indicator);
+        I01_WIRE_FIELD(system_event_code);
+        I01_WIRE_FIELD(decremented_shares);
+        I01_WIRE_FIELD(reason);
+        I01_WIRE_FIELD(quantity_prevented_from_trading);
+        I01_WIRE_FIELD(executed_shares);
+        I01_WIRE_FIELD(execution_price);
+        I01_WIRE_FIELD(liquidity_flag);
+        I01_WIRE_FIELD(match_number);
+    }
+
+    typedef Decimal<T::PriceRaw, true, 10000> Price;
+    /// Seconds past midnight, or one of TimeInForceSpecial.
+    typedef BigEndian<T::TimeInForceSpecial> TimeInForce;
+    /// Nanoseconds past midnight.
+    typedef BigEndian<std::uint64_t> ExchTime;
+
+    /* INBOUND */
+
+    using EnterOrder = Message<
+        Field<F::message_type,          Literal<BigEndian<T::InboundMessageType>, T::InboundMessageType::ENTER_ORDER>>
+      , Field<F::order_token,           Alpha<14>>
+      , Field<F::buy_sell_indicator,    BigEndian<T::BuySellIndicator>>
+      , Field<F::shares,                BigEndian<T::Shares>>
+      , Field<F::stock,                 Alpha<8>>
+      , Field<F::price,                 Price>
+      , Field<F::time_in_force,         TimeInForce>
+      , Field<F::firm,                  Alpha<4>>
+      , Field<F::display,               BigEndian<T::Display>>
+      , Field<F::capacity,              BigEndian<T::Capacity>>
+      , Field<F::iso_eligibility,       BigEndian<T::IntermarketSweepEligibility>>
+      , Field<F::minimum_quantity,      BigEndian<T::Shares>>
+      , Field<F::cross_type,            BigEndian<T::CrossType>>
+      , Field<F::customer_type,         BigEndian<T::CustomerType>>
+    >;
+    static_assert(EnterOrder::SIZE == 49, "OUCH42 EnterOrder is 49 bytes.");
+
+    using ReplaceOrder = Message<
+        Field<F::message_type,          Literal<BigEndian<T::InboundMessageType>, T::InboundMessageType::REPLACE_ORDER>>
+      , Field<F::existing_order_token,  Alpha<14>>
+      , Field<F::replacement_order_token, Alpha<14>>
+      , Field<F::shares,                BigEndian<T::Shares>>
+      , Field<F::price,                 Price>
+      , Field<F::time_in_force,         TimeInForce>
+      , Field<F::display,               BigEndian<T::Display>>
+      , Field<F::iso_eligibility,       BigEndian<T::IntermarketSweepEligibility>>
+      , Field<F::minimum_quantity,      BigEndian<T::Shares>>
+    >;
+    static_assert(ReplaceOrder::SIZE == 47, "OUCH42 ReplaceOrder is 47 bytes.");
+
+    using CancelOrder = Message<
+        Field<F::message_type,          Literal<BigEndian<T::InboundMessageType>, T::InboundMessageType::CANCEL_ORDER>>
+      , Field<F::order_token,           Alpha<14>>
+      , Field<F::shares,                BigEndian<T::Shares>>
+    >;
+    static_assert(CancelOrder::SIZE == 19, "OUCH42 CancelOrder is 19 bytes.");
+
+    using ModifyOrder = Message<
+        Field<F::message_type,          Literal<BigEndian<T::InboundMessageType>, T::InboundMessageType::MODIFY_ORDER>>
+      , Field<F::order_token,           Alpha<14>>
+      , Field<F::buy_sell_indicator,    BigEndian<T::BuySellIndicator>>
+      , Field<F::shares,                BigEndian<T::Shares>>
+    >;
+    static_assert(ModifyOrder::SIZE == 20, "OUCH42 ModifyOrder is 20 bytes.");
+
+    /* OUTBOUND */
+
+    using SystemEvent = Message<
+        Field<F::message_type,          Literal<BigEndian<T::OutboundMessageType>, T::OutboundMessageType::SYSTEM_EVENT>>
+      , Field<F::exch_time,             ExchTime>
+      , Field<F::system_event_code,     BigEndian<T::SystemEventCode>>
+    >;
+    static_assert(SystemEvent::SIZE == 10, "OUCH42 SystemEvent is 10 bytes.");
+
+    using Accepted = Message<
+        Field<F::message_type,          Literal<BigEndian<T::OutboundMessageType>, T::OutboundMessageType::ACCEPTED>>
+      , Field<F::exch_time,             ExchTime>
+      , Field<F::order_token,           Alpha<14>>
+      , Field<F::buy_sell_indicator,    BigEndian<T::BuySellIndicator>>
+      , Field<F::shares,                BigEndian<T::Shares>>
+      , Field<F::stock,                 Alpha<8>>
+      , Field<F::price,                 Price>
+      , Field<F::time_in_force,         TimeInForce>
+      , Field<F::firm,                  Alpha<4>>
+      , Field<F::display,               BigEndian<T::Display>>
+      , Field<F::order_reference_number, BigEndian<T::OrderReferenceNumber>>
+      , Field<F::capacity,              BigEndian<T::Capacity>>
+      , Field<F::iso_eligibility,       BigEndian<T::IntermarketSweepEligibility>>
+      , Field<F::minimum_quantity,      BigEndian<T::Shares>>
+      , Field<F::cross_type,            BigEndian<T::CrossType>>
+      , Field<F::order_state,           BigEndian<T::OrderState>>
+      , Field<F::bbo_weight_indicator,  BigEndian<T::BBOWeightIndicator>>
+    >;
+    static_assert(Accepted::SIZE == 66, "OUCH42 Accepted is 66 bytes.");
+
+    using Replaced = Message<
+        Field<F::message_type,          Literal<BigEndian<T::OutboundMessageType>, T::OutboundMessageType::REPLACED>>
+      , Field<F::exch_time,             ExchTime>
+      , Field<F::order_token,           Alpha<14>>
+      , Field<F::buy_sell_indicator,    BigEndian<T::BuySellIndicator>>
+      , Field<F::shares,                BigEndian<T::Shares>>
+      , Field<F::stock,                 Alpha<8>>
+      , Field<F::price,                 Price>
+      , Field<F::time_in_force,         TimeInForce>
+      , Field<F::firm,                  Alpha<4>>
+      , Field<F::display,               BigEndian<T::Display>>
+      , Field<F::order_reference_number, BigEndian<T::OrderReferenceNumber>>
+      , Field<F::capacity,              BigEndian<T::Capacity>>
+      , Field<F::iso_eligibility,       BigEndian<T::IntermarketSweepEligibility>>
+      , Field<F::minimum_quantity,      BigEndian<T::Shares>>
+      , Field<F::cross_type,            BigEndian<T::CrossType>>
+      , Field<F::order_state,           BigEndian<T::OrderState>>
+      , Field<F::previous_order_token,  Alpha<14>>
+      , Field<F::bbo_weight_indicator,  BigEndian<T::BBOWeightIndicator>>
+    >;
+    static_assert(Replaced::SIZE == 80, "OUCH42 Replaced is 80 bytes.");
+
+    using Canceled = Message<
+        Field<F::message_type,          Literal<BigEndian<T::OutboundMessageType>, T::OutboundMessageType::CANCELED>>
+      , Field<F::exch_time,             ExchTime>
+      , Field<F::order_token,           Alpha<14>>
+      , Field<F::decremented_shares,    BigEndian<T::Shares>>
+      , Field<F::reason,                BigEndian<T::CanceledReason>>
+    >;
+    static_assert(Canceled::SIZE == 28, "OUCH42 Canceled is 28 bytes.");
+
+    using AIQCanceled = Message<
+        Field<F::message_type,          Literal<BigEndian<T::OutboundMessageType>, T::OutboundMessageType::AIQ_CANCELLED>>
+      , Field<F::exch_time,             ExchTime>
+      , Field<F::order_token,           Alpha<14>>
+      , Field<F::decremented_shares,    BigEndian<T::Shares>>
+      , Field<F::reason,                BigEndian<T::CanceledReason>>
+      , Field<F::quantity_prevented_from_trading, BigEndian<T::Shares>>
+      , Field<F::execution_price,       Price>
+      , Field<F::liquidity_flag,        BigEndian<T::LiquidityFlag>>
+    >;
+    static_assert(AIQCanceled::SIZE == 37, "OUCH42 AIQCanceled is 37 bytes.");
+
+    using Executed = Message<
+        Field<F::message_type,          Literal<BigEndian<T::OutboundMessageType>, T::OutboundMessageType::EXECUTED>>
+      , Field<F::exch_time,             ExchTime>
+      , Field<F::order_token,           Alpha<14>>
+      , Field<F::executed_shares,       BigEndian<T::Shares>>
+      , Field<F::execution_price,       Price>
+      , Field<F::liquidity_flag,        BigEndian<T::LiquidityFlag>>
+      , Field<F::match_number,          BigEndian<T::MatchNumber>>
+    >;
+    static_assert(Executed::SIZE == 40, "OUCH42 Executed is 40 bytes.");
+
+    using BrokenTrade = Message<
+        Field<F::message_type,          Literal<BigEndian<T::OutboundMessageType>, T::OutboundMessageType::BROKEN_TRADE>>
+      , Field<F::exch_time,             ExchTime>
+      , Field<F::order_token,           Alpha<14>>
+      , Field<F::match_number,          BigEndian<T::MatchNumber>>
+      , Field<F::reason,                BigEndian<T::BrokenTradeReason>>
+    >;
+    static_assert(BrokenTrade::SIZE == 32, "OUCH42 BrokenTrade is 32 bytes.");
+
+    using Rejected = Message<
+        Field<F::message_type,          Literal<BigEndian<T::OutboundMessageType>, T::OutboundMessageType::REJECTED>>
+      , Field<F::exch_time,             ExchTime>
+      , Field<F::order_token,           Alpha<14>>
+      , Field<F::reason,                BigEndian<T::RejectedReason>>
+    >;
+    static_assert(Rejected::SIZE == 24, "OUCH42 Rejected is 24 bytes.");
+
+    using CancelPending = Message<
+        Field<F::message_type,          Literal<BigEndian<T::OutboundMessageType>, T::OutboundMessageType::CANCEL_PENDING>>
+      , Field<F::exch_time,             ExchTime>
+      , Field<F::order_token,           Alpha<14>>
+    >;
+    static_assert(CancelPending::SIZE == 23, "OUCH42 CancelPending is 23 bytes.");
+
+    using CancelReject = Message<
+        Field<F::message_type,          Literal<BigEndian<T::OutboundMessageType>, T::OutboundMessageType::CANCEL_REJECT>>
+      , Field<F::exch_time,             ExchTime>
+      , Field<F::order_token,           Alpha<14>>
+    >;
+    static_assert(CancelReject::SIZE == 23, "OUCH42 CancelReject is 23 bytes.");
+
+    using OrderPriorityUpdate = Message<
+        Field<F::message_type,          Literal<BigEndian<T::OutboundMessageType>, T::OutboundMessageType::ORDER_PRIORITY_UPDATE>>
+      , Field<F::exch_time,             ExchTime>
+      , Field<F::order_token,           Alpha<14>>
+      , Field<F::execution_price,       Price>
+      , Field<F::display,               BigEndian<T::Display>>
+      , Field<F::order_reference_number, BigEndian<T::OrderReferenceNumber>>
+    >;
+    static_assert(OrderPriorityUpdate::SIZE == 36, "OUCH42 OrderPriorityUpdate is 36 bytes.");
+
+    using Modified = Message<
+        Field<F::message_type,          Literal<BigEndian<T::OutboundMessageType>, T::OutboundMessageType::ORDER_MODIFIED>>
+      , Field<F::exch_time,             ExchTime>
+      , Field<F::order_token,           Alpha<14>>
+      , Field<F::buy_sell_indicator,    BigEndian<T::BuySellIndicator>>
+      , Field<F::shares,                BigEndian<T::Shares>>
+    >;
+    static_assert(Modified::SIZE == 28, "OUCH42 Modified is 28 bytes.");
+
+} } } } }
@@ -110,7 +110,7 @@ OUCH42Session::OUCH42Session(OrderManager *om_p, const std::string& name_)
 OUCH42Session::~OUCH42Session()
 {
     disconnect(true);
-    m_connection.shutdown();
+    m_connection.disconnect_and_quit();
 }
 
 void OUCH42Session::symbology_init()
@@ -415,7 +415,7 @@ void OUCH42Session::on_timer(const Timestamp& ts, void * I01_UNUSED userdata, st
 
     if (m_last_message_received_ts.milliseconds_since_midnight()
             < ts.milliseconds_since_midnight() - (m_heartbeat_grace_sec * 1000ULL)) {
-        core::LockGuard<Mutex> l(m_mutex);
+        Mutex::scoped_lock l(m_mutex);
         m_session_state = State::TIMED_OUT;
         // Nothing received from the server in 5 seconds.
         std::cerr << "OUCH42Session " << name()
@@ -430,7 +430,7 @@ void OUCH42Session::on_timer(const Timestamp& ts, void * I01_UNUSED userdata, st
 
     if (logged_in())
         if (ts.milliseconds_since_midnight() - m_last_message_sent_ts.milliseconds_since_midnight() >= 250ULL) {
-            core::LockGuard<Mutex> l(m_mutex);
+            Mutex::scoped_lock l(m_mutex);
             // Send client heartbeat.
             SBT::Messages::Heartbeat msg{
                 .packet_length = htons(sizeof(SBT::Messages::Heartbeat) - 2),
@@ -448,7 +448,7 @@ void OUCH42Session::on_timer(const Timestamp& ts, void * I01_UNUSED userdata, st
 
 void OUCH42Session::on_connected(const core::Timestamp&, void* I01_UNUSED ud)
 {
-    core::LockGuard<Mutex> l(m_mutex);
+    Mutex::scoped_lock l(m_mutex);
     bool was_connecting = __sync_val_compare_and_swap((int*)&m_session_state, (int)State::CONNECTING, (int)State::CONNECTED);
     if (!was_connecting) {
         return;
@@ -476,7 +476,7 @@ void OUCH42Session::on_connected(const core::Timestamp&, void* I01_UNUSED ud)
 
 void OUCH42Session::on_peer_disconnect(const core::Timestamp&, void* ud)
 {
-    core::LockGuard<Mutex> l(m_mutex);
+    Mutex::scoped_lock l(m_mutex);
     m_active = false;
     m_session_state = State::DISCONNECTED;
     std::cerr << "OUCH42Session " << name() << " peer disconnect." << std::endl;
@@ -485,7 +485,7 @@ void OUCH42Session::on_peer_disconnect(const core::Timestamp&, void* ud)
 
 void OUCH42Session::on_local_disconnect(const core::Timestamp&, void* ud)
 {
-    core::LockGuard<Mutex> l(m_mutex);
+    Mutex::scoped_lock l(m_mutex);
     m_active = false;
     m_session_state = State::DISCONNECTED;
     std::cerr << "OUCH42Session " << name() << " local disconnect." << std::endl;
@@ -560,7 +560,7 @@ void OUCH42Session::on_recv(const core::Timestamp& ts, void * I01_UNUSED ud, con
     if (buf == nullptr) // || !connected())
         return;
 
-    core::LockGuard<Mutex> l(m_mutex);
+    Mutex::scoped_lock l(m_mutex);
     m_last_message_received_ts = ts;
     // If we don't have enough bytes to construct a header, defer:
     if (UNLIKELY(m_dangly_length + len < (ssize_t)sizeof(SBT::Messages::PacketHeader))) {
@@ -1036,7 +1036,7 @@ std::string OUCH42Session::to_string() const
 {
     std::ostringstream ss;
     {
-        core::LockGuard<Mutex> l(m_mutex);
+        Mutex::scoped_lock l(m_mutex);
         ss << m_session_state << ","
            << "INSEQ," << m_persist->data()->last_seqnum_received;
     }
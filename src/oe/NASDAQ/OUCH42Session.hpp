@@ -29,7 +29,7 @@ class OUCH42Session
     , protected SoupBinTCP30::Listener {
 public:
     typedef core::Timestamp Timestamp;
-    typedef core::SpinMutex Mutex;
+    typedef Threading::Mutex Mutex;
     using SymbolInstCache = std::unordered_map<OUCH42::Types::StockArray, Instrument *, core::array_hasher<char, sizeof(OUCH42::Types::StockArray)> >;
     using NASDAQSymbolCache = std::array<std::string, MD::NUM_SYMBOL_INDEX>;
 
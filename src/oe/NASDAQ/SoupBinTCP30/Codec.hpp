@@ -0,0 +1,104 @@
+#pragma once
+
+// SoupBinTCP 3.0 as WireCodec descriptions: byte for byte the packed structs
+// of Messages.hpp.  packet_length is big endian and counts the bytes after
+// it; the payload of data and debug packets follows the header.
+
+#include <cstdint>
+
+#include <i01_oe/WireCodec.hpp>
+
+#include "Types.hpp"
+
+namespace i01 { namespace OE { namespace NASDAQ { namespace SoupBinTCP30 { namespace Codec {
+    using namespace i01::OE::WireCodec;
+    namespace T = i01::OE::NASDAQ::SoupBinTCP30::Types;
+
+    namespace F {
+        I01_WIRE_FIELD(packet_length);
+        I01_WIRE_FIELD(packet_type);
+        I01_WIRE_FIELD(username);
+        I01_WIRE_FIELD(password);
+        I01_WIRE_FIELD(session);
+        I01_WIRE_FIELD(requested_session);
+        I01_WIRE_FIELD(sequence_number);
+        I01_WIRE_FIELD(requested_sequence_number);
+        I01_WIRE_FIELD(reason_code);
+    }
+
+    typedef BigEndian<T::PacketLength> Length;
+    /// Sequence numbers are ASCII decimal, right justified.
+    typedef Alpha<20> SequenceNumber;
+
+    /* DOWNSTREAM */
+
+    using DebugPacket = Message<
+        Field<F::packet_length,         Length>
+      , Field<F::packet_type,           Literal<BigEndian<T::DownstreamPacketType>, T::DownstreamPacketType::DEBUG>>
+    >;
+    static_assert(DebugPacket::SIZE == 3, "SoupBinTCP30 DebugPacket is 3 bytes.");
+
+    using LoginAccept = Message<
+        Field<F::packet_length,         Literal<Length, 31>>
+      , Field<F::packet_type,           Literal<BigEndian<T::DownstreamPacketType>, T::DownstreamPacketType::LOGIN_ACCEPT>>
+      , Field<F::session,               Alpha<10>>
+      , Field<F::sequence_number,       SequenceNumber>
+    >;
+    static_assert(LoginAccept::SIZE == 33, "SoupBinTCP30 LoginAccept is 33 bytes.");
+
+    using LoginReject = Message<
+        Field<F::packet_length,         Literal<Length, 2>>
+      , Field<F::packet_type,           Literal<BigEndian<T::DownstreamPacketType>, T::DownstreamPacketType::LOGIN_REJECT>>
+      , Field<F::reason_code,           BigEndian<T::LoginRejectReasonCode>>
+    >;
+    static_assert(LoginReject::SIZE == 4, "SoupBinTCP30 LoginReject is 4 bytes.");
+
+    using SequencedDataPacket = Message<
+        Field<F::packet_length,         Length>
+      , Field<F::packet_type,           Literal<BigEndian<T::DownstreamPacketType>, T::DownstreamPacketType::SEQUENCED_DATA>>
+    >;
+    static_assert(SequencedDataPacket::SIZE == 3, "SoupBinTCP30 SequencedDataPacket is 3 bytes.");
+
+    using ServerHeartbeat = Message<
+        Field<F::packet_length,         Literal<Length, 1>>
+      , Field<F::packet_type,           Literal<BigEndian<T::DownstreamPacketType>, T::DownstreamPacketType::SERVER_HEARTBEAT>>
+    >;
+    static_assert(ServerHeartbeat::SIZE == 3, "SoupBinTCP30 ServerHeartbeat is 3 bytes.");
+
+    using EndOfSession = Message<
+        Field<F::packet_length,         Literal<Length, 1>>
+      , Field<F::packet_type,           Literal<BigEndian<T::DownstreamPacketType>, T::DownstreamPacketType::END_OF_SESSION>>
+    >;
+    static_assert(EndOfSession::SIZE == 3, "SoupBinTCP30 EndOfSession is 3 bytes.");
+
+    /* UPSTREAM */
+
+    using LoginRequest = Message<
+        Field<F::packet_length,         Literal<Length, 47>>
+      , Field<F::packet_type,           Literal<BigEndian<T::UpstreamPacketType>, T::UpstreamPacketType::LOGIN_REQUEST>>
+      , Field<F::username,              Alpha<6>>
+      , Field<F::password,              Alpha<10>>
+      , Field<F::requested_session,     Alpha<10>>
+      , Field<F::requested_sequence_number, SequenceNumber>
+    >;
+    static_assert(LoginRequest::SIZE == 49, "SoupBinTCP30 LoginRequest is 49 bytes.");
+
+    using UnsequencedDataPacket = Message<
+        Field<F::packet_length,         Length>
+      , Field<F::packet_type,           Literal<BigEndian<T::UpstreamPacketType>, T::UpstreamPacketType::UNSEQUENCED_MESSAGE>>
+    >;
+    static_assert(UnsequencedDataPacket::SIZE == 3, "SoupBinTCP30 UnsequencedDataPacket is 3 bytes.");
+
+    using Heartbeat = Message<
+        Field<F::packet_length,         Literal<Length, 1>>
+      , Field<F::packet_type,           Literal<BigEndian<T::UpstreamPacketType>, T::UpstreamPacketType::HEARTBEAT_MESSAGE>>
+    >;
+    static_assert(Heartbeat::SIZE == 3, "SoupBinTCP30 Heartbeat is 3 bytes.");
+
+    using LogoutRequest = Message<
+        Field<F::packet_length,         Literal<Length, 1>>
+      , Field<F::packet_type,           Literal<BigEndian<T::UpstreamPacketType>, T::UpstreamPacketType::LOGOFF_REQUEST>>
+    >;
+    static_assert(LogoutRequest::SIZE == 3, "SoupBinTCP30 LogoutRequest is 3 bytes.");
+
+} } } } }
@@ -0,0 +1,116 @@
+#pragma once
+
+// UTP Direct as WireCodec descriptions: byte for byte the packed structs of
+// Messages.hpp, all integers big endian.
+
+#include <cstdint>
+
+#include <i01_oe/WireCodec.hpp>
+
+#include "Types.hpp"
+
+namespace i01 { namespace OE { namespace NYSE { namespace UTPDirect { namespace Codec {
+    using namespace i01::OE::WireCodec;
+    namespace T = i01::OE::NYSE::UTPDirect::Types;
+
+    namespace F {
+        I01_WIRE_FIELD(message_type);
+        I01_WIRE_FIELD(msg_length);
+        I01_WIRE_FIELD(msg_seqnum);
+        I01_WIRE_FIELD(last_seqnum);
+        I01_WIRE_FIELD(last_seqnum_client_to_gw);
+        I01_WIRE_FIELD(last_seqnum_gw_to_client);
+        I01_WIRE_FIELD(sender_comp_id);
+        I01_WIRE_FIELD(message_version_profile);
+        I01_WIRE_FIELD(cancel_on_disconnect);
+        I01_WIRE_FIELD(logon_reject_type);
+        I01_WIRE_FIELD(text);
+        I01_WIRE_FIELD(order_qty);
+        I01_WIRE_FIELD(max_floor_qty);
+        I01_WIRE_FIELD(price);
+        I01_WIRE_FIELD(price_scale);
+        I01_WIRE_FIELD(symbol);
+        I01_WIRE_FIELD(exec_inst);
+        I01_WIRE_FIELD(side);
+        I01_WIRE_FIELD(order_type);
+        I01_WIRE_FIELD(time_in_force);
+        I01_WIRE_FIELD(capacity);
+        I01_WIRE_FIELD(routing_instruction);
+        I01_WIRE_FIELD(dot_reserve);
+        I01_WIRE_FIELD(on_behalf_of_compid);
+        I01_WIRE_FIELD(sender_sub_id);
+        I01_WIRE_FIELD(clearing_firm);
+        I01_WIRE_FIELD(account);
+        I01_WIRE_FIELD(client_order_id);
+        I01_WIRE_FIELD(filler);
+    }
+
+    template<std::size_t N> using Text = Alpha<N, '\0'>;
+    typedef BigEndian<std::uint32_t> SeqNum;
+
+    /// Also LogonAccepted.
+    using Logon = Message<
+        Field<F::message_type,          Literal<BigEndian<T::MessageType>, T::MessageType::LOGON>>
+      , Field<F::msg_length,            Literal<BigEndian<T::MsgLength>, 60>>
+      , Field<F::msg_seqnum,            SeqNum>
+      , Field<F::last_seqnum,           SeqNum>
+      , Field<F::sender_comp_id,        Text<12>>
+      , Field<F::message_version_profile, Text<32>>
+      , Field<F::cancel_on_disconnect,  BigEndian<T::CancelOnDisconnect>>
+      , Field<F::filler,                Filler<3>>
+    >;
+    static_assert(Logon::SIZE == 60, "UTPDirect Logon is 60 bytes.");
+
+    using LogonReject = Message<
+        Field<F::message_type,          Literal<BigEndian<T::MessageType>, T::MessageType::LOGON_REJECT>>
+      , Field<F::msg_length,            Literal<BigEndian<T::MsgLength>, 60>>
+      , Field<F::msg_seqnum,            SeqNum>
+      , Field<F::last_seqnum_client_to_gw, SeqNum>
+      , Field<F::last_seqnum_gw_to_client, SeqNum>
+      , Field<F::logon_reject_type,     BigEndian<T::LogonRejectType>>
+      , Field<F::text,                  Text<40>>
+      , Field<F::filler,                Filler<2>>
+    >;
+    static_assert(LogonReject::SIZE == 60, "UTPDirect LogonReject is 60 bytes.");
+
+    using TestRequest = Message<
+        Field<F::message_type,          Literal<BigEndian<T::MessageType>, T::MessageType::TEST_MESSAGE>>
+      , Field<F::msg_length,            Literal<BigEndian<T::MsgLength>, 8>>
+      , Field<F::msg_seqnum,            SeqNum>
+    >;
+    static_assert(TestRequest::SIZE == 8, "UTPDirect TestRequest is 8 bytes.");
+
+    using HeartbeatMessage = Message<
+        Field<F::message_type,          Literal<BigEndian<T::MessageType>, T::MessageType::HEARTBEAT_MESSAGE>>
+      , Field<F::msg_length,            Literal<BigEndian<T::MsgLength>, 8>>
+      , Field<F::msg_seqnum,            SeqNum>
+    >;
+    static_assert(HeartbeatMessage::SIZE == 8, "UTPDirect HeartbeatMessage is 8 bytes.");
+
+    using NewOrder1 = Message<
+        Field<F::message_type,          Literal<BigEndian<T::MessageType>, T::MessageType::NEW_ORDER_1>>
+      , Field<F::msg_length,            Literal<BigEndian<T::MsgLength>, 84>>
+      , Field<F::msg_seqnum,            SeqNum>
+      , Field<F::order_qty,             BigEndian<T::Quantity>>
+      , Field<F::max_floor_qty,         BigEndian<T::Quantity>>
+        // in units of price_scale
+      , Field<F::price,                 BigEndian<T::Price>>
+      , Field<F::price_scale,           BigEndian<T::PriceScale>>
+      , Field<F::symbol,                Text<11>>
+      , Field<F::exec_inst,             BigEndian<T::ExecInst>>
+      , Field<F::side,                  BigEndian<T::Side>>
+      , Field<F::order_type,            BigEndian<T::OrderType>>
+      , Field<F::time_in_force,         BigEndian<T::TimeInForce>>
+      , Field<F::capacity,              BigEndian<T::Capacity>>
+      , Field<F::routing_instruction,   BigEndian<T::RoutingInstruction>>
+      , Field<F::dot_reserve,           BigEndian<T::DOTReserve>>
+      , Field<F::on_behalf_of_compid,   Text<5>>
+      , Field<F::sender_sub_id,         Text<5>>
+      , Field<F::clearing_firm,         Text<5>>
+      , Field<F::account,               Text<10>>
+      , Field<F::client_order_id,       Text<17>>
+      , Field<F::filler,                Filler<3>>
+    >;
+    static_assert(NewOrder1::SIZE == 84, "UTPDirect NewOrder1 is 84 bytes.");
+
+} } } } }
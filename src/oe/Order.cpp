@@ -36,6 +36,10 @@ Order::Order( Instrument* const instrument_
   , m_total_value_paid(0.0)
   , m_last_fill_fee_code(FillFeeCode::UNKNOWN)
   , m_last_exchange_time{0}
+  , m_pool_p(nullptr)
+  , m_retired(false)
+  , m_session_released(false)
+  , m_session_refs(0)
 {
     m_client_order_id.fill(' ');
 }
@@ -66,6 +70,10 @@ Order::Order(const Order& o)
   , m_last_fill_fee_code(o.last_fill_fee_code())
   , m_last_exchange_time(o.last_exchange_time())
   , m_mutex() // don't copy the mutex
+  , m_pool_p(nullptr) // ... or where the storage came from
+  , m_retired(false)
+  , m_session_released(false)
+  , m_session_refs(0)
 {
     m_client_order_id = o.client_order_id();
 }
@@ -0,0 +1,303 @@
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+#include <i01_core/Config.hpp>
+#include <i01_core/Time.hpp>
+
+#include <i01_oe/Order.hpp>
+#include <i01_oe/OrderGateway.hpp>
+#include <i01_oe/OrderManager.hpp>
+#include <i01_oe/OrderSession.hpp>
+#include <i01_oe/Threading.hpp>
+
+namespace i01 { namespace OE {
+
+const std::size_t OrderGateway::DEFAULT_INTENT_QUEUE_SIZE;
+const std::size_t OrderGateway::DEFAULT_EVENT_RING_SIZE;
+const std::uint64_t OrderGateway::DEFAULT_FULL_WAIT_US;
+const std::size_t OrderGateway::NO_LANE;
+
+namespace {
+
+/// Intents handled per pass of a session thread.
+const std::size_t INTENT_BATCH = 64;
+
+}
+
+GatewayClient::GatewayClient(OrderGateway& gw, std::uint32_t index, OrderListener* listener_p, std::size_t sessions, std::size_t ring_size)
+    : m_gateway(gw)
+    , m_index(index)
+    , m_listener_p(listener_p)
+    , m_responses()
+    , m_local()
+    , m_dropped(0)
+{
+    for (std::size_t i = 0; i < sessions; ++i) {
+        m_responses.emplace_back(new ResponseRing(ring_size));
+        m_local.emplace_back(new LocalRing(ring_size));
+    }
+}
+
+bool GatewayClient::send(Order* order_p, OrderSession* session_p)
+{
+    if (UNLIKELY(order_p == nullptr || order_p->listener() != this))
+        return false;
+    const auto lane = m_gateway.lane(session_p);
+    if (UNLIKELY(lane == OrderGateway::NO_LANE))
+        return false;
+
+    auto& om = m_gateway.order_manager();
+    if (!om.prepare_send(order_p, session_p))
+        return false;
+    if (UNLIKELY(!m_gateway.queue(lane, OrderIntent{order_p, 0, m_index, OrderIntent::Kind::NEW}))) {
+        om.complete_send(order_p, false);
+        return false;
+    }
+    return true;
+}
+
+bool GatewayClient::cancel(const Order* order_p, Size newqty)
+{
+    // the order's state belongs to the session's threads; the gateway
+    // thread's OrderManager::cancel turns down terminal orders
+    if (UNLIKELY(order_p == nullptr))
+        return false;
+    const auto lane = m_gateway.lane(order_p->session());
+    if (UNLIKELY(lane == OrderGateway::NO_LANE))
+        return false;
+    return m_gateway.queue(lane, OrderIntent{const_cast<Order*>(order_p), newqty, m_index, OrderIntent::Kind::CANCEL});
+}
+
+std::size_t GatewayClient::poll(std::size_t max)
+{
+    std::size_t n = 0;
+    OrderEvent ev;
+    for (std::size_t i = 0; i < m_responses.size() && n < max; ++i) {
+        // the two rings keep their own order but not each other's; local
+        // rejects go first:
+        while (n < max && m_local[i]->try_pop(ev)) {
+            dispatch(ev);
+            ++n;
+        }
+        while (n < max && m_responses[i]->try_pop(ev)) {
+            dispatch(ev);
+            ++n;
+        }
+    }
+    return n;
+}
+
+void GatewayClient::dispatch(const OrderEvent& ev)
+{
+    if (UNLIKELY(m_listener_p == nullptr))
+        return;
+    switch (ev.kind) {
+    case OrderEvent::Kind::ACKNOWLEDGED:
+        m_listener_p->on_order_acknowledged(ev.order_p);
+        break;
+    case OrderEvent::Kind::FILL:
+        m_listener_p->on_order_fill(ev.order_p, ev.size, ev.price, ev.fee);
+        break;
+    case OrderEvent::Kind::CANCEL:
+        m_listener_p->on_order_cancel(ev.order_p, ev.size);
+        break;
+    case OrderEvent::Kind::CANCEL_REJECTED:
+        m_listener_p->on_order_cancel_rejected(ev.order_p);
+        break;
+    case OrderEvent::Kind::CANCEL_REPLACED:
+        m_listener_p->on_order_cancel_replaced(ev.order_p);
+        break;
+    case OrderEvent::Kind::REJECTED:
+        m_listener_p->on_order_rejected(ev.order_p);
+        break;
+    default:
+        break;
+    }
+}
+
+template<typename Ring>
+void GatewayClient::push(Ring& ring, const OrderEvent& ev)
+{
+    if (LIKELY(ring.try_push(ev)))
+        return;
+    // wait a while for the strategy to poll, but never hold up the
+    // session's thread for good:
+    const auto deadline = core::Timestamp::now() + core::Timestamp(0, static_cast<long>(m_gateway.m_full_wait_ns));
+    do {
+        std::this_thread::yield();
+        if (ring.try_push(ev))
+            return;
+    } while (core::Timestamp::now() < deadline);
+    const auto n = m_dropped.fetch_add(1, std::memory_order_relaxed) + 1;
+    if (0 == (n & (n - 1)))
+        std::cerr << "GatewayClient " << m_index << ": response ring full, " << n << " responses dropped, last for " << *ev.order_p << std::endl;
+}
+
+void GatewayClient::respond(const Order* order_p, OrderEvent::Kind kind, Size size, Price price, Dollars fee)
+{
+    const auto lane = m_gateway.lane(order_p->session());
+    if (UNLIKELY(lane == OrderGateway::NO_LANE)) {
+        std::cerr << "GatewayClient: response for an order on a session outside the gateway: " << *order_p << std::endl;
+        return;
+    }
+    push(*m_responses[lane], OrderEvent{order_p, size, price, fee, kind});
+}
+
+void GatewayClient::local(std::size_t lane, const Order* order_p, OrderEvent::Kind kind)
+{
+    push(*m_local[lane], OrderEvent{order_p, 0, 0, 0, kind});
+}
+
+void GatewayClient::on_order_acknowledged(const Order* order_p)
+{
+    respond(order_p, OrderEvent::Kind::ACKNOWLEDGED);
+}
+
+void GatewayClient::on_order_fill(const Order* order_p, const Size size, const Price price, const Dollars fee)
+{
+    respond(order_p, OrderEvent::Kind::FILL, size, price, fee);
+}
+
+void GatewayClient::on_order_cancel(const Order* order_p, const Size size)
+{
+    respond(order_p, OrderEvent::Kind::CANCEL, size);
+}
+
+void GatewayClient::on_order_cancel_rejected(const Order* order_p)
+{
+    respond(order_p, OrderEvent::Kind::CANCEL_REJECTED);
+}
+
+void GatewayClient::on_order_cancel_replaced(const Order* order_p)
+{
+    respond(order_p, OrderEvent::Kind::CANCEL_REPLACED);
+}
+
+void GatewayClient::on_order_rejected(const Order* order_p)
+{
+    respond(order_p, OrderEvent::Kind::REJECTED);
+}
+
+OrderGateway::SessionThread::SessionThread(OrderGateway& gw, std::size_t lane, OrderSession* session, std::size_t queue_size)
+    : NamedThread(session->name() + "_gw")
+    , session_p(session)
+    , intents(queue_size)
+    , m_gateway(gw)
+    , m_lane(lane)
+{
+}
+
+void * OrderGateway::SessionThread::process()
+{
+    OrderIntent in;
+    std::size_t n = 0;
+    while (n < INTENT_BATCH && intents.try_pop(in)) {
+        handle(in, true);
+        ++n;
+    }
+    if (0 == n) {
+        if (LIKELY(m_gateway.m_spin))
+            __builtin_ia32_pause();
+        else
+            std::this_thread::yield();
+    }
+    return nullptr;
+}
+
+void OrderGateway::SessionThread::post_process()
+{
+    OrderIntent in;
+    while (intents.try_pop(in))
+        handle(in, false);
+}
+
+void OrderGateway::SessionThread::handle(const OrderIntent& in, bool transmit)
+{
+    auto& om = m_gateway.m_om;
+    auto* client = m_gateway.m_clients[in.client].get();
+    switch (in.kind) {
+    case OrderIntent::Kind::NEW:
+        if (!om.complete_send(in.order_p, transmit))
+            client->local(m_lane, in.order_p, OrderEvent::Kind::REJECTED);
+        break;
+    case OrderIntent::Kind::CANCEL:
+        if (!transmit || !om.cancel(in.order_p, in.newqty))
+            client->local(m_lane, in.order_p, OrderEvent::Kind::CANCEL_REJECTED);
+        break;
+    default:
+        break;
+    }
+}
+
+OrderGateway::OrderGateway(OrderManager& om)
+    : m_om(om)
+    , m_intent_queue_size(DEFAULT_INTENT_QUEUE_SIZE)
+    , m_event_ring_size(DEFAULT_EVENT_RING_SIZE)
+    , m_full_wait_ns(DEFAULT_FULL_WAIT_US * 1000)
+    , m_spin(true)
+    , m_lanes()
+    , m_clients()
+    , m_running(false)
+{
+    if (Threading::single_threaded)
+        throw std::runtime_error("OrderGateway: not available in a build with I01_OE_SINGLE_THREADED.");
+
+    auto cs = core::Config::instance().get_shared_state()->copy_prefix_domain("oe.gateway.");
+    m_intent_queue_size = cs->get_or_default<std::size_t>("intent_queue_size", m_intent_queue_size);
+    m_event_ring_size = cs->get_or_default<std::size_t>("event_ring_size", m_event_ring_size);
+    m_full_wait_ns = cs->get_or_default<std::uint64_t>("full_wait_us", DEFAULT_FULL_WAIT_US) * 1000;
+    m_spin = "false" != cs->get_or_default<std::string>("spin", "true");
+}
+
+OrderGateway::~OrderGateway()
+{
+    stop();
+}
+
+void OrderGateway::add_session(OrderSession* session_p)
+{
+    if (m_running || !m_clients.empty())
+        throw std::logic_error("OrderGateway: sessions must be added before clients and start().");
+    if (session_p == nullptr || lane(session_p) != NO_LANE)
+        return;
+    m_lanes.emplace_back(new SessionThread(*this, m_lanes.size(), session_p, m_intent_queue_size));
+}
+
+GatewayClient* OrderGateway::add_client(OrderListener* listener_p)
+{
+    if (m_running)
+        throw std::logic_error("OrderGateway: clients must be added before start().");
+    const auto index = static_cast<std::uint32_t>(m_clients.size());
+    m_clients.emplace_back(new GatewayClient(*this, index, listener_p, m_lanes.size(), m_event_ring_size));
+    return m_clients.back().get();
+}
+
+bool OrderGateway::start()
+{
+    if (m_running)
+        return true;
+    for (auto& t : m_lanes) {
+        if (!t->spawn()) {
+            std::cerr << "OrderGateway: failed to spawn " << t->name() << std::endl;
+            stop();
+            return false;
+        }
+    }
+    m_running = true;
+    return true;
+}
+
+void OrderGateway::stop()
+{
+    for (auto& t : m_lanes) {
+        if (t->state() == SessionThread::State::UNINITIALIZED)
+            continue;
+        while (t->state() == SessionThread::State::STARTING)
+            __builtin_ia32_pause();
+        t->shutdown(true);
+    }
+    m_running = false;
+}
+
+}}
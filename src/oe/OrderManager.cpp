@@ -1,7 +1,11 @@
+#include <algorithm>
 #include <cassert>
 #include <cstdlib>
+#include <stdexcept>
 #include <string>
 
+#include <cxxabi.h>
+
 #include <i01_core/Log.hpp>
 #include <i01_md/DataManager.hpp>
 
@@ -9,17 +13,22 @@
 #include <i01_oe/FileBlotter.hpp>
 #include <i01_oe/FileBlotterReader.hpp>
 #include <i01_oe/Instrument.hpp>
+#include <i01_oe/OrderGateway.hpp>
 #include <i01_oe/OrderLogFormat.hpp>
 #include <i01_oe/OrderManager.hpp>
 #include <i01_oe/OrderSession.hpp>
 
 namespace i01 { namespace OE {
 
+    const std::size_t OrderManager::MAX_ORDER_POOLS;
+    const std::size_t OrderManager::DEFAULT_ORDER_POOL_CAPACITY;
+    const std::size_t OrderManager::DEFAULT_LOCAL_ID_CAPACITY;
+
     OrderManager::OrderManager(MD::DataManager *dm)
         : m_localID(0),
           m_firm_risk(),
           m_portfolio_risk(),
-          m_orders({nullptr}), // ... to protect against looking up localID 0.
+          m_orders(),
           m_sessions(),
           m_default_listener_p(nullptr),
           m_mutex(),
@@ -28,8 +37,17 @@ namespace i01 { namespace OE {
           m_trading_fees(),
           m_last_sale(),
           m_blotter_p(new FileBlotter(*this)),
-          m_blotter_reader_p(new FileBlotterReader())
+          m_blotter_reader_p(new FileBlotterReader()),
+          m_order_pool_cfg(),
+          m_order_pools(),
+          m_send_stage_timing(false),
+          m_send_stage_stats(),
+          m_gateway()
     {
+        for (auto& p : m_order_pool_ptrs)
+            p.store(nullptr, std::memory_order_relaxed);
+        m_orders.reserve(LocalIDTable::CHUNK_SIZE);
+        m_orders.push_back(nullptr); // ... to protect against looking up localID 0.
         assert(m_localID == m_orders.size() - 1);
         m_blotter_reader_p->register_listeners(this);
 
@@ -39,6 +57,8 @@ namespace i01 { namespace OE {
 
     OrderManager::~OrderManager()
     {
+        if (m_gateway)
+            m_gateway->stop();
         for (auto s : m_sessions) {
             s.second->disconnect(true);
         }
@@ -52,10 +72,36 @@ namespace i01 { namespace OE {
         auto oecfg(cfg.copy_prefix_domain("oe."));
         auto oeunivcfg(oecfg->copy_prefix_domain("universe."));
 
+        // A single threaded build has no locks on the order path, so every
+        // strategy, session and market data callback that reaches this
+        // OrderManager has to run on one thread, and the config must say so.
+        bool single_threaded = "true" == oecfg->get_or_default<std::string>("single_threaded", "false");
+        if (Threading::single_threaded && !single_threaded) {
+            throw std::runtime_error("OrderManager: built with I01_OE_SINGLE_THREADED, but oe.single_threaded is not set.");
+        } else if (!Threading::single_threaded && single_threaded) {
+            std::cerr << "OrderManager: oe.single_threaded is set, but this build still locks; rebuild with I01_OE_SINGLE_THREADED to drop the locks." << std::endl;
+        }
+        if (auto timing = oecfg->get<std::string>("send_stage_timing"))
+            m_send_stage_timing = "true" == *timing;
+        // sessions are added to the gateway as they are created, so it has
+        // to exist before any are
+        if ("true" == oecfg->get_or_default<std::string>("gateway.enabled", "false") && !m_gateway) {
+            if (!m_sessions.empty())
+                throw std::logic_error("OrderManager: oe.gateway.enabled needs init() before add_session().");
+            m_gateway.reset(new OrderGateway(*this));
+        }
+
         auto mdcfg(cfg.copy_prefix_domain("md.universe."));
 
         m_universe.init(*mdcfg, *oeunivcfg);
 
+        // size the order storage before anything is sent
+        m_order_pool_cfg = oecfg->copy_prefix_domain("order_pool.");
+        {
+            OrderManagerMutex::scoped_lock lock(m_mutex);
+            m_orders.reserve(oecfg->get_or_default<std::size_t>("local_id_capacity", DEFAULT_LOCAL_ID_CAPACITY));
+        }
+
         // set up the firm risk
         auto frd(oecfg->copy_prefix_domain("risk.firm."));
         m_firm_risk.init(*frd);
@@ -80,6 +126,9 @@ namespace i01 { namespace OE {
             if (it->second)
                 it->second->connect(replay);
         }
+
+        if (m_gateway && !m_gateway->start())
+            throw std::runtime_error("OrderManager: failed to start the order gateway's session threads.");
     }
 
     bool OrderManager::send( Order* order_p
@@ -92,42 +141,115 @@ namespace i01 { namespace OE {
             return false;
         }
 
+        using Stage = SendStageStats::Stage;
+        SendStageStats::Sample sample;
+        SendStageStats::Sample* sample_p = nullptr;
+        if (UNLIKELY(m_send_stage_timing)) {
+            sample.start();
+            sample_p = &sample;
+        }
+
         Order::OrderMutex::scoped_lock lock(order_p->mutex());
         assert(order_p->market() == session_p->market());
+        assign_local_id(order_p);
 
-        {
-            OrderManagerMutex::scoped_lock mlock(m_mutex);
-            order_p->localID(++m_localID);
-            m_orders.push_back(order_p);
-            assert(m_localID == m_orders.size() - 1);
+        EquityInstrument::mutex_type::scoped_lock instlock(order_p->instrument()->mutex());
+        send_stage(sample_p, Stage::LOCK);
+        const bool sent = send_checks(order_p, session_p, sample_p)
+                       && send_to_session(order_p, session_p, sample_p);
+        if (!sent)
+            local_reject(order_p);
+        if (UNLIKELY(sample_p != nullptr)) {
+            sample.lap(Stage::BLOTTER);
+            add_send_stage_sample(sample);
         }
+        return sent;
+    }
+
+    bool OrderManager::prepare_send(Order* order_p, OrderSession* session_p)
+    {
+        if (order_p == nullptr || session_p == nullptr) {
+#ifdef I01_DEBUG_MESSAGING
+            std::cerr << "ERROR: OrderManager::prepare_send called without order or session pointers." << std::endl;
+#endif
+            return false;
+        }
+
+        Order::OrderMutex::scoped_lock lock(order_p->mutex());
+        assert(order_p->market() == session_p->market());
+        assign_local_id(order_p);
+
+        EquityInstrument::mutex_type::scoped_lock instlock(order_p->instrument()->mutex());
+        if (send_checks(order_p, session_p, nullptr))
+            return true;
+        local_reject(order_p);
+        return false;
+    }
+
+    bool OrderManager::complete_send(Order* order_p, bool transmit)
+    {
+        if (UNLIKELY(order_p == nullptr || order_p->session() == nullptr))
+            return false;
+
+        Order::OrderMutex::scoped_lock lock(order_p->mutex());
+        if (UNLIKELY(order_p->state() != OrderState::NEW_AND_UNSENT))
+            return false;
 
         EquityInstrument::mutex_type::scoped_lock instlock(order_p->instrument()->mutex());
-        if (order_p->validate_base() && order_p->validate()) {
+        if (transmit) {
+            if (send_to_session(order_p, order_p->session(), nullptr))
+                return true;
+        } else {
+            m_firm_risk.on_order_removes(order_p, order_p->size());
+        }
+        local_reject(order_p);
+        return false;
+    }
+
+    void OrderManager::assign_local_id(Order* order_p)
+    {
+        OrderManagerMutex::scoped_lock mlock(m_mutex);
+        order_p->localID(++m_localID);
+        m_orders.push_back(order_p);
+        assert(m_localID == m_orders.size() - 1);
+    }
+
+    bool OrderManager::send_checks(Order* order_p, OrderSession* session_p, SendStageStats::Sample* sample_p)
+    {
+        using Stage = SendStageStats::Stage;
+        if (send_stage(sample_p, Stage::VALIDATE, order_p->validate_base() && order_p->validate())) {
             // First, do system-wide risk checks:
-            if ( m_firm_risk.new_order(order_p)
-               && m_portfolio_risk.new_order(order_p)
-               && (session_p->risk().new_order(order_p))
-               && (order_p->instrument()->validate(order_p))
+            if ( send_stage(sample_p, Stage::FIRM_RISK, m_firm_risk.new_order(order_p))
+               && send_stage(sample_p, Stage::PORTFOLIO_RISK, m_portfolio_risk.new_order(order_p))
+               && send_stage(sample_p, Stage::SESSION_RISK, session_p->risk().new_order(order_p))
+               && send_stage(sample_p, Stage::INSTRUMENT, order_p->instrument()->validate(order_p))
                 ) {
                 order_p->session(session_p);
 
                 m_firm_risk.on_order_adds(order_p, order_p->size());
-
-                if (session_p->send(order_p)) {
-                    order_p->state(OrderState::SENT);
-                    m_blotter_p->log_new_order(order_p);
-                    m_blotter_p->log_order_sent(order_p);
-                    return true;
-                } else {
-                    m_firm_risk.on_order_removes(order_p, order_p->size());
-                    std::cerr << "OrderManager: send fail for " << *order_p << std::endl;
-                }
+                return true;
             }
         }
+        return false;
+    }
+
+    bool OrderManager::send_to_session(Order* order_p, OrderSession* session_p, SendStageStats::Sample* sample_p)
+    {
+        if (send_stage(sample_p, SendStageStats::Stage::SESSION_SEND, session_p->send(order_p))) {
+            order_p->state(OrderState::SENT);
+            m_blotter_p->log_new_order(order_p);
+            m_blotter_p->log_order_sent(order_p);
+            return true;
+        }
+        m_firm_risk.on_order_removes(order_p, order_p->size());
+        std::cerr << "OrderManager: send fail for " << *order_p << std::endl;
+        return false;
+    }
+
+    void OrderManager::local_reject(Order* order_p)
+    {
         order_p->state(OrderState::LOCALLY_REJECTED);
         m_blotter_p->log_local_reject(order_p);
-        return false;
     }
 
     bool OrderManager::cancel(const Order* order_p, Size newqty)
@@ -147,6 +269,11 @@ namespace i01 { namespace OE {
             return false;
         }
 
+        // prepared, but not yet handed to its session by complete_send:
+        if (UNLIKELY(nonconst_order_p->state() == OrderState::NEW_AND_UNSENT)) {
+            return false;
+        }
+
         // if already requested a cancel/reduce to <= newqty:
         if (UNLIKELY((nonconst_order_p->state() == OE::OrderState::PENDING_CANCEL) && (nonconst_order_p->m_pendingcancel_newqty <= newqty)))
             return false;
@@ -175,6 +302,11 @@ namespace i01 { namespace OE {
         if (UNLIKELY(only_if_terminal && !(order_p->is_terminal())))
             return false;
 
+        if (UNLIKELY(order_p->m_retired)) {
+            std::cerr << "OrderManager::destroy called on an order already released for reuse: " << *order_p << std::endl;
+            return false;
+        }
+
         if (UNLIKELY(order_p->localID() == 0)) {
             goto exterminate;
         }
@@ -194,7 +326,7 @@ forget:
         m_orders[order_p->localID()] = nullptr;
 exterminate:
         m_blotter_p->log_destroy(order_p);
-        delete order_p;
+        dispose(order_p);
         return true;
     }
 
@@ -251,8 +383,10 @@ void OrderManager::order_update_on_reject(Order *order_p, const Timestamp& times
         m_firm_risk.on_order_removes(order_p, order_p->size());
         m_blotter_p->log_rejected(order_p);
 
-        if (auto* l = order_p->listener_or_default(m_default_listener_p))
+        auto* l = order_p->listener_or_default(m_default_listener_p);
+        if (l)
             l->on_order_rejected(order_p);
+        retire(order_p, l);
     }
 
 void OrderManager::order_update_on_fill(Order *order_p, const Size fillSize,
@@ -315,8 +449,11 @@ void OrderManager::on_fill(Order* order_p,
 
         m_blotter_p->log_filled(order_p, fillSize, fillPrice, timestamp, fee_code);
 
-        if (auto* l = order_p->listener_or_default(m_default_listener_p))
+        auto* l = order_p->listener_or_default(m_default_listener_p);
+        if (l)
             l->on_order_fill(order_p, fillSize, fillPrice, fee);
+        if (order_p->is_terminal())
+            retire(order_p, l);
     }
 
     void OrderManager::on_cancel_rejected(Order* order_p,
@@ -384,8 +521,11 @@ void OrderManager::order_update_on_cancel(Order *order_p, const Size cancelSize,
             m_firm_risk.on_order_removes(order_p, cancelSize);
             m_blotter_p->log_cancelled(order_p, cancelSize);
 
-            if (auto* l = order_p->listener_or_default(m_default_listener_p))
+            auto* l = order_p->listener_or_default(m_default_listener_p);
+            if (l)
                 l->on_order_cancel(order_p, cancelSize);
+            if (order_p->is_terminal())
+                retire(order_p, l);
         }
     }
 
@@ -416,6 +556,8 @@ void OrderManager::order_update_on_cancel(Order *order_p, const Size cancelSize,
         if (osp) {
             m_sessions.emplace(std::make_pair(session_name, osp));
             m_blotter_p->log_add_session(osp.get());
+            if (m_gateway)
+                m_gateway->add_session(osp.get());
             return std::make_pair(osp, true);
         } else {
             std::cerr << "OrderManager::add_session failed to create session " << session_name << std::endl;
@@ -459,7 +601,8 @@ void OrderManager::on_last_sale_change(const MD::EphemeralSymbolIndex esi, const
 size_t OrderManager::find_and_cancel(std::function<bool(OE::Order *)> pred_func)
 {
     size_t count=0;
-    for (auto* o : m_orders) {
+    for (std::size_t i = 1; i < m_orders.size(); ++i) {
+        auto* o = m_orders[static_cast<LocalID>(i)];
         if (o != nullptr && !o->is_terminal() && pred_func(o)) {
             if (cancel(o)) {
                 count++;
@@ -530,7 +673,7 @@ void OrderManager::extend_local_id(LocalID lid)
     assert(m_orders.size() == m_localID+1);
     if (lid+1 > m_orders.size()) {
         // grow the vector with nullptrs ... we will fill them in if necessary...
-        m_orders.resize(lid+1, nullptr);
+        m_orders.resize(lid+1);
         m_localID = lid;
     }
 }
@@ -627,7 +770,7 @@ void OrderManager::on_log_destroy(const Timestamp& ts, const OrderLogFormat::Ord
     auto op = m_orders[b.oid.local_id];
     if (op) {
         m_orders[b.oid.local_id] = nullptr;
-        delete op;
+        dispose(op);
     }
 }
 
@@ -767,6 +910,15 @@ std::string OrderManager::status() const
            << std::string(s.second->active() ? "ACTIVE" : "INACTIVE") << ","
            << s.second->status();
     }
+    for (const auto& ps : order_pool_stats()) {
+        ss << "\norder_pool," << ps.name
+           << ",in_use," << ps.in_use
+           << ",high_water," << ps.high_water
+           << ",capacity," << ps.capacity;
+    }
+    if (m_send_stage_timing) {
+        ss << "\nsend_stage," << send_stage_stats();
+    }
     return ss.str();
 }
 
@@ -786,7 +938,8 @@ OrderManager::OrderPtrContainer OrderManager::all_orders() const
 OrderManager::OrderPtrContainer OrderManager::unsafe_order_filter(const OrderFilterFunc& f) const
 {
     OrderPtrContainer res;
-    for (const auto& p : m_orders) {
+    for (std::size_t i = 1; i < m_orders.size(); ++i) {
+        auto* p = m_orders[static_cast<LocalID>(i)];
         if (nullptr != p && f(p)) {
             res.push_back(p);
         }
@@ -794,6 +947,120 @@ OrderManager::OrderPtrContainer OrderManager::unsafe_order_filter(const OrderFil
     return res;
 }
 
+SendStageStats OrderManager::send_stage_stats() const
+{
+    OrderManagerMutex::scoped_lock lock(m_mutex);
+    return m_send_stage_stats;
+}
+
+void OrderManager::reset_send_stage_stats()
+{
+    OrderManagerMutex::scoped_lock lock(m_mutex);
+    m_send_stage_stats = SendStageStats();
+}
+
+void OrderManager::add_send_stage_sample(const SendStageStats::Sample& sample)
+{
+    OrderManagerMutex::scoped_lock lock(m_mutex);
+    m_send_stage_stats.add(sample);
+}
+
+std::size_t OrderManager::next_order_pool_index()
+{
+    static std::atomic<std::size_t> next(0);
+    return next.fetch_add(1);
+}
+
+namespace {
+
+/// The unqualified name of an order type, e.g. "BOE20Order".
+std::string order_type_name(const std::type_info& type)
+{
+    int status = 0;
+    char *demangled = abi::__cxa_demangle(type.name(), nullptr, nullptr, &status);
+    std::string name(0 == status && demangled ? demangled : type.name());
+    std::free(demangled);
+    auto pos = name.rfind("::");
+    return pos == std::string::npos ? name : name.substr(pos + 2);
+}
+
+}
+
+OrderPool* OrderManager::make_order_pool(std::size_t index, std::size_t block_size, const std::type_info& type)
+{
+    OrderManagerMutex::scoped_lock lock(m_mutex);
+    if (auto* pool = m_order_pool_ptrs[index].load(std::memory_order_relaxed))
+        return pool;
+
+    auto name = order_type_name(type);
+    std::size_t capacity = DEFAULT_ORDER_POOL_CAPACITY;
+    std::size_t slab_size = OrderPool::DEFAULT_SLAB_SIZE;
+    if (m_order_pool_cfg) {
+        m_order_pool_cfg->get<std::size_t>("capacity", capacity);
+        m_order_pool_cfg->get<std::size_t>("slab_size", slab_size);
+        m_order_pool_cfg->get<std::size_t>(name + ".capacity", capacity);
+        m_order_pool_cfg->get<std::size_t>(name + ".slab_size", slab_size);
+    }
+    m_order_pools[index].reset(new OrderPool(name, block_size, capacity, slab_size));
+    m_order_pool_ptrs[index].store(m_order_pools[index].get(), std::memory_order_release);
+    return m_order_pools[index].get();
+}
+
+std::vector<OrderPoolStats> OrderManager::order_pool_stats() const
+{
+    std::vector<OrderPoolStats> res;
+    for (const auto& p : m_order_pool_ptrs) {
+        if (auto* pool = p.load(std::memory_order_acquire))
+            res.push_back(pool->stats());
+    }
+    return res;
+}
+
+void OrderManager::retire(Order* order_p, OrderListener* listener_p)
+{
+    auto* session_p = order_p->session();
+    if (!listener_p || !listener_p->release_terminal_orders() || !session_p || !session_p->releases_orders())
+        return;
+
+    OrderManagerMutex::scoped_lock lock(m_mutex);
+    // a session that let go before the order was terminal broke its
+    // contract: keep the order rather than reuse it under the caller.
+    if (order_p->m_retired || order_p->m_session_released)
+        return;
+    order_p->m_retired = true;
+    const auto id = order_p->localID();
+    if (id > 0 && id < m_orders.size() && m_orders[id] == order_p)
+        m_orders[id] = nullptr;
+}
+
+void OrderManager::on_session_released(Order* order_p)
+{
+    bool retired = false;
+    {
+        OrderManagerMutex::scoped_lock lock(m_mutex);
+        if (UNLIKELY(order_p->m_session_released)) {
+            std::cerr << "OrderManager: order released twice by its session: " << *order_p << std::endl;
+            return;
+        }
+        order_p->m_session_released = true;
+        retired = order_p->m_retired;
+    }
+    if (retired)
+        dispose(order_p);
+}
+
+void OrderManager::dispose(Order* order_p)
+{
+    if (auto* pool = order_p->m_pool_p) {
+        // the block starts at the most derived object:
+        void* p = dynamic_cast<void*>(order_p);
+        order_p->~Order();
+        pool->deallocate(p);
+    } else {
+        delete order_p;
+    }
+}
+
 void OrderManager::enable_stock(MD::EphemeralSymbolIndex esi)
 {
     m_firm_risk.user_enable(esi);
@@ -0,0 +1,106 @@
+#include <cstddef>
+#include <stdexcept>
+
+#include <i01_oe/OrderPool.hpp>
+
+namespace i01 { namespace OE {
+
+const std::size_t OrderPool::DEFAULT_SLAB_SIZE;
+const unsigned LocalIDTable::CHUNK_BITS;
+const std::size_t LocalIDTable::CHUNK_SIZE;
+const std::size_t LocalIDTable::MAX_CHUNKS;
+
+namespace {
+
+std::size_t round_block_size(std::size_t n)
+{
+    // slabs come from operator new, so blocks on this boundary are
+    // suitably aligned for any order type:
+    const std::size_t a = alignof(std::max_align_t);
+    if (n < sizeof(void *))
+        n = sizeof(void *);
+    return (n + a - 1) / a * a;
+}
+
+}
+
+OrderPool::OrderPool(const std::string &name, std::size_t block_size, std::size_t capacity, std::size_t slab_size)
+    : m_name(name)
+    , m_block_size(round_block_size(block_size))
+    , m_slab_size(slab_size ? slab_size : DEFAULT_SLAB_SIZE)
+    , m_slabs()
+    , m_free(nullptr)
+    , m_capacity(0)
+    , m_in_use(0)
+    , m_high_water(0)
+    , m_reused(0)
+    , m_mutex()
+{
+    if (capacity)
+        add_slab_(capacity);
+}
+
+void OrderPool::add_slab_(std::size_t blocks)
+{
+    std::unique_ptr<std::uint8_t[]> slab(new std::uint8_t[blocks * m_block_size]);
+    // thread the new blocks onto the free list in address order:
+    for (std::size_t i = blocks; i-- > 0; ) {
+        auto *b = reinterpret_cast<FreeBlock *>(slab.get() + i * m_block_size);
+        b->next = m_free;
+        m_free = b;
+    }
+    m_slabs.push_back(std::move(slab));
+    m_capacity += blocks;
+}
+
+void * OrderPool::allocate()
+{
+    OrderPoolMutex::scoped_lock lock(m_mutex);
+    if (UNLIKELY(nullptr == m_free)) {
+        add_slab_(m_slab_size);
+    } else if (m_in_use < m_high_water) {
+        // released blocks sit above any never used on the free list:
+        ++m_reused;
+    }
+    FreeBlock *b = m_free;
+    m_free = b->next;
+    if (++m_in_use > m_high_water)
+        m_high_water = m_in_use;
+    return b;
+}
+
+void OrderPool::deallocate(void *p)
+{
+    if (UNLIKELY(nullptr == p))
+        return;
+    OrderPoolMutex::scoped_lock lock(m_mutex);
+    auto *b = static_cast<FreeBlock *>(p);
+    b->next = m_free;
+    m_free = b;
+    --m_in_use;
+}
+
+OrderPool::Stats OrderPool::stats() const
+{
+    OrderPoolMutex::scoped_lock lock(m_mutex);
+    return Stats{m_name, m_block_size, m_capacity, m_in_use, m_high_water, m_slabs.size(), m_reused};
+}
+
+void LocalIDTable::reserve(std::size_t n)
+{
+    const std::size_t chunks = (n + CHUNK_SIZE - 1) >> CHUNK_BITS;
+    if (chunks > MAX_CHUNKS)
+        throw std::length_error("LocalIDTable: too many local IDs");
+    for (; m_num_chunks < chunks; ++m_num_chunks)
+        m_chunks[m_num_chunks].reset(new Order *[CHUNK_SIZE]());
+}
+
+void LocalIDTable::resize(std::size_t n)
+{
+    reserve(n);
+    for (std::size_t i = n; i < m_size; ++i)
+        (*this)[static_cast<LocalID>(i)] = nullptr;
+    m_size = n;
+}
+
+}}
@@ -1,6 +1,7 @@
 #include <stdexcept>
 
 #include <i01_core/Config.hpp>
+#include <i01_oe/OrderManager.hpp>
 #include <i01_oe/OrderSession.hpp>
 #include <i01_oe/L2SimSession.hpp>
 #include "NASDAQ/OUCH42Session.hpp"
@@ -57,6 +58,11 @@ Order* OrderSession::get_order(LocalID id)
     return nullptr;
 }
 
+void OrderSession::release_order(Order* op)
+{
+    m_order_manager_p->on_session_released(op);
+}
+
 OrderSessionPtr OrderSession::factory(OrderManager* omp, const std::string& n, const std::string& t)
 {
     OrderSessionPtr osp;
@@ -0,0 +1,48 @@
+#include <ostream>
+
+#include <i01_oe/SendStageStats.hpp>
+
+namespace i01 { namespace OE {
+
+const std::size_t SendStageStats::NUM_STAGES;
+
+const char * SendStageStats::name(Stage s)
+{
+    switch (s) {
+    case Stage::LOCK:
+        return "LOCK";
+    case Stage::VALIDATE:
+        return "VALIDATE";
+    case Stage::FIRM_RISK:
+        return "FIRM_RISK";
+    case Stage::PORTFOLIO_RISK:
+        return "PORTFOLIO_RISK";
+    case Stage::SESSION_RISK:
+        return "SESSION_RISK";
+    case Stage::INSTRUMENT:
+        return "INSTRUMENT";
+    case Stage::SESSION_SEND:
+        return "SESSION_SEND";
+    case Stage::BLOTTER:
+        return "BLOTTER";
+    default:
+        return "UNKNOWN";
+    }
+}
+
+std::ostream & operator<<(std::ostream &os, const SendStageStats &s)
+{
+    os << "sends," << s.sends;
+    for (std::size_t i = 0; i < SendStageStats::NUM_STAGES; ++i) {
+        const auto& c = s.stages[i];
+        if (0 == c.count)
+            continue;
+        os << "\n" << SendStageStats::name(static_cast<SendStageStats::Stage>(i))
+           << ",count," << c.count
+           << ",mean_cycles," << c.cycles / c.count
+           << ",max_cycles," << c.max_cycles;
+    }
+    return os;
+}
+
+}}
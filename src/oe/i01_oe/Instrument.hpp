@@ -11,6 +11,7 @@
 
 #include <i01_oe/Types.hpp>
 #include <i01_oe/Position.hpp>
+#include <i01_oe/Threading.hpp>
 
 namespace i01 { namespace OE {
 
@@ -19,7 +20,7 @@ class Order;
 class Instrument
 {
 public:
-    typedef core::RecursiveMutex mutex_type;
+    typedef Threading::RecursiveMutex mutex_type;
 
     struct Params {
         Quantity start_quantity;
@@ -7,6 +7,7 @@
 
 #include <i01_md/BookMuxListener.hpp>
 #include <i01_md/MLBookMux.hpp>
+#include <i01_md/OrderStore.hpp>
 
 #include <i01_md/NASDAQ/ITCH50/Messages.hpp>
 
@@ -17,6 +18,9 @@ namespace i01 { namespace OE {
 
 class L2SimSession : public SimSession, public MD::NoopBookMuxListener {
 public:
+    static const std::size_t DEFAULT_MAX_OPEN_ORDERS = 65536;
+    static const std::size_t DEFAULT_MAX_EXECUTIONS_PER_PACKET = 4096;
+
     L2SimSession(OrderManager *om_p, const std::string& name_);
     virtual ~L2SimSession() = default;
 
@@ -90,7 +94,9 @@ private:
 
     using EventQueue = std::priority_queue<TimestampedSimEvent, std::vector<TimestampedSimEvent>, TSECompare>;
 
-    using OrderMap = std::unordered_map<ExchangeID, Order *>;
+    /// Preallocated, sized from the session config, so a day of sim
+    //  orders and market data executions does not allocate.
+    using OrderMap = MD::OrderRefIndex<Order *, ExchangeID>;
 
     using AskOrderContainer = std::map<Price, SimOrder>;
     using BidOrderContainer = std::map<Price, SimOrder, std::greater<Price> > ;
@@ -98,7 +104,7 @@ private:
     using BookIndexMap = std::unordered_map<std::string, MD::EphemeralSymbolIndex>;
     using TradeRefNumContainer = std::unordered_set<MD::TradeEvent::TradeRefNum>;
 
-    using OrderRefNumSizeMap = std::unordered_map<MD::OrderBook::Order::RefNum, MD::OrderBook::Order::Size>;
+    using OrderRefNumSizeMap = MD::OrderRefIndex<MD::OrderBook::Order::Size, MD::OrderBook::Order::RefNum>;
 
     struct BookEntry {
         const MD::BookBase * book_p;
@@ -213,8 +219,14 @@ protected:
 
     virtual bool send(Order *o_p) override;
     virtual bool cancel(Order *o_p, Size newqty = 0) override;
+    /// Every event, book entry and m_orders entry holds its order.
+    virtual bool releases_orders() const override { return true; }
 
     void update_ts(const Timestamp &ts);
+    void schedule_(const SimEvent::Ordering &when, const SimEvent &evt) {
+        hold_order(evt.order_p);
+        m_eventq.emplace(when, evt);
+    }
 
     BookEntry * find_book_entry(const MD::BookBase & book);
 
@@ -260,6 +272,9 @@ private:
     Timestamp m_ts;
     EventQueue m_eventq;
     OrderMap m_orders;
+    /// Orders sent and not yet in m_orders.
+    std::size_t m_num_sending;
+    std::uint64_t m_store_full_rejects;
 
     BooksContainer m_books;
     BookIndexMap m_index_map;
@@ -338,8 +353,10 @@ Size L2SimSession::reduce_helper(CT &cont, const KeyT & k, Order *v, Size newqty
     auto it = cont.find(k);
     if (it != cont.end() && it->second.order_p == v) {
         if (newqty == 0 || it->second.remains == newqty) {
+            const auto remains = it->second.remains;
             cont.erase(it);
-            return it->second.remains;
+            drop_order(v);
+            return remains;
         } else if (newqty < it->second.remains) {
             it->second.remains -= newqty;
             return newqty;
@@ -365,11 +382,13 @@ const Timestamp &ts)
         if (avail_size) {
             // then we can generate a trade for this order
             auto fill_size = std::min(simo.remains, avail_size);
-            m_eventq.emplace(ts+m_ack_latency, SimEvent(OrderState::FILLED, simo.order_p, idx, fill_size, check_price.ref));
+            schedule_(ts+m_ack_latency, SimEvent(OrderState::FILLED, simo.order_p, idx, fill_size, check_price.ref));
             simo.remains -= fill_size;
 
             if (!simo.remains) {
+                auto * op = simo.order_p;
                 it = orders.erase(it);
+                drop_order(op);
             }
         } else {
             ++it;
@@ -484,16 +503,18 @@ int L2SimSession::cross_helper(ContainerT& orders, MD::EphemeralSymbolIndex esi,
                 fill_size = std::min(simo.remains, avail_size.get(simo.order_p));
                 avail_size.remove(simo.order_p, fill_size);
                 shares_crossed += fill_size;
-                m_eventq.emplace(ts+m_ack_latency, SimEvent(OrderState::FILLED, simo.order_p, esi, fill_size, check_price.ref));
+                schedule_(ts+m_ack_latency, SimEvent(OrderState::FILLED, simo.order_p, esi, fill_size, check_price.ref));
                 simo.remains -= fill_size;
             }
 
             if (!simo.remains) {
                 // if we have nothing remaining, we need to erase this order
+                auto * op = simo.order_p;
                 it = orders.erase(it);
+                drop_order(op);
             } else {
                 if (cxl_remainder) {
-                    m_eventq.emplace(ts+m_ack_latency, SimEvent(OrderState::CANCELLED, simo.order_p, esi, open_size - fill_size, 0, ts));
+                    schedule_(ts+m_ack_latency, SimEvent(OrderState::CANCELLED, simo.order_p, esi, open_size - fill_size, 0, ts));
                 }
 
                 ++it;
@@ -502,9 +523,9 @@ int L2SimSession::cross_helper(ContainerT& orders, MD::EphemeralSymbolIndex esi,
             // then this trade price is not of interest to us, so any
             // worse priced orders will also not get filled...
             if (cxl_remainder) {
-                    m_eventq.emplace(ts+m_ack_latency, SimEvent(OrderState::CANCELLED,
-                                                                simo.order_p, esi,
-                                                                open_size, 0, ts));
+                    schedule_(ts+m_ack_latency, SimEvent(OrderState::CANCELLED,
+                                                         simo.order_p, esi,
+                                                         open_size, 0, ts));
             }
 
             // we continue iterating because we could have differences
@@ -7,11 +7,13 @@
 #include <i01_oe/Instrument.hpp>
 #include <i01_oe/Types.hpp>
 #include <i01_oe/OrderListener.hpp>
+#include <i01_oe/Threading.hpp>
 
 namespace i01 { namespace OE {
 
     class Instrument;
     class OrderManager;
+    class OrderPool;
     class OrderSession;
     namespace BATS { class BOE20Session; }
     namespace NASDAQ { class OUCH42Session; }
@@ -188,7 +190,7 @@ namespace i01 { namespace OE {
         /// \internal Validates the base Order portion of the order.
         bool validate_base() const;
 
-        typedef i01::core::RecursiveMutex OrderMutex;
+        typedef Threading::RecursiveMutex OrderMutex;
 
         OrderMutex& mutex() const { return m_mutex; }
 
@@ -246,6 +248,7 @@ namespace i01 { namespace OE {
 
         friend class OrderSession;
         friend class OrderManager;
+        friend class GatewayClient;
         friend class EquityInstrument;
         friend class FileBlotter;
         friend class OrderIdentifier;
@@ -253,6 +256,16 @@ namespace i01 { namespace OE {
         friend class BATS::BOE20Session;
 
         mutable OrderMutex m_mutex;
+
+        /// The pool the order was created in, nullptr if it came from new.
+        OrderPool*          m_pool_p;
+        /// Set once OrderManager has forgotten the terminal order, to be
+        /// reused when its session releases it.
+        bool                m_retired;
+        /// Set once the session holds no pointer to the order.
+        bool                m_session_released;
+        /// References the session counts with OrderSession::hold_order.
+        std::uint32_t       m_session_refs;
     };
 
 } }
@@ -0,0 +1,216 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+#include <i01_core/MPSCRing.hpp>
+#include <i01_core/NamedThread.hpp>
+#include <i01_core/SPSCRing.hpp>
+
+#include <i01_oe/OrderListener.hpp>
+#include <i01_oe/Types.hpp>
+
+namespace i01 { namespace OE {
+
+class Order;
+class OrderGateway;
+class OrderManager;
+class OrderSession;
+
+/// A new order or a cancel on its way to a session's gateway thread.  New
+/// orders have already passed OrderManager::prepare_send.
+struct OrderIntent {
+    enum class Kind : std::uint8_t {
+        NEW = 0
+      , CANCEL
+    };
+
+    Order* order_p;
+    Size newqty;
+    std::uint32_t client;
+    Kind kind;
+};
+
+/// A response to one of a client's orders on its way back to the client's
+/// thread.
+struct OrderEvent {
+    enum class Kind : std::uint8_t {
+        ACKNOWLEDGED = 0
+      , FILL
+      , CANCEL
+      , CANCEL_REJECTED
+      , CANCEL_REPLACED
+      , REJECTED
+    };
+
+    const Order* order_p;
+    Size size;
+    Price price;
+    Dollars fee;
+    Kind kind;
+};
+
+/// One strategy's end of an OrderGateway.  The strategy creates its orders
+/// with the client as their listener, and calls send, cancel and poll from
+/// its own thread only; poll passes each response to the strategy's real
+/// listener on that thread.
+///
+/// A local reject by the gateway thread arrives as on_order_rejected, with
+/// the order LOCALLY_REJECTED, and a cancel that the OrderManager would not
+/// send arrives as on_order_cancel_rejected.  Orders sent through a client
+/// are not released for reuse: the client holds them until polled.
+///
+/// A response that finds the client's ring still full after
+/// oe.gateway.full_wait_us is dropped and counted in dropped(): the
+/// strategy must poll often enough, and treat a non-zero count as lost
+/// track of its orders.
+class GatewayClient
+    : public OrderListener
+    , private boost::noncopyable {
+public:
+    /// Checks the order on this thread and queues it for its session's
+    /// gateway thread.  False if the order was rejected locally, by the
+    /// checks or because the session's queue is full.
+    bool send(Order* order_p, OrderSession* session_p);
+    /// Queues a cancel, or a partial cancel if newqty > 0.  The order's
+    /// state is not checked here: a cancel of a terminal order comes back
+    /// as on_order_cancel_rejected.
+    bool cancel(const Order* order_p, Size newqty = 0);
+    /// Delivers up to max responses to the listener; returns how many.
+    std::size_t poll(std::size_t max = SIZE_MAX);
+
+    OrderListener* listener() const { return m_listener_p; }
+    std::uint32_t index() const { return m_index; }
+    /// Responses dropped because the client did not poll in time.
+    std::uint64_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    // OrderListener, called on the threads that deliver each session's
+    // responses:
+    virtual void on_order_acknowledged(const Order*) override final;
+    virtual void on_order_fill(const Order*, const Size, const Price, const Dollars fee) override final;
+    virtual void on_order_cancel(const Order*, const Size) override final;
+    virtual void on_order_cancel_rejected(const Order*) override final;
+    virtual void on_order_cancel_replaced(const Order*) override final;
+    virtual void on_order_rejected(const Order*) override final;
+
+private:
+    /// Acks and fills may come from any thread: the session's, the gateway
+    /// thread's own OrderManager calls, and the market data threads of the
+    /// simulated sessions.
+    typedef core::MPSCRing<OrderEvent> ResponseRing;
+    /// Local rejects come only from the session's gateway thread.
+    typedef core::SPSCRing<OrderEvent> LocalRing;
+
+    GatewayClient(OrderGateway& gw, std::uint32_t index, OrderListener* listener_p, std::size_t sessions, std::size_t ring_size);
+
+    void respond(const Order* order_p, OrderEvent::Kind kind, Size size = 0, Price price = 0, Dollars fee = 0);
+    /// From the gateway thread of the session at lane.
+    void local(std::size_t lane, const Order* order_p, OrderEvent::Kind kind);
+    template<typename Ring>
+    void push(Ring& ring, const OrderEvent& ev);
+    void dispatch(const OrderEvent& ev);
+
+private:
+    OrderGateway& m_gateway;
+    const std::uint32_t m_index;
+    OrderListener* m_listener_p;
+    /// By session: responses from whichever thread delivers them, and
+    /// local rejects from the session's gateway thread.
+    std::vector<std::unique_ptr<ResponseRing>> m_responses;
+    std::vector<std::unique_ptr<LocalRing>> m_local;
+    std::atomic<std::uint64_t> m_dropped;
+
+    friend class OrderGateway;
+};
+
+/// Order gateway mode: each OrderSession added gets its own thread, named
+/// <session>_gw and pinned by threads.<session>_gw.cpu_affinity like any
+/// NamedThread, that is the only one to call its send and cancel.
+/// Strategies hand it orders through an MPSC queue of intents, already
+/// checked and risk counted on the strategy's thread, and get the
+/// responses back on their own thread through a GatewayClient.
+///
+/// Sessions are added before clients, and both before start().  Not for a
+/// single threaded build, which has no locks between these threads.  The
+/// engine runs in this mode when oe.gateway.enabled is true: the
+/// OrderManager then owns the gateway and adds and starts its sessions.
+///
+/// Configured by oe.gateway.intent_queue_size, per session,
+/// oe.gateway.event_ring_size, per client and session, and
+/// oe.gateway.full_wait_us, how long a response waits for room in a full
+/// ring before it is dropped.  An idle session
+/// thread spins unless oe.gateway.spin is false, when it yields instead:
+/// for threads that are not pinned to a core of their own.
+class OrderGateway : private boost::noncopyable {
+public:
+    static const std::size_t DEFAULT_INTENT_QUEUE_SIZE = 4096;
+    static const std::size_t DEFAULT_EVENT_RING_SIZE = 4096;
+    static const std::uint64_t DEFAULT_FULL_WAIT_US = 10000;
+    static const std::size_t NO_LANE = SIZE_MAX;
+
+public:
+    explicit OrderGateway(OrderManager& om);
+    ~OrderGateway();
+
+    void add_session(OrderSession* session_p);
+    GatewayClient* add_client(OrderListener* listener_p);
+
+    /// Spawns the session threads.
+    bool start();
+    /// Stops the session threads; intents still queued are rejected
+    /// locally.
+    void stop();
+    bool running() const { return m_running; }
+
+    OrderManager& order_manager() const { return m_om; }
+    /// The index of a session, or NO_LANE.
+    std::size_t lane(const OrderSession* session_p) const {
+        for (std::size_t i = 0; i < m_lanes.size(); ++i) {
+            if (m_lanes[i]->session_p == session_p)
+                return i;
+        }
+        return NO_LANE;
+    }
+
+private:
+    typedef core::MPSCRing<OrderIntent> IntentQueue;
+
+    class SessionThread : public core::NamedThread<SessionThread> {
+    public:
+        SessionThread(OrderGateway& gw, std::size_t lane, OrderSession* session_p, std::size_t queue_size);
+
+        virtual void * process() override final;
+        virtual void post_process() override final;
+
+        OrderSession* const session_p;
+        IntentQueue intents;
+
+    private:
+        void handle(const OrderIntent& in, bool transmit);
+
+        OrderGateway& m_gateway;
+        const std::size_t m_lane;
+    };
+
+    bool queue(std::size_t lane, const OrderIntent& in) { return m_lanes[lane]->intents.try_push(in); }
+
+private:
+    OrderManager& m_om;
+    std::size_t m_intent_queue_size;
+    std::size_t m_event_ring_size;
+    std::uint64_t m_full_wait_ns;
+    bool m_spin;
+    std::vector<std::unique_ptr<SessionThread>> m_lanes;
+    std::vector<std::unique_ptr<GatewayClient>> m_clients;
+    bool m_running;
+
+    friend class GatewayClient;
+};
+
+}}
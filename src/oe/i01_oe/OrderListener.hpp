@@ -18,6 +18,13 @@ public:
   virtual void on_order_cancel_rejected(const Order*) {}
   virtual void on_order_cancel_replaced(const Order*) {}
   virtual void on_order_rejected(const Order*) {}
+
+  /// Return true to let the OrderManager take this listener's orders back
+  /// for reuse once they are filled, cancelled or rejected, and their
+  /// session has released them (see OrderSession::releases_orders).  The
+  /// pointer must then not be kept past the on_order_* call that made the
+  /// order terminal.
+  virtual bool release_terminal_orders() const { return false; }
 };
 
 }}
@@ -1,10 +1,15 @@
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <cstdint>
 #include <functional>
+#include <memory>
+#include <new>
 #include <vector>
 #include <map>
 #include <type_traits>
+#include <typeinfo>
 
 #include <boost/noncopyable.hpp>
 
@@ -18,7 +23,10 @@
 #include <i01_oe/BlotterReader.hpp>
 #include <i01_oe/BlotterReaderListener.hpp>
 #include <i01_oe/EqInstUniverse.hpp>
+#include <i01_oe/OrderPool.hpp>
 #include <i01_oe/OrderSessionPtr.hpp>
+#include <i01_oe/SendStageStats.hpp>
+#include <i01_oe/Threading.hpp>
 #include <i01_oe/TradingFees.hpp>
 #include <i01_oe/Types.hpp>
 
@@ -36,6 +44,7 @@ class DataManager;
 namespace i01 { namespace OE {
 
 class Order;
+class OrderGateway;
 class OrderListener;
 class OrderSession;
 
@@ -55,16 +64,45 @@ class OrderSession;
 
         void start(const bool replay = false);
 
+        /// The order gateway when oe.gateway.enabled is set, else
+        /// nullptr.  Every session added gets its gateway thread, spawned
+        /// by start(); strategies get their GatewayClients from it before
+        /// then, see TS::Strategy::gateway_client.
+        OrderGateway* gateway() const { return m_gateway.get(); }
+
         OrderListener* default_listener() const { return m_default_listener_p; }
         void default_listener(OrderListener* l) { m_default_listener_p = l; }
 
-        /// Creates an order of type T, e.g. NYSEOrder.
+        /// Creates an order of type T, e.g. NYSEOrder, in T's order pool.
         template <typename T, typename... Args>
         T* create_order(Args&&... args);
 
+        /// Creates T's order pool now rather than on the first
+        /// create_order<T>, sized from oe.order_pool.<T>.capacity.
+        template <typename T>
+        void reserve_orders();
+
+        std::vector<OrderPoolStats> order_pool_stats() const;
+
         /// Sends an order through the session.
         bool send(Order* order_p, OrderSession* session);
 
+        /// send() in two halves, for an OrderGateway.  prepare_send
+        /// assigns the local ID, runs the order, risk and instrument
+        /// checks and takes the order's risk, or rejects it locally.
+        /// complete_send, once per prepared order and typically on
+        /// another thread, hands it to its session, or with transmit false
+        /// gives back its risk and rejects it locally.
+        bool prepare_send(Order* order_p, OrderSession* session);
+        bool complete_send(Order* order_p, bool transmit = true);
+
+        /// Times each stage of send() with rdtscp while on; off unless
+        /// oe.send_stage_timing is set.
+        void send_stage_timing(bool on) { m_send_stage_timing = on; }
+        bool send_stage_timing() const { return m_send_stage_timing; }
+        SendStageStats send_stage_stats() const;
+        void reset_send_stage_stats();
+
         /// Cancels an order, partially cancels if newqty > 0.
         bool cancel(const Order* order_p, Size newqty = 0);
 
@@ -205,12 +243,47 @@ class OrderSession;
 
         OrderPtrContainer unsafe_order_filter(const OrderFilterFunc& f) const;
 
+        /// \internal Ends a stage of send() if it is being timed, and
+        /// passes ok through so that the checks still short circuit.
+        static bool send_stage(SendStageStats::Sample* sample_p, SendStageStats::Stage s, bool ok = true) {
+            if (UNLIKELY(sample_p != nullptr))
+                sample_p->lap(s);
+            return ok;
+        }
+        void add_send_stage_sample(const SendStageStats::Sample& sample);
+
+        /// \internal The parts of send(); the caller holds the order's
+        /// lock, and for all but assign_local_id its instrument's too.
+        void assign_local_id(Order* order_p);
+        bool send_checks(Order* order_p, OrderSession* session_p, SendStageStats::Sample* sample_p);
+        bool send_to_session(Order* order_p, OrderSession* session_p, SendStageStats::Sample* sample_p);
+        void local_reject(Order* order_p);
+
+        template <typename T>
+        OrderPool* order_pool();
+        static std::size_t next_order_pool_index();
+        OrderPool* make_order_pool(std::size_t index, std::size_t block_size, const std::type_info& type);
+
+        /// \internal Takes a terminal order back if its listener lets it be
+        /// reused and its session releases_orders().  It is forgotten at
+        /// once, but only destroyed once the session has released it too.
+        void retire(Order* order_p, OrderListener* listener_p);
+        /// \internal From OrderSession::release_order: destroys the order
+        /// if it has been retired, else marks it so that it never will be.
+        void on_session_released(Order* order_p);
+        /// \internal Destroys an order and frees its storage.
+        static void dispose(Order* order_p);
+
     private:
-        typedef i01::core::SpinMutex OrderManagerMutex;
-        typedef std::vector<Order*> OrderVecT;
+        typedef Threading::Mutex OrderManagerMutex;
+        typedef LocalIDTable OrderVecT;
         typedef std::map<std::string, OrderSessionPtr> OrderSessionMapT;
         using LastSaleArray = std::array<MD::LastSale, MD::NUM_SYMBOL_INDEX>;
 
+        static const std::size_t MAX_ORDER_POOLS = 32;
+        static const std::size_t DEFAULT_ORDER_POOL_CAPACITY = 16384;
+        static const std::size_t DEFAULT_LOCAL_ID_CAPACITY = 1 << 20;
+
         LocalID               m_localID;
         FirmRiskCheck         m_firm_risk;
         PortfolioRiskCheck    m_portfolio_risk;
@@ -231,6 +304,15 @@ class OrderSession;
         Blotter*              m_blotter_p;
         BlotterReader*        m_blotter_reader_p;
 
+        core::ConfigStateSharedPtr                           m_order_pool_cfg;
+        std::array<std::unique_ptr<OrderPool>, MAX_ORDER_POOLS> m_order_pools;
+        std::array<std::atomic<OrderPool*>, MAX_ORDER_POOLS> m_order_pool_ptrs;
+
+        bool                  m_send_stage_timing;
+        SendStageStats        m_send_stage_stats;
+
+        std::unique_ptr<OrderGateway> m_gateway;
+
         friend OrderSession;
     };
 
@@ -240,8 +322,41 @@ class OrderSession;
         static_assert(std::is_base_of<Order, T>::value,
             "OrderManager::create_order return type must inherit from Order.");
 
-        // TODO: replace with placement new with memory_pool for storage
-        return new T(std::forward<Args>(args)...);
+        OrderPool* pool = order_pool<T>();
+        if (UNLIKELY(!pool))
+            return new T(std::forward<Args>(args)...);
+
+        void* p = pool->allocate();
+        T* op;
+        try {
+            op = new (p) T(std::forward<Args>(args)...);
+        } catch (...) {
+            pool->deallocate(p);
+            throw;
+        }
+        op->m_pool_p = pool;
+        return op;
+    }
+
+    template <typename T>
+    void OrderManager::reserve_orders()
+    {
+        static_assert(std::is_base_of<Order, T>::value,
+            "OrderManager::reserve_orders type must inherit from Order.");
+        order_pool<T>();
+    }
+
+    template <typename T>
+    OrderPool* OrderManager::order_pool()
+    {
+        // each order type gets its own slot the first time it is used:
+        static const std::size_t index = next_order_pool_index();
+        if (UNLIKELY(index >= MAX_ORDER_POOLS))
+            return nullptr;
+        OrderPool* pool = m_order_pool_ptrs[index].load(std::memory_order_acquire);
+        if (LIKELY(pool != nullptr))
+            return pool;
+        return make_order_pool(index, sizeof(T), typeid(T));
     }
 
 }}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+#include <i01_core/Lock.hpp>
+#include <i01_core/macro.hpp>
+
+#include <i01_oe/Threading.hpp>
+#include <i01_oe/Types.hpp>
+
+namespace i01 { namespace OE {
+
+class Order;
+
+struct OrderPoolStats {
+    std::string name;
+    std::size_t block_size;
+    /// Blocks allocated, in use or free.
+    std::size_t capacity;
+    std::size_t in_use;
+    /// The most in use at once.
+    std::size_t high_water;
+    std::size_t slabs;
+    /// Blocks handed out again after being released.
+    std::uint64_t reused;
+};
+
+/// Fixed size blocks for the orders of one type, carved from slabs that
+/// are never freed or moved until the pool is destroyed.  Released blocks
+/// go on an intrusive free list and are handed out again before any new
+/// slab is allocated, so a pool sized for the day's peak of live orders
+/// never allocates after construction.
+class OrderPool : private boost::noncopyable {
+public:
+    using Stats = OrderPoolStats;
+
+    static const std::size_t DEFAULT_SLAB_SIZE = 4096;
+
+public:
+    /// Preallocates capacity blocks of at least block_size bytes; more are
+    /// added slab_size at a time once they are all in use.
+    OrderPool(const std::string &name, std::size_t block_size, std::size_t capacity, std::size_t slab_size = DEFAULT_SLAB_SIZE);
+
+    void * allocate();
+    void deallocate(void *p);
+
+    const std::string & name() const { return m_name; }
+    std::size_t block_size() const { return m_block_size; }
+    Stats stats() const;
+
+private:
+    struct FreeBlock {
+        FreeBlock *next;
+    };
+
+    void add_slab_(std::size_t blocks);
+
+private:
+    typedef Threading::Mutex OrderPoolMutex;
+
+    const std::string m_name;
+    const std::size_t m_block_size;
+    const std::size_t m_slab_size;
+    std::vector<std::unique_ptr<std::uint8_t[]>> m_slabs;
+    FreeBlock *m_free;
+    std::size_t m_capacity;
+    std::size_t m_in_use;
+    std::size_t m_high_water;
+    std::uint64_t m_reused;
+
+    mutable OrderPoolMutex m_mutex;
+};
+
+/// Order pointers by LocalID, in fixed size chunks that never move.  The
+/// table grows a chunk at a time without copying what is already there,
+/// and reserve() allocates every chunk the day needs up front so that
+/// push_back() on the send path only stores a pointer.  Lookups do not
+/// need the lock that serializes growth.
+class LocalIDTable : private boost::noncopyable {
+public:
+    static const unsigned CHUNK_BITS = 16;
+    static const std::size_t CHUNK_SIZE = std::size_t(1) << CHUNK_BITS;
+    static const std::size_t MAX_CHUNKS = 4096;
+
+public:
+    LocalIDTable() : m_size(0), m_num_chunks(0) {}
+
+    std::size_t size() const { return m_size; }
+    bool empty() const { return 0 == m_size; }
+    std::size_t capacity() const { return m_num_chunks * CHUNK_SIZE; }
+
+    Order *& operator[](LocalID id) { return m_chunks[id >> CHUNK_BITS][id & (CHUNK_SIZE - 1)]; }
+    Order * operator[](LocalID id) const { return m_chunks[id >> CHUNK_BITS][id & (CHUNK_SIZE - 1)]; }
+
+    /// Allocates the chunks for n entries; throws std::length_error past
+    /// MAX_CHUNKS * CHUNK_SIZE.
+    void reserve(std::size_t n);
+
+    void push_back(Order *op) {
+        if (UNLIKELY(m_size == capacity()))
+            reserve(m_size + 1);
+        (*this)[static_cast<LocalID>(m_size++)] = op;
+    }
+
+    /// New entries are nullptr.
+    void resize(std::size_t n);
+
+private:
+    std::size_t m_size;
+    std::size_t m_num_chunks;
+    std::array<std::unique_ptr<Order *[]>, MAX_CHUNKS> m_chunks;
+};
+
+}}
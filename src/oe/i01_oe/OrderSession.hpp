@@ -62,6 +62,20 @@ namespace i01 { namespace OE {
         virtual bool destroy(Order* I01_UNUSED order_p)
         { return false; }
 
+        /// Sessions that return true call release_order() on every order
+        /// sent through them once they keep no pointer to it; only their
+        /// orders are ever reused by the OrderManager, and only after the
+        /// release.
+        virtual bool releases_orders() const { return false; }
+        /// The session is done with order_p and will not touch it again.
+        /// Not from inside an OrderManager call on order_p: a terminal
+        /// order may be destroyed here.
+        void release_order(Order *op);
+        /// For sessions that keep an order in several places: each place
+        /// holds it, and dropping the last hold releases it.
+        void hold_order(Order *op) { ++op->m_session_refs; }
+        void drop_order(Order *op) { if (0 == --op->m_session_refs) release_order(op); }
+
         void set_order_sent_time(Order *op, const Timestamp&ts) { op->sent_time(ts); }
         void set_order_last_request_time(Order *op, const Timestamp& ts) { op->last_request_time(ts); }
 
@@ -7,6 +7,7 @@
 #include <i01_core/Config.hpp>
 #include <i01_core/Lock.hpp>
 #include <i01_md/Symbol.hpp>
+#include <i01_oe/Threading.hpp>
 
 #include "RiskCheck.hpp"
 
@@ -111,7 +112,7 @@ public:
         BreakerBits breakers;
     };
 
-    using Mutex = core::SpinRWMutex;
+    using Mutex = Threading::RWMutex;
 
 public:
     /// Create a new risk check.
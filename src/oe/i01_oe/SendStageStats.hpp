@@ -0,0 +1,82 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+
+#include <i01_core/Time.hpp>
+
+namespace i01 { namespace OE {
+
+/// Where OrderManager::send spends its time, in TSC cycles, while
+/// OrderManager::send_stage_timing is on.
+struct SendStageStats {
+    enum class Stage : std::uint8_t {
+        LOCK = 0        ///< Order, OrderManager and Instrument locks and the local ID.
+      , VALIDATE        ///< Order::validate_base and validate.
+      , FIRM_RISK
+      , PORTFOLIO_RISK
+      , SESSION_RISK
+      , INSTRUMENT      ///< Instrument::validate.
+      , SESSION_SEND    ///< Firm risk open exposure and OrderSession::send.
+      , BLOTTER         ///< Logging the order sent or locally rejected.
+      , NUM_STAGES
+    };
+    static const std::size_t NUM_STAGES = static_cast<std::size_t>(Stage::NUM_STAGES);
+
+    struct Counter {
+        std::uint64_t cycles;
+        std::uint64_t max_cycles;
+        /// Sends that reached this stage.
+        std::uint64_t count;
+    };
+
+    /// The stages of one send, kept on its stack and added to the totals
+    /// at the end so that the send path shares no counters.
+    struct Sample {
+        std::uint64_t tsc;
+        std::uint32_t reached;
+        std::array<std::uint64_t, NUM_STAGES> cycles;
+
+        void start() {
+            reached = 0;
+            tsc = core::rdtscp();
+        }
+        /// Ends a stage at the current TSC.
+        void lap(Stage s) {
+            const auto now = core::rdtscp();
+            const auto i = static_cast<std::size_t>(s);
+            cycles[i] = now - tsc;
+            reached |= 1u << i;
+            tsc = now;
+        }
+    };
+
+    std::array<Counter, NUM_STAGES> stages;
+    std::uint64_t sends;
+
+    SendStageStats() : stages(), sends(0) {}
+
+    const Counter& operator[](Stage s) const { return stages[static_cast<std::size_t>(s)]; }
+
+    void add(const Sample& s) {
+        ++sends;
+        for (std::size_t i = 0; i < NUM_STAGES; ++i) {
+            if (s.reached & (1u << i)) {
+                auto& c = stages[i];
+                c.cycles += s.cycles[i];
+                if (s.cycles[i] > c.max_cycles)
+                    c.max_cycles = s.cycles[i];
+                ++c.count;
+            }
+        }
+    }
+
+    static const char * name(Stage s);
+};
+
+/// One line per stage reached: name, count, mean and max cycles.
+std::ostream & operator<<(std::ostream &os, const SendStageStats &s);
+
+}}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <i01_core/Lock.hpp>
+
+namespace i01 { namespace OE {
+
+/// Lock types for the order path: orders, instruments, the OrderManager,
+/// its order pools, firm risk and the order sessions.
+template <bool SingleThreaded>
+struct ThreadingPolicy {
+    static constexpr bool single_threaded = false;
+    typedef core::SpinMutex       Mutex;
+    typedef core::RecursiveMutex  RecursiveMutex;
+    typedef core::SpinRWMutex     RWMutex;
+};
+
+/// Strategies, the OrderManager, its sessions' sends and receives, and
+/// the market data callbacks that reach risk all run on one thread, so
+/// every lock is a no-op.
+template <>
+struct ThreadingPolicy<true> {
+    static constexpr bool single_threaded = true;
+    typedef core::NullMutex       Mutex;
+    typedef core::NullMutex       RecursiveMutex;
+    typedef core::NullRWMutex     RWMutex;
+};
+
+/// Build with I01_OE_SINGLE_THREADED to declare the engine single
+/// threaded; OrderManager::init() then insists on oe.single_threaded.
+#ifdef I01_OE_SINGLE_THREADED
+using Threading = ThreadingPolicy<true>;
+#else
+using Threading = ThreadingPolicy<false>;
+#endif
+
+}}
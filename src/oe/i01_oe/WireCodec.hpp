@@ -0,0 +1,296 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <type_traits>
+
+#include <i01_core/macro.hpp>
+
+/// Compile-time descriptions of fixed layout binary order entry messages.
+//
+//  A message is a list of fields, each a tag naming it and a wire type
+//  saying how its value is laid out:
+//
+//      namespace F {
+//          I01_WIRE_FIELD(message_type);
+//          I01_WIRE_FIELD(shares);
+//      }
+//      using CancelOrder = Message<
+//          Field<F::message_type, Literal<Integer<MessageType, true>, MessageType::CANCEL>>
+//        , Field<F::shares,       BigEndian<std::uint32_t>> >;
+//
+//  From which Writer<CancelOrder> encodes into a buffer, with every offset a
+//  constant and every set inlined, Reader<CancelOrder> decodes a field at a
+//  time straight from the received bytes, and CancelOrder::print writes the
+//  comma separated values as the venue printers in Messages.cpp do.
+//  CancelOrder::FIELDS is the name, offset and size of each field.
+
+namespace i01 { namespace OE { namespace WireCodec {
+
+namespace detail {
+
+template<std::size_t N> struct Unsigned;
+template<> struct Unsigned<1> { typedef std::uint8_t type; };
+template<> struct Unsigned<2> { typedef std::uint16_t type; };
+template<> struct Unsigned<4> { typedef std::uint32_t type; };
+template<> struct Unsigned<8> { typedef std::uint64_t type; };
+
+I01_ALWAYS_INLINE std::uint8_t bswap(std::uint8_t v) { return v; }
+I01_ALWAYS_INLINE std::uint16_t bswap(std::uint16_t v) { return __builtin_bswap16(v); }
+I01_ALWAYS_INLINE std::uint32_t bswap(std::uint32_t v) { return __builtin_bswap32(v); }
+I01_ALWAYS_INLINE std::uint64_t bswap(std::uint64_t v) { return __builtin_bswap64(v); }
+
+constexpr bool HOST_BIG_ENDIAN = __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__;
+
+constexpr std::size_t sum() { return 0; }
+template<typename... Ns>
+constexpr std::size_t sum(std::size_t n, Ns... ns) { return n + sum(ns...); }
+
+/// Expands a pack for its side effects, in order.
+struct Expand {
+    template<typename... Ts> Expand(Ts&&...) {}
+};
+
+}
+
+/// An integer or enum of sizeof(T) bytes, big or little endian on the wire.
+template<typename T, bool BIG>
+struct Integer {
+    typedef T value_type;
+    typedef typename detail::Unsigned<sizeof(T)>::type raw_type;
+    static constexpr std::size_t SIZE = sizeof(T);
+    static constexpr bool PRINTED = true;
+
+    static I01_ALWAYS_INLINE raw_type to_wire(raw_type r) { return BIG == detail::HOST_BIG_ENDIAN ? r : detail::bswap(r); }
+
+    static I01_ALWAYS_INLINE void encode(std::uint8_t *p, const T v) {
+        const raw_type r = to_wire(static_cast<raw_type>(v));
+        std::memcpy(p, &r, SIZE);
+    }
+    static I01_ALWAYS_INLINE T decode(const std::uint8_t *p) {
+        raw_type r;
+        std::memcpy(&r, p, SIZE);
+        return static_cast<T>(to_wire(r));
+    }
+    static void init(std::uint8_t *p) { std::memset(p, 0, SIZE); }
+    /// One byte enums are mostly the venues' character codes: the printable
+    /// ones print as characters.
+    static std::ostream& print(std::ostream& os, const std::uint8_t *p) {
+        if (std::is_enum<T>::value && SIZE == 1 && *p >= ' ' && *p <= '~')
+            return os << static_cast<char>(*p);
+        return os << +static_cast<typename std::conditional<std::is_signed<T>::value,
+                                            typename std::make_signed<raw_type>::type, raw_type>::type>(
+                                 static_cast<raw_type>(decode(p)));
+    }
+};
+
+template<typename T> using BigEndian = Integer<T, true>;
+template<typename T> using LittleEndian = Integer<T, false>;
+
+/// N characters, left justified and padded with PAD.
+template<std::size_t N, char PAD = ' '>
+struct Alpha {
+    typedef std::array<std::uint8_t, N> value_type;
+    static constexpr std::size_t SIZE = N;
+    static constexpr bool PRINTED = true;
+
+    static I01_ALWAYS_INLINE void encode(std::uint8_t *p, const std::array<std::uint8_t, N>& v) { std::memcpy(p, v.data(), N); }
+    static I01_ALWAYS_INLINE void encode(std::uint8_t *p, const std::array<char, N>& v) { std::memcpy(p, v.data(), N); }
+    static I01_ALWAYS_INLINE void encode(std::uint8_t *p, const char *s) {
+        std::size_t i = 0;
+        for (; i < N && s[i] != '\0'; ++i)
+            p[i] = static_cast<std::uint8_t>(s[i]);
+        std::memset(p + i, PAD, N - i);
+    }
+    static void encode(std::uint8_t *p, const std::string& s) {
+        const std::size_t n = s.size() < N ? s.size() : N;
+        std::memcpy(p, s.data(), n);
+        std::memset(p + n, PAD, N - n);
+    }
+    static I01_ALWAYS_INLINE value_type decode(const std::uint8_t *p) {
+        value_type v;
+        std::memcpy(v.data(), p, N);
+        return v;
+    }
+    static void init(std::uint8_t *p) { std::memset(p, PAD, N); }
+    /// NUL padding is left out.
+    static std::ostream& print(std::ostream& os, const std::uint8_t *p) {
+        for (std::size_t i = 0; i < N; ++i)
+            if (p[i] != '\0')
+                os << static_cast<char>(p[i]);
+        return os;
+    }
+};
+
+/// A price, as an integer count of 1/SCALE, rounded as the sessions do.
+template<typename Int, bool BIG, std::uint64_t SCALE>
+struct Decimal {
+    typedef double value_type;
+    typedef Integer<Int, BIG> wire_type;
+    static constexpr std::size_t SIZE = sizeof(Int);
+    static constexpr bool PRINTED = true;
+
+    static I01_ALWAYS_INLINE void encode(std::uint8_t *p, const double v) { wire_type::encode(p, static_cast<Int>(v * SCALE + 0.5)); }
+    static I01_ALWAYS_INLINE double decode(const std::uint8_t *p) { return static_cast<double>(wire_type::decode(p)) / SCALE; }
+    static void init(std::uint8_t *p) { wire_type::init(p); }
+    static std::ostream& print(std::ostream& os, const std::uint8_t *p) { return os << decode(p); }
+};
+
+/// A field always V, written by init: it has no encode.
+template<typename Wire, typename Wire::value_type V>
+struct Literal {
+    typedef typename Wire::value_type value_type;
+    static constexpr std::size_t SIZE = Wire::SIZE;
+    static constexpr bool PRINTED = true;
+
+    static I01_ALWAYS_INLINE value_type decode(const std::uint8_t *p) { return Wire::decode(p); }
+    static I01_ALWAYS_INLINE void init(std::uint8_t *p) { Wire::encode(p, V); }
+    static std::ostream& print(std::ostream& os, const std::uint8_t *p) { return Wire::print(os, p); }
+};
+
+/// Reserved bytes, set to FILL by init and not printed.
+template<std::size_t N, std::uint8_t FILL = 0>
+struct Filler {
+    static constexpr std::size_t SIZE = N;
+    static constexpr bool PRINTED = false;
+
+    static void init(std::uint8_t *p) { std::memset(p, FILL, N); }
+    static std::ostream& print(std::ostream& os, const std::uint8_t *) { return os; }
+};
+
+/// Declares the tag of a field, a type whose name() is NAME.
+#define I01_WIRE_FIELD(NAME) \
+    struct NAME { static constexpr const char * name() { return #NAME; } }
+
+template<typename Tag, typename Wire>
+struct Field {
+    typedef Tag tag;
+    typedef Wire wire;
+};
+
+struct FieldInfo {
+    const char *name;
+    std::size_t offset;
+    std::size_t size;
+};
+
+namespace detail {
+
+/// The offset and wire type of the field tagged Tag.
+template<typename Tag, typename... Fs> struct Find;
+
+struct NoSuchField;
+
+template<typename Tag>
+struct Find<Tag> {
+    static constexpr bool found = false;
+    static constexpr std::size_t offset = 0;
+    typedef NoSuchField wire;
+};
+
+template<typename Tag, typename F, typename... Fs>
+struct Find<Tag, F, Fs...> {
+    static constexpr bool here = std::is_same<Tag, typename F::tag>::value;
+    typedef Find<Tag, Fs...> next;
+    static constexpr bool found = here || next::found;
+    static constexpr std::size_t offset = here ? 0 : F::wire::SIZE + next::offset;
+    typedef typename std::conditional<here, typename F::wire, typename next::wire>::type wire;
+};
+
+}
+
+template<typename... Fs>
+struct Message {
+    static constexpr std::size_t NUM_FIELDS = sizeof...(Fs);
+    static constexpr std::size_t SIZE = detail::sum(Fs::wire::SIZE...);
+    static constexpr FieldInfo FIELDS[sizeof...(Fs)] = {
+        {Fs::tag::name(), detail::Find<typename Fs::tag, Fs...>::offset, Fs::wire::SIZE}...
+    };
+
+    template<typename Tag>
+    using wire = typename detail::Find<Tag, Fs...>::wire;
+
+    template<typename Tag>
+    static constexpr std::size_t offset() {
+        static_assert(detail::Find<Tag, Fs...>::found, "WireCodec: no such field in the message.");
+        return detail::Find<Tag, Fs...>::offset;
+    }
+
+    /// Writes every literal and filler, pads the alphas and zeroes the rest.
+    static void init(std::uint8_t *p) {
+        detail::Expand{(Fs::wire::init(p + offset<typename Fs::tag>()), 0)...};
+    }
+
+    static std::ostream& print(std::ostream& os, const std::uint8_t *p) {
+        bool first = true;
+        detail::Expand{(print_field<Fs>(os, p, first), 0)...};
+        return os;
+    }
+
+private:
+    template<typename F>
+    static void print_field(std::ostream& os, const std::uint8_t *p, bool& first) {
+        if (!F::wire::PRINTED)
+            return;
+        if (!first)
+            os << ",";
+        first = false;
+        F::wire::print(os, p + offset<typename F::tag>());
+    }
+};
+
+template<typename... Fs> constexpr std::size_t Message<Fs...>::NUM_FIELDS;
+template<typename... Fs> constexpr std::size_t Message<Fs...>::SIZE;
+template<typename... Fs> constexpr FieldInfo Message<Fs...>::FIELDS[sizeof...(Fs)];
+
+/// Encodes Msg into a buffer of at least Msg::SIZE bytes.
+template<typename Msg>
+class Writer {
+public:
+    explicit Writer(std::uint8_t *p) : m_p(p) {}
+
+    void init() const { Msg::init(m_p); }
+
+    template<typename Tag, typename V>
+    I01_ALWAYS_INLINE void set(const V& v) const {
+        Msg::template wire<Tag>::encode(m_p + Msg::template offset<Tag>(), v);
+    }
+
+    std::uint8_t * data() const { return m_p; }
+
+private:
+    std::uint8_t *m_p;
+};
+
+/// Decodes Msg in place: each get reads only the bytes of its field.
+template<typename Msg>
+class Reader {
+public:
+    explicit Reader(const std::uint8_t *p) : m_p(p) {}
+
+    template<typename Tag>
+    I01_ALWAYS_INLINE typename Msg::template wire<Tag>::value_type get() const {
+        return Msg::template wire<Tag>::decode(m_p + Msg::template offset<Tag>());
+    }
+
+    /// The bytes of the field, for one too wide to copy out.
+    template<typename Tag>
+    const std::uint8_t * at() const { return m_p + Msg::template offset<Tag>(); }
+
+    const std::uint8_t * data() const { return m_p; }
+
+private:
+    const std::uint8_t *m_p;
+};
+
+template<typename Msg>
+std::ostream& operator<<(std::ostream& os, const Reader<Msg>& r)
+{
+    return Msg::print(os, r.data());
+}
+
+} } }
@@ -893,6 +893,11 @@ void ManualStrategy::do_list_orders_command(const core::MIC& mic, bool show_term
 void ManualStrategy::do_status_command()
 {
     std::cout << m_om_p->status() << std::endl;
+    if (m_dm_p) {
+        const auto md_status = m_dm_p->status();
+        if (!md_status.empty())
+            std::cout << md_status << std::endl;
+    }
 }
 
 void ManualStrategy::do_cancel_all_command()
@@ -25,6 +25,8 @@ void NBBOSamplerStrategy::init(const core::Config::storage_type& cfg)
     cfg.get("interval", m_interval);
     cfg.get("narrow-output", m_narrow_output);
     cfg.get("crossed-only", m_crossed_only);
+    // the narrow output prints each venue's top from the bbo book
+    keep_bbo_book(m_narrow_output);
 
     // TODO: need to convert this to UTC!!
     cfg.get("start-time-seconds-since-midnight", m_start_time_ms_since_midnight);
@@ -1,3 +1,6 @@
+#include <i01_oe/OrderGateway.hpp>
+#include <i01_oe/OrderManager.hpp>
+
 #include <i01_ts/Strategy.hpp>
 #include <i01_ts/LogReaderStrategy.hpp>
 #include <i01_ts/ManualStrategy.hpp>
@@ -51,6 +54,13 @@ Strategy::Strategy(i01::OE::OrderManager * omp, i01::MD::DataManager *dmp, const
     s_strategies.insert(std::make_pair(m_name, this));
 }
 
+OE::GatewayClient * Strategy::gateway_client(OE::OrderListener *l)
+{
+    if (m_om_p == nullptr || m_om_p->gateway() == nullptr)
+        return nullptr;
+    return m_om_p->gateway()->add_client(l);
+}
+
 Strategy * Strategy::get_strategy(const std::string& n)
 {
     core::LockGuard<core::SpinMutex> lock(s_strategies_mutex);
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <memory>
+
+#include <i01_md/NBBOEngine.hpp>
 #include <i01_md/Symbol.hpp>
 
 #include <i01_ts/L1EquitiesStrategy.hpp>
@@ -12,31 +15,41 @@ enum class Side;
 
 namespace i01 { namespace TS {
 
-class NBBOEquitiesStrategy : public L1EquitiesStrategy {
+class NBBOEquitiesStrategy : public L1EquitiesStrategy,
+                             public MD::NBBOListener {
 public:
     using Timestamp = core::Timestamp;
 
+    /// Subscribes to the data manager's consolidated quotes, so NBBO
+    /// strategies with the same quote policy share one NBBO rather than
+    /// each keeping its own.
     NBBOEquitiesStrategy(OE::OrderManager *omp, MD::DataManager *dmp, const std::string& n);
-    // when only one side has changed
+
+    // when only one side has changed; feeds the bbo book if it is kept
     virtual void on_bbo_update(const Timestamp&
                                , const core::MIC&
                                , const MD::EphemeralSymbolIndex&
                                , const MD::L3OrderData::Side&
-                               , const MD::L2Quote& ) override final;
+                               , const MD::L2Quote& ) override;
 
     // when both sides have changed from the last update
     virtual void on_bbo_update(const Timestamp&
                                , const core::MIC&
                                , const MD::EphemeralSymbolIndex&
-                               , const MD::FullL2Quote& ) override final;
+                               , const MD::FullL2Quote& ) override;
+
+    virtual void on_trading_status_update(const MD::TradingStatusEvent&) override;
+
+    /* NBBOListener */
+    virtual void on_nbbo_event(const MD::NBBOEvent&) override final;
 
     // virtual void on_nbbo_update(const Timestamp&, const core::MIC&, MD::EphemeralSymbolIndex, const MD::Side&, const MD::L2Quote&) = 0;
     virtual void on_nbbo_update(const Timestamp&, const core::MIC&, MD::EphemeralSymbolIndex, const MD::FullL2Quote&) = 0;
 
-    virtual void on_trading_status_update(const MD::TradingStatusEvent&) override;
-
     Timestamp last_data_timestamp() const { return m_last_data_timestamp; }
 
+    /// The policy is this strategy's own: it resubscribes to the engine
+    /// under the new policy, so call these before data starts.
     void enable_quotes_in_state(const MD::SymbolState::TradingState s);
     void disable_quotes_in_state(const MD::SymbolState::TradingState s);
 
@@ -44,6 +57,13 @@ private:
     const static std::uint32_t SIDE_MASK = 1 << 16;
 
 protected:
+    const MD::NBBOEngine& nbbo_engine() const;
+
+    /// The NBBO comes from the engine; a strategy that wants each venue's
+    /// top as an order in a consolidated book (e.g. to print it) keeps one
+    /// here, fed by on_bbo_update.  Off by default, as the books are large.
+    void keep_bbo_book(bool keep);
+    /// Only valid while the bbo book is kept.
     const MD::OrderBook& bbo_book(MD::EphemeralSymbolIndex esi) const;
 
 
@@ -65,7 +85,7 @@ protected:
 
 private:
 
-    bool update_book(const Timestamp& ts, const core::MIC& mic, MD::EphemeralSymbolIndex esi,
+    void update_book(const Timestamp& ts, const core::MIC& mic, MD::EphemeralSymbolIndex esi,
                      MD::L3OrderData::Side side, const MD::L2Quote& q);
     MD::OrderBook::Order make_new_order(MD::L3OrderData::RefNum refnum, const Timestamp& ts, const MD::L2Quote& q);
 
@@ -77,14 +97,14 @@ private:
 
 private:
     using BooksArray = std::array<MD::OrderBook,MD::NUM_SYMBOL_INDEX>;
-    using TradingStateBitfield = std::underlying_type<MD::SymbolState::TradingState>::type;
+    using TradingStateBitfield = MD::NBBOEngine::TradingStateBitfield;
     using BoolArray = std::array<bool, MD::NUM_SYMBOL_INDEX>;
     using BoolByMIC = std::array<BoolArray, (int) core::MIC::Enum::NUM_MIC>;
 
 private:
     Timestamp m_last_data_timestamp;
-    BooksArray m_books;
-    BoolByMIC m_venue_enabled;
+    std::unique_ptr<BooksArray> m_books;
+    std::unique_ptr<BoolByMIC> m_venue_enabled;
 
     TradingStateBitfield m_status_policy_bitfield;
 
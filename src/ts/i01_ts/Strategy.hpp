@@ -12,6 +12,8 @@ class DataManager;
 }}
 
 namespace i01 { namespace OE {
+class GatewayClient;
+class OrderListener;
 class OrderManager;
 }}
 
@@ -38,6 +40,14 @@ public:
     /// are pthread_join()ed on prior to engine shutdown.
     virtual void start() {}
 
+    /// In order gateway mode (oe.gateway.enabled), a new GatewayClient
+    /// that hands l the responses to its orders when polled: the strategy
+    /// creates its orders with the client as their listener, and sends,
+    /// cancels and polls through it from its own thread.  nullptr when the
+    /// mode is off, and the strategy uses m_om_p as usual.  Call before
+    /// the engine starts, e.g. from the constructor.
+    OE::GatewayClient * gateway_client(OE::OrderListener *l);
+
     static Strategy * get_strategy(const std::string& n);
     static Strategy * factory(OE::OrderManager * omp, MD::DataManager * dmp, const std::string& n, const std::string& type);
 
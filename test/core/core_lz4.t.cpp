@@ -1,9 +1,15 @@
 #include <gtest/gtest.h>
 
 #include <algorithm>
+#include <chrono>
 #include <iostream>
 #include <fstream>
 #include <string.h>
+#include <unistd.h>
+#include <thread>
+#include <vector>
+
+#include <lz4frame.h>
 
 #include <i01_core/MappedRegion.hpp>
 #include <i01_core/LZ4.hpp>
@@ -48,3 +54,345 @@ TEST(core_lz4, core_lz4_test)
         }
     }
 }
+
+namespace {
+
+/// Compress src to path as one frame per entry of linked, split evenly,
+/// each with 64KB blocks, linked or independent, and a content checksum.
+/// By default the first frame has independent blocks and the second
+/// linked.
+bool write_lz4_frames(const std::string& path, const char *src, size_t len,
+                      const std::vector<bool>& linked = {false, true},
+                      bool block_checksums = false)
+{
+    std::vector<char> out;
+    for (size_t i = 0; i < linked.size(); ++i) {
+        LZ4F_preferences_t prefs;
+        ::memset(&prefs, 0, sizeof(prefs));
+        prefs.frameInfo.blockSizeID = LZ4F_max64KB;
+        prefs.frameInfo.blockMode = linked[i] ? LZ4F_blockLinked : LZ4F_blockIndependent;
+        prefs.frameInfo.contentChecksumFlag = LZ4F_contentChecksumEnabled;
+        if (block_checksums)
+            prefs.frameInfo.blockChecksumFlag = LZ4F_blockChecksumEnabled;
+        const char *p = src + len * i / linked.size();
+        size_t n = len * (i + 1) / linked.size() - len * i / linked.size();
+        size_t off = out.size();
+        out.resize(off + LZ4F_compressFrameBound(n, &prefs));
+        size_t r = LZ4F_compressFrame(&out[off], out.size() - off, p, n, &prefs);
+        if (LZ4F_isError(r))
+            return false;
+        out.resize(off + r);
+    }
+    std::ofstream f(path, std::ios::binary);
+    f.write(out.data(), out.size());
+    return f.good();
+}
+
+}
+
+TEST(core_lz4, core_lz4_seek)
+{
+    using i01::core::MappedRegion;
+    using i01::core::LZ4::Checkpoint;
+    using i01::core::LZ4::FileReader;
+
+    std::string path_decompressed(STRINGIFY(I01_DATA) "/BZX_UNIT_1_20140724_1500.pcap-ns");
+    std::string path_compressed("/tmp/core_lz4_seek." + std::to_string(::getpid()) + ".lz4");
+
+    MappedRegion d(path_decompressed, 0, true);
+    ASSERT_TRUE(d.mapped()) << "reference file not mapped.";
+    ASSERT_TRUE(write_lz4_frames(path_compressed, d.data<char>(), d.size()));
+
+    std::vector<char> buf(4096);
+    auto check_at = [&](FileReader& r, std::uint64_t offset) {
+        ASSERT_TRUE(r.seek(offset)) << "seek to " << offset;
+        EXPECT_EQ(offset, r.tell());
+        size_t want = std::min<size_t>(buf.size(), d.size() - offset);
+        ASSERT_EQ((ssize_t)want, r.read(buf.data(), buf.size())) << "read at " << offset;
+        EXPECT_EQ(0, ::memcmp(d.data<char>() + offset, buf.data(), want)) << "data at " << offset;
+        EXPECT_EQ(offset + want, r.tell());
+    };
+
+    std::vector<Checkpoint> cps;
+    {
+        FileReader r(path_compressed);
+        ASSERT_TRUE(r.is_open());
+        size_t n = 0;
+        ssize_t nn;
+        while ((nn = r.read(buf.data(), buf.size())) > 0) {
+            ASSERT_EQ(0, ::memcmp(d.data<char>() + n, buf.data(), nn)) << "at " << n;
+            n += nn;
+        }
+        ASSERT_EQ(0, nn);
+        ASSERT_EQ(d.size(), n);
+        cps = r.checkpoints();
+        // every block of the first frame, and the start of the second:
+        EXPECT_EQ((d.size() / 2 + 65535) / 65536 + 1, cps.size());
+        EXPECT_EQ(d.size() / 2, cps.back().decompressed_offset);
+        EXPECT_EQ(cps.back().frame_offset, cps.back().compressed_offset);
+
+        // backwards and forwards, in and across frames:
+        for (std::uint64_t o : {d.size() - 100, (size_t)0, (size_t)65536 * 3 + 17, (size_t)65536 * 3 - 1,
+                                d.size() / 2 + 5, d.size() / 2 - 5, d.size() / 2 + 100000, (size_t)123456}) {
+            check_at(r, o);
+        }
+        ASSERT_TRUE(r.seek(d.size()));
+        EXPECT_EQ(0, r.read(buf.data(), buf.size()));
+        EXPECT_FALSE(r.seek(d.size() + 1));
+    }
+    {
+        // a fresh reader jumps straight to saved checkpoints:
+        FileReader r(path_compressed);
+        r.checkpoints(cps);
+        EXPECT_EQ(cps.size(), r.checkpoints().size());
+        check_at(r, 65536 * 20 + 3);
+        check_at(r, 65536 * 7);
+        check_at(r, d.size() / 2 + 77);
+    }
+    ::unlink(path_compressed.c_str());
+}
+
+TEST(core_lz4, core_lz4_read_ahead)
+{
+    using i01::core::MappedRegion;
+    using i01::core::LZ4::Checkpoint;
+    using i01::core::LZ4::FileReader;
+    using i01::core::LZ4::ReadAhead;
+
+    auto read_all = [](FileReader& r, std::vector<char>& out) {
+        std::vector<char> buf(10000);
+        out.clear();
+        ssize_t nn;
+        while ((nn = r.read(buf.data(), buf.size())) > 0)
+            out.insert(out.end(), buf.data(), buf.data() + nn);
+        return nn;
+    };
+    auto same_checkpoints = [](const std::vector<Checkpoint>& a, const std::vector<Checkpoint>& b) {
+        return a.size() == b.size() && 0 == ::memcmp(a.data(), b.data(), a.size() * sizeof(Checkpoint));
+    };
+
+    std::string path_first5(STRINGIFY(I01_DATA) "/BZX_UNIT_1_20140724_1500_first5.pcap-ns");
+    MappedRegion d5(path_first5, 0, true);
+    ASSERT_TRUE(d5.mapped());
+
+    std::string path_decompressed(STRINGIFY(I01_DATA) "/BZX_UNIT_1_20140724_1500.pcap-ns");
+    std::string path_compressed("/tmp/core_lz4_read_ahead." + std::to_string(::getpid()) + ".lz4");
+    MappedRegion d(path_decompressed, 0, true);
+    ASSERT_TRUE(d.mapped());
+    // linked frames between runs of independent ones:
+    ASSERT_TRUE(write_lz4_frames(path_compressed, d.data<char>(), d.size(), {false, false, true, false, true, true, false}));
+
+    std::vector<char> serial;
+    std::vector<Checkpoint> cps;
+    {
+        FileReader r(path_compressed);
+        ASSERT_EQ(0, read_all(r, serial));
+        ASSERT_EQ(d.size(), serial.size());
+        cps = r.checkpoints();
+    }
+
+    for (const ReadAhead& ra : {ReadAhead(1, 1), ReadAhead(2), ReadAhead(3, 2), ReadAhead(4, 16)}) {
+        {
+            FileReader r(STRINGIFY(I01_DATA) "/BZX_UNIT_1_20140724_1500_first5.pcap-ns.lz4", ra);
+            ASSERT_TRUE(r.is_open());
+            std::vector<char> out;
+            EXPECT_EQ(0, read_all(r, out));
+            ASSERT_EQ(d5.size(), out.size());
+            EXPECT_EQ(0, ::memcmp(d5.data<char>(), out.data(), out.size()));
+        }
+        FileReader r(path_compressed, ra);
+        std::vector<char> out;
+        EXPECT_EQ(0, read_all(r, out)) << ra.workers << " workers";
+        EXPECT_TRUE(serial == out) << ra.workers << " workers";
+        EXPECT_TRUE(same_checkpoints(cps, r.checkpoints())) << ra.workers << " workers";
+
+        // seeks drop what was read ahead:
+        std::vector<char> buf(4096);
+        for (std::uint64_t o : {(std::uint64_t)65536 * 5 + 3, d.size() / 7 + 11, d.size() / 2, (std::uint64_t)100, d.size() - 1000}) {
+            ASSERT_TRUE(r.seek(o)) << "seek to " << o;
+            EXPECT_EQ(o, r.tell());
+            size_t want = std::min<size_t>(buf.size(), d.size() - o);
+            ASSERT_EQ((ssize_t)want, r.read(buf.data(), buf.size())) << "read at " << o;
+            EXPECT_EQ(0, ::memcmp(d.data<char>() + o, buf.data(), want)) << "data at " << o;
+        }
+        {
+            // and a fresh reader, seeking part way into the first frame:
+            FileReader r2(path_compressed, ra);
+            r2.checkpoints(cps);
+            ASSERT_TRUE(r2.seek(65536 * 9 + 1));
+            std::vector<char> rest;
+            EXPECT_EQ(0, read_all(r2, rest));
+            ASSERT_EQ(d.size() - (65536 * 9 + 1), rest.size());
+            EXPECT_EQ(0, ::memcmp(d.data<char>() + 65536 * 9 + 1, rest.data(), rest.size()));
+        }
+    }
+
+    {
+        // a corrupt block fails in order, after those before it:
+        std::vector<char> bad;
+        {
+            MappedRegion c(path_compressed, 0, true);
+            bad.assign(c.data<char>(), c.data<char>() + c.size());
+        }
+        // a block of the second frame, which has independent blocks:
+        const Checkpoint& cp = cps[12];
+        ASSERT_NE(cp.frame_offset, cp.compressed_offset);
+        std::uint32_t block_size;
+        ::memcpy(&block_size, &bad[cp.compressed_offset], sizeof(block_size));
+        ASSERT_EQ(0u, block_size & 0x80000000);
+        // literal lengths that run off the end:
+        std::fill(bad.begin() + cp.compressed_offset + 4, bad.begin() + cp.compressed_offset + 4 + block_size, '\xff');
+        std::ofstream(path_compressed, std::ios::binary | std::ios::trunc).write(bad.data(), bad.size());
+        for (unsigned workers : {0u, 2u}) {
+            FileReader r(path_compressed, ReadAhead(workers));
+            std::vector<char> buf(65536);
+            size_t n = 0;
+            ssize_t nn;
+            while ((nn = r.read(buf.data(), buf.size())) > 0)
+                n += nn;
+            EXPECT_EQ(-1, nn) << workers << " workers";
+            EXPECT_EQ(cp.decompressed_offset, n) << workers << " workers";
+        }
+    }
+    ::unlink(path_compressed.c_str());
+}
+
+TEST(core_lz4, core_lz4_checksums)
+{
+    using i01::core::MappedRegion;
+    using i01::core::LZ4::Checkpoint;
+    using i01::core::LZ4::FileReader;
+    using i01::core::LZ4::ReadAhead;
+
+    std::string path_decompressed(STRINGIFY(I01_DATA) "/BZX_UNIT_1_20140724_1500.pcap-ns");
+    std::string path_compressed("/tmp/core_lz4_checksums." + std::to_string(::getpid()) + ".lz4");
+    MappedRegion d(path_decompressed, 0, true);
+    ASSERT_TRUE(d.mapped());
+    ASSERT_TRUE(write_lz4_frames(path_compressed, d.data<char>(), d.size(), {false, true, false}, true));
+
+    std::vector<char> good;
+    {
+        MappedRegion c(path_compressed, 0, true);
+        good.assign(c.data<char>(), c.data<char>() + c.size());
+    }
+    // bytes read before the read fails, or all of them:
+    auto read_until_error = [&](const std::vector<char>& file, unsigned workers, ssize_t& last) {
+        std::ofstream(path_compressed, std::ios::binary | std::ios::trunc).write(file.data(), file.size());
+        FileReader r(path_compressed, ReadAhead(workers));
+        std::vector<char> buf(65536);
+        size_t n = 0;
+        while ((last = r.read(buf.data(), buf.size())) > 0)
+            n += last;
+        return n;
+    };
+
+    std::vector<Checkpoint> cps;
+    {
+        FileReader r(path_compressed);
+        std::vector<char> buf(65536);
+        while (r.read(buf.data(), buf.size()) > 0)
+            ;
+        cps = r.checkpoints();
+    }
+    // the first frame's blocks, then the second and third frames:
+    const std::uint64_t frame1 = d.size() / 3;
+    const std::uint64_t frame2 = 2 * d.size() / 3;
+    auto third = std::find_if(cps.begin() + 1, cps.end(), [frame2](const Checkpoint& cp) { return cp.decompressed_offset >= frame2; });
+    ASSERT_NE(cps.end(), third);
+    ASSERT_EQ(third->frame_offset, third->compressed_offset);
+    const Checkpoint& second = *(third - 1);
+    ASSERT_EQ(frame1, second.decompressed_offset);
+    ASSERT_EQ(second.frame_offset, second.compressed_offset);
+
+    for (unsigned workers : {0u, 2u}) {
+        ssize_t last = 0;
+        EXPECT_EQ(d.size(), read_until_error(good, workers, last)) << workers << " workers";
+        EXPECT_EQ(0, last);
+
+        {
+            // the header checksum of the first frame:
+            std::vector<char> bad(good);
+            bad[6] ^= 0x01;
+            EXPECT_EQ(0u, read_until_error(bad, workers, last)) << workers << " workers";
+            EXPECT_EQ(-1, last);
+        }
+        {
+            // the checksum after the fourth block of the first frame:
+            std::vector<char> bad(good);
+            const Checkpoint& cp = cps[4];
+            std::uint32_t block_size;
+            ::memcpy(&block_size, &bad[cp.compressed_offset], sizeof(block_size));
+            bad[cp.compressed_offset + 4 + (block_size & 0x7fffffff)] ^= 0x01;
+            EXPECT_EQ(cp.decompressed_offset, read_until_error(bad, workers, last)) << workers << " workers";
+            EXPECT_EQ(-1, last);
+        }
+        {
+            // the content checksum of the first frame, just before the
+            // second frame's header:
+            std::vector<char> bad(good);
+            bad[second.frame_offset - 1] ^= 0x01;
+            EXPECT_EQ(frame1, read_until_error(bad, workers, last)) << workers << " workers";
+            EXPECT_EQ(-1, last);
+        }
+        {
+            // the content checksum of the second frame, with linked blocks:
+            std::vector<char> bad(good);
+            bad[third->frame_offset - 1] ^= 0x01;
+            EXPECT_GE(third->decompressed_offset, read_until_error(bad, workers, last)) << workers << " workers";
+            EXPECT_EQ(-1, last);
+        }
+        {
+            // content checksums are not checked after starting part way
+            // into a frame:
+            std::vector<char> bad(good);
+            bad[second.frame_offset - 1] ^= 0x01;
+            std::ofstream(path_compressed, std::ios::binary | std::ios::trunc).write(bad.data(), bad.size());
+            FileReader r(path_compressed, ReadAhead(workers));
+            r.checkpoints(cps);
+            ASSERT_TRUE(r.seek(cps[5].decompressed_offset + 1));
+            EXPECT_TRUE(r.seek(d.size()));
+        }
+    }
+    ::unlink(path_compressed.c_str());
+}
+
+TEST(core_lz4, core_lz4_read_ahead_benchmark)
+{
+    using i01::core::MappedRegion;
+    using i01::core::LZ4::FileReader;
+    using i01::core::LZ4::ReadAhead;
+
+    std::string path_decompressed(STRINGIFY(I01_DATA) "/BZX_UNIT_1_20140724_1500.pcap-ns");
+    std::string path_compressed("/tmp/core_lz4_read_ahead_benchmark." + std::to_string(::getpid()) + ".lz4");
+    MappedRegion d(path_decompressed, 0, true);
+    ASSERT_TRUE(d.mapped());
+    ASSERT_TRUE(write_lz4_frames(path_compressed, d.data<char>(), d.size(), {false}));
+
+    const int rounds = 30;
+    const unsigned cpus = std::max(1u, std::thread::hardware_concurrency());
+    double serial_ns = 0;
+    for (unsigned workers : {0u, 1u, 2u, cpus}) {
+        auto start = std::chrono::steady_clock::now();
+        std::uint64_t records = 0;
+        for (int i = 0; i < rounds; ++i) {
+            // walk the records as a pcap reader would:
+            FileReader r(path_compressed, ReadAhead(workers));
+            char hdr[24];
+            std::vector<char> pkt(65536);
+            ASSERT_EQ(24, r.read(hdr, sizeof(hdr)));
+            std::uint32_t rec[4];
+            while (sizeof(rec) == r.read(reinterpret_cast<char *>(rec), sizeof(rec))) {
+                if (r.read(pkt.data(), rec[2]) != (ssize_t)rec[2])
+                    break;
+                ++records;
+            }
+        }
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        if (0 == workers)
+            serial_ns = ns;
+        std::cout << workers << " workers: " << records / rounds << " records, "
+                  << static_cast<double>(d.size()) * rounds / ns << " GB/s decompressed, x"
+                  << serial_ns / ns << std::endl;
+    }
+    ::unlink(path_compressed.c_str());
+}
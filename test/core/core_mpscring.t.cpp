@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <i01_core/MPSCRing.hpp>
+
+TEST(core_mpscring, core_mpscring_push_pop)
+{
+    i01::core::MPSCRing<std::uint64_t> r(3);
+    EXPECT_EQ(r.capacity(), 4U);
+    EXPECT_TRUE(r.empty());
+
+    for (std::uint64_t round = 0; round < 3; round++) {
+        for (std::uint64_t i = 0; i < 4; i++) {
+            EXPECT_TRUE(r.try_push(round * 10 + i));
+        }
+        EXPECT_FALSE(r.try_push(99));
+        EXPECT_EQ(r.size(), 4U);
+
+        for (std::uint64_t i = 0; i < 4; i++) {
+            std::uint64_t v = 0;
+            ASSERT_TRUE(r.try_pop(v));
+            EXPECT_EQ(v, round * 10 + i);
+        }
+        std::uint64_t v = 0;
+        EXPECT_FALSE(r.try_pop(v));
+    }
+
+    EXPECT_THROW(i01::core::MPSCRing<int>(0), std::invalid_argument);
+}
+
+TEST(core_mpscring, core_mpscring_threads_in_order)
+{
+    // each producer's values arrive in the order it pushed them, and none
+    // are lost or repeated:
+    const std::uint64_t N = 500000;
+    const std::uint64_t PRODUCERS = 4;
+    i01::core::MPSCRing<std::uint64_t> r(1024);
+
+    std::vector<std::thread> producers;
+    for (std::uint64_t p = 0; p < PRODUCERS; p++) {
+        producers.emplace_back([&r, p, N]() {
+                for (std::uint64_t i = 1; i <= N; i++) {
+                    while (!r.try_push((p << 32) | i)) {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+    }
+
+    std::vector<std::uint64_t> expect(PRODUCERS, 1);
+    bool in_order = true;
+    for (std::uint64_t n = 0; n < N * PRODUCERS; ) {
+        std::uint64_t v = 0;
+        if (r.try_pop(v)) {
+            auto p = v >> 32;
+            in_order = in_order && p < PRODUCERS && (v & 0xffffffffULL) == expect[p];
+            if (p < PRODUCERS)
+                ++expect[p];
+            ++n;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    for (auto& t : producers)
+        t.join();
+    EXPECT_TRUE(in_order);
+    EXPECT_TRUE(r.empty());
+}
@@ -0,0 +1,61 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <i01_core/SeqLock.hpp>
+
+namespace {
+struct Pair {
+    std::uint64_t a;
+    std::uint64_t b;
+    std::uint32_t c;
+};
+}
+
+TEST(core_seqlock, core_seqlock_load_store)
+{
+    i01::core::SeqLock<Pair> sl(Pair{1, 2, 3});
+    auto p = sl.load();
+    EXPECT_EQ(p.a, 1U);
+    EXPECT_EQ(p.b, 2U);
+    EXPECT_EQ(p.c, 3U);
+    EXPECT_EQ(sl.version(), 0U);
+
+    sl.store(Pair{4, 5, 6});
+    ASSERT_TRUE(sl.try_load(p));
+    EXPECT_EQ(p.a, 4U);
+    EXPECT_EQ(p.b, 5U);
+    EXPECT_EQ(p.c, 6U);
+    EXPECT_EQ(sl.version(), 1U);
+}
+
+TEST(core_seqlock, core_seqlock_no_torn_reads)
+{
+    i01::core::SeqLock<Pair> sl(Pair{0, 0, 0});
+    std::atomic<bool> done(false);
+    std::atomic<std::uint64_t> torn(0);
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; i++) {
+        readers.emplace_back([&]() {
+                while (!done.load(std::memory_order_relaxed)) {
+                    auto p = sl.load();
+                    if (p.b != p.a * 2 || p.c != static_cast<std::uint32_t>(p.a)) {
+                        torn++;
+                    }
+                }
+            });
+    }
+    for (std::uint64_t i = 1; i <= 1000000; i++) {
+        sl.store(Pair{i, 2 * i, static_cast<std::uint32_t>(i)});
+    }
+    done = true;
+    for (auto &t : readers) {
+        t.join();
+    }
+    EXPECT_EQ(torn.load(), 0U);
+    EXPECT_EQ(sl.version(), 1000000U);
+}
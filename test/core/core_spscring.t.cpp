@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <thread>
+
+#include <i01_core/SPSCRing.hpp>
+
+TEST(core_spscring, core_spscring_push_pop)
+{
+    i01::core::SPSCRing<std::uint64_t> r(3);
+    EXPECT_EQ(r.capacity(), 4U);
+    EXPECT_TRUE(r.empty());
+    EXPECT_TRUE(nullptr == r.front());
+
+    for (std::uint64_t round = 0; round < 3; round++) {
+        for (std::uint64_t i = 0; i < 4; i++) {
+            EXPECT_TRUE(r.try_push(round * 10 + i));
+        }
+        EXPECT_FALSE(r.try_push(99));
+        EXPECT_EQ(r.size(), 4U);
+
+        ASSERT_TRUE(nullptr != r.front());
+        EXPECT_EQ(*r.front(), round * 10);
+        for (std::uint64_t i = 0; i < 4; i++) {
+            std::uint64_t v = 0;
+            ASSERT_TRUE(r.try_pop(v));
+            EXPECT_EQ(v, round * 10 + i);
+        }
+        std::uint64_t v = 0;
+        EXPECT_FALSE(r.try_pop(v));
+    }
+
+    EXPECT_THROW(i01::core::SPSCRing<int>(0), std::invalid_argument);
+}
+
+TEST(core_spscring, core_spscring_threads_in_order)
+{
+    const std::uint64_t N = 2000000;
+    i01::core::SPSCRing<std::uint64_t> r(1024);
+
+    std::thread producer([&]() {
+            for (std::uint64_t i = 1; i <= N; i++) {
+                while (!r.try_push(i)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+
+    std::uint64_t expect = 1;
+    bool in_order = true;
+    while (expect <= N) {
+        std::uint64_t v = 0;
+        if (r.try_pop(v)) {
+            in_order = in_order && v == expect;
+            ++expect;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    EXPECT_TRUE(in_order);
+    EXPECT_TRUE(r.empty());
+}
@@ -0,0 +1,312 @@
+#include <gtest/gtest.h>
+
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <tuple>
+#include <vector>
+
+#include <i01_core/Time.hpp>
+#include <i01_core/TimerListener.hpp>
+#include <i01_core/TimerWheel.hpp>
+
+namespace CORE_TIMER_WHEEL_TEST {
+
+using i01::core::Timestamp;
+using i01::core::TimerWheel;
+
+std::uint64_t to_ns(const Timestamp& ts)
+{
+    return static_cast<std::uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<std::uint64_t>(ts.tv_nsec);
+}
+
+Timestamp from_ns(std::uint64_t ns)
+{
+    return Timestamp(static_cast<time_t>(ns / 1000000000ULL), static_cast<long>(ns % 1000000000ULL));
+}
+
+struct Recorder : public i01::core::TimerListener {
+    using Fire = std::tuple<std::uint64_t, std::uint64_t, std::uintptr_t, std::uint64_t>; // (clock, ts, userdata, iter)
+    const TimerWheel *wheel = nullptr;
+    std::vector<Fire> fires;
+    bool keep = true;
+    std::uint64_t count = 0;
+
+    virtual void on_timer(const Timestamp& ts, void *userdata, std::uint64_t iter) override
+    {
+        ++count;
+        if (keep)
+            fires.emplace_back(to_ns(wheel->time()), to_ns(ts), reinterpret_cast<std::uintptr_t>(userdata), iter);
+    }
+};
+
+/// Cancels or adds timers from on_timer().
+struct Meddler : public i01::core::TimerListener {
+    TimerWheel *wheel = nullptr;
+    TimerWheel::Handle victim = 0;
+    i01::core::TimerListener *spawn = nullptr;
+    std::uint64_t spawn_after_ns = 0;
+
+    virtual void on_timer(const Timestamp& ts, void *, std::uint64_t) override
+    {
+        if (victim) {
+            EXPECT_TRUE(wheel->cancel(victim));
+        }
+        victim = 0;
+        if (spawn)
+            wheel->add(*spawn, nullptr, from_ns(to_ns(ts) + spawn_after_ns));
+        spawn = nullptr;
+    }
+};
+
+const std::uint64_t T0 = 1415725200123456789ULL;
+
+}
+
+TEST(core_timer_wheel, one_shot_order)
+{
+    using namespace CORE_TIMER_WHEEL_TEST;
+
+    // 1ms ticks; deadlines from now to past the last level's reach:
+    TimerWheel w;
+    w.reset(from_ns(T0));
+    Recorder r;
+    r.wheel = &w;
+    std::mt19937_64 rng(7);
+    std::vector<std::uint64_t> deadlines;
+    for (std::uintptr_t i = 0; i < 20000; ++i) {
+        const int scale = static_cast<int>(rng() % 7);
+        std::uint64_t d = T0 + rng() % (1000ULL << (7 * scale));
+        if (0 == i % 1000)
+            d = T0 + 60ULL * 86400 * 1000000000ULL; // beyond 2^32 ticks
+        deadlines.push_back(d);
+        EXPECT_NE(0u, w.add(r, reinterpret_cast<void *>(i), from_ns(d)));
+    }
+    EXPECT_EQ(deadlines.size(), w.size());
+
+    std::uint64_t now = T0;
+    while (!w.empty()) {
+        EXPECT_LE(to_ns(w.time()), to_ns(w.next_due()));
+        now += 1 + rng() % (rng() % 2 ? 1000000ULL : 100000000000ULL);
+        w.advance(from_ns(now));
+    }
+    ASSERT_EQ(deadlines.size(), r.fires.size());
+    for (std::size_t i = 0; i < r.fires.size(); ++i) {
+        const auto& f = r.fires[i];
+        const std::uint64_t d = deadlines[std::get<2>(f)];
+        EXPECT_EQ(d, std::get<1>(f));
+        // on the first tick at or after the deadline:
+        EXPECT_EQ((d + 999999) / 1000000 * 1000000, std::get<0>(f)) << i;
+        EXPECT_EQ(1u, std::get<3>(f));
+        if (i) {
+            const auto& p = r.fires[i - 1];
+            EXPECT_LE(std::get<0>(p), std::get<0>(f));
+            // in the order added within a tick:
+            if (std::get<0>(p) == std::get<0>(f)) {
+                EXPECT_LT(std::get<2>(p), std::get<2>(f));
+            }
+        }
+    }
+
+    // past deadlines fire on the next tick:
+    r.fires.clear();
+    w.add(r, nullptr, from_ns(T0));
+    w.advance(w.time());
+    EXPECT_TRUE(r.fires.empty());
+    w.advance(from_ns(to_ns(w.time()) + 1000000));
+    EXPECT_EQ(1u, r.fires.size());
+}
+
+TEST(core_timer_wheel, periodic_and_cancel)
+{
+    using namespace CORE_TIMER_WHEEL_TEST;
+
+    // deadlines on microsecond ticks:
+    const std::uint64_t B = T0 / 1000 * 1000;
+    TimerWheel w(1000);
+    w.reset(from_ns(B));
+    Recorder r;
+    r.wheel = &w;
+    const auto every_10ms = w.add(r, reinterpret_cast<void *>(1), from_ns(B + 10000000), Timestamp(0, 10000000));
+    const auto every_1s = w.add(r, reinterpret_cast<void *>(2), from_ns(B + 1000000000), Timestamp(1, 0));
+    const auto once = w.add(r, reinterpret_cast<void *>(3), from_ns(B + 5000000));
+    EXPECT_TRUE(w.cancel(once));
+    EXPECT_FALSE(w.cancel(once));
+    EXPECT_FALSE(w.cancel(0));
+
+    // a gap of ten seconds still fires every expiry:
+    w.advance(from_ns(B + 10 * 1000000000ULL));
+    EXPECT_EQ(1000u + 10u, r.fires.size());
+    std::uint64_t n10 = 0, n1 = 0;
+    for (const auto& f : r.fires) {
+        EXPECT_EQ(std::get<0>(f), std::get<1>(f));
+        EXPECT_EQ(1u, std::get<3>(f));
+        if (1 == std::get<2>(f)) {
+            EXPECT_EQ(B + ++n10 * 10000000, std::get<1>(f));
+        } else {
+            EXPECT_EQ(B + ++n1 * 1000000000, std::get<1>(f));
+        }
+    }
+    EXPECT_TRUE(w.cancel(every_10ms));
+    r.fires.clear();
+    w.advance(from_ns(B + 12 * 1000000000ULL));
+    EXPECT_EQ(2u, r.fires.size());
+    EXPECT_TRUE(w.cancel(every_1s));
+    EXPECT_TRUE(w.empty());
+
+    // handles of released timers stay dead once their slot is reused:
+    const auto reused = w.add(r, nullptr, from_ns(B + 13 * 1000000000ULL));
+    EXPECT_NE(reused, every_1s);
+    EXPECT_FALSE(w.cancel(every_1s));
+    EXPECT_TRUE(w.cancel(reused));
+
+    // an interval below the resolution fires once a tick:
+    TimerWheel coarse(1000000);
+    coarse.reset(from_ns(T0));
+    r.wheel = &coarse;
+    r.fires.clear();
+    coarse.add(r, nullptr, from_ns(T0 + 100), Timestamp(0, 300000));
+    coarse.advance(from_ns(T0 + 3000000));
+    ASSERT_EQ(3u, r.fires.size());
+    std::uint64_t iters = 0;
+    for (const auto& f : r.fires) {
+        EXPECT_GE(std::get<0>(f), std::get<1>(f));
+        EXPECT_LT(std::get<0>(f) - std::get<1>(f), 300000u);
+        iters += std::get<3>(f);
+    }
+    std::uint64_t due = 0;
+    for (std::uint64_t d = T0 + 100; d <= (T0 + 3000000) / 1000000 * 1000000; d += 300000)
+        ++due;
+    EXPECT_EQ(due, iters);
+}
+
+TEST(core_timer_wheel, change_while_firing)
+{
+    using namespace CORE_TIMER_WHEEL_TEST;
+
+    // nanosecond ticks, as for replay:
+    TimerWheel w(1);
+    w.reset(from_ns(T0));
+    Recorder r;
+    r.wheel = &w;
+    Meddler m;
+    m.wheel = &w;
+    w.add(m, nullptr, from_ns(T0 + 5000));
+    m.victim = w.add(r, reinterpret_cast<void *>(1), from_ns(T0 + 5000));
+    w.add(r, reinterpret_cast<void *>(2), from_ns(T0 + 5000));
+    m.spawn = &r;
+    m.spawn_after_ns = 0;
+    w.advance(from_ns(T0 + 5000));
+    // the victim is cancelled, and the timer added for now waits a tick:
+    ASSERT_EQ(1u, r.fires.size());
+    EXPECT_EQ(2u, std::get<2>(r.fires[0]));
+    w.advance(from_ns(T0 + 5001));
+    ASSERT_EQ(2u, r.fires.size());
+    EXPECT_EQ(T0 + 5001, std::get<0>(r.fires[1]));
+    EXPECT_TRUE(w.empty());
+
+    // 10s is beyond the reach of nanosecond ticks, so the timer goes round:
+    w.add(r, reinterpret_cast<void *>(3), from_ns(T0 + 10000005001ULL));
+    w.advance(from_ns(T0 + 10000005000ULL));
+    EXPECT_EQ(2u, r.fires.size());
+    w.advance(from_ns(T0 + 20000000000ULL));
+    ASSERT_EQ(3u, r.fires.size());
+    EXPECT_EQ(T0 + 10000005001ULL, std::get<0>(r.fires[2]));
+
+    // reset drops everything:
+    w.add(r, nullptr, from_ns(T0 + 30000000000ULL));
+    w.reset(from_ns(T0));
+    EXPECT_TRUE(w.empty());
+    w.advance(from_ns(T0 + 40000000000ULL));
+    EXPECT_EQ(3u, r.fires.size());
+}
+
+TEST(core_timer_wheel, benchmark)
+{
+    using namespace CORE_TIMER_WHEEL_TEST;
+
+    // 10k periodic timers of 1ms to 1s, driven a millisecond at a time as
+    // a poller loop would for a minute:
+    const std::size_t timers = 10000;
+    const std::uint64_t ticks = 60000;
+    TimerWheel w;
+    w.reset(from_ns(T0));
+    Recorder r;
+    r.wheel = &w;
+    r.keep = false;
+    std::mt19937_64 rng(11);
+    std::vector<TimerWheel::Handle> handles;
+    Timestamp start(Timestamp::now());
+    for (std::size_t i = 0; i < timers; ++i) {
+        const std::uint64_t interval = (1 + rng() % 1000) * 1000000ULL;
+        handles.push_back(w.add(r, nullptr, from_ns(T0 + interval), from_ns(interval)));
+    }
+    const Timestamp add_time(Timestamp::now() - start);
+    start = Timestamp::now();
+    for (std::uint64_t t = 1; t <= ticks; ++t)
+        w.advance(from_ns(T0 + t * 1000000ULL));
+    const Timestamp run_time(Timestamp::now() - start);
+    start = Timestamp::now();
+    for (auto h : handles)
+        EXPECT_TRUE(w.cancel(h));
+    const Timestamp cancel_time(Timestamp::now() - start);
+    EXPECT_TRUE(w.empty());
+    EXPECT_GT(r.count, ticks);
+
+    std::cout << timers << " timers: add " << to_ns(add_time) / timers << "ns"
+              << ", cancel " << to_ns(cancel_time) / timers << "ns"
+              << ", " << r.count << " expiries over " << ticks << " ticks in " << run_time
+              << "s, " << to_ns(run_time) / r.count << "ns per expiry, "
+              << to_ns(run_time) / ticks << "ns per tick" << std::endl;
+
+    // the same expiries from timerfds, all already due, through epoll:
+    struct rlimit rl;
+    ::getrlimit(RLIMIT_NOFILE, &rl);
+    const std::size_t fds = std::min<std::size_t>(timers, rl.rlim_cur > 64 ? rl.rlim_cur - 64 : 0);
+    if (fds < 100)
+        return;
+    const int ep = ::epoll_create1(EPOLL_CLOEXEC);
+    ASSERT_GE(ep, 0);
+    std::vector<int> tfds;
+    for (std::size_t i = 0; i < fds; ++i) {
+        const int fd = ::timerfd_create(CLOCK_REALTIME, TFD_NONBLOCK | TFD_CLOEXEC);
+        ASSERT_GE(fd, 0);
+        struct epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLET;
+        ev.data.fd = fd;
+        ASSERT_EQ(0, ::epoll_ctl(ep, EPOLL_CTL_ADD, fd, &ev));
+        tfds.push_back(fd);
+    }
+    const int rounds = 20;
+    std::vector<struct epoll_event> events(64);
+    std::uint64_t fired = 0;
+    std::uint64_t spent_ns = 0;
+    for (int round = 0; round < rounds; ++round) {
+        const struct itimerspec its{{0, 0}, {0, 1}};
+        for (int fd : tfds)
+            ::timerfd_settime(fd, 0, &its, nullptr);
+        ::usleep(1000);
+        start = Timestamp::now();
+        std::uint64_t n = 0;
+        while (n < fds) {
+            const int k = ::epoll_wait(ep, events.data(), static_cast<int>(events.size()), 0);
+            for (int i = 0; i < k; ++i) {
+                std::uint64_t v;
+                if (sizeof(v) == ::read(events[i].data.fd, &v, sizeof(v)))
+                    ++n;
+            }
+        }
+        spent_ns += to_ns(Timestamp::now() - start);
+        fired += n;
+    }
+    for (int fd : tfds)
+        ::close(fd);
+    ::close(ep);
+    std::cout << fds << " timerfds: " << spent_ns / fired << "ns per expiry through epoll_wait() and read()" << std::endl;
+}
@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <i01_core/TournamentTree.hpp>
+
+TEST(core_tournament_tree, core_tournament_tree_merge)
+{
+    const std::uint64_t END = std::numeric_limits<std::uint64_t>::max();
+    // five sorted streams, two of them empty:
+    std::vector<std::vector<std::uint64_t> > streams(5);
+    std::mt19937 rng(42);
+    for (std::size_t s : {0, 2, 3}) {
+        std::uint64_t v = 0;
+        for (int i = 0; i < 1000; ++i) {
+            v += rng() % 10;
+            streams[s].push_back(v);
+        }
+    }
+
+    i01::core::TournamentTree<std::uint64_t> t(streams.size(), END);
+    EXPECT_EQ(8u, t.size());
+    EXPECT_TRUE(t.empty());
+    std::vector<std::size_t> pos(streams.size(), 0);
+    for (std::size_t s = 0; s < streams.size(); ++s) {
+        if (!streams[s].empty())
+            t.update(s, streams[s][0]);
+    }
+
+    std::vector<std::pair<std::uint64_t, std::size_t> > merged;
+    while (!t.empty()) {
+        const std::size_t s = t.winner();
+        merged.emplace_back(t.top(), s);
+        if (++pos[s] < streams[s].size())
+            t.update(s, streams[s][pos[s]]);
+        else
+            t.exhaust(s);
+    }
+    ASSERT_EQ(3000u, merged.size());
+    for (std::size_t i = 1; i < merged.size(); ++i) {
+        ASSERT_LE(merged[i - 1].first, merged[i].first) << i;
+        // ties go to the lower stream:
+        if (merged[i - 1].first == merged[i].first) {
+            ASSERT_LE(merged[i - 1].second, merged[i].second) << i;
+        }
+    }
+
+    i01::core::TournamentTree<int> one(1, std::numeric_limits<int>::max());
+    EXPECT_EQ(1u, one.size());
+    one.update(0, 7);
+    EXPECT_FALSE(one.empty());
+    EXPECT_EQ(7, one.top());
+    one.exhaust(0);
+    EXPECT_TRUE(one.empty());
+}
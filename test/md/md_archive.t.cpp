@@ -0,0 +1,519 @@
+#include <gtest/gtest.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <i01_core/macro.hpp>
+#include <i01_core/MIC.hpp>
+#include <i01_core/Time.hpp>
+
+#include <i01_net/Pcap.hpp>
+
+#include <i01_md/BookMuxListener.hpp>
+#include <i01_md/EventArchive.hpp>
+#include <i01_md/L2Book.hpp>
+#include <i01_md/NASDAQ/ITCH50/BatchDecoder.hpp>
+#include <i01_md/OrderStore.hpp>
+
+namespace MD_ARCHIVE_TEST {
+
+using namespace i01::MD;
+using i01::core::MIC;
+using i01::core::MICEnum;
+using i01::core::Timestamp;
+
+std::string temp_path(const std::string &name)
+{
+    return "/tmp/md_archive_test." + std::to_string(::getpid()) + "." + name;
+}
+
+/// Counts callbacks and sums what they carry.
+struct CountingListener : public NoopBookMuxListener {
+    virtual void on_symbol_definition(const SymbolDefEvent &evt) override { ++symbols; last_ticker = evt.ticker; }
+    virtual void on_l2_update(const L2BookEvent &evt) override {
+        ++levels;
+        bbo += evt.m_is_bbo;
+        checksum += evt.m_price * 31 + evt.m_size * 7 + evt.m_num_orders + evt.m_delta_size;
+    }
+    virtual void on_trade(const TradeEvent &evt) override { ++trades; checksum += evt.m_price + evt.m_size; }
+    virtual void on_gap(const GapEvent &) override { ++gaps; }
+    virtual void on_trading_status_update(const TradingStatusEvent &) override { ++statuses; }
+    virtual void on_feed_event(const FeedEvent &) override { ++feeds; }
+    virtual void on_start_of_data(const PacketEvent &) override { ++packets; }
+    virtual void on_end_of_data(const PacketEvent &) override { ++ends; }
+
+    std::uint64_t events() const { return symbols + levels + trades + gaps + statuses + feeds + packets + ends; }
+
+    std::uint64_t symbols = 0, levels = 0, bbo = 0, trades = 0, gaps = 0, statuses = 0, feeds = 0, packets = 0, ends = 0;
+    std::uint64_t checksum = 0;
+    std::string last_ticker;
+};
+
+/// Stands in for the ITCH decoder and book mux: builds L2 books per
+/// stock locate from the XNAS captures and publishes the BookMuxListener
+/// events a book mux would.
+class ITCHPcapSource : public i01::net::UDPPktListener<ITCHPcapSource> {
+public:
+    using Decoder = NASDAQ::ITCH50::Batch::BatchDecoder<>;
+
+    struct Order {
+        Price price;
+        Size size;
+        std::uint16_t locate;
+        bool buy;
+    };
+
+    ITCHPcapSource(BookMuxListener &l) :
+        m_listener(l), m_mic(MICEnum::XNAS), m_orders(1 << 16), m_books(NUM_SYMBOL_INDEX), m_packet(new Decoder::PacketType) {}
+
+    template<typename... Args>
+    void handle_payload(std::uint32_t, std::uint16_t, std::uint32_t, std::uint16_t, std::uint8_t *buf, std::size_t len, const Timestamp *ts, Args&&...) {
+        if (!m_decoder.decode(buf, len, *m_packet) || 0 == m_packet->num_entries) {
+            return;
+        }
+        m_ts = *ts;
+        m_listener.on_start_of_data(PacketEvent{m_ts, m_mic});
+        m_packet->for_each(buf, *this);
+        m_listener.on_end_of_data(PacketEvent{m_ts, m_mic});
+    }
+
+    void on_add(const NASDAQ::ITCH50::Batch::Add &m) {
+        const Order o{m.price, m.shares, m.stock_locate, 'B' == m.buy_sell_indicator};
+        if (m_orders.insert(m.order_refnum, o).second) {
+            level_(o, static_cast<std::int64_t>(o.size), 1, L2BookEvent::DeltaReasonCode::NEW_ORDER);
+        }
+    }
+
+    void on_execute(const NASDAQ::ITCH50::Batch::Execute &m) {
+        reduce_(m.order_refnum, m.executed_shares, L2BookEvent::DeltaReasonCode::EXECUTION,
+                m.with_price ? m.execution_price : 0, m.match_number);
+    }
+
+    void on_cancel(const NASDAQ::ITCH50::Batch::Cancel &m) {
+        reduce_(m.order_refnum, m.canceled_shares, L2BookEvent::DeltaReasonCode::CANCEL, 0, 0);
+    }
+
+    void on_delete(const NASDAQ::ITCH50::Batch::Delete &m) {
+        reduce_(m.order_refnum, ~0U, L2BookEvent::DeltaReasonCode::CANCEL, 0, 0);
+    }
+
+    void on_replace(const NASDAQ::ITCH50::Batch::Replace &m) {
+        Order *o = m_orders.find(m.original_order_refnum);
+        if (nullptr == o) {
+            return;
+        }
+        Order n{m.price, m.shares, o->locate, o->buy};
+        reduce_(m.original_order_refnum, ~0U, L2BookEvent::DeltaReasonCode::CANCEL, 0, 0);
+        if (m_orders.insert(m.new_order_refnum, n).second) {
+            level_(n, static_cast<std::int64_t>(n.size), 1, L2BookEvent::DeltaReasonCode::NEW_ORDER);
+        }
+    }
+
+    void on_other(const std::uint8_t *m, std::size_t len) {
+        // stock directory
+        if ('R' == m[0] && len >= 19) {
+            const std::uint16_t locate = NASDAQ::ITCH50::Batch::ScalarKernels::be16(m + 1);
+            std::string ticker(reinterpret_cast<const char *>(m + 11), 8);
+            ticker.erase(ticker.find_last_not_of(' ') + 1);
+            m_listener.on_symbol_definition(SymbolDefEvent{m_mic, locate, ticker});
+        }
+    }
+
+    const L2Book * book(std::uint16_t locate) const { return m_books[locate].get(); }
+
+private:
+    L2Book & book_(std::uint16_t locate) {
+        auto &b = m_books[locate];
+        if (!b) {
+            b.reset(new L2Book(m_mic, locate));
+        }
+        return *b;
+    }
+
+    void level_(const Order &o, std::int64_t dsize, int dorders, L2BookEvent::DeltaReasonCode reason) {
+        L2Book &b = book_(o.locate);
+        const L2Quote q = o.buy ? b.l2_bid(o.price) : b.l2_ask(o.price);
+        const std::int64_t size = std::max<std::int64_t>(0, static_cast<std::int64_t>(q.size) + dsize);
+        const std::int64_t n = size ? std::max<std::int64_t>(0, static_cast<std::int64_t>(q.num_orders) + dorders) : 0;
+        const bool top = b.replace(o.buy, o.price, static_cast<Size>(size), static_cast<NumOrders>(n), m_ts);
+        m_listener.on_l2_update(L2BookEvent{m_ts, b, o.buy, top, b.last_update_reduced_size(o.buy), o.price,
+                    static_cast<Size>(size), static_cast<NumOrders>(n),
+                    static_cast<Size>(dsize < 0 ? -dsize : dsize), reason});
+    }
+
+    void reduce_(std::uint64_t ref, std::uint32_t n, L2BookEvent::DeltaReasonCode reason, Price exec_price, std::uint64_t match) {
+        Order *o = m_orders.find(ref);
+        if (nullptr == o) {
+            return;
+        }
+        const Order before = *o;
+        const Size k = std::min(n, o->size);
+        o->size -= k;
+        level_(before, -static_cast<std::int64_t>(k), o->size ? 0 : -1, reason);
+        if (L2BookEvent::DeltaReasonCode::EXECUTION == reason) {
+            m_listener.on_trade(TradeEvent{m_ts, m_ts, book_(before.locate), match, exec_price ? exec_price : before.price, k,
+                        before.buy ? OrderBook::Order::Side::BUY : OrderBook::Order::Side::SELL, false, nullptr});
+        }
+        if (0 == o->size) {
+            m_orders.erase(ref);
+        }
+    }
+
+private:
+    BookMuxListener &m_listener;
+    MIC m_mic;
+    Timestamp m_ts;
+    OrderStore<Order> m_orders;
+    std::vector<std::unique_ptr<L2Book> > m_books;
+    Decoder m_decoder;
+    std::unique_ptr<Decoder::PacketType> m_packet;
+};
+
+const std::vector<std::string> & xnas_files()
+{
+    static const std::vector<std::string> files = {
+        STRINGIFY(I01_DATA) "/mdnasdaq.20141003.090000.1412341200.first10k.pcap-ns",
+        STRINGIFY(I01_DATA) "/mdnasdaq.20141111.120000_120100.XNAS.first10k.pcap-ns",
+    };
+    return files;
+}
+
+/// Feed one capture through the pcap path into l.
+void read_pcap(const std::string &file, BookMuxListener &l, std::unique_ptr<ITCHPcapSource> &src)
+{
+    src.reset(new ITCHPcapSource(l));
+    i01::net::pcap::UDPReader<ITCHPcapSource> reader(file, src.get());
+    while (reader.read_packets(1024) > 0) {
+    }
+}
+
+/// Forwards to two listeners.
+struct Tee : public NoopBookMuxListener {
+    Tee(BookMuxListener &a, BookMuxListener &b) : m_a(a), m_b(b) {}
+    virtual void on_symbol_definition(const SymbolDefEvent &e) override { m_a.on_symbol_definition(e); m_b.on_symbol_definition(e); }
+    virtual void on_l2_update(const L2BookEvent &e) override { m_a.on_l2_update(e); m_b.on_l2_update(e); }
+    virtual void on_trade(const TradeEvent &e) override { m_a.on_trade(e); m_b.on_trade(e); }
+    virtual void on_start_of_data(const PacketEvent &e) override { m_a.on_start_of_data(e); m_b.on_start_of_data(e); }
+    virtual void on_end_of_data(const PacketEvent &e) override { m_a.on_end_of_data(e); m_b.on_end_of_data(e); }
+    BookMuxListener &m_a;
+    BookMuxListener &m_b;
+};
+
+}
+
+TEST(md_archive, md_archive_round_trip)
+{
+    using namespace MD_ARCHIVE_TEST;
+    const std::string path = temp_path("round_trip");
+    const MIC xnys(MICEnum::XNYS);
+    const MIC bats(MICEnum::BATS);
+    L2Book book(xnys, 17);
+    L2Book other(bats, 3);
+    const std::string ticker("IBM");
+    {
+        Archive::Writer w(path);
+        w.on_symbol_definition(SymbolDefEvent{xnys, 17, ticker});
+        Timestamp ts(1412341200, 5);
+        w.on_start_of_data(PacketEvent{ts, xnys});
+        book.replace(true, 1000000, 300, 2, ts);
+        w.on_l2_update(L2BookEvent{ts, book, true, true, false, 1000000, 300, 2, 300, L2BookEvent::DeltaReasonCode::NEW_ORDER});
+        book.replace(false, 1000100, 100, 1, ts);
+        w.on_l2_update(L2BookEvent{ts, book, false, true, false, 1000100, 100, 1, 100, L2BookEvent::DeltaReasonCode::NEW_ORDER});
+        w.on_end_of_data(PacketEvent{ts, xnys});
+        const Timestamp ts2(1412341202, 7);
+        w.on_trade(TradeEvent{ts2, ts, book, 99, 1000100, 40, OrderBook::Order::Side::SELL, true, nullptr});
+        w.on_trading_status_update(TradingStatusEvent{ts2, other, TradingStatusEvent::Event::HALT});
+        const FeedEvent::EventCode code = FeedEvent::EventCode::END_OF_MESSAGES;
+        w.on_feed_event(FeedEvent{ts2, ts, bats, code});
+        const Timestamp ts3(1412341204, 0);
+        w.on_gap(GapEvent{ts3, bats, 10, 20, ts2});
+        book.replace(true, 1000000, 0, 0, ts3);
+        w.on_l2_update(L2BookEvent{ts3, book, true, true, true, 1000000, 0, 0, 300, L2BookEvent::DeltaReasonCode::CANCEL});
+        EXPECT_TRUE(w.close());
+        EXPECT_EQ(10U, w.header().num_records);
+    }
+
+    Archive::Reader r(path);
+    EXPECT_EQ(10U, r.size());
+    EXPECT_EQ(1U, r.header().num_symbols);
+    // a bucket for the symbol definition, then one per second with data
+    EXPECT_EQ(4U, r.header().num_index_entries);
+    EXPECT_EQ(1412341200000000005ULL, r.header().first_timestamp);
+    EXPECT_EQ(1412341204000000000ULL, r.header().last_timestamp);
+
+    EXPECT_EQ(0U, r.find(Timestamp(0, 0)));
+    EXPECT_EQ(1U, r.find(Timestamp(1412341200, 0)));
+    EXPECT_EQ(5U, r.find(Timestamp(1412341201, 0)));
+    EXPECT_EQ(8U, r.find(Timestamp(1412341203, 500)));
+    EXPECT_EQ(10U, r.find(Timestamp(1412341300, 0)));
+
+    struct Checker : public CountingListener {
+        virtual void on_trade(const TradeEvent &evt) override {
+            CountingListener::on_trade(evt);
+            EXPECT_EQ(99U, evt.m_trade_id);
+            EXPECT_EQ(40U, evt.m_size);
+            EXPECT_TRUE(evt.m_cross);
+            EXPECT_EQ(OrderBook::Order::Side::SELL, evt.m_passive_side);
+            EXPECT_EQ(1412341200, evt.m_exchange_timestamp.tv_sec);
+            EXPECT_EQ(17U, evt.m_book.symbol_index());
+            EXPECT_EQ(MIC(MICEnum::XNYS), evt.m_book.mic());
+        }
+        virtual void on_trading_status_update(const TradingStatusEvent &evt) override {
+            CountingListener::on_trading_status_update(evt);
+            EXPECT_EQ(TradingStatusEvent::Event::HALT, evt.m_event);
+            EXPECT_EQ(MIC(MICEnum::BATS), evt.m_book.mic());
+        }
+        virtual void on_gap(const GapEvent &evt) override {
+            CountingListener::on_gap(evt);
+            EXPECT_EQ(10U, evt.m_expected_seqnum);
+            EXPECT_EQ(20U, evt.m_received_seqnum);
+        }
+        virtual void on_feed_event(const FeedEvent &evt) override {
+            CountingListener::on_feed_event(evt);
+            EXPECT_EQ(FeedEvent::EventCode::END_OF_MESSAGES, evt.event_code);
+        }
+    } c;
+
+    EXPECT_EQ(5U, r.read_until(c, Timestamp(1412341201, 0)));
+    EXPECT_EQ(1U, c.symbols);
+    EXPECT_EQ("IBM", c.last_ticker);
+    EXPECT_EQ(2U, c.levels);
+    EXPECT_EQ(2U, c.bbo);
+    ASSERT_NE(nullptr, r.book(xnys, 17));
+    EXPECT_EQ(FullSummary(Summary(1000000, 300, 2), Summary(1000100, 100, 1)), r.book(xnys, 17)->best());
+
+    EXPECT_EQ(5U, r.read_records(c));
+    EXPECT_TRUE(r.done());
+    EXPECT_EQ(1U, c.trades);
+    EXPECT_EQ(1U, c.statuses);
+    EXPECT_EQ(1U, c.feeds);
+    EXPECT_EQ(1U, c.gaps);
+    EXPECT_EQ(3U, c.levels);
+    EXPECT_EQ(Summary(BookBase::EMPTY_BID_PRICE, 0, 0), r.book(xnys, 17)->best_bid());
+    EXPECT_EQ(nullptr, r.book(MIC(MICEnum::EDGX), 17));
+
+    // skipping rebuilds the books without callbacks
+    r.rewind();
+    CountingListener quiet;
+    EXPECT_EQ(5U, r.skip_until(Timestamp(1412341201, 0)));
+    EXPECT_EQ(0U, quiet.events());
+    EXPECT_EQ(FullSummary(Summary(1000000, 300, 2), Summary(1000100, 100, 1)), r.book(xnys, 17)->best());
+
+    ::unlink(path.c_str());
+}
+
+TEST(md_archive, md_archive_l3_round_trip)
+{
+    using namespace MD_ARCHIVE_TEST;
+    using Order = OrderBook::Order;
+    const std::string path = temp_path("l3_round_trip");
+    const MIC xnas(MICEnum::XNAS);
+    OrderBook book(xnas, 5);
+    const Timestamp ts(1412341200, 0);
+    const Timestamp ets(1412341199, 0);
+    {
+        Archive::Writer w(path);
+        w.on_symbol_definition(SymbolDefEvent{xnas, 5, "AAPL"});
+        w.on_start_of_data(PacketEvent{ts, xnas});
+        const Order a(11, Order::Side::BUY, 1000000, 300, Order::TimeInForce::DAY, ts, ts);
+        const Order b(12, Order::Side::SELL, 1000100, 200, Order::TimeInForce::DAY, ts, ts);
+        w.on_book_added(L3AddEvent{ts, book, a});
+        w.on_book_added(L3AddEvent{ts, book, b});
+        const Order a_left(11, Order::Side::BUY, 1000000, 100, Order::TimeInForce::DAY, ts, ts);
+        w.on_book_canceled(L3CancelEvent{ts, book, a_left, 300});
+        const Order c(13, Order::Side::SELL, 1000200, 250, Order::TimeInForce::DAY, ts, ts);
+        w.on_book_modified(L3ModifyEvent{ts, book, c, 12, 1000100, 200});
+        const Order c_left(13, Order::Side::SELL, 1000200, 0, Order::TimeInForce::DAY, ts, ts);
+        w.on_book_executed(L3ExecutionEvent{ts, ets, book, c_left, 77, 1000150, 250, 250, true});
+        w.on_trade(TradeEvent{ts, ets, book, 78, 1000000, 10, Order::Side::BUY, false, nullptr});
+        w.on_end_of_data(PacketEvent{ts, xnas});
+        EXPECT_TRUE(w.close());
+    }
+
+    struct Checker : public CountingListener {
+        virtual void on_book_added(const L3AddEvent &evt) override {
+            ++adds;
+            EXPECT_EQ(MIC(MICEnum::XNAS), evt.m_book.mic());
+            EXPECT_EQ(5U, evt.m_book.symbol_index());
+            refnums += evt.m_order.refnum;
+        }
+        virtual void on_book_canceled(const L3CancelEvent &evt) override {
+            ++cancels;
+            EXPECT_EQ(11U, evt.m_order.refnum);
+            EXPECT_EQ(100U, evt.m_order.size);
+            EXPECT_EQ(300U, evt.m_old_size);
+            EXPECT_EQ(1000000U, evt.m_order.price);
+        }
+        virtual void on_book_modified(const L3ModifyEvent &evt) override {
+            ++modifies;
+            EXPECT_EQ(13U, evt.m_new_order.refnum);
+            EXPECT_EQ(1000200U, evt.m_new_order.price);
+            EXPECT_EQ(250U, evt.m_new_order.size);
+            EXPECT_EQ(OrderBook::Order::Side::SELL, evt.m_new_order.side);
+            EXPECT_EQ(12U, evt.m_old_refnum);
+            EXPECT_EQ(1000100U, evt.m_old_price);
+            EXPECT_EQ(200U, evt.m_old_size);
+        }
+        virtual void on_book_executed(const L3ExecutionEvent &evt) override {
+            ++executions;
+            EXPECT_EQ(13U, evt.m_order.refnum);
+            EXPECT_EQ(0U, evt.m_order.size);
+            EXPECT_EQ(250U, evt.m_old_size);
+            EXPECT_EQ(250U, evt.m_exec_size);
+            EXPECT_EQ(1000150U, evt.m_exec_price);
+            EXPECT_EQ(77U, evt.m_trade_id);
+            EXPECT_TRUE(evt.m_nonprintable);
+            EXPECT_EQ(1412341199, evt.m_exchange_timestamp.tv_sec);
+        }
+        virtual void on_trade(const TradeEvent &evt) override {
+            CountingListener::on_trade(evt);
+            // the venue's book is the order book
+            trade_book = &evt.m_book;
+        }
+        std::uint64_t adds = 0, cancels = 0, modifies = 0, executions = 0, refnums = 0;
+        const BookBase *trade_book = nullptr;
+    } c;
+
+    Archive::Reader r(path);
+    EXPECT_EQ(9U, r.read_records(c));
+    EXPECT_EQ(2U, c.adds);
+    EXPECT_EQ(23U, c.refnums);
+    EXPECT_EQ(1U, c.cancels);
+    EXPECT_EQ(1U, c.modifies);
+    EXPECT_EQ(1U, c.executions);
+    EXPECT_EQ(1U, c.trades);
+    EXPECT_EQ(0U, c.levels);
+    ASSERT_NE(nullptr, r.l3_book(xnas, 5));
+    EXPECT_EQ(r.l3_book(xnas, 5), c.trade_book);
+    EXPECT_EQ(nullptr, r.book(xnas, 5));
+    const Order *a = r.l3_book(xnas, 5)->find(11);
+    ASSERT_NE(nullptr, a);
+    EXPECT_EQ(100U, a->size);
+    EXPECT_EQ(nullptr, r.l3_book(xnas, 5)->find(12));
+    EXPECT_EQ(nullptr, r.l3_book(xnas, 5)->find(13));
+
+    // skipping rebuilds the order books too
+    r.rewind();
+    EXPECT_EQ(9U, r.skip_until(Timestamp(1412341201, 0)));
+    ASSERT_NE(nullptr, r.l3_book(xnas, 5));
+    ASSERT_NE(nullptr, r.l3_book(xnas, 5)->find(11));
+    EXPECT_EQ(100U, r.l3_book(xnas, 5)->find(11)->size);
+
+    ::unlink(path.c_str());
+}
+
+TEST(md_archive, md_archive_rejects_incomplete)
+{
+    using namespace MD_ARCHIVE_TEST;
+    const std::string path = temp_path("incomplete");
+    EXPECT_THROW(Archive::Reader r(path), std::runtime_error);
+
+    const MIC xnas(MICEnum::XNAS);
+    std::unique_ptr<Archive::Writer> w(new Archive::Writer(path));
+    w->on_start_of_data(PacketEvent{Timestamp(1, 0), xnas});
+    // not closed: no magic number yet
+    EXPECT_THROW(Archive::Reader r(path), std::runtime_error);
+    EXPECT_TRUE(w->close());
+    EXPECT_NO_THROW(Archive::Reader r(path));
+
+    // truncated
+    ASSERT_EQ(0, ::truncate(path.c_str(), sizeof(Archive::ArchiveHeader) + 10));
+    EXPECT_THROW(Archive::Reader r(path), std::runtime_error);
+    ::unlink(path.c_str());
+}
+
+TEST(md_archive, md_archive_xnas_replay_matches_pcap)
+{
+    using namespace MD_ARCHIVE_TEST;
+    for (const auto &file : xnas_files()) {
+        const std::string path = temp_path("xnas");
+        CountingListener live;
+        std::unique_ptr<ITCHPcapSource> src;
+        {
+            Archive::Writer w(path);
+            Tee tee(live, w);
+            read_pcap(file, tee, src);
+            ASSERT_TRUE(w.close());
+        }
+
+        Archive::Reader r(path);
+        CountingListener replayed;
+        EXPECT_EQ(r.size(), r.read_records(replayed));
+        EXPECT_EQ(live.events(), replayed.events());
+        EXPECT_EQ(live.symbols, replayed.symbols);
+        EXPECT_EQ(live.levels, replayed.levels);
+        EXPECT_EQ(live.bbo, replayed.bbo);
+        EXPECT_EQ(live.trades, replayed.trades);
+        EXPECT_EQ(live.packets, replayed.packets);
+        EXPECT_EQ(live.checksum, replayed.checksum);
+        EXPECT_GT(live.levels, 0U);
+
+        std::size_t books = 0;
+        for (std::uint32_t locate = 0; locate < static_cast<std::uint32_t>(NUM_SYMBOL_INDEX); ++locate) {
+            const L2Book *a = src->book(static_cast<std::uint16_t>(locate));
+            const L2Book *b = r.book(MIC(MICEnum::XNAS), locate);
+            ASSERT_EQ(nullptr == a, nullptr == b);
+            if (a) {
+                ++books;
+                EXPECT_EQ(a->best(), b->best()) << "locate " << locate;
+            }
+        }
+        EXPECT_GT(books, 0U);
+        ::unlink(path.c_str());
+    }
+}
+
+TEST(md_archive, md_archive_replay_benchmark)
+{
+    using namespace MD_ARCHIVE_TEST;
+    const std::string path = temp_path("bench");
+    {
+        Archive::Writer w(path);
+        std::unique_ptr<ITCHPcapSource> src;
+        for (const auto &file : xnas_files()) {
+            read_pcap(file, w, src);
+        }
+        ASSERT_TRUE(w.close());
+    }
+
+    const int passes = 20;
+    std::uint64_t pcap_events = 0, archive_events = 0;
+
+    i01::core::MonotonicTimer t;
+    t.start();
+    for (int i = 0; i < passes; ++i) {
+        CountingListener l;
+        std::unique_ptr<ITCHPcapSource> src;
+        for (const auto &file : xnas_files()) {
+            read_pcap(file, l, src);
+        }
+        pcap_events += l.events();
+    }
+    t.stop();
+    const std::uint64_t pcap_cycles = t.interval();
+
+    t.start();
+    for (int i = 0; i < passes; ++i) {
+        CountingListener l;
+        Archive::Reader r(path);
+        r.read_records(l);
+        archive_events += l.events();
+    }
+    t.stop();
+    const std::uint64_t archive_cycles = t.interval();
+
+    EXPECT_EQ(pcap_events, archive_events);
+    std::cout << "Events: " << pcap_events / passes
+              << ", pcap cycles/event: " << static_cast<double>(pcap_cycles) / pcap_events
+              << ", archive cycles/event: " << static_cast<double>(archive_cycles) / archive_events
+              << ", speedup: " << static_cast<double>(pcap_cycles) / archive_cycles << std::endl;
+    ::unlink(path.c_str());
+}
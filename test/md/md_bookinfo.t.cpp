@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <i01_core/Lock.hpp>
+#include <i01_core/macro.hpp>
+#include <i01_core/MIC.hpp>
+#include <i01_core/Time.hpp>
+
+#include <i01_md/BookInfoTable.hpp>
+#include <i01_md/L2Book.hpp>
+
+using i01::core::MonotonicTimer;
+using i01::core::Timestamp;
+using namespace i01::MD;
+
+namespace MD_BOOKINFO_TEST {
+
+const std::size_t NUM_SYMBOLS = 8192;
+const std::size_t NUM_MESSAGES = 4000000;
+
+/// The interleaved per-ESI layout BookMuxBase used before BookInfoTable.
+struct InterleavedBookInfo {
+    BookBase *book_p;
+    SymbolState state;
+    LastSale last_sale;
+    i01::core::SpinRWMutex mutex;
+};
+
+/// Skewed symbol activity, as on a real feed: a few hundred names carry
+//  most of the messages.
+std::vector<EphemeralSymbolIndex> make_esi_sequence()
+{
+    std::mt19937_64 rng(20150218);
+    std::vector<EphemeralSymbolIndex> seq;
+    seq.reserve(NUM_MESSAGES);
+    for (std::size_t i = 0; i < NUM_MESSAGES; i++) {
+        auto r = rng();
+        auto esi = (r % 4 == 0) ? r % NUM_SYMBOLS : (r >> 8) % 512 * 13 % NUM_SYMBOLS;
+        seq.push_back(static_cast<EphemeralSymbolIndex>(esi));
+    }
+    return seq;
+}
+
+/// Per-message hot path: find the book, read its top of book, and record
+//  a last sale for one message in eight.
+template <typename BookFn, typename LastSaleFn, typename PrefetchFn>
+double cycles_per_message(const std::vector<EphemeralSymbolIndex> &seq, BookFn book, LastSaleFn last_sale, PrefetchFn prefetch)
+{
+    const Timestamp ts{1, 0};
+    std::uint64_t sum = 0;
+    MonotonicTimer t;
+    t.start();
+    for (std::size_t i = 0; i < seq.size(); i++) {
+        if (LIKELY(i + 1 < seq.size())) {
+            prefetch(seq[i + 1]);
+        }
+        const auto esi = seq[i];
+        const BookBase *b = book(esi);
+        sum += b->symbol_index() + std::get<0>(b->best().first);
+        if ((i & 7) == 0) {
+            last_sale(esi) = LastSale{ static_cast<Price>(i), ts };
+        }
+    }
+    t.stop();
+    EXPECT_GT(sum, 0U);
+    return static_cast<double>(t.interval()) / seq.size();
+}
+
+}
+
+TEST(md_bookinfo, md_bookinfo_table_accessors)
+{
+    using namespace MD_BOOKINFO_TEST;
+    std::unique_ptr<BookInfoTable<NUM_SYMBOLS>> table(new BookInfoTable<NUM_SYMBOLS>());
+    EXPECT_TRUE(nullptr == table->book(0));
+    EXPECT_TRUE(nullptr == table->book(NUM_SYMBOLS - 1));
+
+    L2Book book(i01::core::MIC{}, 42);
+    table->book(42) = &book;
+    EXPECT_EQ(table->book(42), &book);
+    table->prefetch(42);
+    table->prefetch_book(42);
+    table->prefetch_book(43);
+
+    table->last_sale(42) = LastSale{ 100, Timestamp{1, 0} };
+    EXPECT_NE(&table->last_sale(42), &table->last_sale(43));
+    EXPECT_GE(reinterpret_cast<std::uintptr_t>(&table->mutex(1)) - reinterpret_cast<std::uintptr_t>(&table->mutex(0)), 64U);
+}
+
+TEST(md_bookinfo, md_bookinfo_layout_benchmark)
+{
+    using namespace MD_BOOKINFO_TEST;
+    const auto seq = make_esi_sequence();
+
+    std::vector<std::unique_ptr<L2Book>> books;
+    for (std::size_t i = 0; i < NUM_SYMBOLS; i++) {
+        books.emplace_back(new L2Book(i01::core::MIC{}, static_cast<SymbolIndex>(i)));
+    }
+
+    std::unique_ptr<InterleavedBookInfo[]> aos(new InterleavedBookInfo[NUM_SYMBOLS]);
+    std::unique_ptr<BookInfoTable<NUM_SYMBOLS>> soa(new BookInfoTable<NUM_SYMBOLS>());
+    for (std::size_t i = 0; i < NUM_SYMBOLS; i++) {
+        aos[i].book_p = books[i].get();
+        soa->book(static_cast<EphemeralSymbolIndex>(i)) = books[i].get();
+    }
+
+    auto no_prefetch = [](EphemeralSymbolIndex) {};
+    const auto before = cycles_per_message(seq,
+            [&](EphemeralSymbolIndex esi) { return aos[esi].book_p; },
+            [&](EphemeralSymbolIndex esi) -> LastSale & { return aos[esi].last_sale; },
+            no_prefetch);
+    const auto after = cycles_per_message(seq,
+            [&](EphemeralSymbolIndex esi) { return soa->book(esi); },
+            [&](EphemeralSymbolIndex esi) -> LastSale & { return soa->last_sale(esi); },
+            no_prefetch);
+    const auto after_prefetch = cycles_per_message(seq,
+            [&](EphemeralSymbolIndex esi) { return soa->book(esi); },
+            [&](EphemeralSymbolIndex esi) -> LastSale & { return soa->last_sale(esi); },
+            [&](EphemeralSymbolIndex esi) { soa->prefetch(esi); soa->prefetch_book(esi); });
+
+    std::cout << "Per-message book info cost over " << seq.size() << " messages, " << NUM_SYMBOLS << " symbols:" << std::endl
+              << "  interleaved:          " << before << " cycles/msg (" << sizeof(InterleavedBookInfo) << " bytes/entry)" << std::endl
+              << "  hot/cold:             " << after << " cycles/msg (" << sizeof(BookInfoTable<NUM_SYMBOLS>::HotInfo) << " bytes/hot entry)" << std::endl
+              << "  hot/cold + prefetch:  " << after_prefetch << " cycles/msg" << std::endl;
+}
@@ -0,0 +1,277 @@
+#include <gtest/gtest.h>
+
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <i01_core/MIC.hpp>
+#include <i01_core/Time.hpp>
+
+#include <i01_md/BookMuxListener.hpp>
+#include <i01_md/DecoderEvents.hpp>
+#include <i01_md/L2Book.hpp>
+#include <i01_md/MLBookMux.hpp>
+
+using i01::core::MonotonicTimer;
+using i01::core::Timestamp;
+using namespace i01::MD;
+
+namespace MD_BOOKMUX_BATCH_TEST {
+
+/// Counts per-event book updates, like any existing strategy.
+class CountingListener : public NoopBookMuxListener {
+public:
+    virtual void on_l2_update(const L2BookEvent &e) override {
+        ++m_updates;
+        m_sum += e.m_price;
+    }
+    virtual void on_trade(const TradeEvent &) override { ++m_trades; }
+    virtual void on_start_of_data(const PacketEvent &) override { ++m_packets; }
+
+    int m_updates = 0;
+    int m_trades = 0;
+    int m_packets = 0;
+    Price m_sum = 0;
+};
+
+/// Opts in to batching.
+class BatchingListener : public CountingListener {
+public:
+    void on_book_batch(const BookBatchEvent &e) {
+        m_batches.push_back(std::vector<BookBatchEntry>(e.begin(), e.end()));
+        m_events.push_back(std::vector<BookBatchItem>(e.m_events, e.m_events + e.m_num_events));
+        m_end_of_packet.push_back(e.m_end_of_packet);
+    }
+    virtual void on_end_of_data(const PacketEvent &) override { m_ends.push_back(m_batches.size()); }
+
+    std::vector<std::vector<BookBatchEntry>> m_batches;
+    std::vector<std::vector<BookBatchItem>> m_events;
+    std::vector<bool> m_end_of_packet;
+    std::vector<std::size_t> m_ends;
+};
+
+/// Opts in to batching and reads the new top of each changed symbol.
+class TopListener : public NoopBookMuxListener {
+public:
+    void on_book_batch(const BookBatchEvent &e) {
+        for (const auto &entry : e) {
+            if (entry.m_top_changed) {
+                ++m_symbols;
+                m_sum += std::get<0>(entry.m_best.first);
+            }
+        }
+    }
+
+    int m_symbols = 0;
+    Price m_sum = 0;
+};
+
+/// Reads the top of book on every update, as strategies do without
+//  batching.
+class PerEventTopListener : public NoopBookMuxListener {
+public:
+    virtual void on_l2_update(const L2BookEvent &e) override {
+        const FullSummary best = e.m_book.best();
+        if (best != m_last) {
+            ++m_symbols;
+            m_sum += std::get<0>(best.first);
+            m_last = best;
+        }
+    }
+
+    int m_symbols = 0;
+    Price m_sum = 0;
+    FullSummary m_last;
+};
+
+/// Stands in for a feed's BookMux: applies L2 updates and notifies.
+template<typename... Listeners>
+class TestMux : public MLBookMux<L2Book, Listeners...> {
+public:
+    using Base = MLBookMux<L2Book, Listeners...>;
+    using Listener = typename Base::Listener;
+
+    TestMux(Listeners*... l) : Base(i01::core::MIC{}, l...) {}
+
+    void start(const Timestamp &ts) { this->on_raw_msg(ts, StartOfPktMsg(), 0, 0); }
+    void end(const Timestamp &ts) { this->on_raw_msg(ts, EndOfPktMsg(), 0, 0); }
+
+    void update(const Timestamp &ts, EphemeralSymbolIndex esi, bool is_bid, Price p, Size s) {
+        auto *b = this->create_book_for_symbol(esi);
+        b->replace(is_bid, p, s, 1, ts);
+        this->notify(&Listener::on_l2_update, L2BookEvent{ts, *b, is_bid, false, false, p, s, 1, s, L2BookEvent::DeltaReasonCode::NONE});
+    }
+
+    void trade(const Timestamp &ts, EphemeralSymbolIndex esi, Price p) {
+        auto *b = this->create_book_for_symbol(esi);
+        this->notify(&Listener::on_trade, TradeEvent{ts, ts, *b, 0, p, 100, TradeEvent::PassiveSide::UNKNOWN, false, nullptr});
+    }
+};
+
+struct Update {
+    EphemeralSymbolIndex esi;
+    Price price;
+};
+
+const int MSGS_PER_PACKET = 30;
+
+template<typename Mux>
+double replay(Mux &mux, const std::vector<Update> &msgs)
+{
+    const Timestamp ts{1, 0};
+    MonotonicTimer t;
+    t.start();
+    for (std::size_t i = 0; i < msgs.size(); i += MSGS_PER_PACKET) {
+        mux.start(ts);
+        for (std::size_t j = i; j < i + MSGS_PER_PACKET; j++) {
+            mux.update(ts, msgs[j].esi, true, msgs[j].price, 100);
+        }
+        mux.end(ts);
+    }
+    t.stop();
+    return static_cast<double>(t.interval()) * MSGS_PER_PACKET / msgs.size();
+}
+
+}
+
+TEST(md_bookmux_batch, md_bookmux_batch_disabled_is_per_event)
+{
+    using namespace MD_BOOKMUX_BATCH_TEST;
+    BatchingListener bl;
+    TestMux<BatchingListener> mux(&bl);
+    EXPECT_FALSE(mux.batching());
+
+    const Timestamp ts{1, 0};
+    mux.start(ts);
+    mux.update(ts, 1, true, 1000, 100);
+    mux.update(ts, 1, true, 1100, 100);
+    mux.end(ts);
+    EXPECT_EQ(bl.m_updates, 2);
+    EXPECT_TRUE(bl.m_batches.empty());
+}
+
+TEST(md_bookmux_batch, md_bookmux_batch_coalesces_per_symbol)
+{
+    using namespace MD_BOOKMUX_BATCH_TEST;
+    CountingListener cl;
+    BatchingListener bl;
+    TestMux<CountingListener, BatchingListener> mux(&cl, &bl);
+    mux.batching(true);
+    ASSERT_TRUE(mux.batching());
+
+    const Timestamp t1{1, 0}, t2{1, 5}, t3{1, 9};
+    mux.start(t1);
+    mux.update(t1, 7, true, 1000, 100);
+    mux.update(t2, 3, false, 1200, 100);
+    mux.update(t2, 7, true, 900, 200);
+    mux.update(t3, 7, false, 1300, 300);
+    EXPECT_TRUE(bl.m_batches.empty());
+    mux.end(t3);
+
+    // per-event listeners are unaffected, batch listeners only get the batch
+    EXPECT_EQ(cl.m_updates, 4);
+    EXPECT_EQ(bl.m_updates, 0);
+    EXPECT_EQ(bl.m_packets, 1);
+
+    ASSERT_EQ(bl.m_batches.size(), 1U);
+    ASSERT_EQ(bl.m_ends.size(), 1U);
+    EXPECT_EQ(bl.m_ends[0], 1U);
+    EXPECT_TRUE(bl.m_end_of_packet[0]);
+
+    const auto &batch = bl.m_batches[0];
+    ASSERT_EQ(batch.size(), 2U);
+    EXPECT_EQ(batch[0].m_esi, 7U);
+    EXPECT_EQ(batch[0].m_num_events, 3U);
+    EXPECT_EQ(batch[0].m_sides, BookBatchEntry::BID | BookBatchEntry::ASK);
+    EXPECT_TRUE(batch[0].m_top_changed);
+    EXPECT_EQ(batch[0].m_first_timestamp, t1);
+    EXPECT_EQ(batch[0].m_last_timestamp, t3);
+    EXPECT_EQ(std::get<0>(batch[0].m_best.first), 1000U);
+    EXPECT_EQ(std::get<0>(batch[0].m_best.second), 1300U);
+    EXPECT_EQ(batch[1].m_esi, 3U);
+    EXPECT_EQ(batch[1].m_num_events, 1U);
+    EXPECT_EQ(batch[1].m_sides, BookBatchEntry::ASK);
+
+    // and the events themselves, in feed order
+    const auto &events = bl.m_events[0];
+    ASSERT_EQ(events.size(), 4U);
+    const Price prices[] = {1000, 1200, 900, 1300};
+    for (std::size_t i = 0; i < events.size(); i++) {
+        EXPECT_EQ(events[i].m_type, BookBatchItem::Type::L2_UPDATE);
+        EXPECT_EQ(events[i].l2_update().m_price, prices[i]);
+    }
+    EXPECT_EQ(events[1].l2_update().m_book.symbol_index(), 3U);
+    EXPECT_FALSE(events[1].l2_update().m_is_buy);
+    EXPECT_EQ(events[2].l2_update().m_size, 200U);
+    EXPECT_EQ(events[3].l2_update().m_timestamp, t3);
+
+    // a level below the top changes, the top does not
+    mux.start(t3);
+    mux.update(t3, 7, true, 800, 100);
+    mux.end(t3);
+    ASSERT_EQ(bl.m_batches.size(), 2U);
+    ASSERT_EQ(bl.m_batches[1].size(), 1U);
+    EXPECT_FALSE(bl.m_batches[1][0].m_top_changed);
+}
+
+TEST(md_bookmux_batch, md_bookmux_batch_flushes_before_unbatched_events)
+{
+    using namespace MD_BOOKMUX_BATCH_TEST;
+    BatchingListener bl;
+    TestMux<BatchingListener> mux(&bl);
+    mux.batching(true);
+
+    const Timestamp ts{1, 0};
+    mux.start(ts);
+    mux.update(ts, 1, true, 1000, 100);
+    mux.trade(ts, 1, 1000);
+    mux.update(ts, 1, true, 1000, 0);
+    mux.end(ts);
+
+    EXPECT_EQ(bl.m_trades, 1);
+    ASSERT_EQ(bl.m_batches.size(), 2U);
+    EXPECT_FALSE(bl.m_end_of_packet[0]);
+    EXPECT_TRUE(bl.m_end_of_packet[1]);
+    ASSERT_EQ(bl.m_events[1].size(), 1U);
+    EXPECT_EQ(bl.m_events[1][0].l2_update().m_size, 0U);
+
+    // and once the buffer is full
+    bl.m_batches.clear();
+    mux.start(ts);
+    const auto n = TestMux<BatchingListener>::BatchBuffer::capacity + 1;
+    for (std::size_t i = 0; i < n; i++) {
+        mux.update(ts, static_cast<EphemeralSymbolIndex>(i), false, 2000, 100);
+    }
+    mux.end(ts);
+    ASSERT_EQ(bl.m_batches.size(), 2U);
+    EXPECT_EQ(bl.m_batches[0].size(), n - 1);
+    EXPECT_EQ(bl.m_batches[1].size(), 1U);
+}
+
+TEST(md_bookmux_batch, md_bookmux_batch_benchmark)
+{
+    using namespace MD_BOOKMUX_BATCH_TEST;
+    const int NUM_PACKETS = 100000;
+    const int NUM_SYMBOLS = 8;
+
+    std::mt19937 rng(20150301);
+    std::vector<Update> msgs;
+    for (int i = 0; i < NUM_PACKETS * MSGS_PER_PACKET; i++) {
+        msgs.push_back(Update{ static_cast<EphemeralSymbolIndex>(rng() % NUM_SYMBOLS), 1000 + rng() % 16 });
+    }
+
+    PerEventTopListener pl1, pl2;
+    TestMux<PerEventTopListener, PerEventTopListener> per_event(&pl1, &pl2);
+    TopListener tl1, tl2;
+    TestMux<TopListener, TopListener> batched(&tl1, &tl2);
+    batched.batching(true);
+
+    const auto per_event_cycles = replay(per_event, msgs);
+    const auto batched_cycles = replay(batched, msgs);
+    EXPECT_GT(pl1.m_symbols, 0);
+    EXPECT_GT(tl1.m_symbols, 0);
+
+    std::cout << MSGS_PER_PACKET << " book updates per packet, " << NUM_SYMBOLS << " symbols, 2 listeners:" << std::endl
+              << "  per-event: " << per_event_cycles << " cycles/packet" << std::endl
+              << "  batched:   " << batched_cycles << " cycles/packet" << std::endl;
+}
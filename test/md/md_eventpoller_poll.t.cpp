@@ -0,0 +1,278 @@
+#include <gtest/gtest.h>
+
+#include <time.h>
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include <i01_core/Config.hpp>
+#include <i01_core/Time.hpp>
+#include <i01_core/TimerListener.hpp>
+
+#include <i01_net/EventPoller.hpp>
+#include <i01_net/SocketListener.hpp>
+#include <i01_net/UDPSocket.hpp>
+
+namespace MD_EVENTPOLLER_POLL_TEST {
+
+using i01::core::Timestamp;
+using i01::net::EpollEventPoller;
+using i01::net::PollMode;
+using i01::net::UDPSocket;
+
+const char LOCAL[] = "127.0.0.1";
+
+class Counter : public i01::net::SocketListener {
+public:
+    std::uint64_t packets = 0;
+
+    virtual void on_connected(const Timestamp&, void *) override {}
+    virtual void on_peer_disconnect(const Timestamp&, void *) override {}
+    virtual void on_local_disconnect(const Timestamp&, void *) override {}
+    virtual void on_recv(const Timestamp&, void *, const std::uint8_t *, const ssize_t &) override { ++packets; }
+};
+
+class Ticker : public i01::core::TimerListener {
+public:
+    std::uint64_t fires = 0;
+
+    virtual void on_timer(const Timestamp&, void *, std::uint64_t iter) override { fires += iter; }
+};
+
+/// A loopback UDP pair: rx added to poller, tx sending to it.
+struct Loopback {
+    Counter counter;
+    UDPSocket tx;
+
+    Loopback(EpollEventPoller& poller, std::uint16_t port) : tx(false)
+    {
+        UDPSocket rx;
+        EXPECT_TRUE(rx.set_reuseaddr());
+        EXPECT_TRUE(rx.bind(port, LOCAL));
+        EXPECT_TRUE(poller.add_socket(counter, nullptr, rx.fd().transfer_ownership()));
+        tx.set_peer(LOCAL, port);
+    }
+
+    void send()
+    {
+        const std::uint64_t x = 0;
+        EXPECT_EQ(static_cast<ssize_t>(sizeof(x)), tx.send(&x, sizeof(x)));
+    }
+};
+
+std::uint64_t elapsed_ns(const Timestamp& start)
+{
+    const Timestamp d(Timestamp::now() - start);
+    return static_cast<std::uint64_t>(d.tv_sec) * 1000000000ULL + static_cast<std::uint64_t>(d.tv_nsec);
+}
+
+std::uint64_t thread_cpu_ns()
+{
+    struct timespec ts;
+    ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<std::uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<std::uint64_t>(ts.tv_nsec);
+}
+
+/// Today at hh:mm:ss local time.
+Timestamp local_time(int hh, int mm, int ss)
+{
+    time_t now = ::time(nullptr);
+    struct tm lt;
+    ::localtime_r(&now, &lt);
+    lt.tm_hour = hh;
+    lt.tm_min = mm;
+    lt.tm_sec = ss;
+    lt.tm_isdst = -1;
+    return Timestamp(::mktime(&lt), 0);
+}
+
+}
+
+TEST(md_eventpoller_poll, backoff)
+{
+    using namespace MD_EVENTPOLLER_POLL_TEST;
+
+    EpollEventPoller poller("polltest");
+    EXPECT_EQ(PollMode::SPIN, poller.poll_mode());
+    EXPECT_FALSE(poller.poll_mode(PollMode::BACKOFF, 10, 0));
+    ASSERT_TRUE(poller.poll_mode(PollMode::BACKOFF, 10, 5));
+    EXPECT_EQ(PollMode::BACKOFF, poller.effective_poll_mode());
+    Loopback lb(poller, 31030);
+    const auto& stats = poller.poll_stats();
+
+    // spins spin_count times, then blocks for wait_ms at a time:
+    auto start = Timestamp::now();
+    for (int i = 0; i < 10; ++i)
+        ASSERT_TRUE(poller.run());
+    EXPECT_EQ(10u, stats.empty.load());
+    EXPECT_EQ(0u, stats.blocking.load());
+    EXPECT_LT(elapsed_ns(start), 5000000u);
+    start = Timestamp::now();
+    ASSERT_TRUE(poller.run());
+    ASSERT_TRUE(poller.run());
+    EXPECT_EQ(2u, stats.blocking.load());
+    EXPECT_GE(elapsed_ns(start), 9000000u);
+
+    // a blocked poll returns as soon as there is data, and spinning
+    // starts over:
+    lb.send();
+    start = Timestamp::now();
+    ASSERT_TRUE(poller.run());
+    EXPECT_EQ(1u, lb.counter.packets);
+    EXPECT_EQ(1u, stats.productive.load());
+    EXPECT_EQ(3u, stats.blocking.load());
+    for (int i = 0; i < 10; ++i)
+        ASSERT_TRUE(poller.run());
+    EXPECT_EQ(3u, stats.blocking.load());
+    EXPECT_EQ(22u, stats.empty.load());
+}
+
+TEST(md_eventpoller_poll, spin_never_blocks)
+{
+    using namespace MD_EVENTPOLLER_POLL_TEST;
+
+    EpollEventPoller poller("polltest");
+    ASSERT_TRUE(poller.poll_mode(PollMode::SPIN, 0));
+    Loopback lb(poller, 31031);
+    auto start = Timestamp::now();
+    for (int i = 0; i < 1000; ++i)
+        ASSERT_TRUE(poller.run());
+    EXPECT_LT(elapsed_ns(start), 100000000u);
+    EXPECT_EQ(0u, poller.poll_stats().blocking.load());
+    EXPECT_EQ(1000u, poller.poll_stats().empty.load());
+}
+
+TEST(md_eventpoller_poll, schedule)
+{
+    using namespace MD_EVENTPOLLER_POLL_TEST;
+
+    EpollEventPoller poller("polltest");
+    ASSERT_TRUE(poller.poll_mode(PollMode::ADAPTIVE));
+    EXPECT_EQ(PollMode::ADAPTIVE, poller.scheduled_poll_mode(local_time(12, 0, 0)));
+
+    poller.add_poll_schedule(16 * 3600 + 5 * 60, PollMode::BACKOFF);
+    poller.add_poll_schedule(9 * 3600 + 25 * 60, PollMode::SPIN);
+    ASSERT_EQ(2u, poller.poll_schedule().size());
+    EXPECT_EQ(9u * 3600 + 25 * 60, poller.poll_schedule().front().first);
+    EXPECT_EQ(PollMode::BACKOFF, poller.scheduled_poll_mode(local_time(3, 0, 0)));
+    EXPECT_EQ(PollMode::BACKOFF, poller.scheduled_poll_mode(local_time(9, 24, 59)));
+    EXPECT_EQ(PollMode::SPIN, poller.scheduled_poll_mode(local_time(9, 25, 0)));
+    EXPECT_EQ(PollMode::SPIN, poller.scheduled_poll_mode(local_time(16, 4, 59)));
+    EXPECT_EQ(PollMode::BACKOFF, poller.scheduled_poll_mode(local_time(16, 5, 0)));
+    EXPECT_EQ(PollMode::BACKOFF, poller.scheduled_poll_mode(local_time(23, 59, 59)));
+}
+
+TEST(md_eventpoller_poll, configure)
+{
+    using namespace MD_EVENTPOLLER_POLL_TEST;
+
+    auto cfg = i01::core::ConfigState::create();
+    cfg->emplace("poll_mode", "adaptive");
+    cfg->emplace("spin_count", "500");
+    cfg->emplace("wait_ms", "2");
+    cfg->emplace("spin_rate", "5000");
+    cfg->emplace("busy_poll_us", "50");
+    cfg->emplace("poll_schedule.1.at", "09:25");
+    cfg->emplace("poll_schedule.1.mode", "spin");
+    cfg->emplace("poll_schedule.2.at", "20:05:30");
+    cfg->emplace("poll_schedule.2.mode", "backoff");
+
+    EpollEventPoller poller("polltest");
+    ASSERT_TRUE(poller.configure(*cfg));
+    EXPECT_EQ(PollMode::ADAPTIVE, poller.poll_mode());
+    EXPECT_EQ(500u, poller.spin_count());
+    EXPECT_EQ(2, poller.wait_ms());
+    EXPECT_EQ(5000u, poller.spin_rate());
+    EXPECT_EQ(50, poller.busy_poll_us());
+    ASSERT_EQ(2u, poller.poll_schedule().size());
+    EXPECT_EQ(9u * 3600 + 25 * 60, poller.poll_schedule()[0].first);
+    EXPECT_EQ(PollMode::SPIN, poller.poll_schedule()[0].second);
+    EXPECT_EQ(20u * 3600 + 5 * 60 + 30, poller.poll_schedule()[1].first);
+    EXPECT_EQ(PollMode::BACKOFF, poller.poll_schedule()[1].second);
+
+    // SO_BUSY_POLL may need privileges, but the socket is still added:
+    Loopback lb(poller, 31032);
+
+    (*cfg)["poll_schedule.2.mode"] = "sometimes";
+    EXPECT_FALSE(poller.configure(*cfg));
+    (*cfg)["poll_schedule.2.mode"] = "spin";
+    (*cfg)["poll_schedule.2.at"] = "25:00";
+    EXPECT_FALSE(poller.configure(*cfg));
+    cfg->erase("poll_schedule.2.at");
+    cfg->erase("poll_schedule.2.mode");
+    (*cfg)["poll_mode"] = "nap";
+    EXPECT_FALSE(poller.configure(*cfg));
+}
+
+TEST(md_eventpoller_poll, timers)
+{
+    using namespace MD_EVENTPOLLER_POLL_TEST;
+
+    // a poll blocking for up to a second still wakes for the timers:
+    EpollEventPoller poller("polltest");
+    ASSERT_TRUE(poller.poll_mode(PollMode::BACKOFF, 0, 1000));
+    std::vector<Ticker> tickers(100);
+    EXPECT_FALSE(poller.add_timer(tickers[0], nullptr, Timestamp(), Timestamp(0, 5000000)));
+    for (auto& t : tickers)
+        ASSERT_TRUE(poller.add_timer(t, nullptr, Timestamp(0, 5000000), Timestamp(0, 5000000)));
+    const auto start = Timestamp::now();
+    while (tickers.back().fires < 10)
+        ASSERT_TRUE(poller.run());
+    EXPECT_GE(elapsed_ns(start), 49000000u);
+    EXPECT_LT(elapsed_ns(start), 500000000u);
+    for (const auto& t : tickers)
+        EXPECT_EQ(10u, t.fires);
+    EXPECT_GT(poller.poll_stats().blocking.load(), 0u);
+}
+
+TEST(md_eventpoller_poll, adaptive)
+{
+    using namespace MD_EVENTPOLLER_POLL_TEST;
+
+    EpollEventPoller poller("polltest");
+    ASSERT_TRUE(poller.poll_mode(PollMode::ADAPTIVE, 100, 1));
+    poller.spin_rate(1000);
+    EXPECT_EQ(PollMode::BACKOFF, poller.effective_poll_mode());
+    Loopback lb(poller, 31033);
+
+    // a busy second switches to spinning...
+    auto start = Timestamp::now();
+    while (elapsed_ns(start) < 2200000000ULL && PollMode::SPIN != poller.effective_poll_mode()) {
+        for (int i = 0; i < 10; ++i)
+            lb.send();
+        ASSERT_TRUE(poller.run());
+    }
+    EXPECT_EQ(PollMode::SPIN, poller.effective_poll_mode());
+    EXPECT_GE(poller.poll_stats().event_rate.load(), 1000u);
+
+    // ...and a quiet one back off:
+    start = Timestamp::now();
+    while (elapsed_ns(start) < 2200000000ULL && PollMode::BACKOFF != poller.effective_poll_mode())
+        ASSERT_TRUE(poller.run());
+    EXPECT_EQ(PollMode::BACKOFF, poller.effective_poll_mode());
+    EXPECT_EQ(2u, poller.poll_stats().switches.load());
+    std::cout << poller.status() << std::endl;
+}
+
+TEST(md_eventpoller_poll, benchmark)
+{
+    using namespace MD_EVENTPOLLER_POLL_TEST;
+
+    // CPU used by an idle poller:
+    for (PollMode mode : {PollMode::SPIN, PollMode::BACKOFF}) {
+        EpollEventPoller poller("polltest");
+        ASSERT_TRUE(poller.poll_mode(mode, 10000, 1));
+        Loopback lb(poller, 31034);
+        const auto cpu = thread_cpu_ns();
+        auto start = Timestamp::now();
+        while (elapsed_ns(start) < 300000000ULL)
+            ASSERT_TRUE(poller.run());
+        const double busy = static_cast<double>(thread_cpu_ns() - cpu) / static_cast<double>(elapsed_ns(start));
+
+        std::cout << mode << ": idle cpu " << busy * 100 << "%, " << poller.poll_stats() << std::endl;
+        if (PollMode::BACKOFF == mode) {
+            EXPECT_LT(busy, 0.5);
+        }
+    }
+}
@@ -0,0 +1,347 @@
+#include <gtest/gtest.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <i01_core/Time.hpp>
+
+#include <i01_net/EventPoller.hpp>
+#include <i01_net/SocketListener.hpp>
+#include <i01_net/UDPSocket.hpp>
+
+namespace MD_EVENTPOLLER_RECV_TEST {
+
+using i01::core::Timestamp;
+using i01::net::EpollEventPoller;
+using i01::net::RecvDescriptor;
+using i01::net::RecvLatencyHistogram;
+using i01::net::RecvMode;
+using i01::net::RecvTimestamping;
+using i01::net::UDPSocket;
+
+const char GROUP[] = "239.255.1.17";
+const char LOCAL[] = "127.0.0.1";
+
+struct Payload {
+    std::uint64_t seqnum;
+    std::int64_t sec;
+    std::int64_t nsec;
+};
+
+std::uint64_t to_ns(const Timestamp& ts)
+{
+    return static_cast<std::uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<std::uint64_t>(ts.tv_nsec);
+}
+
+class Recorder : public i01::net::SocketListener {
+public:
+    std::uint64_t packets = 0;
+    std::uint64_t batches = 0;
+    std::uint64_t max_batch = 0;
+    std::uint64_t out_of_order = 0;
+    std::uint64_t bad_len = 0;
+    std::uint64_t next_seqnum = 0;
+    /// Datagrams with a kernel timestamp, and those stamped after they
+    /// were dequeued.
+    std::uint64_t kernel_stamped = 0;
+    std::uint64_t bad_kernel_ts = 0;
+    std::vector<std::uint64_t> latency_ns;
+
+    virtual void on_connected(const Timestamp&, void *) override {}
+    virtual void on_peer_disconnect(const Timestamp&, void *) override {}
+    virtual void on_local_disconnect(const Timestamp&, void *) override {}
+
+    virtual void on_recv(const Timestamp&, void *, const std::uint8_t *buf, const ssize_t & len) override
+    {
+        ++batches;
+        max_batch = std::max<std::uint64_t>(max_batch, 1);
+        packet(buf, len);
+    }
+
+    virtual void on_recv_timestamped(const Timestamp& ts, void *, const std::uint8_t *buf, const ssize_t & len, const Timestamp& kernel_ts, const Timestamp&) override
+    {
+        ++batches;
+        max_batch = std::max<std::uint64_t>(max_batch, 1);
+        kernel(ts, kernel_ts);
+        packet(buf, len);
+    }
+
+    virtual void on_recv_batch(const Timestamp&, void *, const RecvDescriptor *descs, std::size_t n) override
+    {
+        ++batches;
+        max_batch = std::max<std::uint64_t>(max_batch, n);
+        for (std::size_t i = 0; i < n; ++i) {
+            kernel(descs[i].ts, descs[i].kernel_ts);
+            packet(descs[i].buf, descs[i].len);
+        }
+    }
+
+private:
+    void kernel(const Timestamp& ts, const Timestamp& kernel_ts)
+    {
+        if (0 == kernel_ts.tv_sec)
+            return;
+        ++kernel_stamped;
+        if (ts < kernel_ts)
+            ++bad_kernel_ts;
+    }
+
+    void packet(const std::uint8_t *buf, ssize_t len)
+    {
+        const Timestamp now(Timestamp::now());
+        if (len != static_cast<ssize_t>(sizeof(Payload))) {
+            ++bad_len;
+            return;
+        }
+        Payload p;
+        std::memcpy(&p, buf, sizeof(p));
+        if (p.seqnum != next_seqnum)
+            ++out_of_order;
+        next_seqnum = p.seqnum + 1;
+        ++packets;
+        latency_ns.push_back(to_ns(now) - to_ns(Timestamp(p.sec, p.nsec)));
+    }
+};
+
+/// A receive socket on GROUP joined on the loopback interface, or a plain
+/// loopback socket if the host can not loop back multicast.
+int receiver(std::uint16_t port, bool& multicast)
+{
+    auto u = UDPSocket::create_multicast_socket(LOCAL, std::string(GROUP) + ":" + std::to_string(port));
+    multicast = u.fd().valid();
+    if (!multicast) {
+        UDPSocket plain;
+        if (!plain.set_reuseaddr() || !plain.bind(port, LOCAL))
+            return -1;
+        plain.set_rcvbuf();
+        return plain.fd().transfer_ownership();
+    }
+    u.set_rcvbuf();
+    return u.fd().transfer_ownership();
+}
+
+struct Result {
+    std::uint64_t sent;
+    Recorder rec;
+    /// Time spent in the poller.
+    double seconds;
+    bool multicast;
+    /// Of the poller's socket, if timestamping.
+    RecvLatencyHistogram recv_latency;
+};
+
+/// Reads the poller's latency histograms from another thread until
+/// stopped, as a status thread does while the poller adds to them.
+class LatencyWatcher {
+public:
+    explicit LatencyWatcher(EpollEventPoller& poller)
+        : m_polling(true)
+        , m_seen(0)
+        , m_thread([this, &poller] {
+            while (m_polling.load()) {
+                RecvLatencyHistogram h;
+                poller.recv_latency(nullptr, h);
+                m_seen = std::max(m_seen, h.count());
+            }
+        }) {}
+    ~LatencyWatcher() { stop(); }
+
+    /// The largest count seen.
+    std::uint64_t stop()
+    {
+        m_polling = false;
+        if (m_thread.joinable())
+            m_thread.join();
+        return m_seen;
+    }
+
+private:
+    std::atomic<bool> m_polling;
+    std::uint64_t m_seen;
+    std::thread m_thread;
+};
+
+/// Send num_bursts bursts of burst datagrams, reading each burst with a
+/// poller in mode before sending the next, so that only the receive path
+/// is timed and the socket buffer never overflows.
+void run(RecvMode mode, std::uint16_t port, std::uint64_t num_bursts, std::uint32_t burst, Result& res,
+         RecvTimestamping timestamping = RecvTimestamping::NONE)
+{
+    EpollEventPoller poller("recvtest");
+    ASSERT_TRUE(poller.recv_mode(mode, 32));
+    poller.recv_timestamping(timestamping);
+    int fd = receiver(port, res.multicast);
+    ASSERT_GE(fd, 0);
+    ASSERT_TRUE(poller.add_socket(res.rec, nullptr, fd));
+    // the kernel turns on receive timestamping from a work queue, so the
+    // first datagrams after SO_TIMESTAMPING is set may not be stamped:
+    if (RecvTimestamping::NONE != timestamping)
+        ::usleep(50000);
+
+    UDPSocket tx(false);
+    if (res.multicast) {
+        ASSERT_TRUE(tx.set_multicast_interface(LOCAL));
+        ASSERT_TRUE(tx.set_multicast_loopback(true));
+        tx.set_peer(GROUP, port);
+    } else {
+        tx.set_peer(LOCAL, port);
+    }
+
+    LatencyWatcher watcher(poller);
+
+    res.sent = 0;
+    std::uint64_t busy_ns = 0;
+    Payload p{0, 0, 0};
+    for (std::uint64_t b = 0; b < num_bursts; ++b) {
+        for (std::uint32_t i = 0; i < burst; ++i) {
+            const Timestamp now(Timestamp::now());
+            p.sec = now.tv_sec;
+            p.nsec = now.tv_nsec;
+            ASSERT_EQ(static_cast<ssize_t>(sizeof(p)), tx.send(&p, sizeof(p)));
+            ++p.seqnum;
+        }
+        res.sent += burst;
+        const Timestamp start(Timestamp::now());
+        while (res.rec.packets < res.sent) {
+            ASSERT_TRUE(poller.run());
+            if ((Timestamp::now() - start).tv_sec >= 2)
+                break; // lost datagrams
+        }
+        busy_ns += to_ns(Timestamp::now() - start);
+    }
+    res.seconds = static_cast<double>(busy_ns) / 1e9;
+    const std::uint64_t seen = watcher.stop();
+    poller.recv_latency(nullptr, res.recv_latency);
+    EXPECT_LE(seen, res.recv_latency.count());
+}
+
+std::uint64_t percentile(std::vector<std::uint64_t> v, double p)
+{
+    if (v.empty())
+        return 0;
+    std::size_t i = static_cast<std::size_t>(p * (v.size() - 1));
+    std::nth_element(v.begin(), v.begin() + i, v.end());
+    return v[i];
+}
+
+}
+
+TEST(md_eventpoller_recv, recvmmsg_batches)
+{
+    using namespace MD_EVENTPOLLER_RECV_TEST;
+
+    Result res;
+    run(RecvMode::RECVMMSG, 31017, 20, 50, res);
+    EXPECT_EQ(res.sent, res.rec.packets);
+    EXPECT_EQ(0u, res.rec.bad_len);
+    EXPECT_EQ(0u, res.rec.out_of_order);
+    EXPECT_LT(res.rec.batches, res.rec.packets);
+    EXPECT_GT(res.rec.max_batch, 1u);
+    EXPECT_LE(res.rec.max_batch, 32u);
+}
+
+TEST(md_eventpoller_recv, recv_mode_config)
+{
+    using namespace MD_EVENTPOLLER_RECV_TEST;
+
+    EpollEventPoller poller("recvtest");
+    EXPECT_EQ(RecvMode::RECV, poller.recv_mode());
+    EXPECT_EQ(1u, poller.recv_batch());
+    EXPECT_FALSE(poller.recv_mode(RecvMode::RECVMMSG, 0));
+    EXPECT_FALSE(poller.recv_mode(RecvMode::RECVMMSG, 16, 0));
+    EXPECT_TRUE(poller.recv_mode(RecvMode::RECVMMSG, 16, 9000));
+    EXPECT_EQ(RecvMode::RECVMMSG, poller.recv_mode());
+    EXPECT_EQ(16u, poller.recv_batch());
+    EXPECT_EQ(9000u, poller.recv_buffer_size());
+}
+
+TEST(md_eventpoller_recv, kernel_timestamps)
+{
+    using namespace MD_EVENTPOLLER_RECV_TEST;
+
+    std::uint16_t port = 31020;
+    for (RecvMode mode : {RecvMode::RECV, RecvMode::RECVMMSG}) {
+        Result res;
+        run(mode, port++, 10, 50, res, RecvTimestamping::SOFTWARE);
+        EXPECT_EQ(res.sent, res.rec.packets) << mode;
+        EXPECT_EQ(res.rec.packets, res.rec.kernel_stamped) << mode;
+        EXPECT_EQ(0u, res.rec.bad_kernel_ts) << mode;
+        EXPECT_EQ(res.rec.packets, res.recv_latency.count()) << mode;
+        EXPECT_GT(res.recv_latency.max_ns(), 0u) << mode;
+    }
+
+    // no kernel timestamps unless asked for:
+    Result res;
+    run(RecvMode::RECVMMSG, port, 2, 50, res);
+    EXPECT_EQ(res.sent, res.rec.packets);
+    EXPECT_EQ(0u, res.rec.kernel_stamped);
+    EXPECT_EQ(0u, res.recv_latency.count());
+}
+
+TEST(md_eventpoller_recv, latency_histogram)
+{
+    using namespace MD_EVENTPOLLER_RECV_TEST;
+
+    EXPECT_EQ(0u, RecvLatencyHistogram::bucket(0));
+    EXPECT_EQ(1u, RecvLatencyHistogram::bucket(1));
+    EXPECT_EQ(2u, RecvLatencyHistogram::bucket(2));
+    EXPECT_EQ(2u, RecvLatencyHistogram::bucket(3));
+    EXPECT_EQ(11u, RecvLatencyHistogram::bucket(1024));
+    EXPECT_EQ(63u, RecvLatencyHistogram::bucket(UINT64_MAX));
+
+    RecvLatencyHistogram h;
+    EXPECT_EQ(0u, h.percentile_ns(0.5));
+    for (std::uint64_t ns = 1; ns <= 1000; ++ns)
+        h.add(ns);
+    // stamped after it was dequeued counts as zero:
+    h.add(Timestamp(10, 5), Timestamp(10, 0));
+    h.add(Timestamp(9, 999999000), Timestamp(10, 0));
+    EXPECT_EQ(1002u, h.count());
+    EXPECT_EQ(1u, h[0]);
+    EXPECT_EQ(1000u, h.max_ns());
+    EXPECT_EQ(512u, h.percentile_ns(0.5));
+    EXPECT_EQ(1000u, h.percentile_ns(0.99));
+
+    RecvLatencyHistogram h2;
+    h2.add(1000000);
+    h2.merge(h);
+    EXPECT_EQ(1003u, h2.count());
+    EXPECT_EQ(1000000u, h2.max_ns());
+    EXPECT_EQ(1u, h2[RecvLatencyHistogram::bucket(1000000)]);
+}
+
+TEST(md_eventpoller_recv, benchmark)
+{
+    using namespace MD_EVENTPOLLER_RECV_TEST;
+
+    const std::uint64_t bursts = 4000;
+    const std::uint32_t burst = 50;
+    std::uint16_t port = 31018;
+    for (RecvMode mode : {RecvMode::RECV, RecvMode::RECVMMSG}) {
+        Result res;
+        run(mode, port++, bursts, burst, res);
+        std::cout << mode << (res.multicast ? " multicast" : " unicast") << ": "
+                  << res.rec.packets << "/" << res.sent << " packets in " << res.seconds << "s, "
+                  << static_cast<std::uint64_t>(res.rec.packets / res.seconds) << " packets/sec, "
+                  << res.rec.batches << " reads, latency ns p50 " << percentile(res.rec.latency_ns, 0.5)
+                  << " p99 " << percentile(res.rec.latency_ns, 0.99) << std::endl;
+        EXPECT_GT(res.rec.packets, res.sent * 9 / 10);
+    }
+    // socket queueing (dequeue - kernel receive time) in the same bursts:
+    for (RecvMode mode : {RecvMode::RECV, RecvMode::RECVMMSG}) {
+        Result res;
+        run(mode, port++, bursts / 4, burst, res, RecvTimestamping::SOFTWARE);
+        std::cout << mode << " socket queueing: " << res.recv_latency << std::endl;
+        EXPECT_EQ(res.rec.packets, res.recv_latency.count());
+    }
+}
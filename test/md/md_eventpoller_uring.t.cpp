@@ -0,0 +1,321 @@
+#include <gtest/gtest.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <i01_core/Config.hpp>
+#include <i01_core/Time.hpp>
+#include <i01_core/TimerListener.hpp>
+
+#include <i01_net/EventPoller.hpp>
+#include <i01_net/SocketListener.hpp>
+#include <i01_net/UDPSocket.hpp>
+#include <i01_net/UringEventPoller.hpp>
+
+namespace MD_EVENTPOLLER_URING_TEST {
+
+using i01::core::Timestamp;
+using i01::net::EpollEventPoller;
+using i01::net::EventPoller;
+using i01::net::RecvDescriptor;
+using i01::net::RecvMode;
+using i01::net::UDPSocket;
+using i01::net::UringEventPoller;
+
+const char LOCAL[] = "127.0.0.1";
+
+std::uint64_t to_ns(const Timestamp& ts)
+{
+    return static_cast<std::uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<std::uint64_t>(ts.tv_nsec);
+}
+
+class Recorder : public i01::net::SocketListener, public i01::core::TimerListener {
+public:
+    std::uint64_t packets = 0;
+    std::uint64_t bytes = 0;
+    std::uint64_t calls = 0;
+    std::uint64_t max_batch = 0;
+    std::uint64_t out_of_order = 0;
+    std::uint64_t next_seqnum = 0;
+    std::uint64_t disconnects = 0;
+    std::uint64_t timers = 0;
+    /// Echo each read back to this fd if set.
+    int echo_fd = -1;
+
+    virtual void on_connected(const Timestamp&, void *) override {}
+    virtual void on_peer_disconnect(const Timestamp&, void *) override { ++disconnects; }
+    virtual void on_local_disconnect(const Timestamp&, void *) override {}
+
+    virtual void on_recv(const Timestamp&, void *, const std::uint8_t *buf, const ssize_t & len) override
+    {
+        ++calls;
+        max_batch = std::max<std::uint64_t>(max_batch, 1);
+        packet(buf, len);
+    }
+
+    virtual void on_recv_batch(const Timestamp&, void *, const RecvDescriptor *descs, std::size_t n) override
+    {
+        ++calls;
+        max_batch = std::max<std::uint64_t>(max_batch, n);
+        for (std::size_t i = 0; i < n; ++i)
+            packet(descs[i].buf, descs[i].len);
+    }
+
+    virtual void on_timer(const Timestamp&, void *, std::uint64_t iter) override { timers += iter; }
+
+private:
+    void packet(const std::uint8_t *buf, ssize_t len)
+    {
+        ++packets;
+        bytes += static_cast<std::uint64_t>(len);
+        if (echo_fd >= 0) {
+            EXPECT_EQ(len, ::send(echo_fd, buf, static_cast<std::size_t>(len), 0));
+            return;
+        }
+        if (len != static_cast<ssize_t>(sizeof(std::uint64_t)))
+            return;
+        std::uint64_t seqnum;
+        std::memcpy(&seqnum, buf, sizeof(seqnum));
+        if (seqnum != next_seqnum)
+            ++out_of_order;
+        next_seqnum = seqnum + 1;
+    }
+};
+
+int udp_receiver(std::uint16_t port)
+{
+    UDPSocket rx;
+    if (!rx.set_reuseaddr() || !rx.bind(port, LOCAL))
+        return -1;
+    rx.set_rcvbuf();
+    return rx.fd().transfer_ownership();
+}
+
+/// A connected loopback TCP pair.
+bool tcp_pair(std::uint16_t port, int& client, int& server)
+{
+    int l = ::socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    ::setsockopt(l, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in a;
+    std::memset(&a, 0, sizeof(a));
+    a.sin_family = AF_INET;
+    a.sin_port = htons(port);
+    a.sin_addr.s_addr = ::inet_addr(LOCAL);
+    if (0 != ::bind(l, reinterpret_cast<sockaddr *>(&a), sizeof(a)) || 0 != ::listen(l, 1)) {
+        ::close(l);
+        return false;
+    }
+    client = ::socket(AF_INET, SOCK_STREAM, 0);
+    bool ok = 0 == ::connect(client, reinterpret_cast<sockaddr *>(&a), sizeof(a));
+    server = ok ? ::accept(l, nullptr, nullptr) : -1;
+    ::close(l);
+    for (int fd : {client, server})
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return ok && server >= 0;
+}
+
+/// Send num_bursts bursts of burst datagrams, reading each with poller
+/// before the next, and return the seconds spent in the poller.
+double udp_bursts(EventPoller& poller, Recorder& rec, std::uint16_t port, std::uint64_t num_bursts, std::uint32_t burst)
+{
+    int fd = udp_receiver(port);
+    EXPECT_GE(fd, 0);
+    EXPECT_TRUE(poller.add_socket(rec, nullptr, fd, true));
+    UDPSocket tx(false);
+    tx.set_peer(LOCAL, port);
+
+    std::uint64_t sent = 0;
+    std::uint64_t busy_ns = 0;
+    for (std::uint64_t b = 0; b < num_bursts; ++b) {
+        for (std::uint32_t i = 0; i < burst; ++i) {
+            EXPECT_EQ(static_cast<ssize_t>(sizeof(sent)), tx.send(&sent, sizeof(sent)));
+            ++sent;
+        }
+        const Timestamp start(Timestamp::now());
+        while (rec.packets < sent) {
+            EXPECT_TRUE(poller.run());
+            if ((Timestamp::now() - start).tv_sec >= 2)
+                break; // lost datagrams
+        }
+        busy_ns += to_ns(Timestamp::now() - start);
+    }
+    return static_cast<double>(busy_ns) / 1e9;
+}
+
+/// n request/response round trips of len bytes over loopback TCP, the
+/// server side echoing from the poller, and return the seconds taken.
+double tcp_round_trips(EventPoller& poller, Recorder& rec, std::uint16_t port, std::uint64_t n, std::size_t len)
+{
+    int client = -1, server = -1;
+    EXPECT_TRUE(tcp_pair(port, client, server));
+    rec.echo_fd = server;
+    EXPECT_TRUE(poller.add_socket(rec, nullptr, server, true));
+
+    std::vector<std::uint8_t> req(len, 0x5a), resp(len);
+    const Timestamp start(Timestamp::now());
+    for (std::uint64_t i = 0; i < n; ++i) {
+        EXPECT_EQ(static_cast<ssize_t>(len), ::send(client, req.data(), len, 0));
+        const std::uint64_t want = (i + 1) * len;
+        while (rec.bytes < want)
+            EXPECT_TRUE(poller.run());
+        std::size_t got = 0;
+        while (got < len) {
+            ssize_t r = ::recv(client, resp.data() + got, len - got, 0);
+            EXPECT_GT(r, 0);
+            if (r <= 0)
+                break;
+            got += static_cast<std::size_t>(r);
+        }
+    }
+    const double s = static_cast<double>(to_ns(Timestamp::now() - start)) / 1e9;
+    ::close(client);
+    return s;
+}
+
+}
+
+TEST(md_eventpoller_uring, udp_batches)
+{
+    using namespace MD_EVENTPOLLER_URING_TEST;
+
+    UringEventPoller poller("uringtest");
+    Recorder rec;
+    udp_bursts(poller, rec, 31040, 20, 50);
+    EXPECT_EQ(1000u, rec.packets);
+    EXPECT_EQ(0u, rec.out_of_order);
+    EXPECT_LT(rec.calls, rec.packets);
+    EXPECT_GT(rec.max_batch, 1u);
+    EXPECT_LE(rec.max_batch, static_cast<std::uint64_t>(UringEventPoller::MAX_RECV_BATCH));
+    EXPECT_EQ(0u, poller.stats().no_buffers.load());
+    std::cout << poller.status() << std::endl;
+}
+
+TEST(md_eventpoller_uring, buffer_exhaustion)
+{
+    using namespace MD_EVENTPOLLER_URING_TEST;
+
+    // more datagrams per burst than buffers: the multishot receive ends
+    // and is re-armed once the buffers come back
+    UringEventPoller poller("uringtest");
+    ASSERT_TRUE(poller.ring_size(64, 16, 256));
+    Recorder rec;
+    udp_bursts(poller, rec, 31041, 10, 100);
+    EXPECT_EQ(1000u, rec.packets);
+    EXPECT_EQ(0u, rec.out_of_order);
+    EXPECT_GT(poller.stats().no_buffers.load(), 0u);
+    EXPECT_GT(poller.stats().rearms.load(), 0u);
+    EXPECT_FALSE(poller.ring_size(64, 16, 256));
+}
+
+TEST(md_eventpoller_uring, tcp)
+{
+    using namespace MD_EVENTPOLLER_URING_TEST;
+
+    UringEventPoller poller("uringtest");
+    Recorder rec;
+    int client = -1, server = -1;
+    ASSERT_TRUE(tcp_pair(31042, client, server));
+    ASSERT_TRUE(poller.add_socket(rec, nullptr, server, true));
+    const char msg[] = "hello, order entry";
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_EQ(static_cast<ssize_t>(sizeof(msg)), ::send(client, msg, sizeof(msg), 0));
+        while (rec.bytes < (i + 1) * sizeof(msg))
+            ASSERT_TRUE(poller.run());
+    }
+    EXPECT_EQ(3 * sizeof(msg), rec.bytes);
+    ::close(client);
+    const Timestamp start(Timestamp::now());
+    while (0 == rec.disconnects && (Timestamp::now() - start).tv_sec < 2)
+        ASSERT_TRUE(poller.run());
+    EXPECT_EQ(1u, rec.disconnects);
+}
+
+TEST(md_eventpoller_uring, timer)
+{
+    using namespace MD_EVENTPOLLER_URING_TEST;
+
+    UringEventPoller poller("uringtest");
+    Recorder rec;
+    ASSERT_TRUE(poller.add_timer(rec, nullptr, Timestamp(0, 1000000), Timestamp(0, 1000000)));
+    const Timestamp start(Timestamp::now());
+    while (rec.timers < 5 && (Timestamp::now() - start).tv_sec < 2)
+        ASSERT_TRUE(poller.run());
+    EXPECT_GE(rec.timers, 5u);
+}
+
+TEST(md_eventpoller_uring, create_event_poller)
+{
+    using namespace MD_EVENTPOLLER_URING_TEST;
+
+    auto cfg = i01::core::ConfigState::create();
+    std::unique_ptr<EventPoller> p(i01::net::create_event_poller("uringtest", *cfg));
+    ASSERT_TRUE(p != nullptr);
+    EXPECT_TRUE(dynamic_cast<EpollEventPoller *>(p.get()) != nullptr);
+
+    cfg->emplace("backend", "io_uring");
+    cfg->emplace("recv_buffers", "256");
+    cfg->emplace("recv_buffer_size", "9000");
+    p.reset(i01::net::create_event_poller("uringtest", *cfg));
+    ASSERT_TRUE(p != nullptr);
+    auto *u = dynamic_cast<UringEventPoller *>(p.get());
+    ASSERT_TRUE(u != nullptr);
+    EXPECT_EQ(256u, u->buffer_count());
+    EXPECT_EQ(9000u, u->buffer_size());
+
+    (*cfg)["recv_buffers"] = "100";
+    EXPECT_EQ(nullptr, i01::net::create_event_poller("uringtest", *cfg));
+    (*cfg)["backend"] = "kqueue";
+    EXPECT_EQ(nullptr, i01::net::create_event_poller("uringtest", *cfg));
+}
+
+TEST(md_eventpoller_uring, benchmark)
+{
+    using namespace MD_EVENTPOLLER_URING_TEST;
+
+    const std::uint64_t bursts = 4000;
+    const std::uint32_t burst = 50;
+    const std::uint64_t round_trips = 20000;
+    std::uint16_t port = 31050;
+
+    for (int backend = 0; backend < 3; ++backend) {
+        std::unique_ptr<EventPoller> p;
+        std::string label;
+        if (backend < 2) {
+            auto *e = new EpollEventPoller("uringbench");
+            e->recv_mode(backend ? RecvMode::RECVMMSG : RecvMode::RECV, 32);
+            label = backend ? "epoll recvmmsg" : "epoll recv";
+            p.reset(e);
+        } else {
+            p.reset(new UringEventPoller("uringbench"));
+            label = "io_uring";
+        }
+        Recorder rec;
+        const double s = udp_bursts(*p, rec, port++, bursts, burst);
+        std::cout << label << " udp: " << rec.packets << " packets in " << s << "s, "
+                  << static_cast<std::uint64_t>(rec.packets / s) << " packets/sec, "
+                  << rec.calls << " callbacks" << std::endl;
+        EXPECT_GT(rec.packets, bursts * burst * 9 / 10);
+    }
+
+    for (int backend = 0; backend < 2; ++backend) {
+        std::unique_ptr<EventPoller> p;
+        if (backend)
+            p.reset(new UringEventPoller("uringbench"));
+        else
+            p.reset(new EpollEventPoller("uringbench"));
+        Recorder rec;
+        const double s = tcp_round_trips(*p, rec, port++, round_trips, 64);
+        std::cout << (backend ? "io_uring" : "epoll") << " tcp: " << round_trips << " round trips in " << s << "s, "
+                  << static_cast<std::uint64_t>(s * 1e9 / round_trips) << " ns each" << std::endl;
+    }
+}
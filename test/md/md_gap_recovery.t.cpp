@@ -0,0 +1,521 @@
+#include <gtest/gtest.h>
+
+#include <arpa/inet.h>
+#include <endian.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <i01_core/macro.hpp>
+#include <i01_core/Time.hpp>
+
+#include <i01_net/Pcap.hpp>
+#include <i01_net/SocketListener.hpp>
+#include <i01_net/TCPSocket.hpp>
+#include <i01_net/UDPSocket.hpp>
+
+#include <i01_md/GapRecovery.hpp>
+
+namespace MD_GAP_RECOVERY_TEST {
+
+using i01::core::Timestamp;
+using i01::MD::GapRecovery;
+using i01::MD::RecoveryRequest;
+using i01::net::UDPSocket;
+
+using Packet = std::vector<std::uint8_t>;
+
+const std::string XNAS(STRINGIFY(I01_DATA) "/mdnasdaq.20141111.120000_120100.XNAS.first10k.pcap-ns");
+const std::string BZX(STRINGIFY(I01_DATA) "/BZX_UNIT_1_20140724_1500.pcap-ns");
+
+const char LOCAL[] = "127.0.0.1";
+const std::uint16_t SERVER_PORT = 47811;
+const std::uint16_t CLIENT_PORT = 47812;
+
+struct Capture {
+    std::vector<Packet> packets;
+    std::vector<Timestamp> timestamps;
+
+    /// buf is the UDP header and payload.
+    void handle(std::uint32_t, std::uint16_t, std::uint32_t, std::uint16_t, std::uint8_t *buf, size_t len, const Timestamp *ts)
+    {
+        packets.emplace_back(buf + 8, buf + len);
+        timestamps.push_back(*ts);
+    }
+};
+
+std::uint64_t mold_seqnum(const Packet& p)
+{
+    std::uint64_t s;
+    ::memcpy(&s, p.data() + 10, sizeof(s));
+    return be64toh(s);
+}
+
+std::uint32_t pitch_seqnum(const Packet& p)
+{
+    std::uint32_t s;
+    ::memcpy(&s, p.data() + 4, sizeof(s));
+    return le32toh(s);
+}
+
+/// What the decoder would have been given.
+class Sink : public i01::net::SocketListener {
+public:
+    std::vector<Packet> packets;
+
+    virtual void on_connected(const Timestamp&, void *) override {}
+    virtual void on_peer_disconnect(const Timestamp&, void *) override {}
+    virtual void on_local_disconnect(const Timestamp&, void *) override {}
+    virtual void on_recv(const Timestamp&, void *, const std::uint8_t *buf, const ssize_t& len) override
+    {
+        packets.emplace_back(buf, buf + len);
+    }
+};
+
+class Outcomes : public i01::MD::GapRecoveryListener {
+public:
+    unsigned started = 0;
+    unsigned complete = 0;
+    unsigned failed = 0;
+    std::size_t buffered = 0;
+
+    virtual void on_recovery_started(const Timestamp&, std::uint8_t, std::uint64_t expected, std::uint64_t received) override
+    {
+        EXPECT_LT(expected, received);
+        ++started;
+    }
+    virtual void on_recovery_complete(const Timestamp&, std::uint8_t, const Timestamp&, std::size_t packets_buffered) override
+    {
+        ++complete;
+        buffered += packets_buffered;
+    }
+    virtual void on_recovery_failed(const Timestamp&, std::uint8_t, std::uint64_t expected, std::uint64_t received) override
+    {
+        EXPECT_LT(expected, received);
+        ++failed;
+    }
+};
+
+/// A MoldUDP64 request server answering from a capture: each request gets
+/// the captured packets holding the messages asked for, sent back to the
+/// requester.
+class FakeMoldServer {
+public:
+    explicit FakeMoldServer(const std::vector<Packet>& packets) : m_packets(packets), m_socket(true)
+    {
+        for (std::size_t i = 0; i < packets.size(); ++i)
+            m_by_seqnum[mold_seqnum(packets[i])] = i;
+        m_socket.set_reuseaddr();
+        bound = m_socket.bind(SERVER_PORT, LOCAL);
+        m_socket.set_peer(LOCAL, CLIENT_PORT);
+    }
+
+    /// Answer the requests waiting; returns the number of requests.
+    unsigned serve()
+    {
+        unsigned n = 0;
+        std::uint8_t req[64];
+        sockaddr_in from;
+        for (ssize_t len; (len = m_socket.recv(req, sizeof(req), from)) > 0; ++n) {
+            EXPECT_EQ(20, len);
+            std::uint64_t seqnum;
+            std::uint16_t count;
+            ::memcpy(&seqnum, req + 10, sizeof(seqnum));
+            ::memcpy(&count, req + 18, sizeof(count));
+            seqnum = be64toh(seqnum);
+            const std::uint64_t end = seqnum + be16toh(count);
+            auto it = m_by_seqnum.upper_bound(seqnum);
+            if (it != m_by_seqnum.begin())
+                --it;
+            for (; it != m_by_seqnum.end() && it->first < end; ++it) {
+                const Packet& p = m_packets[it->second];
+                EXPECT_EQ(0, ::memcmp(p.data(), req, 10)) << "session";
+                m_socket.send(p.data(), p.size());
+                ++sent;
+            }
+        }
+        return n;
+    }
+
+    bool bound = false;
+    std::uint64_t sent = 0;
+
+private:
+    const std::vector<Packet>& m_packets;
+    std::map<std::uint64_t, std::size_t> m_by_seqnum;
+    UDPSocket m_socket;
+};
+
+/// Read what the server sent back into the recovery.
+unsigned pump(UDPSocket& client, GapRecovery& gr, const Timestamp& ts)
+{
+    unsigned n = 0;
+    std::uint8_t buf[2048];
+    sockaddr_in from;
+    for (ssize_t len; (len = client.recv(buf, sizeof(buf), from)) > 0; ++n)
+        gr.on_recv(ts, nullptr, buf, len);
+    return n;
+}
+
+bool dropped(std::size_t i)
+{
+    // single losses, and a run of five
+    return (i % 97 == 41) || (i >= 5000 && i < 5005);
+}
+
+}
+
+TEST(md_gap_recovery, moldudp64_rerequest)
+{
+    using namespace MD_GAP_RECOVERY_TEST;
+
+    Capture cap;
+    i01::net::pcap::UDPReader<Capture> reader(XNAS, &cap);
+    reader.read_packets();
+    ASSERT_GT(cap.packets.size(), 9000u);
+    for (std::size_t i = 1; i < cap.packets.size(); ++i)
+        ASSERT_LE(mold_seqnum(cap.packets[i - 1]), mold_seqnum(cap.packets[i]));
+
+    FakeMoldServer server(cap.packets);
+    ASSERT_TRUE(server.bound);
+    UDPSocket client(true);
+    client.set_reuseaddr();
+    ASSERT_TRUE(client.bind(CLIENT_PORT, LOCAL));
+    client.set_peer(LOCAL, SERVER_PORT);
+
+    Sink sink;
+    Outcomes outcomes;
+    i01::MD::MoldUDP64RequestTransport transport(client);
+    GapRecovery gr(GapRecovery::Framing::MOLDUDP64, &sink, &transport);
+    gr.listener(&outcomes);
+
+    unsigned drops = 0;
+    for (std::size_t i = 0; i < cap.packets.size(); ++i) {
+        if (dropped(i)) {
+            ++drops;
+        } else {
+            gr.on_recv(cap.timestamps[i], nullptr, cap.packets[i].data(), static_cast<ssize_t>(cap.packets[i].size()));
+        }
+        // the server is only looked at every few packets, so that some
+        // are held back behind each gap
+        if (i % 8 == 7) {
+            server.serve();
+            pump(client, gr, cap.timestamps[i]);
+        }
+    }
+    server.serve();
+    pump(client, gr, cap.timestamps.back());
+
+    const auto& stats = gr.stats();
+    EXPECT_FALSE(gr.recovering(0));
+    EXPECT_EQ(0u, gr.buffered(0));
+    EXPECT_GT(drops, 90u);
+    EXPECT_EQ(stats.gaps, stats.recovered);
+    EXPECT_EQ(0u, stats.failed);
+    EXPECT_EQ(outcomes.started, outcomes.complete);
+    EXPECT_EQ(0u, outcomes.failed);
+    EXPECT_GT(stats.packets_buffered, 0u);
+    EXPECT_EQ(stats.packets_buffered, outcomes.buffered);
+    // heartbeats ahead of the sequence are not passed on
+    const auto data = [](const std::vector<Packet>& packets) {
+        std::vector<Packet> d;
+        for (const auto& p : packets)
+            if (p[18] || p[19])
+                d.push_back(p);
+        return d;
+    };
+    EXPECT_TRUE(data(cap.packets) == data(sink.packets)) << sink.packets.size() << " of " << cap.packets.size();
+
+    std::cout << stats.gaps << " gaps over " << drops << " lost packets, " << stats.requests << " requests, "
+              << server.sent << " packets resent, " << stats.packets_buffered << " buffered, at most "
+              << stats.max_buffered << ", " << stats.duplicates << " duplicates; time to recover max "
+              << stats.max_time_to_recover << " total " << stats.total_time_to_recover << std::endl;
+}
+
+TEST(md_gap_recovery, moldudp64_failure)
+{
+    using namespace MD_GAP_RECOVERY_TEST;
+
+    Capture cap;
+    i01::net::pcap::UDPReader<Capture> reader(XNAS, &cap);
+    reader.read_packets();
+    ASSERT_GT(cap.packets.size(), 100u);
+
+    // requests that go nowhere:
+    class Nowhere : public i01::MD::RecoveryTransport {
+    public:
+        std::vector<RecoveryRequest> requests;
+        virtual bool request(const RecoveryRequest& r) override
+        {
+            requests.push_back(r);
+            return true;
+        }
+    } nowhere;
+
+    GapRecovery::Config cfg;
+    cfg.ring_size = 16;
+    cfg.max_retries = 2;
+    cfg.retry_timeout = Timestamp{0, 10000000};
+
+    // retries run out, then the ring fills:
+    for (int ring_fills = 0; ring_fills < 2; ++ring_fills) {
+        Sink sink;
+        Outcomes outcomes;
+        nowhere.requests.clear();
+        GapRecovery gr(GapRecovery::Framing::MOLDUDP64, &sink, &nowhere, cfg);
+        gr.listener(&outcomes);
+
+        Timestamp ts{1000, 0};
+        const auto step = [&]() {
+            ts = ts + Timestamp{0, 4000000};
+            if (!ring_fills)
+                gr.on_timer(ts, nullptr, 1);
+        };
+        std::vector<Packet> expected;
+        for (std::size_t i = 0; i < 12; ++i) {
+            if (i == 3)
+                continue;
+            gr.on_recv(ts, nullptr, cap.packets[i].data(), static_cast<ssize_t>(cap.packets[i].size()));
+            expected.push_back(cap.packets[i]);
+            step();
+        }
+        ASSERT_TRUE(gr.recovering(0));
+        EXPECT_EQ(8u, gr.buffered(0));
+        EXPECT_EQ(3u, sink.packets.size());
+        ASSERT_FALSE(nowhere.requests.empty());
+        EXPECT_EQ(mold_seqnum(cap.packets[3]), nowhere.requests[0].seqnum);
+        EXPECT_EQ(mold_seqnum(cap.packets[4]) - mold_seqnum(cap.packets[3]), nowhere.requests[0].count);
+        EXPECT_EQ(0, ::memcmp(cap.packets[0].data(), nowhere.requests[0].session.data(), 10));
+
+        if (ring_fills) {
+            for (std::size_t i = 12; i < 30; ++i) {
+                gr.on_recv(ts, nullptr, cap.packets[i].data(), static_cast<ssize_t>(cap.packets[i].size()));
+                expected.push_back(cap.packets[i]);
+            }
+            EXPECT_EQ(1u, nowhere.requests.size());
+        } else {
+            for (int i = 0; i < 10; ++i)
+                step();
+            EXPECT_EQ(1u + cfg.max_retries, nowhere.requests.size());
+        }
+        // everything held back was passed on, and the gap left for the decoder:
+        EXPECT_FALSE(gr.recovering(0));
+        EXPECT_EQ(1u, outcomes.failed);
+        EXPECT_EQ(0u, outcomes.complete);
+        EXPECT_EQ(1u, gr.stats().failed);
+        EXPECT_TRUE(expected == sink.packets);
+    }
+}
+
+TEST(md_gap_recovery, moldudp64_ring_full_retransmission)
+{
+    using namespace MD_GAP_RECOVERY_TEST;
+
+    Capture cap;
+    i01::net::pcap::UDPReader<Capture> reader(XNAS, &cap);
+    reader.read_packets();
+    ASSERT_GT(cap.packets.size(), 100u);
+
+    class Nowhere : public i01::MD::RecoveryTransport {
+    public:
+        virtual bool request(const RecoveryRequest&) override { return true; }
+    } nowhere;
+
+    GapRecovery::Config cfg;
+    cfg.ring_size = 4;
+    Sink sink;
+    Outcomes outcomes;
+    GapRecovery gr(GapRecovery::Framing::MOLDUDP64, &sink, &nowhere, cfg);
+    gr.listener(&outcomes);
+
+    const Timestamp ts{1000, 0};
+    const auto recv = [&](std::size_t i) {
+        gr.on_recv(ts, nullptr, cap.packets[i].data(), static_cast<ssize_t>(cap.packets[i].size()));
+    };
+    // 3 and 5 are lost, and 4, 6, 7 and 8 fill the ring:
+    for (std::size_t i = 0; i < 9; ++i) {
+        if (i != 3 && i != 5)
+            recv(i);
+    }
+    ASSERT_TRUE(gr.recovering(0));
+    ASSERT_EQ(4u, gr.buffered(0));
+    ASSERT_EQ(3u, sink.packets.size());
+
+    // the retransmission of 5 finds no room: recovery fails, and 5 is
+    // passed on in its place between 4 and 6
+    recv(5);
+    EXPECT_FALSE(gr.recovering(0));
+    EXPECT_EQ(1u, outcomes.failed);
+    EXPECT_EQ(0u, gr.buffered(0));
+    // 3 comes too late, and 5 again is a duplicate
+    const auto duplicates = gr.stats().duplicates;
+    recv(3);
+    recv(5);
+    EXPECT_EQ(duplicates + 2, gr.stats().duplicates);
+    recv(9);
+
+    std::vector<Packet> expected;
+    for (std::size_t i = 0; i < 10; ++i) {
+        if (i != 3)
+            expected.push_back(cap.packets[i]);
+    }
+    ASSERT_EQ(expected.size(), sink.packets.size());
+    for (std::size_t i = 0; i < expected.size(); ++i)
+        EXPECT_EQ(mold_seqnum(expected[i]), mold_seqnum(sink.packets[i])) << i;
+}
+
+TEST(md_gap_recovery, pitch2_gap_request_proxy)
+{
+    using namespace MD_GAP_RECOVERY_TEST;
+
+    Capture cap;
+    i01::net::pcap::UDPReader<Capture> reader(BZX, &cap);
+    reader.read_packets();
+    std::vector<Packet> unit1;
+    for (const auto& p : cap.packets)
+        if (p.size() >= 8 && p[3] == 1 && pitch_seqnum(p))
+            unit1.push_back(p);
+    ASSERT_GT(unit1.size(), 30000u);
+    std::map<std::uint32_t, std::size_t> by_seqnum;
+    for (std::size_t i = 0; i < unit1.size(); ++i)
+        by_seqnum[pitch_seqnum(unit1[i])] = i;
+
+    // fds[1] is the proxy's end of the TCP session
+    int fds[2];
+    {
+        int listener = ::socket(AF_INET, SOCK_STREAM, 0);
+        ASSERT_LE(0, listener);
+        const int one = 1;
+        ::setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in addr;
+        ::memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(SERVER_PORT);
+        addr.sin_addr.s_addr = ::inet_addr(LOCAL);
+        ASSERT_EQ(0, ::bind(listener, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)));
+        ASSERT_EQ(0, ::listen(listener, 1));
+        fds[0] = ::socket(AF_INET, SOCK_STREAM, 0);
+        ASSERT_EQ(0, ::connect(fds[0], reinterpret_cast<sockaddr *>(&addr), sizeof(addr)));
+        fds[1] = ::accept4(listener, nullptr, nullptr, SOCK_NONBLOCK);
+        ASSERT_LE(0, fds[1]);
+        ::setsockopt(fds[1], IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        ::close(listener);
+    }
+    i01::net::TCPSocket session(fds[0]);
+    session.set_nonblocking();
+
+    Sink sink;
+    Outcomes outcomes;
+    i01::MD::PITCH2GapRequestTransport transport(session);
+    GapRecovery gr(GapRecovery::Framing::PITCH2, &sink, &transport);
+    gr.listener(&outcomes);
+    transport.recovery(&gr);
+
+    // pass the proxy's next len bytes to the transport
+    const auto relay = [&](const Timestamp& ts, ssize_t len) {
+        char buf[64];
+        while (len > 0) {
+            const ssize_t n = session.recv(buf, std::min<std::size_t>(len, sizeof(buf)));
+            ASSERT_LE(0, n);
+            transport.on_recv(ts, nullptr, reinterpret_cast<std::uint8_t *>(buf), n);
+            len -= n;
+        }
+    };
+
+    // gap requests are answered with status, and accepted ones with the
+    // packets on the "gap channel"; every third is out of range instead.
+    unsigned answered = 0;
+    const auto proxy = [&](const Timestamp& ts) {
+        std::uint8_t buf[4096];
+        ssize_t len = ::recv(fds[1], buf, sizeof(buf), 0);
+        for (ssize_t off = 0; len > 0 && off + 8 <= len; ) {
+            std::uint16_t pkt_len;
+            ::memcpy(&pkt_len, buf + off, 2);
+            const std::uint8_t *m = buf + off + 8;
+            if (m[1] == 0x01) {
+                EXPECT_EQ(22, m[0]);
+                EXPECT_EQ(0, ::memcmp(m + 2, "0001TEST  PASSWORD  ", 20));
+                const std::uint8_t resp[] = {11, 0, 1, 0, 0, 0, 0, 0, 3, 0x02, 'A'};
+                EXPECT_EQ(11, ::send(fds[1], resp, sizeof(resp), 0));
+                relay(ts, 11);
+            } else if (m[1] == 0x03) {
+                EXPECT_EQ(9, m[0]);
+                std::uint32_t seqnum;
+                std::uint16_t count;
+                ::memcpy(&seqnum, m + 3, 4);
+                ::memcpy(&count, m + 7, 2);
+                const bool accept = ++answered % 3 != 0;
+                std::uint8_t resp[18] = {18, 0, 1, 0, 0, 0, 0, 0, 10, 0x04, m[2]};
+                ::memcpy(resp + 11, m + 3, 6);
+                resp[17] = accept ? 'A' : 'O';
+                // split across two reads of the session:
+                EXPECT_EQ(5, ::send(fds[1], resp, 5, 0));
+                relay(ts, 5);
+                EXPECT_EQ(13, ::send(fds[1], resp + 5, 13, 0));
+                relay(ts, 13);
+                if (accept) {
+                    auto it = by_seqnum.upper_bound(le32toh(seqnum));
+                    if (it != by_seqnum.begin())
+                        --it;
+                    for (; it != by_seqnum.end() && it->first < le32toh(seqnum) + le16toh(count); ++it)
+                        gr.on_recv(ts, nullptr, unit1[it->second].data(), static_cast<ssize_t>(unit1[it->second].size()));
+                }
+            }
+            off += pkt_len;
+        }
+    };
+
+    // not logged in yet, so the gap cannot be asked for:
+    gr.on_recv(Timestamp{1, 0}, nullptr, unit1[0].data(), static_cast<ssize_t>(unit1[0].size()));
+    gr.on_recv(Timestamp{1, 0}, nullptr, unit1[2].data(), static_cast<ssize_t>(unit1[2].size()));
+    EXPECT_EQ(1u, outcomes.failed);
+    EXPECT_FALSE(gr.recovering(1));
+    EXPECT_EQ(2u, sink.packets.size());
+
+    ASSERT_TRUE(transport.login("0001", "TEST", "PASSWORD"));
+    proxy(Timestamp{1, 0});
+    ASSERT_TRUE(transport.logged_in());
+
+    std::vector<Packet> expected{unit1[0], unit1[2]};
+    unsigned drops = 0;
+    for (std::size_t i = 3; i < unit1.size(); ++i) {
+        if (dropped(i)) {
+            ++drops;
+        } else {
+            gr.on_recv(Timestamp{2, 0}, nullptr, unit1[i].data(), static_cast<ssize_t>(unit1[i].size()));
+        }
+        if (i % 8 == 7)
+            proxy(Timestamp{2, 0});
+    }
+    proxy(Timestamp{2, 0});
+
+    // the rejected gaps are passed on without their packets, the rest are
+    // filled in order:
+    for (std::size_t i = 3; i < unit1.size(); ++i)
+        expected.push_back(unit1[i]);
+    const auto& stats = gr.stats();
+    EXPECT_FALSE(gr.recovering(1));
+    EXPECT_EQ(stats.gaps, stats.recovered + stats.failed);
+    EXPECT_EQ(answered / 3 + 1, stats.failed);
+    EXPECT_EQ(stats.recovered, outcomes.complete);
+    EXPECT_GT(stats.recovered, 0u);
+    std::size_t j = 0;
+    for (const auto& p : sink.packets) {
+        while (j < expected.size() && expected[j] != p)
+            ++j;
+        ASSERT_LT(j, expected.size()) << "out of order at seqnum " << pitch_seqnum(p);
+        ++j;
+    }
+    EXPECT_LT(sink.packets.size(), expected.size());
+    EXPECT_GT(sink.packets.size(), expected.size() - drops);
+    ::close(fds[1]);
+}
@@ -0,0 +1,337 @@
+#include <gtest/gtest.h>
+
+#include <endian.h>
+#include <string.h>
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <i01_core/macro.hpp>
+#include <i01_core/Time.hpp>
+
+#include <i01_net/Pcap.hpp>
+
+#include <i01_md/NASDAQ/ITCH50/BatchDecoder.hpp>
+
+namespace MD_ITCH50_BATCH_TEST {
+
+using namespace i01::MD::NASDAQ::ITCH50::Batch;
+
+using ScalarDecoder = BatchDecoder<ScalarKernels>;
+using DefaultDecoder = BatchDecoder<>;
+using PacketType = DefaultDecoder::PacketType;
+
+/// Collects the UDP payloads of a pcap.
+class PacketCollector : public i01::net::UDPPktListener<PacketCollector> {
+public:
+    template<typename... Args>
+    void handle_payload(std::uint32_t, std::uint16_t, std::uint32_t, std::uint16_t, std::uint8_t *buf, std::size_t len, const i01::core::Timestamp *, Args&&...) {
+        m_packets.emplace_back(buf, buf + len);
+    }
+
+    std::vector<std::vector<std::uint8_t> > m_packets;
+};
+
+std::vector<std::vector<std::uint8_t> > load(const std::vector<std::string> &files)
+{
+    PacketCollector c;
+    for (const auto &f : files) {
+        i01::net::pcap::UDPReader<PacketCollector> reader(f, &c);
+        while (reader.read_packets(1024) > 0) {
+        }
+    }
+    return std::move(c.m_packets);
+}
+
+const std::vector<std::string> & xnas_files()
+{
+    static const std::vector<std::string> files = {
+        STRINGIFY(I01_DATA) "/mdnasdaq.20141003.090000.1412341200.first10k.pcap-ns",
+        STRINGIFY(I01_DATA) "/mdnasdaq.20141111.120000_120100.XNAS.first10k.pcap-ns",
+    };
+    return files;
+}
+
+/// Builds a MoldUDP64 packet.
+struct PacketBuilder {
+    PacketBuilder(std::uint64_t seqnum) {
+        bytes.resize(20);
+        memcpy(bytes.data(), "SESSION001", 10);
+        const std::uint64_t s = htobe64(seqnum);
+        memcpy(bytes.data() + 10, &s, 8);
+    }
+
+    PacketBuilder & msg(const std::vector<std::uint8_t> &m) {
+        const std::uint16_t n = htobe16(static_cast<std::uint16_t>(m.size()));
+        bytes.insert(bytes.end(), reinterpret_cast<const std::uint8_t *>(&n), reinterpret_cast<const std::uint8_t *>(&n) + 2);
+        bytes.insert(bytes.end(), m.begin(), m.end());
+        ++count;
+        const std::uint16_t c = htobe16(count);
+        memcpy(bytes.data() + 18, &c, 2);
+        return *this;
+    }
+
+    std::vector<std::uint8_t> bytes;
+    std::uint16_t count = 0;
+};
+
+/// Writes big endian fields into a message.
+struct MessageBuilder {
+    MessageBuilder(char type, std::size_t len, std::uint16_t locate, std::uint16_t tracking, std::uint64_t ts) : bytes(len, 0) {
+        bytes[0] = static_cast<std::uint8_t>(type);
+        be(1, locate, 2);
+        be(3, tracking, 2);
+        be(5, ts, 6);
+    }
+
+    MessageBuilder & be(std::size_t off, std::uint64_t v, std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i) {
+            bytes[off + n - 1 - i] = static_cast<std::uint8_t>(v >> (8 * i));
+        }
+        return *this;
+    }
+
+    MessageBuilder & raw(std::size_t off, const char *s, std::size_t n) {
+        memcpy(bytes.data() + off, s, n);
+        return *this;
+    }
+
+    std::vector<std::uint8_t> bytes;
+};
+
+std::vector<std::uint8_t> synthetic_packet()
+{
+    const std::uint64_t ts = 0x0000123456789abcULL;
+    PacketBuilder p(42);
+    p.msg(MessageBuilder('S', 12, 0, 1, ts).raw(11, "O", 1).bytes)
+     .msg(MessageBuilder('A', ADD_SIZE, 7, 2, ts + 1).be(11, 0x0102030405060708ULL, 8).raw(19, "B", 1)
+          .be(20, 100, 4).raw(24, "AAPL    ", 8).be(32, 1234500, 4).bytes)
+     .msg(MessageBuilder('F', ADD_MPID_SIZE, 8, 3, ts + 2).be(11, 0x1112131415161718ULL, 8).raw(19, "S", 1)
+          .be(20, 200, 4).raw(24, "MSFT    ", 8).be(32, 456700, 4).raw(36, "GSCO", 4).bytes)
+     .msg(MessageBuilder('E', EXECUTE_SIZE, 7, 4, ts + 3).be(11, 0x0102030405060708ULL, 8).be(19, 40, 4)
+          .be(23, 0xa1a2a3a4a5a6a7a8ULL, 8).bytes)
+     .msg(MessageBuilder('C', EXECUTE_WITH_PRICE_SIZE, 7, 5, ts + 4).be(11, 0x0102030405060708ULL, 8).be(19, 10, 4)
+          .be(23, 0xb1b2b3b4b5b6b7b8ULL, 8).raw(31, "Y", 1).be(32, 1234400, 4).bytes)
+     .msg(MessageBuilder('X', CANCEL_SIZE, 8, 6, ts + 5).be(11, 0x1112131415161718ULL, 8).be(19, 50, 4).bytes)
+     .msg(MessageBuilder('U', REPLACE_SIZE, 8, 7, ts + 6).be(11, 0x1112131415161718ULL, 8).be(19, 0x2122232425262728ULL, 8)
+          .be(27, 150, 4).be(31, 456800, 4).bytes)
+     .msg(MessageBuilder('D', DELETE_SIZE, 8, 8, ts + 7).be(11, 0x2122232425262728ULL, 8).bytes)
+     // a hot type with the wrong length is passed through
+     .msg(MessageBuilder('D', DELETE_SIZE + 1, 8, 9, ts + 8).bytes);
+    return p.bytes;
+}
+
+/// Records the order of delivery.
+struct OrderRecorder {
+    void on_add(const Add &r) { seen += r.attributed ? 'F' : 'A'; }
+    void on_execute(const Execute &r) { seen += r.with_price ? 'C' : 'E'; }
+    void on_cancel(const Cancel &) { seen += 'X'; }
+    void on_delete(const Delete &) { seen += 'D'; }
+    void on_replace(const Replace &) { seen += 'U'; }
+    void on_other(const std::uint8_t *m, std::size_t) { seen += '*'; seen += static_cast<char>(m[0]); }
+    std::string seen;
+};
+
+template<typename Decoder>
+void check_synthetic()
+{
+    const auto pkt = synthetic_packet();
+    Decoder dec;
+    std::unique_ptr<typename Decoder::PacketType> p(new typename Decoder::PacketType);
+    ASSERT_TRUE(dec.decode(pkt.data(), pkt.size(), *p));
+    EXPECT_EQ(0, memcmp(p->session.data(), "SESSION001", 10));
+    EXPECT_EQ(42U, p->seqnum);
+    EXPECT_EQ(9U, p->msg_count);
+    EXPECT_FALSE(p->truncated);
+    ASSERT_EQ(9U, p->num_entries);
+    ASSERT_EQ(2U, p->num_adds);
+    ASSERT_EQ(2U, p->num_executes);
+    ASSERT_EQ(1U, p->num_cancels);
+    ASSERT_EQ(1U, p->num_deletes);
+    ASSERT_EQ(1U, p->num_replaces);
+
+    const std::uint64_t ts = 0x0000123456789abcULL;
+    const Add &a = p->adds[0];
+    EXPECT_EQ(ts + 1, a.timestamp);
+    EXPECT_EQ(7U, a.stock_locate);
+    EXPECT_EQ(2U, a.tracking_number);
+    EXPECT_EQ('B', a.buy_sell_indicator);
+    EXPECT_EQ(0U, a.attributed);
+    EXPECT_EQ(0x0102030405060708ULL, a.order_refnum);
+    EXPECT_EQ(100U, a.shares);
+    EXPECT_EQ(1234500U, a.price);
+    EXPECT_EQ(0, memcmp(a.stock.data(), "AAPL    ", 8));
+    const Add &f = p->adds[1];
+    EXPECT_EQ('S', f.buy_sell_indicator);
+    EXPECT_EQ(1U, f.attributed);
+    EXPECT_EQ(0x1112131415161718ULL, f.order_refnum);
+    EXPECT_EQ(456700U, f.price);
+
+    const Execute &e = p->executes[0];
+    EXPECT_EQ(ts + 3, e.timestamp);
+    EXPECT_EQ(0x0102030405060708ULL, e.order_refnum);
+    EXPECT_EQ(40U, e.executed_shares);
+    EXPECT_EQ(0xa1a2a3a4a5a6a7a8ULL, e.match_number);
+    EXPECT_EQ(0U, e.with_price);
+    EXPECT_EQ(0, e.printable);
+    EXPECT_EQ(0U, e.execution_price);
+    const Execute &c = p->executes[1];
+    EXPECT_EQ(10U, c.executed_shares);
+    EXPECT_EQ(0xb1b2b3b4b5b6b7b8ULL, c.match_number);
+    EXPECT_EQ(1U, c.with_price);
+    EXPECT_EQ('Y', c.printable);
+    EXPECT_EQ(1234400U, c.execution_price);
+
+    EXPECT_EQ(0x1112131415161718ULL, p->cancels[0].order_refnum);
+    EXPECT_EQ(50U, p->cancels[0].canceled_shares);
+    EXPECT_EQ(6U, p->cancels[0].tracking_number);
+
+    EXPECT_EQ(0x2122232425262728ULL, p->deletes[0].order_refnum);
+    EXPECT_EQ(ts + 7, p->deletes[0].timestamp);
+
+    const Replace &u = p->replaces[0];
+    EXPECT_EQ(0x1112131415161718ULL, u.original_order_refnum);
+    EXPECT_EQ(0x2122232425262728ULL, u.new_order_refnum);
+    EXPECT_EQ(150U, u.shares);
+    EXPECT_EQ(456800U, u.price);
+    EXPECT_EQ(8U, u.stock_locate);
+
+    OrderRecorder rec;
+    p->for_each(pkt.data(), rec);
+    EXPECT_EQ("*SAFECXUD*D", rec.seen);
+}
+
+template<typename A, typename B>
+bool same(const A &a, const B &b, std::size_t n)
+{
+    return 0 == memcmp(a.data(), b.data(), n * sizeof(typename A::value_type));
+}
+
+}
+
+TEST(md_itch50_batch, md_itch50_batch_synthetic)
+{
+    using namespace MD_ITCH50_BATCH_TEST;
+    check_synthetic<ScalarDecoder>();
+    check_synthetic<DefaultDecoder>();
+}
+
+TEST(md_itch50_batch, md_itch50_batch_framing)
+{
+    using namespace MD_ITCH50_BATCH_TEST;
+    std::unique_ptr<PacketType> p(new PacketType);
+    DefaultDecoder dec;
+
+    const std::uint8_t short_pkt[10] = {};
+    EXPECT_FALSE(dec.decode(short_pkt, sizeof(short_pkt), *p));
+    EXPECT_EQ(0U, p->num_entries);
+
+    // heartbeat and end of session carry no messages
+    PacketBuilder hb(7);
+    EXPECT_TRUE(dec.decode(hb.bytes.data(), hb.bytes.size(), *p));
+    EXPECT_EQ(0U, p->msg_count);
+    EXPECT_EQ(0U, p->num_entries);
+    hb.bytes[18] = hb.bytes[19] = 0xFF;
+    EXPECT_TRUE(dec.decode(hb.bytes.data(), hb.bytes.size(), *p));
+    EXPECT_EQ(0xFFFFU, p->msg_count);
+    EXPECT_EQ(0U, p->num_entries);
+
+    // a message block cut short ends the packet
+    auto pkt = synthetic_packet();
+    pkt.resize(pkt.size() - 5);
+    EXPECT_TRUE(dec.decode(pkt.data(), pkt.size(), *p));
+    EXPECT_EQ(8U, p->num_entries);
+
+    // more messages than the batch holds
+    pkt = synthetic_packet();
+    BatchDecoder<DefaultKernels, 4> small_dec;
+    std::unique_ptr<BatchDecoder<DefaultKernels, 4>::PacketType> small(new BatchDecoder<DefaultKernels, 4>::PacketType);
+    EXPECT_TRUE(small_dec.decode(pkt.data(), pkt.size(), *small));
+    EXPECT_TRUE(small->truncated);
+    EXPECT_EQ(4U, small->num_entries);
+    EXPECT_EQ(2U, small->num_adds);
+    EXPECT_EQ(1U, small->num_executes);
+}
+
+TEST(md_itch50_batch, md_itch50_batch_xnas_matches_scalar)
+{
+    using namespace MD_ITCH50_BATCH_TEST;
+    const auto packets = load(xnas_files());
+    ASSERT_FALSE(packets.empty());
+
+    ScalarDecoder scalar_dec;
+    DefaultDecoder dec;
+    std::unique_ptr<PacketType> ref(new PacketType);
+    std::unique_ptr<PacketType> p(new PacketType);
+    std::size_t msgs = 0, hot = 0;
+    for (const auto &pkt : packets) {
+        const bool ref_ok = scalar_dec.decode(pkt.data(), pkt.size(), *ref);
+        ASSERT_EQ(ref_ok, dec.decode(pkt.data(), pkt.size(), *p));
+        ASSERT_FALSE(p->truncated);
+        ASSERT_EQ(ref->num_entries, p->num_entries);
+        ASSERT_EQ(ref->num_adds, p->num_adds);
+        ASSERT_EQ(ref->num_executes, p->num_executes);
+        ASSERT_EQ(ref->num_cancels, p->num_cancels);
+        ASSERT_EQ(ref->num_deletes, p->num_deletes);
+        ASSERT_EQ(ref->num_replaces, p->num_replaces);
+        ASSERT_TRUE(same(ref->entries, p->entries, p->num_entries));
+        ASSERT_TRUE(same(ref->adds, p->adds, p->num_adds));
+        ASSERT_TRUE(same(ref->executes, p->executes, p->num_executes));
+        ASSERT_TRUE(same(ref->cancels, p->cancels, p->num_cancels));
+        ASSERT_TRUE(same(ref->deletes, p->deletes, p->num_deletes));
+        ASSERT_TRUE(same(ref->replaces, p->replaces, p->num_replaces));
+        msgs += p->num_entries;
+        hot += p->num_adds + p->num_executes + p->num_cancels + p->num_deletes + p->num_replaces;
+    }
+    EXPECT_GT(hot, 0U);
+    std::cout << "Packets: " << packets.size() << ", messages: " << msgs << ", order messages: " << hot
+              << ", kernels: " << DefaultDecoder::kernels() << std::endl;
+}
+
+namespace MD_ITCH50_BATCH_TEST {
+
+struct Throughput {
+    double msgs_per_sec;
+    double cycles_per_msg;
+};
+
+template<typename Decoder>
+Throughput throughput(const std::vector<std::vector<std::uint8_t> > &packets, int passes)
+{
+    Decoder dec;
+    std::unique_ptr<typename Decoder::PacketType> p(new typename Decoder::PacketType);
+    std::uint64_t msgs = 0, sink = 0;
+    i01::core::MonotonicTimer t;
+    const i01::core::Timestamp begin = i01::core::Timestamp::now();
+    t.start();
+    for (int i = 0; i < passes; ++i) {
+        for (const auto &pkt : packets) {
+            dec.decode(pkt.data(), pkt.size(), *p);
+            msgs += p->num_entries;
+            sink += p->num_adds ? p->adds[0].order_refnum : 0;
+        }
+    }
+    t.stop();
+    const i01::core::Timestamp elapsed = i01::core::Timestamp::now() - begin;
+    EXPECT_NE(0U, sink);
+    const double ns = elapsed.tv_sec * 1e9 + elapsed.tv_nsec;
+    return Throughput{msgs * 1e9 / ns, static_cast<double>(t.interval()) / msgs};
+}
+
+}
+
+TEST(md_itch50_batch, md_itch50_batch_benchmark)
+{
+    using namespace MD_ITCH50_BATCH_TEST;
+    const auto packets = load(xnas_files());
+    ASSERT_FALSE(packets.empty());
+    const int passes = 50;
+    const auto scalar = throughput<ScalarDecoder>(packets, passes);
+    const auto batch = throughput<DefaultDecoder>(packets, passes);
+    std::cout << "Messages/sec, scalar: " << static_cast<std::uint64_t>(scalar.msgs_per_sec)
+              << " (" << scalar.cycles_per_msg << " cycles/msg), " << DefaultDecoder::kernels() << ": "
+              << static_cast<std::uint64_t>(batch.msgs_per_sec) << " (" << batch.cycles_per_msg << " cycles/msg)" << std::endl;
+}
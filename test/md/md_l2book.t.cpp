@@ -0,0 +1,349 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+
+#include <i01_core/macro.hpp>
+#include <i01_core/MIC.hpp>
+#include <i01_core/Time.hpp>
+
+#include <i01_net/Pcap.hpp>
+
+#include <i01_md/L2Book.hpp>
+#include <i01_md/NYSE/PDP/Messages.hpp>
+
+using i01::core::MonotonicTimer;
+using i01::core::Timestamp;
+using namespace i01::MD;
+
+namespace MD_L2BOOK_TEST {
+
+typedef BidL2BookHalf<i01::core::SpinRWMutex, MapL2Storage> MapBids;
+typedef AskL2BookHalf<i01::core::SpinRWMutex, MapL2Storage> MapAsks;
+typedef BidL2BookHalf<i01::core::SpinRWMutex, FlatL2Storage<>> FlatBids;
+typedef AskL2BookHalf<i01::core::SpinRWMutex, FlatL2Storage<>> FlatAsks;
+
+/// One price level update pulled out of an OpenBook Ultra capture.
+struct LevelUpdate {
+    std::uint16_t security_index;
+    bool clear;
+    bool is_bid;
+    Price price;
+    Size size;
+    NumOrders num_orders;
+};
+
+/// Collects every price point of the full and delta updates in a PDP
+//  capture, so that the book backends can be timed without the decoder.
+class PDPLevelCollector : public i01::net::UDPPktListener<PDPLevelCollector> {
+public:
+    template<typename...Args>
+    void handle_payload(std::uint32_t, std::uint16_t, std::uint32_t, std::uint16_t, std::uint8_t *buf, std::size_t len, const Timestamp *, Args&&...) {
+        namespace PDP = i01::MD::NYSE::PDP;
+        if (len < sizeof(PDP::Messages::MessageHeader)) {
+            return;
+        }
+        auto header = reinterpret_cast<const PDP::Messages::MessageHeader *>(buf);
+        const auto msg_type = static_cast<PDP::Types::MsgType>(ntohs(static_cast<std::uint16_t>(header->msg_type)));
+        std::uint8_t *bufidx = buf + sizeof(PDP::Messages::MessageHeader);
+        std::uint8_t *end = buf + len;
+
+        while (bufidx + sizeof(PDP::Types::MsgSize) <= end) {
+            const std::size_t msg_size = ntohs(*reinterpret_cast<const PDP::Types::MsgSize *>(bufidx));
+            if (0 == msg_size || bufidx + msg_size > end) {
+                return;
+            }
+            if (PDP::Types::MsgType::OPENBOOK_FULL_UPDATE == msg_type) {
+                auto msg = reinterpret_cast<const PDP::Messages::FullUpdate *>(bufidx);
+                const auto si = ntohs(msg->security_index);
+                m_updates.push_back(LevelUpdate{si, true, true, 0, 0, 0});
+                auto npp = (msg_size - sizeof(PDP::Messages::FullUpdate)) / sizeof(PDP::Messages::FullUpdatePricePoint);
+                auto pp = reinterpret_cast<const PDP::Messages::FullUpdatePricePoint *>(bufidx + sizeof(PDP::Messages::FullUpdate));
+                for (auto i = 0U; i < npp; i++, pp++) {
+                    m_updates.push_back(LevelUpdate{si, false, pp->side == PDP::Types::Side::BUY,
+                                scale_(ntohl(pp->price_numerator), msg->price_scale_code),
+                                ntohl(pp->volume), ntohs(pp->num_orders)});
+                }
+            } else if (PDP::Types::MsgType::OPENBOOK_DELTA_UPDATE == msg_type) {
+                auto msg = reinterpret_cast<const PDP::Messages::DeltaUpdate *>(bufidx);
+                const auto si = ntohs(msg->security_index);
+                auto npp = (msg_size - sizeof(PDP::Messages::DeltaUpdate)) / sizeof(PDP::Messages::DeltaUpdatePricePoint);
+                auto pp = reinterpret_cast<const PDP::Messages::DeltaUpdatePricePoint *>(bufidx + sizeof(PDP::Messages::DeltaUpdate));
+                for (auto i = 0U; i < npp; i++, pp++) {
+                    m_updates.push_back(LevelUpdate{si, false, pp->side == PDP::Types::Side::BUY,
+                                scale_(ntohl(pp->price_numerator), msg->price_scale_code),
+                                ntohl(pp->volume), ntohs(pp->num_orders)});
+                }
+            } else {
+                return;
+            }
+            bufidx += msg_size;
+        }
+    }
+
+    std::vector<LevelUpdate> m_updates;
+
+private:
+    static Price scale_(std::uint32_t numerator, std::uint8_t scale) {
+        Price p = numerator;
+        for (; scale < 4; scale++) { p *= 10; }
+        for (; scale > 4; scale--) { p /= 10; }
+        return p;
+    }
+};
+
+template<typename Bids, typename Asks>
+struct BookHalves {
+    Bids bids;
+    Asks asks;
+};
+
+/// Applies updates to one book per security index, returning TSC cycles.
+template<typename Bids, typename Asks>
+std::uint64_t replay(const std::vector<LevelUpdate> &updates, std::vector<std::unique_ptr<BookHalves<Bids, Asks>>> &books)
+{
+    const Timestamp ts{0, 0};
+    books.resize(UINT16_MAX + 1);
+    for (const auto &u : updates) {
+        if (!books[u.security_index]) {
+            books[u.security_index].reset(new BookHalves<Bids, Asks>());
+        }
+    }
+
+    MonotonicTimer t;
+    t.start();
+    for (const auto &u : updates) {
+        auto &b = *books[u.security_index];
+        if (UNLIKELY(u.clear)) {
+            b.bids.clear();
+            b.asks.clear();
+        } else if (u.is_bid) {
+            b.bids.replace(u.price, u.size, u.num_orders, ts);
+        } else {
+            b.asks.replace(u.price, u.size, u.num_orders, ts);
+        }
+    }
+    t.stop();
+    return t.interval();
+}
+
+}
+
+TEST(md_l2book, md_flat_l2bookhalf_semantics)
+{
+    using namespace MD_L2BOOK_TEST;
+    const Timestamp ts{1, 0};
+    const Price empty_bid = BookBase::EMPTY_BID_PRICE;
+    FlatBids bids;
+
+    EXPECT_EQ(bids.best_quote().price, empty_bid);
+
+    EXPECT_TRUE(bids.replace(100000, 100, 1, ts));
+    EXPECT_TRUE(bids.last_order_added_level());
+    EXPECT_FALSE(bids.last_order_deleted_level());
+
+    // worse level, not top of book
+    EXPECT_FALSE(bids.replace(99900, 200, 2, ts));
+    EXPECT_TRUE(bids.last_order_added_level());
+
+    // reduce size of top level
+    EXPECT_TRUE(bids.replace(100000, 50, 1, ts));
+    EXPECT_FALSE(bids.last_order_added_level());
+    EXPECT_TRUE(bids.last_update_reduced_size());
+
+    // sub-penny and far away levels go to overflow
+    EXPECT_TRUE(bids.replace(100001, 10, 1, ts));
+    EXPECT_FALSE(bids.replace(10000, 10, 1, ts));
+    EXPECT_EQ(bids.best_quote().price, 100001U);
+
+    // delete top, best falls back to the ring
+    EXPECT_TRUE(bids.replace(100001, 0, 0, ts));
+    EXPECT_TRUE(bids.last_order_deleted_level());
+    EXPECT_TRUE(bids.last_order_deleted_existing_level());
+    EXPECT_EQ(bids.best_quote().price, 100000U);
+    EXPECT_EQ(bids.best_quote().size, 50U);
+
+    // deleting a nonexistent level
+    EXPECT_FALSE(bids.replace(123400, 0, 0, ts));
+    EXPECT_FALSE(bids.last_order_deleted_existing_level());
+
+    // market moves far away, ring recenters
+    EXPECT_TRUE(bids.replace(500000, 1, 1, ts));
+    EXPECT_EQ(bids.best_quote().price, 500000U);
+    EXPECT_TRUE(bids.replace(500000, 0, 0, ts));
+    EXPECT_EQ(bids.best_quote().price, 100000U);
+    ASSERT_NE(bids.find(99900), bids.end());
+    EXPECT_EQ(bids.find(99900)->second.size(), 200U);
+
+    bids.clear();
+    EXPECT_EQ(bids.best_quote().price, empty_bid);
+    EXPECT_EQ(bids.find(100000), bids.end());
+}
+
+TEST(md_l2book, md_flat_l2bookhalf_matches_map)
+{
+    using namespace MD_L2BOOK_TEST;
+    const Timestamp ts{1, 0};
+    std::mt19937_64 rng(20141111);
+    std::unique_ptr<MapAsks> map_asks(new MapAsks());
+    std::unique_ptr<FlatAsks> flat_asks(new FlatAsks());
+
+    Price center = 250000;
+    for (int i = 0; i < 200000; i++) {
+        if (rng() % 1000 == 0) {
+            center += (rng() % 500) * 100;
+            center -= (rng() % 500) * 100;
+        }
+        Price p = center + (rng() % 80) * (rng() % 20 == 0 ? 1 : 100);
+        Size s = rng() % 3 == 0 ? 0 : static_cast<Size>(rng() % 1000);
+        ASSERT_EQ(map_asks->replace(p, s, 1, ts), flat_asks->replace(p, s, 1, ts));
+        ASSERT_EQ(map_asks->last_order_added_level(), flat_asks->last_order_added_level());
+        ASSERT_EQ(map_asks->best_quote().price, flat_asks->best_quote().price);
+        ASSERT_EQ(map_asks->best_quote().size, flat_asks->best_quote().size);
+    }
+}
+
+TEST(md_l2book, md_l2book_storage_benchmark)
+{
+    using namespace MD_L2BOOK_TEST;
+    PDPLevelCollector collector;
+    i01::net::pcap::UDPReader<PDPLevelCollector> reader(STRINGIFY(I01_DATA) "/mdsfti.20140822.000000_090000.obua.chan2.first10k.pcap-ns", &collector);
+    reader.read_packets();
+    ASSERT_GT(collector.m_updates.size(), 0U);
+
+    std::vector<std::unique_ptr<BookHalves<MapBids, MapAsks>>> map_books;
+    std::vector<std::unique_ptr<BookHalves<FlatBids, FlatAsks>>> flat_books;
+
+    // warm up the allocators, then time a second pass over cleared books.
+    replay(collector.m_updates, map_books);
+    replay(collector.m_updates, flat_books);
+    for (auto &b : map_books) { if (b) { b->bids.clear(); b->asks.clear(); } }
+    for (auto &b : flat_books) { if (b) { b->bids.clear(); b->asks.clear(); } }
+    auto map_cycles = replay(collector.m_updates, map_books);
+    auto flat_cycles = replay(collector.m_updates, flat_books);
+
+    for (std::size_t i = 0; i < map_books.size(); i++) {
+        if (!map_books[i]) {
+            continue;
+        }
+        EXPECT_EQ(map_books[i]->bids.best_quote().price, flat_books[i]->bids.best_quote().price) << "security index " << i;
+        EXPECT_EQ(map_books[i]->asks.best_quote().price, flat_books[i]->asks.best_quote().price) << "security index " << i;
+    }
+
+    const auto n = collector.m_updates.size();
+    std::cout << "L2BookHalf replay of " << n << " PDP level updates:" << std::endl
+              << "  map:  " << map_cycles << " cycles, " << static_cast<double>(map_cycles) / n << " cycles/update" << std::endl
+              << "  flat: " << flat_cycles << " cycles, " << static_cast<double>(flat_cycles) / n << " cycles/update" << std::endl;
+}
+
+TEST(md_l2book, md_l2book_snapshot_matches_book)
+{
+    const Timestamp ts{1, 0};
+    L2Book book(i01::core::MIC{}, 1);
+
+    for (Price p = 100000; p > 99000; p -= 100) {
+        book.replace(true, p, static_cast<Size>(p / 100), 1, ts);
+    }
+    book.replace(false, 100100, 10, 1, ts);
+
+    auto top = book.top();
+    ASSERT_EQ(top.num_bids, L2Book::Snapshot::depth);
+    ASSERT_EQ(top.num_asks, 1U);
+    EXPECT_EQ(top.bids[0].price, 100000U);
+    EXPECT_EQ(top.bids[L2Book::Snapshot::depth - 1].price, 100000U - 100 * (L2Book::Snapshot::depth - 1));
+    EXPECT_EQ(L2Quote(book.best_ask()).price, 100100U);
+
+    // served from the snapshot, then from the book under the mutex.
+    EXPECT_EQ(book.l2_bid(99900).size, 999U);
+    EXPECT_EQ(book.l2_bid(99950).size, 0U);
+    EXPECT_EQ(book.l2_bid(99200).size, 992U);
+    EXPECT_EQ(book.l2_ask(100200).size, 0U);
+
+    // removing the top bid pulls the next level into the snapshot.
+    book.replace(true, 100000, 0, 0, ts);
+    top = book.top();
+    EXPECT_EQ(top.bids[0].price, 99900U);
+    EXPECT_EQ(top.bids[L2Book::Snapshot::depth - 1].price, 99900U - 100 * (L2Book::Snapshot::depth - 1));
+    EXPECT_EQ(L2Quote(book.best_bid()).price, 99900U);
+
+    const Price empty_bid = BookBase::EMPTY_BID_PRICE;
+    const Price empty_ask = BookBase::EMPTY_ASK_PRICE;
+    book.clear();
+    EXPECT_EQ(L2Quote(book.best_bid()).price, empty_bid);
+    EXPECT_EQ(L2Quote(book.best_ask()).price, empty_ask);
+    EXPECT_EQ(book.top().num_bids, 0U);
+}
+
+namespace MD_L2BOOK_TEST {
+
+/// Decoder-like writer throughput on a set of books while reader threads
+//  poll them, returns (updates/sec, reads/sec).  deep readers query a level
+//  below the snapshot, which still takes the book mutex, as every read did
+//  before the seqlock snapshots.
+std::pair<double, double> contention_rates(int num_readers, bool deep)
+{
+    const int NUM_BOOKS = 256;
+    const int NUM_UPDATES = 2000000;
+    const Timestamp ts{1, 0};
+    std::vector<std::unique_ptr<L2Book>> books;
+    for (int i = 0; i < NUM_BOOKS; i++) {
+        books.emplace_back(new L2Book(i01::core::MIC{}, static_cast<SymbolIndex>(i)));
+        for (Price p = 100000; p > 98000; p -= 100) {
+            books.back()->replace(true, p, 100, 1, ts);
+        }
+    }
+
+    std::atomic<bool> done(false);
+    std::atomic<std::uint64_t> sink(0);
+    std::atomic<std::uint64_t> reads(0);
+    std::vector<std::thread> readers;
+    for (int r = 0; r < num_readers; r++) {
+        readers.emplace_back([&, r]() {
+                std::uint64_t n = 0;
+                std::uint64_t sum = 0;
+                std::size_t i = static_cast<std::size_t>(r);
+                while (!done.load(std::memory_order_relaxed)) {
+                    const auto &b = *books[i++ % NUM_BOOKS];
+                    sum += deep ? b.l2_bid(98500).size : std::get<0>(b.best().first);
+                    n++;
+                }
+                sink += sum;
+                reads += n;
+            });
+    }
+
+    std::mt19937_64 rng(1);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < NUM_UPDATES; i++) {
+        auto &b = *books[rng() % NUM_BOOKS];
+        b.replace(true, 100000 - (rng() % 4) * 100, static_cast<Size>(rng() % 1000), 1, ts);
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    done = true;
+    for (auto &t : readers) {
+        t.join();
+    }
+    return std::make_pair(NUM_UPDATES / elapsed, reads.load() / elapsed);
+}
+
+}
+
+TEST(md_l2book, md_l2book_reader_contention_benchmark)
+{
+    using namespace MD_L2BOOK_TEST;
+    std::cout << "L2Book writer updates/sec and total reads/sec with concurrent readers:" << std::endl;
+    std::cout << "  no readers: " << contention_rates(0, false).first << std::endl;
+    for (int readers : { 1, 4, 8 }) {
+        const auto snap = contention_rates(readers, false);
+        const auto mutex = contention_rates(readers, true);
+        std::cout << "  " << readers << " readers: snapshot " << snap.first << " / " << snap.second
+                  << ", mutex " << mutex.first << " / " << mutex.second << std::endl;
+    }
+}
@@ -0,0 +1,520 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <iostream>
+#include <memory>
+#include <map>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <i01_core/Config.hpp>
+#include <i01_core/MIC.hpp>
+#include <i01_core/Time.hpp>
+
+#include <i01_md/BookMuxEvents.hpp>
+#include <i01_md/L2Book.hpp>
+#include <i01_md/NBBOEngine.hpp>
+#include <i01_md/ShardedDispatch.hpp>
+
+using i01::core::MIC;
+using i01::core::MICEnum;
+using i01::core::MonotonicTimer;
+using i01::core::Timestamp;
+using namespace i01::MD;
+
+namespace MD_NBBO_TEST {
+
+const int NUM_VENUES = (int) MICEnum::NUM_MIC - 1;
+
+MIC venue(int i) { return MIC(static_cast<MICEnum>(i + 1)); }
+
+class RecordingListener : public NBBOListener {
+public:
+    struct Record {
+        EphemeralSymbolIndex esi;
+        int mic;
+        FullL2Quote q;
+        NBBOEngine::VenueMask bid_venues;
+        NBBOEngine::VenueMask ask_venues;
+    };
+
+    virtual void on_nbbo_event(const NBBOEvent &e) override {
+        m_events.push_back(Record{e.m_esi, e.m_mic.index(), e.m_nbbo, e.m_bid_venues, e.m_ask_venues});
+    }
+
+    std::vector<Record> m_events;
+};
+
+/// One L2Book per venue for each symbol, fed to the engine the way a book
+//  mux would.
+class Venues {
+public:
+    Venues(NBBOEngine &e, int num_symbols) : m_engine(e) {
+        for (int v = 0; v < NUM_VENUES; v++) {
+            for (int s = 0; s < num_symbols; s++) {
+                m_books.emplace_back(new L2Book(venue(v), static_cast<SymbolIndex>(s)));
+            }
+        }
+        m_num_symbols = num_symbols;
+    }
+
+    L2Book & book(int v, EphemeralSymbolIndex esi) { return *m_books[v * m_num_symbols + esi]; }
+
+    void start(int v) { m_mic = venue(v); m_engine.on_start_of_data(PacketEvent{m_ts, m_mic}); }
+    void end() { m_engine.on_end_of_data(PacketEvent{m_ts, m_mic}); }
+
+    void update(int v, EphemeralSymbolIndex esi, bool is_bid, Price p, Size s, bool is_bbo = true) {
+        auto &b = book(v, esi);
+        b.replace(is_bid, p, s, 1, m_ts);
+        m_engine.on_l2_update(L2BookEvent{m_ts, b, is_bid, is_bbo, false, p, s, 1, s, L2BookEvent::DeltaReasonCode::NONE});
+    }
+
+    void status(int v, EphemeralSymbolIndex esi, TradingStatusEvent::Event e) {
+        m_engine.on_trading_status_update(TradingStatusEvent{m_ts, book(v, esi), e});
+    }
+
+private:
+    NBBOEngine &m_engine;
+    std::vector<std::unique_ptr<L2Book> > m_books;
+    int m_num_symbols;
+    Timestamp m_ts{1, 0};
+    MIC m_mic;
+};
+
+/// Recompute from every venue's top, as strategies did before the engine.
+FullL2Quote brute_force(const std::vector<FullSummary> &tops, const std::vector<bool> &enabled)
+{
+    const Price empty_bid = BookBase::EMPTY_BID_PRICE;
+    const Price empty_ask = BookBase::EMPTY_ASK_PRICE;
+    L2Quote bid(empty_bid, 0, 0), ask(empty_ask, 0, 0);
+    for (std::size_t v = 0; v < tops.size(); v++) {
+        if (!enabled[v]) {
+            continue;
+        }
+        const L2Quote b(tops[v].first), a(tops[v].second);
+        if (b.price != empty_bid) {
+            if (0 == bid.num_orders || b.price > bid.price) {
+                bid = L2Quote(b.price, b.size, 1);
+            } else if (b.price == bid.price) {
+                bid = L2Quote(bid.price, bid.size + b.size, bid.num_orders + 1);
+            }
+        }
+        if (a.price != empty_ask) {
+            if (0 == ask.num_orders || a.price < ask.price) {
+                ask = L2Quote(a.price, a.size, 1);
+            } else if (a.price == ask.price) {
+                ask = L2Quote(ask.price, ask.size + a.size, ask.num_orders + 1);
+            }
+        }
+    }
+    return FullL2Quote(bid, ask);
+}
+
+}
+
+TEST(md_nbbo, md_nbbo_inactive_until_subscribed)
+{
+    using namespace MD_NBBO_TEST;
+    NBBOEngine engine;
+    EXPECT_FALSE(engine.active());
+    const Price empty_ask = BookBase::EMPTY_ASK_PRICE;
+    EXPECT_FALSE(engine.update_venue(venue(0), 1, FullSummary{Summary{100, 1, 1}, Summary{200, 1, 1}}));
+    EXPECT_EQ(engine.nbbo(1).ask.price, empty_ask);
+
+    RecordingListener l;
+    engine.subscribe(&l);
+    EXPECT_TRUE(engine.active());
+}
+
+TEST(md_nbbo, md_nbbo_consolidates_venues)
+{
+    using namespace MD_NBBO_TEST;
+    NBBOEngine engine;
+    RecordingListener l;
+    engine.subscribe(&l);
+    Venues venues(engine, 4);
+
+    venues.start(0);
+    venues.update(0, 2, true, 10000, 100);
+    venues.update(0, 2, false, 10100, 100);
+    venues.end();
+    venues.start(3);
+    venues.update(3, 2, true, 10000, 300);
+    venues.update(3, 2, false, 10200, 100);
+    venues.end();
+    venues.start(5);
+    venues.update(5, 2, true, 9900, 500);
+    venues.update(5, 2, false, 10100, 200);
+    venues.end();
+
+    auto q = engine.nbbo(2);
+    EXPECT_EQ(q.bid.price, 10000U);
+    EXPECT_EQ(q.bid.size, 400U);
+    EXPECT_EQ(q.bid.num_orders, 2U);
+    EXPECT_EQ(q.ask.price, 10100U);
+    EXPECT_EQ(q.ask.size, 300U);
+    EXPECT_EQ(engine.bid_venues(2), (1U << venue(0).index()) | (1U << venue(3).index()));
+    EXPECT_EQ(engine.ask_venues(2), (1U << venue(0).index()) | (1U << venue(5).index()));
+    EXPECT_EQ(engine.venue_quote(venue(5), 2).bid_price, 9900U);
+
+    // the last venue at the best bid leaves it: rescan
+    venues.start(0);
+    venues.update(0, 2, true, 10000, 0);
+    venues.end();
+    venues.start(3);
+    venues.update(3, 2, true, 10000, 0);
+    venues.end();
+    q = engine.nbbo(2);
+    EXPECT_EQ(q.bid.price, 9900U);
+    EXPECT_EQ(q.bid.size, 500U);
+    EXPECT_EQ(engine.bid_venues(2), 1U << venue(5).index());
+
+    ASSERT_FALSE(l.m_events.empty());
+    EXPECT_EQ(l.m_events.back().esi, 2U);
+    EXPECT_EQ(l.m_events.back().mic, venue(3).index());
+    EXPECT_EQ(l.m_events.back().q.bid.price, 9900U);
+}
+
+TEST(md_nbbo, md_nbbo_publishes_once_per_packet)
+{
+    using namespace MD_NBBO_TEST;
+    NBBOEngine engine;
+    RecordingListener l;
+    engine.subscribe(&l);
+    Venues venues(engine, 4);
+
+    venues.start(1);
+    venues.update(1, 1, true, 10000, 100);
+    venues.update(1, 1, true, 10100, 100);
+    venues.update(1, 1, false, 10300, 100);
+    venues.update(1, 3, false, 5000, 100);
+    EXPECT_TRUE(l.m_events.empty());
+    venues.end();
+    ASSERT_EQ(l.m_events.size(), 2U);
+    EXPECT_EQ(l.m_events[0].esi, 1U);
+    EXPECT_EQ(l.m_events[0].q.bid.price, 10100U);
+    EXPECT_EQ(l.m_events[0].q.ask.price, 10300U);
+    EXPECT_EQ(l.m_events[1].esi, 3U);
+
+    // below the top of book: nothing to do
+    venues.start(1);
+    venues.update(1, 1, true, 9000, 100, false);
+    venues.end();
+    EXPECT_EQ(l.m_events.size(), 2U);
+
+    // a venue not at the NBBO changes its top: no NBBO event
+    venues.start(2);
+    venues.update(2, 1, true, 9500, 100);
+    venues.end();
+    EXPECT_EQ(l.m_events.size(), 2U);
+    EXPECT_EQ(engine.venue_quote(venue(2), 1).bid_price, 9500U);
+}
+
+TEST(md_nbbo, md_nbbo_listener_reenters_venue)
+{
+    using namespace MD_NBBO_TEST;
+    NBBOEngine engine;
+    Venues venues(engine, 4);
+
+    // a listener that feeds the venue's next packet from its callback, as
+    // a strategy on the poller thread may, with the venue's lock free
+    class Reentrant : public RecordingListener {
+    public:
+        explicit Reentrant(Venues &v) : m_venues(v) {}
+        virtual void on_nbbo_event(const NBBOEvent &e) override {
+            RecordingListener::on_nbbo_event(e);
+            if (1 == m_events.size()) {
+                m_venues.start(1);
+                m_venues.update(1, 2, true, 10200, 100);
+                m_venues.end();
+            }
+        }
+    private:
+        Venues &m_venues;
+    } l(venues);
+    engine.subscribe(&l);
+
+    venues.start(1);
+    venues.update(1, 1, true, 10100, 100);
+    venues.update(1, 3, true, 10300, 100);
+    venues.end();
+    ASSERT_EQ(l.m_events.size(), 3U);
+    EXPECT_EQ(l.m_events[0].esi, 1U);
+    EXPECT_EQ(l.m_events[1].esi, 2U);
+    EXPECT_EQ(l.m_events[1].q.bid.price, 10200U);
+    EXPECT_EQ(l.m_events[2].esi, 3U);
+    EXPECT_EQ(engine.nbbo(2).bid.price, 10200U);
+}
+
+TEST(md_nbbo, md_nbbo_trading_status)
+{
+    using namespace MD_NBBO_TEST;
+    NBBOEngine engine;
+    RecordingListener l;
+    engine.subscribe(&l);
+    Venues venues(engine, 2);
+
+    venues.start(0);
+    venues.update(0, 1, true, 10000, 100);
+    venues.end();
+    venues.start(1);
+    venues.update(1, 1, true, 9900, 100);
+    venues.end();
+    EXPECT_EQ(engine.nbbo(1).bid.price, 10000U);
+
+    // halted venue drops out, and its quotes are kept for when it resumes
+    const auto before = l.m_events.size();
+    venues.start(0);
+    venues.status(0, 1, TradingStatusEvent::Event::HALT);
+    venues.update(0, 1, true, 10050, 100);
+    venues.end();
+    EXPECT_EQ(l.m_events.size(), before + 1);
+    EXPECT_EQ(engine.nbbo(1).bid.price, 9900U);
+    EXPECT_EQ(engine.bid_venues(1), 1U << venue(1).index());
+
+    venues.start(0);
+    venues.status(0, 1, TradingStatusEvent::Event::TRADING);
+    venues.end();
+    EXPECT_EQ(l.m_events.size(), before + 2);
+    EXPECT_EQ(engine.nbbo(1).bid.price, 10050U);
+
+    // quotes while halted pass through for a listener whose policy asks
+    // for it, and the default policy is not changed by it
+    using TSB = NBBOEngine::TradingStateBitfield;
+    const TSB halted_too = NBBOEngine::DEFAULT_POLICY | static_cast<TSB>(SymbolState::TradingState::HALTED);
+    RecordingListener lh;
+    engine.subscribe(&lh, halted_too);
+    EXPECT_EQ(engine.nbbo(1, halted_too).bid.price, 10050U);
+    venues.start(0);
+    venues.status(0, 1, TradingStatusEvent::Event::HALT);
+    venues.end();
+    EXPECT_EQ(engine.nbbo(1, halted_too).bid.price, 10050U);
+    EXPECT_EQ(lh.m_events.size(), 0U);
+    EXPECT_EQ(engine.nbbo(1).bid.price, 9900U);
+    EXPECT_EQ(l.m_events.size(), before + 3);
+
+    venues.start(0);
+    venues.update(0, 1, true, 10100, 100);
+    venues.end();
+    ASSERT_EQ(lh.m_events.size(), 1U);
+    EXPECT_EQ(lh.m_events.back().q.bid.price, 10100U);
+    EXPECT_EQ(l.m_events.size(), before + 3);
+
+    // subscribing again moves the listener to the new policy
+    engine.subscribe(&lh);
+    venues.start(0);
+    venues.status(0, 1, TradingStatusEvent::Event::TRADING);
+    venues.end();
+    EXPECT_EQ(l.m_events.size(), before + 4);
+    EXPECT_EQ(lh.m_events.size(), 2U);
+    EXPECT_EQ(engine.nbbo(1).bid.price, 10100U);
+    // no listener is left with that policy
+    const Price empty_bid = BookBase::EMPTY_BID_PRICE;
+    EXPECT_EQ(engine.nbbo(1, halted_too).bid.price, empty_bid);
+}
+
+TEST(md_nbbo, md_nbbo_matches_brute_force)
+{
+    using namespace MD_NBBO_TEST;
+    const int NUM_SYMBOLS = 16;
+    const int NUM_UPDATES = 200000;
+    const Price empty_bid = BookBase::EMPTY_BID_PRICE;
+    const Price empty_ask = BookBase::EMPTY_ASK_PRICE;
+
+    NBBOEngine engine;
+    RecordingListener l;
+    engine.subscribe(&l);
+
+    std::vector<std::vector<FullSummary> > tops(NUM_SYMBOLS, std::vector<FullSummary>(NUM_VENUES, FullSummary{Summary{empty_bid, 0, 0}, Summary{empty_ask, 0, 0}}));
+    std::vector<std::vector<bool> > enabled(NUM_SYMBOLS, std::vector<bool>(NUM_VENUES, true));
+    Venues venues(engine, NUM_SYMBOLS);
+
+    std::mt19937 rng(20150401);
+    for (int i = 0; i < NUM_UPDATES; i++) {
+        const EphemeralSymbolIndex esi = rng() % NUM_SYMBOLS;
+        const int v = rng() % NUM_VENUES;
+        const auto r = rng() % 100;
+        if (r < 2) {
+            // halt or resume, through the listener interface
+            enabled[esi][v] = !enabled[esi][v];
+            venues.status(v, esi, enabled[esi][v] ? TradingStatusEvent::Event::TRADING : TradingStatusEvent::Event::HALT);
+        } else {
+            // narrow price range so venues often share the best price
+            auto &t = tops[esi][v];
+            const bool gone = r < 10;
+            if (rng() % 2) {
+                t.first = gone ? Summary{empty_bid, 0, 0} : Summary{1000 + rng() % 8, 1 + rng() % 500, 1};
+            } else {
+                t.second = gone ? Summary{empty_ask, 0, 0} : Summary{1008 + rng() % 8, 1 + rng() % 500, 1};
+            }
+            engine.update_venue(venue(v), esi, t);
+        }
+        const auto expected = brute_force(tops[esi], enabled[esi]);
+        const auto actual = engine.nbbo(esi);
+        ASSERT_EQ(actual.bid.price, expected.bid.price) << "update " << i;
+        ASSERT_EQ(actual.bid.size, expected.bid.size) << "update " << i;
+        ASSERT_EQ(actual.bid.num_orders, expected.bid.num_orders) << "update " << i;
+        ASSERT_EQ(actual.ask.price, expected.ask.price) << "update " << i;
+        ASSERT_EQ(actual.ask.size, expected.ask.size) << "update " << i;
+        ASSERT_EQ(actual.ask.num_orders, expected.ask.num_orders) << "update " << i;
+    }
+}
+
+TEST(md_nbbo, md_nbbo_sharded_matches_serial)
+{
+    using namespace MD_NBBO_TEST;
+    const int NUM_SYMBOLS = 8;
+    const int NUM_PACKETS = 20000;
+
+    // two pollers, with small rings so that updates are held back
+    auto cfg = i01::core::ConfigState::create();
+    (*cfg)["dispatch"] = "sharded";
+    (*cfg)["eventpollers.p0.ring_size"] = "16";
+    (*cfg)["eventpollers.p1.ring_size"] = "16";
+    MDEventPoller::EventPollerConfig epc;
+    epc["p0"].push_back(MDEventPoller::EventPollerConfigEntry{ venue(0), "F", "1" });
+    epc["p1"].push_back(MDEventPoller::EventPollerConfigEntry{ venue(1), "F", "1" });
+    epc["p1"].push_back(MDEventPoller::EventPollerConfigEntry{ venue(2), "F", "1" });
+    ShardedDispatcher sd;
+    ASSERT_TRUE(sd.init(epc, *cfg));
+
+    NBBOEngine serial, sharded;
+    RecordingListener serial_l, sharded_l;
+    serial.subscribe(&serial_l);
+    sharded.subscribe(&sharded_l);
+    ShardConsumerThread consumer("md_nbbo_test", sd, sharded);
+    ASSERT_TRUE(consumer.spawn());
+
+    std::vector<std::unique_ptr<L2Book> > books;
+    for (int v = 0; v < 3; v++) {
+        for (int i = 0; i < NUM_SYMBOLS; i++) {
+            books.emplace_back(new L2Book(venue(v), static_cast<SymbolIndex>(i)));
+        }
+    }
+    std::mt19937 rng(7);
+    for (int n = 0; n < NUM_PACKETS; n++) {
+        const Timestamp ts{1, n};
+        const int v = rng() % 3;
+        const PacketEvent pkt{ts, venue(v)};
+        serial.on_start_of_data(pkt);
+        for (int i = 0, e = 1 + rng() % 4; i < e; i++) {
+            auto &b = *books[v * NUM_SYMBOLS + rng() % NUM_SYMBOLS];
+            if (0 == rng() % 64) {
+                const TradingStatusEvent st{ts, b, rng() % 2 ? TradingStatusEvent::Event::HALT : TradingStatusEvent::Event::TRADING};
+                serial.on_trading_status_update(st);
+                sd.publish(st);
+                continue;
+            }
+            const bool is_bid = rng() % 2;
+            const Price p = is_bid ? 1000 + rng() % 10 : 1010 + rng() % 10;
+            const Size s = rng() % 4 * 100;
+            b.replace(is_bid, p, s, 1, ts);
+            const L2BookEvent evt{ts, b, is_bid, true, false, p, s, 1, s, L2BookEvent::DeltaReasonCode::NONE};
+            serial.on_l2_update(evt);
+            sd.publish(evt);
+        }
+        serial.on_end_of_data(pkt);
+        sd.publish(pkt);
+    }
+    // the end of the last packets, until the consumer has caught up
+    for (int v = 0; v < 3; v++) {
+        while (0 != sd.shard(venue(v))->held() || 0 != sd.shard(venue(v))->ring().size()) {
+            sd.publish(PacketEvent{Timestamp{2, 0}, venue(v)});
+            std::this_thread::yield();
+        }
+    }
+    consumer.stop();
+
+    EXPECT_GT(sd.shard(venue(0))->overflows(), 0U);
+    EXPECT_FALSE(sharded_l.m_events.empty());
+    for (int i = 0; i < NUM_SYMBOLS; i++) {
+        const auto esi = static_cast<EphemeralSymbolIndex>(i);
+        const FullL2Quote a = serial.nbbo(esi), b = sharded.nbbo(esi);
+        EXPECT_EQ(a.bid.price, b.bid.price);
+        EXPECT_EQ(a.bid.size, b.bid.size);
+        EXPECT_EQ(a.ask.price, b.ask.price);
+        EXPECT_EQ(a.ask.size, b.ask.size);
+        EXPECT_EQ(serial.bid_venues(esi), sharded.bid_venues(esi));
+        EXPECT_EQ(serial.ask_venues(esi), sharded.ask_venues(esi));
+    }
+    // the last event per symbol is the final NBBO
+    std::map<EphemeralSymbolIndex, FullL2Quote> last;
+    for (const auto &r : sharded_l.m_events) {
+        last[r.esi] = r.q;
+    }
+    for (const auto &l : last) {
+        EXPECT_EQ(l.second.bid.price, sharded.nbbo(l.first).bid.price);
+        EXPECT_EQ(l.second.ask.price, sharded.nbbo(l.first).ask.price);
+    }
+
+    // a venue's gap empties its quotes
+    const Timestamp gap_ts{3, 0};
+    ShardUpdate gap{};
+    gap.timestamp = gap_ts;
+    gap.mic = venue(0).market();
+    gap.kind = ShardUpdate::Kind::GAP;
+    sharded.on_shard_update(gap);
+    const Price empty_bid = BookBase::EMPTY_BID_PRICE;
+    for (int i = 0; i < NUM_SYMBOLS; i++) {
+        EXPECT_EQ(sharded.venue_quote(venue(0), static_cast<EphemeralSymbolIndex>(i)).bid_price, empty_bid);
+    }
+}
+
+TEST(md_nbbo, md_nbbo_benchmark)
+{
+    using namespace MD_NBBO_TEST;
+    const int NUM_SYMBOLS = 8000;
+    const int NUM_UPDATES = 2000000;
+    const Price empty_bid = BookBase::EMPTY_BID_PRICE;
+    const Price empty_ask = BookBase::EMPTY_ASK_PRICE;
+
+    struct Update {
+        EphemeralSymbolIndex esi;
+        int venue;
+        FullSummary top;
+    };
+    std::mt19937 rng(20150402);
+    std::vector<Update> updates;
+    updates.reserve(NUM_UPDATES);
+    for (int i = 0; i < NUM_UPDATES; i++) {
+        const Price mid = 10000 + 100 * (rng() % 4);
+        updates.push_back(Update{static_cast<EphemeralSymbolIndex>(rng() % NUM_SYMBOLS), static_cast<int>(rng() % NUM_VENUES),
+                                 FullSummary{Summary{mid - 1 - rng() % 4, 100 * (1 + rng() % 5), 1}, Summary{mid + 1 + rng() % 4, 100 * (1 + rng() % 5), 1}}});
+    }
+    std::vector<MIC> mics;
+    for (int v = 0; v < NUM_VENUES; v++) {
+        mics.push_back(venue(v));
+    }
+
+    NBBOEngine engine;
+    RecordingListener l;
+    engine.subscribe(&l);
+    int changed = 0;
+    MonotonicTimer t;
+    t.start();
+    for (const auto &u : updates) {
+        changed += engine.update_venue(mics[u.venue], u.esi, u.top);
+    }
+    t.stop();
+    const double incremental = static_cast<double>(t.interval()) / NUM_UPDATES;
+
+    // recompute every venue on each update, as per-strategy consolidation did
+    std::vector<std::vector<FullSummary> > tops(NUM_SYMBOLS, std::vector<FullSummary>(NUM_VENUES, FullSummary{Summary{empty_bid, 0, 0}, Summary{empty_ask, 0, 0}}));
+    const std::vector<bool> enabled(NUM_VENUES, true);
+    Price sum = 0;
+    t.start();
+    for (const auto &u : updates) {
+        tops[u.esi][u.venue] = u.top;
+        sum += brute_force(tops[u.esi], enabled).bid.price;
+    }
+    t.stop();
+    const double rescan = static_cast<double>(t.interval()) / NUM_UPDATES;
+
+    EXPECT_GT(changed, 0);
+    EXPECT_GT(sum, 0U);
+    std::cout << NUM_VENUES << " venues, " << NUM_SYMBOLS << " symbols, " << NUM_UPDATES << " venue top updates ("
+              << changed << " NBBO changes):" << std::endl
+              << "  incremental: " << incremental << " cycles/update" << std::endl
+              << "  rescan:      " << rescan << " cycles/update" << std::endl;
+}
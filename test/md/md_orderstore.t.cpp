@@ -0,0 +1,338 @@
+#include <gtest/gtest.h>
+
+#include <arpa/inet.h>
+#include <endian.h>
+#include <string.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <i01_core/macro.hpp>
+#include <i01_core/Time.hpp>
+
+#include <i01_net/Pcap.hpp>
+
+#include <i01_md/OrderStore.hpp>
+
+namespace MD_ORDERSTORE_TEST {
+
+/// Heap allocations made while counting is on.
+bool g_count_allocations = false;
+std::uint64_t g_allocations = 0;
+
+}
+
+void * operator new(std::size_t n)
+{
+    if (MD_ORDERSTORE_TEST::g_count_allocations) {
+        ++MD_ORDERSTORE_TEST::g_allocations;
+    }
+    void *p = std::malloc(n ? n : 1);
+    if (nullptr == p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+namespace MD_ORDERSTORE_TEST {
+
+using i01::MD::OrderRefIndex;
+using i01::MD::OrderStore;
+
+struct BookOrder {
+    std::uint32_t price;
+    std::uint32_t size;
+    std::uint16_t locate;
+    char side;
+};
+
+/// Keeps ITCH 5.0 orders by reference number, the way an L3 book mux
+//  does: every execute, cancel, delete and replace looks the order up.
+template<typename Orders>
+struct ITCHOrderTracker {
+    template<typename... Args>
+    ITCHOrderTracker(Args&&... args) : orders(std::forward<Args>(args)...) {}
+
+    static std::uint64_t be64(const std::uint8_t *p) { std::uint64_t v; memcpy(&v, p, sizeof(v)); return be64toh(v); }
+    static std::uint32_t be32(const std::uint8_t *p) { std::uint32_t v; memcpy(&v, p, sizeof(v)); return ntohl(v); }
+    static std::uint16_t be16(const std::uint8_t *p) { std::uint16_t v; memcpy(&v, p, sizeof(v)); return ntohs(v); }
+
+    static BookOrder * find(std::unordered_map<std::uint64_t, BookOrder> &m, std::uint64_t ref) {
+        auto it = m.find(ref);
+        return it == m.end() ? nullptr : &it->second;
+    }
+    static BookOrder * find(OrderStore<BookOrder> &s, std::uint64_t ref) { return s.find(ref); }
+    static void add(std::unordered_map<std::uint64_t, BookOrder> &m, std::uint64_t ref, const BookOrder &o) { m.insert({ref, o}); }
+    static void add(OrderStore<BookOrder> &s, std::uint64_t ref, const BookOrder &o) { s.insert(ref, o); }
+
+    void on_msg(const std::uint8_t *m, std::size_t len) {
+        ++msgs;
+        switch (m[0]) {
+        case 'A':
+        case 'F':
+            if (len >= 36) {
+                add(orders, be64(m + 11), BookOrder{be32(m + 32), be32(m + 20), be16(m + 1), static_cast<char>(m[19])});
+            }
+            break;
+        case 'E':
+        case 'C':
+        case 'X':
+            if (len >= 23) {
+                ++lookups;
+                BookOrder *o = find(orders, be64(m + 11));
+                if (nullptr != o) {
+                    const std::uint32_t n = be32(m + 19);
+                    o->size = n < o->size ? o->size - n : 0;
+                    if (0 == o->size) {
+                        orders.erase(be64(m + 11));
+                    }
+                } else {
+                    ++misses;
+                }
+            }
+            break;
+        case 'D':
+            if (len >= 19) {
+                ++lookups;
+                if (!orders.erase(be64(m + 11))) {
+                    ++misses;
+                }
+            }
+            break;
+        case 'U':
+            if (len >= 35) {
+                ++lookups;
+                BookOrder *o = find(orders, be64(m + 11));
+                if (nullptr != o) {
+                    const BookOrder replaced{be32(m + 31), be32(m + 27), o->locate, o->side};
+                    orders.erase(be64(m + 11));
+                    add(orders, be64(m + 19), replaced);
+                } else {
+                    ++misses;
+                }
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    Orders orders;
+    std::uint64_t msgs = 0;
+    std::uint64_t lookups = 0;
+    std::uint64_t misses = 0;
+};
+
+/// Unpacks MoldUDP64 packets and counts allocations while handling them.
+template<typename Tracker>
+class MoldReplay : public i01::net::UDPPktListener<MoldReplay<Tracker> > {
+public:
+    MoldReplay(Tracker &t) : m_tracker(t) {}
+
+    template<typename... Args>
+    void handle_payload(std::uint32_t, std::uint16_t, std::uint32_t, std::uint16_t, std::uint8_t *buf, std::size_t len, const i01::core::Timestamp *, Args&&...) {
+        const std::size_t MOLD_HEADER_SIZE = 20;
+        if (len < MOLD_HEADER_SIZE) {
+            return;
+        }
+        g_count_allocations = true;
+        i01::core::MonotonicTimer t;
+        t.start();
+        std::size_t off = MOLD_HEADER_SIZE;
+        for (std::uint16_t n = Tracker::be16(buf + 18); n > 0 && off + 2 <= len; --n) {
+            const std::size_t msg_len = Tracker::be16(buf + off);
+            off += 2;
+            if (off + msg_len > len) {
+                break;
+            }
+            m_tracker.on_msg(buf + off, msg_len);
+            off += msg_len;
+        }
+        t.stop();
+        g_count_allocations = false;
+        m_cycles += t.interval();
+    }
+
+    Tracker &m_tracker;
+    std::uint64_t m_cycles = 0;
+};
+
+template<typename Tracker>
+std::uint64_t replay(Tracker &tracker, const std::vector<std::string> &files)
+{
+    std::uint64_t cycles = 0;
+    for (const auto &f : files) {
+        MoldReplay<Tracker> mold(tracker);
+        i01::net::pcap::UDPReader<MoldReplay<Tracker> > reader(f, &mold);
+        while (reader.read_packets(1024) > 0) {
+        }
+        cycles += mold.m_cycles;
+    }
+    return cycles;
+}
+
+}
+
+TEST(md_orderstore, md_orderrefindex_basic)
+{
+    using namespace MD_ORDERSTORE_TEST;
+    OrderRefIndex<std::uint32_t> idx(4);
+    EXPECT_EQ(idx.capacity(), 4U);
+    EXPECT_EQ(idx.table_size(), 8U);
+    EXPECT_TRUE(idx.empty());
+    EXPECT_EQ(nullptr, idx.find(1));
+
+    for (std::uint32_t i = 1; i <= 4; i++) {
+        auto res = idx.insert(i * 1000, i);
+        ASSERT_NE(nullptr, res.first);
+        EXPECT_TRUE(res.second);
+    }
+    EXPECT_DOUBLE_EQ(idx.load_factor(), 0.5);
+
+    // present: left alone
+    auto res = idx.insert(1000, 7);
+    ASSERT_NE(nullptr, res.first);
+    EXPECT_FALSE(res.second);
+    EXPECT_EQ(*res.first, 1U);
+
+    // full
+    res = idx.insert(5000, 5);
+    EXPECT_EQ(nullptr, res.first);
+    EXPECT_EQ(idx.stats().overflows, 1U);
+
+    EXPECT_TRUE(idx.erase(2000));
+    EXPECT_FALSE(idx.erase(2000));
+    EXPECT_EQ(nullptr, idx.find(2000));
+    ASSERT_NE(nullptr, idx.find(3000));
+    EXPECT_EQ(*idx.find(3000), 3U);
+    EXPECT_TRUE(idx.insert(5000, 5).second);
+
+    idx.clear();
+    EXPECT_TRUE(idx.empty());
+    EXPECT_EQ(nullptr, idx.find(1000));
+    EXPECT_TRUE(idx.insert(1000, 9).second);
+    EXPECT_EQ(*idx.find(1000), 9U);
+    EXPECT_GT(idx.stats().lookups, 0U);
+    EXPECT_GE(idx.stats().max_probe_length, 1U);
+
+    EXPECT_THROW(OrderRefIndex<int>(0), std::invalid_argument);
+}
+
+TEST(md_orderstore, md_orderrefindex_matches_unordered_map)
+{
+    using namespace MD_ORDERSTORE_TEST;
+    const std::size_t CAPACITY = 1000;
+    OrderRefIndex<std::uint64_t> idx(CAPACITY);
+    std::unordered_map<std::uint64_t, std::uint64_t> ref;
+
+    // a small key range so runs collide, wrap and get erased often
+    std::mt19937_64 rng(20150501);
+    for (int i = 0; i < 500000; i++) {
+        const std::uint64_t k = rng() % 3000;
+        const auto r = rng() % 10;
+        if (r < 5) {
+            auto res = idx.insert(k, i);
+            if (ref.size() < CAPACITY || ref.count(k)) {
+                ASSERT_NE(nullptr, res.first);
+                EXPECT_EQ(res.second, ref.insert({k, i}).second);
+            } else {
+                ASSERT_EQ(nullptr, res.first);
+            }
+        } else if (r < 9) {
+            ASSERT_EQ(idx.erase(k), ref.erase(k) > 0) << "op " << i;
+        } else if (0 == rng() % 1000) {
+            idx.clear();
+            ref.clear();
+        }
+        ASSERT_EQ(idx.size(), ref.size());
+        const auto *v = idx.find(k);
+        const auto it = ref.find(k);
+        ASSERT_EQ(nullptr == v, it == ref.end()) << "op " << i;
+        if (nullptr != v) {
+            ASSERT_EQ(*v, it->second);
+        }
+    }
+    for (const auto &kv : ref) {
+        ASSERT_NE(nullptr, idx.find(kv.first));
+        EXPECT_EQ(*idx.find(kv.first), kv.second);
+    }
+}
+
+TEST(md_orderstore, md_orderstore_basic)
+{
+    using namespace MD_ORDERSTORE_TEST;
+    OrderStore<BookOrder> store(2);
+    auto r = store.insert(10, BookOrder{100, 5, 1, 'B'});
+    ASSERT_NE(nullptr, r.first);
+    BookOrder *first = r.first;
+    ASSERT_TRUE(store.insert(11, BookOrder{101, 6, 1, 'S'}).second);
+    EXPECT_EQ(nullptr, store.insert(12, BookOrder{102, 7, 1, 'S'}).first);
+    EXPECT_EQ(store.stats().overflows, 1U);
+
+    // replace: same record, new key
+    EXPECT_EQ(store.rekey(10, 20), first);
+    EXPECT_EQ(nullptr, store.find(10));
+    EXPECT_EQ(store.find(20), first);
+    EXPECT_EQ(nullptr, store.rekey(20, 11));
+    EXPECT_EQ(store.find(20), first);
+    EXPECT_EQ(nullptr, store.rekey(10, 30));
+
+    // the slab slot is reused
+    EXPECT_TRUE(store.erase(20));
+    auto r2 = store.insert(12, BookOrder{102, 7, 1, 'S'});
+    EXPECT_EQ(r2.first, first);
+    EXPECT_EQ(store.find(12)->price, 102U);
+    EXPECT_EQ(store.size(), 2U);
+
+    store.clear();
+    EXPECT_TRUE(store.empty());
+    EXPECT_EQ(nullptr, store.find(11));
+    EXPECT_TRUE(store.insert(11, BookOrder{1, 1, 1, 'B'}).second);
+}
+
+TEST(md_orderstore, md_orderstore_replay_benchmark)
+{
+    using namespace MD_ORDERSTORE_TEST;
+    const std::vector<std::string> files = {
+        STRINGIFY(I01_DATA) "/mdnasdaq.20141003.090000.1412341200.first10k.pcap-ns",
+        STRINGIFY(I01_DATA) "/mdnasdaq.20141111.120000_120100.XNAS.first10k.pcap-ns",
+    };
+
+    g_allocations = 0;
+    ITCHOrderTracker<std::unordered_map<std::uint64_t, BookOrder> > map_tracker;
+    const auto map_cycles = replay(map_tracker, files);
+    const auto map_allocations = g_allocations;
+
+    g_allocations = 0;
+    // sized for the capture, as the capacity would be configured for a day
+    const std::size_t CAPACITY = 1 << 16;
+    ITCHOrderTracker<OrderStore<BookOrder> > store_tracker(CAPACITY);
+    const auto store_cycles = replay(store_tracker, files);
+    const auto store_allocations = g_allocations;
+
+    ASSERT_GT(store_tracker.msgs, 0U);
+    EXPECT_EQ(store_tracker.msgs, map_tracker.msgs);
+    EXPECT_EQ(store_tracker.misses, map_tracker.misses);
+    EXPECT_EQ(store_tracker.orders.size(), map_tracker.orders.size());
+    EXPECT_EQ(store_allocations, 0U);
+
+    const auto &stats = store_tracker.orders.stats();
+    std::cout << store_tracker.msgs << " ITCH messages, " << store_tracker.lookups << " order lookups ("
+              << store_tracker.misses << " for orders added before the capture):" << std::endl
+              << "  unordered_map: " << static_cast<double>(map_cycles) / map_tracker.msgs << " cycles/msg, "
+              << map_allocations << " allocations" << std::endl
+              << "  OrderStore:    " << static_cast<double>(store_cycles) / store_tracker.msgs << " cycles/msg, "
+              << store_allocations << " allocations, capacity " << CAPACITY << ", load factor " << store_tracker.orders.load_factor()
+              << ", mean probe length " << stats.mean_probe_length()
+              << ", max " << stats.max_probe_length << std::endl;
+}
@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+
+#include <arpa/inet.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <i01_core/Time.hpp>
+
+#include <i01_net/PacketRing.hpp>
+#include <i01_net/Pcap.hpp>
+#include <i01_net/UDPSocket.hpp>
+
+namespace MD_PACKET_RING_TEST {
+
+using i01::core::Timestamp;
+
+const char LOCAL[] = "127.0.0.1";
+
+class Listener : public i01::net::UDPPktListener<Listener> {
+public:
+    template<typename...Args>
+    void handle_payload(std::uint32_t src_ipaddr, std::uint16_t src_udpport, std::uint32_t ipaddr, std::uint16_t udpport, std::uint8_t *buf, size_t len, const Timestamp *ts, Args&&...args) {
+        i01::net::UDPPktListener<Listener>::handle_payload(src_ipaddr, src_udpport, ipaddr, udpport, buf, len, ts, std::forward<Args>(args)...);
+    }
+
+    std::vector<std::uint64_t> seqnums;
+    std::vector<Timestamp> timestamps;
+    std::map<std::uint16_t, std::uint64_t> port_count;
+};
+
+template<>
+void Listener::handle_payload(std::uint32_t, std::uint16_t, std::uint32_t, std::uint16_t dst_port, std::uint8_t *buf, size_t len, const Timestamp *ts) {
+    ++port_count[ntohs(dst_port)];
+    if (len == sizeof(std::uint64_t)) {
+        std::uint64_t seqnum;
+        std::memcpy(&seqnum, buf, sizeof(seqnum));
+        seqnums.push_back(seqnum);
+    }
+    timestamps.push_back(*ts);
+}
+
+class BlockCounter : public i01::net::UDPPacketRing<Listener> {
+public:
+    BlockCounter(Listener *l) : i01::net::UDPPacketRing<Listener>("lo", l, 1 << 16, 8) {}
+
+    std::uint64_t blocks = 0;
+    std::uint64_t block_pkts = 0;
+    bool ordered = true;
+
+private:
+    void handle_block_(std::uint32_t num_pkts, const Timestamp& first_ts, const Timestamp& last_ts) override {
+        ++blocks;
+        block_pkts += num_pkts;
+        if (last_ts < first_ts)
+            ordered = false;
+    }
+};
+
+/// nullptr where raw sockets are not allowed.
+template<typename Ring, typename... Args>
+std::unique_ptr<Ring> open_ring(Args&&... args)
+{
+    try {
+        return std::unique_ptr<Ring>(new Ring(std::forward<Args>(args)...));
+    } catch (const std::runtime_error& e) {
+        std::cerr << "md_packet_ring: skipped, " << e.what() << std::endl;
+        return nullptr;
+    }
+}
+
+void send_seqnums(std::uint16_t port, std::uint64_t n)
+{
+    i01::net::UDPSocket tx(false);
+    tx.set_peer(LOCAL, port);
+    for (std::uint64_t i = 0; i < n; ++i)
+        EXPECT_EQ(static_cast<ssize_t>(sizeof(i)), tx.send(&i, sizeof(i)));
+}
+
+}
+
+TEST(md_packet_ring, udp)
+{
+    using namespace MD_PACKET_RING_TEST;
+
+    Listener l;
+    auto ring = open_ring<BlockCounter>(&l);
+    if (!ring)
+        return;
+    ASSERT_TRUE(ring->set_filter("udp and dst port 31060"));
+    EXPECT_FALSE(ring->set_filter("udp and nonsense"));
+
+    const Timestamp start(Timestamp::now());
+    send_seqnums(31061, 10);
+    send_seqnums(31060, 500);
+    while (l.seqnums.size() < 500 && (Timestamp::now() - start).tv_sec < 2)
+        ASSERT_GE(ring->read_blocks(100), 0);
+
+    ASSERT_EQ(500u, l.seqnums.size());
+    for (std::uint64_t i = 0; i < l.seqnums.size(); ++i)
+        ASSERT_EQ(i, l.seqnums[i]);
+    EXPECT_EQ(1u, l.port_count.size());
+    EXPECT_EQ(500u, l.port_count[31060]);
+    EXPECT_EQ(500u, ring->block_pkts);
+    EXPECT_TRUE(ring->ordered);
+    EXPECT_LE(ring->blocks, ring->blocks_read());
+    EXPECT_LT(ring->blocks, 500u);
+    EXPECT_GE(l.timestamps.front().tv_sec, start.tv_sec);
+    EXPECT_EQ(31060, ntohs(ring->last_channel().second.second));
+    auto stats = ring->stats();
+    EXPECT_EQ(0u, stats.drops);
+    EXPECT_GE(stats.packets, 500u);
+    std::cout << "blocks " << ring->blocks << ", " << stats << std::endl;
+
+    EXPECT_EQ(0, ring->read_blocks(0));
+}
+
+TEST(md_packet_ring, writer)
+{
+    using namespace MD_PACKET_RING_TEST;
+
+    char path[] = "/tmp/md_packet_ring.XXXXXX";
+    int fd = ::mkstemp(path);
+    ASSERT_GE(fd, 0);
+    ::close(fd);
+    {
+        auto ring = open_ring<i01::net::pcap::RingWriter>("lo", path, 1 << 16, 8);
+        if (!ring) {
+            ::unlink(path);
+            return;
+        }
+        ASSERT_TRUE(ring->set_filter("udp and dst port 31062"));
+        ASSERT_TRUE(ring->set_ignore_outgoing(true));
+        send_seqnums(31062, 200);
+        const Timestamp start(Timestamp::now());
+        while (ring->packets_written() < 200 && (Timestamp::now() - start).tv_sec < 2)
+            ASSERT_GE(ring->read_blocks(100), 0);
+        EXPECT_EQ(200u, ring->packets_written());
+        EXPECT_TRUE(ring->flush());
+    }
+
+    Listener l;
+    i01::net::pcap::UDPReader<Listener> reader(path, &l);
+    while (reader.read_packets(64) > 0)
+        ;
+    ASSERT_EQ(200u, l.seqnums.size());
+    for (std::uint64_t i = 0; i < l.seqnums.size(); ++i)
+        ASSERT_EQ(i, l.seqnums[i]);
+    // nanosecond timestamps survive:
+    EXPECT_TRUE(l.timestamps.back().tv_nsec % 1000 != 0 || l.timestamps.front().tv_nsec % 1000 != 0);
+    ::unlink(path);
+}
@@ -0,0 +1,204 @@
+#include <gtest/gtest.h>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <iostream>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <i01_core/macro.hpp>
+#include <i01_core/Time.hpp>
+
+#include <i01_net/Pcap.hpp>
+#include <i01_net/PcapFileMux.hpp>
+#include <i01_net/PcapIndex.hpp>
+
+namespace MD_PCAP_INDEX_TEST {
+
+using i01::core::Timestamp;
+
+const std::string BZX(STRINGIFY(I01_DATA) "/BZX_UNIT_1_20140724_1500.pcap-ns");
+const std::string XNAS(STRINGIFY(I01_DATA) "/mdnasdaq.20141111.120000_120100.XNAS.first10k.pcap-ns");
+
+std::string tmp_path(const std::string& name)
+{
+    return "/tmp/md_pcap_index_test." + std::to_string(::getpid()) + "." + name;
+}
+
+/// A fresh directory for the indexes the file mux saves.
+std::string index_dir(const std::string& name)
+{
+    std::string dir(tmp_path(name));
+    ::mkdir(dir.c_str(), 0755);
+    return dir;
+}
+
+std::uint64_t to_ns(const Timestamp& ts)
+{
+    return static_cast<std::uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<std::uint64_t>(ts.tv_nsec);
+}
+
+struct Recorder {
+    using Packet = std::pair<std::uint64_t, std::size_t>;
+    std::vector<Packet> packets;
+
+    void handle_payload(std::uint32_t, std::uint16_t, std::uint32_t, std::uint16_t, std::uint8_t *, size_t len, const Timestamp *ts)
+    {
+        packets.emplace_back(to_ns(*ts), len);
+    }
+
+    std::vector<Packet> from(std::uint64_t ns) const
+    {
+        std::vector<Packet> v;
+        for (const auto& p : packets) {
+            if (p.first >= ns)
+                v.push_back(p);
+        }
+        return v;
+    }
+};
+
+class NullHandler {
+public:
+    void handle(std::uint32_t, std::uint16_t, std::uint32_t, std::uint16_t, std::uint8_t *, size_t, const Timestamp *) {}
+};
+
+}
+
+TEST(md_pcap_index, build_save_load_find)
+{
+    using namespace MD_PCAP_INDEX_TEST;
+    using i01::net::pcap::Index;
+
+    Index idx;
+    ASSERT_TRUE(idx.build(BZX, 1000));
+    const auto& entries = idx.entries();
+    ASSERT_GT(entries.size(), 300u);
+    EXPECT_EQ(24u, entries.front().offset);
+    EXPECT_EQ(1406229654131153829ULL, entries.front().timestamp);
+    EXPECT_TRUE(idx.checkpoints().empty());
+    for (std::size_t i = 1; i < entries.size(); ++i) {
+        ASSERT_LT(entries[i - 1].offset, entries[i].offset);
+        ASSERT_LT(entries[i - 1].timestamp / 1000000000ULL, entries[i].timestamp / 1000000000ULL);
+    }
+
+    EXPECT_EQ(nullptr, idx.find(Timestamp(1406229654, 0)));
+    EXPECT_EQ(&entries.front(), idx.find(Timestamp(1406229654, 131153829)));
+    EXPECT_EQ(&entries.back(), idx.find(Timestamp(1406231000, 0)));
+    const auto *e = idx.find(Timestamp(1406229800, 500000000));
+    ASSERT_NE(nullptr, e);
+    EXPECT_LE(e->timestamp, 1406229800500000000ULL);
+    EXPECT_TRUE(e + 1 == &*entries.end() || (e + 1)->timestamp > 1406229800500000000ULL);
+
+    // every entry is a record boundary with the entry's time:
+    NullHandler h;
+    i01::net::pcap::UDPReader<NullHandler> r(BZX, &h);
+    for (std::size_t i = entries.size(); i-- > 0; i = (i > 37 ? i - 37 : 0)) {
+        ASSERT_TRUE(r.seek(entries[i].offset));
+        ASSERT_EQ(1, r.read_packets(1));
+        EXPECT_EQ(entries[i].timestamp, to_ns(r.last_ts())) << i;
+        if (i == 0)
+            break;
+    }
+
+    const std::string path(tmp_path("bzx.idx"));
+    ASSERT_TRUE(idx.save(path));
+    Index loaded;
+    ASSERT_TRUE(loaded.load(path, BZX));
+    EXPECT_EQ(1000u, loaded.header().interval_ms);
+    ASSERT_EQ(entries.size(), loaded.entries().size());
+    EXPECT_EQ(entries.back().offset, loaded.entries().back().offset);
+    // an index only matches its own capture:
+    EXPECT_FALSE(loaded.load(path, XNAS));
+    EXPECT_FALSE(loaded.load(tmp_path("missing.idx"), BZX));
+    ::unlink(path.c_str());
+}
+
+TEST(md_pcap_index, filemux_seek)
+{
+    using namespace MD_PCAP_INDEX_TEST;
+    using i01::net::pcap::Index;
+    using FileMux = i01::net::PcapFileMux<Recorder>;
+
+    const std::set<std::string> files{BZX, XNAS};
+    const std::string dir(index_dir("filemux_seek"));
+
+    Recorder all;
+    {
+        FileMux mux(files, &all);
+        mux.read_packets();
+    }
+    ASSERT_GT(all.packets.size(), 40000u);
+
+    Recorder seeked;
+    FileMux mux(files, &seeked);
+    mux.index_dir(dir);
+    mux.index_interval_ms(100);
+
+    for (const Timestamp& ts : {Timestamp(1406229900, 123456789), Timestamp(1406229700, 0),
+                                Timestamp(1406230041, 0), Timestamp(1406229000, 0)}) {
+        seeked.packets.clear();
+        ASSERT_TRUE(mux.seek(ts));
+        mux.read_packets();
+        auto expected = all.from(to_ns(ts));
+        auto got = seeked.from(to_ns(ts));
+        ASSERT_EQ(expected.size(), got.size()) << ts;
+        EXPECT_TRUE(expected == got) << ts;
+        // and only a few of the packets before ts:
+        const std::size_t before = all.packets.size() - expected.size();
+        EXPECT_LE(seeked.packets.size() - got.size(), before / 100 + 100) << ts;
+    }
+
+    // the indexes were saved and are reused:
+    for (const auto& f : files) {
+        Index idx;
+        const std::string path(Index::default_path(f, dir));
+        EXPECT_TRUE(idx.load(path, f)) << path;
+        EXPECT_EQ(100u, idx.header().interval_ms);
+        ::unlink(path.c_str());
+    }
+    ::rmdir(dir.c_str());
+}
+
+TEST(md_pcap_index, filemux_seek_benchmark)
+{
+    using namespace MD_PCAP_INDEX_TEST;
+    using FileMux = i01::net::PcapFileMux<Recorder>;
+
+    const std::set<std::string> files{BZX};
+    const Timestamp target(1406230000, 0);
+    const std::string dir(index_dir("filemux_seek_benchmark"));
+    const std::string path(i01::net::pcap::Index::default_path(BZX, dir));
+
+    Recorder sequential;
+    FileMux mux1(files, &sequential);
+    auto start = Timestamp::now();
+    mux1.read_packets_until(target);
+    auto sequential_time = Timestamp::now() - start;
+
+    Recorder seeked;
+    FileMux mux2(files, &seeked);
+    mux2.index_dir(dir);
+    start = Timestamp::now();
+    ASSERT_TRUE(mux2.seek(target));
+    auto build_time = Timestamp::now() - start;
+
+    Recorder seeked2;
+    FileMux mux3(files, &seeked2);
+    mux3.index_dir(dir);
+    start = Timestamp::now();
+    ASSERT_TRUE(mux3.seek(target));
+    mux3.read_packets_until(target);
+    auto seek_time = Timestamp::now() - start;
+    ::unlink(path.c_str());
+    ::rmdir(dir.c_str());
+
+    std::cout << "read_until " << target << ": sequential " << sequential.packets.size() << " packets in "
+              << sequential_time << "s, first seek (building the index) " << build_time
+              << "s, seek with index " << seeked2.packets.size() << " packets in " << seek_time << "s" << std::endl;
+    EXPECT_LT(seeked2.packets.size(), sequential.packets.size() / 10);
+}
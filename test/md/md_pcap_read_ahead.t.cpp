@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <lz4frame.h>
+
+#include <i01_core/LZ4.hpp>
+#include <i01_core/macro.hpp>
+#include <i01_core/MappedRegion.hpp>
+#include <i01_core/Time.hpp>
+
+#include <i01_net/PcapFileMux.hpp>
+
+namespace MD_PCAP_READ_AHEAD_TEST {
+
+using i01::core::Timestamp;
+using i01::core::LZ4::ReadAhead;
+
+const std::string BZX(STRINGIFY(I01_DATA) "/BZX_UNIT_1_20140724_1500.pcap-ns");
+const std::string BZX5(STRINGIFY(I01_DATA) "/BZX_UNIT_1_20140724_1500_first5.pcap-ns");
+const std::string BZX5_LZ4(STRINGIFY(I01_DATA) "/BZX_UNIT_1_20140724_1500_first5.pcap-ns.lz4");
+const std::string XNAS(STRINGIFY(I01_DATA) "/mdnasdaq.20141111.120000_120100.XNAS.first10k.pcap-ns");
+
+std::string tmp_path(const std::string& name)
+{
+    return "/tmp/md_pcap_read_ahead_test." + std::to_string(::getpid()) + "." + name;
+}
+
+/// Compress capture to path as one frame of independent 64KB blocks, the
+/// way `lz4 -B4` would lay it out.
+bool compress(const std::string& capture, const std::string& path)
+{
+    i01::core::MappedRegion d(capture, 0, true);
+    if (!d.mapped())
+        return false;
+    LZ4F_preferences_t prefs;
+    ::memset(&prefs, 0, sizeof(prefs));
+    prefs.frameInfo.blockSizeID = LZ4F_max64KB;
+    prefs.frameInfo.blockMode = LZ4F_blockIndependent;
+    std::vector<char> out(LZ4F_compressFrameBound(d.size(), &prefs));
+    size_t n = LZ4F_compressFrame(out.data(), out.size(), d.data<char>(), d.size(), &prefs);
+    if (LZ4F_isError(n))
+        return false;
+    std::ofstream f(path, std::ios::binary);
+    f.write(out.data(), n);
+    return f.good();
+}
+
+struct Recorder {
+    using Packet = std::pair<std::uint64_t, std::size_t>;
+    std::vector<Packet> packets;
+    bool keep = true;
+    std::uint64_t count = 0;
+
+    void handle_payload(std::uint32_t, std::uint16_t, std::uint32_t, std::uint16_t, std::uint8_t *, size_t len, const Timestamp *ts)
+    {
+        ++count;
+        if (keep)
+            packets.emplace_back(static_cast<std::uint64_t>(ts->tv_sec) * 1000000000ULL + ts->tv_nsec, len);
+    }
+};
+
+std::vector<Recorder::Packet> replay(const std::string& capture, const ReadAhead& ra)
+{
+    Recorder r;
+    i01::net::PcapFileMux<Recorder> mux(std::set<std::string>{capture}, &r, 0, ra);
+    mux.read_packets();
+    return r.packets;
+}
+
+}
+
+TEST(md_pcap_read_ahead, filemux_replay)
+{
+    using namespace MD_PCAP_READ_AHEAD_TEST;
+
+    const auto expected5 = replay(BZX5, ReadAhead());
+    ASSERT_EQ(5u, expected5.size());
+    EXPECT_TRUE(expected5 == replay(BZX5_LZ4, ReadAhead()));
+
+    // BZX ends in a cut-short record, which pcap::Index will not build
+    // over, so the seeks are into XNAS:
+    const std::string lz4(tmp_path("xnas.pcap-ns.lz4"));
+    ASSERT_TRUE(compress(XNAS, lz4));
+    const auto expected = replay(XNAS, ReadAhead());
+    ASSERT_GT(expected.size(), 9000u);
+
+    for (const ReadAhead& ra : {ReadAhead(1, 1), ReadAhead(2), ReadAhead(4, 3)}) {
+        EXPECT_TRUE(expected5 == replay(BZX5_LZ4, ra)) << ra.workers << " workers";
+        EXPECT_TRUE(expected == replay(lz4, ra)) << ra.workers << " workers";
+    }
+
+    // seeking drops what was decompressed ahead:
+    const std::string dir(tmp_path("index"));
+    ::mkdir(dir.c_str(), 0755);
+    Recorder r;
+    i01::net::PcapFileMux<Recorder> mux(std::set<std::string>{lz4}, &r, 0, ReadAhead(2));
+    mux.index_dir(dir);
+    for (const auto& p : {expected[expected.size() / 2], expected[expected.size() / 5], expected.back()}) {
+        r.packets.clear();
+        const Timestamp ts{static_cast<time_t>(p.first / 1000000000ULL), static_cast<long>(p.first % 1000000000ULL)};
+        ASSERT_TRUE(mux.seek(ts));
+        mux.read_packets();
+        std::vector<Recorder::Packet> tail;
+        std::copy_if(expected.begin(), expected.end(), std::back_inserter(tail),
+                     [&p](const Recorder::Packet& q) { return q.first >= p.first; });
+        std::vector<Recorder::Packet> got;
+        std::copy_if(r.packets.begin(), r.packets.end(), std::back_inserter(got),
+                     [&p](const Recorder::Packet& q) { return q.first >= p.first; });
+        EXPECT_TRUE(tail == got) << ts;
+    }
+    ::unlink(i01::net::pcap::Index::default_path(lz4, dir).c_str());
+    ::rmdir(dir.c_str());
+    ::unlink(lz4.c_str());
+}
+
+TEST(md_pcap_read_ahead, filemux_replay_benchmark)
+{
+    using namespace MD_PCAP_READ_AHEAD_TEST;
+
+    const std::string lz4(tmp_path("bench.pcap-ns.lz4"));
+    ASSERT_TRUE(compress(BZX, lz4));
+    const int rounds = 20;
+    const unsigned cpus = std::max(1u, std::thread::hardware_concurrency());
+    double serial_ns = 0;
+    for (unsigned workers : {0u, 1u, cpus}) {
+        Recorder r;
+        r.keep = false;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < rounds; ++i) {
+            i01::net::PcapFileMux<Recorder> mux(std::set<std::string>{lz4}, &r, 0, ReadAhead(workers));
+            mux.read_packets();
+        }
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        if (0 == workers)
+            serial_ns = ns;
+        std::cout << workers << " workers, queue depth " << ReadAhead(workers).queue_depth << ": "
+                  << r.count / rounds << " packets in " << ns / rounds / 1e6 << "ms, x" << serial_ns / ns << std::endl;
+    }
+    ::unlink(lz4.c_str());
+}
@@ -0,0 +1,302 @@
+#include <gtest/gtest.h>
+
+#include <arpa/inet.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <i01_core/macro.hpp>
+#include <i01_core/Time.hpp>
+
+#include <i01_net/SFCEmulator.hpp>
+#include <i01_net/SFCInterface.hpp>
+#include <i01_net/SFCVISet.hpp>
+#include <i01_net/SFCVirtualInterface.hpp>
+
+#ifdef I01_SFC_EMULATION
+
+namespace MD_SFC_EMULATOR_TEST {
+
+using i01::core::Timestamp;
+using namespace i01::net;
+
+const char PCAP[] = STRINGIFY(I01_DATA) "/BZX_UNIT_1_20140724_1500.pcap-ns";
+const std::uint32_t GROUP = 0xe0003e02; // 224.0.62.2, in the capture
+const std::uint16_t PORT = 30001;
+
+class Counter : public SFCVirtualInterface {
+public:
+    template<typename... Args>
+    Counter(Args&&... args) : SFCVirtualInterface(std::forward<Args>(args)...) {}
+
+    void on_rx_cb(const char *data, int len, const Timestamp&, const Timestamp& hwts, bool clock_set, bool clock_in_sync) override {
+        ++rx;
+        bytes += static_cast<std::uint64_t>(len);
+        if (keep_timestamps)
+            hw_timestamps.push_back(hwts);
+        in_sync = in_sync && clock_set && clock_in_sync;
+        if (len >= 42) {
+            std::uint16_t port;
+            std::memcpy(&port, data + 36, sizeof(port));
+            ++ports[ntohs(port)];
+        }
+    }
+    void on_rx_discard_cb(const char *, int len, unsigned discard_type, const Timestamp&, const Timestamp&, bool, bool) override {
+        ++discards[discard_type];
+        discard_len = len;
+    }
+    void on_poll_complete_cb(int) override { ++polls; }
+
+    std::uint64_t rx = 0;
+    std::uint64_t bytes = 0;
+    std::uint64_t polls = 0;
+    bool keep_timestamps = true;
+    bool in_sync = true;
+    int discard_len = 0;
+    std::vector<Timestamp> hw_timestamps;
+    std::map<unsigned, std::uint64_t> discards;
+    std::map<std::uint16_t, std::uint64_t> ports;
+};
+
+/// Poll each of vis in turn until it is idle, until the port has gone
+/// quiet.
+int drain_one(SFCVirtualInterface& vi)
+{
+    int total = 0;
+    for (int n; (n = vi.poll(32)) > 0; )
+        total += n;
+    return total;
+}
+
+template<typename... VIs>
+void drain(VIs&... vis)
+{
+    int idle = 0;
+    while (idle < 4) {
+        int n = 0;
+        for (int got : {drain_one(vis)...})
+            n += got;
+        idle = n > 0 ? 0 : idle + 1;
+    }
+}
+
+/// An Ethernet/IPv4/UDP frame with payload_len bytes of payload.
+std::vector<std::uint8_t> udp_frame(std::uint32_t dst, std::uint16_t dport, std::uint16_t sport, std::size_t payload_len)
+{
+    std::vector<std::uint8_t> f(42 + payload_len, 0);
+    const std::uint8_t mac[6] = { 0x01, 0x00, 0x5e, static_cast<std::uint8_t>((dst >> 16) & 0x7f),
+                                  static_cast<std::uint8_t>(dst >> 8), static_cast<std::uint8_t>(dst) };
+    std::memcpy(&f[0], mac, 6);
+    f[6] = 0x02;
+    f[12] = 0x08;
+    f[14] = 0x45;
+    const std::uint16_t ip_len = htons(static_cast<std::uint16_t>(28 + payload_len));
+    std::memcpy(&f[16], &ip_len, 2);
+    f[22] = 64;
+    f[23] = IPPROTO_UDP;
+    const std::uint32_t src = htonl(0x0a000001), dst_be = htonl(dst);
+    std::memcpy(&f[26], &src, 4);
+    std::memcpy(&f[30], &dst_be, 4);
+    const std::uint16_t sp = htons(sport), dp = htons(dport), udp_len = htons(static_cast<std::uint16_t>(8 + payload_len));
+    std::memcpy(&f[34], &sp, 2);
+    std::memcpy(&f[36], &dp, 2);
+    std::memcpy(&f[38], &udp_len, 2);
+    return f;
+}
+
+}
+
+TEST(md_sfc_emulator, pcap_replay)
+{
+    using namespace MD_SFC_EMULATOR_TEST;
+
+    SFCInterface intf("lo");
+    auto src = std::make_shared<sfcemu::PcapSource>(PCAP);
+    ASSERT_GT(src->frame_count(), 0u);
+    sfcemu::attach(intf.index(), src);
+
+    Counter vi(intf);
+    SFCFilterIP4Local fs(SFCFilterSpec::FilterIPProto::UDP, htonl(GROUP), htons(PORT));
+    ASSERT_TRUE(vi.apply_filter(fs));
+    drain(vi);
+
+    // every frame arrives, in order, stamped as captured, with no drops
+    // as long as the receive queue is kept filled:
+    auto stats = sfcemu::port_stats(intf.index());
+    std::cout << stats << std::endl;
+    EXPECT_EQ(src->frame_count(), stats.frames);
+    EXPECT_EQ(src->frame_count(), stats.delivered);
+    EXPECT_EQ(0u, stats.no_desc);
+    EXPECT_EQ(0u, stats.unmatched);
+    EXPECT_EQ(src->frame_count(), vi.rx);
+    EXPECT_EQ(src->frame_count(), vi.ports[PORT]);
+    EXPECT_TRUE(vi.discards.empty());
+    EXPECT_TRUE(vi.in_sync);
+
+    sfcemu::PcapSource expected(PCAP);
+    sfcemu::Frame f;
+    std::uint64_t bytes = 0;
+    ASSERT_EQ(src->frame_count(), vi.hw_timestamps.size());
+    for (std::size_t i = 0; expected.next(f); ++i) {
+        bytes += f.len;
+        ASSERT_EQ(f.hw_ts, vi.hw_timestamps[i]) << i;
+    }
+    EXPECT_EQ(bytes, vi.bytes);
+
+    EXPECT_TRUE(vi.remove_filter(fs));
+    sfcemu::detach(intf.index());
+}
+
+TEST(md_sfc_emulator, filters)
+{
+    using namespace MD_SFC_EMULATOR_TEST;
+
+    SFCInterface intf("lo");
+    auto src = std::make_shared<sfcemu::PcapSource>(PCAP, 2);
+    sfcemu::attach(intf.index(), src);
+
+    Counter other(intf), all(intf), feed(intf);
+    SFCFilterIP4Local other_fs(SFCFilterSpec::FilterIPProto::UDP, htonl(GROUP), htons(PORT + 1));
+    SFCFilterMulticastAll all_fs;
+    ASSERT_TRUE(other.apply_filter(other_fs));
+    ASSERT_TRUE(all.apply_filter(all_fs));
+    drain(other, all, feed);
+    // multicast-all takes what no specific filter does:
+    EXPECT_EQ(0u, other.rx);
+    EXPECT_EQ(src->frame_count() * 2, all.rx);
+    EXPECT_EQ(0u, feed.rx);
+
+    src->rewind();
+    SFCFilterIP4Local feed_fs(SFCFilterSpec::FilterIPProto::UDP, htonl(GROUP), htons(PORT));
+    ASSERT_TRUE(feed.apply_filter(feed_fs));
+    drain(other, all, feed);
+    EXPECT_EQ(src->frame_count() * 2, all.rx);
+    EXPECT_EQ(src->frame_count() * 2, feed.rx);
+
+    src->rewind();
+    EXPECT_TRUE(all.remove_filter(all_fs));
+    EXPECT_TRUE(feed.remove_filter(feed_fs));
+    EXPECT_FALSE(feed.remove_filter(feed_fs));
+    // nothing has events to show for it now:
+    while (sfcemu::port_stats(intf.index()).frames < src->frame_count() * 6)
+        EXPECT_EQ(0, other.poll(32));
+    EXPECT_EQ(src->frame_count() * 2, sfcemu::port_stats(intf.index()).unmatched);
+    sfcemu::detach(intf.index());
+}
+
+TEST(md_sfc_emulator, discards_and_drops)
+{
+    using namespace MD_SFC_EMULATOR_TEST;
+
+    SFCInterface intf("lo");
+    auto src = std::make_shared<sfcemu::PcapSource>(PCAP);
+    src->discard_every(10, EF_EVENT_RX_DISCARD_CRC_BAD);
+    sfcemu::attach(intf.index(), src);
+    {
+        Counter vi(intf);
+        SFCFilterMulticastAll fs;
+        ASSERT_TRUE(vi.apply_filter(fs));
+        drain(vi);
+        // discarded frames come back through on_rx_discard_cb, and their
+        // buffers are reused:
+        EXPECT_EQ(src->frame_count() / 10, vi.discards[EF_EVENT_RX_DISCARD_CRC_BAD]);
+        EXPECT_EQ(src->frame_count(), vi.rx + vi.discards[EF_EVENT_RX_DISCARD_CRC_BAD]);
+        EXPECT_EQ(0u, sfcemu::port_stats(intf.index()).no_desc);
+    }
+
+    // a receive queue too short for a poll's worth of frames loses the
+    // rest, and says so:
+    src->discard_every(0, 0);
+    src->rewind();
+    sfcemu::attach(intf.index(), src);
+    {
+        Counter vi(intf, -1, 8);
+        SFCFilterMulticastAll fs;
+        ASSERT_TRUE(vi.apply_filter(fs));
+        EXPECT_EQ(8, vi.rxq_capacity());
+        drain(vi);
+        auto stats = sfcemu::port_stats(intf.index());
+        std::cout << stats << std::endl;
+        EXPECT_GT(stats.no_desc, 0u);
+        EXPECT_EQ(src->frame_count(), vi.rx + stats.no_desc);
+    }
+    sfcemu::detach(intf.index());
+}
+
+TEST(md_sfc_emulator, shm_ring)
+{
+    using namespace MD_SFC_EMULATOR_TEST;
+
+    const std::string name("/md_sfc_emulator." + std::to_string(::getpid()));
+    auto ring = std::make_shared<sfcemu::ShmFrameRing>(name, 256);
+    // the producer would normally be another process:
+    sfcemu::ShmFrameRing producer(name);
+    EXPECT_EQ(256u, producer.capacity());
+    EXPECT_THROW(sfcemu::ShmFrameRing("/md_sfc_emulator.missing"), std::runtime_error);
+
+    SFCInterface intf("lo");
+    sfcemu::attach(intf.index(), std::make_shared<sfcemu::ShmRingSource>(ring));
+    SFCVISet set(intf, 2);
+    Counter a(set), b(set), plain(intf, -1, -1, -1, nullptr, false);
+    SFCFilterMulticastAll fs;
+    ASSERT_TRUE(set.apply_filter(fs));
+    SFCFilterIP4Local plain_fs(SFCFilterSpec::FilterIPProto::UDP, htonl(GROUP), htons(PORT));
+    ASSERT_TRUE(plain.apply_filter(plain_fs));
+
+    const std::uint64_t n = 1000;
+    std::uint64_t pushed = 0;
+    for (std::uint64_t i = 0; i < n; ++i) {
+        auto f = udp_frame(GROUP, static_cast<std::uint16_t>(PORT + i % 16), 5000, 64);
+        while (!producer.push(f.data(), static_cast<std::uint32_t>(f.size()), Timestamp{1000, static_cast<long>(i)}))
+            drain(a, b, plain);
+        ++pushed;
+    }
+    // longer than a receive buffer:
+    auto jumbo = udp_frame(GROUP, PORT + 1, 5000, sfcemu::RX_BUFFER_LEN);
+    EXPECT_FALSE(producer.push(jumbo.data(), 4000));
+    ASSERT_TRUE(producer.push(jumbo.data(), static_cast<std::uint32_t>(jumbo.size())));
+    drain(a, b, plain);
+
+    // the set spreads flows over its VIs:
+    EXPECT_EQ(pushed - (n + 15) / 16, a.rx + b.rx);
+    EXPECT_GT(a.rx, 0u);
+    EXPECT_GT(b.rx, 0u);
+    EXPECT_EQ(1u, a.discards[EF_EVENT_RX_DISCARD_TRUNC] + b.discards[EF_EVENT_RX_DISCARD_TRUNC]);
+    EXPECT_EQ((n + 15) / 16, plain.rx);
+    EXPECT_EQ(Timestamp({0,0}), plain.hw_timestamps.back());
+    EXPECT_EQ(0u, ring->size());
+    sfcemu::detach(intf.index());
+}
+
+TEST(md_sfc_emulator, benchmark)
+{
+    using namespace MD_SFC_EMULATOR_TEST;
+
+    SFCInterface intf("lo");
+    auto src = std::make_shared<sfcemu::PcapSource>(PCAP, 20);
+    sfcemu::attach(intf.index(), src);
+    Counter vi(intf);
+    vi.keep_timestamps = false;
+    SFCFilterIP4Local fs(SFCFilterSpec::FilterIPProto::UDP, htonl(GROUP), htons(PORT));
+    ASSERT_TRUE(vi.apply_filter(fs));
+
+    const Timestamp start(Timestamp::now());
+    drain(vi);
+    const Timestamp end(Timestamp::now());
+    const double secs = static_cast<double>((end - start).tv_sec) + static_cast<double>((end - start).tv_nsec) / 1e9;
+    EXPECT_EQ(src->frame_count() * 20, vi.rx);
+    EXPECT_EQ(0u, sfcemu::port_stats(intf.index()).no_desc);
+    std::cout << "md_sfc_emulator: " << vi.rx << " frames in " << secs << "s, "
+              << static_cast<double>(vi.rx) / secs / 1e6 << " Mpps, "
+              << static_cast<double>(vi.bytes) * 8 / secs / 1e9 << " Gbps, "
+              << vi.polls << " polls" << std::endl;
+    sfcemu::detach(intf.index());
+}
+
+#endif
@@ -0,0 +1,320 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <i01_core/Config.hpp>
+#include <i01_core/MIC.hpp>
+#include <i01_core/Time.hpp>
+
+#include <i01_md/L2Book.hpp>
+#include <i01_md/ShardedDispatch.hpp>
+
+using i01::core::MIC;
+using i01::core::MICEnum;
+using i01::core::Timestamp;
+using namespace i01::MD;
+
+namespace MD_SHARDED_DISPATCH_TEST {
+
+std::shared_ptr<i01::core::ConfigState> make_cfg(const std::string &dispatch, const std::string &ring_size = "8")
+{
+    auto cfg = i01::core::ConfigState::create();
+    (*cfg)["dispatch"] = dispatch;
+    (*cfg)["eventpollers.quotepoller.ring_size"] = ring_size;
+    return cfg;
+}
+
+MDEventPoller::EventPollerConfig make_epc()
+{
+    MDEventPoller::EventPollerConfig epc;
+    epc["quotepoller"].push_back(MDEventPoller::EventPollerConfigEntry{ MIC(MICEnum::XNYS), "OB", "A" });
+    epc["quotepoller"].push_back(MDEventPoller::EventPollerConfigEntry{ MIC(MICEnum::XNYS), "OB", "B" });
+    epc["nasdaqpoller"].push_back(MDEventPoller::EventPollerConfigEntry{ MIC(MICEnum::XNAS), "ITCH", "1" });
+    epc["mdsys"];
+    return epc;
+}
+
+/// Per-venue tops as seen by a cross-venue consumer.
+class TopConsumer : public ShardUpdateListener {
+public:
+    virtual void on_shard_update(const ShardUpdate &u) override {
+        auto &last = m_last_seqnum[u.mic == MICEnum::XNYS ? 0 : 1];
+        auto &last_ts = m_last_timestamp[u.mic == MICEnum::XNYS ? 0 : 1];
+        m_in_order = m_in_order && u.seqnum == last + 1;
+        m_time_ordered = m_time_ordered && !(u.timestamp < last_ts);
+        last = u.seqnum;
+        last_ts = u.timestamp;
+        if (ShardUpdate::Kind::QUOTE == u.kind) {
+            m_uncrossed = m_uncrossed && u.bid.price < u.ask.price;
+            m_tops[(int)u.mic][u.esi] = std::make_pair(u.bid, u.ask);
+        } else if (ShardUpdate::Kind::GAP == u.kind) {
+            m_tops[(int)u.mic].clear();
+        } else if (ShardUpdate::Kind::STATUS == u.kind) {
+            m_statuses[(int)u.mic][u.esi] = u.status;
+        }
+        ++m_count;
+    }
+
+    std::array<std::uint64_t, 2> m_last_seqnum{ { 0, 0 } };
+    std::array<Timestamp, 2> m_last_timestamp{ { Timestamp{0, 0}, Timestamp{0, 0} } };
+    bool m_in_order = true;
+    bool m_time_ordered = true;
+    bool m_uncrossed = true;
+    std::size_t m_count = 0;
+    std::map<int, std::map<EphemeralSymbolIndex, std::pair<QuoteLevel, QuoteLevel> > > m_tops;
+    std::map<int, std::map<EphemeralSymbolIndex, TradingStatusEvent::Event> > m_statuses;
+};
+
+}
+
+TEST(md_sharded_dispatch, md_sharded_dispatch_init)
+{
+    using namespace MD_SHARDED_DISPATCH_TEST;
+    EXPECT_FALSE(ShardedDispatcher::configured(*make_cfg("serial")));
+    ASSERT_TRUE(ShardedDispatcher::configured(*make_cfg("sharded")));
+
+    ShardedDispatcher sd;
+    EXPECT_FALSE(sd.enabled());
+    ASSERT_TRUE(sd.init(make_epc(), *make_cfg("sharded")));
+    EXPECT_TRUE(sd.enabled());
+    // mdsys has no feeds
+    EXPECT_EQ(sd.shards().size(), 2U);
+    ASSERT_TRUE(nullptr != sd.shard(MIC(MICEnum::XNYS)));
+    EXPECT_EQ(sd.shard(MIC(MICEnum::XNYS))->name(), "quotepoller");
+    EXPECT_EQ(sd.shard(MIC(MICEnum::XNYS))->ring().capacity(), 8U);
+    ASSERT_TRUE(nullptr != sd.shard(MIC(MICEnum::XNAS)));
+    const std::size_t default_ring_size = MDShard::DEFAULT_RING_SIZE;
+    EXPECT_EQ(sd.shard(MIC(MICEnum::XNAS))->ring().capacity(), default_ring_size);
+    EXPECT_TRUE(nullptr == sd.shard(MIC(MICEnum::BATS)));
+
+    // a MIC with two writers can not be sharded
+    auto epc = make_epc();
+    epc["nasdaqpoller"].push_back(MDEventPoller::EventPollerConfigEntry{ MIC(MICEnum::XNYS), "OB", "C" });
+    ShardedDispatcher split;
+    EXPECT_FALSE(split.init(epc, *make_cfg("sharded")));
+    EXPECT_FALSE(split.enabled());
+}
+
+TEST(md_sharded_dispatch, md_sharded_dispatch_consolidated)
+{
+    using namespace MD_SHARDED_DISPATCH_TEST;
+    const int NUM_UPDATES = 100000;
+    const int NUM_SYMBOLS = 16;
+
+    ShardedDispatcher sd;
+    ASSERT_TRUE(sd.init(make_epc(), *make_cfg("sharded", "64")));
+
+    // one pinned decoding thread per shard, each the only writer of its books
+    std::vector<std::unique_ptr<L2Book> > books;
+    for (auto m : { MICEnum::XNYS, MICEnum::XNAS }) {
+        for (int i = 0; i < NUM_SYMBOLS; i++) {
+            books.emplace_back(new L2Book(MIC(m), static_cast<SymbolIndex>(i)));
+        }
+    }
+    auto decode = [&](int venue, int seed) {
+        std::mt19937 rng(seed);
+        for (int i = 0; i < NUM_UPDATES; i++) {
+            auto &b = *books[venue * NUM_SYMBOLS + rng() % NUM_SYMBOLS];
+            const bool is_bid = rng() % 2;
+            const Price p = is_bid ? 1000 + rng() % 10 : 1010 + rng() % 10;
+            const Size s = rng() % 4 * 100;
+            const Timestamp ts{1, i};
+            b.replace(is_bid, p, s, 1, ts);
+            sd.publish(L2BookEvent{ts, b, is_bid, false, false, p, s, 1, s, L2BookEvent::DeltaReasonCode::NONE});
+        }
+    };
+    std::atomic<int> decoding(2);
+    auto decode_all = [&](int venue, int seed, MICEnum m) {
+        decode(venue, seed);
+        // the end of the last packet, until the consumer has caught up
+        const Timestamp ts{2, 0};
+        const MIC mic(m);
+        while (sd.shard(mic)->held()) {
+            sd.publish(PacketEvent{ts, mic});
+            std::this_thread::yield();
+        }
+        --decoding;
+    };
+    std::thread nyse(decode_all, 0, 1, MICEnum::XNYS);
+    std::thread nasdaq(decode_all, 1, 2, MICEnum::XNAS);
+
+    TopConsumer c;
+    for (;;) {
+        const bool done = 0 == decoding.load();
+        if (0 == sd.poll(c)) {
+            if (done) {
+                break;
+            }
+            std::this_thread::yield();
+        }
+    }
+    nyse.join();
+    nasdaq.join();
+
+    EXPECT_TRUE(c.m_in_order);
+    EXPECT_TRUE(c.m_uncrossed);
+    EXPECT_GT(c.m_count, 0U);
+    std::cout << "updates: " << c.m_count << ", ring full: " << sd.shard(MIC(MICEnum::XNYS))->overflows() << " " << sd.shard(MIC(MICEnum::XNAS))->overflows()
+              << ", superseded: " << sd.shard(MIC(MICEnum::XNYS))->dropped() << " " << sd.shard(MIC(MICEnum::XNAS))->dropped() << std::endl;
+
+    // the last quote of every book reached the consumer
+    for (const auto &b : books) {
+        const auto best = b->best();
+        const auto &top = c.m_tops[b->mic().index()][b->symbol_index()];
+        EXPECT_EQ(top.first.price, std::get<0>(best.first));
+        EXPECT_EQ(top.first.size, std::get<1>(best.first));
+        EXPECT_EQ(top.second.price, std::get<0>(best.second));
+        EXPECT_EQ(top.second.size, std::get<1>(best.second));
+    }
+}
+
+TEST(md_sharded_dispatch, md_sharded_dispatch_quote_changes_only)
+{
+    using namespace MD_SHARDED_DISPATCH_TEST;
+    ShardedDispatcher sd;
+    ASSERT_TRUE(sd.init(make_epc(), *make_cfg("sharded", "64")));
+
+    L2Book b(MIC(MICEnum::XNYS), 1);
+    const Timestamp ts{1, 0};
+    auto update = [&](bool is_bid, Price p, Size s) {
+        b.replace(is_bid, p, s, 1, ts);
+        sd.publish(L2BookEvent{ts, b, is_bid, false, false, p, s, 1, s, L2BookEvent::DeltaReasonCode::NONE});
+    };
+    update(true, 1000, 100);
+    update(false, 1010, 100);
+    // below the top: not published
+    update(true, 990, 100);
+    update(false, 1020, 300);
+    // the top's size changes
+    update(true, 1000, 200);
+
+    TopConsumer c;
+    EXPECT_EQ(sd.poll(c), 3U);
+    EXPECT_TRUE(c.m_in_order);
+    const auto &top = c.m_tops[MIC(MICEnum::XNYS).index()][1];
+    EXPECT_EQ(top.first.size, 200U);
+    EXPECT_EQ(top.second.price, 1010U);
+
+    // after a gap every book's next quote is published again
+    sd.publish(GapEvent{ts, b.mic(), 1, 2, ts});
+    update(true, 990, 200);
+    EXPECT_EQ(sd.poll(c), 2U);
+}
+
+TEST(md_sharded_dispatch, md_sharded_dispatch_full_ring_does_not_block)
+{
+    using namespace MD_SHARDED_DISPATCH_TEST;
+    const int NUM_SYMBOLS = 4;
+    ShardedDispatcher sd;
+    ASSERT_TRUE(sd.init(make_epc(), *make_cfg("sharded", "8")));
+    MDShard &shard = *sd.shard(MIC(MICEnum::XNYS));
+
+    std::vector<std::unique_ptr<L2Book> > books;
+    for (int i = 0; i < NUM_SYMBOLS; i++) {
+        books.emplace_back(new L2Book(MIC(MICEnum::XNYS), static_cast<SymbolIndex>(i)));
+    }
+    // no consumer: the ring fills, then quotes are held, one per book
+    for (int i = 0; i < 1000; i++) {
+        auto &b = *books[i % NUM_SYMBOLS];
+        const Timestamp ts{1, i};
+        const Price p = 1000 + i % 7;
+        b.replace(true, p, 100, 1, ts);
+        sd.publish(L2BookEvent{ts, b, true, false, false, p, 100, 1, 100, L2BookEvent::DeltaReasonCode::NONE});
+        sd.publish(TradeEvent{ts, ts, b, 0, p, 100, TradeEvent::PassiveSide::UNKNOWN, false, nullptr});
+    }
+    EXPECT_EQ(shard.ring().size(), 8U);
+    EXPECT_EQ(shard.held(), static_cast<std::size_t>(NUM_SYMBOLS));
+    EXPECT_GT(shard.overflows(), 0U);
+    EXPECT_GT(shard.dropped(), 0U);
+
+    // held quotes go out as the consumer catches up
+    TopConsumer c;
+    const Timestamp ts{2, 0};
+    while (shard.held()) {
+        sd.poll(c);
+        sd.publish(PacketEvent{ts, MIC(MICEnum::XNYS)});
+    }
+    sd.poll(c);
+    EXPECT_TRUE(c.m_in_order);
+    for (const auto &b : books) {
+        const auto &top = c.m_tops[MIC(MICEnum::XNYS).index()][b->symbol_index()];
+        EXPECT_EQ(top.first.price, std::get<0>(b->best().first));
+    }
+}
+
+TEST(md_sharded_dispatch, md_sharded_dispatch_held_quote_after_gap)
+{
+    using namespace MD_SHARDED_DISPATCH_TEST;
+    ShardedDispatcher sd;
+    ASSERT_TRUE(sd.init(make_epc(), *make_cfg("sharded", "8")));
+    MDShard &shard = *sd.shard(MIC(MICEnum::XNYS));
+
+    L2Book a(MIC(MICEnum::XNYS), 1);
+    L2Book b(MIC(MICEnum::XNYS), 2);
+    auto update = [&](L2Book &book, Price p, int t) {
+        const Timestamp ts{1, t};
+        book.replace(true, p, 100, 1, ts);
+        sd.publish(L2BookEvent{ts, book, true, false, false, p, 100, 1, 100, L2BookEvent::DeltaReasonCode::NONE});
+    };
+    // fill the ring
+    for (int i = 0; i < 8; i++) {
+        update(b, 1000 + i, i);
+    }
+    EXPECT_EQ(shard.ring().size(), 8U);
+    // a quote for a before the gap, the gap, and a's next quote are held
+    update(a, 1000, 10);
+    EXPECT_EQ(shard.held(), 1U);
+    sd.publish(GapEvent{Timestamp{1, 11}, a.mic(), 1, 2, Timestamp{1, 11}});
+    EXPECT_EQ(shard.held(), 1U);
+    update(a, 1001, 12);
+    EXPECT_EQ(shard.held(), 2U);
+    // a's trading status is held apart from its quote, and outlives gaps
+    sd.publish(TradingStatusEvent{Timestamp{1, 12}, a, TradingStatusEvent::Event::HALT});
+    EXPECT_EQ(shard.held(), 3U);
+
+    TopConsumer c;
+    const Timestamp ts{2, 0};
+    while (shard.held()) {
+        sd.poll(c);
+        sd.publish(PacketEvent{ts, a.mic()});
+    }
+    sd.poll(c);
+    EXPECT_TRUE(c.m_in_order);
+    EXPECT_TRUE(c.m_time_ordered);
+    // a's quote came after the gap, so the consumer still has it
+    const auto &tops = c.m_tops[a.mic().index()];
+    ASSERT_EQ(tops.count(1), 1U);
+    EXPECT_EQ(tops.at(1).first.price, 1001U);
+    EXPECT_EQ(tops.count(2), 0U);
+    EXPECT_EQ(shard.dropped(), 1U);
+    EXPECT_EQ(c.m_statuses[a.mic().index()][1], TradingStatusEvent::Event::HALT);
+
+    // the same top is not published again, the consumer has it
+    update(a, 1001, 13);
+    EXPECT_EQ(sd.poll(c), 0U);
+
+    // a full FIFO of dropped updates makes room for more
+    for (int i = 0; i < 8; i++) {
+        update(b, 2000 + i, 20 + i);
+    }
+    const int NUM_GAPS = NUM_SYMBOL_INDEX;
+    for (int i = 0; i < NUM_GAPS; i++) {
+        sd.publish(GapEvent{Timestamp{1, 30 + i}, a.mic(), 1, 2, Timestamp{1, 30 + i}});
+        update(a, 3000 + i, 30 + i);
+    }
+    EXPECT_EQ(shard.held(), 2U);
+    while (shard.held()) {
+        sd.poll(c);
+        sd.publish(PacketEvent{ts, a.mic()});
+    }
+    sd.poll(c);
+    EXPECT_TRUE(c.m_in_order);
+    EXPECT_TRUE(c.m_time_ordered);
+    ASSERT_EQ(tops.count(1), 1U);
+    EXPECT_EQ(tops.at(1).first.price, static_cast<Price>(3000 + NUM_GAPS - 1));
+}
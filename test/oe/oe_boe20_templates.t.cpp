@@ -0,0 +1,171 @@
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <i01_core/Config.hpp>
+#include <i01_core/Time.hpp>
+
+#include <i01_oe/BATSOrder.hpp>
+#include <i01_oe/OrderManager.hpp>
+
+#include "BATS/BOE20Session.hpp"
+
+#include "oe_test_util.hpp"
+
+namespace OE_BOE20_TEMPLATES_TEST {
+
+using namespace OE_TEST;
+using i01::OE::BATS::BOE20Session;
+
+const std::size_t BENCH_ORDERS = 1000000;
+const int BENCH_ROUNDS = 5;
+
+/// Serializes new orders as send_new_order does, less the sequence number
+/// and the socket.
+class SerializingSession : public BOE20Session {
+public:
+    SerializingSession(OrderManager *om_p, const std::string& name_) : BOE20Session(om_p, name_) {}
+
+    bool serialize(Order *op) {
+        NewOrderBuffer *buf;
+        if (!m_no_bufs.get(buf))
+            return false;
+        const bool ok = m_new_order_templates ? fill_new_order_from_template(op, *buf) : fill_new_order(op, *buf);
+        m_no_bufs.release(buf);
+        return ok;
+    }
+
+    /// The bytes of op's NewOrder, from its template or field by field.
+    std::vector<std::uint8_t> bytes(Order *op, bool from_template) {
+        NewOrderBuffer *buf;
+        EXPECT_TRUE(m_no_bufs.get(buf));
+        const bool ok = from_template ? fill_new_order_from_template(op, *buf) : fill_new_order(op, *buf);
+        EXPECT_TRUE(ok);
+        std::vector<std::uint8_t> v(buf->data.bytes, buf->data.bytes + buf->msglen);
+        m_no_bufs.release(buf);
+        return v;
+    }
+
+    std::size_t num_templates(const Instrument *inst) const { return m_no_templates[inst->esi()].templates.size(); }
+    bool new_order_templates() const { return m_new_order_templates; }
+};
+
+void configure_boe(bool templates)
+{
+    configure();
+    i01::core::Config::instance().load_strings({
+        {"md.universe.symbol.2.cta_symbol", "BRK/B"},
+        {"oe.sessions.BOE.type", "BOE20Session"},
+        {"oe.sessions.BOE.mic", "BATS"},
+        {"oe.sessions.BOE.remote.addr", "127.0.0.1"},
+        {"oe.sessions.BOE.remote.port", "1"},
+        {"oe.sessions.BOE.session_sub_id", "0001"},
+        {"oe.sessions.BOE.username", "TEST"},
+        {"oe.sessions.BOE.password", "TEST"},
+        {"oe.sessions.BOE.clearing_firm", "CLRF"},
+        {"oe.sessions.BOE.clearing_account", "CLRA"},
+        {"oe.sessions.BOE.hpr_broker_loc", "B"},
+        {"oe.sessions.BOE.state_path", "boe20.BOE.state"},
+        {"oe.sessions.BOE.new_order_templates", templates ? "true" : "false"},
+    });
+}
+
+/// The session and the order manager it needs, in a scratch directory.
+struct Fixture {
+    explicit Fixture(bool templates) {
+        configure_boe(templates);
+        om.init(*i01::core::Config::instance().get_shared_state());
+        session.reset(new SerializingSession(&om, "BOE"));
+    }
+    ~Fixture() {
+        session.reset();
+        ::unlink("boe20.BOE.state");
+    }
+
+    ScratchDir scratch;
+    OrderManager om;
+    std::unique_ptr<SerializingSession> session;
+};
+
+}
+
+TEST(oe_boe20_templates, oe_boe20_template_bytes)
+{
+    using namespace OE_BOE20_TEMPLATES_TEST;
+    Fixture f(true);
+    auto& s = *f.session;
+    ASSERT_TRUE(s.new_order_templates());
+
+    // LIMIT DAY and IOC, every side, are made at session start:
+    auto *aapl = f.om.universe()[1].data();
+    auto *brk = f.om.universe()[2].data();
+    EXPECT_EQ(8u, s.num_templates(aapl));
+    EXPECT_EQ(8u, s.num_templates(brk));
+
+    const Side sides[] = {Side::BUY, Side::SELL, Side::SHORT, Side::SHORT_EXEMPT};
+    const TimeInForce tifs[] = {TimeInForce::DAY, TimeInForce::IMMEDIATE_OR_CANCEL, TimeInForce::GTC};
+    const OrderType types[] = {OrderType::LIMIT, OrderType::MARKET, OrderType::MIDPOINT_PEG};
+    std::size_t n = 0;
+    for (auto *inst : {aapl, brk}) {
+        for (const auto type : types) {
+            for (const auto tif : tifs) {
+                for (const auto side : sides) {
+                    // twice each: neither may make a template
+                    for (int i = 0; i < 2; ++i, ++n) {
+                        BATSOrder a(inst, 10.01 + n, 100 + n, side, tif, type, nullptr);
+                        BATSOrder b(inst, 10.01 + n, 100 + n, side, tif, type, nullptr);
+                        if (n % 3 == 0) {
+                            a.boe_display_indicator(BOE20Order::DisplayIndicator::HIDDEN);
+                            b.boe_display_indicator(BOE20Order::DisplayIndicator::HIDDEN);
+                        }
+                        EXPECT_EQ(s.bytes(&a, false), s.bytes(&b, true)) << b;
+                        EXPECT_EQ(a.boe_exec_inst(), b.boe_exec_inst());
+                        EXPECT_EQ(a.boe_display_indicator(), b.boe_display_indicator());
+                        EXPECT_EQ(a.boe_routing_inst().u32, b.boe_routing_inst().u32);
+                        EXPECT_EQ(0, std::memcmp(a.client_order_id().data(), b.client_order_id().data(), a.client_order_id().size()));
+                    }
+                }
+            }
+        }
+    }
+    // only those made at session start, so sending never writes them:
+    EXPECT_EQ(8u, s.num_templates(aapl));
+    EXPECT_EQ(8u, s.num_templates(brk));
+
+    // an order the session cannot serialize makes no template:
+    BATSOrder bad(aapl, 10.0, 100, Side::UNKNOWN, TimeInForce::DAY, OrderType::LIMIT, nullptr);
+    EXPECT_FALSE(s.serialize(&bad));
+    BATSOrder big(brk, 10.0, 1000000, Side::BUY, TimeInForce::DAY, OrderType::LIMIT, nullptr);
+    EXPECT_FALSE(s.serialize(&big));
+}
+
+TEST(oe_boe20_templates, oe_boe20_template_benchmark)
+{
+    using namespace OE_BOE20_TEMPLATES_TEST;
+    // the best of a few rounds of each, alternating, for a noisy machine:
+    double best[2] = {1e9, 1e9};
+    for (int round = 0; round < BENCH_ROUNDS; ++round) {
+        for (const bool templates : {false, true}) {
+            Fixture f(templates);
+            auto *inst = f.om.universe()[1].data();
+            std::vector<std::unique_ptr<BATSOrder>> orders;
+            for (std::size_t i = 0; i < 64; ++i)
+                orders.emplace_back(new BATSOrder(inst, 10.0 + 0.01 * i, 100 + i, day_side(i), TimeInForce::DAY, OrderType::LIMIT, nullptr));
+
+            const auto start = Timestamp::now();
+            for (std::size_t i = 0; i < BENCH_ORDERS; ++i)
+                ASSERT_TRUE(f.session->serialize(orders[i % orders.size()].get()));
+            const double ns = static_cast<double>(to_ns(Timestamp::now() - start)) / BENCH_ORDERS;
+            best[templates] = std::min(best[templates], ns);
+        }
+    }
+    std::cout << "ns per new order serialized, field by field " << best[0]
+              << ", from templates " << best[1] << std::endl;
+}
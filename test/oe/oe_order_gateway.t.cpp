@@ -0,0 +1,447 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <i01_core/Config.hpp>
+#include <i01_core/MPSCRing.hpp>
+#include <i01_core/Time.hpp>
+
+#include <i01_oe/NASDAQOrder.hpp>
+#include <i01_oe/OrderGateway.hpp>
+#include <i01_oe/OrderManager.hpp>
+#include <i01_oe/Threading.hpp>
+
+#include "oe_test_util.hpp"
+
+namespace OE_ORDER_GATEWAY_TEST {
+
+using namespace OE_TEST;
+
+/// A session with a wire: send and cancel queue what they were given under
+//  a socket lock, as the socket sessions do, and exchange() answers it from
+//  the one thread that plays the exchange.  The time on the wire of each
+//  new order, less the TSC the strategy put in its userdata, is kept.
+class WireSession : public SimSession {
+public:
+    WireSession(OrderManager *om_p, const std::string& name_, std::size_t orders)
+        : SimSession(om_p, name_), m_wire(1 << 16), m_tick_to_wire(orders, 0), m_sent(0) {}
+
+    /// Acks each new order, cancelling it too if cancel_new, and cancels
+    //  what was asked to be.  Returns how many messages were handled.
+    std::size_t exchange(bool cancel_new) {
+        std::size_t n = 0;
+        Message m;
+        while (m_wire.try_pop(m)) {
+            const auto ts = Timestamp::now();
+            if (m.cancel) {
+                m_order_manager_p->on_cancel(m.order_p, m.order_p->open_size(), ts, ts.nanoseconds_since_midnight());
+            } else {
+                m_order_manager_p->on_acknowledged(m.order_p, m.order_p->localID(), m.order_p->size(), ts, ts.nanoseconds_since_midnight());
+                if (cancel_new)
+                    m_order_manager_p->on_cancel(m.order_p, m.order_p->size(), ts, ts.nanoseconds_since_midnight());
+            }
+            ++n;
+        }
+        return n;
+    }
+
+    std::vector<std::uint64_t>& tick_to_wire() { return m_tick_to_wire; }
+    std::size_t sent() const { return m_sent.load(); }
+
+protected:
+    virtual bool send(Order *op) override {
+        Threading::Mutex::scoped_lock l(m_socket_mutex);
+        const auto i = m_sent.load(std::memory_order_relaxed);
+        if (i < m_tick_to_wire.size())
+            m_tick_to_wire[i] = i01::core::rdtscp() - op->userdata_integral();
+        put(Message{op, false});
+        m_sent.store(i + 1, std::memory_order_release);
+        return true;
+    }
+    virtual bool cancel(Order *op, Size) override {
+        Threading::Mutex::scoped_lock l(m_socket_mutex);
+        return put(Message{op, true});
+    }
+
+private:
+    struct Message {
+        Order *order_p;
+        bool cancel;
+    };
+
+    bool put(const Message& m) {
+        while (!m_wire.try_push(m))
+            std::this_thread::yield();
+        return true;
+    }
+
+    Threading::Mutex m_socket_mutex;
+    i01::core::MPSCRing<Message> m_wire;
+    std::vector<std::uint64_t> m_tick_to_wire;
+    std::atomic<std::size_t> m_sent;
+};
+
+struct CountingStrategy : public OrderListener {
+    virtual void on_order_acknowledged(const Order *) override { ++acks; }
+    virtual void on_order_fill(const Order *, const Size, const Price, const Dollars) override { ++fills; }
+    virtual void on_order_cancel(const Order *, const Size) override { ++cancels; }
+    virtual void on_order_cancel_rejected(const Order *) override { ++cancel_rejects; }
+    virtual void on_order_rejected(const Order *) override { ++rejects; }
+
+    std::atomic<std::uint64_t> acks{0};
+    std::atomic<std::uint64_t> fills{0};
+    std::atomic<std::uint64_t> cancels{0};
+    std::atomic<std::uint64_t> cancel_rejects{0};
+    std::atomic<std::uint64_t> rejects{0};
+};
+
+/// Every order is a buy and is cancelled straight away, so the open
+//  exposure is what the exchange has yet to answer.
+void configure_gateway(bool spin)
+{
+    configure();
+    i01::core::Config::instance().load_strings({
+        {"oe.universe.default.position_limit", "100000000"},
+        {"oe.universe.default.position_value_limit", "1000000000"},
+        {"oe.risk.firm.long_open_exposure_limit", "10000000"},
+        {"oe.risk.firm.gross_open_exposure_limit", "10000000"},
+        {"oe.gateway.spin", spin ? "true" : "false"},
+        {"oe.gateway.event_ring_size", "4096"},
+        {"oe.gateway.full_wait_us", "10000"},
+    });
+}
+
+template <typename Pred>
+bool wait_for(Pred pred, std::function<void()> work = []() {})
+{
+    const auto deadline = Timestamp::now().tv_sec + 10;
+    while (!pred()) {
+        work();
+        if (Timestamp::now().tv_sec > deadline)
+            return false;
+        std::this_thread::yield();
+    }
+    return true;
+}
+
+struct TickToWire {
+    std::vector<std::uint64_t> cycles;
+    double seconds = 0;
+};
+
+/// Orders a strategy may have open before it waits for the exchange, which
+//  keeps the open exposure inside the firm limits.
+const std::size_t MAX_OPEN = 256;
+
+/// threads strategies each send n orders, one per tick, every interval_ns,
+//  either straight through the OrderManager or through an OrderGateway.
+//  Another thread plays the exchange and cancels every order it is sent.
+void run_tick_to_wire(bool gateway, std::size_t threads, std::size_t n, std::uint64_t interval_ns, double tpn, TickToWire& res)
+{
+    OrderManager om;
+    om.init(*i01::core::Config::instance().get_shared_state());
+    om.reserve_orders<NASDAQOrder>();
+    WireSession session(&om, "SIMDAY", threads * n);
+    auto *inst = om.universe()[1].data();
+    ASSERT_NE(nullptr, inst);
+
+    std::vector<CountingStrategy> strategies(threads);
+    std::unique_ptr<OrderGateway> gw;
+    std::vector<GatewayClient *> clients;
+    if (gateway) {
+        gw.reset(new OrderGateway(om));
+        gw->add_session(&session);
+        for (auto& s : strategies)
+            clients.push_back(gw->add_client(&s));
+        ASSERT_TRUE(gw->start());
+    }
+
+    std::atomic<bool> done(false);
+    std::thread exchange([&]() {
+            while (!done.load(std::memory_order_acquire)) {
+                if (0 == session.exchange(true))
+                    std::this_thread::yield();
+            }
+            session.exchange(true);
+        });
+
+    const auto interval = static_cast<std::uint64_t>(interval_ns * tpn);
+    const auto start = Timestamp::now();
+    std::vector<std::thread> workers;
+    for (std::size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+                OrderListener *listener = gateway ? static_cast<OrderListener *>(clients[t]) : &strategies[t];
+                auto& strategy = strategies[t];
+                auto next = i01::core::rdtscp();
+                for (std::size_t i = 0; i < n; ++i) {
+                    while (i01::core::rdtscp() < next || i - strategy.cancels >= MAX_OPEN) {
+                        if (gateway)
+                            clients[t]->poll();
+                        std::this_thread::yield();
+                    }
+                    next += interval;
+                    // the tick arrives:
+                    const auto tick = i01::core::rdtscp();
+                    auto *op = om.create_order<NASDAQOrder>(inst, 10.0, 100, Side::BUY, TimeInForce::DAY, OrderType::LIMIT, listener);
+                    op->userdata_integral(tick);
+                    const bool sent = gateway ? clients[t]->send(op, &session) : om.send(op, &session);
+                    EXPECT_TRUE(sent);
+                }
+                EXPECT_TRUE(wait_for([&]() { return strategy.cancels == n; },
+                                     [&]() { if (gateway) clients[t]->poll(); }));
+            });
+    }
+    for (auto& w : workers)
+        w.join();
+    res.seconds = static_cast<double>(to_ns(Timestamp::now() - start)) / 1e9;
+    EXPECT_EQ(threads * n, session.sent());
+    done.store(true, std::memory_order_release);
+    exchange.join();
+    if (gw)
+        gw->stop();
+
+    for (auto& s : strategies) {
+        EXPECT_EQ(n, s.acks);
+        EXPECT_EQ(n, s.cancels);
+        EXPECT_EQ(0u, s.rejects);
+    }
+    res.cycles.swap(session.tick_to_wire());
+}
+
+void report(const char *mode, std::size_t threads, double tpn, TickToWire& res)
+{
+    std::cout << mode << ", " << threads << " strategy thread" << (threads > 1 ? "s" : "")
+              << ": " << res.cycles.size() << " orders in " << res.seconds << " s"
+              << ", tick to wire ns p50 " << static_cast<std::uint64_t>(percentile(res.cycles, 0.5) / tpn)
+              << " p99 " << static_cast<std::uint64_t>(percentile(res.cycles, 0.99) / tpn)
+              << " p99.9 " << static_cast<std::uint64_t>(percentile(res.cycles, 0.999) / tpn) << std::endl;
+}
+
+}
+
+TEST(oe_order_gateway, oe_order_gateway_round_trip)
+{
+    using namespace OE_ORDER_GATEWAY_TEST;
+    if (Threading::single_threaded)
+        return; // no gateway without locks
+    configure_gateway(false);
+    ScratchDir scratch;
+
+    OrderManager om;
+    om.init(*i01::core::Config::instance().get_shared_state());
+    WireSession session(&om, "SIMDAY", 0);
+    CountingStrategy strategy;
+    OrderGateway gw(om);
+    gw.add_session(&session);
+    auto *client = gw.add_client(&strategy);
+    EXPECT_THROW(gw.add_session(&session), std::logic_error);
+    ASSERT_TRUE(gw.start());
+
+    auto *inst = om.universe()[1].data();
+    const std::size_t n = 100;
+    std::vector<Order *> orders;
+    for (std::size_t i = 0; i < n; ++i) {
+        auto *op = om.create_order<NASDAQOrder>(inst, 10.0, 100, Side::BUY, TimeInForce::DAY, OrderType::LIMIT, client);
+        ASSERT_TRUE(client->send(op, &session));
+        orders.push_back(op);
+    }
+    // checked on this thread, so never queued:
+    auto *bad = om.create_order<NASDAQOrder>(inst, 0.0, 100, Side::BUY, TimeInForce::DAY, OrderType::LIMIT, client);
+    EXPECT_FALSE(client->send(bad, &session));
+    EXPECT_EQ(OrderState::LOCALLY_REJECTED, bad->state());
+    // not the client's order:
+    auto *other = om.create_order<NASDAQOrder>(inst, 10.0, 100, Side::BUY, TimeInForce::DAY, OrderType::LIMIT, &strategy);
+    EXPECT_FALSE(client->send(other, &session));
+
+    // this thread plays the exchange as well as the strategy:
+    ASSERT_TRUE(wait_for([&]() { return session.sent() == n; }));
+    EXPECT_EQ(n, session.exchange(false));
+    ASSERT_TRUE(wait_for([&]() { return strategy.acks == n; }, [&]() { client->poll(); }));
+    EXPECT_EQ(0u, strategy.fills + strategy.cancels);
+
+    // fill one in four, cancel the rest through the gateway, and ask for
+    // the last cancel twice: the OrderManager will not send the second.
+    for (std::size_t i = 0; i < n; ++i) {
+        if (0 == i % 4) {
+            const auto ts = Timestamp::now();
+            om.on_fill(orders[i], orders[i]->size(), orders[i]->price(), ts, ts.nanoseconds_since_midnight());
+        } else {
+            EXPECT_TRUE(client->cancel(orders[i]));
+        }
+    }
+    EXPECT_TRUE(client->cancel(orders[n - 1]));
+    ASSERT_TRUE(wait_for([&]() { return strategy.cancel_rejects == 1; },
+                         [&]() { session.exchange(false); client->poll(); }));
+    ASSERT_TRUE(wait_for([&]() { return strategy.cancels == n - n / 4; },
+                         [&]() { session.exchange(false); client->poll(); }));
+    EXPECT_EQ(n / 4, strategy.fills);
+    EXPECT_EQ(0u, strategy.rejects);
+    // filled, so the gateway thread turns the cancel down:
+    EXPECT_TRUE(client->cancel(orders[0]));
+    ASSERT_TRUE(wait_for([&]() { return strategy.cancel_rejects == 2; }, [&]() { client->poll(); }));
+    gw.stop();
+    EXPECT_FALSE(gw.running());
+}
+
+TEST(oe_order_gateway, oe_order_gateway_mode)
+{
+    using namespace OE_ORDER_GATEWAY_TEST;
+    if (Threading::single_threaded)
+        return; // no gateway without locks
+    configure_gateway(false);
+    i01::core::Config::instance().load_strings({
+        {"oe.sessions.GWSIM.type", "L2SimSession"},
+        {"oe.sessions.GWSIM.mic", "XNAS"},
+    });
+    ScratchDir scratch;
+    {
+        OrderManager om;
+        om.init(*i01::core::Config::instance().get_shared_state());
+        EXPECT_EQ(nullptr, om.gateway());
+    }
+
+    i01::core::Config::instance().load_strings({{"oe.gateway.enabled", "true"}});
+    {
+        OrderManager om;
+        om.init(*i01::core::Config::instance().get_shared_state());
+        ASSERT_NE(nullptr, om.gateway());
+        // sessions join the gateway as the OrderManager creates them
+        auto osp = om.add_session("GWSIM", "L2SimSession");
+        ASSERT_TRUE(osp.second);
+        EXPECT_NE(OrderGateway::NO_LANE, om.gateway()->lane(osp.first.get()));
+        CountingStrategy strategy;
+        auto *client = om.gateway()->add_client(&strategy);
+        ASSERT_NE(nullptr, client);
+        EXPECT_FALSE(om.gateway()->running());
+        om.start();
+        EXPECT_TRUE(om.gateway()->running());
+        EXPECT_THROW(om.gateway()->add_client(&strategy), std::logic_error);
+    }
+    i01::core::Config::instance().load_strings({{"oe.gateway.enabled", "false"}});
+}
+
+TEST(oe_order_gateway, oe_order_gateway_response_producers)
+{
+    using namespace OE_ORDER_GATEWAY_TEST;
+    if (Threading::single_threaded)
+        return; // no gateway without locks
+    configure_gateway(false);
+    i01::core::Config::instance().load_strings({
+        {"oe.gateway.event_ring_size", "64"},
+        {"oe.gateway.full_wait_us", "1000000"},
+    });
+    ScratchDir scratch;
+
+    OrderManager om;
+    om.init(*i01::core::Config::instance().get_shared_state());
+    WireSession session(&om, "SIMDAY", 0);
+    CountingStrategy strategy;
+    OrderGateway gw(om);
+    gw.add_session(&session);
+    auto *client = gw.add_client(&strategy);
+    ASSERT_TRUE(gw.start());
+
+    auto *inst = om.universe()[1].data();
+    const std::size_t n = 2000;
+    std::vector<Order *> orders;
+    for (std::size_t i = 0; i < n; ++i) {
+        auto *op = om.create_order<NASDAQOrder>(inst, 10.0, 100, Side::BUY, TimeInForce::DAY, OrderType::LIMIT, client);
+        ASSERT_TRUE(client->send(op, &session));
+        orders.push_back(op);
+    }
+    ASSERT_TRUE(wait_for([&]() { return session.sent() == n; }));
+
+    // two threads answer for the one session, into the one small ring,
+    // while the strategy polls:
+    std::atomic<bool> done(false);
+    std::thread strategy_thread([&]() {
+            while (!done.load(std::memory_order_acquire))
+                client->poll();
+            client->poll();
+        });
+    std::vector<std::thread> producers;
+    for (std::size_t p = 0; p < 2; ++p) {
+        producers.emplace_back([&, p]() {
+                for (std::size_t i = p; i < n; i += 2) {
+                    const auto ts = Timestamp::now();
+                    om.on_acknowledged(orders[i], orders[i]->localID(), orders[i]->size(), ts, ts.nanoseconds_since_midnight());
+                    om.on_cancel(orders[i], orders[i]->size(), ts, ts.nanoseconds_since_midnight());
+                }
+            });
+    }
+    for (auto& p : producers)
+        p.join();
+    EXPECT_TRUE(wait_for([&]() { return strategy.cancels == n; }));
+    done.store(true, std::memory_order_release);
+    strategy_thread.join();
+    EXPECT_EQ(n, strategy.acks);
+    EXPECT_EQ(n, strategy.cancels);
+    EXPECT_EQ(0u, client->dropped());
+    gw.stop();
+}
+
+TEST(oe_order_gateway, oe_order_gateway_full_ring)
+{
+    using namespace OE_ORDER_GATEWAY_TEST;
+    if (Threading::single_threaded)
+        return; // no gateway without locks
+    configure_gateway(false);
+    i01::core::Config::instance().load_strings({
+        {"oe.gateway.event_ring_size", "8"},
+        {"oe.gateway.full_wait_us", "100"},
+    });
+    ScratchDir scratch;
+
+    OrderManager om;
+    om.init(*i01::core::Config::instance().get_shared_state());
+    WireSession session(&om, "SIMDAY", 0);
+    CountingStrategy strategy;
+    OrderGateway gw(om);
+    gw.add_session(&session);
+    auto *client = gw.add_client(&strategy);
+    ASSERT_TRUE(gw.start());
+
+    auto *inst = om.universe()[1].data();
+    const std::size_t n = 32;
+    for (std::size_t i = 0; i < n; ++i) {
+        auto *op = om.create_order<NASDAQOrder>(inst, 10.0, 100, Side::BUY, TimeInForce::DAY, OrderType::LIMIT, client);
+        ASSERT_TRUE(client->send(op, &session));
+    }
+    ASSERT_TRUE(wait_for([&]() { return session.sent() == n; }));
+
+    // the strategy does not poll: the exchange is held up a while for
+    // each ack past the ring's 8, which is then dropped.
+    EXPECT_EQ(n, session.exchange(false));
+    EXPECT_EQ(n - 8, client->dropped());
+    EXPECT_EQ(8u, client->poll());
+    EXPECT_EQ(8u, strategy.acks);
+    gw.stop();
+}
+
+TEST(oe_order_gateway, oe_order_gateway_tick_to_wire_benchmark)
+{
+    using namespace OE_ORDER_GATEWAY_TEST;
+    if (Threading::single_threaded)
+        return; // no gateway without locks
+    // spinning threads only make sense with a core each:
+    const bool spin = std::thread::hardware_concurrency() >= 11;
+    configure_gateway(spin);
+    ScratchDir scratch;
+    const double tpn = tsc_per_ns();
+    const std::size_t TOTAL = 200000;
+
+    for (std::size_t threads : {1, 8}) {
+        for (bool gateway : {false, true}) {
+            TickToWire res;
+            run_tick_to_wire(gateway, threads, TOTAL / threads, 2000 * threads, tpn, res);
+            report(gateway ? "gateway" : "direct", threads, tpn, res);
+        }
+    }
+    if (!spin)
+        std::cout << "(" << std::thread::hardware_concurrency() << " cores: all threads yield when idle)" << std::endl;
+}
@@ -0,0 +1,187 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include <i01_oe/NASDAQOrder.hpp>
+#include <i01_oe/OrderManager.hpp>
+#include <i01_oe/OrderPool.hpp>
+
+#include "oe_test_util.hpp"
+
+namespace OE_ORDER_POOL_TEST {
+
+using namespace OE_TEST;
+
+const std::size_t DAY_ORDERS = 2000000;
+
+struct DayResult {
+    std::vector<std::uint64_t> send_ns;
+    std::uint64_t rss_start_kb = 0;
+    std::uint64_t rss_end_kb = 0;
+    std::uint64_t orders_kept = 0;
+    OrderPoolStats pool;
+};
+
+/// A day of orders through a DaySession, each sent and then responded to.
+void run_day(bool release, std::size_t n, DayResult& res)
+{
+    OrderManager om;
+    om.init(*i01::core::Config::instance().get_shared_state());
+    om.reserve_orders<NASDAQOrder>();
+    DaySession session(&om, "SIMDAY");
+    DayStrategy strategy(release);
+    auto *inst = om.universe()[1].data();
+    ASSERT_NE(nullptr, inst);
+
+    res.send_ns.assign(n, 0);
+    res.rss_start_kb = anon_rss_kb();
+    for (std::size_t i = 0; i < n; ++i) {
+        const auto start = Timestamp::now();
+        auto *op = om.create_order<NASDAQOrder>(inst, 10.0, 100, day_side(i), TimeInForce::DAY, OrderType::LIMIT, &strategy);
+        const bool sent = om.send(op, &session);
+        res.send_ns[i] = to_ns(Timestamp::now() - start);
+        ASSERT_TRUE(sent);
+        session.respond();
+    }
+    res.rss_end_kb = anon_rss_kb();
+    res.orders_kept = om.all_orders().size();
+    auto stats = om.order_pool_stats();
+    ASSERT_EQ(1u, stats.size());
+    res.pool = stats.front();
+    EXPECT_EQ(n, strategy.fills + strategy.cancels);
+}
+
+void report(const char *name, std::size_t n, DayResult& res)
+{
+    std::cout << name << ": " << n << " orders, send ns p50 " << percentile(res.send_ns, 0.5)
+              << " p99 " << percentile(res.send_ns, 0.99)
+              << " p99.9 " << percentile(res.send_ns, 0.999)
+              << " max " << *std::max_element(res.send_ns.begin(), res.send_ns.end())
+              << ", anon RSS +" << (res.rss_end_kb - res.rss_start_kb) << " kB"
+              << ", " << res.orders_kept << " orders kept, pool of " << res.pool.capacity
+              << " in " << res.pool.slabs << " slabs" << std::endl;
+}
+
+}
+
+TEST(oe_order_pool, oe_order_pool_reuse)
+{
+    using namespace OE_ORDER_POOL_TEST;
+
+    OrderPool pool("Test", 40, 4, 2);
+    auto stats = pool.stats();
+    EXPECT_EQ(48u, stats.block_size);
+    EXPECT_EQ(4u, stats.capacity);
+    EXPECT_EQ(1u, stats.slabs);
+
+    std::vector<void *> blocks;
+    for (int i = 0; i < 4; ++i)
+        blocks.push_back(pool.allocate());
+    EXPECT_EQ(4u, std::set<void *>(blocks.begin(), blocks.end()).size());
+    EXPECT_EQ(1u, pool.stats().slabs);
+
+    // full, so the next comes from a new slab:
+    blocks.push_back(pool.allocate());
+    stats = pool.stats();
+    EXPECT_EQ(6u, stats.capacity);
+    EXPECT_EQ(2u, stats.slabs);
+    EXPECT_EQ(5u, stats.in_use);
+
+    // the last released is the first reused:
+    pool.deallocate(blocks[1]);
+    pool.deallocate(blocks[3]);
+    EXPECT_EQ(blocks[3], pool.allocate());
+    EXPECT_EQ(blocks[1], pool.allocate());
+    stats = pool.stats();
+    EXPECT_EQ(5u, stats.in_use);
+    EXPECT_EQ(5u, stats.high_water);
+    EXPECT_EQ(2u, stats.reused);
+    EXPECT_EQ(2u, stats.slabs);
+}
+
+TEST(oe_order_pool, oe_local_id_table)
+{
+    using namespace OE_ORDER_POOL_TEST;
+
+    LocalIDTable t;
+    t.push_back(nullptr);
+    auto *first = reinterpret_cast<Order *>(0x10);
+    t.push_back(first);
+    Order **slot = &t[1];
+
+    // growing past a chunk does not move what is there:
+    t.resize(LocalIDTable::CHUNK_SIZE * 3 + 5);
+    EXPECT_EQ(LocalIDTable::CHUNK_SIZE * 4, t.capacity());
+    EXPECT_EQ(slot, &t[1]);
+    EXPECT_EQ(first, t[1]);
+    EXPECT_EQ(nullptr, t[LocalIDTable::CHUNK_SIZE * 3 + 4]);
+    t.push_back(first);
+    EXPECT_EQ(first, t[LocalIDTable::CHUNK_SIZE * 3 + 5]);
+
+    t.resize(1);
+    t.resize(2);
+    EXPECT_EQ(nullptr, t[1]);
+}
+
+TEST(oe_order_pool, oe_order_manager_release_terminal)
+{
+    using namespace OE_ORDER_POOL_TEST;
+    configure();
+
+    // {listener releases, session releases}
+    for (auto release : std::vector<std::pair<bool, bool> >{{false, true}, {true, true}, {true, false}}) {
+        OrderManager om;
+        om.init(*i01::core::Config::instance().get_shared_state());
+        DaySession session(&om, "SIMDAY", release.second);
+        DayStrategy strategy(release.first);
+        auto *inst = om.universe()[1].data();
+        ASSERT_NE(nullptr, inst);
+
+        const std::size_t n = 3000;
+        std::set<const Order *> seen;
+        for (std::size_t i = 0; i < n; ++i) {
+            auto *op = om.create_order<NASDAQOrder>(inst, 10.0, 100, day_side(i), TimeInForce::DAY, OrderType::LIMIT, &strategy);
+            seen.insert(op);
+            ASSERT_TRUE(om.send(op, &session));
+            session.respond();
+        }
+        EXPECT_EQ(n, strategy.fills + strategy.cancels);
+        auto stats = om.order_pool_stats();
+        ASSERT_EQ(1u, stats.size());
+        EXPECT_EQ("NASDAQOrder", stats.front().name);
+        if (release.first && release.second) {
+            // each order is reused once its session has let go of it:
+            EXPECT_EQ(0u, om.all_orders().size());
+            EXPECT_EQ(0u, stats.front().in_use);
+            EXPECT_EQ(1u, seen.size());
+            EXPECT_EQ(4096u, stats.front().capacity);
+        } else {
+            EXPECT_EQ(n, om.all_orders().size());
+            EXPECT_EQ(n, stats.front().in_use);
+            EXPECT_EQ(n, seen.size());
+        }
+    }
+}
+
+TEST(oe_order_pool, oe_order_pool_day_benchmark)
+{
+    using namespace OE_ORDER_POOL_TEST;
+    configure();
+    ScratchDir scratch;
+
+    DayResult reused;
+    run_day(true, DAY_ORDERS, reused);
+    report("released on terminal", DAY_ORDERS, reused);
+    EXPECT_EQ(0u, reused.orders_kept);
+    EXPECT_EQ(1u, reused.pool.slabs);
+
+    DayResult kept;
+    run_day(false, DAY_ORDERS, kept);
+    report("kept all day", DAY_ORDERS, kept);
+    EXPECT_EQ(DAY_ORDERS, kept.orders_kept);
+}
@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#include <i01_core/Time.hpp>
+
+#include <i01_oe/NASDAQOrder.hpp>
+#include <i01_oe/OrderManager.hpp>
+#include <i01_oe/SendStageStats.hpp>
+#include <i01_oe/Threading.hpp>
+
+#include "oe_test_util.hpp"
+
+namespace OE_SEND_LATENCY_TEST {
+
+using namespace OE_TEST;
+using Stage = SendStageStats::Stage;
+
+const std::size_t BENCH_ORDERS = 500000;
+
+/// Sends n orders, each answered before the next, and returns the wall
+/// clock ns of each send.
+std::vector<std::uint64_t> send_day(OrderManager& om, std::size_t n)
+{
+    DaySession session(&om, "SIMDAY");
+    DayStrategy strategy(true);
+    auto *inst = om.universe()[1].data();
+    std::vector<std::uint64_t> send_ns(n, 0);
+    for (std::size_t i = 0; i < n; ++i) {
+        auto *op = om.create_order<NASDAQOrder>(inst, 10.0, 100, day_side(i), TimeInForce::DAY, OrderType::LIMIT, &strategy);
+        const auto start = Timestamp::now();
+        const bool sent = om.send(op, &session);
+        send_ns[i] = to_ns(Timestamp::now() - start);
+        EXPECT_TRUE(sent);
+        session.respond();
+    }
+    return send_ns;
+}
+
+}
+
+TEST(oe_send_latency, oe_send_stage_stats)
+{
+    using namespace OE_SEND_LATENCY_TEST;
+    configure();
+    ScratchDir scratch;
+
+    OrderManager om;
+    om.init(*i01::core::Config::instance().get_shared_state());
+    EXPECT_FALSE(om.send_stage_timing());
+    send_day(om, 10);
+    EXPECT_EQ(0u, om.send_stage_stats().sends);
+
+    om.send_stage_timing(true);
+    send_day(om, 100);
+    auto stats = om.send_stage_stats();
+    EXPECT_EQ(100u, stats.sends);
+    for (std::size_t i = 0; i < SendStageStats::NUM_STAGES; ++i) {
+        EXPECT_EQ(100u, stats.stages[i].count) << SendStageStats::name(static_cast<Stage>(i));
+        EXPECT_LE(stats.stages[i].cycles / 100, stats.stages[i].max_cycles);
+    }
+
+    // a zero price fails Order::validate_base, so nothing after VALIDATE
+    // but the local reject in the blotter is timed:
+    om.reset_send_stage_stats();
+    DaySession session(&om, "SIMDAY");
+    DayStrategy strategy(true);
+    auto *op = om.create_order<NASDAQOrder>(om.universe()[1].data(), 0.0, 100, Side::BUY, TimeInForce::DAY, OrderType::LIMIT, &strategy);
+    EXPECT_FALSE(om.send(op, &session));
+    stats = om.send_stage_stats();
+    EXPECT_EQ(1u, stats.sends);
+    EXPECT_EQ(1u, stats[Stage::LOCK].count);
+    EXPECT_EQ(1u, stats[Stage::VALIDATE].count);
+    EXPECT_EQ(0u, stats[Stage::FIRM_RISK].count);
+    EXPECT_EQ(0u, stats[Stage::SESSION_SEND].count);
+    EXPECT_EQ(1u, stats[Stage::BLOTTER].count);
+}
+
+TEST(oe_send_latency, oe_single_threaded_config)
+{
+    using namespace OE_SEND_LATENCY_TEST;
+    configure();
+    ScratchDir scratch;
+
+    // the config may not ask for locks that the build has taken out:
+    i01::core::Config::instance().load_strings({{"oe.single_threaded", "false"}});
+    {
+        OrderManager om;
+        if (Threading::single_threaded)
+            EXPECT_THROW(om.init(*i01::core::Config::instance().get_shared_state()), std::runtime_error);
+        else
+            EXPECT_NO_THROW(om.init(*i01::core::Config::instance().get_shared_state()));
+    }
+    i01::core::Config::instance().load_strings({{"oe.single_threaded", "true"}});
+    {
+        OrderManager om;
+        EXPECT_NO_THROW(om.init(*i01::core::Config::instance().get_shared_state()));
+    }
+}
+
+TEST(oe_send_latency, oe_send_latency_benchmark)
+{
+    using namespace OE_SEND_LATENCY_TEST;
+    configure();
+    ScratchDir scratch;
+    const double tpn = tsc_per_ns();
+
+    OrderManager om;
+    om.init(*i01::core::Config::instance().get_shared_state());
+    om.reserve_orders<NASDAQOrder>();
+
+    auto send_ns = send_day(om, BENCH_ORDERS);
+    std::cout << (Threading::single_threaded ? "single threaded" : "locking")
+              << " build, " << BENCH_ORDERS << " orders, send ns p50 " << percentile(send_ns, 0.5)
+              << " p99 " << percentile(send_ns, 0.99)
+              << " p99.9 " << percentile(send_ns, 0.999) << std::endl;
+
+    om.send_stage_timing(true);
+    send_day(om, BENCH_ORDERS);
+    const auto stats = om.send_stage_stats();
+    EXPECT_EQ(BENCH_ORDERS, stats.sends);
+    double total = 0;
+    std::cout << "stage mean ns (" << std::setprecision(3) << tpn << " TSC/ns):" << std::endl;
+    for (std::size_t i = 0; i < SendStageStats::NUM_STAGES; ++i) {
+        const auto& c = stats.stages[i];
+        const double ns = c.count ? c.cycles / tpn / c.count : 0;
+        total += ns;
+        std::cout << "  " << std::setw(15) << std::left << SendStageStats::name(static_cast<Stage>(i))
+                  << std::setw(8) << std::right << std::fixed << std::setprecision(1) << ns
+                  << "  max " << static_cast<std::uint64_t>(c.max_cycles / tpn) << std::endl;
+    }
+    std::cout << "  " << std::setw(15) << std::left << "TOTAL" << std::setw(8) << std::right << total << std::endl;
+}
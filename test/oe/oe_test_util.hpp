@@ -0,0 +1,169 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <i01_core/Config.hpp>
+#include <i01_core/Time.hpp>
+
+#include <i01_oe/Order.hpp>
+#include <i01_oe/OrderListener.hpp>
+#include <i01_oe/OrderManager.hpp>
+#include <i01_oe/SimSession.hpp>
+
+namespace OE_TEST {
+
+using i01::core::Timestamp;
+using namespace i01::OE;
+
+/// Acks each order sent through it and then fills or cancels it, as an
+//  exchange would, but only when respond() is called: OrderManager::send
+//  must have returned before any response arrives.  Unless releases is
+//  false, it lets go of each order once it has responded to it.
+class DaySession : public SimSession {
+public:
+    DaySession(OrderManager *om_p, const std::string& name_, bool releases = true)
+        : SimSession(om_p, name_), m_releases(releases) {}
+
+    /// Every fourth order is filled, the rest are cancelled.
+    void respond() {
+        for (auto *op : m_sent) {
+            const auto ts = Timestamp::now();
+            m_order_manager_p->on_acknowledged(op, op->localID(), op->size(), ts, ts.nanoseconds_since_midnight());
+            if (0 == m_responses++ % 4)
+                m_order_manager_p->on_fill(op, op->size(), op->price(), ts, ts.nanoseconds_since_midnight());
+            else
+                m_order_manager_p->on_cancel(op, op->size(), ts, ts.nanoseconds_since_midnight());
+            if (m_releases)
+                release_order(op);
+        }
+        m_sent.clear();
+    }
+
+protected:
+    virtual bool send(Order *op) override { m_sent.push_back(op); return true; }
+    virtual bool cancel(Order *, Size) override { return false; }
+    virtual bool releases_orders() const override { return m_releases; }
+
+private:
+    const bool m_releases;
+    std::vector<Order *> m_sent;
+    std::uint64_t m_responses = 0;
+};
+
+struct DayStrategy : public OrderListener {
+    explicit DayStrategy(bool release) : m_release(release) {}
+
+    virtual void on_order_fill(const Order *, const Size, const Price, const Dollars) override { ++fills; }
+    virtual void on_order_cancel(const Order *, const Size) override { ++cancels; }
+    virtual bool release_terminal_orders() const override { return m_release; }
+
+    bool m_release;
+    std::uint64_t fills = 0;
+    std::uint64_t cancels = 0;
+};
+
+/// One symbol, AAPL, one SimSession, SIMDAY, and limits that a day of
+//  DaySession orders never reaches.
+inline void configure()
+{
+    i01::core::Config::instance().load_strings({
+        {"md.universe.symbol.1.cta_symbol", "AAPL"},
+        {"oe.sessions.SIMDAY.type", "SimSession"},
+        {"oe.sessions.SIMDAY.mic", "XNAS"},
+        {"oe.universe.default.order_size_limit", "10000"},
+        {"oe.universe.default.order_price_limit", "1000"},
+        {"oe.universe.default.order_value_limit", "100000"},
+        {"oe.universe.default.order_rate_limit", "-1"},
+        {"oe.universe.default.position_limit", "10000"},
+        {"oe.universe.default.position_value_limit", "100000"},
+        {"oe.universe.default.lot_size", "100"},
+        {"oe.risk.firm.realized_loss_limit", "5000"},
+        {"oe.risk.firm.unrealized_loss_limit", "15000"},
+        {"oe.risk.firm.gross_notional_limit", "1000000"},
+        {"oe.risk.firm.net_notional_limit", "1000000"},
+        {"oe.risk.firm.long_open_exposure_limit", "1000000"},
+        {"oe.risk.firm.short_open_exposure_limit", "1000000"},
+        {"oe.risk.firm.gross_open_exposure_limit", "2000000"},
+        {"oe.local_id_capacity", "2100000"},
+        {"oe.order_pool.NASDAQOrder.capacity", "4096"},
+        {"oe.order_pool.NASDAQOrder.slab_size", "4096"},
+        {"oe.single_threaded", Threading::single_threaded ? "true" : "false"},
+    });
+}
+
+/// Only the filled orders alternate, so the position stays flat or long
+//  and no locates are needed.
+inline Side day_side(std::size_t i)
+{
+    return 4 == i % 8 ? Side::SELL : Side::BUY;
+}
+
+inline std::uint64_t to_ns(const Timestamp& ts)
+{
+    return static_cast<std::uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<std::uint64_t>(ts.tv_nsec);
+}
+
+inline std::uint64_t percentile(std::vector<std::uint64_t>& v, double p)
+{
+    if (v.empty())
+        return 0;
+    std::size_t i = static_cast<std::size_t>(p * (v.size() - 1));
+    std::nth_element(v.begin(), v.begin() + i, v.end());
+    return v[i];
+}
+
+/// TSC ticks per nanosecond, against CLOCK_MONOTONIC over 100ms.
+inline double tsc_per_ns()
+{
+    const struct timespec pause = {0, 100000000};
+    const auto t0 = Timestamp::now();
+    const auto c0 = i01::core::rdtscp();
+    ::nanosleep(&pause, nullptr);
+    const auto c1 = i01::core::rdtscp();
+    const auto t1 = Timestamp::now();
+    return static_cast<double>(c1 - c0) / static_cast<double>(to_ns(t1 - t0));
+}
+
+/// Resident anonymous memory in kB: RSS less file backed pages, so the
+//  memory mapped order log does not count.
+inline std::uint64_t anon_rss_kb()
+{
+    std::uint64_t size = 0, resident = 0, shared = 0;
+    std::ifstream statm("/proc/self/statm");
+    statm >> size >> resident >> shared;
+    return (resident - shared) * static_cast<std::uint64_t>(::sysconf(_SC_PAGESIZE)) / 1024;
+}
+
+/// The order log of a day is most of a gigabyte: write it somewhere to be
+//  thrown away.
+class ScratchDir {
+public:
+    ScratchDir() : m_old(::getcwd(nullptr, 0)) {
+        char tmpl[] = "/tmp/oe_test.XXXXXX";
+        m_path = ::mkdtemp(tmpl);
+        EXPECT_EQ(0, ::chdir(m_path.c_str()));
+    }
+    ~ScratchDir() {
+        ::unlink((m_path + "/orderlog").c_str());
+        ::unlink((m_path + "/orderlog.offset").c_str());
+        EXPECT_EQ(0, ::chdir(m_old));
+        ::rmdir(m_path.c_str());
+        ::free(m_old);
+    }
+
+private:
+    char *m_old;
+    std::string m_path;
+};
+
+}
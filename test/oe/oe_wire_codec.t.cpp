@@ -0,0 +1,2078 @@
+#include <gtest/gtest.h>
+
+#include <arpa/inet.h>
+#include <endian.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <i01_core/Config.hpp>
+#include <i01_core/Time.hpp>
+
+#include <i01_oe/BATSOrder.hpp>
+#include <i01_oe/NASDAQOrder.hpp>
+#include <i01_oe/OrderManager.hpp>
+#include <i01_oe/WireCodec.hpp>
+
+#include "ARCA/ArcaDirect41/Codec.hpp"
+#include "ARCA/ArcaDirect41/Messages.hpp"
+#include "BATS/BOE20/Codec.hpp"
+#include "BATS/BOE20Session.hpp"
+#include "EDGE/XPRS130/Codec.hpp"
+#include "EDGE/XPRS130/Messages.hpp"
+#include "NASDAQ/OUCH42/Codec.hpp"
+#include "NASDAQ/OUCH42/Messages.hpp"
+#include "NASDAQ/OUCH42Session.hpp"
+#include "NASDAQ/SoupBinTCP30/Codec.hpp"
+#include "NASDAQ/SoupBinTCP30/Messages.hpp"
+#include "NYSE/UTPDirect/Codec.hpp"
+#include "NYSE/UTPDirect/Messages.hpp"
+
+#include "oe_test_util.hpp"
+
+namespace OE_WIRE_CODEC_TEST {
+
+using namespace OE_TEST;
+using namespace i01::OE::WireCodec;
+using i01::OE::BATS::BOE20Session;
+using i01::OE::NASDAQ::OUCH42Session;
+namespace SBT = i01::OE::NASDAQ::SoupBinTCP30;
+namespace O42 = i01::OE::NASDAQ::OUCH42;
+namespace BOE = i01::OE::BATS::BOE20;
+namespace AD41 = i01::OE::ARCA::ArcaDirect41;
+namespace XPRS = i01::OE::EDGE::XPRS130;
+namespace UTP = i01::OE::NYSE::UTPDirect;
+
+typedef std::vector<std::uint8_t> Bytes;
+
+const std::size_t BENCH_MESSAGES = 10000000;
+const int BENCH_ROUNDS = 5;
+const std::size_t NUM_BUFS = 64;
+/// How much slower than the structs the codec may measure.
+const double BENCH_SLACK = 1.25;
+const double BENCH_SLACK_NS = 0.5;
+const int WAIT_MS = 2000;
+
+template<typename T>
+Bytes bytes_of(const T& msg)
+{
+    const auto *p = reinterpret_cast<const std::uint8_t *>(&msg);
+    return Bytes(p, p + sizeof(msg));
+}
+
+template<typename Msg>
+Bytes bytes_of(const Writer<Msg>& w)
+{
+    return Bytes(w.data(), w.data() + Msg::SIZE);
+}
+
+/// A Msg from init and then set(w).
+template<typename Msg, typename Fn>
+Bytes encode(Fn set)
+{
+    Bytes b(Msg::SIZE);
+    Writer<Msg> w(b.data());
+    w.init();
+    set(w);
+    return b;
+}
+
+template<typename Msg>
+Bytes encode()
+{
+    return encode<Msg>([](const Writer<Msg>&) {});
+}
+
+inline Bytes cat(Bytes a, const Bytes& b)
+{
+    a.insert(a.end(), b.begin(), b.end());
+    return a;
+}
+
+template<typename Msg>
+std::string printed(const std::uint8_t *p)
+{
+    std::ostringstream ss;
+    ss << Reader<Msg>(p);
+    return ss.str();
+}
+
+/// Keeps the stores to p from being optimized away.
+inline void clobber(const void *p)
+{
+    asm volatile("" : : "r"(p) : "memory");
+}
+
+/// Polls pred for up to WAIT_MS: sessions handle what the exchange writes
+/// on their connection thread.
+template<typename Pred>
+bool eventually(Pred pred)
+{
+    for (int i = 0; i < WAIT_MS && !pred(); ++i)
+        ::usleep(1000);
+    return pred();
+}
+
+struct Member {
+    const char *name;
+    std::size_t offset;
+    std::size_t size;
+};
+
+/// A member of the packed struct S, by its path.
+#define MEMBER(S, m) Member{#m, offsetof(S, m), sizeof(static_cast<S *>(nullptr)->m)}
+
+/// Msg is the packed struct: its size, and field for member its offsets
+/// and sizes.
+template<typename Msg>
+void expect_layout(const char *name, std::size_t size, std::initializer_list<Member> members)
+{
+    SCOPED_TRACE(name);
+    EXPECT_EQ(size, Msg::SIZE);
+    ASSERT_EQ(members.size(), Msg::NUM_FIELDS);
+    std::size_t i = 0;
+    for (const auto& m : members) {
+        const auto& f = Msg::FIELDS[i++];
+        EXPECT_EQ(m.offset, f.offset) << f.name << " is " << m.name;
+        EXPECT_EQ(m.size, f.size) << f.name << " is " << m.name;
+    }
+}
+
+/// The exchange end of one session's connection, on a loopback port.
+class Exchange {
+public:
+    Exchange() : m_listener(::socket(AF_INET, SOCK_STREAM, 0)), m_fd(-1), m_port(0) {
+        EXPECT_LE(0, m_listener);
+        sockaddr_in addr;
+        ::memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = 0;
+        addr.sin_addr.s_addr = ::inet_addr("127.0.0.1");
+        EXPECT_EQ(0, ::bind(m_listener, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)));
+        EXPECT_EQ(0, ::listen(m_listener, 1));
+        socklen_t len = sizeof(addr);
+        EXPECT_EQ(0, ::getsockname(m_listener, reinterpret_cast<sockaddr *>(&addr), &len));
+        m_port = ntohs(addr.sin_port);
+    }
+    ~Exchange() {
+        if (m_fd >= 0)
+            ::close(m_fd);
+        ::close(m_listener);
+    }
+
+    int port() const { return m_port; }
+
+    bool accept() {
+        pollfd pfd = {m_listener, POLLIN, 0};
+        if (::poll(&pfd, 1, WAIT_MS) != 1)
+            return false;
+        m_fd = ::accept(m_listener, nullptr, nullptr);
+        return m_fd >= 0;
+    }
+
+    /// n bytes, or what arrived of them within WAIT_MS.
+    Bytes read(std::size_t n) {
+        Bytes b(n);
+        std::size_t got = 0;
+        while (got < n) {
+            pollfd pfd = {m_fd, POLLIN, 0};
+            if (::poll(&pfd, 1, WAIT_MS) != 1)
+                break;
+            const ssize_t len = ::recv(m_fd, b.data() + got, n - got, 0);
+            if (len <= 0)
+                break;
+            got += static_cast<std::size_t>(len);
+        }
+        b.resize(got);
+        return b;
+    }
+
+    void write(const Bytes& b) {
+        EXPECT_EQ(static_cast<ssize_t>(b.size()), ::send(m_fd, b.data(), b.size(), MSG_NOSIGNAL));
+    }
+
+private:
+    int m_listener;
+    int m_fd;
+    int m_port;
+};
+
+/* SoupBinTCP and OUCH */
+
+/// The next SoupBinTCP packet the session sent, past its heartbeats.
+inline Bytes sbt_packet(Exchange& ex)
+{
+    const auto heartbeat = encode<SBT::Codec::Heartbeat>();
+    for (;;) {
+        auto p = ex.read(sizeof(SBT::Types::PacketLength));
+        if (p.size() < sizeof(SBT::Types::PacketLength))
+            return p;
+        p = cat(p, ex.read(static_cast<std::size_t>(p[0] << 8 | p[1])));
+        if (p != heartbeat)
+            return p;
+    }
+}
+
+inline Bytes unsequenced(const Bytes& msg)
+{
+    namespace F = SBT::Codec::F;
+    return cat(encode<SBT::Codec::UnsequencedDataPacket>([&](const Writer<SBT::Codec::UnsequencedDataPacket>& w) {
+        w.set<F::packet_length>(static_cast<SBT::Types::PacketLength>(msg.size() + 1));
+    }), msg);
+}
+
+inline Bytes sequenced(const Bytes& msg)
+{
+    namespace F = SBT::Codec::F;
+    return cat(encode<SBT::Codec::SequencedDataPacket>([&](const Writer<SBT::Codec::SequencedDataPacket>& w) {
+        w.set<F::packet_length>(static_cast<SBT::Types::PacketLength>(msg.size() + 1));
+    }), msg);
+}
+
+/// The token OUCH42Session makes for the first order, a BUY of AAPL.
+const std::array<std::uint8_t, 14> OUCH_TOKEN = {{'I','A','A','P','L','0','0','0','0','0','0','0','0','1'}};
+const std::array<char, 4> OUCH_FIRM = {{'F','I','R','M'}};
+const std::array<char, 8> OUCH_STOCK = {{'A','A','P','L',' ',' ',' ',' '}};
+
+/// An EnterOrder as OUCH42Session::send fills it, for a DAY limit buy.
+inline void fill_enter_order(O42::Messages::EnterOrder& m, std::uint32_t shares, double price)
+{
+    namespace OT = O42::Types;
+    m.message_type = OT::InboundMessageType::ENTER_ORDER;
+    m.order_token.arr = OUCH_TOKEN;
+    m.buy_sell_indicator = OT::BuySellIndicator::BUY;
+    m.shares = htonl(shares);
+    m.stock.arr = OUCH_STOCK;
+    m.price.set_limit(price);
+    m.display = OT::Display::ANONYMOUS_PRICE_TO_COMPLY;
+    m.time_in_force.set_market_hours();
+    m.cross_type = OT::CrossType::NO_CROSS;
+    m.firm.arr = OUCH_FIRM;
+    m.capacity = OT::Capacity::AGENCY;
+    m.iso_eligibility = OT::IntermarketSweepEligibility::NOT_ELIGIBLE;
+    m.minimum_quantity = htonl(0);
+    m.customer_type = OT::CustomerType::USE_DEFAULT;
+}
+
+/// The same from the codec, every field set as the session sets them.
+inline void encode_enter_order(const Writer<O42::Codec::EnterOrder>& w, std::uint32_t shares, double price)
+{
+    namespace F = O42::Codec::F;
+    namespace OT = O42::Types;
+    w.set<F::order_token>(OUCH_TOKEN);
+    w.set<F::buy_sell_indicator>(OT::BuySellIndicator::BUY);
+    w.set<F::shares>(shares);
+    w.set<F::stock>(OUCH_STOCK);
+    w.set<F::price>(price);
+    w.set<F::display>(OT::Display::ANONYMOUS_PRICE_TO_COMPLY);
+    w.set<F::time_in_force>(OT::TimeInForceSpecial::MARKET_HOURS);
+    w.set<F::cross_type>(OT::CrossType::NO_CROSS);
+    w.set<F::firm>(OUCH_FIRM);
+    w.set<F::capacity>(OT::Capacity::AGENCY);
+    w.set<F::iso_eligibility>(OT::IntermarketSweepEligibility::NOT_ELIGIBLE);
+    w.set<F::minimum_quantity>(0u);
+    w.set<F::customer_type>(OT::CustomerType::USE_DEFAULT);
+}
+
+/// An OUCH42Session that the test may log out.
+class OUCH42Wire : public OUCH42Session {
+public:
+    OUCH42Wire(OrderManager *om_p, const std::string& name_) : OUCH42Session(om_p, name_) {}
+
+    using OUCH42Session::disconnect;
+};
+
+/// An OUCH42Session for AAPL connected to an Exchange and logged in, and
+/// the order manager it needs, in a scratch directory.
+struct OUCHFixture {
+    OUCHFixture() {
+        configure();
+        i01::core::Config::instance().load_strings({
+            {"oe.sessions.OUCH.type", "OUCH42Session"},
+            {"oe.sessions.OUCH.mic", "XNAS"},
+            {"oe.sessions.OUCH.protocol", "SoupBinTCP"},
+            {"oe.sessions.OUCH.remote.addr", "127.0.0.1"},
+            {"oe.sessions.OUCH.remote.port", std::to_string(ex.port())},
+            {"oe.sessions.OUCH.username", "USER"},
+            {"oe.sessions.OUCH.password", "PASSWORD"},
+            {"oe.sessions.OUCH.default_broker_locate", "0"},
+            {"oe.sessions.OUCH.firm_identifier", "FIRM"},
+            {"oe.sessions.OUCH.heartbeat_grace_period", "60"},
+            {"oe.sessions.OUCH.state_path", "ouch42.OUCH.state"},
+        });
+        om.init(*i01::core::Config::instance().get_shared_state());
+        session.reset(new OUCH42Wire(&om, "OUCH"));
+    }
+    ~OUCHFixture() {
+        session.reset();
+        ::unlink("ouch42.OUCH.state");
+    }
+
+    /// Checks the LoginRequest and accepts it at sequence number 1.
+    void login() {
+        namespace F = SBT::Codec::F;
+        ASSERT_TRUE(session->manual_connect());
+        ASSERT_TRUE(ex.accept());
+        EXPECT_EQ(encode<SBT::Codec::LoginRequest>([](const Writer<SBT::Codec::LoginRequest>& w) {
+            w.set<F::username>("USER");
+            w.set<F::password>("PASSWORD");
+            w.set<F::requested_sequence_number>("                   1");
+        }), sbt_packet(ex));
+        ex.write(encode<SBT::Codec::LoginAccept>([](const Writer<SBT::Codec::LoginAccept>& w) {
+            w.set<F::session>("SESSION");
+            w.set<F::sequence_number>("                   1");
+        }));
+        ASSERT_TRUE(eventually([&] { return session->active(); }));
+    }
+
+    Exchange ex;
+    ScratchDir scratch;
+    OrderManager om;
+    std::unique_ptr<OUCH42Wire> session;
+};
+
+/* BOE */
+
+/// What BOE20Session::fill_new_order writes for each order into a buffer
+/// prepare_new_order_buffer has set up.
+struct BOEOrderFields {
+    BOE::Types::ClOrdID cl_ord_id;
+    BOE::Types::Side side;
+    BOE::Types::Quantity qty;
+    double price;
+    BOE::Types::ExecInst exec_inst;
+    BOE::Types::OrdType ord_type;
+    BOE::Types::TimeInForce tif;
+    BOE::Types::DisplayIndicator display;
+    BOE::Types::RoutingInst routing_inst;
+    BOE::Types::Symbol symbol;
+};
+
+/// The packed structs, as fill_new_order does it.
+inline void fill_new_order(std::uint8_t *buf, const BOEOrderFields& f)
+{
+    auto *msg = reinterpret_cast<BOE::Messages::NewOrder *>(buf);
+    auto *opt = reinterpret_cast<BOE::Messages::NewOrder::OptionalFields *>(buf + sizeof(BOE::Messages::NewOrder) + 6);
+    msg->cl_ord_id = f.cl_ord_id;
+    msg->side = f.side;
+    msg->order_qty = f.qty;
+    opt->price = static_cast<BOE::Types::Price>(f.price * BOE::Types::PRICE_DIVISOR + 0.5);
+    opt->exec_inst = f.exec_inst;
+    opt->ord_type = f.ord_type;
+    opt->time_in_force = f.tif;
+    opt->display_indicator = f.display;
+    opt->routing_inst = f.routing_inst;
+    opt->symbol.arr = f.symbol.arr;
+}
+
+/// The same from the codec.
+inline void encode_new_order(const Writer<BOE::Codec::NewOrder>& w, const BOEOrderFields& f)
+{
+    namespace F = BOE::Codec::F;
+    w.set<F::cl_ord_id>(f.cl_ord_id.arr);
+    w.set<F::side>(f.side);
+    w.set<F::order_qty>(f.qty);
+    w.set<F::price>(f.price);
+    w.set<F::exec_inst>(f.exec_inst);
+    w.set<F::ord_type>(f.ord_type);
+    w.set<F::time_in_force>(f.tif);
+    w.set<F::display_indicator>(f.display);
+    w.set<F::routing_inst>(f.routing_inst.text.arr);
+    w.set<F::symbol>(f.symbol.arr);
+}
+
+/// The session fields BOE20Session::prepare_new_order_buffer sets once.
+inline void init_new_order(const Writer<BOE::Codec::NewOrder>& w)
+{
+    namespace F = BOE::Codec::F;
+    w.init();
+    w.set<F::clearing_firm>("CLRF");
+    w.set<F::clearing_account>("CLRA");
+    w.set<F::capacity>(BOE::Types::Capacity::AGENCY);
+    w.set<F::account>("DEFG");
+    w.set<F::attributed_quote>('N');
+    w.set<F::ext_exec_inst>('N');
+}
+
+/// A BOE20Session that hands out the bytes it serializes, less the sequence
+/// number and the socket, and names its inbound messages.
+class BOE20Wire : public BOE20Session {
+public:
+    BOE20Wire(OrderManager *om_p, const std::string& name_) : BOE20Session(om_p, name_) {}
+
+    template<typename M> using Inbound = BOE20Session::InboundMsgBuffer<M>;
+
+    Bytes new_order(Order *op) {
+        NewOrderBuffer *buf;
+        EXPECT_TRUE(m_no_bufs.get(buf));
+        EXPECT_TRUE(fill_new_order(op, *buf));
+        Bytes v(buf->data.bytes, buf->data.bytes + buf->msglen);
+        m_no_bufs.release(buf);
+        return v;
+    }
+
+    /// As send_cancel does it.
+    Bytes cancel_order(Order *op) {
+        CancelOrderBuffer *buf;
+        EXPECT_TRUE(m_cxl_bufs.get(buf));
+        buf->data.msg.orig_cl_ord_id = create_cl_ord_id(op);
+        Bytes v(buf->data.bytes, buf->data.bytes + buf->msglen);
+        m_cxl_bufs.release(buf);
+        return v;
+    }
+
+    BOE::Types::ClOrdID cl_ord_id(Order *op) const { return create_cl_ord_id(op); }
+};
+
+/// The fields of o's NewOrder, once the session has resolved the BOE20
+/// attributes it defaults.
+inline BOEOrderFields boe_fields(const BOE20Wire& s, BATSOrder& o, BOE::Types::Side side, BOE::Types::TimeInForce tif)
+{
+    BOEOrderFields f{s.cl_ord_id(&o), side, static_cast<BOE::Types::Quantity>(o.size()), o.price(),
+                     o.boe_exec_inst(), BOE::Types::OrdType::LIMIT, tif,
+                     o.boe_display_indicator(), o.boe_routing_inst(), BOE::Types::Symbol()};
+    f.symbol.arr.fill('\0');
+    std::memcpy(f.symbol.arr.data(), "AAPL", 4);
+    return f;
+}
+
+/// A BOE20Session for AAPL and the order manager it needs, in a scratch
+/// directory.
+struct BOEFixture {
+    explicit BOEFixture(int port = 1) {
+        configure();
+        i01::core::Config::instance().load_strings({
+            {"oe.sessions.BOE.type", "BOE20Session"},
+            {"oe.sessions.BOE.mic", "BATS"},
+            {"oe.sessions.BOE.remote.addr", "127.0.0.1"},
+            {"oe.sessions.BOE.remote.port", std::to_string(port)},
+            {"oe.sessions.BOE.session_sub_id", "0001"},
+            {"oe.sessions.BOE.username", "TEST"},
+            {"oe.sessions.BOE.password", "TEST"},
+            {"oe.sessions.BOE.clearing_firm", "CLRF"},
+            {"oe.sessions.BOE.clearing_account", "CLRA"},
+            {"oe.sessions.BOE.hpr_broker_loc", "B"},
+            {"oe.sessions.BOE.state_path", "boe20.BOE.state"},
+            {"oe.sessions.BOE.new_order_templates", "false"},
+        });
+        om.init(*i01::core::Config::instance().get_shared_state());
+        session.reset(new BOE20Wire(&om, "BOE"));
+    }
+    ~BOEFixture() {
+        session.reset();
+        ::unlink("boe20.BOE.state");
+    }
+
+    ScratchDir scratch;
+    OrderManager om;
+    std::unique_ptr<BOE20Wire> session;
+};
+
+/// The next BOE message the session sent, past its heartbeats.
+inline Bytes boe_message(Exchange& ex)
+{
+    const auto heartbeat = encode<BOE::Codec::ClientHeartbeat>();
+    for (;;) {
+        auto m = ex.read(sizeof(BOE::Types::StartOfMessage) + sizeof(BOE::Types::MessageLength));
+        if (m.size() < sizeof(BOE::Types::StartOfMessage) + sizeof(BOE::Types::MessageLength))
+            return m;
+        m = cat(m, ex.read(static_cast<std::size_t>(m[2] | m[3] << 8) - sizeof(BOE::Types::MessageLength)));
+        if (m != heartbeat)
+            return m;
+    }
+}
+
+/// The return bitfields group asking for Resp as the codec reads it.
+template<typename Resp>
+Bytes return_bitfields()
+{
+    namespace F = BOE::Codec::F;
+    const auto resp = encode<Resp>();
+    const Reader<Resp> r(resp.data());
+    return encode<BOE::Codec::ReturnBitfieldsParamGroup>([&](const Writer<BOE::Codec::ReturnBitfieldsParamGroup>& w) {
+        w.set<F::message_type>(r.template get<F::message_type>());
+        w.set<F::bitfield1>(r.template get<F::bitfield1>());
+        w.set<F::bitfield2>(r.template get<F::bitfield2>());
+        w.set<F::bitfield3>(r.template get<F::bitfield3>());
+        w.set<F::bitfield4>(r.template get<F::bitfield4>());
+        w.set<F::bitfield5>(r.template get<F::bitfield5>());
+        w.set<F::bitfield6>(r.template get<F::bitfield6>());
+        w.set<F::bitfield7>(r.template get<F::bitfield7>());
+        w.set<F::bitfield8>(r.template get<F::bitfield8>());
+    });
+}
+
+/// ns per call of BENCH_MESSAGES calls of f(buffer, i).
+template<typename Fn>
+double time_calls(std::vector<std::array<std::uint8_t, 256>>& bufs, Fn f)
+{
+    const auto start = Timestamp::now();
+    for (std::size_t i = 0; i < BENCH_MESSAGES; ++i) {
+        auto *p = bufs[i % NUM_BUFS].data();
+        f(p, i);
+        clobber(p);
+    }
+    return static_cast<double>(to_ns(Timestamp::now() - start)) / BENCH_MESSAGES;
+}
+
+/// Best of BENCH_ROUNDS of fs and of fc, in ns per call, taking turns so
+/// that the noise of the machine falls on both.
+template<typename FS, typename FC>
+std::pair<double, double> bench(std::vector<std::array<std::uint8_t, 256>>& bufs, FS fs, FC fc)
+{
+    std::pair<double, double> best(1e9, 1e9);
+    for (int round = 0; round < BENCH_ROUNDS; ++round) {
+        best.first = std::min(best.first, time_calls(bufs, fs));
+        best.second = std::min(best.second, time_calls(bufs, fc));
+    }
+    return best;
+}
+
+}
+
+TEST(oe_wire_codec, oe_wire_codec_fields)
+{
+    using namespace OE_WIRE_CODEC_TEST;
+    using Msg = O42::Codec::EnterOrder;
+    namespace F = O42::Codec::F;
+    static_assert(Msg::offset<F::price>() == offsetof(O42::Messages::EnterOrder, price), "constant offsets");
+
+    // the field table is the struct, field by field:
+    std::size_t offset = 0;
+    for (const auto& f : Msg::FIELDS) {
+        EXPECT_EQ(offset, f.offset) << f.name;
+        offset += f.size;
+    }
+    EXPECT_EQ(Msg::SIZE, offset);
+    EXPECT_EQ(sizeof(O42::Messages::EnterOrder), offset);
+    EXPECT_EQ(14u, Msg::NUM_FIELDS);
+    EXPECT_STREQ("minimum_quantity", Msg::FIELDS[11].name);
+    EXPECT_EQ(offsetof(O42::Messages::EnterOrder, minimum_quantity), Msg::FIELDS[11].offset);
+
+    // init writes the literals and pads the text, fillers are not printed:
+    std::array<std::uint8_t, UTP::Codec::NewOrder1::SIZE> utp;
+    utp.fill(0xff);
+    Writer<UTP::Codec::NewOrder1> w(utp.data());
+    w.init();
+    EXPECT_EQ(UTP::Types::MessageType::NEW_ORDER_1, Reader<UTP::Codec::NewOrder1>(utp.data()).get<UTP::Codec::F::message_type>());
+    EXPECT_EQ(84u, Reader<UTP::Codec::NewOrder1>(utp.data()).get<UTP::Codec::F::msg_length>());
+    EXPECT_EQ(0u, utp[UTP::Codec::NewOrder1::SIZE - 1]);
+    // 21 fields, less the filler:
+    const auto s = printed<UTP::Codec::NewOrder1>(utp.data());
+    EXPECT_EQ(19, std::count(s.begin(), s.end(), ','));
+}
+
+TEST(oe_wire_codec, oe_wire_codec_layout_nasdaq)
+{
+    using namespace OE_WIRE_CODEC_TEST;
+
+    {
+        using S = SBT::Messages::DebugPacket;
+        expect_layout<SBT::Codec::DebugPacket>("SBT DebugPacket", sizeof(S), {
+            MEMBER(S, hdr.packet_length), MEMBER(S, hdr.packet_type)
+        });
+    }
+    {
+        using S = SBT::Messages::LoginAccept;
+        expect_layout<SBT::Codec::LoginAccept>("SBT LoginAccept", sizeof(S), {
+            MEMBER(S, hdr.packet_length), MEMBER(S, hdr.packet_type), MEMBER(S, session),
+            MEMBER(S, sequence_number)
+        });
+    }
+    {
+        using S = SBT::Messages::LoginReject;
+        expect_layout<SBT::Codec::LoginReject>("SBT LoginReject", sizeof(S), {
+            MEMBER(S, hdr.packet_length), MEMBER(S, hdr.packet_type), MEMBER(S, reason_code)
+        });
+    }
+    {
+        using S = SBT::Messages::SequencedDataPacket;
+        expect_layout<SBT::Codec::SequencedDataPacket>("SBT SequencedDataPacket", sizeof(S), {
+            MEMBER(S, hdr.packet_length), MEMBER(S, hdr.packet_type)
+        });
+    }
+    {
+        using S = SBT::Messages::ServerHeartbeat;
+        expect_layout<SBT::Codec::ServerHeartbeat>("SBT ServerHeartbeat", sizeof(S), {
+            MEMBER(S, hdr.packet_length), MEMBER(S, hdr.packet_type)
+        });
+    }
+    {
+        using S = SBT::Messages::EndOfSession;
+        expect_layout<SBT::Codec::EndOfSession>("SBT EndOfSession", sizeof(S), {
+            MEMBER(S, hdr.packet_length), MEMBER(S, hdr.packet_type)
+        });
+    }
+    {
+        using S = SBT::Messages::LoginRequest;
+        expect_layout<SBT::Codec::LoginRequest>("SBT LoginRequest", sizeof(S), {
+            MEMBER(S, packet_length), MEMBER(S, packet_type), MEMBER(S, username), MEMBER(S, password),
+            MEMBER(S, requested_session), MEMBER(S, requested_sequence_number)
+        });
+    }
+    {
+        using S = SBT::Messages::UnsequencedDataPacket;
+        expect_layout<SBT::Codec::UnsequencedDataPacket>("SBT UnsequencedDataPacket", sizeof(S), {
+            MEMBER(S, packet_length), MEMBER(S, packet_type)
+        });
+    }
+    {
+        using S = SBT::Messages::Heartbeat;
+        expect_layout<SBT::Codec::Heartbeat>("SBT Heartbeat", sizeof(S), {
+            MEMBER(S, packet_length), MEMBER(S, packet_type)
+        });
+    }
+    {
+        using S = SBT::Messages::LogoutRequest;
+        expect_layout<SBT::Codec::LogoutRequest>("SBT LogoutRequest", sizeof(S), {
+            MEMBER(S, packet_length), MEMBER(S, packet_type)
+        });
+    }
+    {
+        using S = O42::Messages::EnterOrder;
+        expect_layout<O42::Codec::EnterOrder>("O42 EnterOrder", sizeof(S), {
+            MEMBER(S, message_type), MEMBER(S, order_token), MEMBER(S, buy_sell_indicator), MEMBER(S, shares),
+            MEMBER(S, stock), MEMBER(S, price), MEMBER(S, time_in_force), MEMBER(S, firm), MEMBER(S, display),
+            MEMBER(S, capacity), MEMBER(S, iso_eligibility), MEMBER(S, minimum_quantity),
+            MEMBER(S, cross_type), MEMBER(S, customer_type)
+        });
+    }
+    {
+        using S = O42::Messages::ReplaceOrder;
+        expect_layout<O42::Codec::ReplaceOrder>("O42 ReplaceOrder", sizeof(S), {
+            MEMBER(S, message_type), MEMBER(S, existing_order_token), MEMBER(S, replacement_order_token),
+            MEMBER(S, shares), MEMBER(S, price), MEMBER(S, time_in_force), MEMBER(S, display),
+            MEMBER(S, iso_eligibility), MEMBER(S, minimum_quantity)
+        });
+    }
+    {
+        using S = O42::Messages::CancelOrder;
+        expect_layout<O42::Codec::CancelOrder>("O42 CancelOrder", sizeof(S), {
+            MEMBER(S, message_type), MEMBER(S, order_token), MEMBER(S, shares)
+        });
+    }
+    {
+        using S = O42::Messages::ModifyOrder;
+        expect_layout<O42::Codec::ModifyOrder>("O42 ModifyOrder", sizeof(S), {
+            MEMBER(S, message_type), MEMBER(S, order_token), MEMBER(S, buy_sell_indicator), MEMBER(S, shares)
+        });
+    }
+    {
+        using S = O42::Messages::SystemEvent;
+        expect_layout<O42::Codec::SystemEvent>("O42 SystemEvent", sizeof(S), {
+            MEMBER(S, hdr.message_type), MEMBER(S, hdr.exch_time), MEMBER(S, system_event_code)
+        });
+    }
+    {
+        using S = O42::Messages::Accepted;
+        expect_layout<O42::Codec::Accepted>("O42 Accepted", sizeof(S), {
+            MEMBER(S, hdr.message_type), MEMBER(S, hdr.exch_time), MEMBER(S, hdr.order_token),
+            MEMBER(S, buy_sell_indicator), MEMBER(S, shares), MEMBER(S, stock), MEMBER(S, price),
+            MEMBER(S, time_in_force), MEMBER(S, firm), MEMBER(S, display), MEMBER(S, order_reference_number),
+            MEMBER(S, capacity), MEMBER(S, iso_eligibility), MEMBER(S, minimum_quantity),
+            MEMBER(S, cross_type), MEMBER(S, order_state), MEMBER(S, bbo_weight_indicator)
+        });
+    }
+    {
+        using S = O42::Messages::Replaced;
+        expect_layout<O42::Codec::Replaced>("O42 Replaced", sizeof(S), {
+            MEMBER(S, hdr.message_type), MEMBER(S, hdr.exch_time), MEMBER(S, hdr.order_token),
+            MEMBER(S, buy_sell_indicator), MEMBER(S, shares), MEMBER(S, stock), MEMBER(S, price),
+            MEMBER(S, time_in_force), MEMBER(S, firm), MEMBER(S, display), MEMBER(S, order_reference_number),
+            MEMBER(S, capacity), MEMBER(S, iso_eligibility), MEMBER(S, minimum_quantity),
+            MEMBER(S, cross_type), MEMBER(S, order_state), MEMBER(S, previous_order_token),
+            MEMBER(S, bbo_weight_indicator)
+        });
+    }
+    {
+        using S = O42::Messages::Canceled;
+        expect_layout<O42::Codec::Canceled>("O42 Canceled", sizeof(S), {
+            MEMBER(S, hdr.message_type), MEMBER(S, hdr.exch_time), MEMBER(S, hdr.order_token),
+            MEMBER(S, decremented_shares), MEMBER(S, reason)
+        });
+    }
+    {
+        using S = O42::Messages::AIQCanceled;
+        expect_layout<O42::Codec::AIQCanceled>("O42 AIQCanceled", sizeof(S), {
+            MEMBER(S, hdr.message_type), MEMBER(S, hdr.exch_time), MEMBER(S, hdr.order_token),
+            MEMBER(S, decremented_shares), MEMBER(S, reason), MEMBER(S, quantity_prevented_from_trading),
+            MEMBER(S, execution_price), MEMBER(S, liquidity_flag)
+        });
+    }
+    {
+        using S = O42::Messages::Executed;
+        expect_layout<O42::Codec::Executed>("O42 Executed", sizeof(S), {
+            MEMBER(S, hdr.message_type), MEMBER(S, hdr.exch_time), MEMBER(S, hdr.order_token),
+            MEMBER(S, executed_shares), MEMBER(S, execution_price), MEMBER(S, liquidity_flag),
+            MEMBER(S, match_number)
+        });
+    }
+    {
+        using S = O42::Messages::BrokenTrade;
+        expect_layout<O42::Codec::BrokenTrade>("O42 BrokenTrade", sizeof(S), {
+            MEMBER(S, hdr.message_type), MEMBER(S, hdr.exch_time), MEMBER(S, hdr.order_token),
+            MEMBER(S, match_number), MEMBER(S, reason)
+        });
+    }
+    {
+        using S = O42::Messages::Rejected;
+        expect_layout<O42::Codec::Rejected>("O42 Rejected", sizeof(S), {
+            MEMBER(S, hdr.message_type), MEMBER(S, hdr.exch_time), MEMBER(S, hdr.order_token),
+            MEMBER(S, reason)
+        });
+    }
+    {
+        using S = O42::Messages::CancelPending;
+        expect_layout<O42::Codec::CancelPending>("O42 CancelPending", sizeof(S), {
+            MEMBER(S, hdr.message_type), MEMBER(S, hdr.exch_time), MEMBER(S, hdr.order_token)
+        });
+    }
+    {
+        using S = O42::Messages::CancelReject;
+        expect_layout<O42::Codec::CancelReject>("O42 CancelReject", sizeof(S), {
+            MEMBER(S, hdr.message_type), MEMBER(S, hdr.exch_time), MEMBER(S, hdr.order_token)
+        });
+    }
+    {
+        using S = O42::Messages::OrderPriorityUpdate;
+        expect_layout<O42::Codec::OrderPriorityUpdate>("O42 OrderPriorityUpdate", sizeof(S), {
+            MEMBER(S, hdr.message_type), MEMBER(S, hdr.exch_time), MEMBER(S, hdr.order_token),
+            MEMBER(S, execution_price), MEMBER(S, display), MEMBER(S, order_reference_number)
+        });
+    }
+    {
+        using S = O42::Messages::Modified;
+        expect_layout<O42::Codec::Modified>("O42 Modified", sizeof(S), {
+            MEMBER(S, hdr.message_type), MEMBER(S, hdr.exch_time), MEMBER(S, hdr.order_token),
+            MEMBER(S, buy_sell_indicator), MEMBER(S, shares)
+        });
+    }
+}
+
+TEST(oe_wire_codec, oe_wire_codec_layout_bats)
+{
+    using namespace OE_WIRE_CODEC_TEST;
+
+    {
+        using S = BOE::Messages::LoginRequest;
+        expect_layout<BOE::Codec::LoginRequest>("BOE LoginRequest", sizeof(S), {
+            MEMBER(S, header.start_of_message), MEMBER(S, header.message_length),
+            MEMBER(S, header.message_type), MEMBER(S, header.matching_unit),
+            MEMBER(S, header.sequence_number), MEMBER(S, session_sub_id), MEMBER(S, username),
+            MEMBER(S, password), MEMBER(S, num_param_groups)
+        });
+    }
+    {
+        using S = BOE::Messages::UnitSequencesParamGroup;
+        expect_layout<BOE::Codec::UnitSequencesParamGroup>("BOE UnitSequencesParamGroup", sizeof(S), {
+            MEMBER(S, header.length), MEMBER(S, header.type), MEMBER(S, no_unspecified_unit_replay),
+            MEMBER(S, unit_sequence_number.number_of_units)
+        });
+    }
+    {
+        using S = BOE::Messages::UnitNumberSequencePair;
+        expect_layout<BOE::Codec::UnitNumberSequencePair>("BOE UnitNumberSequencePair", sizeof(S), {
+            MEMBER(S, unit_number), MEMBER(S, unit_sequence)
+        });
+    }
+    {
+        using S = BOE::Messages::ReturnBitfieldsParamGroup;
+        expect_layout<BOE::Codec::ReturnBitfieldsParamGroup>("BOE ReturnBitfieldsParamGroup", sizeof(S), {
+            MEMBER(S, header.length), MEMBER(S, header.type), MEMBER(S, message_type),
+            MEMBER(S, bitfields.num_bitfields), MEMBER(S, bitfields.bitfields.u8[0]),
+            MEMBER(S, bitfields.bitfields.u8[1]), MEMBER(S, bitfields.bitfields.u8[2]),
+            MEMBER(S, bitfields.bitfields.u8[3]), MEMBER(S, bitfields.bitfields.u8[4]),
+            MEMBER(S, bitfields.bitfields.u8[5]), MEMBER(S, bitfields.bitfields.u8[6]),
+            MEMBER(S, bitfields.bitfields.u8[7])
+        });
+    }
+    {
+        using S = BOE::Messages::LogoutRequest;
+        expect_layout<BOE::Codec::LogoutRequest>("BOE LogoutRequest", sizeof(S), {
+            MEMBER(S, message_header.start_of_message), MEMBER(S, message_header.message_length),
+            MEMBER(S, message_header.message_type), MEMBER(S, message_header.matching_unit),
+            MEMBER(S, message_header.sequence_number)
+        });
+    }
+    {
+        using S = BOE::Messages::ClientHeartbeat;
+        expect_layout<BOE::Codec::ClientHeartbeat>("BOE ClientHeartbeat", sizeof(S), {
+            MEMBER(S, message_header.start_of_message), MEMBER(S, message_header.message_length),
+            MEMBER(S, message_header.message_type), MEMBER(S, message_header.matching_unit),
+            MEMBER(S, message_header.sequence_number)
+        });
+    }
+    {
+        using S = BOE::Messages::LoginResponse;
+        expect_layout<BOE::Codec::LoginResponse>("BOE LoginResponse", sizeof(S), {
+            MEMBER(S, message_header.start_of_message), MEMBER(S, message_header.message_length),
+            MEMBER(S, message_header.message_type), MEMBER(S, message_header.matching_unit),
+            MEMBER(S, message_header.sequence_number), MEMBER(S, login_response_status),
+            MEMBER(S, login_response_text), MEMBER(S, no_unspecified_unit_replay),
+            MEMBER(S, last_received_sequence_number), MEMBER(S, unit_sequence_number.number_of_units)
+        });
+    }
+    {
+        using S = BOE::Messages::Logout;
+        expect_layout<BOE::Codec::Logout>("BOE Logout", sizeof(S), {
+            MEMBER(S, message_header.start_of_message), MEMBER(S, message_header.message_length),
+            MEMBER(S, message_header.message_type), MEMBER(S, message_header.matching_unit),
+            MEMBER(S, message_header.sequence_number), MEMBER(S, logout_reason),
+            MEMBER(S, logout_reason_text), MEMBER(S, last_received_sequence_number),
+            MEMBER(S, unit_sequence_number.number_of_units)
+        });
+    }
+    {
+        using S = BOE::Messages::ServerHeartbeat;
+        expect_layout<BOE::Codec::ServerHeartbeat>("BOE ServerHeartbeat", sizeof(S), {
+            MEMBER(S, message_header.start_of_message), MEMBER(S, message_header.message_length),
+            MEMBER(S, message_header.message_type), MEMBER(S, message_header.matching_unit),
+            MEMBER(S, message_header.sequence_number)
+        });
+    }
+    {
+        using S = BOE::Messages::ReplayComplete;
+        expect_layout<BOE::Codec::ReplayComplete>("BOE ReplayComplete", sizeof(S), {
+            MEMBER(S, message_header.start_of_message), MEMBER(S, message_header.message_length),
+            MEMBER(S, message_header.message_type), MEMBER(S, message_header.matching_unit),
+            MEMBER(S, message_header.sequence_number)
+        });
+    }
+    {
+        using S = BOE20Wire::Inbound<BOE::Messages::OrderAcknowledgment>;
+        expect_layout<BOE::Codec::OrderAcknowledgment>("BOE OrderAcknowledgment", sizeof(S), {
+            MEMBER(S, msg.message_header.start_of_message), MEMBER(S, msg.message_header.message_length),
+            MEMBER(S, msg.message_header.message_type), MEMBER(S, msg.message_header.matching_unit),
+            MEMBER(S, msg.message_header.sequence_number), MEMBER(S, msg.transaction_time),
+            MEMBER(S, msg.cl_ord_id), MEMBER(S, msg.order_id), MEMBER(S, msg.reserved),
+            MEMBER(S, msg.number_of_return_bitfields), MEMBER(S, return_bitfields[0]),
+            MEMBER(S, return_bitfields[1]), MEMBER(S, return_bitfields[2]), MEMBER(S, return_bitfields[3]),
+            MEMBER(S, return_bitfields[4]), MEMBER(S, return_bitfields[5]), MEMBER(S, return_bitfields[6]),
+            MEMBER(S, return_bitfields[7]), MEMBER(S, opt.side), MEMBER(S, opt.peg_difference),
+            MEMBER(S, opt.price), MEMBER(S, opt.exec_inst), MEMBER(S, opt.ord_type),
+            MEMBER(S, opt.time_in_force), MEMBER(S, opt.min_qty), MEMBER(S, opt.max_remove_pct),
+            MEMBER(S, opt.symbol), MEMBER(S, opt.capacity), MEMBER(S, opt.account),
+            MEMBER(S, opt.clearing_firm), MEMBER(S, opt.clearing_account), MEMBER(S, opt.display_indicator),
+            MEMBER(S, opt.max_floor), MEMBER(S, opt.discretion_amount), MEMBER(S, opt.order_qty),
+            MEMBER(S, opt.leaves_qty), MEMBER(S, opt.display_price), MEMBER(S, opt.working_price),
+            MEMBER(S, opt.attributed_quote), MEMBER(S, opt.ext_exec_inst), MEMBER(S, opt.routing_inst)
+        });
+    }
+    {
+        using S = BOE20Wire::Inbound<BOE::Messages::OrderRejected>;
+        expect_layout<BOE::Codec::OrderRejected>("BOE OrderRejected", sizeof(S), {
+            MEMBER(S, msg.message_header.start_of_message), MEMBER(S, msg.message_header.message_length),
+            MEMBER(S, msg.message_header.message_type), MEMBER(S, msg.message_header.matching_unit),
+            MEMBER(S, msg.message_header.sequence_number), MEMBER(S, msg.transaction_time),
+            MEMBER(S, msg.cl_ord_id), MEMBER(S, msg.order_reject_reason), MEMBER(S, msg.text),
+            MEMBER(S, msg.reserved), MEMBER(S, msg.number_of_return_bitfields),
+            MEMBER(S, return_bitfields[0]), MEMBER(S, return_bitfields[1]), MEMBER(S, return_bitfields[2]),
+            MEMBER(S, return_bitfields[3]), MEMBER(S, return_bitfields[4]), MEMBER(S, return_bitfields[5]),
+            MEMBER(S, return_bitfields[6]), MEMBER(S, return_bitfields[7]), MEMBER(S, opt.side),
+            MEMBER(S, opt.peg_difference), MEMBER(S, opt.price), MEMBER(S, opt.exec_inst),
+            MEMBER(S, opt.ord_type), MEMBER(S, opt.time_in_force), MEMBER(S, opt.min_qty),
+            MEMBER(S, opt.max_remove_pct), MEMBER(S, opt.symbol), MEMBER(S, opt.capacity),
+            MEMBER(S, opt.account), MEMBER(S, opt.clearing_firm), MEMBER(S, opt.clearing_account),
+            MEMBER(S, opt.display_indicator), MEMBER(S, opt.max_floor), MEMBER(S, opt.discretion_amount),
+            MEMBER(S, opt.order_qty), MEMBER(S, opt.attributed_quote), MEMBER(S, opt.ext_exec_inst),
+            MEMBER(S, opt.routing_inst)
+        });
+    }
+    {
+        using S = BOE20Wire::Inbound<BOE::Messages::OrderModified>;
+        expect_layout<BOE::Codec::OrderModified>("BOE OrderModified", sizeof(S), {
+            MEMBER(S, msg.message_header.start_of_message), MEMBER(S, msg.message_header.message_length),
+            MEMBER(S, msg.message_header.message_type), MEMBER(S, msg.message_header.matching_unit),
+            MEMBER(S, msg.message_header.sequence_number), MEMBER(S, msg.transaction_time),
+            MEMBER(S, msg.cl_ord_id), MEMBER(S, msg.order_id), MEMBER(S, msg.reserved),
+            MEMBER(S, msg.number_of_return_bitfields), MEMBER(S, return_bitfields[0]),
+            MEMBER(S, return_bitfields[1]), MEMBER(S, return_bitfields[2]), MEMBER(S, return_bitfields[3]),
+            MEMBER(S, return_bitfields[4]), MEMBER(S, return_bitfields[5]), MEMBER(S, return_bitfields[6]),
+            MEMBER(S, return_bitfields[7]), MEMBER(S, opt.side), MEMBER(S, opt.peg_difference),
+            MEMBER(S, opt.price), MEMBER(S, opt.exec_inst), MEMBER(S, opt.ord_type),
+            MEMBER(S, opt.time_in_force), MEMBER(S, opt.min_qty), MEMBER(S, opt.max_remove_pct),
+            MEMBER(S, opt.account), MEMBER(S, opt.clearing_firm), MEMBER(S, opt.clearing_account),
+            MEMBER(S, opt.display_indicator), MEMBER(S, opt.max_floor), MEMBER(S, opt.discretion_amount),
+            MEMBER(S, opt.order_qty), MEMBER(S, opt.orig_cl_ord_id), MEMBER(S, opt.leaves_qty),
+            MEMBER(S, opt.display_price), MEMBER(S, opt.working_price), MEMBER(S, opt.attributed_quote),
+            MEMBER(S, opt.ext_exec_inst), MEMBER(S, opt.routing_inst)
+        });
+    }
+    {
+        using S = BOE20Wire::Inbound<BOE::Messages::OrderRestated>;
+        expect_layout<BOE::Codec::OrderRestated>("BOE OrderRestated", sizeof(S), {
+            MEMBER(S, msg.message_header.start_of_message), MEMBER(S, msg.message_header.message_length),
+            MEMBER(S, msg.message_header.message_type), MEMBER(S, msg.message_header.matching_unit),
+            MEMBER(S, msg.message_header.sequence_number), MEMBER(S, msg.transaction_time),
+            MEMBER(S, msg.cl_ord_id), MEMBER(S, msg.order_id), MEMBER(S, msg.restatement_reason),
+            MEMBER(S, msg.reserved), MEMBER(S, msg.number_of_return_bitfields),
+            MEMBER(S, return_bitfields[0]), MEMBER(S, return_bitfields[1]), MEMBER(S, return_bitfields[2]),
+            MEMBER(S, return_bitfields[3]), MEMBER(S, return_bitfields[4]), MEMBER(S, return_bitfields[5]),
+            MEMBER(S, return_bitfields[6]), MEMBER(S, return_bitfields[7]), MEMBER(S, opt.side),
+            MEMBER(S, opt.peg_difference), MEMBER(S, opt.price), MEMBER(S, opt.exec_inst),
+            MEMBER(S, opt.ord_type), MEMBER(S, opt.time_in_force), MEMBER(S, opt.min_qty),
+            MEMBER(S, opt.max_remove_pct), MEMBER(S, opt.symbol), MEMBER(S, opt.capacity),
+            MEMBER(S, opt.account), MEMBER(S, opt.clearing_firm), MEMBER(S, opt.clearing_account),
+            MEMBER(S, opt.display_indicator), MEMBER(S, opt.max_floor), MEMBER(S, opt.discretion_amount),
+            MEMBER(S, opt.order_qty), MEMBER(S, opt.orig_cl_ord_id), MEMBER(S, opt.leaves_qty),
+            MEMBER(S, opt.display_price), MEMBER(S, opt.working_price), MEMBER(S, opt.attributed_quote),
+            MEMBER(S, opt.ext_exec_inst), MEMBER(S, opt.routing_inst)
+        });
+    }
+    {
+        using S = BOE::Messages::UserModifyRejected;
+        expect_layout<BOE::Codec::UserModifyRejected>("BOE UserModifyRejected", sizeof(S) + 8, {
+            MEMBER(S, message_header.start_of_message), MEMBER(S, message_header.message_length),
+            MEMBER(S, message_header.message_type), MEMBER(S, message_header.matching_unit),
+            MEMBER(S, message_header.sequence_number), MEMBER(S, transaction_time), MEMBER(S, cl_ord_id),
+            MEMBER(S, modify_reject_reason), MEMBER(S, text), MEMBER(S, reserved),
+            MEMBER(S, order_rejected_bitfields.num_bitfields),
+            MEMBER(S, order_rejected_bitfields.bitfields[0]),
+            MEMBER(S, order_rejected_bitfields.bitfields[1]),
+            MEMBER(S, order_rejected_bitfields.bitfields[2]),
+            MEMBER(S, order_rejected_bitfields.bitfields[3]),
+            MEMBER(S, order_rejected_bitfields.bitfields[4]),
+            MEMBER(S, order_rejected_bitfields.bitfields[5]),
+            MEMBER(S, order_rejected_bitfields.bitfields[6]),
+            MEMBER(S, order_rejected_bitfields.bitfields[7])
+        });
+    }
+    {
+        using S = BOE20Wire::Inbound<BOE::Messages::OrderCancelled>;
+        expect_layout<BOE::Codec::OrderCancelled>("BOE OrderCancelled", sizeof(S), {
+            MEMBER(S, msg.message_header.start_of_message), MEMBER(S, msg.message_header.message_length),
+            MEMBER(S, msg.message_header.message_type), MEMBER(S, msg.message_header.matching_unit),
+            MEMBER(S, msg.message_header.sequence_number), MEMBER(S, msg.transaction_time),
+            MEMBER(S, msg.cl_ord_id), MEMBER(S, msg.cancel_reason), MEMBER(S, msg.reserved),
+            MEMBER(S, msg.number_of_return_bitfields), MEMBER(S, return_bitfields[0]),
+            MEMBER(S, return_bitfields[1]), MEMBER(S, return_bitfields[2]), MEMBER(S, return_bitfields[3]),
+            MEMBER(S, return_bitfields[4]), MEMBER(S, return_bitfields[5]), MEMBER(S, return_bitfields[6]),
+            MEMBER(S, return_bitfields[7]), MEMBER(S, opt.side), MEMBER(S, opt.peg_difference),
+            MEMBER(S, opt.price), MEMBER(S, opt.exec_inst), MEMBER(S, opt.ord_type),
+            MEMBER(S, opt.time_in_force), MEMBER(S, opt.min_qty), MEMBER(S, opt.max_remove_pct),
+            MEMBER(S, opt.symbol), MEMBER(S, opt.capacity), MEMBER(S, opt.account),
+            MEMBER(S, opt.clearing_firm), MEMBER(S, opt.clearing_account), MEMBER(S, opt.display_indicator),
+            MEMBER(S, opt.max_floor), MEMBER(S, opt.discretion_amount), MEMBER(S, opt.order_qty),
+            MEMBER(S, opt.leaves_qty), MEMBER(S, opt.attributed_quote), MEMBER(S, opt.ext_exec_inst),
+            MEMBER(S, opt.routing_inst)
+        });
+    }
+    {
+        using S = BOE20Wire::Inbound<BOE::Messages::CancelRejected>;
+        expect_layout<BOE::Codec::CancelRejected>("BOE CancelRejected", sizeof(S), {
+            MEMBER(S, msg.message_header.start_of_message), MEMBER(S, msg.message_header.message_length),
+            MEMBER(S, msg.message_header.message_type), MEMBER(S, msg.message_header.matching_unit),
+            MEMBER(S, msg.message_header.sequence_number), MEMBER(S, msg.transaction_time),
+            MEMBER(S, msg.cl_ord_id), MEMBER(S, msg.cancel_reject_reason), MEMBER(S, msg.text),
+            MEMBER(S, msg.reserved), MEMBER(S, msg.number_of_return_bitfields),
+            MEMBER(S, return_bitfields[0]), MEMBER(S, return_bitfields[1]), MEMBER(S, return_bitfields[2]),
+            MEMBER(S, return_bitfields[3]), MEMBER(S, return_bitfields[4]), MEMBER(S, return_bitfields[5]),
+            MEMBER(S, return_bitfields[6]), MEMBER(S, return_bitfields[7]), MEMBER(S, opt.side),
+            MEMBER(S, opt.peg_difference), MEMBER(S, opt.price), MEMBER(S, opt.exec_inst),
+            MEMBER(S, opt.ord_type), MEMBER(S, opt.time_in_force), MEMBER(S, opt.min_qty),
+            MEMBER(S, opt.max_remove_pct), MEMBER(S, opt.symbol), MEMBER(S, opt.capacity)
+        });
+    }
+    {
+        using S = BOE20Wire::Inbound<BOE::Messages::OrderExecution>;
+        expect_layout<BOE::Codec::OrderExecution>("BOE OrderExecution", sizeof(S), {
+            MEMBER(S, msg.message_header.start_of_message), MEMBER(S, msg.message_header.message_length),
+            MEMBER(S, msg.message_header.message_type), MEMBER(S, msg.message_header.matching_unit),
+            MEMBER(S, msg.message_header.sequence_number), MEMBER(S, msg.transaction_time),
+            MEMBER(S, msg.cl_ord_id), MEMBER(S, msg.exec_id), MEMBER(S, msg.last_shares),
+            MEMBER(S, msg.last_px), MEMBER(S, msg.leaves_qty), MEMBER(S, msg.base_liquidity_indicator),
+            MEMBER(S, msg.sub_liquidity_indicator), MEMBER(S, msg.contra_broker), MEMBER(S, msg.reserved),
+            MEMBER(S, msg.number_of_return_bitfields), MEMBER(S, return_bitfields[0]),
+            MEMBER(S, return_bitfields[1]), MEMBER(S, return_bitfields[2]), MEMBER(S, return_bitfields[3]),
+            MEMBER(S, return_bitfields[4]), MEMBER(S, return_bitfields[5]), MEMBER(S, return_bitfields[6]),
+            MEMBER(S, return_bitfields[7]), MEMBER(S, opt.side), MEMBER(S, opt.peg_difference),
+            MEMBER(S, opt.price), MEMBER(S, opt.exec_inst), MEMBER(S, opt.ord_type),
+            MEMBER(S, opt.time_in_force), MEMBER(S, opt.min_qty), MEMBER(S, opt.max_remove_pct),
+            MEMBER(S, opt.symbol), MEMBER(S, opt.capacity), MEMBER(S, opt.account),
+            MEMBER(S, opt.clearing_firm), MEMBER(S, opt.clearing_account), MEMBER(S, opt.display_indicator),
+            MEMBER(S, opt.max_floor), MEMBER(S, opt.discretion_amount), MEMBER(S, opt.order_qty),
+            MEMBER(S, opt.attributed_quote), MEMBER(S, opt.ext_exec_inst), MEMBER(S, opt.fee_code),
+            MEMBER(S, opt.routing_inst)
+        });
+    }
+    {
+        using S = BOE20Wire::Inbound<BOE::Messages::TradeCancelOrCorrect>;
+        expect_layout<BOE::Codec::TradeCancelOrCorrect>("BOE TradeCancelOrCorrect", sizeof(S), {
+            MEMBER(S, msg.message_header.start_of_message), MEMBER(S, msg.message_header.message_length),
+            MEMBER(S, msg.message_header.message_type), MEMBER(S, msg.message_header.matching_unit),
+            MEMBER(S, msg.message_header.sequence_number), MEMBER(S, msg.transaction_time),
+            MEMBER(S, msg.cl_ord_id), MEMBER(S, msg.order_id), MEMBER(S, msg.exec_ref_id),
+            MEMBER(S, msg.side), MEMBER(S, msg.base_liquidity_indicator), MEMBER(S, msg.clearing_firm),
+            MEMBER(S, msg.clearing_account), MEMBER(S, msg.last_shares), MEMBER(S, msg.last_px),
+            MEMBER(S, msg.corrected_price), MEMBER(S, msg.orig_time), MEMBER(S, msg.reserved),
+            MEMBER(S, msg.number_of_return_bitfields), MEMBER(S, return_bitfields[0]),
+            MEMBER(S, return_bitfields[1]), MEMBER(S, return_bitfields[2]), MEMBER(S, return_bitfields[3]),
+            MEMBER(S, return_bitfields[4]), MEMBER(S, return_bitfields[5]), MEMBER(S, return_bitfields[6]),
+            MEMBER(S, return_bitfields[7]), MEMBER(S, opt.symbol), MEMBER(S, opt.capacity)
+        });
+    }
+}
+
+TEST(oe_wire_codec, oe_wire_codec_layout_arca)
+{
+    using namespace OE_WIRE_CODEC_TEST;
+
+    {
+        using S = AD41::Messages::LogonRequestVariant1;
+        expect_layout<AD41::Codec::LogonRequestVariant1>("AD41 LogonRequestVariant1", sizeof(S), {
+            MEMBER(S, message_type), MEMBER(S, variant), MEMBER(S, length), MEMBER(S, seqnum),
+            MEMBER(S, last_seqnum), MEMBER(S, username), MEMBER(S, symbology),
+            MEMBER(S, message_version_profile), MEMBER(S, cancel_on_disconnect),
+            MEMBER(S, message_terminator)
+        });
+    }
+    {
+        using S = AD41::Messages::LogonRequestVariant2Full;
+        expect_layout<AD41::Codec::LogonRequestVariant2Full>("AD41 LogonRequestVariant2Full", sizeof(S), {
+            MEMBER(S, message_type), MEMBER(S, variant), MEMBER(S, length), MEMBER(S, seqnum),
+            MEMBER(S, last_seqnum), MEMBER(S, session_profile_bitmap), MEMBER(S, username),
+            MEMBER(S, message_version_profile), MEMBER(S, cancel_on_disconnect),
+            MEMBER(S, default_extended_exec_inst), MEMBER(S, default_proactive_if_locked),
+            MEMBER(S, message_terminator)
+        });
+    }
+    {
+        using S = AD41::Messages::LogonReject;
+        expect_layout<AD41::Codec::LogonReject>("AD41 LogonReject", sizeof(S), {
+            MEMBER(S, message_type), MEMBER(S, variant), MEMBER(S, length), MEMBER(S, seqnum),
+            MEMBER(S, last_seqnum_server_received), MEMBER(S, last_seqnum_server_sent),
+            MEMBER(S, reject_type), MEMBER(S, text), MEMBER(S, filler), MEMBER(S, message_terminator)
+        });
+    }
+    {
+        using S = AD41::Messages::TestRequest;
+        expect_layout<AD41::Codec::TestRequest>("AD41 TestRequest", sizeof(S), {
+            MEMBER(S, message_type), MEMBER(S, variant), MEMBER(S, length), MEMBER(S, seqnum),
+            MEMBER(S, filler), MEMBER(S, message_terminator)
+        });
+    }
+    {
+        using S = AD41::Messages::Heartbeat;
+        expect_layout<AD41::Codec::Heartbeat>("AD41 Heartbeat", sizeof(S), {
+            MEMBER(S, message_type), MEMBER(S, variant), MEMBER(S, length), MEMBER(S, seqnum),
+            MEMBER(S, filler), MEMBER(S, message_terminator)
+        });
+    }
+    {
+        using S = AD41::Messages::NewOrderMessageVariant1;
+        expect_layout<AD41::Codec::NewOrderVariant1>("AD41 NewOrderVariant1", sizeof(S), {
+            MEMBER(S, message_type), MEMBER(S, variant), MEMBER(S, length), MEMBER(S, seqnum),
+            MEMBER(S, client_order_id), MEMBER(S, pcs_link_id), MEMBER(S, order_quantity),
+            MEMBER(S, order_price), MEMBER(S, ex_destination), MEMBER(S, price_scale), MEMBER(S, symbol),
+            MEMBER(S, company_group_id), MEMBER(S, deliver_to_comp_id), MEMBER(S, sender_sub_id),
+            MEMBER(S, exec_inst), MEMBER(S, side), MEMBER(S, order_type), MEMBER(S, time_in_force),
+            MEMBER(S, rule_80a), MEMBER(S, trading_session_id), MEMBER(S, account), MEMBER(S, iso),
+            MEMBER(S, extended_exec_inst), MEMBER(S, extended_pnp), MEMBER(S, no_self_trade),
+            MEMBER(S, proactive_if_locked), MEMBER(S, filler), MEMBER(S, message_terminator)
+        });
+    }
+    {
+        using S = AD41::Messages::Cancel;
+        expect_layout<AD41::Codec::Cancel>("AD41 Cancel", sizeof(S), {
+            MEMBER(S, message_type), MEMBER(S, variant), MEMBER(S, length), MEMBER(S, seqnum),
+            MEMBER(S, order_id), MEMBER(S, original_client_order_id), MEMBER(S, strike_price),
+            MEMBER(S, under_qty), MEMBER(S, ex_destination), MEMBER(S, corporate_action),
+            MEMBER(S, put_or_call), MEMBER(S, bulk_cancel), MEMBER(S, open_or_close), MEMBER(S, symbol),
+            MEMBER(S, strike_date), MEMBER(S, side), MEMBER(S, deliver_to_comp_id), MEMBER(S, account),
+            MEMBER(S, filler), MEMBER(S, message_terminator)
+        });
+    }
+    {
+        using S = AD41::Messages::CancelReplaceVariant1;
+        expect_layout<AD41::Codec::CancelReplaceVariant1>("AD41 CancelReplaceVariant1", sizeof(S), {
+            MEMBER(S, message_type), MEMBER(S, variant), MEMBER(S, length), MEMBER(S, seqnum),
+            MEMBER(S, order_id), MEMBER(S, new_client_order_id), MEMBER(S, original_client_order_id),
+            MEMBER(S, order_qty), MEMBER(S, strike_price), MEMBER(S, price), MEMBER(S, ex_destination),
+            MEMBER(S, under_qty), MEMBER(S, price_scale), MEMBER(S, put_or_call), MEMBER(S, corporate_action),
+            MEMBER(S, open_or_close), MEMBER(S, symbol), MEMBER(S, strike_date), MEMBER(S, exec_inst),
+            MEMBER(S, side), MEMBER(S, order_type), MEMBER(S, time_in_force), MEMBER(S, rule_80a),
+            MEMBER(S, trading_session_id), MEMBER(S, deliver_to_comp_id), MEMBER(S, account),
+            MEMBER(S, filler), MEMBER(S, message_terminator)
+        });
+    }
+    {
+        using S = AD41::Messages::CancelReplaceVariant4;
+        expect_layout<AD41::Codec::CancelReplaceVariant4>("AD41 CancelReplaceVariant4", sizeof(S), {
+            MEMBER(S, message_type), MEMBER(S, variant), MEMBER(S, length), MEMBER(S, seqnum),
+            MEMBER(S, order_id), MEMBER(S, original_client_order_id), MEMBER(S, order_qty), MEMBER(S, price),
+            MEMBER(S, ex_destination), MEMBER(S, price_scale), MEMBER(S, symbol), MEMBER(S, side),
+            MEMBER(S, suppress_ack), MEMBER(S, deliver_to_comp_id), MEMBER(S, account), MEMBER(S, filler),
+            MEMBER(S, message_terminator)
+        });
+    }
+    {
+        using S = AD41::Messages::CancelRequestAck;
+        expect_layout<AD41::Codec::CancelRequestAck>("AD41 CancelRequestAck", sizeof(S), {
+            MEMBER(S, message_type), MEMBER(S, variant), MEMBER(S, length), MEMBER(S, seqnum),
+            MEMBER(S, sending_time), MEMBER(S, transaction_time), MEMBER(S, client_order_id),
+            MEMBER(S, order_id), MEMBER(S, filler), MEMBER(S, message_terminator)
+        });
+    }
+    {
+        using S = AD41::Messages::Killed;
+        expect_layout<AD41::Codec::Killed>("AD41 Killed", sizeof(S), {
+            MEMBER(S, message_type), MEMBER(S, variant), MEMBER(S, length), MEMBER(S, seqnum),
+            MEMBER(S, sending_time), MEMBER(S, transaction_time), MEMBER(S, client_order_id),
+            MEMBER(S, order_id), MEMBER(S, information_text), MEMBER(S, filler),
+            MEMBER(S, message_terminator)
+        });
+    }
+    {
+        using S = AD41::Messages::KilledSTP;
+        expect_layout<AD41::Codec::KilledSTP>("AD41 KilledSTP", sizeof(S), {
+            MEMBER(S, message_type), MEMBER(S, variant), MEMBER(S, length), MEMBER(S, seqnum),
+            MEMBER(S, sending_time), MEMBER(S, transaction_time), MEMBER(S, client_order_id),
+            MEMBER(S, order_id), MEMBER(S, last_shares), MEMBER(S, information_text), MEMBER(S, text),
+            MEMBER(S, liquidity_indicator), MEMBER(S, filler), MEMBER(S, message_terminator)
+        });
+    }
+    {
+        using S = AD41::Messages::CancelReplaceAck;
+        expect_layout<AD41::Codec::CancelReplaceAck>("AD41 CancelReplaceAck", sizeof(S), {
+            MEMBER(S, message_type), MEMBER(S, variant), MEMBER(S, length), MEMBER(S, seqnum),
+            MEMBER(S, sending_time), MEMBER(S, transaction_time), MEMBER(S, original_client_order_id),
+            MEMBER(S, order_id), MEMBER(S, filler), MEMBER(S, message_terminator)
+        });
+    }
+    {
+        using S = AD41::Messages::Replaced;
+        expect_layout<AD41::Codec::Replaced>("AD41 Replaced", sizeof(S), {
+            MEMBER(S, message_type), MEMBER(S, variant), MEMBER(S, length), MEMBER(S, seqnum),
+            MEMBER(S, sending_time), MEMBER(S, transaction_time), MEMBER(S, new_client_order_id),
+            MEMBER(S, order_id), MEMBER(S, filler), MEMBER(S, message_terminator)
+        });
+    }
+    {
+        using S = AD41::Messages::CancelReplaceReject;
+        expect_layout<AD41::Codec::CancelReplaceReject>("AD41 CancelReplaceReject", sizeof(S), {
+            MEMBER(S, message_type), MEMBER(S, variant), MEMBER(S, length), MEMBER(S, seqnum),
+            MEMBER(S, sending_time), MEMBER(S, transaction_time), MEMBER(S, client_order_id),
+            MEMBER(S, original_client_order_id), MEMBER(S, rejected_message_type), MEMBER(S, text),
+            MEMBER(S, reject_reason), MEMBER(S, filler), MEMBER(S, message_terminator)
+        });
+    }
+    {
+        using S = AD41::Messages::BustedOrCorrected;
+        expect_layout<AD41::Codec::BustedOrCorrected>("AD41 BustedOrCorrected", sizeof(S), {
+            MEMBER(S, message_type), MEMBER(S, variant), MEMBER(S, length), MEMBER(S, seqnum),
+            MEMBER(S, sending_time), MEMBER(S, transaction_time), MEMBER(S, client_order_id),
+            MEMBER(S, execution_id), MEMBER(S, order_quantity), MEMBER(S, price), MEMBER(S, price_scale),
+            MEMBER(S, type), MEMBER(S, filler), MEMBER(S, message_terminator)
+        });
+    }
+    {
+        using S = AD41::Messages::Ack;
+        expect_layout<AD41::Codec::Ack>("AD41 Ack", sizeof(S), {
+            MEMBER(S, message_type), MEMBER(S, variant), MEMBER(S, length), MEMBER(S, seqnum),
+            MEMBER(S, sending_time), MEMBER(S, transaction_time), MEMBER(S, original_client_order_id),
+            MEMBER(S, order_id), MEMBER(S, price), MEMBER(S, price_scale), MEMBER(S, liquidity_indicator),
+            MEMBER(S, filler), MEMBER(S, message_terminator)
+        });
+    }
+    {
+        using S = AD41::Messages::FillVariant1;
+        expect_layout<AD41::Codec::FillVariant1>("AD41 FillVariant1", sizeof(S), {
+            MEMBER(S, message_type), MEMBER(S, variant), MEMBER(S, length), MEMBER(S, seqnum),
+            MEMBER(S, sending_time), MEMBER(S, transaction_time), MEMBER(S, client_order_id),
+            MEMBER(S, order_id), MEMBER(S, execution_id), MEMBER(S, arca_ex_id), MEMBER(S, last_shares),
+            MEMBER(S, last_price), MEMBER(S, price_scale), MEMBER(S, liquidity_indicator), MEMBER(S, side),
+            MEMBER(S, last_mkt), MEMBER(S, filler), MEMBER(S, message_terminator)
+        });
+    }
+    {
+        using S = AD41::Messages::FillVariant2;
+        expect_layout<AD41::Codec::FillVariant2>("AD41 FillVariant2", sizeof(S), {
+            MEMBER(S, message_type), MEMBER(S, variant), MEMBER(S, length), MEMBER(S, seqnum),
+            MEMBER(S, sending_time), MEMBER(S, transaction_time), MEMBER(S, client_order_id),
+            MEMBER(S, order_id), MEMBER(S, execution_id), MEMBER(S, execution_ref_id), MEMBER(S, arca_ex_id),
+            MEMBER(S, order_quantity), MEMBER(S, price), MEMBER(S, leaves), MEMBER(S, cum_qty),
+            MEMBER(S, avg_px), MEMBER(S, stop_price), MEMBER(S, discretion_offset), MEMBER(S, peg_difference),
+            MEMBER(S, last_shares), MEMBER(S, last_price), MEMBER(S, strike_price), MEMBER(S, put_or_call),
+            MEMBER(S, open_or_close), MEMBER(S, symbol), MEMBER(S, strike_date), MEMBER(S, exec_trans_type),
+            MEMBER(S, order_reject_reason), MEMBER(S, order_status), MEMBER(S, execution_type),
+            MEMBER(S, side), MEMBER(S, order_type), MEMBER(S, time_in_force), MEMBER(S, account),
+            MEMBER(S, text), MEMBER(S, discretion_instruction), MEMBER(S, liquidity_indicator),
+            MEMBER(S, exec_broker), MEMBER(S, last_mkt), MEMBER(S, filler), MEMBER(S, message_terminator)
+        });
+    }
+    {
+        using S = AD41::Messages::FillVariant3;
+        expect_layout<AD41::Codec::FillVariant3>("AD41 FillVariant3", sizeof(S), {
+            MEMBER(S, message_type), MEMBER(S, variant), MEMBER(S, length), MEMBER(S, seqnum),
+            MEMBER(S, sending_time), MEMBER(S, transaction_time), MEMBER(S, client_order_id),
+            MEMBER(S, order_id), MEMBER(S, execution_id), MEMBER(S, execution_ref_id), MEMBER(S, arca_ex_id),
+            MEMBER(S, leg_ref_id), MEMBER(S, last_shares), MEMBER(S, last_price), MEMBER(S, exec_trans_type),
+            MEMBER(S, order_reject_reason), MEMBER(S, execution_type), MEMBER(S, side), MEMBER(S, text),
+            MEMBER(S, liquidity_indicator), MEMBER(S, filler), MEMBER(S, message_terminator)
+        });
+    }
+}
+
+TEST(oe_wire_codec, oe_wire_codec_layout_edge)
+{
+    using namespace OE_WIRE_CODEC_TEST;
+
+    {
+        using S = XPRS::Messages::MEPLoginRequest;
+        expect_layout<XPRS::Codec::MEPLoginRequest>("XPRS MEPLoginRequest", sizeof(S), {
+            MEMBER(S, package_length), MEMBER(S, package_type), MEMBER(S, username), MEMBER(S, password),
+            MEMBER(S, requested_session), MEMBER(S, requested_sequence_number)
+        });
+    }
+    {
+        using S = XPRS::Messages::MEPLoginAccepted;
+        expect_layout<XPRS::Codec::MEPLoginAccepted>("XPRS MEPLoginAccepted", sizeof(S), {
+            MEMBER(S, package_length), MEMBER(S, package_type), MEMBER(S, session),
+            MEMBER(S, sequence_number)
+        });
+    }
+    {
+        using S = XPRS::Messages::MEPLoginRejected;
+        expect_layout<XPRS::Codec::MEPLoginRejected>("XPRS MEPLoginRejected", sizeof(S), {
+            MEMBER(S, package_length), MEMBER(S, package_type), MEMBER(S, reject_reason_code)
+        });
+    }
+    {
+        using S = XPRS::Messages::MEPSequencedData;
+        expect_layout<XPRS::Codec::MEPSequencedData>("XPRS MEPSequencedData", sizeof(S), {
+            MEMBER(S, package_length), MEMBER(S, package_type)
+        });
+    }
+    {
+        using S = XPRS::Messages::MEPUnsequencedData;
+        expect_layout<XPRS::Codec::MEPUnsequencedData>("XPRS MEPUnsequencedData", sizeof(S), {
+            MEMBER(S, package_length), MEMBER(S, package_type)
+        });
+    }
+    {
+        using S = XPRS::Messages::MEPServerHeartbeat;
+        expect_layout<XPRS::Codec::MEPServerHeartbeat>("XPRS MEPServerHeartbeat", sizeof(S), {
+            MEMBER(S, package_length), MEMBER(S, package_type)
+        });
+    }
+    {
+        using S = XPRS::Messages::MEPClientHeartbeat;
+        expect_layout<XPRS::Codec::MEPClientHeartbeat>("XPRS MEPClientHeartbeat", sizeof(S), {
+            MEMBER(S, package_length), MEMBER(S, package_type)
+        });
+    }
+    {
+        using S = XPRS::Messages::MEPLogoutRequest;
+        expect_layout<XPRS::Codec::MEPLogoutRequest>("XPRS MEPLogoutRequest", sizeof(S), {
+            MEMBER(S, package_length), MEMBER(S, package_type)
+        });
+    }
+    {
+        using S = XPRS::Messages::MEPDebug;
+        expect_layout<XPRS::Codec::MEPDebug>("XPRS MEPDebug", sizeof(S), {
+            MEMBER(S, package_length), MEMBER(S, package_type)
+        });
+    }
+    {
+        using S = XPRS::Messages::MEPEndOfSession;
+        expect_layout<XPRS::Codec::MEPEndOfSession>("XPRS MEPEndOfSession", sizeof(S), {
+            MEMBER(S, package_length), MEMBER(S, package_type)
+        });
+    }
+    {
+        using S = XPRS::Messages::EnterOrderShortFormat;
+        expect_layout<XPRS::Codec::EnterOrderShortFormat>("XPRS EnterOrderShortFormat", sizeof(S), {
+            MEMBER(S, message_type), MEMBER(S, order_token), MEMBER(S, buy_sell_indicator),
+            MEMBER(S, quantity), MEMBER(S, symbol), MEMBER(S, price), MEMBER(S, time_in_force),
+            MEMBER(S, display), MEMBER(S, special_order_type), MEMBER(S, extended_hours_eligible),
+            MEMBER(S, capacity), MEMBER(S, route_out_eligibility), MEMBER(S, iso_eligibility)
+        });
+    }
+    {
+        using S = XPRS::Messages::EnterOrderExtendedFormat;
+        expect_layout<XPRS::Codec::EnterOrderExtendedFormat>("XPRS EnterOrderExtendedFormat", sizeof(S), {
+            MEMBER(S, message_type), MEMBER(S, order_token), MEMBER(S, buy_sell_indicator),
+            MEMBER(S, quantity), MEMBER(S, symbol), MEMBER(S, price), MEMBER(S, time_in_force),
+            MEMBER(S, display), MEMBER(S, special_order_type), MEMBER(S, extended_hours_eligible),
+            MEMBER(S, capacity), MEMBER(S, route_out_eligibility), MEMBER(S, iso_eligibility),
+            MEMBER(S, routing_delivery_method), MEMBER(S, route_strategy), MEMBER(S, minimum_quantity),
+            MEMBER(S, max_floor), MEMBER(S, peg_difference), MEMBER(S, discretionary_offset),
+            MEMBER(S, expire_time), MEMBER(S, symbol_suffix)
+        });
+    }
+    {
+        using S = XPRS::Messages::AcceptedMessageShortFormat;
+        expect_layout<XPRS::Codec::AcceptedMessageShortFormat>("XPRS AcceptedMessageShortFormat", sizeof(S), {
+            MEMBER(S, message_type), MEMBER(S, timestamp), MEMBER(S, order_token),
+            MEMBER(S, buy_sell_indicator), MEMBER(S, quantity), MEMBER(S, symbol), MEMBER(S, price),
+            MEMBER(S, time_in_force), MEMBER(S, display), MEMBER(S, special_order_type),
+            MEMBER(S, extended_hours_eligible), MEMBER(S, order_reference_number), MEMBER(S, capacity),
+            MEMBER(S, route_out_eligibility), MEMBER(S, iso_eligibility)
+        });
+    }
+    {
+        using S = XPRS::Messages::AcceptedMessageExtendedFormat;
+        expect_layout<XPRS::Codec::AcceptedMessageExtendedFormat>("XPRS AcceptedMessageExtendedFormat", sizeof(S), {
+            MEMBER(S, message_type), MEMBER(S, timestamp), MEMBER(S, order_token),
+            MEMBER(S, buy_sell_indicator), MEMBER(S, quantity), MEMBER(S, symbol), MEMBER(S, price),
+            MEMBER(S, time_in_force), MEMBER(S, display), MEMBER(S, special_order_type),
+            MEMBER(S, extended_hours_eligible), MEMBER(S, order_reference_number), MEMBER(S, capacity),
+            MEMBER(S, route_out_eligibility), MEMBER(S, iso_eligibility), MEMBER(S, routing_delivery_method),
+            MEMBER(S, route_strategy), MEMBER(S, minimum_quantity), MEMBER(S, max_floor),
+            MEMBER(S, peg_difference), MEMBER(S, discretionary_offset), MEMBER(S, expire_time),
+            MEMBER(S, symbol_suffix)
+        });
+    }
+    {
+        using S = XPRS::Messages::ExecutedOrder;
+        expect_layout<XPRS::Codec::ExecutedOrder>("XPRS ExecutedOrder", sizeof(S), {
+            MEMBER(S, message_type), MEMBER(S, timestamp), MEMBER(S, order_token),
+            MEMBER(S, executed_quantity), MEMBER(S, execution_price), MEMBER(S, liquidity_flag),
+            MEMBER(S, match_number)
+        });
+    }
+    {
+        using S = XPRS::Messages::RejectedMessage;
+        expect_layout<XPRS::Codec::RejectedMessage>("XPRS RejectedMessage", sizeof(S), {
+            MEMBER(S, message_type), MEMBER(S, timestamp), MEMBER(S, order_token), MEMBER(S, reject_reason)
+        });
+    }
+    {
+        using S = XPRS::Messages::ExtendedRejectedMessage;
+        expect_layout<XPRS::Codec::ExtendedRejectedMessage>("XPRS ExtendedRejectedMessage", sizeof(S), {
+            MEMBER(S, message_type), MEMBER(S, timestamp), MEMBER(S, order_token), MEMBER(S, reject_reason),
+            MEMBER(S, in_response_to)
+        });
+    }
+    {
+        using S = XPRS::Messages::Cancel;
+        expect_layout<XPRS::Codec::Cancel>("XPRS Cancel", sizeof(S), {
+            MEMBER(S, message_type), MEMBER(S, order_token), MEMBER(S, quantity)
+        });
+    }
+    {
+        using S = XPRS::Messages::CanceledMessage;
+        expect_layout<XPRS::Codec::CanceledMessage>("XPRS CanceledMessage", sizeof(S), {
+            MEMBER(S, message_type), MEMBER(S, timestamp), MEMBER(S, order_token),
+            MEMBER(S, decremented_quantity), MEMBER(S, canceled_reason)
+        });
+    }
+    {
+        using S = XPRS::Messages::CancelPending;
+        expect_layout<XPRS::Codec::CancelPending>("XPRS CancelPending", sizeof(S), {
+            MEMBER(S, message_type), MEMBER(S, timestamp), MEMBER(S, order_token)
+        });
+    }
+    {
+        using S = XPRS::Messages::Replace;
+        expect_layout<XPRS::Codec::Replace>("XPRS Replace", sizeof(S), {
+            MEMBER(S, message_type), MEMBER(S, existing_order_token), MEMBER(S, replacement_order_token),
+            MEMBER(S, quantity), MEMBER(S, price)
+        });
+    }
+    {
+        using S = XPRS::Messages::ReplacedMessage;
+        expect_layout<XPRS::Codec::ReplacedMessage>("XPRS ReplacedMessage", sizeof(S), {
+            MEMBER(S, message_type), MEMBER(S, timestamp), MEMBER(S, replacement_order_token),
+            MEMBER(S, buy_sell_indicator), MEMBER(S, quantity), MEMBER(S, symbol), MEMBER(S, price),
+            MEMBER(S, order_reference_number), MEMBER(S, capacity), MEMBER(S, previous_order_token)
+        });
+    }
+    {
+        using S = XPRS::Messages::PendingReplace;
+        expect_layout<XPRS::Codec::PendingReplace>("XPRS PendingReplace", sizeof(S), {
+            MEMBER(S, message_type), MEMBER(S, timestamp), MEMBER(S, order_token)
+        });
+    }
+    {
+        using S = XPRS::Messages::SystemEvent;
+        expect_layout<XPRS::Codec::SystemEvent>("XPRS SystemEvent", sizeof(S), {
+            MEMBER(S, message_type), MEMBER(S, timestamp), MEMBER(S, event_code)
+        });
+    }
+    {
+        using S = XPRS::Messages::BrokenTrade;
+        expect_layout<XPRS::Codec::BrokenTrade>("XPRS BrokenTrade", sizeof(S), {
+            MEMBER(S, message_type), MEMBER(S, timestamp), MEMBER(S, order_token), MEMBER(S, match_number),
+            MEMBER(S, broken_trade_reason)
+        });
+    }
+    {
+        using S = XPRS::Messages::PriceCorrection;
+        expect_layout<XPRS::Codec::PriceCorrection>("XPRS PriceCorrection", sizeof(S), {
+            MEMBER(S, message_type), MEMBER(S, timestamp), MEMBER(S, order_token), MEMBER(S, match_number),
+            MEMBER(S, new_execution_price), MEMBER(S, price_correction_reason)
+        });
+    }
+    {
+        using S = XPRS::Messages::AntiInternalizationModifier;
+        expect_layout<XPRS::Codec::AntiInternalizationModifier>("XPRS AntiInternalizationModifier", sizeof(S), {
+            MEMBER(S, message_type), MEMBER(S, ai_method), MEMBER(S, ai_identifier), MEMBER(S, ai_group_id)
+        });
+    }
+    {
+        using S = XPRS::Messages::AIAdditionalInfoMessage;
+        expect_layout<XPRS::Codec::AIAdditionalInfoMessage>("XPRS AIAdditionalInfoMessage", sizeof(S), {
+            MEMBER(S, message_type), MEMBER(S, timestamp), MEMBER(S, order_token), MEMBER(S, quantity),
+            MEMBER(S, price), MEMBER(S, canceled_order_state), MEMBER(S, contra_member_id),
+            MEMBER(S, contra_token_or_cl_order_id), MEMBER(S, ai_method), MEMBER(S, ai_identifier),
+            MEMBER(S, ai_group_id)
+        });
+    }
+}
+
+TEST(oe_wire_codec, oe_wire_codec_layout_nyse)
+{
+    using namespace OE_WIRE_CODEC_TEST;
+
+    {
+        using S = UTP::Messages::Logon;
+        expect_layout<UTP::Codec::Logon>("UTP Logon", sizeof(S), {
+            MEMBER(S, message_type), MEMBER(S, msg_length), MEMBER(S, msg_seqnum), MEMBER(S, last_seqnum),
+            MEMBER(S, sender_comp_id), MEMBER(S, message_version_profile), MEMBER(S, cancel_on_disconnect),
+            MEMBER(S, filler)
+        });
+    }
+    {
+        using S = UTP::Messages::LogonReject;
+        expect_layout<UTP::Codec::LogonReject>("UTP LogonReject", sizeof(S), {
+            MEMBER(S, message_type), MEMBER(S, msg_length), MEMBER(S, msg_seqnum),
+            MEMBER(S, last_seqnum_client_to_gw), MEMBER(S, last_seqnum_gw_to_client),
+            MEMBER(S, logon_reject_type), MEMBER(S, text), MEMBER(S, filler)
+        });
+    }
+    {
+        using S = UTP::Messages::TestRequest;
+        expect_layout<UTP::Codec::TestRequest>("UTP TestRequest", sizeof(S), {
+            MEMBER(S, message_type), MEMBER(S, msg_length), MEMBER(S, msg_seqnum)
+        });
+    }
+    {
+        using S = UTP::Messages::HeartbeatMessage;
+        expect_layout<UTP::Codec::HeartbeatMessage>("UTP HeartbeatMessage", sizeof(S), {
+            MEMBER(S, message_type), MEMBER(S, msg_length), MEMBER(S, msg_seqnum)
+        });
+    }
+    {
+        using S = UTP::Messages::NewOrder1;
+        expect_layout<UTP::Codec::NewOrder1>("UTP NewOrder1", sizeof(S), {
+            MEMBER(S, message_type), MEMBER(S, msg_length), MEMBER(S, msg_seqnum), MEMBER(S, order_qty),
+            MEMBER(S, max_floor_qty), MEMBER(S, price), MEMBER(S, price_scale), MEMBER(S, symbol),
+            MEMBER(S, exec_inst), MEMBER(S, side), MEMBER(S, order_type), MEMBER(S, time_in_force),
+            MEMBER(S, capacity), MEMBER(S, routing_instruction), MEMBER(S, dot_reserve),
+            MEMBER(S, on_behalf_of_compid), MEMBER(S, sender_sub_id), MEMBER(S, clearing_firm),
+            MEMBER(S, account), MEMBER(S, client_order_id), MEMBER(S, filler)
+        });
+    }
+}
+
+TEST(oe_wire_codec, oe_wire_codec_ouch42_session)
+{
+    using namespace OE_WIRE_CODEC_TEST;
+    namespace F = O42::Codec::F;
+    namespace OT = O42::Types;
+    OUCHFixture fx;
+    fx.login();
+    auto& ex = fx.ex;
+    auto *inst = fx.om.universe()[1].data();
+    DayStrategy strategy(false);
+
+    // what the exchange sends about an order, in a SoupBinTCP data packet;
+    // the token is where it is in an Accepted in each of them:
+    auto response = [](const char *token, Bytes msg) {
+        Writer<O42::Codec::Accepted>(msg.data()).set<F::order_token>(token);
+        return sequenced(msg);
+    };
+    auto accepted = [&](const char *token, std::uint32_t shares, std::uint64_t refnum) {
+        return response(token, encode<O42::Codec::Accepted>([&](const Writer<O42::Codec::Accepted>& w) {
+            w.set<F::buy_sell_indicator>(OT::BuySellIndicator::BUY);
+            w.set<F::shares>(shares);
+            w.set<F::stock>(OUCH_STOCK);
+            w.set<F::price>(10.01);
+            w.set<F::time_in_force>(OT::TimeInForceSpecial::MARKET_HOURS);
+            w.set<F::firm>(OUCH_FIRM);
+            w.set<F::display>(OT::Display::ANONYMOUS_PRICE_TO_COMPLY);
+            w.set<F::order_reference_number>(refnum);
+            w.set<F::order_state>(OT::OrderState::LIVE);
+        }));
+    };
+    auto cancel_order = [](const char *token, std::uint32_t shares) {
+        return unsequenced(encode<O42::Codec::CancelOrder>([&](const Writer<O42::Codec::CancelOrder>& w) {
+            w.set<F::order_token>(token);
+            w.set<F::shares>(shares);
+        }));
+    };
+
+    // an order the exchange fills a third of, then cancels the rest of:
+    auto *op = fx.om.create_order<NASDAQOrder>(inst, 10.01, 300, Side::BUY, TimeInForce::DAY, OrderType::LIMIT, &strategy);
+    ASSERT_TRUE(fx.om.send(op, fx.session.get()));
+    EXPECT_EQ(1u, op->localID());
+    const auto enter = sbt_packet(ex);
+    EXPECT_EQ(unsequenced(encode<O42::Codec::EnterOrder>([](const Writer<O42::Codec::EnterOrder>& w) {
+        encode_enter_order(w, 300, 10.01);
+    })), enter);
+    ASSERT_EQ(SBT::Codec::UnsequencedDataPacket::SIZE + O42::Codec::EnterOrder::SIZE, enter.size());
+    EXPECT_EQ("O,IAAPL000000001,B,300,AAPL    ,10.01,99998,FIRM,Y,A,N,0,N, ",
+              printed<O42::Codec::EnterOrder>(enter.data() + SBT::Codec::UnsequencedDataPacket::SIZE));
+
+    ex.write(accepted("IAAPL000000001", 300, 1234));
+    ASSERT_TRUE(eventually([&] { return OrderState::ACKNOWLEDGED == op->state(); }));
+    EXPECT_EQ(1234u, op->exchangeID());
+    EXPECT_EQ(TimeInForce::DAY, op->tif());
+
+    ex.write(response("IAAPL000000001", encode<O42::Codec::Executed>([](const Writer<O42::Codec::Executed>& w) {
+        w.set<F::executed_shares>(100u);
+        w.set<F::execution_price>(10.01);
+        w.set<F::liquidity_flag>(OT::LiquidityFlag::ADDED);
+        w.set<F::match_number>(42u);
+    })));
+    ASSERT_TRUE(eventually([&] { return 100u == op->filled_size(); }));
+    EXPECT_EQ(OrderState::PARTIALLY_FILLED, op->state());
+    EXPECT_EQ(1u, strategy.fills);
+
+    ex.write(response("IAAPL000000001", encode<O42::Codec::OrderPriorityUpdate>([](const Writer<O42::Codec::OrderPriorityUpdate>& w) {
+        w.set<F::execution_price>(10.01);
+        w.set<F::display>(OT::Display::ANONYMOUS_PRICE_TO_COMPLY);
+        w.set<F::order_reference_number>(5678u);
+    })));
+    ASSERT_TRUE(eventually([&] { return 5678u == op->exchangeID(); }));
+
+    ASSERT_TRUE(fx.om.cancel(op));
+    EXPECT_EQ(cancel_order("IAAPL000000001", 0), sbt_packet(ex));
+    ex.write(response("IAAPL000000001", encode<O42::Codec::CancelReject>()));
+    ASSERT_TRUE(eventually([&] { return OrderState::CANCEL_REJECTED == op->state(); }));
+
+    ASSERT_TRUE(fx.om.cancel(op));
+    EXPECT_EQ(cancel_order("IAAPL000000001", 0), sbt_packet(ex));
+    ex.write(response("IAAPL000000001", encode<O42::Codec::CancelPending>()));
+    ASSERT_TRUE(eventually([&] { return OrderState::CANCEL_REJECTED == op->state(); }));
+
+    ASSERT_TRUE(fx.om.cancel(op));
+    EXPECT_EQ(cancel_order("IAAPL000000001", 0), sbt_packet(ex));
+    ex.write(response("IAAPL000000001", encode<O42::Codec::Canceled>([](const Writer<O42::Codec::Canceled>& w) {
+        w.set<F::decremented_shares>(200u);
+        w.set<F::reason>(OT::CanceledReason::USER_REQUESTED);
+    })));
+    ASSERT_TRUE(eventually([&] { return OrderState::CANCELLED == op->state(); }));
+    EXPECT_EQ(200u, op->cancelled_size());
+    EXPECT_EQ(1u, strategy.cancels);
+
+    // one the exchange rejects:
+    auto *rejected = fx.om.create_order<NASDAQOrder>(inst, 10.02, 100, Side::SELL, TimeInForce::DAY, OrderType::LIMIT, &strategy);
+    ASSERT_TRUE(fx.om.send(rejected, fx.session.get()));
+    EXPECT_EQ(unsequenced(encode<O42::Codec::EnterOrder>([](const Writer<O42::Codec::EnterOrder>& w) {
+        encode_enter_order(w, 100, 10.02);
+        w.set<F::order_token>("EAAPL000000002");
+        w.set<F::buy_sell_indicator>(OT::BuySellIndicator::SELL);
+    })), sbt_packet(ex));
+    ex.write(response("EAAPL000000002", encode<O42::Codec::Rejected>([](const Writer<O42::Codec::Rejected>& w) {
+        w.set<F::reason>(OT::RejectedReason::HALTED);
+    })));
+    ASSERT_TRUE(eventually([&] { return OrderState::REMOTELY_REJECTED == rejected->state(); }));
+
+    // and one the exchange reduces and then cancels, with the messages
+    // about no order in between:
+    auto *modified = fx.om.create_order<NASDAQOrder>(inst, 10.01, 200, Side::BUY, TimeInForce::DAY, OrderType::LIMIT, &strategy);
+    ASSERT_TRUE(fx.om.send(modified, fx.session.get()));
+    EXPECT_EQ(unsequenced(encode<O42::Codec::EnterOrder>([](const Writer<O42::Codec::EnterOrder>& w) {
+        encode_enter_order(w, 200, 10.01);
+        w.set<F::order_token>("IAAPL000000003");
+    })), sbt_packet(ex));
+    ex.write(accepted("IAAPL000000003", 200, 9012));
+    ex.write(sequenced(encode<O42::Codec::SystemEvent>([](const Writer<O42::Codec::SystemEvent>& w) {
+        w.set<F::system_event_code>(OT::SystemEventCode::START_OF_DAY);
+    })));
+    ex.write(response("IAAPL000000001", encode<O42::Codec::BrokenTrade>([](const Writer<O42::Codec::BrokenTrade>& w) {
+        w.set<F::match_number>(42u);
+        w.set<F::reason>(OT::BrokenTradeReason::ERRONEOUS);
+    })));
+    ex.write(cat(encode<SBT::Codec::DebugPacket>([](const Writer<SBT::Codec::DebugPacket>& w) {
+        w.set<SBT::Codec::F::packet_length>(static_cast<SBT::Types::PacketLength>(1 + 5));
+    }), Bytes{'d', 'e', 'b', 'u', 'g'}));
+    ex.write(encode<SBT::Codec::ServerHeartbeat>());
+    ex.write(response("IAAPL000000003", encode<O42::Codec::Modified>([](const Writer<O42::Codec::Modified>& w) {
+        w.set<F::buy_sell_indicator>(OT::BuySellIndicator::BUY);
+        w.set<F::shares>(100u);
+    })));
+    ASSERT_TRUE(eventually([&] { return 100u == modified->open_size(); }));
+    EXPECT_EQ(OrderState::ACKNOWLEDGED, modified->state());
+    EXPECT_EQ(9012u, modified->exchangeID());
+    EXPECT_TRUE(fx.session->active());
+    ex.write(response("IAAPL000000003", encode<O42::Codec::AIQCanceled>([](const Writer<O42::Codec::AIQCanceled>& w) {
+        w.set<F::decremented_shares>(100u);
+        w.set<F::reason>(OT::CanceledReason::SELF_MATCH_PREVENTION);
+        w.set<F::quantity_prevented_from_trading>(100u);
+        w.set<F::execution_price>(10.01);
+        w.set<F::liquidity_flag>(OT::LiquidityFlag::ADDED);
+    })));
+    ASSERT_TRUE(eventually([&] { return OrderState::CANCELLED == modified->state(); }));
+    EXPECT_EQ(1u, strategy.fills);
+
+    fx.session->disconnect();
+    EXPECT_EQ(encode<SBT::Codec::LogoutRequest>(), sbt_packet(ex));
+}
+
+TEST(oe_wire_codec, oe_wire_codec_boe20_session)
+{
+    using namespace OE_WIRE_CODEC_TEST;
+    namespace F = BOE::Codec::F;
+    namespace BT = BOE::Types;
+    Exchange ex;
+    BOEFixture fx(ex.port());
+    auto& s = *fx.session;
+    auto *inst = fx.om.universe()[1].data();
+    DayStrategy strategy(false);
+
+    ASSERT_TRUE(s.manual_connect());
+    ASSERT_TRUE(ex.accept());
+    const auto login = encode<BOE::Codec::LoginRequest>([](const Writer<BOE::Codec::LoginRequest>& w) {
+        w.set<F::message_length>(static_cast<BT::MessageLength>(BOE::Codec::LoginRequest::SIZE + 9 * BOE::Codec::ReturnBitfieldsParamGroup::SIZE - 2));
+        w.set<F::session_sub_id>("0001");
+        w.set<F::username>("TEST");
+        w.set<F::password>("TEST");
+        w.set<F::num_param_groups>(9);
+    });
+    const Bytes return_bitfields_groups[] = {
+        return_bitfields<BOE::Codec::OrderAcknowledgment>(), return_bitfields<BOE::Codec::OrderRejected>(),
+        return_bitfields<BOE::Codec::OrderModified>(), return_bitfields<BOE::Codec::OrderRestated>(),
+        return_bitfields<BOE::Codec::UserModifyRejected>(), return_bitfields<BOE::Codec::OrderCancelled>(),
+        return_bitfields<BOE::Codec::CancelRejected>(), return_bitfields<BOE::Codec::OrderExecution>(),
+        return_bitfields<BOE::Codec::TradeCancelOrCorrect>(),
+    };
+    Bytes expected_login = login;
+    for (const auto& g : return_bitfields_groups)
+        expected_login = cat(expected_login, g);
+    EXPECT_EQ(expected_login, boe_message(ex));
+
+    ex.write(cat(encode<BOE::Codec::LoginResponse>([](const Writer<BOE::Codec::LoginResponse>& w) {
+        w.set<F::message_length>(static_cast<BT::MessageLength>(BOE::Codec::LoginResponse::SIZE - 2));
+        w.set<F::login_response_status>(BT::LoginResponseStatus::LOGIN_ACCEPTED);
+        w.set<F::login_response_text>("Accepted");
+    }), encode<BOE::Codec::ReplayComplete>()));
+    ASSERT_TRUE(eventually([&] { return s.active(); }));
+
+    // what the exchange sends about an order, sequenced on matching unit 1;
+    // the header and ClOrdID are where they are in an ack in each of them:
+    BT::SequenceNumber inbound = 0;
+    auto response = [&](const BT::ClOrdID& id, Bytes msg) {
+        Writer<BOE::Codec::OrderAcknowledgment> w(msg.data());
+        w.set<F::matching_unit>(1);
+        w.set<F::sequence_number>(++inbound);
+        w.set<F::cl_ord_id>(id.arr);
+        return msg;
+    };
+    auto ack = [&](const BT::ClOrdID& id, BT::Quantity qty, BT::OrderID order_id) {
+        return response(id, encode<BOE::Codec::OrderAcknowledgment>([&](const Writer<BOE::Codec::OrderAcknowledgment>& w) {
+            w.set<F::order_id>(order_id);
+            w.set<F::side>(BT::Side::BUY);
+            w.set<F::price>(10.01);
+            w.set<F::ord_type>(BT::OrdType::LIMIT);
+            w.set<F::symbol>("AAPL");
+            w.set<F::clearing_firm>("CLRF");
+            w.set<F::order_qty>(qty);
+            w.set<F::leaves_qty>(qty);
+        }));
+    };
+    auto new_order = [&](BATSOrder& o, BT::Side side, BT::SequenceNumber seq) {
+        return encode<BOE::Codec::NewOrder>([&](const Writer<BOE::Codec::NewOrder>& w) {
+            init_new_order(w);
+            encode_new_order(w, boe_fields(s, o, side, BT::TimeInForce::DAY));
+            w.set<F::sequence_number>(seq);
+        });
+    };
+    auto modify_order = [&](BATSOrder& o, BT::OrderQty qty, BT::SequenceNumber seq) {
+        return encode<BOE::Codec::ModifyOrder>([&](const Writer<BOE::Codec::ModifyOrder>& w) {
+            w.set<F::sequence_number>(seq);
+            w.set<F::new_cl_ord_id>(s.cl_ord_id(&o).arr);
+            w.set<F::orig_cl_ord_id>(s.cl_ord_id(&o).arr);
+            w.set<F::clearing_firm>("CLRF");
+            w.set<F::order_qty>(qty);
+            w.set<F::price>(o.price());
+            w.set<F::ord_type>(BT::OrdType::LIMIT);
+            w.set<F::cancel_orig_on_reject>(static_cast<BT::CancelOrigOnReject>('N'));
+            w.set<F::exec_inst>(o.boe_exec_inst());
+            w.set<F::side>(BT::Side::BUY);
+        });
+    };
+    auto cancel_order = [&](BATSOrder& o, BT::SequenceNumber seq) {
+        return encode<BOE::Codec::CancelOrder>([&](const Writer<BOE::Codec::CancelOrder>& w) {
+            w.set<F::sequence_number>(seq);
+            w.set<F::orig_cl_ord_id>(s.cl_ord_id(&o).arr);
+            w.set<F::clearing_firm>("CLRF");
+        });
+    };
+
+    // an order reduced once it is allowed to be, filled in part, and
+    // cancelled once it is allowed to be:
+    auto *op = fx.om.create_order<BATSOrder>(inst, 10.01, 300, Side::BUY, TimeInForce::DAY, OrderType::LIMIT, &strategy);
+    ASSERT_TRUE(fx.om.send(op, &s));
+    EXPECT_EQ(new_order(*op, BT::Side::BUY, 1), boe_message(ex));
+    const auto id = s.cl_ord_id(op);
+    ex.write(ack(id, 300, 1001));
+    ASSERT_TRUE(eventually([&] { return OrderState::ACKNOWLEDGED == op->state(); }));
+    EXPECT_EQ(1001u, op->exchangeID());
+
+    ASSERT_TRUE(fx.om.cancel(op, 200));
+    EXPECT_EQ(modify_order(*op, 200, 2), boe_message(ex));
+    ex.write(response(id, encode<BOE::Codec::UserModifyRejected>([](const Writer<BOE::Codec::UserModifyRejected>& w) {
+        w.set<F::modify_reject_reason>(BT::ReasonCode::ADMIN);
+        w.set<F::text>("Too late");
+    })));
+    ASSERT_TRUE(eventually([&] { return OrderState::CANCEL_REJECTED == op->state(); }));
+
+    ASSERT_TRUE(fx.om.cancel(op, 200));
+    EXPECT_EQ(modify_order(*op, 200, 3), boe_message(ex));
+    ex.write(response(id, encode<BOE::Codec::OrderModified>([&](const Writer<BOE::Codec::OrderModified>& w) {
+        w.set<F::order_id>(1001u);
+        w.set<F::order_qty>(200u);
+        w.set<F::orig_cl_ord_id>(id.arr);
+        w.set<F::leaves_qty>(200u);
+    })));
+    ASSERT_TRUE(eventually([&] { return 100u == op->cancelled_size(); }));
+    EXPECT_EQ(OrderState::PARTIALLY_CANCELLED, op->state());
+
+    ex.write(response(id, encode<BOE::Codec::OrderExecution>([](const Writer<BOE::Codec::OrderExecution>& w) {
+        w.set<F::exec_id>(77u);
+        w.set<F::last_shares>(100u);
+        w.set<F::last_px>(10.01);
+        w.set<F::leaves_qty>(100u);
+        w.set<F::base_liquidity_indicator>(BT::BaseLiquidityIndicator::ADDED_LIQUIDITY);
+    })));
+    ASSERT_TRUE(eventually([&] { return 100u == op->filled_size(); }));
+    EXPECT_EQ(1u, strategy.fills);
+
+    ASSERT_TRUE(fx.om.cancel(op));
+    EXPECT_EQ(cancel_order(*op, 4), boe_message(ex));
+    ex.write(response(id, encode<BOE::Codec::CancelRejected>([](const Writer<BOE::Codec::CancelRejected>& w) {
+        w.set<F::cancel_reject_reason>(BT::ReasonCode::ADMIN);
+    })));
+    ASSERT_TRUE(eventually([&] { return OrderState::CANCEL_REJECTED == op->state(); }));
+
+    ASSERT_TRUE(fx.om.cancel(op));
+    EXPECT_EQ(cancel_order(*op, 5), boe_message(ex));
+    ex.write(response(id, encode<BOE::Codec::OrderCancelled>([](const Writer<BOE::Codec::OrderCancelled>& w) {
+        w.set<F::cancel_reason>(BT::ReasonCode::ADMIN);
+        w.set<F::leaves_qty>(0u);
+    })));
+    ASSERT_TRUE(eventually([&] { return OrderState::CANCELLED == op->state(); }));
+    EXPECT_EQ(200u, op->cancelled_size());
+
+    // one the exchange rejects:
+    auto *rejected = fx.om.create_order<BATSOrder>(inst, 10.02, 100, Side::SELL, TimeInForce::DAY, OrderType::LIMIT, &strategy);
+    ASSERT_TRUE(fx.om.send(rejected, &s));
+    EXPECT_EQ(new_order(*rejected, BT::Side::SELL, 6), boe_message(ex));
+    ex.write(response(s.cl_ord_id(rejected), encode<BOE::Codec::OrderRejected>([](const Writer<BOE::Codec::OrderRejected>& w) {
+        w.set<F::order_reject_reason>(BT::ReasonCode::ADMIN);
+    })));
+    ASSERT_TRUE(eventually([&] { return OrderState::REMOTELY_REJECTED == rejected->state(); }));
+
+    // and one the exchange restates to nothing, after a trade correction
+    // and a heartbeat:
+    auto *restated = fx.om.create_order<BATSOrder>(inst, 10.01, 100, Side::BUY, TimeInForce::DAY, OrderType::LIMIT, &strategy);
+    ASSERT_TRUE(fx.om.send(restated, &s));
+    EXPECT_EQ(new_order(*restated, BT::Side::BUY, 7), boe_message(ex));
+    const auto restated_id = s.cl_ord_id(restated);
+    ex.write(ack(restated_id, 100, 1002));
+    ex.write(response(id, encode<BOE::Codec::TradeCancelOrCorrect>([](const Writer<BOE::Codec::TradeCancelOrCorrect>& w) {
+        w.set<F::exec_ref_id>(77u);
+    })));
+    ex.write(encode<BOE::Codec::ServerHeartbeat>());
+    ex.write(response(restated_id, encode<BOE::Codec::OrderRestated>([](const Writer<BOE::Codec::OrderRestated>& w) {
+        w.set<F::restatement_reason>(BT::RestatementReason::RELOAD);
+        w.set<F::order_qty>(100u);
+        w.set<F::leaves_qty>(0u);
+    })));
+    ASSERT_TRUE(eventually([&] { return OrderState::CANCELLED == restated->state(); }));
+    EXPECT_EQ(1u, strategy.fills);
+    EXPECT_TRUE(s.active());
+
+    fx.session.reset();
+    EXPECT_EQ(encode<BOE::Codec::LogoutRequest>(), boe_message(ex));
+}
+
+TEST(oe_wire_codec, oe_wire_codec_boe20)
+{
+    using namespace OE_WIRE_CODEC_TEST;
+    namespace F = BOE::Codec::F;
+    namespace BT = BOE::Types;
+    BOEFixture fx;
+    auto& s = *fx.session;
+    auto *inst = fx.om.universe()[1].data();
+
+    std::array<std::uint8_t, BOE::Codec::NewOrder::SIZE> buf;
+    Writer<BOE::Codec::NewOrder> w(buf.data());
+    init_new_order(w);
+
+    const Side sides[] = {Side::BUY, Side::SELL, Side::SHORT, Side::SHORT_EXEMPT};
+    const BT::Side boe_sides[] = {BT::Side::BUY, BT::Side::SELL, BT::Side::SELL_SHORT, BT::Side::SELL_SHORT_EXEMPT};
+    const TimeInForce tifs[] = {TimeInForce::DAY, TimeInForce::IMMEDIATE_OR_CANCEL};
+    const BT::TimeInForce boe_tifs[] = {BT::TimeInForce::DAY, BT::TimeInForce::IOC};
+    for (std::size_t i = 0; i < 4; ++i) {
+        for (std::size_t j = 0; j < 2; ++j) {
+            BATSOrder o(inst, 10.01 + i + 0.1 * j, 100 * (i + 1), sides[i], tifs[j], OrderType::LIMIT, nullptr);
+            if (j)
+                o.boe_display_indicator(BOE20Order::DisplayIndicator::HIDDEN);
+            const auto session_bytes = s.new_order(&o);
+            encode_new_order(w, boe_fields(s, o, boe_sides[i], boe_tifs[j]));
+            EXPECT_EQ(session_bytes, bytes_of(w)) << o;
+
+            Reader<BOE::Codec::NewOrder> r(buf.data());
+            EXPECT_EQ(boe_sides[i], r.get<F::side>());
+            EXPECT_EQ(o.size(), r.get<F::order_qty>());
+            EXPECT_DOUBLE_EQ(o.price(), r.get<F::price>());
+            EXPECT_EQ(o.boe_display_indicator(), r.get<F::display_indicator>());
+            EXPECT_EQ(0, std::memcmp(o.client_order_id().data(), r.at<F::cl_ord_id>(), 20));
+        }
+    }
+
+    BATSOrder o(inst, 10.0, 100, Side::BUY, TimeInForce::DAY, OrderType::LIMIT, nullptr);
+    std::array<std::uint8_t, BOE::Codec::CancelOrder::SIZE> cbuf;
+    Writer<BOE::Codec::CancelOrder> cw(cbuf.data());
+    cw.init();
+    cw.set<F::clearing_firm>(std::string("CLRF"));
+    cw.set<F::orig_cl_ord_id>(s.cl_ord_id(&o).arr);
+    EXPECT_EQ(s.cancel_order(&o), bytes_of(cw));
+
+    // the sequence number is the session's to patch; the length leaves out
+    // the start of message:
+    cw.set<F::sequence_number>(0x01020304u);
+    Reader<BOE::Codec::CancelOrder> cr(cbuf.data());
+    EXPECT_EQ(0x01020304u, cr.get<F::sequence_number>());
+    EXPECT_EQ(0x04, cbuf[6]);
+    EXPECT_EQ(BOE::Codec::CancelOrder::SIZE - 2, cr.get<F::message_length>());
+    EXPECT_EQ(0, printed<BOE::Codec::CancelOrder>(cbuf.data()).find("47802,34,57,0,16909060,B"));
+}
+
+TEST(oe_wire_codec, oe_wire_codec_arca_xprs_utp)
+{
+    using namespace OE_WIRE_CODEC_TEST;
+
+    {
+        namespace F = AD41::Codec::F;
+        namespace AT = AD41::Types;
+        AD41::Messages::NewOrderMessageVariant1 m;
+        std::memset(&m, 0, sizeof(m));
+        m.message_type = AT::MessageType::NEW_ORDER;
+        m.variant = 1;
+        m.length = htons(sizeof(m));
+        m.seqnum = htonl(77);
+        m.client_order_id = htonl(123456);
+        m.order_quantity = htonl(200);
+        m.order_price = htonl(1005);
+        m.ex_destination = static_cast<AT::ExDestination>(htons(static_cast<std::uint16_t>(AT::ExDestination::NYSE_ARCA_EQUITIES)));
+        m.price_scale = AT::PriceScale::TWO;
+        std::memcpy(m.symbol.raw, "IBM", 3);
+        std::memcpy(m.company_group_id, "ABCD", 4);
+        m.exec_inst = '1';
+        m.side = AT::Side::SELL;
+        m.order_type = '2';
+        m.time_in_force = AT::TimeInForce::IOC;
+        m.rule_80a = AT::Rule80A::AGENCY_SINGLE_ORDER;
+        std::memcpy(m.account, "ACCT", 4);
+        m.iso = AT::ISO::NO_ISO_FLAG;
+        m.message_terminator = AT::MessageTerminator::NEW_LINE;
+
+        std::array<std::uint8_t, AD41::Codec::NewOrderVariant1::SIZE> buf;
+        Writer<AD41::Codec::NewOrderVariant1> w(buf.data());
+        w.init();
+        w.set<F::seqnum>(77u);
+        w.set<F::client_order_id>(123456u);
+        w.set<F::order_quantity>(200u);
+        w.set<F::order_price>(1005u);
+        w.set<F::ex_destination>(AT::ExDestination::NYSE_ARCA_EQUITIES);
+        w.set<F::price_scale>(AT::PriceScale::TWO);
+        w.set<F::symbol>("IBM");
+        w.set<F::company_group_id>("ABCD");
+        w.set<F::exec_inst>('1');
+        w.set<F::side>(AT::Side::SELL);
+        w.set<F::order_type>('2');
+        w.set<F::time_in_force>(AT::TimeInForce::IOC);
+        w.set<F::rule_80a>(AT::Rule80A::AGENCY_SINGLE_ORDER);
+        w.set<F::account>("ACCT");
+        w.set<F::iso>(AT::ISO::NO_ISO_FLAG);
+        EXPECT_EQ(bytes_of(m), bytes_of(w));
+        EXPECT_EQ(AT::ExDestination::NYSE_ARCA_EQUITIES, Reader<AD41::Codec::NewOrderVariant1>(buf.data()).get<F::ex_destination>());
+
+        AD41::Messages::Ack ack;
+        std::memset(&ack, 0, sizeof(ack));
+        ack.message_type = AT::MessageType::ORDER_ACK;
+        ack.length = htons(sizeof(ack));
+        ack.original_client_order_id = htonl(123456);
+        ack.order_id = htobe64(987654321ULL);
+        ack.price = htonl(1005);
+        Reader<AD41::Codec::Ack> r(reinterpret_cast<const std::uint8_t *>(&ack));
+        EXPECT_EQ(123456u, r.get<F::original_client_order_id>());
+        EXPECT_EQ(987654321ULL, r.get<F::order_id>());
+        EXPECT_EQ(1005u, r.get<F::price>());
+    }
+    {
+        namespace F = XPRS::Codec::F;
+        namespace XT = XPRS::Types;
+        XPRS::Messages::EnterOrderShortFormat m;
+        m.message_type = XT::MessageType::ENTER_ORDER_SHORT_FORMAT;
+        std::memcpy(m.order_token, OUCH_TOKEN.data(), 14);
+        m.buy_sell_indicator = XT::BuySellIndicator::SELL_SHORT;
+        m.quantity = htonl(100);
+        std::memcpy(m.symbol, "MSFT  ", 6);
+        m.price = htonl(static_cast<XT::Price>(45.67 * 10000.0 + 0.5));
+        m.time_in_force = XT::TimeInForce::DAY;
+        m.display = XT::Display::DISPLAYED;
+        m.special_order_type = XT::SpecialOrderType::HIDE_NOT_SLIDE;
+        m.extended_hours_eligible = XT::ExtendedHoursEligible::REGULAR_SESSION_ONLY;
+        m.capacity = XT::Capacity::AGENCY;
+        m.route_out_eligibility = XT::RouteOutEligibility::BOOK_ONLY;
+        m.iso_eligibility = XT::ISOEligibility::NO;
+
+        std::array<std::uint8_t, XPRS::Codec::EnterOrderShortFormat::SIZE> buf;
+        Writer<XPRS::Codec::EnterOrderShortFormat> w(buf.data());
+        w.init();
+        w.set<F::order_token>(OUCH_TOKEN);
+        w.set<F::buy_sell_indicator>(XT::BuySellIndicator::SELL_SHORT);
+        w.set<F::quantity>(100u);
+        w.set<F::symbol>("MSFT");
+        w.set<F::price>(45.67);
+        w.set<F::time_in_force>(XT::TimeInForce::DAY);
+        w.set<F::display>(XT::Display::DISPLAYED);
+        w.set<F::special_order_type>(XT::SpecialOrderType::HIDE_NOT_SLIDE);
+        w.set<F::extended_hours_eligible>(XT::ExtendedHoursEligible::REGULAR_SESSION_ONLY);
+        w.set<F::capacity>(XT::Capacity::AGENCY);
+        w.set<F::route_out_eligibility>(XT::RouteOutEligibility::BOOK_ONLY);
+        w.set<F::iso_eligibility>(XT::ISOEligibility::NO);
+        EXPECT_EQ(bytes_of(m), bytes_of(w));
+        EXPECT_EQ("O,IAAPL000000001,T,100,MSFT  ,45.67,1,Y,S,R,A,N,N", printed<XPRS::Codec::EnterOrderShortFormat>(buf.data()));
+
+        XPRS::Messages::Cancel c;
+        c.message_type = XT::MessageType::CANCEL_ORDER;
+        std::memcpy(c.order_token, OUCH_TOKEN.data(), 14);
+        c.quantity = htonl(0);
+        std::array<std::uint8_t, XPRS::Codec::Cancel::SIZE> cbuf;
+        Writer<XPRS::Codec::Cancel> cw(cbuf.data());
+        cw.init();
+        cw.set<F::order_token>(OUCH_TOKEN);
+        EXPECT_EQ(bytes_of(c), bytes_of(cw));
+    }
+    {
+        namespace F = UTP::Codec::F;
+        namespace UT = UTP::Types;
+        UTP::Messages::NewOrder1 m;
+        std::memset(&m, 0, sizeof(m));
+        m.message_type = static_cast<UT::MessageType>(htons(static_cast<std::uint16_t>(UT::MessageType::NEW_ORDER_1)));
+        m.msg_length = htons(sizeof(m));
+        m.msg_seqnum.integral = htonl(5);
+        m.order_qty = htonl(300);
+        m.price = htonl(2550);
+        m.price_scale = UT::PriceScale::TWO;
+        std::memcpy(m.symbol, "BRK B", 5);
+        m.side = UT::Side::BUY;
+        m.order_type = UT::OrderType::LIMIT;
+        m.time_in_force = UT::TimeInForce::DAY;
+        m.routing_instruction = UT::RoutingInstruction::DNS;
+        m.dot_reserve = UT::DOTReserve::NO;
+        std::memcpy(m.client_order_id, "ABC 0001/01022015", 17);
+
+        std::array<std::uint8_t, UTP::Codec::NewOrder1::SIZE> buf;
+        Writer<UTP::Codec::NewOrder1> w(buf.data());
+        w.init();
+        w.set<F::msg_seqnum>(5u);
+        w.set<F::order_qty>(300u);
+        w.set<F::price>(2550u);
+        w.set<F::price_scale>(UT::PriceScale::TWO);
+        w.set<F::symbol>("BRK B");
+        w.set<F::side>(UT::Side::BUY);
+        w.set<F::order_type>(UT::OrderType::LIMIT);
+        w.set<F::time_in_force>(UT::TimeInForce::DAY);
+        w.set<F::routing_instruction>(UT::RoutingInstruction::DNS);
+        w.set<F::dot_reserve>(UT::DOTReserve::NO);
+        w.set<F::client_order_id>("ABC 0001/01022015");
+        EXPECT_EQ(bytes_of(m), bytes_of(w));
+        EXPECT_EQ(0, printed<UTP::Codec::NewOrder1>(buf.data()).find("65,84,5,300,0,2550,2,BRK B,"));
+    }
+}
+
+TEST(oe_wire_codec, oe_wire_codec_benchmark)
+{
+    using namespace OE_WIRE_CODEC_TEST;
+    std::vector<std::array<std::uint8_t, 256>> bufs(NUM_BUFS);
+    const double prices[] = {10.01, 10.02, 99.99, 123.4567};
+
+    // both ways of encoding make the EnterOrder the session sends:
+    Bytes enter;
+    {
+        OUCHFixture fx;
+        fx.login();
+        DayStrategy strategy(false);
+        auto *op = fx.om.create_order<NASDAQOrder>(fx.om.universe()[1].data(), 10.01, 300, Side::BUY,
+                                                   TimeInForce::DAY, OrderType::LIMIT, &strategy);
+        ASSERT_TRUE(fx.om.send(op, fx.session.get()));
+        enter = sbt_packet(fx.ex);
+        ASSERT_EQ(SBT::Codec::UnsequencedDataPacket::SIZE + O42::Codec::EnterOrder::SIZE, enter.size());
+        enter.erase(enter.begin(), enter.begin() + SBT::Codec::UnsequencedDataPacket::SIZE);
+    }
+    O42::Messages::EnterOrder eo;
+    std::memset(&eo, 0xff, sizeof(eo));
+    fill_enter_order(eo, 300, 10.01);
+    EXPECT_EQ(enter, bytes_of(eo));
+    EXPECT_EQ(enter, encode<O42::Codec::EnterOrder>([](const Writer<O42::Codec::EnterOrder>& w) {
+        encode_enter_order(w, 300, 10.01);
+    }));
+
+    // and the NewOrder:
+    BOEOrderFields f;
+    {
+        BOEFixture fx;
+        auto& s = *fx.session;
+        BATSOrder o(fx.om.universe()[1].data(), 10.01, 300, Side::BUY, TimeInForce::DAY, OrderType::LIMIT, nullptr);
+        const auto session_bytes = s.new_order(&o);
+        f = boe_fields(s, o, BOE::Types::Side::BUY, BOE::Types::TimeInForce::DAY);
+        std::array<std::uint8_t, BOE::Codec::NewOrder::SIZE> buf;
+        Writer<BOE::Codec::NewOrder> w(buf.data());
+        init_new_order(w);
+        fill_new_order(buf.data(), f);
+        EXPECT_EQ(session_bytes, bytes_of(w));
+        init_new_order(w);
+        encode_new_order(w, f);
+        EXPECT_EQ(session_bytes, bytes_of(w));
+    }
+
+    // the struct fills write every field, so both start from init:
+    for (auto& b : bufs)
+        Writer<O42::Codec::EnterOrder>(b.data()).init();
+    const auto ouch = bench(bufs, [&](std::uint8_t *p, std::size_t i) {
+        fill_enter_order(*reinterpret_cast<O42::Messages::EnterOrder *>(p), 100 + (i & 63), prices[i & 3]);
+    }, [&](std::uint8_t *p, std::size_t i) {
+        encode_enter_order(Writer<O42::Codec::EnterOrder>(p), 100 + (i & 63), prices[i & 3]);
+    });
+
+    for (auto& b : bufs)
+        init_new_order(Writer<BOE::Codec::NewOrder>(b.data()));
+    const auto boe = bench(bufs, [&](std::uint8_t *p, std::size_t i) {
+        f.qty = static_cast<BOE::Types::Quantity>(100 + (i & 63));
+        f.price = prices[i & 3];
+        fill_new_order(p, f);
+    }, [&](std::uint8_t *p, std::size_t i) {
+        f.qty = static_cast<BOE::Types::Quantity>(100 + (i & 63));
+        f.price = prices[i & 3];
+        encode_new_order(Writer<BOE::Codec::NewOrder>(p), f);
+    });
+
+    std::cout << "ns per message encoded, OUCH42 EnterOrder struct " << ouch.first << " codec " << ouch.second
+              << ", BOE20 NewOrder struct " << boe.first << " codec " << boe.second << std::endl;
+    // the codec is to cost no more than the structs, less the noise of a
+    // shared machine:
+    EXPECT_LE(ouch.second, BENCH_SLACK * ouch.first + BENCH_SLACK_NS);
+    EXPECT_LE(boe.second, BENCH_SLACK * boe.first + BENCH_SLACK_NS);
+}